@@ -3,21 +3,21 @@
 ////////////////////////////////////////////////////////////////////////////////
 QwtPlotGappedCurve::QwtPlotGappedCurve(double gapValue) 
 :	QwtPlotCurve(), 
-    gapValue_(gapValue), naValue_(0)
+    gapValue_(gapValue), naValue_(0), gapsMarked_(false)
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 QwtPlotGappedCurve::QwtPlotGappedCurve(const QwtText &title, double gapValue)
 :	QwtPlotCurve(title), 
-    gapValue_(gapValue), naValue_(0)
+    gapValue_(gapValue), naValue_(0), gapsMarked_(false)
 {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 QwtPlotGappedCurve::QwtPlotGappedCurve(const QString &title, double gapValue)
 :	QwtPlotCurve(title), 
-    gapValue_(gapValue) , naValue_(0)
+    gapValue_(gapValue) , naValue_(0), gapsMarked_(false)
 {
 }
 
@@ -40,7 +40,7 @@ void QwtPlotGappedCurve::drawSeries(QPainter *painter, const QwtScaleMap &xMap,
         double yprev = 0;
         if (i>0) yprev = sample(i-1).y();
 
-        if ((y < (naValue_ + -0.001) || y > (naValue_ + 0.001)) && (x - last <= gapValue_) &&
+        if ((y < (naValue_ + -0.001) || y > (naValue_ + 0.001)) && (gapsMarked_ || x - last <= gapValue_) &&
             (yprev < (naValue_ + -0.001) || yprev > (naValue_ + 0.001))) {
 
             int start = i-1;
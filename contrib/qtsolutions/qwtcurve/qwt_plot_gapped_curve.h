@@ -30,11 +30,18 @@ public:
                                                 const QwtScaleMap &yMap, const QRectF &canvRect, int from, int to) const;
 
     void setNAValue(double x) { naValue_=x; }
+    double gapValue() const { return gapValue_; }
+    double naValue() const { return naValue_; }
+
+    /// The data has a naValue point wherever there is a gap, e.g. once it
+    /// has been decimated, so the distance between points isn't checked
+    void setGapsMarked(bool x) { gapsMarked_=x; }
 
 private:
 	/// Value that denotes missed Y data at point
     double gapValue_;
     double naValue_;
+    bool gapsMarked_;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -26,6 +26,8 @@
 #include "ANT.h"
 #include "ANTMessage.h"
 #include "TrainSidebar.h" // for RT_MODE_{ERGO,SPIN,CALIBRATE}
+#include "RealtimeController.h" // for telemetrySample
+#include "TelemetryRecorder.h"
 #include <QMessageBox>
 #include <QTime>
 #include <QProgressDialog>
@@ -131,10 +133,14 @@ ANT::ANT(QObject *parent, DeviceConfiguration *devConf, QString athlete) : QThre
     if (!elapsedTimer.isMonotonic())
         qDebug() << "Caution: ANT timer is not monotonic";
 
-    // state machine
-    state = ST_WAIT_FOR_SYNC;
-    length = bytes = 0;
-    checksum = ANT_SYNC_BYTE;
+    // not recording
+    recorder = NULL;
+    recordSource = 0;
+    recordChannels = 0;
+
+#ifndef WIN32
+    replay = NULL;
+#endif
 
     // ant ids - may not be configured of course
     if (devConf && devConf->deviceProfile.length())
@@ -188,6 +194,9 @@ ANT::~ANT()
 #if defined GC_HAVE_LIBUSB
     delete usb2;
 #endif
+#ifndef WIN32
+    if (replay) delete replay;
+#endif
 }
 
 void ANT::setDevice(QString x)
@@ -266,9 +275,7 @@ void ANT::run()
 
     for (int i=0; i<ANT_MAX_CHANNELS; i++) antChannel[i]->init();
 
-    state = ST_WAIT_FOR_SYNC;
-    length = bytes = 0;
-    checksum = ANT_SYNC_BYTE;
+    framer.clear();
 
     if (openPort() == 0) {
 
@@ -288,14 +295,15 @@ void ANT::run()
 
     while(1)
     {
-        // read more bytes from the device
-        uint8_t byte;
+        // read whatever the device has for us, rawRead waits
+        // for it to arrive so we only sleep after an error
+        uint8_t buf[64];
 
-        int rc = rawRead(&byte, 1);
+        int rc = rawRead(buf, qMin(int(sizeof(buf)), framer.space()));
 
         if (rc > 0)
-            receiveByte((unsigned char)byte);
-        else {
+            receiveBytes(buf, rc);
+        else if (rc < 0) {
 
             // Recognise USB device removal. Linux transitions through -5 (I/O error)
             // to -6 (No such device or address). Windows seems to stick on -5
@@ -999,51 +1007,37 @@ ANT::sendMessage(ANTMessage m) {
 }
 
 void
-ANT::receiveByte(unsigned char byte) {
-
-    switch (state) {
-        case ST_WAIT_FOR_SYNC:
-            if (byte == ANT_SYNC_BYTE) {
-                state = ST_GET_LENGTH;
-                checksum = ANT_SYNC_BYTE;
-                rxMessage[0] = byte;
-            }
-            break;
+ANT::receiveBytes(const uint8_t *bytes, int size) {
 
-        case ST_GET_LENGTH:
-            if ((byte == 0) || (byte > ANT_MAX_LENGTH)) {
-                state = ST_WAIT_FOR_SYNC;
-            }
-            else {
-              rxMessage[ANT_OFFSET_LENGTH] = byte;
-                checksum ^= byte;
-                length = byte;
-                bytes = 0;
-                state = ST_GET_MESSAGE_ID;
-            }
-            break;
+    framer.append(bytes, size);
+    bool received = false;
+    while (framer.next(rxMessage)) {
+        processMessage();
+        received = true;
+    }
 
-        case ST_GET_MESSAGE_ID:
-            rxMessage[ANT_OFFSET_ID] = byte;
-            checksum ^= byte;
-            state = ST_GET_DATA;
-            break;
+    // record as it arrives, not when the train view next looks
+    if (received) record();
+}
 
-        case ST_GET_DATA:
-            rxMessage[ANT_OFFSET_DATA + bytes] = byte;
-            checksum ^= byte;
-            if (++bytes >= length){
-                state = ST_VALIDATE_PACKET;
-            }
-            break;
+void
+ANT::setRecorder(TelemetryRecorder *recorder, int source, quint32 channels)
+{
+    // set before the recorder is seen by the receive thread
+    recordSource = source;
+    recordChannels = channels;
+    this->recorder.storeRelease(recorder);
+}
 
-        case ST_VALIDATE_PACKET:
-            if (checksum == byte){
-                processMessage();
-            }
-            state = ST_WAIT_FOR_SYNC;
-            break;
-    }
+void
+ANT::record()
+{
+    TelemetryRecorder *to = recorder.loadAcquire();
+    if (to == NULL || !to->isRecording()) return;
+
+    TelemetrySample sample = RealtimeController::telemetrySample(telemetry, recordChannels);
+    sample.msecs = to->sessionTime();
+    to->push(recordSource, sample);
 }
 
 
@@ -1143,7 +1137,11 @@ int ANT::closePort()
     }
 #endif
     tcflush(devicePort, TCIOFLUSH); // clear out the garbage
-    return close(devicePort);
+    int rc = close(devicePort);
+
+    if (replay) delete replay;
+    replay = NULL;
+    return rc;
 #endif
 }
 
@@ -1194,9 +1192,18 @@ int ANT::openPort()
     int ldisc=N_TTY; // LINUX
 #endif
 
+    // a port of replay:<capture> replays it through a pseudo
+    // terminal instead of talking to a stick, see ANTSerial.h
+    if (replay) delete replay;
+    replay = NULL;
+    if (deviceFilename.startsWith("replay:")) {
+        replay = new ANTReplay(deviceFilename.mid(7));
+        if (!replay->open()) return -1;
+    }
+
 #ifdef GC_HAVE_LIBUSB
     int rc;
-    if ((rc=usb2->open()) != -1) {
+    if (!replay && (rc=usb2->open()) != -1) {
         usbMode = USB2;
         channels = 8;
         return rc;
@@ -1206,9 +1213,10 @@ int ANT::openPort()
 
     // if usb2 failed / not compiled in, we must be using
     // a USB1 stick so default to 4 channels
-    channels = 4;
+    channels = replay ? 8 : 4;
 
-    if ((devicePort=open(deviceFilename.toLatin1(),O_RDWR | O_NOCTTY | O_NONBLOCK)) == -1)
+    QString port = replay ? replay->device() : deviceFilename;
+    if ((devicePort=open(port.toLatin1(),O_RDWR | O_NOCTTY | O_NONBLOCK)) == -1)
         return errno;
 
     tcflush(devicePort, TCIOFLUSH); // clear out the garbage
@@ -1240,6 +1248,9 @@ int ANT::openPort()
     if(tcsetattr(devicePort, TCSANOW, &deviceSettings) == -1) return errno;
     tcgetattr(devicePort, &deviceSettings);
 
+    // only once the garbage has been flushed
+    if (replay) replay->start();
+
 #endif
 
     // success
@@ -1309,7 +1320,11 @@ int ANT::rawRead([[maybe_unused]] uint8_t bytes[], [[maybe_unused]] int size)
     switch (usbMode) {
 #ifdef GC_HAVE_USBXPRESS
     case USB1:
-        return USBXpress::read(&devicePort, bytes, size);
+        {
+            // nothing read is an error, only the tty waits for data
+            int rc = USBXpress::read(&devicePort, bytes, size);
+            return rc ? rc : -1;
+        }
         break;
 #endif
     case USB2:
@@ -1329,17 +1344,21 @@ int ANT::rawRead([[maybe_unused]] uint8_t bytes[], [[maybe_unused]] int size)
         return usb2->read((char *)bytes, size);
     }
 #endif
-    int i=0;
-    uint8_t byte;
-
-    // read one byte at a time sleeping when no data ready
-    // until we timeout waiting then return error
-    for (i=0; i<size; i++) {
-        int rc = read(devicePort, &byte, 1);
-        if (rc == -1 || rc == 0) return -1; // error!
-        else bytes[i] = byte;
-    }
-    return i;
+    // wait for something to arrive then take all of it, returns
+    // 0 when nothing arrived so the caller doesn't need to sleep
+    struct pollfd fds;
+    fds.fd = devicePort;
+    fds.events = POLLIN;
+    fds.revents = 0;
+
+    int rc = poll(&fds, 1, 50);
+    if (rc == 0 || (rc == -1 && errno == EINTR)) return 0;
+    if (rc == -1) return -1; // error!
+
+    rc = read(devicePort, bytes, size);
+    if (rc > 0) return rc;
+    if (rc == -1 && errno == EAGAIN) return 0;
+    return -1; // error, or hung up
 
 #endif
     return -1; // keep compiler happy.
@@ -27,12 +27,14 @@
 #include "RealtimeData.h"
 #include "CalibrationData.h"
 #include "DeviceConfiguration.h"
+#include "ANTSerial.h"
 
 //
 // QT stuff
 //
 #include <QThread>
 #include <QMutex>
+#include <QAtomicPointer>
 #include <QObject>
 #include <QQueue>
 #include <QStringList>
@@ -71,6 +73,7 @@
 #include <termios.h> // unix!!
 #include <unistd.h> // unix!!
 #include <sys/ioctl.h>
+#include <poll.h> // unix!!
 #ifndef N_TTY // for OpenBSD
 #define N_TTY 0
 #endif
@@ -90,6 +93,7 @@
 
 class ANTMessage;
 class ANTChannel;
+class TelemetryRecorder;
 
 typedef struct ant_sensor_type {
   bool user; // can user select this when calibrating ?
@@ -517,6 +521,9 @@ public:
     static char deviceTypeCode(int type); // utility to convert CHANNEL_TYPE_X to 'c', 'p' et al
     static char deviceIdCode(int type); // utility to convert CHANNEL_TYPE_X to 'c', 'p' et al
 
+    // record the channels as each message arrives, null recorder to stop
+    void setRecorder(TelemetryRecorder *recorder, int source, quint32 channels);
+
     // debug enums
     enum { DEBUG_LEVEL_ERRORS=1,
        DEBUG_LEVEL_ANT_CONNECTION=2,
@@ -537,7 +544,7 @@ public:
 
     // transmission
     void sendMessage(ANTMessage);
-    void receiveByte(unsigned char byte);
+    void receiveBytes(const uint8_t *bytes, int size);
     void handleChannelEvent(void);
     void processMessage(void);
 
@@ -741,6 +748,12 @@ private:
     RealtimeData telemetry;
     CalibrationData calibration;
 
+    // recording telemetry as it arrives
+    void record();
+    QAtomicPointer<TelemetryRecorder> recorder;
+    int recordSource;
+    quint32 recordChannels;
+
     QMutex pvars;  // lock/unlock access to telemetry data between thread and controller
     int Status;     // what status is the client in?
     bool configuring; // set to true if we're in configuration mode.
@@ -755,6 +768,7 @@ private:
 #else
     int devicePort;                 // unix!!
     struct termios deviceSettings;  // unix!!
+    ANTReplay *replay;              // when deviceFilename is replay:<capture>
 #endif
 
 #if defined GC_HAVE_LIBUSB
@@ -772,12 +786,8 @@ private:
     bool ANT_Reset_Acknowledge;
     unsigned char rxMessage[ANT_MAX_MESSAGE_SIZE];
 
-    // state machine whilst receiving bytes
-    enum States {ST_WAIT_FOR_SYNC, ST_GET_LENGTH, ST_GET_MESSAGE_ID, ST_GET_DATA, ST_VALIDATE_PACKET} state;
-    //enum States state;
-    int length;
-    int bytes;
-    int checksum;
+    // messages framed from the bytes received
+    ANTFramer framer;
     int powerchannels; // how many power channels do we have?
     QDateTime lastCadenceMessage;
 
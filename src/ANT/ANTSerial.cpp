@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ANTSerial.h"
+
+#include <QFile>
+#include <QElapsedTimer>
+
+#include <string.h>
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+void
+ANTFramer::append(const uint8_t *bytes, int size)
+{
+    if (size > space()) size = space(); // can't happen, we read no more than space()
+
+    // at most two copies, either side of the wrap
+    unsigned int start = head & (capacity-1);
+    int first = qMin(size, capacity - int(start));
+    memcpy(buffer + start, bytes, first);
+    memcpy(buffer, bytes + first, size - first);
+    head += size;
+}
+
+bool
+ANTFramer::next(unsigned char *message)
+{
+    while (count()) {
+
+        // skip to the next sync
+        if (at(0) != sync) {
+            tail++;
+            continue;
+        }
+        if (count() < 2) return false;
+
+        // a bad length isn't a message, the length byte is skipped too
+        int length = at(1);
+        if (length == 0 || length > maxLength) {
+            tail += 2;
+            continue;
+        }
+
+        // sync, length, id, data and checksum
+        int size = length + 4;
+        if (count() < size) return false;
+
+        uint8_t checksum = 0;
+        for (int i=0; i<size-1; i++) {
+            message[i] = at(i);
+            checksum ^= message[i];
+        }
+        bool good = (checksum == at(size-1));
+        tail += size;
+
+        if (good) return true;
+    }
+    return false;
+}
+
+#ifndef WIN32
+ANTReplay::ANTReplay(QString filename, bool realtime) : filename(filename), realtime(realtime), master(-1), slave(-1), stopping(0)
+{
+}
+
+ANTReplay::~ANTReplay()
+{
+    stop();
+    wait();
+
+    if (slave >= 0) close(slave);
+    if (master >= 0) close(master);
+}
+
+bool
+ANTReplay::parse(const QByteArray &antlog, QByteArray &bytes, QVector<int> &offsets, QVector<qint64> &times)
+{
+    // RS, 8 byte timestamp and 12 byte message, see ANTLogger
+    const int record = 1 + 8 + 12;
+
+    if (antlog.size() == 0 || antlog.size() % record) return false;
+    for (int i=0; i<antlog.size(); i += record)
+        if (antlog[i] != 'R' && antlog[i] != 'S') return false;
+
+    bytes.clear();
+    offsets.clear();
+    times.clear();
+    for (int i=0; i<antlog.size(); i += record) {
+
+        // only what was received from the stick
+        const uint8_t *p = (const uint8_t*)antlog.constData() + i;
+        if (p[0] != 'R') continue;
+
+        qint64 millis = 0;
+        for (int j=8; j>0; j--) millis = (millis << 8) | p[j];
+
+        // the checksum isn't logged
+        const uint8_t *message = p + 9;
+        int length = message[1];
+        if (message[0] != ANTFramer::sync || length == 0 || length > ANTFramer::maxLength) continue;
+
+        offsets << bytes.size();
+        times << millis;
+
+        uint8_t checksum = 0;
+        for (int j=0; j<length+3; j++) {
+            bytes.append(char(message[j]));
+            checksum ^= message[j];
+        }
+        bytes.append(char(checksum));
+    }
+    return true;
+}
+
+bool
+ANTReplay::open()
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) return false;
+    QByteArray capture = file.readAll();
+    file.close();
+
+    if (!parse(capture, bytes, offsets, times)) {
+
+        // raw bytes from the stick, sent as the stick would
+        bytes = capture;
+        offsets.clear();
+        times.clear();
+        for (int i=0; i<bytes.size(); i += 64) {
+            offsets << i;
+            times << 0;
+        }
+    }
+
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0) return false;
+    if (grantpt(master) == -1 || unlockpt(master) == -1 || ptsname(master) == NULL) return false;
+    slaveName = ptsname(master);
+
+    // we keep the slave open so the master never sees a hangup, and
+    // make it raw now so nothing written before the port is set up
+    // gets echoed or held back waiting for a newline
+    if ((slave = ::open(slaveName.toLatin1(), O_RDWR | O_NOCTTY)) == -1) return false;
+
+    struct termios settings;
+    tcgetattr(slave, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(slave, TCSANOW, &settings);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void
+ANTReplay::drain()
+{
+    // throw away whatever was written to the device
+    char buf[256];
+    while (read(master, buf, sizeof(buf)) > 0) ;
+}
+
+bool
+ANTReplay::send(const char *data, int size)
+{
+    while (size > 0 && !stopping) {
+
+        int rc = write(master, data, size);
+        if (rc > 0) {
+            data += rc;
+            size -= rc;
+        } else if (rc == -1 && (errno == EAGAIN || errno == EINTR)) {
+
+            // the reader is behind, wait for room
+            struct pollfd fds;
+            fds.fd = master;
+            fds.events = POLLOUT;
+            fds.revents = 0;
+            poll(&fds, 1, 10);
+            drain();
+
+        } else return false;
+    }
+    return true;
+}
+
+void
+ANTReplay::run()
+{
+    QElapsedTimer clock;
+    clock.start();
+    qint64 first = times.count() ? times[0] : 0;
+
+    for (int i=0; i<offsets.count() && !stopping; i++) {
+
+        // when it was recorded
+        if (realtime) {
+            qint64 wait;
+            while (!stopping && (wait = times[i] - first - clock.elapsed()) > 0) {
+                drain();
+                msleep(qMin(wait, qint64(10)));
+            }
+        }
+
+        int end = (i+1 < offsets.count()) ? offsets[i+1] : bytes.size();
+        if (!send(bytes.constData() + offsets[i], end - offsets[i])) break;
+        drain();
+    }
+
+    // all sent, stay quiet until we're stopped
+    while (!stopping) {
+        drain();
+        msleep(10);
+    }
+}
+#endif
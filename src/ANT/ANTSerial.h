@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_ANTSerial_h
+#define _GC_ANTSerial_h 1
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QThread>
+#include <QAtomicInt>
+
+#include <stdint.h>
+
+//
+// Frames ANT messages from the bytes read from the stick.
+//
+// Bytes are appended to a ring buffer as they are read, in whatever size
+// chunks the stick delivers them, and whole messages are taken out of it.
+// A message is sync, length, id, length data bytes and a checksum; bytes
+// before a sync are skipped, as is a sync followed by a bad length, and
+// messages with a bad checksum are dropped. The results are the same as
+// feeding the bytes through a state machine one at a time.
+//
+class ANTFramer
+{
+    public:
+
+        static const uint8_t sync = 0xA4;       // ANT_SYNC_BYTE
+        static const int maxLength = 9;         // ANT_MAX_LENGTH
+        static const int capacity = 1024;       // power of 2
+
+        ANTFramer() : head(0), tail(0) {}
+
+        void clear() { head = tail = 0; }
+        int count() const { return int(head - tail); }
+        int space() const { return capacity - count(); }
+
+        // add bytes read from the stick, no more than space()
+        void append(const uint8_t *bytes, int size);
+
+        // take the next good message into message (sync, length, id
+        // and data, at least ANT_MAX_MESSAGE_SIZE bytes), false when
+        // the rest of it hasn't arrived yet
+        bool next(unsigned char *message);
+
+    private:
+
+        uint8_t at(unsigned int i) const { return buffer[(tail + i) & (capacity-1)]; }
+
+        uint8_t buffer[capacity];
+        unsigned int head, tail;        // free running, wrap together
+};
+
+#ifndef WIN32
+//
+// Replays a capture through a pseudo terminal, so the ANT code can be run
+// without a stick by opening device() in place of the serial port.
+//
+// The capture can be an antlog.raw written by ANTLogger, in which case the
+// messages received from the stick are replayed at the same pace they were
+// recorded, or just the raw bytes read from a stick. Anything written to the
+// device is read and thrown away.
+//
+class ANTReplay : public QThread
+{
+    public:
+
+        ANTReplay(QString filename, bool realtime = true);
+        ~ANTReplay();
+
+        // create the pseudo terminal and load the capture
+        bool open();
+        QString device() const { return slaveName; }
+
+        // stop replaying, the device stays open until we are deleted
+        void stop() { stopping = 1; }
+
+        // convert an antlog.raw into the bytes the stick sent, with the
+        // offset into bytes and time in ms of each message
+        static bool parse(const QByteArray &antlog, QByteArray &bytes,
+                          QVector<int> &offsets, QVector<qint64> &times);
+
+    protected:
+
+        void run() override;
+
+    private:
+
+        bool send(const char *data, int size);
+        void drain();
+
+        QString filename, slaveName;
+        bool realtime;
+        int master, slave;
+        QAtomicInt stopping;
+
+        QByteArray bytes;
+        QVector<int> offsets;
+        QVector<qint64> times;
+};
+#endif
+#endif // _GC_ANTSerial_h
@@ -177,6 +177,19 @@ ANTlocalController::getRealtimeData(RealtimeData &rtData)
     processRealtimeData(rtData);
 }
 
+quint32
+ANTlocalController::setRecorder(TelemetryRecorder *recorder, int source, quint32 channels)
+{
+    // power worked out from speed is only known when polled
+    if (estimatesPower()) channels &= ~TelemetrySample::Power;
+    if (recorder == NULL || channels == 0) {
+        myANTlocal->setRecorder(NULL, 0, 0);
+        return 0;
+    }
+    myANTlocal->setRecorder(recorder, source, channels);
+    return channels;
+}
+
 uint8_t
 ANTlocalController::getCalibrationType()
 {
@@ -60,6 +60,7 @@ public:
     bool doesPush(), doesPull(), doesLoad();
     void getRealtimeData(RealtimeData &rtData);
     void pushRealtimeData(RealtimeData &rtData);
+    quint32 setRecorder(TelemetryRecorder *recorder, int source, quint32 channels);
 
     // now with the kickr we can control trainers
     void setLoad(double);
@@ -35,6 +35,7 @@
 #include "WPrime.h"
 #include "IndendPlotMarker.h"
 #include "Utils.h"
+#include "SeriesPyramid.h"
 
 #include <qwt_plot_curve.h>
 #include <qwt_plot_canvas.h>
@@ -53,6 +54,7 @@
 #include "qwt_plot_gapped_curve.h"
 
 #include <QMultiMap>
+#include <QSharedPointer>
 
 #include <string.h> // for memcpy
 
@@ -78,6 +80,114 @@ class IntervalPlotData : public QwtSeriesData<QPointF>
     virtual QRectF boundingRect() const;
 };
 
+// a curve drawn through a min/max pyramid over the smoothed series, so
+// however many samples are visible only a couple per bucket are drawn; qwt
+// tells us the scale whenever it changes (ScaleInterest) and we pick the
+// samples for it then. Zoomed plots share the pyramid of the full plot.
+class PyramidPlotData : public QwtSeriesData<QPointF>
+{
+    public:
+    PyramidPlotData(QSharedPointer<SeriesPyramid> pyramid, int base, int from, int to) :
+        pyramid(pyramid), base(base), from(from), to(to)
+    {
+        if (from < to) {
+            int min, max;
+            pyramid->range(from, to, min, max);
+            bounds = QRectF(pyramid->x(from), pyramid->y(min),
+                            pyramid->x(to-1) - pyramid->x(from), pyramid->y(max) - pyramid->y(min));
+        }
+        pyramid->decimate(from, to, buckets, view);
+    }
+
+    size_t size() const { return view.count(); }
+    QPointF sample(size_t i) const
+    {
+        // a break is drawn as no data where the next sample is
+        if (view[i] == SeriesPyramid::Break) return QPointF(pyramid->x(view[i+1]), pyramid->breakValue());
+        return QPointF(pyramid->x(view[i]), pyramid->y(view[i]));
+    }
+    QRectF boundingRect() const { return bounds; }
+
+    void setRectOfInterest(const QRectF &rect)
+    {
+        // one sample either side so the line runs off the edges
+        int lo = qMax(from, pyramid->lowerBound(rect.left()) - 1);
+        int hi = qMin(to, pyramid->lowerBound(rect.right()) + 1);
+        pyramid->decimate(lo, hi, buckets, view);
+    }
+
+    static const int buckets = 4096; // more than enough pixels across
+
+    QSharedPointer<SeriesPyramid> pyramid;
+    int base;           // index of the first sample in the ride arrays
+    int from, to;       // the samples this curve shows
+
+    private:
+    QVector<int> view;
+    QRectF bounds;
+};
+
+static void setPyramidData(QwtPlotCurve *curve, PyramidPlotData *data)
+{
+    // a gapped curve breaks the line wherever consecutive samples are more
+    // than the gap apart or zero, decimated samples are always further apart
+    // than that so the pyramid marks the breaks and the curve only uses those
+    QwtPlotGappedCurve *gapped = dynamic_cast<QwtPlotGappedCurve*>(curve);
+    if (gapped) gapped->setGapsMarked(data->pyramid->hasBreaks());
+
+    curve->setItemInterest(QwtPlotItem::ScaleInterest, true);
+    curve->setSamples(data);
+}
+
+// count samples of y against x, which start at index base in the ride arrays
+static void setPyramidSamples(QwtPlotCurve *curve, const double *x, const double *y, int count, int base)
+{
+    QSharedPointer<SeriesPyramid> pyramid(new SeriesPyramid(x, y, count));
+    QwtPlotGappedCurve *gapped = dynamic_cast<QwtPlotGappedCurve*>(curve);
+    if (gapped) pyramid->setBreaks(gapped->gapValue(), gapped->naValue());
+    setPyramidData(curve, new PyramidPlotData(pyramid, base, 0, pyramid->count()));
+}
+
+// count samples from startidx, sharing the pyramid of the reference curve
+// when it covers them, so zooming doesn't copy or rebuild anything
+static void setPyramidSamples(QwtPlotCurve *curve, const QwtPlotCurve *reference, int startidx,
+                              const double *x, const double *y, int count)
+{
+    const PyramidPlotData *there = dynamic_cast<const PyramidPlotData*>(reference->data());
+    bool gapped = dynamic_cast<QwtPlotGappedCurve*>(curve) != NULL;
+    if (there && startidx >= there->base && startidx - there->base + count <= there->pyramid->count()
+        && count && there->pyramid->x(startidx - there->base) == x[0] && there->pyramid->hasBreaks() == gapped) {
+        int from = startidx - there->base;
+        setPyramidData(curve, new PyramidPlotData(there->pyramid, there->base, from, from + count));
+    } else {
+        setPyramidSamples(curve, x, y, count, startidx);
+    }
+}
+
+// samples copied from another curve
+static void setPyramidSamples(QwtPlotCurve *curve, const QVector<QPointF> &samples)
+{
+    QVector<double> x(samples.count()), y(samples.count());
+    for (int i=0; i<samples.count(); i++) {
+        x[i] = samples[i].x();
+        y[i] = samples[i].y();
+    }
+    setPyramidSamples(curve, x.constData(), y.constData(), x.count(), 0);
+}
+
+// all the samples of a curve, not just those drawn at the current scale
+static QVector<QPointF> curveSamples(const QwtPlotCurve *curve)
+{
+    QVector<QPointF> array;
+    const PyramidPlotData *data = dynamic_cast<const PyramidPlotData*>(curve->data());
+    if (data) {
+        for (int i=data->from; i<data->to; i++) array << QPointF(data->pyramid->x(i), data->pyramid->y(i));
+    } else {
+        for (size_t i=0; i<curve->data()->size(); i++) array << curve->data()->sample(i);
+    }
+    return array;
+}
+
 // define a background class to handle shading of power zones
 // draws power zone bands IF zones are defined and the option
 // to draw bonds has been selected
@@ -2379,113 +2489,113 @@ AllPlot::recalc(AllPlotObject *objects)
     // set curve.
     for(int k=0; k<objects->U.count(); k++) {
         if (!objects->U[k].array.empty()) {
-            objects->U[k].curve->setSamples(xaxis.data() + startingIndex, objects->U[k].smooth.data() + startingIndex, totalPoints);
+            setPyramidSamples(objects->U[k].curve, xaxis.data() + startingIndex, objects->U[k].smooth.data() + startingIndex, totalPoints, startingIndex);
             //XXXXHEREXXX
         }
     }
 
     if (!objects->wattsArray.empty()) {
-        objects->wattsCurve->setSamples(xaxis.data() + startingIndex, objects->smoothWatts.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->wattsCurve, xaxis.data() + startingIndex, objects->smoothWatts.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->antissArray.empty()) {
-        objects->antissCurve->setSamples(xaxis.data() + startingIndex, objects->smoothANT.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->antissCurve, xaxis.data() + startingIndex, objects->smoothANT.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->atissArray.empty()) {
-        objects->atissCurve->setSamples(xaxis.data() + startingIndex, objects->smoothAT.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->atissCurve, xaxis.data() + startingIndex, objects->smoothAT.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->rvArray.empty()) {
-        objects->rvCurve->setSamples(xaxis.data() + startingIndex, objects->smoothRV.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->rvCurve, xaxis.data() + startingIndex, objects->smoothRV.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->rcadArray.empty()) {
-        objects->rcadCurve->setSamples(xaxis.data() + startingIndex, objects->smoothRCad.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->rcadCurve, xaxis.data() + startingIndex, objects->smoothRCad.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->rgctArray.empty()) {
-        objects->rgctCurve->setSamples(xaxis.data() + startingIndex, objects->smoothRGCT.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->rgctCurve, xaxis.data() + startingIndex, objects->smoothRGCT.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->gearArray.empty()) {
-        objects->gearCurve->setSamples(xaxis.data() + startingIndex, objects->smoothGear.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->gearCurve, xaxis.data() + startingIndex, objects->smoothGear.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->smo2Array.empty()) {
-        objects->smo2Curve->setSamples(xaxis.data() + startingIndex, objects->smoothSmO2.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->smo2Curve, xaxis.data() + startingIndex, objects->smoothSmO2.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->thbArray.empty()) {
-        objects->thbCurve->setSamples(xaxis.data() + startingIndex, objects->smoothtHb.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->thbCurve, xaxis.data() + startingIndex, objects->smoothtHb.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->o2hbArray.empty()) {
-        objects->o2hbCurve->setSamples(xaxis.data() + startingIndex, objects->smoothO2Hb.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->o2hbCurve, xaxis.data() + startingIndex, objects->smoothO2Hb.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->hhbArray.empty()) {
-        objects->hhbCurve->setSamples(xaxis.data() + startingIndex, objects->smoothHHb.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->hhbCurve, xaxis.data() + startingIndex, objects->smoothHHb.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->npArray.empty()) {
-        objects->npCurve->setSamples(xaxis.data() + startingIndex, objects->smoothNP.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->npCurve, xaxis.data() + startingIndex, objects->smoothNP.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->xpArray.empty()) {
-        objects->xpCurve->setSamples(xaxis.data() + startingIndex, objects->smoothXP.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->xpCurve, xaxis.data() + startingIndex, objects->smoothXP.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->apArray.empty()) {
-        objects->apCurve->setSamples(xaxis.data() + startingIndex, objects->smoothAP.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->apCurve, xaxis.data() + startingIndex, objects->smoothAP.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->hrArray.empty()) {
-        objects->hrCurve->setSamples(xaxis.data() + startingIndex, objects->smoothHr.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->hrCurve, xaxis.data() + startingIndex, objects->smoothHr.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->tcoreArray.empty()) {
-        objects->tcoreCurve->setSamples(xaxis.data() + startingIndex, objects->smoothTcore.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->tcoreCurve, xaxis.data() + startingIndex, objects->smoothTcore.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->speedArray.empty()) {
-        objects->speedCurve->setSamples(xaxis.data() + startingIndex, objects->smoothSpeed.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->speedCurve, xaxis.data() + startingIndex, objects->smoothSpeed.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->accelArray.empty()) {
-        objects->accelCurve->setSamples(xaxis.data() + startingIndex, objects->smoothAccel.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->accelCurve, xaxis.data() + startingIndex, objects->smoothAccel.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->wattsDArray.empty()) {
-        objects->wattsDCurve->setSamples(xaxis.data() + startingIndex, objects->smoothWattsD.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->wattsDCurve, xaxis.data() + startingIndex, objects->smoothWattsD.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->cadDArray.empty()) {
-        objects->cadDCurve->setSamples(xaxis.data() + startingIndex, objects->smoothCadD.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->cadDCurve, xaxis.data() + startingIndex, objects->smoothCadD.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->nmDArray.empty()) {
-        objects->nmDCurve->setSamples(xaxis.data() + startingIndex, objects->smoothNmD.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->nmDCurve, xaxis.data() + startingIndex, objects->smoothNmD.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->hrDArray.empty()) {
-        objects->hrDCurve->setSamples(xaxis.data() + startingIndex, objects->smoothHrD.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->hrDCurve, xaxis.data() + startingIndex, objects->smoothHrD.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->cadArray.empty()) {
-        objects->cadCurve->setSamples(xaxis.data() + startingIndex, objects->smoothCad.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->cadCurve, xaxis.data() + startingIndex, objects->smoothCad.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->altArray.empty()) {
-        objects->altCurve->setSamples(xaxis.data() + startingIndex, objects->smoothAltitude.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->altCurve, xaxis.data() + startingIndex, objects->smoothAltitude.data() + startingIndex, totalPoints, startingIndex);
         objects->altSlopeCurve->setSamples(xaxis.data() + startingIndex, objects->smoothAltitude.data() + startingIndex, totalPoints);
     }
     if (!objects->slopeArray.empty()) {
-        objects->slopeCurve->setSamples(xaxis.data() + startingIndex, objects->smoothSlope.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->slopeCurve, xaxis.data() + startingIndex, objects->smoothSlope.data() + startingIndex, totalPoints, startingIndex);
     }
 
     if (!objects->tempArray.empty()) {
-        objects->tempCurve->setSamples(xaxis.data() + startingIndex, objects->smoothTemp.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->tempCurve, xaxis.data() + startingIndex, objects->smoothTemp.data() + startingIndex, totalPoints, startingIndex);
     }
 
 
@@ -2494,29 +2604,21 @@ AllPlot::recalc(AllPlotObject *objects)
     }
 
     if (!objects->torqueArray.empty()) {
-        objects->torqueCurve->setSamples(xaxis.data() + startingIndex, objects->smoothTorque.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->torqueCurve, xaxis.data() + startingIndex, objects->smoothTorque.data() + startingIndex, totalPoints, startingIndex);
     }
 
     // left/right pedals
     if (!objects->balanceArray.empty()) {
-        objects->balanceLCurve->setSamples(xaxis.data() + startingIndex, 
-                                           objects->smoothBalanceL.data() + startingIndex, totalPoints);
-        objects->balanceRCurve->setSamples(xaxis.data() + startingIndex, 
-                                           objects->smoothBalanceR.data() + startingIndex, totalPoints);
-    }
-    if (!objects->lteArray.empty()) objects->lteCurve->setSamples(xaxis.data() + startingIndex, 
-                                             objects->smoothLTE.data() + startingIndex, totalPoints);
-    if (!objects->rteArray.empty()) objects->rteCurve->setSamples(xaxis.data() + startingIndex, 
-                                             objects->smoothRTE.data() + startingIndex, totalPoints);
-    if (!objects->lpsArray.empty()) objects->lpsCurve->setSamples(xaxis.data() + startingIndex, 
-                                             objects->smoothLPS.data() + startingIndex, totalPoints);
-    if (!objects->rpsArray.empty()) objects->rpsCurve->setSamples(xaxis.data() + startingIndex, 
-                                             objects->smoothRPS.data() + startingIndex, totalPoints);
-
-    if (!objects->lpcoArray.empty()) objects->lpcoCurve->setSamples(xaxis.data() + startingIndex,
-                                             objects->smoothLPCO.data() + startingIndex, totalPoints);
-    if (!objects->rpcoArray.empty()) objects->rpcoCurve->setSamples(xaxis.data() + startingIndex,
-                                             objects->smoothRPCO.data() + startingIndex, totalPoints);
+        setPyramidSamples(objects->balanceLCurve, xaxis.data() + startingIndex, objects->smoothBalanceL.data() + startingIndex, totalPoints, startingIndex);
+        setPyramidSamples(objects->balanceRCurve, xaxis.data() + startingIndex, objects->smoothBalanceR.data() + startingIndex, totalPoints, startingIndex);
+    }
+    if (!objects->lteArray.empty()) setPyramidSamples(objects->lteCurve, xaxis.data() + startingIndex, objects->smoothLTE.data() + startingIndex, totalPoints, startingIndex);
+    if (!objects->rteArray.empty()) setPyramidSamples(objects->rteCurve, xaxis.data() + startingIndex, objects->smoothRTE.data() + startingIndex, totalPoints, startingIndex);
+    if (!objects->lpsArray.empty()) setPyramidSamples(objects->lpsCurve, xaxis.data() + startingIndex, objects->smoothLPS.data() + startingIndex, totalPoints, startingIndex);
+    if (!objects->rpsArray.empty()) setPyramidSamples(objects->rpsCurve, xaxis.data() + startingIndex, objects->smoothRPS.data() + startingIndex, totalPoints, startingIndex);
+
+    if (!objects->lpcoArray.empty()) setPyramidSamples(objects->lpcoCurve, xaxis.data() + startingIndex, objects->smoothLPCO.data() + startingIndex, totalPoints, startingIndex);
+    if (!objects->rpcoArray.empty()) setPyramidSamples(objects->rpcoCurve, xaxis.data() + startingIndex, objects->smoothRPCO.data() + startingIndex, totalPoints, startingIndex);
     if (!objects->lppbArray.empty()) {
         objects->lppCurve->setSamples(new QwtIntervalSeriesData(objects->smoothLPP));
     }
@@ -3365,47 +3467,47 @@ AllPlot::setDataFromPlot(AllPlot *plot, int startidx, int stopidx)
         setMatchLabels(standard);
     }
     int points = stopidx - startidx + 1; // e.g. 10 to 12 is 3 points 10,11,12, so not 12-10 !
-    for(int k=0; k<standard->U.count(); k++) standard->U[k].curve->setSamples(xaxis,smoothU[k], points);
-    standard->wattsCurve->setSamples(xaxis,smoothW,points);
-    standard->atissCurve->setSamples(xaxis,smoothAT,points);
-    standard->antissCurve->setSamples(xaxis,smoothANT,points);
-    standard->npCurve->setSamples(xaxis,smoothN,points);
-    standard->rvCurve->setSamples(xaxis,smoothRV,points);
-    standard->rcadCurve->setSamples(xaxis,smoothRCad,points);
-    standard->rgctCurve->setSamples(xaxis,smoothRGCT,points);
-    standard->gearCurve->setSamples(xaxis,smoothGear,points);
-    standard->smo2Curve->setSamples(xaxis,smoothSmO2,points);
-    standard->thbCurve->setSamples(xaxis,smoothtHb,points);
-    standard->o2hbCurve->setSamples(xaxis,smoothO2Hb,points);
-    standard->hhbCurve->setSamples(xaxis,smoothHHb,points);
-    standard->xpCurve->setSamples(xaxis,smoothX,points);
-    standard->apCurve->setSamples(xaxis,smoothL,points);
-    standard->hrCurve->setSamples(xaxis, smoothHR,points);
-    standard->tcoreCurve->setSamples(xaxis, smoothTCORE,points);
-    standard->speedCurve->setSamples(xaxis, smoothS, points);
-    standard->accelCurve->setSamples(xaxis, smoothAC, points);
-    standard->wattsDCurve->setSamples(xaxis, smoothWD, points);
-    standard->cadDCurve->setSamples(xaxis, smoothCD, points);
-    standard->nmDCurve->setSamples(xaxis, smoothND, points);
-    standard->hrDCurve->setSamples(xaxis, smoothHD, points);
-    standard->cadCurve->setSamples(xaxis, smoothC, points);
-    standard->altCurve->setSamples(xaxis, smoothA, points);
+    for(int k=0; k<standard->U.count(); k++) setPyramidSamples(standard->U[k].curve, plot->standard->U[k].curve, startidx, xaxis, smoothU[k], points);
+    setPyramidSamples(standard->wattsCurve, plot->standard->wattsCurve, startidx, xaxis, smoothW, points);
+    setPyramidSamples(standard->atissCurve, plot->standard->atissCurve, startidx, xaxis, smoothAT, points);
+    setPyramidSamples(standard->antissCurve, plot->standard->antissCurve, startidx, xaxis, smoothANT, points);
+    setPyramidSamples(standard->npCurve, plot->standard->npCurve, startidx, xaxis, smoothN, points);
+    setPyramidSamples(standard->rvCurve, plot->standard->rvCurve, startidx, xaxis, smoothRV, points);
+    setPyramidSamples(standard->rcadCurve, plot->standard->rcadCurve, startidx, xaxis, smoothRCad, points);
+    setPyramidSamples(standard->rgctCurve, plot->standard->rgctCurve, startidx, xaxis, smoothRGCT, points);
+    setPyramidSamples(standard->gearCurve, plot->standard->gearCurve, startidx, xaxis, smoothGear, points);
+    setPyramidSamples(standard->smo2Curve, plot->standard->smo2Curve, startidx, xaxis, smoothSmO2, points);
+    setPyramidSamples(standard->thbCurve, plot->standard->thbCurve, startidx, xaxis, smoothtHb, points);
+    setPyramidSamples(standard->o2hbCurve, plot->standard->o2hbCurve, startidx, xaxis, smoothO2Hb, points);
+    setPyramidSamples(standard->hhbCurve, plot->standard->hhbCurve, startidx, xaxis, smoothHHb, points);
+    setPyramidSamples(standard->xpCurve, plot->standard->xpCurve, startidx, xaxis, smoothX, points);
+    setPyramidSamples(standard->apCurve, plot->standard->apCurve, startidx, xaxis, smoothL, points);
+    setPyramidSamples(standard->hrCurve, plot->standard->hrCurve, startidx, xaxis, smoothHR, points);
+    setPyramidSamples(standard->tcoreCurve, plot->standard->tcoreCurve, startidx, xaxis, smoothTCORE, points);
+    setPyramidSamples(standard->speedCurve, plot->standard->speedCurve, startidx, xaxis, smoothS, points);
+    setPyramidSamples(standard->accelCurve, plot->standard->accelCurve, startidx, xaxis, smoothAC, points);
+    setPyramidSamples(standard->wattsDCurve, plot->standard->wattsDCurve, startidx, xaxis, smoothWD, points);
+    setPyramidSamples(standard->cadDCurve, plot->standard->cadDCurve, startidx, xaxis, smoothCD, points);
+    setPyramidSamples(standard->nmDCurve, plot->standard->nmDCurve, startidx, xaxis, smoothND, points);
+    setPyramidSamples(standard->hrDCurve, plot->standard->hrDCurve, startidx, xaxis, smoothHD, points);
+    setPyramidSamples(standard->cadCurve, plot->standard->cadCurve, startidx, xaxis, smoothC, points);
+    setPyramidSamples(standard->altCurve, plot->standard->altCurve, startidx, xaxis, smoothA, points);
     standard->altSlopeCurve->setSamples(xaxis, smoothA, points);
-    standard->slopeCurve->setSamples(xaxis, smoothSL, points);
-    standard->tempCurve->setSamples(xaxis, smoothTE, points);
+    setPyramidSamples(standard->slopeCurve, plot->standard->slopeCurve, startidx, xaxis, smoothSL, points);
+    setPyramidSamples(standard->tempCurve, plot->standard->tempCurve, startidx, xaxis, smoothTE, points);
 
     QVector<QwtIntervalSample> tmpWND(points);
     memcpy(tmpWND.data(), smoothRS, (points) * sizeof(QwtIntervalSample));
     standard->windCurve->setSamples(new QwtIntervalSeriesData(tmpWND));
-    standard->torqueCurve->setSamples(xaxis, smoothNM, points);
-    standard->balanceLCurve->setSamples(xaxis, smoothBALL, points);
-    standard->balanceRCurve->setSamples(xaxis, smoothBALR, points);
-    standard->lteCurve->setSamples(xaxis, smoothLTE, points);
-    standard->rteCurve->setSamples(xaxis, smoothRTE, points);
-    standard->lpsCurve->setSamples(xaxis, smoothLPS, points);
-    standard->rpsCurve->setSamples(xaxis, smoothRPS, points);
-    standard->lpcoCurve->setSamples(xaxis, smoothLPCO, points);
-    standard->rpcoCurve->setSamples(xaxis, smoothRPCO, points);
+    setPyramidSamples(standard->torqueCurve, plot->standard->torqueCurve, startidx, xaxis, smoothNM, points);
+    setPyramidSamples(standard->balanceLCurve, plot->standard->balanceLCurve, startidx, xaxis, smoothBALL, points);
+    setPyramidSamples(standard->balanceRCurve, plot->standard->balanceRCurve, startidx, xaxis, smoothBALR, points);
+    setPyramidSamples(standard->lteCurve, plot->standard->lteCurve, startidx, xaxis, smoothLTE, points);
+    setPyramidSamples(standard->rteCurve, plot->standard->rteCurve, startidx, xaxis, smoothRTE, points);
+    setPyramidSamples(standard->lpsCurve, plot->standard->lpsCurve, startidx, xaxis, smoothLPS, points);
+    setPyramidSamples(standard->rpsCurve, plot->standard->rpsCurve, startidx, xaxis, smoothRPS, points);
+    setPyramidSamples(standard->lpcoCurve, plot->standard->lpcoCurve, startidx, xaxis, smoothLPCO, points);
+    setPyramidSamples(standard->rpcoCurve, plot->standard->rpcoCurve, startidx, xaxis, smoothRPCO, points);
 
     QVector<QwtIntervalSample> tmpLDC(points);
     memcpy(tmpLDC.data(), smoothLPP, (points) * sizeof(QwtIntervalSample));
@@ -4087,10 +4189,9 @@ AllPlot::setDataFromPlot(AllPlot *plot)
             ourCurve->attach(this);
 
             // lets clone the data
-            QVector<QPointF> array;
-            for (size_t i=0; i<thereCurve->data()->size(); i++) array << thereCurve->data()->sample(i);
+            QVector<QPointF> array = curveSamples(thereCurve);
 
-            ourCurve->setSamples(array);
+            setPyramidSamples(ourCurve, array);
             ourCurve->setYAxis(QwtAxis::YLeft);
             ourCurve->setBaseline(thereCurve->baseline());
             ourCurve->setStyle(thereCurve->style());
@@ -4116,8 +4217,7 @@ AllPlot::setDataFromPlot(AllPlot *plot)
             ourCurve2->attach(this);
 
             // lets clone the data
-            QVector<QPointF> array;
-            for (size_t i=0; i<thereCurve2->data()->size(); i++) array << thereCurve2->data()->sample(i);
+            QVector<QPointF> array = curveSamples(thereCurve2);
 
             ourCurve2->setSamples(array);
             ourCurve2->setYAxis(QwtAxis::YLeft);
@@ -4187,9 +4287,9 @@ AllPlot::setDataFromPlot(AllPlot *plot)
 
             // minimum non-zero value... worst case its zero !
             double minNZ = 0.00f;
-            for (size_t i=0; i<thereCurve->data()->size(); i++) {
-                if (!minNZ) minNZ = thereCurve->data()->sample(i).y();
-                else if (thereCurve->data()->sample(i).y()<minNZ) minNZ = thereCurve->data()->sample(i).y();
+            foreach (QPointF p, curveSamples(thereCurve)) {
+                if (!minNZ) minNZ = p.y();
+                else if (p.y()<minNZ) minNZ = p.y();
             }
             setAxisScale(QwtAxis::YLeft, minNZ, thereCurve->maxYValue() + 0.10f);
 
@@ -4838,12 +4938,12 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
 
                     // lets clone the data
                     QVector<double> x,y;
-                    for (size_t i=0; i<thereCurve->data()->size(); i++) {
-                        x << thereCurve->data()->sample(i).x();
-                        y << thereCurve->data()->sample(i).y();
+                    foreach (QPointF p, curveSamples(thereCurve)) {
+                        x << p.x();
+                        y << p.y();
                     }
 
-                    ourCurve->setSamples(x,y);
+                    setPyramidSamples(ourCurve, x.constData(), y.constData(), x.count(), 0);
                     ourCurve->setYAxis(QwtAxis::YLeft);
                     ourCurve->setBaseline(thereCurve->baseline());
 
@@ -4878,8 +4978,7 @@ AllPlot::setDataFromPlots(QList<AllPlot *> plots)
                     ourCurve2->setPen(pen);
 
                     // lets clone the data
-                    QVector<QPointF> array;
-                    for (size_t i=0; i<thereCurve2->data()->size(); i++) array << thereCurve2->data()->sample(i);
+                    QVector<QPointF> array = curveSamples(thereCurve2);
 
                     ourCurve2->setSamples(array);
                     ourCurve2->setYAxis(QwtAxis::YLeft);
@@ -5128,7 +5227,7 @@ AllPlot::setDataFromObject(AllPlotObject *object, AllPlot *reference)
 
         if (!object->U[k].smooth.empty()) {
 
-            standard->U[k].curve->setSamples(xaxis.data(), object->U[k].smooth.data(), totalPoints);
+            setPyramidSamples(standard->U[k].curve, xaxis.data(), object->U[k].smooth.data(), totalPoints, 0);
             //XXXXHEREXXX
             standard->U[k].curve->attach(this);
             standard->U[k].curve->setVisible(true);
@@ -5136,7 +5235,7 @@ AllPlot::setDataFromObject(AllPlotObject *object, AllPlot *reference)
     }
 
     if (!object->wattsArray.empty()) {
-        standard->wattsCurve->setSamples(xaxis.data(), object->smoothWatts.data(), totalPoints);
+        setPyramidSamples(standard->wattsCurve, xaxis.data(), object->smoothWatts.data(), totalPoints, 0);
         standard->wattsCurve->attach(this);
         standard->wattsCurve->setVisible(true);
     }
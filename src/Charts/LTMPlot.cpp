@@ -26,6 +26,7 @@
 #include "LTMWindow.h"
 #include "RideMetric.h"
 #include "RideCache.h"
+#include "MetricAggregate.h"
 #include "RideFileCache.h"
 #include "Banister.h"
 #include "Estimator.h"
@@ -2668,7 +2669,6 @@ LTMPlot::createMetricData(Context *context, LTMSettings *settings, MetricDetail
     bool aggZero = metricDetail.metric ? metricDetail.metric->aggregateZero() : false;
     n=-1;
     int lastDay=0;
-    unsigned long secondsPerGroupBy=0;
     bool wantZero = forceZero ? 1 : (metricDetail.curveStyle == QwtPlotCurve::Steps);
 
     // curve specific filter
@@ -2676,23 +2676,53 @@ LTMPlot::createMetricData(Context *context, LTMSettings *settings, MetricDetail
     if (!SearchFilterBox::isNull(metricDetail.datafilter))
         spec.addMatches(SearchFilterBox::matches(context, metricDetail.datafilter));
 
-    //
-    double ymean_prev=0.0;
+    // sum totals, average averages and choose best for Peaks
+    int type = metricDetail.metric ? metricDetail.metric->type() : RideMetric::Average;
+    if (metricDetail.uunits == "Ramp" ||
+        metricDetail.uunits == tr("Ramp")) type = RideMetric::Total;
+    if (metricDetail.type == METRIC_BEST) type = RideMetric::Peak;
+
+    // the metric is looked up once, its values come from the metric matrix
+    RideMetricMatrix &matrix = context->athlete->rideCache->metricMatrix();
+    QVector<double> mvalues, mcounts, mmeans;
+    if (metricDetail.type != METRIC_META) {
+        const RideMetric *m = RideMetricFactory::instance().rideMetric(metricDetail.symbol);
+        if (m) {
+            mvalues = matrix.values(m->index());
+            if (type == RideMetric::StdDev) mmeans = matrix.stdmeans(m->index());
+        }
+    }
+    if (metricDetail.metric) mcounts = matrix.counts(metricDetail.metric->index());
+
+    // convert from stored metric value to imperial and seconds to hours
+    double conversion = 1.0, conversionSum = 0.0;
+    bool hours = false;
+    if (metricDetail.metric) {
+        if (GlobalContext::context()->useMetricUnits == false) {
+            conversion = metricDetail.metric->conversion();
+            conversionSum = metricDetail.metric->conversionSum();
+        }
+        hours = metricDetail.metric->units(true) == "seconds" ||
+                metricDetail.metric->units(true) == tr("seconds");
+    }
 
-    foreach (RideItem *ride, context->athlete->rideCache->rides()) { 
+    // gather the values to aggregate with the group they go in
+    QVector<double> values, counts, means;
+    QVector<int> groups;
+    const QVector<RideItem*> &rides = context->athlete->rideCache->rides();
+    for (int i=0; i<rides.count(); i++) {
+
+        RideItem *ride = rides[i];
 
         // filter out unwanted stuff
         if (!spec.pass(ride)) continue;
 
-        // day we are on
-        int currentDay = groupForDate(ride->dateTime.date(), settings->groupBy);
-
         // value for day
         double value;
         if (metricDetail.type == METRIC_META)
             value = ride->getText(metricDetail.name, "0.0").toDouble();
         else
-            value = ride->getForSymbol(metricDetail.symbol);
+            value = i < mvalues.count() ? mvalues[i] : 0;
 
         // check values are bounded to stop QWT going berserk
         if (std::isnan(value) || std::isinf(value)) value = 0;
@@ -2700,114 +2730,53 @@ LTMPlot::createMetricData(Context *context, LTMSettings *settings, MetricDetail
         // skip unavailable values
         if (value == RideFile::NA) continue;
 
-        // set aggZero to false and value to zero if is temperature and -255
-        if (metricDetail.metric && metricDetail.metric->symbol() == "average_temp" && value == RideFile::NA) {
-            value = 0;
-            aggZero = false;
-        }
-
         if (metricDetail.metric) {
-            // convert from stored metric value to imperial
-            if (GlobalContext::context()->useMetricUnits == false) {
-                value *= metricDetail.metric->conversion();
-                value += metricDetail.metric->conversionSum();
-            }
-
-            // convert seconds to hours
-            if (metricDetail.metric->units(true) == "seconds" ||
-                metricDetail.metric->units(true) == tr("seconds")) value /= 3600;
+            value *= conversion;
+            value += conversionSum;
+            if (hours) value /= 3600;
         }
 
         if (value || wantZero) {
-            unsigned long seconds = metricDetail.metric ? ride->getCountForSymbol(metricDetail.metric->symbol()) : 1;
-            if (currentDay > lastDay) {
-                if (lastDay && wantZero) {
-                    while (lastDay<currentDay && n<=maxdays) {
-                        lastDay++;
-                        n++;
-                        x[n]=lastDay - groupForDate(settings->start.date(), settings->groupBy);
-                        y[n]=0;
-                    }
-                } else {
-                    n++;
-                }
-
-                // drop out of roange
-                if (n>maxdays) break;
-                // first time thru
-                if (n<0) n=0;
+            values << value;
+            counts << (i < mcounts.count() ? double((unsigned long)(mcounts[i])) : 1);
+            means << (i < mmeans.count() ? mmeans[i] : 0);
+            groups << groupForDate(ride->dateTime.date(), settings->groupBy);
+        }
+    }
 
-                ymean_prev = ride->getStdMeanForSymbol(metricDetail.symbol);
+    // a value for each day, week, month etc that has rides
+    QVector<int> keys;
+    QVector<double> results;
+    MetricAggregate::grouped(type, values.constData(), counts.constData(),
+                             type == RideMetric::StdDev ? means.constData() : NULL,
+                             groups.constData(), values.count(), aggZero, keys, results);
 
-                y[n] = value;
-                x[n] = currentDay - groupForDate(settings->start.date(), settings->groupBy);
+    int start = groupForDate(settings->start.date(), settings->groupBy);
+    for (int k=0; k<keys.count(); k++) {
 
-                // only increment counter if nonzero or we aggregate zeroes
-                if (value || aggZero) secondsPerGroupBy = seconds; 
-                else secondsPerGroupBy = 0;
-
-            } else {
-                // sum totals, average averages and choose best for Peaks
-                int type = metricDetail.metric ? metricDetail.metric->type() : RideMetric::Average;
+        // day we are on
+        int currentDay = keys[k];
 
-                if (metricDetail.uunits == "Ramp" ||
-                    metricDetail.uunits == tr("Ramp")) type = RideMetric::Total;
+        if (lastDay && wantZero) {
+            while (lastDay<currentDay && n<=maxdays) {
+                lastDay++;
+                n++;
+                x[n]=lastDay - start;
+                y[n]=0;
+            }
+        } else {
+            n++;
+        }
 
-                if (metricDetail.type == METRIC_BEST) type = RideMetric::Peak;
+        // drop out of roange
+        if (n>maxdays) break;
+        // first time thru
+        if (n<0) n=0;
 
-                // first time thru
-                if (n<0) n=0;
+        y[n] = results[k];
+        x[n] = currentDay - start;
 
-                switch (type) {
-                case RideMetric::Total:
-                    y[n] += value;
-                    break;
-                case RideMetric::Average:
-                    {
-                    // average should be calculated taking into account
-                    // the duration of the ride, otherwise high value but
-                    // short rides will skew the overall average
-                    if (value || aggZero) y[n] = ((y[n]*secondsPerGroupBy)+(seconds*value)) / (secondsPerGroupBy+seconds);
-                    break;
-                    }
-                case RideMetric::Low:
-                    if (value < y[n]) y[n] = value;
-                    break;
-                case RideMetric::Peak:
-                    if (value > y[n]) y[n] = value;
-                    break;
-                case RideMetric::MeanSquareRoot:
-                    if (value) y[n] = sqrt((pow(y[n],2)*secondsPerGroupBy + pow(value,2)*seconds)/(secondsPerGroupBy+seconds));
-                    break;
-                case RideMetric::StdDev:
-                    if (value)
-                        {
-                            double ymean_next = ride->getStdMeanForSymbol(metricDetail.symbol);
-                            double ymean =  (secondsPerGroupBy*ymean_prev + ymean_next*seconds)/(secondsPerGroupBy + seconds);
-
-                            // Combining two standard deviations using
-                            // the formula:
-                            //
-                            //   sqrt(((n1-1)*S1^2+(n2-1)*S2^2+n1*(ymean_1-ymean)^2+n2*(ymean_2-ymean)^2)/(n1+n2))
-                            //
-                            // where:
-                            //
-                            //   ymean = (n1*ymean_1 + n2*ymean_2)/(n1+n2)
-
-                            y[n] = pow(y[n],2)*(secondsPerGroupBy-1) + pow(value,2)*(seconds-1);
-                            y[n] += pow(ymean_prev - ymean,2)*secondsPerGroupBy + pow(ymean_next - ymean,2)*seconds;
-                            y[n] /= (secondsPerGroupBy + seconds);
-                            y[n] = sqrt(y[n]);
-
-                            ymean_prev = ymean;
-                        }
-                    break;
-                }
-                // increment group counter if nonzero or we aggregate zeroes
-                if (value || aggZero) secondsPerGroupBy += seconds;
-            }
-            lastDay = currentDay;
-        }
+        lastDay = currentDay;
     }
 }
 
@@ -649,6 +649,23 @@ static const QStringList timeInZonesWBAL = QStringList()
         << "wtime_in_zone_L3"
         << "wtime_in_zone_L4";
 
+// the values of each metric for all rides, from the ride cache metric matrix
+static QVector<QVector<double> > metricColumns(Context *context, const QStringList &symbols)
+{
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    QVector<QVector<double> > returning;
+    foreach(QString symbol, symbols) {
+        const RideMetric *m = factory.rideMetric(symbol);
+        returning << (m ? context->athlete->rideCache->metricMatrix().values(m->index()) : QVector<double>());
+    }
+    return returning;
+}
+
+static double columnValue(const QVector<QVector<double> > &columns, int i, int ride)
+{
+    return (i < columns.count() && ride < columns[i].count()) ? columns[i][ride] : 0;
+}
+
 ZoneOverviewItem::ZoneOverviewItem(ChartSpace *parent, QString name, RideFile::seriestype series, bool polarized) : ChartSpaceItem(parent, name)
 {
     this->type = OverviewItemType::ZONE;
@@ -2146,9 +2163,22 @@ ZoneOverviewItem::setDateRange(DateRange dr)
     spec.setDateRange(dr);
     setFilter(this, spec);
 
+    // the zone metrics are looked up once, not for every ride
+    QStringList symbols;
+    switch(series) {
+    case RideFile::hr: symbols = polarized ? timeInZonesHRPolarized : timeInZonesHR; break;
+    default:
+    case RideFile::watts: symbols = polarized ? timeInZonesPolarized : timeInZones; break;
+    case RideFile::kph: symbols = polarized ? paceTimeInZonesPolarized : paceTimeInZones; break;
+    case RideFile::wbal: symbols = timeInZonesWBAL; break;
+    }
+    QVector<QVector<double> > zones = metricColumns(parent->context, symbols);
+
     // aggregate sum and count etc
-    foreach(RideItem *item, parent->context->athlete->rideCache->rides()) {
+    const QVector<RideItem*> &rides = parent->context->athlete->rideCache->rides();
+    for(int r=0; r<rides.count(); r++) {
 
+        RideItem *item = rides[r];
         if (!spec.pass(item)) continue;
 
         switch(series) {
@@ -2160,7 +2190,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
             {
                 if (polarized) {
                     for(int i=0; i<3; i++) {
-                        vals[i] += item->getForSymbol(timeInZonesHRPolarized[i]);
+                        vals[i] += columnValue(zones, i, r);
                     }
                 } else if (parent->context->athlete->hrZones(item->sport)) {
 
@@ -2171,7 +2201,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
 
                         numhrzones = parent->context->athlete->hrZones(item->sport)->numZones(hrrange);
                         for(int i=0; i<categories.count() && i < numhrzones;i++) {
-                            vals[i] += item->getForSymbol(timeInZonesHR[i]);
+                            vals[i] += columnValue(zones, i, r);
                         }
                     }
                 }
@@ -2186,7 +2216,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
             {
                 if (polarized) {
                     for(int i=0; i<3; i++) {
-                        vals[i] += item->getForSymbol(timeInZonesPolarized[i]);
+                        vals[i] += columnValue(zones, i, r);
                     }
                 } else if (parent->context->athlete->zones(item->sport)) {
 
@@ -2197,7 +2227,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
 
                         numzones = parent->context->athlete->zones(item->sport)->numZones(range);
                         for(int i=0; i<categories.count() && i < numzones;i++) {
-                            vals[i] += item->getForSymbol(timeInZones[i]);
+                            vals[i] += columnValue(zones, i, r);
                         }
                     }
                 }
@@ -2211,7 +2241,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
             {
                 if (polarized) {
                     for(int i=0; i<3; i++) {
-                        vals[i] += item->getForSymbol(paceTimeInZonesPolarized[i]);
+                        vals[i] += columnValue(zones, i, r);
                     }
                 } else if ((item->isRun || item->isSwim) && parent->context->athlete->paceZones(item->isSwim)) {
 
@@ -2222,7 +2252,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
 
                         numzones = parent->context->athlete->paceZones(item->isSwim)->numZones(range);
                         for(int i=0; i<categories.count() && i < numzones;i++) {
-                            vals[i] += item->getForSymbol(paceTimeInZones[i]);
+                            vals[i] += columnValue(zones, i, r);
                         }
                     }
                 }
@@ -2232,7 +2262,7 @@ ZoneOverviewItem::setDateRange(DateRange dr)
             case RideFile::wbal:
             {
                 for(int i=0; i<4; i++) {
-                    vals[i] += item->getForSymbol(timeInZonesWBAL[i]);
+                    vals[i] += columnValue(zones, i, r);
                 }
             }
             break;
@@ -1758,6 +1758,23 @@ RideEditor::endCommand(bool undo, RideCommand *cmd)
 
             break;
         }
+        case RideCommand::SetPointValues:
+        {
+            SetPointValuesCommand *spv = (SetPointValuesCommand*)cmd;
+
+            // the rows updated, only their extent matters
+            int column = model->columnFor(spv->series);
+            QModelIndex top = model->index(spv->rows.first(), column);
+            QModelIndex bottom = model->index(spv->rows.last(), column);
+
+            if (inLUW) { // see above
+                itemselection << top << bottom;
+            } else {
+                table->selectionModel()->setCurrentIndex(top, QItemSelectionModel::SelectCurrent);
+                table->selectionModel()->select(QItemSelection(top, bottom), QItemSelectionModel::SelectCurrent);
+            }
+            break;
+        }
         case RideCommand::InsertPoint:
         {
             InsertPointCommand *ip = (InsertPointCommand *)cmd;
@@ -1768,6 +1785,29 @@ RideEditor::endCommand(bool undo, RideCommand *cmd)
             }
             break;
         }
+        case RideCommand::InsertPoints:
+        {
+            // update the EditorData maps a block of rows at a time
+            InsertPointsCommand *ip = (InsertPointsCommand *)cmd;
+            if (undo) {
+                // from the bottom up, so the rows above don't move
+                for (int end=ip->rows.count(); end > 0;) {
+                    int start = end-1;
+                    while (start > 0 && ip->rows[start-1] == ip->rows[start]-1) start--;
+                    data->deleteRows(ip->rows[start], end-start);
+                    end = start;
+                }
+            } else {
+                // from the top down, rows are where they end up
+                for (int start=0; start < ip->rows.count();) {
+                    int end = start+1;
+                    while (end < ip->rows.count() && ip->rows[end] == ip->rows[end-1]+1) end++;
+                    data->insertRows(ip->rows[start], end-start);
+                    start = end;
+                }
+            }
+            break;
+        }
         case RideCommand::DeletePoint:
         {
             DeletePointCommand *dp = (DeletePointCommand *)cmd;
@@ -2883,17 +2923,19 @@ PasteSpecialDialog::okClicked()
         // ok. we are good to go, so overwrite target with source
         rideEditor->ride->ride()->command->startLUW("Paste Special");
 
-        for (int i = 0; i < target.rows; i++) {
+        for (int j = 0; j < target.columns; j++) {
 
-            for (int j = 0; j < target.columns; j++) {
+            // target column type...
+            RideFile::SeriesType what = rideEditor->model->columnType(target.column + j);
 
-                // target column type...
-                RideFile::SeriesType what = rideEditor->model->columnType(target.column + j);
+            // do we have that?
+            int sourceSeries = headings.indexOf(RideFile::seriesName(what));
+            if (sourceSeries != -1) { // YES, we have some
 
-                // do we have that?
-                int sourceSeries = headings.indexOf(RideFile::seriesName(what));
-                if (sourceSeries != -1) // YES, we have some
-                    rideEditor->ride->ride()->command->setPointValue(target.row+i, what, cells[i][sourceSeries]);
+                // the whole column in one go
+                QVector<double> values(target.rows);
+                for (int i = 0; i < target.rows; i++) values[i] = cells[i][sourceSeries];
+                rideEditor->ride->ride()->command->setPointValues(target.row, what, values);
             }
         }
 
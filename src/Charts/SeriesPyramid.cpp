@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "SeriesPyramid.h"
+
+#include <algorithm>
+
+const int SeriesPyramid::Break;
+
+SeriesPyramid::SeriesPyramid(const double *x, const double *y, int n) : gapped(false), gap(0), na(0)
+{
+    if (n < 0) n = 0;
+    xs.resize(n);
+    ys.resize(n);
+    std::copy(x, x+n, xs.begin());
+    std::copy(y, y+n, ys.begin());
+
+    levels.resize(1);
+
+    // each level from the one below, pairs of blocks at a time
+    for (int size=2; size/2 < n; size *= 2) {
+
+        int blocks = (n + size - 1) / size;
+        QVector<int> level(blocks * 2);
+
+        if (size == 2) {
+            for (int b=0; b<blocks; b++) {
+                int i = b*2, j = qMin(i+1, n-1);
+                level[b*2] = ys[j] < ys[i] ? j : i;
+                level[b*2+1] = ys[j] > ys[i] ? j : i;
+            }
+        } else {
+            const QVector<int> &below = levels.last();
+            int under = below.count() / 2;
+            for (int b=0; b<blocks; b++) {
+                int l = b*2, r = qMin(l+1, under-1);
+                int lmin = below[l*2], rmin = below[r*2];
+                int lmax = below[l*2+1], rmax = below[r*2+1];
+                level[b*2] = ys[rmin] < ys[lmin] ? rmin : lmin;
+                level[b*2+1] = ys[rmax] > ys[lmax] ? rmax : lmax;
+            }
+        }
+        levels << level;
+    }
+}
+
+void
+SeriesPyramid::setBreaks(double gap, double na)
+{
+    this->gapped = true;
+    this->gap = gap;
+    this->na = na;
+
+    // the same test QwtPlotGappedCurve makes, so nan is no data too
+    auto nodata = [na](double y) { return !(y < (na - 0.001) || y > (na + 0.001)); };
+
+    int n = count();
+    breaks.resize(n);
+    for (int i=0; i<n; i++) {
+        bool joined = i && !nodata(ys[i]) && !nodata(ys[i-1]) && xs[i] - xs[i-1] <= gap;
+        breaks[i] = (i ? breaks[i-1] : 0) + ((i && !joined) ? 1 : 0);
+    }
+}
+
+int
+SeriesPyramid::lowerBound(double value) const
+{
+    return std::lower_bound(xs.begin(), xs.end(), value) - xs.begin();
+}
+
+void
+SeriesPyramid::range(int from, int to, int &min, int &max) const
+{
+    min = max = from;
+
+    // the largest aligned block that fits at each step
+    for (int i=from; i<to; ) {
+        int k = 0;
+        while (k+1 < levels.count() && (i & ((2<<k)-1)) == 0 && i + (2<<k) <= to) k++;
+
+        int lo = i, hi = i;
+        if (k) {
+            lo = levels[k][(i>>k)*2];
+            hi = levels[k][(i>>k)*2+1];
+        }
+        if (ys[lo] < ys[min]) min = lo;
+        if (ys[hi] > ys[max]) max = hi;
+        i += 1<<k;
+    }
+}
+
+void
+SeriesPyramid::decimate(int from, int to, int buckets, QVector<int> &indices) const
+{
+    indices.clear();
+    from = qMax(from, 0);
+    to = qMin(to, count());
+    if (from >= to) return;
+
+    // few enough to draw them all
+    if (to - from <= 2 * buckets) {
+        indices.reserve(to - from);
+        for (int i=from; i<to; i++) indices << i;
+        if (gapped) markBreaks(indices);
+        return;
+    }
+
+    // blocks no more than buckets of them
+    int k = 1;
+    while (k+1 < levels.count() && ((to - from) >> k) > buckets) k++;
+    int size = 1<<k;
+
+    indices.reserve((gapped ? 8 : 2) * ((to - from) / size + 2) + 2);
+    indices << from;
+
+    for (int i=from; i<to; ) {
+
+        int end = qMin((i / size + 1) * size, to);
+        int lo, hi;
+        if (i % size == 0 && end == qMin(i + size, count())) {
+            lo = levels[k][(i>>k)*2];
+            hi = levels[k][(i>>k)*2+1];
+        } else {
+            range(i, end, lo, hi); // part of a block at either end
+        }
+
+        int keep[4] = { lo, hi };
+        int keeping = 2;
+
+        // the line runs into the block up to its first break and out of
+        // it from its last, so keep the samples either side of those; a
+        // break between this block and the last one counts as in this one
+        int before = qMax(i-1, 0);
+        if (gapped && breaks[end-1] > breaks[before]) {
+            QVector<int>::const_iterator inside = breaks.constBegin() + before + 1, after = breaks.constBegin() + end;
+            keep[keeping++] = int(std::lower_bound(inside, after, breaks[before] + 1) - breaks.constBegin()) - 1;
+            keep[keeping++] = int(std::lower_bound(inside, after, breaks[end-1]) - breaks.constBegin());
+        }
+        std::sort(keep, keep + keeping);
+
+        // in order, once
+        for (int j=0; j<keeping; j++) if (keep[j] > indices.last()) indices << keep[j];
+        i = end;
+    }
+
+    if (indices.last() != to-1) indices << to-1;
+    if (gapped) markBreaks(indices);
+}
+
+void
+SeriesPyramid::markBreaks(QVector<int> &indices) const
+{
+    QVector<int> marked;
+    marked.reserve(indices.count() * 2);
+    for (int k=0; k<indices.count(); k++) {
+        if (k && breaks[indices[k]] > breaks[indices[k-1]]) marked << Break;
+        marked << indices[k];
+    }
+    indices.swap(marked);
+}
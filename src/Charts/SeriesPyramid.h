@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_SeriesPyramid_h
+#define _GC_SeriesPyramid_h 1
+
+#include <QVector>
+
+//
+// Min/max pyramid for a plotted series, so a curve only has to draw a
+// couple of points for each pixel however many samples are visible.
+//
+// Level k holds the index of the smallest and largest y for each block of
+// 2^k samples, built once from the level below. Drawing a range uses the
+// level whose blocks give no more than the number of buckets asked for and
+// keeps both the min and max of each block, so peaks are never lost; the
+// blocks at either end of the range are worked out from the blocks that fit
+// inside it. Zooming in just picks a lower level over fewer samples.
+//
+// x must be ascending (time or distance).
+//
+// A gapped curve only joins samples that are close enough and neither of
+// which is its "no data" value, decimated samples are further apart than
+// that. With setBreaks() the pyramid counts where those breaks fall and
+// decimate() puts a Break between samples that have one between them, and
+// keeps the samples either side of the breaks in each block, so the curve
+// can split on the Breaks alone and still join the runs across blocks.
+//
+class SeriesPyramid
+{
+    public:
+
+        SeriesPyramid(const double *x, const double *y, int n);
+
+        int count() const { return xs.count(); }
+        double x(int i) const { return xs[i]; }
+        double y(int i) const { return ys[i]; }
+
+        // a curve that doesn't join samples more than gap apart in x, or
+        // either of which is within 0.001 of na, as QwtPlotGappedCurve
+        void setBreaks(double gap, double na);
+        bool hasBreaks() const { return gapped; }
+        double breakValue() const { return na; } // y to draw a Break at
+
+        // in the decimated indices, between two samples that aren't joined
+        static const int Break = -1;
+
+        // first sample with x >= value
+        int lowerBound(double value) const;
+
+        // samples with the smallest and largest y in from..to-1
+        void range(int from, int to, int &min, int &max) const;
+
+        // the samples to draw from..to-1, in order, about two per bucket
+        // and always including the first and last, with Breaks if set
+        void decimate(int from, int to, int buckets, QVector<int> &indices) const;
+
+    private:
+
+        void markBreaks(QVector<int> &indices) const;
+
+        QVector<double> xs, ys;
+        QVector<QVector<int> > levels;  // [k] min, max for each block of 2^k, [0] unused
+
+        bool gapped;
+        double gap, na;
+        QVector<int> breaks;            // [i] breaks between samples 0..i
+};
+#endif // _GC_SeriesPyramid_h
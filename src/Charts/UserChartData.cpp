@@ -97,11 +97,7 @@ UserChartData::compute(RideItem *item, Specification spec, DateRange dr)
     } else {
         if (!spec.isEmpty(item->ride()) && fsample) {
             RideFileIterator it(item->ride(), spec);
-
-            while(it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                root->eval(rt, fsample, Result(0), 0, const_cast<RideItem*>(item), point, NULL, spec, dr);
-            }
+            root->evalSamples(rt, fsample, it, const_cast<RideItem*>(item), NULL, spec, dr);
         }
 
     }
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+// The parts of the ride list that need nothing more than the snapshot and
+// the request: the rides in a date range, the columns of each row and the
+// etags all the endpoints use so polling clients can skip what they have
+
+#include "APIWebService.h"
+
+#include <QCryptographicHash>
+#include <algorithm>
+
+void
+APIRideSnapshot::range(QDate since, QDate before, QVector<ride>::const_iterator &from, QVector<ride>::const_iterator &to) const
+{
+    from = rides.constBegin();
+    to = rides.constEnd();
+    if (!sorted) return;
+
+    from = std::lower_bound(from, to, since, [](const ride &r, const QDate &d) { return r.date < d; });
+    to = std::upper_bound(from, to, before, [](const QDate &d, const ride &r) { return d < r.date; });
+}
+
+QByteArray
+APIWebService::rideLine(const APIRideSnapshot::ride &ride, const listRideSettings &settings)
+{
+    // date, time, filename
+    QByteArray line;
+    line += ride.date.toString("yyyy/MM/dd").toLocal8Bit();
+    line += ",";
+    line += ride.time.toString("hh:mm:ss").toLocal8Bit();
+    line += ",";
+    line += ride.fileName.toLocal8Bit();
+
+    if (settings.wanted.count()) {
+        // specific metrics
+        foreach(int index, settings.wanted) {
+            double value = ride.metrics[index];
+            line += ",";
+            line += QString("%1").arg(value, 'f').simplified().toLocal8Bit();
+        }
+    } else {
+
+        // all metrics...
+        foreach(double value, ride.metrics) {
+            line += ",";
+            line += QString("%1").arg(value, 'f').simplified().toLocal8Bit();
+        }
+    }
+
+    // all the metadata asked for
+    foreach(QString name, settings.metawanted) {
+
+        // Start Date and Time are special cases, as RideItem::getText()
+        QString text;
+        if (name == "Start Date") text = QString::number(QDate(1900,01,01).daysTo(ride.date));
+        else if (name == "Start Time") text = QString::number(QTime(0,0,0).secsTo(ride.time));
+        else text = ride.metadata.value(name, "");
+
+        text.replace("\"","'");   // don't use double quotes...
+        text.replace("\n","\\n"); // newlines
+        text.replace("\r","\\r"); // carriage returns
+        text.replace("\t","\\t"); // tabs
+
+        line += ",\"";
+        line += text.toLocal8Bit();
+        line += "\"";
+    }
+
+    line += "\n";
+    return line;
+}
+
+QByteArray
+APIWebService::etag(HttpRequest &request, QString version)
+{
+    // the same request for the same version of the data
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(request.getPath());
+    QMultiMap<QByteArray,QByteArray> parameters = request.getParameterMap();
+    QMultiMap<QByteArray,QByteArray>::const_iterator it = parameters.constBegin();
+    for (; it != parameters.constEnd(); ++it) {
+        hash.addData("&" + it.key() + "=" + it.value());
+    }
+    hash.addData("#" + version.toUtf8());
+
+    return "\"" + hash.result().toHex() + "\"";
+}
+
+bool
+APIWebService::notModified(HttpRequest &request, HttpResponse &response, QByteArray etag)
+{
+    response.setHeader("ETag", etag);
+
+    // header names are as sent, so could be any case
+    QMultiMap<QByteArray,QByteArray> headers = request.getHeaderMap();
+    QMultiMap<QByteArray,QByteArray>::const_iterator it = headers.constBegin();
+    for (; it != headers.constEnd(); ++it) {
+        if (it.key().toLower() != "if-none-match") continue;
+
+        foreach(QByteArray tag, it.value().split(',')) {
+            tag = tag.trimmed();
+            if (tag.startsWith("W/")) tag = tag.mid(2);
+            if (tag == etag || tag == "*") {
+                response.setStatus(304, "Not Modified");
+                response.write(QByteArray(), true);
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -33,6 +33,8 @@
 
 #include <QTemporaryFile>
 #include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
 
 void
 APIWebService::service(HttpRequest &request, HttpResponse &response)
@@ -72,8 +74,7 @@ APIWebService::athleteData(QStringList &paths, HttpRequest &request, HttpRespons
         response.write("missing athlete.");
         return;
     } else {
-        QFile ridedb(home.absolutePath() + "/" + paths[0] + "/cache/rideDB.json");
-        if (!ridedb.exists()) {
+        if (!hasRideDB(paths[0])) {
             response.setStatus(404); // malformed URL
             response.setHeader("Content-Type", "text; charset=ISO-8859-1");
             response.write("unknown athlete " + paths[0].toLocal8Bit());
@@ -159,6 +160,13 @@ APIWebService::athleteData(QStringList &paths, HttpRequest &request, HttpRespons
     response.write("malformed url");
 }
 
+bool
+APIWebService::hasRideDB(QString athlete) const
+{
+    QString cache = home.absolutePath() + "/" + athlete + "/cache/";
+    return QFile(cache + "rideDB.bin").exists() || QFile(cache + "rideDB.json").exists();
+}
+
 void
 APIWebService::listAthletes(HttpRequest &, HttpResponse &response)
 {
@@ -174,8 +182,7 @@ APIWebService::listAthletes(HttpRequest &, HttpResponse &response)
 
         // sure fire sign the athlete has been upgraded to post 3.2 and not some
         // random directory full of other things & check something basic is set
-        QString ridedb = home.absolutePath() + "/" + name + "/cache/rideDB.json";
-        if (QFile(ridedb).exists()) {
+        if (hasRideDB(name)) {
             // we need to initialize athlete settings for cvalue to work
             appsettings->initializeQSettingsAthlete(home.absolutePath(), name);
             if (appsettings->cvalue(name, GC_SEX, "") == "") continue;
@@ -195,104 +202,21 @@ APIWebService::listAthletes(HttpRequest &, HttpResponse &response)
 }
 
 
-void 
-APIWebService::writeRideLine(RideItem &item, HttpRequest *request, HttpResponse *response)
+bool
+APIWebService::cached(QByteArray etag, QByteArray &body)
 {
+    QMutexLocker locker(&lock);
+    QByteArray *have = responses.object(etag);
+    if (have == NULL) return false;
+    body = *have;
+    return true;
+}
 
-    // honour the since parameter
-    QString sincep(request->getParameter("since"));
-    QDate since(1900,01,01);
-    if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
-
-    // before parameter
-    QString beforep(request->getParameter("before"));
-    QDate before(3000,01,01);
-    if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
-
-    // in range?
-    if (item.dateTime.date() < since) return;
-    if (item.dateTime.date() > before) return;
-
-    // are we doing rides or intervals?
-    listRideSettings *settings = static_cast<listRideSettings *>(response->userData());
-
-    if (settings->intervals == true) {
-
-        // loop through all available intervals for this ride item
-        foreach(IntervalItem *interval, item.intervals()){ 
-
-            // date, time, filename
-            response->bwrite(item.dateTime.date().toString("yyyy/MM/dd").toLocal8Bit());
-            response->bwrite(", ");
-            response->bwrite(item.dateTime.time().toString("hh:mm:ss").toLocal8Bit());;
-            response->bwrite(", ");
-            response->bwrite(item.fileName.toLocal8Bit());
-
-            // now the interval name and type
-            response->bwrite(", \"");
-            response->bwrite(interval->name.toLocal8Bit());
-            response->bwrite("\", ");
-            response->bwrite(QString("%1").arg(static_cast<int>(interval->type)).toLocal8Bit());
-
-            // essentially the same as below .. cut and paste (refactor?XXX)
-            if (settings->wanted.count()) {
-                // specific metrics
-                foreach(int index, settings->wanted) {
-                    double value = interval->metrics()[index];
-                    response->bwrite(",");
-                    response->bwrite(QString("%1").arg(value, 'f').simplified().toLocal8Bit());
-                }
-            } else {
-    
-                // all metrics...
-                foreach(double value, interval->metrics()) {
-                    response->bwrite(",");
-                    response->bwrite(QString("%1").arg(value, 'f').simplified().toLocal8Bit());
-                }
-            }
-            response->bwrite("\n");
-        }
-
-    } else {
-
-        // date, time, filename
-        response->bwrite(item.dateTime.date().toString("yyyy/MM/dd").toLocal8Bit());
-        response->bwrite(",");
-        response->bwrite(item.dateTime.time().toString("hh:mm:ss").toLocal8Bit());;
-        response->bwrite(",");
-        response->bwrite(item.fileName.toLocal8Bit());
-
-        if (settings->wanted.count()) {
-            // specific metrics
-            foreach(int index, settings->wanted) {
-                double value = item.metrics()[index];
-                response->bwrite(",");
-                response->bwrite(QString("%1").arg(value, 'f').simplified().toLocal8Bit());
-            }
-        } else {
-    
-            // all metrics...
-            foreach(double value, item.metrics()) {
-                response->bwrite(",");
-                response->bwrite(QString("%1").arg(value, 'f').simplified().toLocal8Bit());
-            }
-        }
-
-        // all the metadata asked for
-        foreach(QString name, settings->metawanted) {
-            QString text = item.getText(name,"");
-            text.replace("\"","'");   // don't use double quotes...
-            text.replace("\n","\\n"); // newlines
-            text.replace("\r","\\r"); // carriage returns
-            text.replace("\t","\\t"); // tabs
-
-            response->bwrite(",\"");
-            response->bwrite(text.toLocal8Bit());
-            response->bwrite("\"");
-        }
-
-        response->bwrite("\n");
-    }
+void
+APIWebService::cache(QByteArray etag, const QByteArray &body)
+{
+    QMutexLocker locker(&lock);
+    responses.insert(etag, new QByteArray(body), 1 + body.size() / 1024);
 }
 
 void
@@ -301,7 +225,6 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
     // does it exist ?
     QString filename = QString("%1/%2/activities/%3").arg(home.absolutePath()).arg(athlete).arg(paths[0]);
 
-    QString contents;
     QFile file(filename);
     if (file.exists() && file.open(QFile::ReadOnly | QFile::Text)) {
 
@@ -356,6 +279,18 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
             if (format == "pwx") response.setHeader("Content-Type", "application/vnd.trainingpeaks.pwx+xml; charset=ISO-8859-1");
         }
 
+        // the same file in the same format, we may not need to send
+        // it again, or might have it to hand
+        QFileInfo info(filename);
+        QByteArray tag = etag(request, QString("%1-%2-%3").arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size()).arg(format));
+        if (notModified(request, response, tag)) return;
+
+        QByteArray body;
+        if (cached(tag, body)) {
+            response.write(body, true);
+            return;
+        }
+
         // lets read the file in as a ridefile
         QStringList errors;
         RideFile *f = RideFileFactory::instance().openRideFile(NULL, file, errors);
@@ -392,14 +327,13 @@ APIWebService::listActivity(QString athlete, QStringList paths, HttpRequest &req
 
         if (success) {
 
-            // read in the whole thing
+            // send it as it is read back, keeping it for next time
+            APIResponseBody sending(response);
             out.open(QFile::ReadOnly | QFile::Text);
-            QTextStream in(&out);
-            contents = in.readAll();
+            while (!out.atEnd()) sending.write(out.read(40960));
             out.close();
 
-            // write back in one hit
-            response.write(contents.toLocal8Bit(), true);
+            if (sending.finish()) cache(tag, sending.kept);
             return;
 
         } else {
@@ -446,13 +380,32 @@ APIWebService::listMMP(QString athlete, QStringList paths, HttpRequest &request,
     }
 
     QString filename=paths[0];
+    QString CPXfilename = home.absolutePath() + "/" + athlete + "/cache/" + QFileInfo(filename).completeBaseName() + ".cpx";
 
+    // bests change when the rides are refreshed, which updates the ride
+    // cache, otherwise they come from the ride's .cpx
+    QString version;
     if (paths[0] == "bests") {
+        QSharedPointer<const APIRideSnapshot> rides = snapshot(athlete);
+        version = rides ? rides->version : QString();
+    } else {
+        QFileInfo info(CPXfilename);
+        version = QString("%1-%2").arg(info.exists() ? info.lastModified().toMSecsSinceEpoch() : 0).arg(info.size());
+    }
+    QByteArray tag = etag(request, version);
+    if (notModified(request, response, tag)) return;
+
+    QByteArray body;
+    if (cached(tag, body)) {
+        response.write(body, true);
+        return;
+    }
 
-        // header
-        response.bwrite("secs, ");
-        response.bwrite(seriesp.toLocal8Bit());
-        response.bwrite("\n");
+    // header
+    APIResponseBody sending(response);
+    sending.write("secs, " + seriesp.toLocal8Bit() + "\n");
+
+    if (paths[0] == "bests") {
 
         // honour the since parameter
         QString sincep(request.getParameter("since"));
@@ -466,28 +419,22 @@ APIWebService::listMMP(QString athlete, QStringList paths, HttpRequest &request,
 
         int secs=0;
         foreach(float value, RideFileCache::meanMaxFor(home.absolutePath() + "/" + athlete + "/cache", series, since, before)) {
-            if (secs >0) response.bwrite(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
+            if (secs >0) sending.write(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
             secs++;
         }
 
-
     } else {
-        QString CPXfilename = home.absolutePath() + "/" + athlete + "/cache/" + QFileInfo(filename).completeBaseName() + ".cpx";
-
-        // header
-        response.bwrite("secs, ");
-        response.bwrite(seriesp.toLocal8Bit());
-        response.bwrite("\n");
 
         if (QFileInfo(CPXfilename).exists()) {
             int secs=0;
             foreach(float value, RideFileCache::meanMaxFor(CPXfilename, series)) {
-                if (secs >0) response.bwrite(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
+                if (secs >0) sending.write(QString("%1, %2\n").arg(secs).arg(value).toLocal8Bit());
                 secs++;
             }
         }
-        response.flush();
     }
+
+    if (sending.finish()) cache(tag, sending.kept);
 }
 
 void
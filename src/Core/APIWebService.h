@@ -23,6 +23,9 @@
 #include "RideItem.h"
 #include "RideMetadata.h"
 #include <QDir>
+#include <QMutex>
+#include <QCache>
+#include <QSharedPointer>
 
 struct listRideSettings {
     bool intervals;
@@ -31,13 +34,59 @@ struct listRideSettings {
     QList<QString> metawanted; // metadata to list
 };
 
+// the rides in an athlete's ride cache, read from cache/rideDB.bin (or an
+// older rideDB.json) once and kept until it changes, so polling the api
+// doesn't read it every time
+struct APIRideSnapshot {
+
+    struct ride {
+        QDate date;
+        QTime time;
+        QString fileName;
+        QVector<double> metrics;
+        QMap<QString, QString> metadata;
+    };
+
+    QString version;        // file read, its modified time and size
+    QVector<ride> rides;    // in date order
+    bool sorted;            // by date, so a date range can be found quickly
+
+    // the rides from since to before inclusive, or all of them if not sorted
+    void range(QDate since, QDate before, QVector<ride>::const_iterator &from, QVector<ride>::const_iterator &to) const;
+};
+
+// a body written out as it is rendered, keeping a copy for the
+// response cache while it is small enough to be worth keeping
+struct APIResponseBody {
+
+    static const int keepMax = 4 * 1024 * 1024;
+
+    APIResponseBody(HttpResponse &response) : response(response), keeping(true) {}
+
+    void write(const QByteArray &data) {
+        response.bwrite(data);
+        if (!keeping) return;
+        if (kept.size() + data.size() > keepMax) {
+            keeping = false;
+            kept.clear();
+        } else kept += data;
+    }
+
+    // send what is left, true if all of it was kept
+    bool finish() { response.flush(); return keeping; }
+
+    HttpResponse &response;
+    QByteArray kept;
+    bool keeping;
+};
+
 class APIWebService : public HttpRequestHandler
 {
 
     public:
 
-        // nothing to do in constructor
-        APIWebService(QDir home, QObject *parent=NULL) : HttpRequestHandler(parent), home(home) {}
+        // rendered responses are cached up to 64MB (cost is in KB)
+        APIWebService(QDir home, QObject *parent=NULL) : HttpRequestHandler(parent), home(home), responses(64*1024) {}
 
         // request despatchers
         void service(HttpRequest &request, HttpResponse &response);
@@ -52,10 +101,30 @@ class APIWebService : public HttpRequestHandler
         void listMeasures(QString athlete, QStringList paths, HttpRequest &request, HttpResponse &response);
 
         // utility
-        void writeRideLine(RideItem &item, HttpRequest *request, HttpResponse *response);
+        void collectRide(RideItem &item, APIRideSnapshot *snapshot); // called by the RideDB parser
+        static QByteArray rideLine(const APIRideSnapshot::ride &ride, const listRideSettings &settings);
+
+        // rides for the athlete, read again if the cache changed; NULL if there is none
+        QSharedPointer<const APIRideSnapshot> snapshot(QString athlete);
+
+        // conditional requests; the etag is for the request and the version of the data
+        // it is from, returns true (having responded) if the client already has it
+        static QByteArray etag(HttpRequest &request, QString version);
+        static bool notModified(HttpRequest &request, HttpResponse &response, QByteArray etag);
+
+        // rendered bodies, no bigger than APIResponseBody keeps
+        bool cached(QByteArray etag, QByteArray &body);
+        void cache(QByteArray etag, const QByteArray &body);
+
+        // does the athlete have a ride cache, binary or json
+        bool hasRideDB(QString athlete) const;
 
     private:
         QDir home;
+
+        QMutex lock;
+        QHash<QString, QSharedPointer<const APIRideSnapshot> > snapshots;
+        QCache<QByteArray, QByteArray> responses;
 };
 
 #endif
@@ -26,6 +26,8 @@
 #include "RideCache.h"
 #include "Estimator.h"
 #include "RideFileCache.h"
+#include "MeanMaxIndex.h"
+#include "FreeSearch.h"
 #include "RideMetric.h"
 #include "Settings.h"
 #include "TimeUtils.h"
@@ -169,9 +171,16 @@ Athlete::Athlete(Context *context, const QDir &homeDir)
     cloudAutoDownload = new CloudServiceAutoDownload(context);
     connect(context, SIGNAL(refreshEnd()), cloudAutoDownload, SLOT(autoDownload()));
 
+    // aggregated bests for weeks, months and years
+    meanmaxIndex = new MeanMaxIndex(context);
+
+    // search index for metadata, loaded when first used
+    freeSearchIndex = new FreeSearchIndex(context);
+
     // now most dependencies are in get cache
     QEventLoop loop;
     rideCache = new RideCache(context);
+    freeSearchIndex->connectRideCache(rideCache);
     connect(rideCache, SIGNAL(loadComplete()), &loop, SLOT(quit()));
     connect(rideCache, SIGNAL(loadComplete()), this, SLOT(loadComplete()));
 
@@ -239,6 +248,8 @@ Athlete::~Athlete()
 {
     // close the ride cache down first
     delete rideCache;
+    delete meanmaxIndex;
+    delete freeSearchIndex;
 
     // save those preset charts
     LTMSettings reader;
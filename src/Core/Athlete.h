@@ -44,6 +44,8 @@ class Seasons;
 class RideNavigator;
 class NamedSearches;
 class RideFileCache;
+class MeanMaxIndex;
+class FreeSearchIndex;
 class RideItem;
 class IntervalItem;
 class IntervalTreeView;
@@ -93,6 +95,8 @@ class Athlete : public QObject
         Seasons *seasons;
         Routes *routes;
         QList<RideFileCache*> cpxCache;
+        MeanMaxIndex *meanmaxIndex; // pre-aggregated bests for date ranges
+        FreeSearchIndex *freeSearchIndex; // metadata and interval names
         RideCache *rideCache;
         Measures *measures;
 
@@ -57,6 +57,9 @@ GlobalContext::notifyConfigChanged(qint32 state)
 {
     QApplication::setOverrideCursor(Qt::WaitCursor);
 
+    // settings threads have read are stale
+    GSettingsSnapshot::invalidate();
+
     // read it in - global only
     readConfig(state);
 
@@ -219,6 +219,7 @@ class Context : public QObject
 
         // realtime signals
         void notifyTelemetryUpdate(const RealtimeData &rtData) { telemetryUpdate(rtData); }
+        void notifySessionBests(const QVector<float> &bests) { sessionBests(bests); }
         void notifyErgFileSelected(ErgFile *x) { workout=x; ergFileSelected(x); ergFileSelected((ErgFileBase*)(x));}
         void notifyVideoSyncFileSelected(VideoSyncFile *x) { videosync=x; videoSyncFileSelected(x); }
         ErgFile *currentErgFile() { return workout; }
@@ -361,6 +362,7 @@ class Context : public QObject
 
         // realtime
         void telemetryUpdate(const RealtimeData &rtData);
+        void sessionBests(const QVector<float> &bests); // best watts for each duration in secs
         void ergFileSelected(ErgFile *);
         void ergFileSelected(ErgFileBase *);
         void videoSyncFileSelected(VideoSyncFile *);
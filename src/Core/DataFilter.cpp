@@ -19,6 +19,7 @@
 #include "Utils.h"
 #include "Statistic.h"
 #include "DataFilter.h"
+#include "DataFilterProgram.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "RideItem.h"
@@ -1769,6 +1770,12 @@ void Leaf::clear(Leaf *leaf)
 {
     if (leaf == NULL) return; // critical to avoid crashes
 
+    // compiled programs go with the tree
+    delete leaf->program;
+    leaf->program = NULL;
+    delete leaf->vector;
+    leaf->vector = NULL;
+
     switch(leaf->type) {
     case Leaf::Script :
     case Leaf::String : delete leaf->lvalue.s; break;
@@ -3337,6 +3344,9 @@ DataFilter::DataFilter(QObject *parent, Context *context, QString formula) : QOb
     else
         treeRoot=NULL;
 
+    // compile what we can to bytecode
+    if (treeRoot && DataFiltererrors.count() == 0) DataFilterProgram::compile(&rt, treeRoot);
+
     errors = DataFiltererrors;
 }
 
@@ -3430,7 +3440,7 @@ QStringList DataFilter::check(QString query)
         // no errors just failed to finish
         if (!treeRoot) DataFiltererrors << tr("malformed expression.");
 
-    }
+    } else DataFilterProgram::compile(&rt, treeRoot);
 
     errors = DataFiltererrors;
     return errors;
@@ -3478,6 +3488,9 @@ QStringList DataFilter::parseFilter(Context *context, QString query, QStringList
 
         rt.isdynamic = treeRoot->isDynamic(treeRoot);
 
+        // compile what we can to bytecode
+        DataFilterProgram::compile(&rt, treeRoot);
+
         // successfully parsed, lets check semantics
         //treeRoot->print(0,NULL);
         emit parseGood();
@@ -3616,11 +3629,35 @@ static int monthsTo(QDate from, QDate to)
     return months;
 }
 
+void Leaf::evalSamples(DataFilterRuntime *df, Leaf *leaf, RideFileIterator samples, RideItem *m, const QHash<QString,RideMetric*> *c, const Specification &s, const DateRange &d)
+{
+    samples.toFront();
+    if (!leaf || !samples.hasNext()) return;
+
+    // all at once when we can
+    if (leaf->vector && m && m->ride(false)) {
+        RideFile *f = m->ride(false);
+        RideFileColumnsPtr columns = f->columns(leaf->vector->columnsRead());
+        if (columns->count() == f->dataPoints().count() &&
+            leaf->vector->runColumns(df, m, *columns, samples.firstIndex(), samples.lastIndex(), c))
+            return;
+    }
+
+    // otherwise one at a time
+    while(samples.hasNext()) {
+        struct RideFilePoint *point = samples.next();
+        eval(df, leaf, Result(0), 0, m, point, c, s, d);
+    }
+}
+
 Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, const Result &x, long it, RideItem *m, RideFilePoint *p, const QHash<QString,RideMetric*> *c, const  Specification &s, const DateRange &d)
 {
     // Avoid crash on NULL leaf
     if (!leaf) return Result(0);
 
+    // compiled to bytecode, run it if we can
+    if (leaf->program && leaf->program->runnable(df, m, p)) return Result(leaf->program->run(df, m, p, c));
+
     switch(leaf->type) {
 
     //
@@ -4940,11 +4977,32 @@ Result Leaf::eval(DataFilterRuntime *df, Leaf *leaf, const Result &x, long it, R
 
                         // spec may limit to an interval
                         RideFileIterator it(m->ride(), s);
-                        while(it.hasNext()) {
-                            struct RideFilePoint *p = it.next();
-                            double value=p->value(leaf->seriesType);
-                            returning.number() += value;
-                            returning.asNumeric().append(value);
+
+                        // straight from the column when it's held in one
+                        RideFileColumnsPtr columns;
+                        if (RideFileColumns::isStored(leaf->seriesType) && it.hasNext())
+                            columns = m->ride()->columns(QList<RideFile::SeriesType>() << leaf->seriesType);
+                        if (columns && columns->count() == m->ride()->dataPoints().count()) {
+
+                            const int from = it.firstIndex();
+                            const int n = it.lastIndex() - from + 1;
+                            const double *column = columns->column(leaf->seriesType);
+
+                            QVector<double> &values = returning.asNumeric();
+                            values.resize(n);
+                            if (column) memcpy(values.data(), column + from, n * sizeof(double));
+                            else values.fill(RideFileColumns::defaultValue(leaf->seriesType));
+
+                            for(int i=0; i<n; i++) returning.number() += values.at(i);
+
+                        } else {
+
+                            while(it.hasNext()) {
+                                struct RideFilePoint *p = it.next();
+                                double value=p->value(leaf->seriesType);
+                                returning.number() += value;
+                                returning.asNumeric().append(value);
+                            }
                         }
                     }
                 }
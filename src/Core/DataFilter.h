@@ -39,6 +39,7 @@ class RideMetric;
 class FieldDefinition;
 class DataFilter;
 class DataFilterRuntime;
+class DataFilterProgram;
 
 class Result {
     public:
@@ -114,7 +115,7 @@ class Leaf {
 
     public:
 
-        Leaf(int loc, int leng) : type(none),lvalue(),rvalue(),cond(),op(0),series(NULL),dynamic(false),loc(loc),leng(leng),inerror(false) { }
+        Leaf(int loc, int leng) : type(none),lvalue(),rvalue(),cond(),op(0),series(NULL),dynamic(false),loc(loc),leng(leng),inerror(false),program(NULL),vector(NULL) { }
 
         // evaluate against a RideItem using its context
         //
@@ -128,6 +129,10 @@ class Leaf {
         //
         Result eval(DataFilterRuntime *df, Leaf *, const Result &x, long it, RideItem *m, RideFilePoint *p = NULL, const QHash<QString,RideMetric*> *metrics=NULL, const Specification &spec=Specification(), const  DateRange &d=DateRange());
 
+        // evaluate a function for each sample the iterator covers, over whole
+        // columns at once when the function has been vectorised
+        void evalSamples(DataFilterRuntime *df, Leaf *, RideFileIterator samples, RideItem *m, const QHash<QString,RideMetric*> *metrics=NULL, const Specification &spec=Specification(), const  DateRange &d=DateRange());
+
         // tree traversal etc
         void print(int level, DataFilterRuntime*);  // print leaf and all children
         void color(Leaf *, QTextDocument *);  // update the document to match
@@ -164,6 +169,47 @@ class Leaf {
         int loc, leng;
         bool inerror;
         RideFile::XDataJoin xjoin; // how to join xdata with main
+
+        DataFilterProgram *program; // compiled bytecode for this subtree, see DataFilterProgram.h
+        DataFilterProgram *vector;  // user functions compiled to run over whole columns
+};
+
+// user defined symbols, accessed by name when walking the tree
+// and by slot from compiled programs. Slots are never reused, so
+// a slot resolved at compile time remains valid until reparsed.
+class DataFilterSymbols {
+
+    public:
+
+        bool contains(const QString &name) const { int i = index.value(name, -1); return i >= 0 && defined.at(i); }
+        Result value(const QString &name) const { int i = index.value(name, -1); return (i >= 0 && defined.at(i)) ? values.at(i) : Result(); }
+        void insert(const QString &name, const Result &value) { int i = slot(name); values[i] = value; defined[i] = true; }
+        void clear() { values.fill(Result()); defined.fill(false); }
+
+        // slot for name, allocated if needed
+        int slot(const QString &name) {
+            int i = index.value(name, -1);
+            if (i < 0) {
+                i = values.count();
+                index.insert(name, i);
+                values << Result();
+                defined << false;
+            }
+            return i;
+        }
+
+        // numeric access by slot, for compiled programs
+        bool isScalar(int i) { return i < values.count() && defined.at(i) && values[i].isNumber && !values[i].isVector(); }
+        double number(int i) { return values[i].number(); }
+        void setNumber(int i, double value) {
+            if (defined.at(i) && values[i].isNumber && !values[i].isVector()) values[i].number() = value;
+            else { values[i] = Result(value); defined[i] = true; }
+        }
+
+    private:
+        QHash<QString, int> index;
+        QVector<Result> values;
+        QVector<bool> defined;
 };
 
 class UserChart;
@@ -194,7 +240,7 @@ public:
     QStringList dataSeriesSymbols;
 
     // user defined symbols
-    QHash<QString, Result> symbols;
+    DataFilterSymbols symbols;
 
     // user defined functions
     QHash<QString, Leaf*> functions;
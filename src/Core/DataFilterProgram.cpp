@@ -0,0 +1,1060 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "DataFilterProgram.h"
+#include "DataFilter.h"
+#include "RideItem.h"
+#include "RideFile.h"
+#include "RideMetric.h"
+#include "Utils.h"
+
+#include <QVarLengthArray>
+#include <QVector>
+#include <QDate>
+#include <QTime>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+#include "DataFilter_yacc.h"
+
+// same bound as the tree walker applies to while loops
+static const int maxwhile = 1000000;
+
+// the single parameter maths functions, these must
+// have the same semantics as DataFilterFunctions[]
+static const struct {
+    const char *name;
+    double (*func)(double);
+} mathFunctions[] = {
+    { "cos", cos }, { "tan", tan }, { "sin", sin },
+    { "acos", acos }, { "atan", atan }, { "asin", asin },
+    { "cosh", cosh }, { "tanh", tanh }, { "sinh", sinh },
+    { "acosh", acosh }, { "atanh", atanh }, { "asinh", asinh },
+    { "exp", exp }, { "log", log }, { "log10", log10 },
+    { "ceil", ceil }, { "floor", floor }, { "fabs", fabs },
+    { "isinf", Utils::myisinf }, { "isnan", Utils::myisnan },
+    { "sqrt", sqrt },
+    { NULL, NULL }
+};
+
+static int mathFunction(const QString &name)
+{
+    for(int i=0; mathFunctions[i].name; i++)
+        if (name == mathFunctions[i].name) return i;
+    return -1;
+}
+
+//
+// Compiler, lowers subtrees to programs
+//
+class DataFilterCompiler
+{
+    public:
+
+        DataFilterCompiler(DataFilterRuntime *df) : df(df), highest(0), next(0), branchfree(false) {}
+
+        void compile(Leaf *root);
+
+    private:
+
+        // how a symbol is resolved, in the same order as Leaf::eval
+        enum symbolkind { Unsupported, Series, Slot, Ride, Constant, Metric };
+        symbolkind classify(const QString &symbol, int &arg, double &constant, QString &rename) const;
+
+        bool compilable(Leaf *leaf) const;
+        void attach(Leaf *leaf);
+        DataFilterProgram *lower(Leaf *leaf);
+        bool emit(DataFilterProgram *program, Leaf *leaf, int dst);
+        bool load(DataFilterProgram *program, Leaf *leaf, int dst);
+
+        // vector programs for functions called per sample
+        DataFilterProgram *vectorise(Leaf *function);
+        bool assigned(Leaf *leaf);
+        bool statement(DataFilterProgram *program, Leaf *leaf, int mask);
+        bool assignment(DataFilterProgram *program, Leaf *leaf, int mask);
+        int expression(DataFilterProgram *program, Leaf *leaf);
+        int temporary();
+
+        int add(DataFilterProgram *program, quint8 op, int dst=0, int a=0, int b=0, int arg=0);
+        void patch(DataFilterProgram *program, int jump) { program->code[jump].arg = program->code.count(); }
+        int constant(DataFilterProgram *program, double value);
+
+        DataFilterRuntime *df;
+        int highest;            // highest register used
+        int next;               // next free register, vector programs
+        bool branchfree;        // emitting a vector program
+        QVector<int> accumulators; // slots updated by the vector program
+};
+
+DataFilterCompiler::symbolkind
+DataFilterCompiler::classify(const QString &symbol, int &arg, double &constant, QString &rename) const
+{
+    // sample data, programs that read samples only run when there is one
+    if (df->dataSeriesSymbols.contains(symbol)) {
+        RideFile::SeriesType type = RideFile::seriesForSymbol(symbol);
+        if (type == RideFile::index) return Unsupported;
+        arg = type;
+        return Series;
+    }
+
+    // user symbols override all others
+    if (df->symbols.contains(symbol)) {
+        arg = df->symbols.slot(symbol);
+        return Slot;
+    }
+
+    if (symbol == "i" || symbol == "x") return Unsupported;
+    if (symbol == "isRide") { arg = DataFilterProgram::IsBike; return Ride; }
+    if (symbol == "isRun") { arg = DataFilterProgram::IsRun; return Ride; }
+    if (symbol == "isSwim") { arg = DataFilterProgram::IsSwim; return Ride; }
+    if (symbol == "isXtrain") { arg = DataFilterProgram::IsXtrain; return Ride; }
+    if (symbol == "isAero") { arg = DataFilterProgram::IsAero; return Ride; }
+    if (!symbol.compare("NA", Qt::CaseInsensitive)) { constant = RideFile::NA; return Constant; }
+    if (!symbol.compare("RECINTSECS", Qt::CaseInsensitive) ||
+        !symbol.compare("Current", Qt::CaseInsensitive) ||
+        !symbol.compare("Today", Qt::CaseInsensitive)) return Unsupported;
+    if (!symbol.compare("Date", Qt::CaseInsensitive)) { arg = DataFilterProgram::Date; return Ride; }
+    if (!symbol.compare("Time", Qt::CaseInsensitive)) { arg = DataFilterProgram::Time; return Ride; }
+    if (!symbol.compare("isPlanned", Qt::CaseInsensitive) ||
+        !symbol.compare("Planned", Qt::CaseInsensitive)) { arg = DataFilterProgram::Planned; return Ride; }
+    if (!symbol.compare("isDirty", Qt::CaseInsensitive) ||
+        !symbol.compare("Dirty", Qt::CaseInsensitive)) { arg = DataFilterProgram::Dirty; return Ride; }
+
+    // coggan pmc values
+    if (!symbol.compare("ctl", Qt::CaseInsensitive) ||
+        !symbol.compare("atl", Qt::CaseInsensitive) ||
+        !symbol.compare("tsb", Qt::CaseInsensitive)) return Unsupported;
+
+    // metrics, but not numeric metadata fields
+    if (df->lookupType.value(symbol)) {
+        rename = df->lookupMap.value(symbol, "");
+        const RideMetric *m = RideMetricFactory::instance().rideMetric(rename);
+        if (m == NULL) return Unsupported;
+        arg = m->index();
+        return Metric;
+    }
+
+    // metadata strings
+    return Unsupported;
+}
+
+bool
+DataFilterCompiler::compilable(Leaf *leaf) const
+{
+    if (leaf == NULL) return false;
+
+    switch(leaf->type) {
+
+    case Leaf::Float :
+    case Leaf::Integer :
+        return true;
+
+    case Leaf::Symbol :
+    {
+        int arg;
+        double constant;
+        QString rename;
+        return classify(*(leaf->lvalue.n), arg, constant, rename) != Unsupported;
+    }
+
+    case Leaf::UnaryOperation :
+        return (leaf->op == '-' || leaf->op == '!') && compilable(leaf->lvalue.l);
+
+    case Leaf::BinaryOperation :
+    case Leaf::Operation :
+        switch(leaf->op) {
+        case ASSIGN:
+            return leaf->lvalue.l && leaf->lvalue.l->type == Leaf::Symbol &&
+                   df->symbols.contains(*(leaf->lvalue.l->lvalue.n)) && compilable(leaf->rvalue.l);
+        case ADD: case SUBTRACT: case MULTIPLY: case DIVIDE: case POW:
+        case EQ: case NEQ: case LT: case LTE: case GT: case GTE:
+        case ELVIS:
+            return compilable(leaf->lvalue.l) && compilable(leaf->rvalue.l);
+        default:
+            return false;
+        }
+
+    case Leaf::Logical :
+        if (leaf->op == AND || leaf->op == OR) return compilable(leaf->lvalue.l) && compilable(leaf->rvalue.l);
+        return leaf->op == 0 && compilable(leaf->lvalue.l);
+
+    case Leaf::Conditional :
+        if (leaf->op == IF_ || leaf->op == 0)
+            return compilable(leaf->cond.l) && compilable(leaf->lvalue.l) && (leaf->rvalue.l == NULL || compilable(leaf->rvalue.l));
+        if (leaf->op == WHILE)
+            return compilable(leaf->cond.l) && compilable(leaf->lvalue.l);
+        return false;
+
+    case Leaf::Compound :
+        foreach(Leaf *statement, *(leaf->lvalue.b)) if (!compilable(statement)) return false;
+        return true;
+
+    case Leaf::Function :
+    {
+        // user defined functions, but only once compiled
+        if (leaf->function != "count" && df->functions.contains(leaf->function))
+            return df->functions.value(leaf->function)->program != NULL;
+
+        if (leaf->series || leaf->lvalue.l) return false;
+
+        bool supported = false;
+        if (mathFunction(leaf->function) >= 0) supported = leaf->fparms.count() == 1;
+        else if (leaf->function == "round") supported = leaf->fparms.count() == 1 || leaf->fparms.count() == 2;
+        else if (leaf->function == "sum" || leaf->function == "mean" ||
+                 leaf->function == "max" || leaf->function == "min") supported = true;
+        if (!supported) return false;
+
+        foreach(Leaf *parm, leaf->fparms) if (!compilable(parm)) return false;
+        return true;
+    }
+
+    default:
+        return false;
+    }
+}
+
+int
+DataFilterCompiler::add(DataFilterProgram *program, quint8 op, int dst, int a, int b, int arg)
+{
+    DataFilterProgram::instruction i;
+    i.op = op;
+    i.dst = dst;
+    i.a = a;
+    i.b = b;
+    i.arg = arg;
+    program->code << i;
+    return program->code.count() - 1;
+}
+
+int
+DataFilterCompiler::constant(DataFilterProgram *program, double value)
+{
+    program->constants << value;
+    return program->constants.count() - 1;
+}
+
+// registers are used like a stack, the code emitted for a leaf only ever
+// writes dst and the registers above it, so anything below dst survives
+bool
+DataFilterCompiler::emit(DataFilterProgram *program, Leaf *leaf, int dst)
+{
+    // we need dst+2 for while loops
+    if (dst + 2 > 255) return false;
+    if (dst + 2 > highest) highest = dst + 2;
+
+    switch(leaf->type) {
+
+    case Leaf::Float :
+        add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, leaf->lvalue.f));
+        return true;
+
+    case Leaf::Integer :
+        add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, leaf->lvalue.i));
+        return true;
+
+    case Leaf::Symbol :
+        return load(program, leaf, dst);
+
+    case Leaf::UnaryOperation :
+        if (!emit(program, leaf->lvalue.l, dst)) return false;
+        add(program, leaf->op == '-' ? DataFilterProgram::Neg : DataFilterProgram::Not, dst, dst);
+        return true;
+
+    case Leaf::BinaryOperation :
+    case Leaf::Operation :
+    {
+        if (leaf->op == ASSIGN) {
+            if (branchfree) return false;
+            if (!emit(program, leaf->rvalue.l, dst)) return false;
+            add(program, DataFilterProgram::StoreSlot, 0, dst, 0, df->symbols.slot(*(leaf->lvalue.l->lvalue.n)));
+            return true;
+        }
+
+        if (leaf->op == ELVIS && branchfree) {
+            if (!emit(program, leaf->lvalue.l, dst) || !emit(program, leaf->rvalue.l, dst+1)) return false;
+            add(program, DataFilterProgram::Elvis, dst, dst, dst+1);
+            return true;
+        }
+
+        if (leaf->op == ELVIS) {
+            if (!emit(program, leaf->lvalue.l, dst)) return false;
+            int done = add(program, DataFilterProgram::JumpIfNonZero, 0, dst);
+            if (!emit(program, leaf->rvalue.l, dst)) return false;
+            patch(program, done);
+            return true;
+        }
+
+        quint8 op;
+        switch(leaf->op) {
+        case ADD: op = DataFilterProgram::Add; break;
+        case SUBTRACT: op = DataFilterProgram::Subtract; break;
+        case MULTIPLY: op = DataFilterProgram::Multiply; break;
+        case DIVIDE: op = DataFilterProgram::Divide; break;
+        case POW: op = DataFilterProgram::Pow; break;
+        case EQ: op = DataFilterProgram::Eq; break;
+        case NEQ: op = DataFilterProgram::Neq; break;
+        case LT: op = DataFilterProgram::Lt; break;
+        case LTE: op = DataFilterProgram::Lte; break;
+        case GT: op = DataFilterProgram::Gt; break;
+        case GTE: op = DataFilterProgram::Gte; break;
+        default: return false;
+        }
+        if (!emit(program, leaf->lvalue.l, dst) || !emit(program, leaf->rvalue.l, dst+1)) return false;
+        add(program, op, dst, dst, dst+1);
+        return true;
+    }
+
+    case Leaf::Logical :
+    {
+        if (leaf->op == 0) return emit(program, leaf->lvalue.l, dst);
+
+        if (branchfree) {
+            if (!emit(program, leaf->lvalue.l, dst) || !emit(program, leaf->rvalue.l, dst+1)) return false;
+            add(program, leaf->op == AND ? DataFilterProgram::And : DataFilterProgram::Or, dst, dst, dst+1);
+            return true;
+        }
+
+        // short circuit, result is always 0 or 1
+        bool isand = leaf->op == AND;
+        quint8 test = isand ? DataFilterProgram::JumpIfZero : DataFilterProgram::JumpIfNonZero;
+
+        if (!emit(program, leaf->lvalue.l, dst)) return false;
+        int first = add(program, test, 0, dst);
+        if (!emit(program, leaf->rvalue.l, dst)) return false;
+        int second = add(program, test, 0, dst);
+        add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, isand ? 1 : 0));
+        int done = add(program, DataFilterProgram::Jump);
+        patch(program, first);
+        patch(program, second);
+        add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, isand ? 0 : 1));
+        patch(program, done);
+        return true;
+    }
+
+    case Leaf::Conditional :
+    {
+        if (leaf->op == WHILE && branchfree) return false;
+
+        if (branchfree) {
+
+            // both sides are evaluated, then selected on the condition
+            if (leaf->rvalue.l) {
+                if (!emit(program, leaf->rvalue.l, dst)) return false;
+            } else {
+                add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+            }
+            if (!emit(program, leaf->cond.l, dst+1) || !emit(program, leaf->lvalue.l, dst+2)) return false;
+            add(program, DataFilterProgram::Select, dst, dst, dst+2, dst+1);
+            return true;
+        }
+
+        if (leaf->op == WHILE) {
+
+            // dst is the loop count, below anything the condition and body
+            // use, dst+1 the value and dst+2 the condition; the body may
+            // overwrite the condition since it has been tested by then
+            add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+            add(program, DataFilterProgram::LoadK, dst+1, 0, 0, constant(program, 0));
+            int top = add(program, DataFilterProgram::Loop, 0, dst);
+            if (!emit(program, leaf->cond.l, dst+2)) return false;
+            int exit = add(program, DataFilterProgram::JumpIfZero, 0, dst+2);
+            if (!emit(program, leaf->lvalue.l, dst+1)) return false;
+            add(program, DataFilterProgram::Jump, 0, 0, 0, top);
+            patch(program, top);
+            patch(program, exit);
+            add(program, DataFilterProgram::LoopEnd, 0, dst);
+            add(program, DataFilterProgram::Move, dst, dst+1);
+            return true;
+        }
+
+        if (!emit(program, leaf->cond.l, dst)) return false;
+        int otherwise = add(program, DataFilterProgram::JumpIfZero, 0, dst);
+        if (!emit(program, leaf->lvalue.l, dst)) return false;
+        int done = add(program, DataFilterProgram::Jump);
+        patch(program, otherwise);
+        if (leaf->rvalue.l) {
+            if (!emit(program, leaf->rvalue.l, dst)) return false;
+        } else {
+            add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+        }
+        patch(program, done);
+        return true;
+    }
+
+    case Leaf::Compound :
+    {
+        if (branchfree) return false;
+
+        // value of the last statement
+        if (leaf->lvalue.b->isEmpty()) add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+        foreach(Leaf *statement, *(leaf->lvalue.b)) if (!emit(program, statement, dst)) return false;
+        return true;
+    }
+
+    case Leaf::Function :
+    {
+        if (leaf->function != "count" && df->functions.contains(leaf->function)) {
+
+            // may have side effects
+            if (branchfree) return false;
+
+            Leaf *callee = df->functions.value(leaf->function);
+            DataFilterProgram *called = callee->program;
+            if (called == NULL) return false;
+
+            // we check what the callee reads before we start
+            foreach(int slot, called->reads) if (!program->reads.contains(slot)) program->reads << slot;
+            if (called->sampled) program->sampled = true;
+
+            program->calls << callee;
+            add(program, DataFilterProgram::Call, dst, 0, 0, program->calls.count()-1);
+            return true;
+        }
+
+        int f = mathFunction(leaf->function);
+        if (f >= 0) {
+            if (!emit(program, leaf->fparms[0], dst)) return false;
+            program->functions << mathFunctions[f].func;
+            add(program, DataFilterProgram::Math, dst, dst, 0, program->functions.count()-1);
+            return true;
+        }
+
+        if (leaf->function == "round") {
+            if (leaf->fparms.count() == 2) {
+                // decimal places are evaluated first
+                if (!emit(program, leaf->fparms[1], dst) || !emit(program, leaf->fparms[0], dst+1)) return false;
+                add(program, DataFilterProgram::RoundDp, dst, dst+1, dst);
+            } else {
+                if (!emit(program, leaf->fparms[0], dst)) return false;
+                add(program, DataFilterProgram::Round, dst, dst);
+            }
+            return true;
+        }
+
+        if (leaf->function == "sum" || leaf->function == "mean") {
+            add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+            foreach(Leaf *parm, leaf->fparms) {
+                if (!emit(program, parm, dst+1)) return false;
+                add(program, DataFilterProgram::Add, dst, dst, dst+1);
+            }
+            if (leaf->function == "mean" && leaf->fparms.count()) {
+                add(program, DataFilterProgram::LoadK, dst+1, 0, 0, constant(program, leaf->fparms.count()));
+                add(program, DataFilterProgram::Divide, dst, dst, dst+1);
+            }
+            return true;
+        }
+
+        if (leaf->function == "max" || leaf->function == "min") {
+            if (leaf->fparms.isEmpty()) {
+                add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, 0));
+                return true;
+            }
+            quint8 op = leaf->function == "max" ? DataFilterProgram::Max : DataFilterProgram::Min;
+            if (!emit(program, leaf->fparms[0], dst)) return false;
+            for(int i=1; i<leaf->fparms.count(); i++) {
+                if (!emit(program, leaf->fparms[i], dst+1)) return false;
+                add(program, op, dst, dst, dst+1);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    default:
+        return false;
+    }
+}
+
+bool
+DataFilterCompiler::load(DataFilterProgram *program, Leaf *leaf, int dst)
+{
+    int arg=0;
+    double value=0;
+    QString rename;
+    switch(classify(*(leaf->lvalue.n), arg, value, rename)) {
+    case Series:
+        // vector programs read the columns
+        if (branchfree && !RideFileColumns::isStored(static_cast<RideFile::SeriesType>(arg))) return false;
+        program->sampled = true;
+        if (!program->series.contains(static_cast<RideFile::SeriesType>(arg))) program->series << static_cast<RideFile::SeriesType>(arg);
+        add(program, DataFilterProgram::LoadSeries, dst, 0, 0, arg);
+        break;
+    case Slot:
+        // symbols updated per sample are not known until folded
+        if (branchfree && accumulators.contains(arg)) return false;
+        if (!program->reads.contains(arg)) program->reads << arg;
+        add(program, DataFilterProgram::LoadSlot, dst, 0, 0, arg);
+        break;
+    case Ride:
+        add(program, DataFilterProgram::LoadRide, dst, 0, 0, arg);
+        break;
+    case Constant:
+        add(program, DataFilterProgram::LoadK, dst, 0, 0, constant(program, value));
+        break;
+    case Metric:
+        program->names << rename;
+        program->metrics << arg;
+        add(program, DataFilterProgram::LoadMetric, dst, 0, 0, program->names.count()-1);
+        break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+DataFilterProgram *
+DataFilterCompiler::lower(Leaf *leaf)
+{
+    highest = 0;
+    DataFilterProgram *program = new DataFilterProgram();
+    if (!emit(program, leaf, 0)) {
+        delete program;
+        return NULL;
+    }
+    program->registers = highest + 1;
+    return program;
+}
+
+void
+DataFilterCompiler::attach(Leaf *leaf)
+{
+    if (leaf == NULL || leaf->program) return;
+
+    // literals are quicker to walk
+    if (leaf->type != Leaf::Float && leaf->type != Leaf::Integer && compilable(leaf)) {
+        leaf->program = lower(leaf);
+        if (leaf->program) return;
+    }
+
+    // otherwise try the subtrees
+    switch(leaf->type) {
+    case Leaf::Logical :
+    case Leaf::BinaryOperation :
+    case Leaf::Operation :
+        attach(leaf->lvalue.l);
+        attach(leaf->rvalue.l);
+        break;
+    case Leaf::UnaryOperation :
+        attach(leaf->lvalue.l);
+        break;
+    case Leaf::Function :
+        attach(leaf->lvalue.l);
+        attach(leaf->series);
+        foreach(Leaf *parm, leaf->fparms) attach(parm);
+        break;
+    case Leaf::Compound :
+        foreach(Leaf *statement, *(leaf->lvalue.b)) attach(statement);
+        break;
+    case Leaf::Conditional :
+        attach(leaf->cond.l);
+        attach(leaf->lvalue.l);
+        attach(leaf->rvalue.l);
+        break;
+    case Leaf::Index :
+    case Leaf::Select :
+        attach(leaf->lvalue.l);
+        foreach(Leaf *parm, leaf->fparms) attach(parm);
+        break;
+    default:
+        break;
+    }
+}
+
+//
+// Vector programs
+//
+int
+DataFilterCompiler::temporary()
+{
+    if (next > 255) return -1;
+    if (next > highest) highest = next;
+    return next++;
+}
+
+int
+DataFilterCompiler::expression(DataFilterProgram *program, Leaf *leaf)
+{
+    // evaluated into a register of its own, that is
+    // kept until the block has been folded
+    int dst = next;
+    if (!compilable(leaf) || !emit(program, leaf, dst)) return -1;
+    next = highest + 1;
+    return dst;
+}
+
+static bool
+isSymbol(Leaf *leaf, const QString &symbol)
+{
+    return leaf && leaf->type == Leaf::Symbol && *(leaf->lvalue.n) == symbol;
+}
+
+// find the symbols updated, each can only be updated once
+bool
+DataFilterCompiler::assigned(Leaf *leaf)
+{
+    if (leaf == NULL) return true;
+
+    switch(leaf->type) {
+    case Leaf::Compound :
+        foreach(Leaf *statement, *(leaf->lvalue.b)) if (!assigned(statement)) return false;
+        return true;
+
+    case Leaf::Conditional :
+        if (leaf->op != IF_) return true;
+        return assigned(leaf->lvalue.l) && assigned(leaf->rvalue.l);
+
+    case Leaf::Operation :
+    case Leaf::BinaryOperation :
+    {
+        if (leaf->op != ASSIGN) return true;
+        if (!leaf->lvalue.l || leaf->lvalue.l->type != Leaf::Symbol) return false;
+        QString symbol = *(leaf->lvalue.l->lvalue.n);
+        if (!df->symbols.contains(symbol)) return false;
+        int slot = df->symbols.slot(symbol);
+        if (accumulators.contains(slot)) return false;
+        accumulators << slot;
+        return true;
+    }
+
+    default:
+        return true;
+    }
+}
+
+bool
+DataFilterCompiler::statement(DataFilterProgram *program, Leaf *leaf, int mask)
+{
+    if (leaf == NULL) return true;
+
+    switch(leaf->type) {
+    case Leaf::Compound :
+        foreach(Leaf *statement, *(leaf->lvalue.b))
+            if (!this->statement(program, statement, mask)) return false;
+        return true;
+
+    case Leaf::Conditional :
+    {
+        if (leaf->op != IF_) break; // ternary is an expression
+
+        int cond = expression(program, leaf->cond.l);
+        if (cond < 0) return false;
+
+        int then = cond;
+        if (mask >= 0) {
+            if ((then = temporary()) < 0) return false;
+            add(program, DataFilterProgram::And, then, cond, mask);
+        }
+        if (!statement(program, leaf->lvalue.l, then)) return false;
+
+        if (leaf->rvalue.l) {
+            int otherwise = temporary();
+            if (otherwise < 0) return false;
+            add(program, DataFilterProgram::Not, otherwise, cond);
+            if (mask >= 0) add(program, DataFilterProgram::And, otherwise, otherwise, mask);
+            if (!statement(program, leaf->rvalue.l, otherwise)) return false;
+        }
+        return true;
+    }
+
+    case Leaf::Operation :
+    case Leaf::BinaryOperation :
+        if (leaf->op == ASSIGN) return assignment(program, leaf, mask);
+        break;
+
+    default:
+        break;
+    }
+
+    // anything else must be an expression, the value isn't used so
+    // we only check it has no side effects and drop the code
+    int size = program->code.count();
+    if (expression(program, leaf) < 0) return false;
+    program->code.resize(size);
+    return true;
+}
+
+bool
+DataFilterCompiler::assignment(DataFilterProgram *program, Leaf *leaf, int mask)
+{
+    QString symbol = *(leaf->lvalue.l->lvalue.n);
+    Leaf *rhs = leaf->rvalue.l;
+    if (rhs == NULL) return false;
+
+    DataFilterProgram::reduction r;
+    r.kind = DataFilterProgram::Last;
+    r.swapped = false;
+    r.mask = mask;
+    r.slot = df->symbols.slot(symbol);
+
+    // acc <- acc + expr etc, otherwise just the last value
+    Leaf *value = rhs;
+    if (rhs->type == Leaf::Operation || rhs->type == Leaf::BinaryOperation) {
+
+        bool left = isSymbol(rhs->lvalue.l, symbol);
+        bool right = isSymbol(rhs->rvalue.l, symbol);
+
+        if ((rhs->op == ADD || rhs->op == MULTIPLY) && (left || right)) {
+            r.kind = rhs->op == ADD ? DataFilterProgram::Sum : DataFilterProgram::Product;
+            value = left ? rhs->rvalue.l : rhs->lvalue.l;
+        } else if (rhs->op == SUBTRACT && left) {
+            r.kind = DataFilterProgram::Difference;
+            value = rhs->rvalue.l;
+        }
+
+    } else if (rhs->type == Leaf::Function && (rhs->function == "max" || rhs->function == "min") &&
+               !df->functions.contains(rhs->function) && rhs->fparms.count() == 2 &&
+               rhs->series == NULL && rhs->lvalue.l == NULL) {
+
+        bool left = isSymbol(rhs->fparms[0], symbol);
+        bool right = isSymbol(rhs->fparms[1], symbol);
+
+        if (left || right) {
+            r.kind = rhs->function == "max" ? DataFilterProgram::Maximum : DataFilterProgram::Minimum;
+            r.swapped = !left;
+            value = left ? rhs->fparms[1] : rhs->fparms[0];
+        }
+    }
+
+    // folding reads the current value
+    if (r.kind != DataFilterProgram::Last && !program->reads.contains(r.slot)) program->reads << r.slot;
+
+    r.value = expression(program, value);
+    if (r.value < 0) return false;
+
+    program->reductions << r;
+    return true;
+}
+
+DataFilterProgram *
+DataFilterCompiler::vectorise(Leaf *function)
+{
+    accumulators.clear();
+    if (!assigned(function) || accumulators.isEmpty()) return NULL;
+
+    DataFilterProgram *program = new DataFilterProgram();
+    branchfree = true;
+    highest = next = 0;
+
+    bool ok = statement(program, function, -1);
+    branchfree = false;
+
+    if (!ok || program->reductions.isEmpty()) {
+        delete program;
+        return NULL;
+    }
+    program->registers = highest + 1;
+    program->sampled = true;
+    return program;
+}
+
+void
+DataFilterCompiler::compile(Leaf *root)
+{
+    // user functions first so calls to them can compile, we go
+    // round until no more compile since they may call each other
+    bool compiled = true;
+    while (compiled) {
+        compiled = false;
+        foreach(Leaf *function, df->functions) {
+            if (function->program == NULL && compilable(function)) {
+                function->program = lower(function);
+                if (function->program) compiled = true;
+            }
+        }
+    }
+
+    // and then everything else
+    attach(root);
+
+    // any function might be called per sample
+    foreach(Leaf *function, df->functions)
+        if (function->vector == NULL) function->vector = vectorise(function);
+}
+
+void
+DataFilterProgram::compile(DataFilterRuntime *df, Leaf *root)
+{
+    if (root == NULL) return;
+    DataFilterCompiler compiler(df);
+    compiler.compile(root);
+}
+
+double
+DataFilterProgram::metric(int index, RideItem *m, const QHash<QString,RideMetric*> *c) const
+{
+    // metadata overrides the metric value, as when walking the tree
+    const QString &name = names[index];
+    QString meta = m->getText(name, "unknown");
+    if (meta != "unknown") return meta.toDouble();
+    if (c) return RideMetric::getForSymbol(name, c);
+    if (m->metrics().size() == RideMetricFactory::instance().metricCount()) return m->metrics()[metrics[index]];
+    return 0.0f;
+}
+
+double
+DataFilterProgram::ride(int field, RideItem *m) const
+{
+    switch(field) {
+    case IsBike: return m->isBike ? 1 : 0;
+    case IsRun: return m->isRun ? 1 : 0;
+    case IsSwim: return m->isSwim ? 1 : 0;
+    case IsXtrain: return m->isXtrain ? 1 : 0;
+    case IsAero: return m->isAero ? 1 : 0;
+    case Date: return QDate(1900,01,01).daysTo(m->dateTime.date());
+    case Time: return QTime(0,0,0).secsTo(m->dateTime.time());
+    case Planned: return m->planned;
+    case Dirty: return m->isdirty;
+    }
+    return 0;
+}
+
+bool
+DataFilterProgram::runnable(DataFilterRuntime *df, RideItem *m, RideFilePoint *p) const
+{
+    // symbols evaluate to zero with no ride
+    if (m == NULL) return false;
+
+    // sample data symbols mean something else without a sample
+    if (sampled && p == NULL) return false;
+
+    // user symbols must be a number, not a string or vector
+    foreach(int slot, reads) if (!df->symbols.isScalar(slot)) return false;
+
+    return true;
+}
+
+double
+DataFilterProgram::run(DataFilterRuntime *df, RideItem *m, RideFilePoint *p, const QHash<QString,RideMetric*> *c) const
+{
+    QVarLengthArray<double, 32> r(registers);
+    const instruction *code = this->code.constData();
+    const int count = this->code.count();
+
+    for(int pc=0; pc < count; pc++) {
+
+        const instruction &i = code[pc];
+
+        switch(i.op) {
+
+        case LoadK: r[i.dst] = constants[i.arg]; break;
+        case Move: r[i.dst] = r[i.a]; break;
+        case LoadSlot: r[i.dst] = df->symbols.number(i.arg); break;
+        case StoreSlot: df->symbols.setNumber(i.arg, r[i.a]); break;
+        case LoadSeries: r[i.dst] = p->value(static_cast<RideFile::SeriesType>(i.arg)); break;
+
+        case LoadMetric: r[i.dst] = metric(i.arg, m, c); break;
+        case LoadRide: r[i.dst] = ride(i.arg, m); break;
+
+        case Neg: r[i.dst] = r[i.a] * -1; break;
+        case Not: r[i.dst] = !r[i.a]; break;
+        case Add: r[i.dst] = r[i.a] + r[i.b]; break;
+        case Subtract: r[i.dst] = r[i.a] - r[i.b]; break;
+        case Multiply: r[i.dst] = r[i.a] * r[i.b]; break;
+        case Divide: r[i.dst] = r[i.b] ? r[i.a] / r[i.b] : 0; break;
+        case Pow: r[i.dst] = pow(r[i.a], r[i.b]); break;
+        case Eq: r[i.dst] = r[i.a] == r[i.b]; break;
+        case Neq: r[i.dst] = r[i.a] != r[i.b]; break;
+        case Lt: r[i.dst] = r[i.a] < r[i.b]; break;
+        case Lte: r[i.dst] = r[i.a] <= r[i.b]; break;
+        case Gt: r[i.dst] = r[i.a] > r[i.b]; break;
+        case Gte: r[i.dst] = r[i.a] >= r[i.b]; break;
+        case Max: if (r[i.b] > r[i.a]) r[i.dst] = r[i.b]; else r[i.dst] = r[i.a]; break;
+        case Min: if (r[i.b] < r[i.a]) r[i.dst] = r[i.b]; else r[i.dst] = r[i.a]; break;
+
+        case Math: r[i.dst] = functions[i.arg](r[i.a]); break;
+        case Round: r[i.dst] = round(r[i.a]); break;
+        case RoundDp:
+        {
+            double factor = pow(10, r[i.b]);
+            r[i.dst] = round(r[i.a] * factor) / factor;
+        }
+        break;
+
+        case Jump: pc = i.arg - 1; break;
+        case JumpIfZero: if (!r[i.a]) pc = i.arg - 1; break;
+        case JumpIfNonZero: if (r[i.a]) pc = i.arg - 1; break;
+
+        // bounded to stop badly written code hanging
+        case Loop: if (!(r[i.a]++ < maxwhile)) pc = i.arg - 1; break;
+        case LoopEnd:
+            if (r[i.a] >= maxwhile)
+                qDebug()<<"WARNING: "<< "[ loops="<<r[i.a]<<"] runaway while loop terminated, check formula/filter.";
+            break;
+
+        case Call:
+        {
+            // same stack bound as the tree walker
+            df->stack += 1;
+            if (df->stack > 500) {
+                qDebug()<<"stack overflow";
+                df->stack = 0;
+                r[i.dst] = 0;
+                break;
+            }
+            r[i.dst] = calls[i.arg]->program->run(df, m, p, c);
+            if (df->stack > 0) df->stack -= 1;
+        }
+        break;
+        }
+    }
+    return r[0];
+}
+
+//
+// Vector programs, each register holds a block of samples
+//
+static const int blocksize = 256;
+
+static inline void fill(double *into, int n, double value)
+{
+    for(int j=0; j<n; j++) into[j] = value;
+}
+
+bool
+DataFilterProgram::runColumns(DataFilterRuntime *df, RideItem *m, const RideFileColumns &columns, int from, int to, const QHash<QString,RideMetric*> *c) const
+{
+    if (m == NULL || reductions.isEmpty()) return false;
+    if (from < 0 || to < from || to >= columns.count()) return false;
+    foreach(int slot, reads) if (!df->symbols.isScalar(slot)) return false;
+
+    // symbols are folded locally and stored at the end
+    QVarLengthArray<double, 16> acc(reductions.count());
+    QVarLengthArray<bool, 16> updated(reductions.count());
+    for(int k=0; k<reductions.count(); k++) {
+        const reduction &red = reductions[k];
+        acc[k] = red.kind == Last ? 0 : df->symbols.number(red.slot);
+        updated[k] = red.kind != Last;
+    }
+
+    QVector<double> block(registers * blocksize);
+    double *r = block.data();
+    const instruction *code = this->code.constData();
+    const int count = this->code.count();
+
+    for(int start=from; start <= to; start += blocksize) {
+
+        const int n = qMin(blocksize, to - start + 1);
+
+        for(int pc=0; pc < count; pc++) {
+
+            const instruction &i = code[pc];
+            double *d = r + i.dst * blocksize;
+            const double *a = r + i.a * blocksize;
+            const double *b = r + i.b * blocksize;
+
+            switch(i.op) {
+
+            case LoadK: fill(d, n, constants[i.arg]); break;
+            case LoadSlot: fill(d, n, df->symbols.number(i.arg)); break;
+            case LoadMetric: fill(d, n, metric(i.arg, m, c)); break;
+            case LoadRide: fill(d, n, ride(i.arg, m)); break;
+            case LoadSeries:
+            {
+                RideFile::SeriesType series = static_cast<RideFile::SeriesType>(i.arg);
+                const double *column = columns.column(series);
+                if (column) memcpy(d, column + start, n * sizeof(double));
+                else fill(d, n, RideFileColumns::defaultValue(series));
+            }
+            break;
+
+            case Neg: for(int j=0; j<n; j++) d[j] = a[j] * -1; break;
+            case Not: for(int j=0; j<n; j++) d[j] = !a[j]; break;
+            case Add: for(int j=0; j<n; j++) d[j] = a[j] + b[j]; break;
+            case Subtract: for(int j=0; j<n; j++) d[j] = a[j] - b[j]; break;
+            case Multiply: for(int j=0; j<n; j++) d[j] = a[j] * b[j]; break;
+            case Divide: for(int j=0; j<n; j++) d[j] = b[j] ? a[j] / b[j] : 0; break;
+            case Pow: for(int j=0; j<n; j++) d[j] = pow(a[j], b[j]); break;
+            case Eq: for(int j=0; j<n; j++) d[j] = a[j] == b[j]; break;
+            case Neq: for(int j=0; j<n; j++) d[j] = a[j] != b[j]; break;
+            case Lt: for(int j=0; j<n; j++) d[j] = a[j] < b[j]; break;
+            case Lte: for(int j=0; j<n; j++) d[j] = a[j] <= b[j]; break;
+            case Gt: for(int j=0; j<n; j++) d[j] = a[j] > b[j]; break;
+            case Gte: for(int j=0; j<n; j++) d[j] = a[j] >= b[j]; break;
+            case Max: for(int j=0; j<n; j++) d[j] = b[j] > a[j] ? b[j] : a[j]; break;
+            case Min: for(int j=0; j<n; j++) d[j] = b[j] < a[j] ? b[j] : a[j]; break;
+            case And: for(int j=0; j<n; j++) d[j] = a[j] && b[j]; break;
+            case Or: for(int j=0; j<n; j++) d[j] = a[j] || b[j]; break;
+            case Elvis: for(int j=0; j<n; j++) d[j] = a[j] ? a[j] : b[j]; break;
+            case Select:
+            {
+                const double *cond = r + i.arg * blocksize;
+                for(int j=0; j<n; j++) d[j] = cond[j] ? b[j] : a[j];
+            }
+            break;
+
+            case Math: for(int j=0; j<n; j++) d[j] = functions[i.arg](a[j]); break;
+            case Round: for(int j=0; j<n; j++) d[j] = round(a[j]); break;
+            case RoundDp:
+                for(int j=0; j<n; j++) {
+                    double factor = pow(10, b[j]);
+                    d[j] = round(a[j] * factor) / factor;
+                }
+                break;
+
+            default: break; // not generated for vector programs
+            }
+        }
+
+        // fold into the symbols, in sample order
+        for(int k=0; k<reductions.count(); k++) {
+
+            const reduction &red = reductions[k];
+            const double *v = r + red.value * blocksize;
+            const double *mask = red.mask >= 0 ? r + red.mask * blocksize : NULL;
+            double total = acc[k];
+
+            switch(red.kind) {
+            case Sum:
+                for(int j=0; j<n; j++) if (!mask || mask[j]) total = total + v[j];
+                break;
+            case Difference:
+                for(int j=0; j<n; j++) if (!mask || mask[j]) total = total - v[j];
+                break;
+            case Product:
+                for(int j=0; j<n; j++) if (!mask || mask[j]) total = total * v[j];
+                break;
+            case Maximum:
+                for(int j=0; j<n; j++) if (!mask || mask[j]) {
+                    if (red.swapped) total = total > v[j] ? total : v[j];
+                    else total = v[j] > total ? v[j] : total;
+                }
+                break;
+            case Minimum:
+                for(int j=0; j<n; j++) if (!mask || mask[j]) {
+                    if (red.swapped) total = total < v[j] ? total : v[j];
+                    else total = v[j] < total ? v[j] : total;
+                }
+                break;
+            case Last:
+                for(int j=n-1; j>=0; j--) if (!mask || mask[j]) {
+                    total = v[j];
+                    updated[k] = true;
+                    break;
+                }
+                break;
+            }
+            acc[k] = total;
+        }
+    }
+
+    for(int k=0; k<reductions.count(); k++)
+        if (updated[k]) df->symbols.setNumber(reductions[k].slot, acc[k]);
+
+    return true;
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_DataFilterProgram_h
+#define _GC_DataFilterProgram_h 1
+#include "GoldenCheetah.h"
+#include "RideFile.h" // for SeriesType
+
+#include <QVector>
+#include <QString>
+#include <QHash>
+
+class Leaf;
+class DataFilterRuntime;
+class DataFilterCompiler;
+class RideItem;
+class RideMetric;
+
+//
+// Bytecode for DataFilter expressions
+//
+// Once a filter or program has been validated the tree is compiled; any
+// subtree that only deals in numbers (arithmetic, comparisons, logic,
+// if/while, assignment to user symbols, metrics, sample values, the maths
+// functions and calls to user functions that compile) is lowered to a
+// program for a small register machine and attached to the leaf at its root.
+// Leaf::eval runs the program instead of walking the subtree. Strings,
+// vectors and most of the builtin functions are still evaluated by
+// walking the tree.
+//
+// Symbols are resolved when compiling; user symbols to a slot in the
+// runtime symbol table, metrics to their name and index, sample data to the
+// series type, and user functions to the leaf holding their program.
+//
+// A program is only run when all of the user symbols it reads hold a
+// single number, otherwise the tree is walked as before. Since programs
+// only ever store numbers that remains true until it completes.
+//
+// User functions that are called once per sample (e.g. sample { } in a user
+// metric) are also compiled to run over whole columns of RideFileColumns
+// when every statement is an update to a user symbol that can be folded;
+//
+//     acc <- acc + expr, acc <- acc - expr, acc <- acc * expr
+//     acc <- max(acc, expr), acc <- min(acc, expr), acc <- expr
+//
+// optionally inside if/else, where expr only depends upon the sample data,
+// constants and user symbols not updated in the function. The expressions
+// are evaluated a block of samples at a time without branches and the
+// results folded into the symbols in sample order, so the results are the
+// same as calling the function for each sample.
+//
+class DataFilterProgram
+{
+    public:
+
+        // compile the tree, attaching programs to the leaves
+        static void compile(DataFilterRuntime *df, Leaf *root);
+
+        // can we run now, or do we need to walk the tree?
+        bool runnable(DataFilterRuntime *df, RideItem *m, RideFilePoint *p) const;
+
+        // evaluate, only if runnable()
+        double run(DataFilterRuntime *df, RideItem *m, RideFilePoint *p, const QHash<QString,RideMetric*> *c) const;
+
+        // evaluate for samples from..to (inclusive) of the columns, vector programs
+        // only, returns false without doing anything if it cannot run now
+        bool runColumns(DataFilterRuntime *df, RideItem *m, const RideFileColumns &columns, int from, int to, const QHash<QString,RideMetric*> *c) const;
+
+        // the columns runColumns() reads, only those need building
+        const QList<RideFile::SeriesType> &columnsRead() const { return series; }
+
+        enum opcode {
+            LoadK, Move, LoadSlot, StoreSlot, LoadSeries, LoadMetric, LoadRide,
+            Neg, Not, Add, Subtract, Multiply, Divide, Pow,
+            Eq, Neq, Lt, Lte, Gt, Gte, Max, Min,
+            Math, Round, RoundDp,
+            Jump, JumpIfZero, JumpIfNonZero, Loop, LoopEnd,
+            Call,
+            And, Or, Select, Elvis      // branch free, vector programs only
+        };
+
+        enum reductionkind { Sum, Difference, Product, Maximum, Minimum, Last };
+
+        enum ridefield { IsBike, IsRun, IsSwim, IsXtrain, IsAero, Date, Time, Planned, Dirty };
+
+        struct instruction {
+            quint8 op, dst, a, b;   // registers
+            qint32 arg;             // constant, slot, series, jump target etc
+        };
+
+        struct reduction {
+            quint8 kind;            // reductionkind
+            bool swapped;           // max(expr, acc) rather than max(acc, expr)
+            int value, mask;        // registers, mask is -1 when unconditional
+            int slot;               // user symbol updated
+        };
+
+    private:
+
+        friend class ::DataFilterCompiler;
+        DataFilterProgram() : registers(1), sampled(false) {}
+
+        double metric(int index, RideItem *m, const QHash<QString,RideMetric*> *c) const;
+        double ride(int field, RideItem *m) const;
+
+        QVector<instruction> code;
+        QVector<double> constants;
+        QVector<QString> names;                 // metric names, metadata may override
+        QVector<int> metrics;                   // index for the metric names
+        QVector<double (*)(double)> functions;  // maths functions
+        QVector<Leaf*> calls;                   // user functions, compiled
+        QVector<int> reads;                     // user symbol slots read, including calls
+        QList<RideFile::SeriesType> series;     // sample data read, vector programs
+        QVector<reduction> reductions;          // vector programs, in statement order
+        int registers;
+        bool sampled;                           // reads sample data
+};
+#endif // _GC_DataFilterProgram_h
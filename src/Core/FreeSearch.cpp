@@ -23,6 +23,9 @@
 #include "IntervalItem.h"
 #include "RideCache.h"
 
+#include <QFile>
+#include <QSaveFile>
+
 FreeSearch::FreeSearch()
 {
     // nothing to do, all the data we need is in the ridecache
@@ -83,38 +86,190 @@ QList<QString> FreeSearch::search(Context* context, QString query)
     // search split will tokenise and handle quoting and escaping
     QStringList tokens = searchSplit(query);
 
-    foreach(RideItem*item, context->athlete->rideCache->rides()) {
+    // rides with metadata or user intervals - even autodiscovered
+    // that contain any of the tokens, in ridecache order
+    QSet<QString> found = context->athlete->freeSearchIndex->search(tokens);
+    if (found.count()) {
+        foreach(RideItem*item, context->athlete->rideCache->rides()) {
+            if (found.contains(item->fileName)) filenames << item->fileName;
+        }
+    }
+
+    emit results(filenames);
+
+    return filenames;
+}
+
+//
+// FreeSearchIndex
+//
+static const quint32 FreeSearchIndexMagic = 0x47465349; // GFSI
+
+FreeSearchIndex::FreeSearchIndex(Context *context) :
+    context(context), loaded(false), checkall(true), changed(false)
+{
+    // anything that might change the texts for a ride
+    connect(context, SIGNAL(rideAdded(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(context, SIGNAL(rideChanged(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(context, SIGNAL(rideSaved(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(context, SIGNAL(rideDirty(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(context, SIGNAL(intervalsUpdate(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(rideDeleted(RideItem*)));
+    connect(context, SIGNAL(intervalsChanged()), this, SLOT(intervalsChanged()));
+
+    // a background refresh updates metadata and renames rides without telling
+    // anyone which, and the calendar text is rewritten when the fields change
+    connect(context, SIGNAL(refreshEnd()), this, SLOT(checkAll()));
+    connect(context, SIGNAL(configChanged(qint32)), this, SLOT(configChanged(qint32)));
+}
+
+// the ridecache is created after us, so the athlete connects it
+void
+FreeSearchIndex::connectRideCache(RideCache *rideCache)
+{
+    connect(rideCache, SIGNAL(itemChanged(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+    connect(rideCache, SIGNAL(itemSaved(RideItem*)), this, SLOT(rideChanged(RideItem*)));
+}
+
+FreeSearchIndex::~FreeSearchIndex()
+{
+    save();
+}
+
+QStringList
+FreeSearchIndex::texts(RideItem *item)
+{
+    QStringList returning;
+
+    QMapIterator<QString,QString> meta(item->metadata());
+    meta.toFront();
+    while (meta.hasNext()) {
+        meta.next();
+        returning << meta.value();
+    }
+
+    foreach(IntervalItem *interval, item->intervals())
+        returning << interval->name;
+
+    return returning;
+}
+
+void
+FreeSearchIndex::rideChanged(RideItem *item)
+{
+    if (item) marked.insert(item);
+}
+
+void
+FreeSearchIndex::rideDeleted(RideItem *item)
+{
+    marked.remove(item);
+    if (loaded) {
+        index.remove(item->fileName);
+        changed = true;
+    }
+}
+
+void
+FreeSearchIndex::intervalsChanged()
+{
+    // we don't know which ride
+    checkall = true;
+}
+
+void
+FreeSearchIndex::checkAll()
+{
+    checkall = true;
+}
+
+void
+FreeSearchIndex::configChanged(qint32 what)
+{
+    if (what & CONFIG_FIELDS) checkall = true;
+}
 
-        QMapIterator<QString,QString> meta(item->metadata());
-        meta.toFront();
-        while (meta.hasNext()) {
-            meta.next();
+QSet<QString>
+FreeSearchIndex::search(const QStringList &tokens)
+{
+    if (!loaded) load();
+    refresh();
+
+    return index.search(tokens);
+}
 
-            // does the super string contain the tokens?
-            foreach(QString token, tokens) {
+void
+FreeSearchIndex::refresh()
+{
+    if (checkall) {
 
-                if (meta.value().contains(token, Qt::CaseInsensitive)) {
-                    filenames << item->fileName;
-                    goto nextItem;
-                }
+        // everything, and remove rides that have gone
+        QSet<QString> current;
+        foreach(RideItem *item, context->athlete->rideCache->rides()) {
+            QStringList list = texts(item);
+            quint64 sig = TextIndex::signature(list);
+            if (!index.contains(item->fileName, sig)) {
+                index.update(item->fileName, sig, list);
+                changed = true;
+            }
+            current.insert(item->fileName);
+        }
+        foreach(QString key, index.keys()) {
+            if (!current.contains(key)) {
+                index.remove(key);
+                changed = true;
             }
         }
 
-        // user intervals - even autodiscovered
-        foreach(IntervalItem *interval, item->intervals()) {
-
-            foreach (QString token, tokens) {
+    } else {
 
-                if (interval->name.contains(token, Qt::CaseInsensitive)) {
-                    filenames << item->fileName;
-                    goto nextItem;
-                }
+        // just the rides that might have changed
+        foreach(RideItem *item, marked) {
+            QStringList list = texts(item);
+            quint64 sig = TextIndex::signature(list);
+            if (!index.contains(item->fileName, sig)) {
+                index.update(item->fileName, sig, list);
+                changed = true;
             }
         }
-        nextItem:;
     }
 
-    emit results(filenames);
+    checkall = false;
+    marked.clear();
+}
 
-    return filenames;
+void
+FreeSearchIndex::load()
+{
+    loaded = true;
+    checkall = true;
+
+    QFile file(context->athlete->home->cache().canonicalPath() + "/freesearch.idx");
+    if (!file.open(QFile::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != FreeSearchIndexMagic || version != FREESEARCH_INDEX_VERSION) return;
+
+    // when it is corrupt we just index everything again
+    if (!index.read(in)) changed = true;
+}
+
+void
+FreeSearchIndex::save()
+{
+    if (!loaded || !changed) return;
+
+    // written to a temporary and renamed, so it is never half written
+    QSaveFile file(context->athlete->home->cache().canonicalPath() + "/freesearch.idx");
+    if (!file.open(QFile::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << FreeSearchIndexMagic << quint32(FREESEARCH_INDEX_VERSION);
+    index.write(out);
+    if (file.commit()) changed = false;
 }
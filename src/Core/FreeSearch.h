@@ -28,6 +28,7 @@
 #include "RideMetadata.h"
 #include "RideCache.h"
 #include "RideItem.h"
+#include "TextIndex.h"
 
 class FreeSearch : public QObject
 {
@@ -52,4 +53,54 @@ private:
     QStringList filenames;
 };
 
+//
+// The metadata and interval names for every ride in a TextIndex, so a search
+// doesn't need to look at every ride. It is loaded from the cache the first
+// time it is used, and rides are indexed again when they change; anything
+// that might change the texts marks the ride, and it is checked against
+// the signature of its texts before the next search.
+//
+// The index is saved in cache/freesearch.idx when the athlete is closed.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+//
+#define FREESEARCH_INDEX_VERSION 1
+
+class FreeSearchIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    FreeSearchIndex(Context *context);
+    ~FreeSearchIndex();
+
+    // rides with texts that contain any of the tokens, ignoring case
+    QSet<QString> search(const QStringList &tokens);
+
+    // the texts we search for a ride
+    static QStringList texts(RideItem *item);
+
+    // listen for changes the ridecache makes to its items
+    void connectRideCache(RideCache *rideCache);
+
+public slots:
+    void rideChanged(RideItem *item);
+    void rideDeleted(RideItem *item);
+    void intervalsChanged();
+    void checkAll();
+    void configChanged(qint32);
+
+private:
+    void load();
+    void refresh();
+    void save();
+
+    Context *context;
+    TextIndex index;
+    bool loaded, checkall, changed;
+    QSet<RideItem*> marked;     // might have changed
+};
+
 #endif
@@ -21,9 +21,11 @@
 #include "Athlete.h"
 #include "RideFileCache.h"
 #include "RideCacheModel.h"
+#include "RideDBStore.h"
 #include "Specification.h"
 #include "DataProcessor.h"
 #include "Estimator.h"
+#include "TaskScheduler.h"
 
 #include "Route.h"
 
@@ -39,8 +41,14 @@
 #include "unistd.h"
 #endif
 
+#include <QLoggingCategory>
+
+Q_DECLARE_LOGGING_CATEGORY(gcRideCache)
+Q_LOGGING_CATEGORY(gcRideCache, "gc.ridecache")
+
 // we initialise the global user metrics
 #include "RideMetric.h"
+#include "MetricAggregate.h"
 #include "UserMetricSettings.h"
 #include "UserMetricParser.h"
 #include "SpecialFields.h"
@@ -63,7 +71,7 @@ private:
         RideCache *cache;
 };
 
-RideCache::RideCache(Context *context) : context(context)
+RideCache::RideCache(Context *context) : context(context), matrix_(this)
 {
     directory = context->athlete->home->activities();
     plannedDirectory = context->athlete->home->planned();
@@ -142,6 +150,9 @@ RideCache::RideCache(Context *context) : context(context)
     std::sort(rides_.begin(), rides_.end(), rideCacheLessThan);
 
     // load the store - will unstale once cache restored
+    store_ = new RideDBStore(context->athlete->home->cache().canonicalPath());
+    connect(this, SIGNAL(itemChanged(RideItem*)), this, SLOT(itemUnstored(RideItem*)));
+    connect(this, SIGNAL(itemSaved(RideItem*)), this, SLOT(itemUnstored(RideItem*)));
     RideCacheLoader *rideCacheLoader = new RideCacheLoader(this);
     connect(rideCacheLoader, SIGNAL(finished()), this, SLOT(postLoad()));
     connect(rideCacheLoader, SIGNAL(finished()), this, SIGNAL(loadComplete()));
@@ -209,6 +220,7 @@ RideCache::~RideCache()
 
     // save to store
     save();
+    delete store_;
 }
 
 void
@@ -245,6 +257,7 @@ RideCache::configChanged(qint32 what)
     if (what & CONFIG_FIELDS) {
         foreach(RideItem *item, rides()) {
             item->metadata_.insert("Calendar Text", GlobalContext::context()->rideMetadata->calendarText(item));
+            item->unstored.storeRelease(1);
         }
     }
 
@@ -259,6 +272,12 @@ RideCache::configChanged(qint32 what)
     }
 }
 
+void
+RideCache::itemUnstored(RideItem *item)
+{
+    if (item) item->unstored.storeRelease(1);
+}
+
 void
 RideCache::itemChanged()
 {
@@ -565,6 +584,7 @@ RideCache::removeRides
 // We use a bison parser to reduce memory
 // overhead and (believe it or not) simplicity
 // RideCache::load() and save() -- see RideDB.y
+// the binary store they use is in RideDBStore.cpp
 
 // export metrics to csv, for users to play with R, Matlab, Excel etc
 void
@@ -668,6 +688,10 @@ RideCache::threadCompleted(RideCacheRefreshThread*thread)
 
     if (isLast && ! cancelled) {
         //fprintf(stderr,"refresh ended\n"); fflush(stderr);
+
+        // where the refresh spent its time, with --debug-rules "gc.ridecache.debug=true"
+        qCDebug(gcRideCache, "refresh timings: %s", TaskScheduler::instance().timings().toLocal8Bit().constData());
+
         context->notifyRefreshEnd();
         garbageCollect();
         QMetaObject::invokeMethod(saveWorker_, [this]() {
@@ -739,23 +763,16 @@ RideCache::refresh()
         //future = QtConcurrent::map(reverse_, itemRefresh);
         //watcher.setFuture(future);
 
-        // calculate number of threads and work per thread
-        int maxthreads = QThreadPool::globalInstance()->maxThreadCount();
-        int threads = maxthreads / 2;
-        if (threads==0) threads=1; // need at least one!
-        int n=0;
-
         // refresh happenning
         updates = 0;
         context->notifyRefreshStart();
+        TaskScheduler::instance().resetTimings();
 
-        while(n++ < threads) {
-
-            // if goes past last make it the last
-            RideCacheRefreshThread *thread = new RideCacheRefreshThread(this);
-            refreshThreads << thread;
-            thread->start();
-        }
+        // one thread feeds the rides to the task scheduler, which
+        // runs them (and the work within each ride) on all cores
+        RideCacheRefreshThread *thread = new RideCacheRefreshThread(this);
+        refreshThreads << thread;
+        thread->start();
 
 
     } else {
@@ -766,6 +783,66 @@ RideCache::refresh()
     }
 }
 
+static_assert(int(MetricAggregate::Total) == int(RideMetric::Total) &&
+              int(MetricAggregate::Average) == int(RideMetric::Average) &&
+              int(MetricAggregate::Peak) == int(RideMetric::Peak) &&
+              int(MetricAggregate::Low) == int(RideMetric::Low) &&
+              int(MetricAggregate::RunningTotal) == int(RideMetric::RunningTotal) &&
+              int(MetricAggregate::MeanSquareRoot) == int(RideMetric::MeanSquareRoot) &&
+              int(MetricAggregate::StdDev) == int(RideMetric::StdDev), "MetricAggregate::Type must match RideMetric::MetricType");
+
+QAtomicInt RideMetricMatrix::changes;
+
+QVector<double>
+RideMetricMatrix::column(Column which, int index)
+{
+    QMutexLocker locker(&lock);
+
+    // drop the columns if anything changed since they were filled, when the
+    // ride list hasn't been touched the comparison is of the shared data only
+    int now = changes.loadAcquire();
+    int count = RideMetricFactory::instance().metricCount();
+    if (now != generation || count != metrics || rides != cache->rides()) {
+        rides = cache->rides();
+        generation = now;
+        metrics = count;
+        for (int c=0; c<Columns; c++) columns[c] = QVector<QVector<double> >(metrics);
+    }
+
+    if (index < 0 || index >= metrics) return QVector<double>();
+
+    QVector<double> &returning = columns[which][index];
+    if (returning.count() == rides.count()) return returning;
+
+    // fill it, as RideItem::getForSymbol, getCountForSymbol and getStdMeanForSymbol
+    returning.resize(rides.count());
+    double *into = returning.data();
+    for (int i=0; i<rides.count(); i++) {
+        RideItem *item = rides[i];
+        bool computed = item->metrics_.size() == metrics;
+
+        switch (which) {
+        default:
+        case Values:
+            {
+                double value = computed ? item->metrics_[index] : 0;
+                into[i] = (std::isnan(value) || std::isinf(value)) ? 0 : value;
+            }
+            break;
+        case Counts:
+            {
+                double count = computed ? item->count_.value(index, 0) : 0;
+                into[i] = count ? count : 1;
+            }
+            break;
+        case StdMeans:
+            into[i] = computed ? item->stdmean_.value(index, 0.0f) : 0;
+            break;
+        }
+    }
+    return returning;
+}
+
 QString
 RideCache::getAggregate(QString name, Specification spec, bool useMetricUnits, bool nofmt)
 {
@@ -776,72 +853,36 @@ RideCache::getAggregate(QString name, Specification spec, bool useMetricUnits, b
         return QString("%1 unknown").arg(name);
     }
 
-    // what we will return
-    double rvalue = 0;
-    double rcount = 0; // using double to avoid rounding issues with int when dividing
-
-    // loop through and aggregate
-    foreach (RideItem *item, rides()) {
+    // the rides to aggregate, gathered from the matrix
+    QVector<double> values = matrix_.values(metric->index());
+    QVector<double> counts = matrix_.counts(metric->index());
+    QVector<double> passed, weights;
+    passed.reserve(values.count());
+    weights.reserve(values.count());
 
-        // skip filtered rides
-        if (!spec.pass(item)) continue;
+    // do we aggregate zero values ?
+    bool aggZero = metric->aggregateZero();
+    bool temp = metric->symbol() == "average_temp";
 
-        // get this value
-        double value = item->getForSymbol(name);
-        double count = item->getCountForSymbol(name); // for averaging
+    for (int i=0; i<values.count() && i<rides_.count(); i++) {
 
-        // check values are bounded, just in case
-        if (std::isnan(value) || std::isinf(value)) value = 0;
+        // skip filtered rides
+        if (!spec.pass(rides_[i])) continue;
 
-        // do we aggregate zero values ?
-        bool aggZero = metric->aggregateZero();
+        double value = values[i];
+        double count = counts[i];
 
-        // set aggZero to false and value to zero if is temperature and -255
-        if (metric->symbol() == "average_temp" && value == RideFile::NA) {
+        // temperature of -255 is zero and left out of the average
+        if (temp && value == RideFile::NA) {
             value = 0;
-            aggZero = false;
-        }
-
-        switch (metric->type()) {
-        case RideMetric::RunningTotal:
-        case RideMetric::Total:
-            rvalue += value;
-            break;
-        default:
-        case RideMetric::Average:
-            {
-            // average should be calculated taking into account
-            // the duration of the ride, otherwise high value but
-            // short rides will skew the overall average
-            if (value || aggZero) {
-                rvalue += value*count;
-                rcount += count;
-            }
-            break;
-            }
-        case RideMetric::Low:
-            {
-            if (value < rvalue) rvalue = value;
-            break;
-            }
-        case RideMetric::Peak:
-            {
-            if (value > rvalue) rvalue = value;
-            break;
-            }
-        case RideMetric::MeanSquareRoot:
-            {
-                rvalue = sqrt((pow(rvalue, 2)*rcount + pow(value,2)*count)/(rcount + count));
-                rcount += count;
-                break;
-            }
+            count = 0;
         }
+        passed << value;
+        weights << count;
     }
 
-    // now compute the average
-    if (metric->type() == RideMetric::Average) {
-        if (rcount) rvalue = rvalue / rcount;
-    }
+    double rvalue = MetricAggregate::aggregate(metric->type(), passed.constData(), weights.constData(),
+                                               passed.count(), aggZero);
 
     const_cast<RideMetric*>(metric)->setValue(rvalue);
     // Format appropriately
@@ -878,18 +919,16 @@ RideCache::getBests(QString symbol, int n, Specification specification, bool use
     if (!metric) return results;
 
     // loop through and aggregate
-    foreach (RideItem *ride, rides_) {
+    QVector<double> values = matrix_.values(metric->index());
+    for (int i=0; i<values.count() && i<rides_.count(); i++) {
 
         // skip filtered rides
-        if (!specification.pass(ride)) continue;
+        if (!specification.pass(rides_[i])) continue;
 
         // get this value
         AthleteBest add;
-        add.nvalue = ride->getForSymbol(symbol, true);
-        add.date = ride->dateTime.date();
-
-        const_cast<RideMetric*>(metric)->setValue(add.nvalue);
-        add.value = metric->toString(useMetricUnits);
+        add.nvalue = values[i];
+        add.date = rides_[i]->dateTime.date();
 
         // nil values are not needed
         if (add.nvalue < 0 || add.nvalue > 0) results << add;
@@ -903,6 +942,12 @@ RideCache::getBests(QString symbol, int n, Specification specification, bool use
     // truncate
     if (results.count() > n) results.erase(results.begin()+n,results.end());
 
+    // format just the ones we return
+    for (int i=0; i<results.count(); i++) {
+        const_cast<RideMetric*>(metric)->setValue(results[i].nvalue);
+        results[i].value = metric->toString(useMetricUnits);
+    }
+
     // return the array with the right number of entries in #1 - n order
     return results;
 }
@@ -2045,38 +2090,47 @@ RideCache::copyPlannedRideFile
 }
 
 
-// refresh metrics
+// refresh metrics, each ride is refreshed as a task on the scheduler
+// alongside the work within each ride, we just feed them and wait
 void RideCacheRefreshThread::run()
 {
-    while (! isInterruptionRequested()) {
-        int n = cache->nextRefresh();
-        //fprintf(stderr, "refreshing %d of %d\n", n+1, cache->reverse_.count()); fflush(stderr);
-        if (n < 0) {
-            //fprintf(stderr, "worker thread exits!\n"); fflush(stderr);
-            goto exitthread;
-        }
+    int count = 0;
+    if (cache) {
+        QMutexLocker locker(&cache->updateMutex);
+        count = cache->reverse_.count();
+    }
 
-        if (isInterruptionRequested()) {
-            goto exitthread;
-        }
+    TaskGroup group;
+    for (int i=0; i<count && !isInterruptionRequested(); i++)
+        group.run([this]() { refreshNext(); });
+    group.wait();
 
-        RideItem *item = nullptr;
-        {
-            QMutexLocker locker(&cache->updateMutex);
-            if (n < cache->reverse_.count()) {
-                item = cache->reverse_[n];
-            }
-        }
+    if (cache) {
+        cache->threadCompleted(this);
+    }
+}
 
-        if (item && item->isstale) {
-            item->refresh();
-            if (item == item->context->currentRideItem()) {
-                item->context->notifyRideChanged(item);
-            }
+// claim the next ride (newest first) and refresh it
+void RideCacheRefreshThread::refreshNext()
+{
+    if (isInterruptionRequested() || !cache) return;
+
+    int n = cache->nextRefresh();
+    //fprintf(stderr, "refreshing %d of %d\n", n+1, cache->reverse_.count()); fflush(stderr);
+    if (n < 0) return;
+
+    RideItem *item = nullptr;
+    {
+        QMutexLocker locker(&cache->updateMutex);
+        if (n < cache->reverse_.count()) {
+            item = cache->reverse_[n];
         }
     }
-exitthread:
-    if (cache) {
-        cache->threadCompleted(this);
+
+    if (item && item->isstale) {
+        item->refresh();
+        if (item == item->context->currentRideItem()) {
+            item->context->notifyRideChanged(item);
+        }
     }
 }
@@ -27,6 +27,8 @@
 
 #include <QVector>
 #include <QThread>
+#include <QMutex>
+#include <QAtomicInt>
 #include <QPointer>
 
 #include <QFuture>
@@ -41,6 +43,51 @@ class AthleteBest;
 class RideCacheModel;
 class Estimator;
 class Banister;
+class RideDBStore;
+class RideCache;
+
+// Metric values of every ride in the cache, a column for each metric in the
+// same order as RideCache::rides(), so aggregating a metric over the rides
+// reads one array rather than looking the metric up by name for each ride.
+// Callers resolve the RideMetric once and use its index().
+//
+// Columns are filled the first time they are asked for and dropped when
+// the rides change or any ride's metrics are recomputed, see touch(). They
+// are returned implicitly shared so a caller can hold on to them while the
+// matrix is refilled.
+class RideMetricMatrix
+{
+    public:
+
+        RideMetricMatrix(RideCache *cache) : cache(cache), generation(-1), metrics(0) {}
+
+        // as stored (metric units), zero when not computed
+        QVector<double> values(int index) { return column(Values, index); }
+
+        // for averaging, never zero
+        QVector<double> counts(int index) { return column(Counts, index); }
+
+        // for aggregating std deviations
+        QVector<double> stdmeans(int index) { return column(StdMeans, index); }
+
+        // whenever ride metrics are recomputed
+        static void touch() { changes.ref(); }
+
+    private:
+
+        enum Column { Values=0, Counts, StdMeans, Columns };
+        QVector<double> column(Column which, int index);
+
+        RideCache *cache;
+        QMutex lock;
+
+        // what the columns were filled from
+        QVector<RideItem*> rides;
+        int generation, metrics;
+        QVector<QVector<double> > columns[Columns];
+
+        static QAtomicInt changes;
+};
 
 class RideCache : public QObject
 {
@@ -65,6 +112,9 @@ class RideCache : public QObject
         // get an aggregate applying the passed spec
         QString getAggregate(QString name, Specification spec, bool useMetricUnits, bool nofmt=false);
 
+        // metric values of all the rides, by metric index
+        RideMetricMatrix &metricMatrix() { return matrix_; }
+
         // get top n bests
         QList<AthleteBest> getBests(QString symbol, int n, Specification specification, bool useMetricUnits=true);
 
@@ -157,10 +207,11 @@ class RideCache : public QObject
 
     public slots:
 
-        // restore / dump cache to disk (json)
+        // restore / dump cache to disk (binary store or json)
         void load();
         void postLoad();
         void save(bool opendata=false, QString filename="");
+        void saveJSON(bool opendata, QString filename);
 
         // clean up refresh threads
         void cleanupThread(RideCacheRefreshThread *thread);
@@ -180,6 +231,9 @@ class RideCache : public QObject
         // item telling us it changed
         void itemChanged();
 
+        // item needs writing to the ride store
+        void itemUnstored(RideItem *item);
+
         // clear deleted objects
         void garbageCollect();
 
@@ -222,6 +276,8 @@ class RideCache : public QObject
         Estimator *estimator;
         bool first; // updated when estimates are marked stale
 
+        RideDBStore *store_; // binary store for metrics, replaces rideDB.json
+
     private:
         bool renameRideFiles(const QString& oldFileName, const QString& newFileName, bool isPlanned, QString &error);
         bool isValidLink(RideItem *item1, RideItem *item2, QString &error);
@@ -230,6 +286,8 @@ class RideCache : public QObject
         bool isCancelled = false;
         QThread *saveThread_ = nullptr;
         QObject *saveWorker_ = nullptr;
+
+        RideMetricMatrix matrix_;
 };
 
 class AthleteBest
@@ -254,6 +312,8 @@ class RideCacheRefreshThread : public QThread
         virtual void run() override;
 
     private:
+        void refreshNext(); // a task, refreshes the next stale ride
+
         QPointer<RideCache> cache;
 };
 
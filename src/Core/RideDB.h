@@ -47,8 +47,7 @@
 #define RIDEDB_VERSION "2.0"
 
 class APIWebService;
-class HttpResponse;
-class HttpRequest;
+struct APIRideSnapshot;
 
 // using context (we are reentrant)
 struct RideDBContext {
@@ -62,8 +61,7 @@ struct RideDBContext {
 
     // api parms
     APIWebService *api;
-    HttpRequest *request;
-    HttpResponse *response;
+    APIRideSnapshot *snapshot;
 
     // the scanner
     void *scanner;
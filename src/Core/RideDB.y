@@ -18,9 +18,11 @@
  */
 
 #include "RideDB.h"
+#include "RideDBStore.h"
 #include "RideFileCache.h"
 #include "SpecialFields.h"
 #include "Settings.h"
+#include <QFileInfo>
 #ifdef GC_WANT_HTTP
 #include "APIWebService.h"
 #endif
@@ -79,8 +81,8 @@ ride: '{' rideelement_list '}'                                  {
                                                                     // a binary search, but suspect this ok < 10000 rides
                                                                     if (jc->api != NULL) {
                                                                     #ifdef GC_WANT_HTTP
-                                                                        // we're listing rides in the api
-                                                                        jc->api->writeRideLine(jc->item, jc->request, jc->response);
+                                                                        // we're taking a snapshot for the api
+                                                                        jc->api->collectRide(jc->item, jc->snapshot);
                                                                     #endif
                                                                     } else {
                                                                         double progress= round(double(jc->loading++) / double(jc->cache->rides().count()) * 100.0f);
@@ -322,8 +324,17 @@ string: STRING                                               { jc->JsonString =
 void 
 RideCache::load()
 {
-    // only load if it exists !
     QFile rideDB(QString("%1/%2").arg(context->athlete->home->cache().canonicalPath()).arg("rideDB.json"));
+
+    // the binary store is much quicker, we only parse rideDB.json when the
+    // store is missing or can't be used, or the json was written after it
+    // by an older version or restored from a backup. The store isn't loaded
+    // then so the next save rewrites it from what the json had.
+    QFileInfo json(rideDB), store(store_->indexFile());
+    bool newer = json.exists() && store.exists() && json.lastModified() > store.lastModified();
+    if (!newer && store_->load(this, context)) return;
+
+    // only load if it exists !
     if (rideDB.exists() && rideDB.open(QFile::ReadOnly)) {
 
         QDir directory = context->athlete->home->activities();
@@ -478,7 +489,23 @@ QString ConstructNameNumberNumberString(QString s0, QString name, QString s1, do
 //          d = json.load(json_data)
 //      print(len(d["RIDES"])
 //
+// Ordinarily the cache is saved to the binary store (see RideDBStore.h) and
+// rideDB.json is only written for export, or when the store can't be written.
+// The web api reads the store too, so it doesn't need the json.
+//
 void RideCache::save(bool opendata, QString filename)
+{
+    // exports are always json
+    if (opendata || filename != "") {
+        saveJSON(opendata, filename);
+        return;
+    }
+
+    // only changed rides are written, if it fails we fall back to the json
+    if (!store_->save(rides())) saveJSON(false, "");
+}
+
+void RideCache::saveJSON(bool opendata, QString filename)
 {
 
     // now save data away - use passed filename if set
@@ -853,34 +880,144 @@ void RideCache::save(bool opendata, QString filename)
 
 #ifdef GC_WANT_HTTP
 #include "RideMetadata.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+
+QSharedPointer<const APIRideSnapshot>
+APIWebService::snapshot(QString athlete)
+{
+    // the binary store the ride cache saves to, or rideDB.json when the
+    // store is missing or older, as RideCache::load() chooses
+    QString cache = QString("%1/%2/cache").arg(home.absolutePath()).arg(athlete);
+    QFileInfo json(cache + "/rideDB.json"), store(cache + "/rideDB.bin");
+    bool binary = store.exists() && !(json.exists() && json.lastModified() > store.lastModified());
+    QFileInfo info = binary ? store : json;
+    if (!info.exists()) return QSharedPointer<const APIRideSnapshot>();
+
+    QString version = QString("%1-%2-%3").arg(info.fileName()).arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size());
+
+    // still current ?
+    {
+        QMutexLocker locker(&lock);
+        QSharedPointer<const APIRideSnapshot> have = snapshots.value(athlete);
+        if (have && have->version == version) return have;
+    }
+
+    // parse the rideDB, without holding the lock so other athletes are not held up
+    QSharedPointer<APIRideSnapshot> snap(new APIRideSnapshot);
+    snap->version = version;
+    snap->sorted = true;
+
+    QFile rideDB(info.filePath());
+    if (binary) {
+
+        // no parsing, the metrics are read straight from the store
+        RideDBStore::read(cache, [&](RideItem &item) { collectRide(item, snap.data()); });
+
+    } else if (rideDB.open(QFile::ReadOnly)) {
+
+        // ok, lets read it in
+        QTextStream stream(&rideDB);
+
+        // Read the entire file into a QString -- we avoid using fopen since it
+        // doesn't handle foreign characters well. Instead we use QFile and parse
+        // from a QString
+        QString contents = stream.readAll();
+        rideDB.close();
+
+        // create scanner context for reentrant parsing
+        RideDBContext *jc = new RideDBContext;
+        jc->cache = NULL;
+        jc->api = this;
+        jc->snapshot = snap.data();
+        jc->old = false;
+
+        // clean item
+        jc->item.path = home.absolutePath() + "/activities";
+        jc->item.context = NULL;
+        jc->item.isstale = jc->item.isdirty = jc->item.isedit = false;
+
+        RideDBlex_init(&scanner);
+
+        // inform the parser/lexer we have a new file
+        RideDB_setString(contents, scanner);
+
+        // setup
+        jc->errors.clear();
+
+        // parse it
+        RideDBparse(jc);
+
+        // clean up
+        RideDBlex_destroy(scanner);
+
+        // regardless of errors we're done !
+        delete jc;
+    }
+
+    // store slots are reused so it isn't in date order like the json
+    if (!snap->sorted) {
+        std::stable_sort(snap->rides.begin(), snap->rides.end(), [](const APIRideSnapshot::ride &a, const APIRideSnapshot::ride &b) {
+            return a.date < b.date || (a.date == b.date && a.time < b.time);
+        });
+        snap->sorted = true;
+    }
+
+    // only keep it if the file wasn't being written while we read it
+    info.refresh();
+    if (QString("%1-%2-%3").arg(info.fileName()).arg(info.lastModified().toMSecsSinceEpoch()).arg(info.size()) == version) {
+        QMutexLocker locker(&lock);
+        snapshots.insert(athlete, snap);
+    }
+    return snap;
+}
+
+void
+APIWebService::collectRide(RideItem &item, APIRideSnapshot *snapshot)
+{
+    APIRideSnapshot::ride add;
+    add.date = item.dateTime.date();
+    add.time = item.dateTime.time();
+    add.fileName = item.fileName;
+    add.metrics = item.metrics();
+    add.metadata = item.metadata();
+
+    if (snapshot->rides.count() && snapshot->rides.last().date > add.date) snapshot->sorted = false;
+    snapshot->rides << add;
+}
 
 void
 APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &response)
 {
     listRideSettings settings;
 
-    // the ride db
-    QString ridedb = QString("%1/%2/cache/rideDB.json").arg(home.absolutePath()).arg(athlete);
-    QFile rideDB(ridedb);
+    // the ride db, as at the last time it changed
+    QSharedPointer<const APIRideSnapshot> rides = snapshot(athlete);
 
     // list activities and associated metrics
     response.setHeader("Content-Type", "text; charset=ISO-8859-1");
 
     // not known..
-    if (!rideDB.exists()) {
+    if (!rides) {
         response.setStatus(404);
         response.write("malformed URL or unknown athlete.\n");
         return;
     }
 
+    // the listing depends upon the rides, the metadata config and the activities
+    QString metaConfig = home.canonicalPath()+"/metadata.xml";
+    QFileInfo activitiesDir(home.absolutePath() + "/" + athlete + "/activities");
+    QString version = QString("%1-%2-%3").arg(rides->version)
+                                         .arg(QFileInfo(metaConfig).lastModified().toMSecsSinceEpoch())
+                                         .arg(activitiesDir.lastModified().toMSecsSinceEpoch());
+    if (notModified(request, response, etag(request, version))) return;
+
     // intervals or rides?
     QString intervalsp = request.getParameter("intervals");
     if (intervalsp.toUpper() == "TRUE") settings.intervals = true;
     else settings.intervals = false;
 
-    // set user data
-    response.setUserData(&settings);
-
     // write headings
     const RideMetricFactory &factory = RideMetricFactory::instance();
     QVector<const RideMetric *> indexed(factory.metricCount());
@@ -915,7 +1052,6 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
     if (metadata.toUpper() != "NONE" && metadata != "") {
 
         // first lets read in meta config
-        QString metaConfig = home.canonicalPath()+"/metadata.xml";
         if (!QFile(metaConfig).exists()) metaConfig = ":/xml/metadata.xml";
 
         // params to readXML - we ignore them
@@ -958,7 +1094,17 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         if(settings.metawanted.count()) nometa = false;
     }
 
-    // list 'em by reading the ride cache from disk
+    // honour the since parameter
+    QString sincep(request.getParameter("since"));
+    QDate since(1900,01,01);
+    if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
+
+    // before parameter
+    QString beforep(request.getParameter("before"));
+    QDate before(3000,01,01);
+    if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
+
+    // list 'em from the ride cache snapshot
     if ((nometa == false || nometrics == false) && settings.intervals == false) {
 
         int i=0;
@@ -990,61 +1136,22 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         }
         response.bwrite("\n");
 
-        // parse the rideDB and write a line for each entry
-        if (rideDB.exists() && rideDB.open(QFile::ReadOnly)) {
-
-            // ok, lets read it in
-            QTextStream stream(&rideDB);
+        // only the rides in the date range, usually they are in date order
+        // so we can go straight to them
+        QVector<APIRideSnapshot::ride>::const_iterator from, to;
+        rides->range(since, before, from, to);
 
-            // Read the entire file into a QString -- we avoid using fopen since it
-            // doesn't handle foreign characters well. Instead we use QFile and parse
-            // from a QString
-            QString contents = stream.readAll();
-            rideDB.close();
+        for (; from != to; ++from) {
 
-            // create scanner context for reentrant parsing
-            RideDBContext *jc = new RideDBContext;
-            jc->cache = NULL;
-            jc->api = this;
-            jc->response = &response;
-            jc->request = &request;
-            jc->old = false;
-
-            // clean item
-            jc->item.path = home.absolutePath() + "/activities";
-            jc->item.context = NULL;
-            jc->item.isstale = jc->item.isdirty = jc->item.isedit = false;
-
-            RideDBlex_init(&scanner);
-
-            // inform the parser/lexer we have a new file
-            RideDB_setString(contents, scanner);
-
-            // setup
-            jc->errors.clear();
-
-            // parse it
-            RideDBparse(jc);
-
-            // clean up
-            RideDBlex_destroy(scanner);
+            // in range?
+            if (from->date < since) continue;
+            if (from->date > before) continue;
 
-            // regardless of errors we're done !
-            delete jc;
+            response.bwrite(rideLine(*from, settings));
         }
 
     } else {
 
-        // honour the since parameter
-        QString sincep(request.getParameter("since"));
-        QDate since(1900,01,01);
-        if (sincep != "") since = QDate::fromString(sincep,"yyyy/MM/dd");
-
-        // before parameter
-        QString beforep(request.getParameter("before"));
-        QDate before(3000,01,01);
-        if (beforep != "") before = QDate::fromString(beforep,"yyyy/MM/dd");
-
         // fast list of rides by traversing the directory
         response.bwrite("\n"); // headings have no metric columns
 
@@ -1054,7 +1161,7 @@ APIWebService::listRides(QString athlete, HttpRequest &request, HttpResponse &re
         names << "*"; // anything
 
         // loop through files, make sure in time range wanted
-        QDir activities(home.absolutePath() + "/" + athlete + "/activities");
+        QDir activities(activitiesDir.filePath());
         foreach(QString name, activities.entryList(names, spec, QDir::Name)) {
 
             // parse it into date and time
@@ -0,0 +1,417 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideDBStore.h"
+#include "RideCache.h"
+#include "RideItem.h"
+#include "IntervalItem.h"
+#include "RideMetric.h"
+#include "Context.h"
+#include "Athlete.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
+#include <cmath>
+#include <cstring>
+
+// metric names in RideMetric::index() order
+static QStringList metricNames()
+{
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    QStringList names;
+    for(int i=0; i<factory.metricCount(); i++) names << QString();
+    for(int i=0; i<factory.metricCount(); i++) {
+        QString name = factory.metricName(i);
+        names[factory.rideMetric(name)->index()] = name;
+    }
+    return names;
+}
+
+static QString rideKey(bool planned, QString fileName)
+{
+    return QString(planned ? "planned/%1" : "activities/%1").arg(fileName);
+}
+
+// sport flags are derived, same as when parsing rideDB.json
+static void setSport(RideItem &item, QString sport)
+{
+    item.sport = sport;
+    item.isBike = item.isRun = item.isSwim = item.isXtrain = item.isAero = false;
+    if (sport == "Bike") item.isBike = true;
+    else if (sport == "Run") item.isRun = true;
+    else if (sport == "Swim") item.isSwim = true;
+    else if (sport == "Aero") item.isAero = true;
+    else item.isXtrain = true;
+}
+
+// rideDB.json drops nan, inf and zero values (unless aggregateZero says
+// the count matters) so we normalise the same way, that way the values
+// restored don't depend upon which store they were restored from
+class RideDBStoreNormaliser
+{
+    public:
+        RideDBStoreNormaliser() {
+            const RideMetricFactory &factory = RideMetricFactory::instance();
+            aggregateZero.fill(false, factory.metricCount());
+            for(int i=0; i<factory.metricCount(); i++) {
+                const RideMetric *m = factory.rideMetric(factory.metricName(i));
+                aggregateZero[m->index()] = m->aggregateZero();
+            }
+        }
+
+        void apply(int index, double &value, double &count) const {
+            if (std::isinf(value) || std::isnan(value)) value = count = 0;
+            else if (value == 0 && !(count > 1.0 && aggregateZero.value(index, false))) count = 0;
+        }
+
+    private:
+        QVector<bool> aggregateZero;
+};
+
+static void serialize(RideItem *item, const RideDBStoreNormaliser &normal, QByteArray &record, QByteArray &side)
+{
+    const QVector<double> &metrics = item->metrics();
+    const QVector<double> &counts = item->counts();
+    int n = metrics.count();
+
+    RideDBStoreRecord r;
+    memset(&r, 0, sizeof(r));
+    if (item->planned) r.flags |= RideDBStoreFile::RecordPlanned;
+    if (item->samples) r.flags |= RideDBStoreFile::RecordSamples;
+    if (item->isAero) r.flags |= RideDBStoreFile::RecordAero;
+    r.dateTime = item->dateTime.toMSecsSinceEpoch();
+    r.fingerprint = item->fingerprint;
+    r.crc = item->crc;
+    r.metacrc = item->metacrc;
+    r.timestamp = item->timestamp;
+    r.dbversion = item->dbversion;
+    r.udbversion = item->udbversion;
+    r.zoneRange = item->zoneRange;
+    r.hrZoneRange = item->hrZoneRange;
+    r.paceZoneRange = item->paceZoneRange;
+    r.color = item->color.rgba();
+    r.weight = item->weight;
+
+    record.resize(RideDBStoreFile::recordSize(n));
+    memcpy(record.data(), &r, sizeof(r));
+    double *values = reinterpret_cast<double*>(record.data() + sizeof(r));
+    double *ncounts = values + n;
+    for(int i=0; i<n; i++) {
+        values[i] = metrics[i];
+        ncounts[i] = counts.value(i, 0);
+        normal.apply(i, values[i], ncounts[i]);
+    }
+
+    // everything else is variable length
+    side.clear();
+    QDataStream out(&side, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << item->fileName << item->present << item->sport << item->overrides_
+        << item->stdmeans() << item->stdvariances() << item->metadata() << item->xdata();
+
+    // interval metrics are mostly zero, so only write the ones that aren't
+    out << quint32(item->intervals().count());
+    foreach(IntervalItem *interval, item->intervals()) {
+        out << interval->name << qint32(interval->type) << interval->start << interval->stop
+            << interval->startKM << interval->stopKM << qint32(interval->displaySequence)
+            << quint32(interval->color.rgba()) << interval->route << interval->test;
+
+        const QVector<double> &imetrics = interval->metrics();
+        const QVector<double> &icounts = interval->counts();
+        quint32 nonzero = 0;
+        for(int i=0; i<imetrics.count(); i++) if (imetrics[i] > 0.00f || imetrics[i] < 0.00f) nonzero++;
+        out << nonzero;
+        for(int i=0; i<imetrics.count(); i++) {
+            if (imetrics[i] > 0.00f || imetrics[i] < 0.00f)
+                out << quint32(i) << imetrics[i] << icounts.value(i, 0);
+        }
+        out << interval->stdmeans() << interval->stdvariances();
+    }
+}
+
+// stdmean and stdvariance maps are keyed by metric index
+static void remapKeys(QMap<int, double> &map, const QVector<int> &remap)
+{
+    QMap<int, double> remapped;
+    QMapIterator<int, double> i(map);
+    while (i.hasNext()) {
+        i.next();
+        int index = remap.value(i.key(), -1);
+        if (index >= 0) remapped.insert(index, i.value());
+    }
+    map = remapped;
+}
+
+// stored metric positions to the current index, -1 if it no longer exists
+static QVector<int> remapping(const QStringList &stored)
+{
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    QVector<int> remap(stored.count(), -1);
+    for(int i=0; i<stored.count(); i++) {
+        const RideMetric *m = factory.rideMetric(stored[i]);
+        if (m) remap[i] = m->index();
+    }
+    return remap;
+}
+
+// a stored record into the item, false if the side data is corrupt
+static bool restore(RideItem &item, int n, const RideDBStoreRecord &r, const double *values, const double *counts,
+                    const QByteArray &side, bool identical, const QVector<int> &remap)
+{
+    item.planned = r.flags & RideDBStoreFile::RecordPlanned;
+    item.samples = r.flags & RideDBStoreFile::RecordSamples;
+    item.dateTime = QDateTime::fromMSecsSinceEpoch(r.dateTime);
+    item.fingerprint = r.fingerprint;
+    item.crc = r.crc;
+    item.metacrc = r.metacrc;
+    item.timestamp = r.timestamp;
+    item.dbversion = r.dbversion;
+    item.udbversion = r.udbversion;
+    item.zoneRange = r.zoneRange;
+    item.hrZoneRange = r.hrZoneRange;
+    item.paceZoneRange = r.paceZoneRange;
+    item.color = QColor::fromRgba(r.color);
+    item.weight = r.weight;
+
+    if (identical) {
+        memcpy(item.metrics().data(), values, n * sizeof(double));
+        memcpy(item.counts().data(), counts, n * sizeof(double));
+    } else {
+        item.metrics().fill(0.0f);
+        item.counts().fill(0.0f);
+        for(int i=0; i<n; i++) {
+            if (remap[i] < 0) continue;
+            item.metrics()[remap[i]] = values[i];
+            item.counts()[remap[i]] = counts[i];
+        }
+    }
+
+    QDataStream in(side);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    QString sport;
+    in >> item.fileName >> item.present >> sport >> item.overrides_
+       >> item.stdmeans() >> item.stdvariances() >> item.metadata() >> item.xdata();
+    setSport(item, sport);
+    if (r.flags & RideDBStoreFile::RecordAero) item.isAero = true;
+    if (!identical) {
+        remapKeys(item.stdmeans(), remap);
+        remapKeys(item.stdvariances(), remap);
+    }
+
+    quint32 intervals = 0;
+    in >> intervals;
+    for(quint32 k=0; k < intervals && in.status() == QDataStream::Ok; k++) {
+
+        IntervalItem interval;
+        qint32 type, seq;
+        quint32 rgba, nonzero;
+        in >> interval.name >> type >> interval.start >> interval.stop >> interval.startKM >> interval.stopKM
+           >> seq >> rgba >> interval.route >> interval.test >> nonzero;
+        interval.type = static_cast<RideFileInterval::intervaltype>(type);
+        interval.displaySequence = seq;
+        interval.color = QColor::fromRgba(rgba);
+
+        for(quint32 j=0; j < nonzero && in.status() == QDataStream::Ok; j++) {
+            quint32 i;
+            double value, count;
+            in >> i >> value >> count;
+            int index = identical ? int(i) : remap.value(i, -1);
+            if (index < 0 || index >= interval.metrics().count()) continue;
+            interval.metrics()[index] = value;
+            interval.counts()[index] = count;
+        }
+        in >> interval.stdmeans() >> interval.stdvariances();
+        if (!identical) {
+            remapKeys(interval.stdmeans(), remap);
+            remapKeys(interval.stdvariances(), remap);
+        }
+        item.addInterval(interval);
+    }
+    return in.status() == QDataStream::Ok;
+}
+
+RideDBStore::RideDBStore(QString directory) :
+    file(directory + "/rideDB.bin", directory + "/rideDB.dat")
+{
+}
+
+void
+RideDBStore::invalidate()
+{
+    QMutexLocker locker(&lock);
+    file.invalidate();
+}
+
+bool
+RideDBStore::load(RideCache *cache, Context *context)
+{
+    QMutexLocker locker(&lock);
+
+    // a clean item we restore into, then copy into the cache
+    RideItem item;
+    item.path = context->athlete->home->activities().canonicalPath();
+    item.context = context;
+    item.isstale = item.isdirty = item.isedit = false;
+
+    // stored metric positions mapped to the current index, they only differ
+    // when metrics have been added or removed since the store was written
+    bool prepared = false, identical = false;
+    QVector<int> remap;
+
+    QString folder = context->athlete->home->root().canonicalPath();
+    double lastProgressUpdate = 0;
+
+    bool loaded = file.load([&](const QStringList &stored, const RideDBStoreRecord &r, const double *values,
+                                const double *counts, const QByteArray &side, double done) -> QString {
+
+        if (!prepared) {
+            prepared = true;
+            identical = (stored == metricNames());
+            remap = remapping(stored);
+        }
+        int n = stored.count();
+
+        double progress = round(done * 100.0f);
+        if (progress > lastProgressUpdate) {
+            context->notifyLoadProgress(folder, progress);
+            lastProgressUpdate = progress;
+        }
+
+        bool ok = restore(item, n, r, values, counts, side, identical, remap);
+
+        // corrupt or the ride no longer exists, the slot is reused
+        QString key;
+        int found = ok ? cache->find(&item) : -1;
+        if (found == -1) {
+            foreach(IntervalItem *x, item.intervals()) delete x;
+        } else {
+            RideItem *restored = cache->rides().at(found);
+            restored->setFrom(item);
+
+            // as on disk, unless the metric definitions changed
+            if (identical) restored->unstored.storeRelease(0);
+            key = rideKey(item.planned, item.fileName);
+        }
+
+        // the cache item owns the intervals now
+        item.clearIntervals();
+        return key;
+    });
+
+    // don't add the temporary to the cache deletelist
+    item.context = NULL;
+
+    return loaded;
+}
+
+bool
+RideDBStore::read(QString directory, std::function<void(RideItem &)> collect)
+{
+    // our own view of the files, the cache that owns them may be writing
+    RideDBStoreFile file(directory + "/rideDB.bin", directory + "/rideDB.dat");
+
+    RideItem item;
+    item.path = QFileInfo(directory).dir().absolutePath() + "/activities";
+    item.context = NULL;
+    item.isstale = item.isdirty = item.isedit = false;
+
+    bool prepared = false, identical = false;
+    QVector<int> remap;
+
+    return file.load([&](const QStringList &stored, const RideDBStoreRecord &r, const double *values,
+                         const double *counts, const QByteArray &side, double) -> QString {
+
+        if (!prepared) {
+            prepared = true;
+            identical = (stored == metricNames());
+            remap = remapping(stored);
+        }
+
+        bool ok = restore(item, stored.count(), r, values, counts, side, identical, remap);
+        if (ok) collect(item);
+
+        foreach(IntervalItem *x, item.intervals()) delete x;
+        item.clearIntervals();
+        return ok ? rideKey(item.planned, item.fileName) : QString();
+    });
+}
+
+bool
+RideDBStore::save(const QVector<RideItem*> &rides)
+{
+    QMutexLocker locker(&lock);
+
+    QStringList current = metricNames();
+    RideDBStoreNormaliser normal;
+
+    // cleared as they are serialized, so a ride that changes while we
+    // write is written again next time, and set again if we fail
+    QList<RideItem*> cleared;
+
+    // just the rides that changed since they were written, and any new ones
+    if (file.canUpdate(current)) {
+
+        QList<RideDBStoreFile::Entry> changed;
+        QSet<QString> live;
+        foreach(RideItem *item, rides) {
+
+            // same rules as rideDB.json
+            if (item->metrics().count() == 0 || item->skipsave == true) continue;
+
+            QString key = rideKey(item->planned, item->fileName);
+            if (live.contains(key)) continue; // duplicate
+            live.insert(key);
+
+            bool unstored = item->unstored.fetchAndStoreOrdered(0);
+            if (unstored) cleared << item;
+            if (!unstored && file.contains(key)) continue;
+
+            RideDBStoreFile::Entry entry;
+            entry.key = key;
+            serialize(item, normal, entry.record, entry.side);
+            changed << entry;
+        }
+        if (file.update(changed, live)) return true;
+
+        foreach(RideItem *item, cleared) item->unstored.storeRelease(1);
+        cleared.clear();
+    }
+
+    // everything, from scratch
+    QList<RideDBStoreFile::Entry> entries;
+    foreach(RideItem *item, rides) {
+
+        // same rules as rideDB.json
+        if (item->metrics().count() == 0 || item->skipsave == true) continue;
+
+        if (item->unstored.fetchAndStoreOrdered(0)) cleared << item;
+
+        RideDBStoreFile::Entry entry;
+        entry.key = rideKey(item->planned, item->fileName);
+        serialize(item, normal, entry.record, entry.side);
+        entries << entry;
+    }
+    if (file.rewrite(current, entries)) return true;
+
+    foreach(RideItem *item, cleared) item->unstored.storeRelease(1);
+    return false;
+}
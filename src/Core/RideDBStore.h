@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideDBStore_h
+#define _GC_RideDBStore_h 1
+#include "GoldenCheetah.h"
+#include "RideDBStoreFile.h"
+
+#include <QString>
+#include <QMutex>
+#include <functional>
+
+class RideCache;
+class RideItem;
+class Context;
+
+//
+// Binary store for the ride cache, used in place of cache/rideDB.json to
+// restore pre-computed metrics at startup.
+//
+// Each RideItem is one record in cache/rideDB.bin holding the scalar state
+// along with the metric values and counts in RideMetric::index() order, and
+// anything variable length (filename, metadata, xdata, intervals etc) is in
+// the side table cache/rideDB.dat, see RideDBStoreFile for the layout.
+//
+// The files are memory mapped on load so there is no parsing of numbers.
+// RideItem::unstored is set whenever a ride changes (refresh, itemChanged and
+// itemSaved) and save only serializes and writes those rides, plus any that
+// are new. The store is rewritten from scratch when the metric definitions
+// change or when the side table is mostly garbage.
+//
+class RideDBStore
+{
+    public:
+
+        RideDBStore(QString directory);
+
+        // restore metrics for rides in the cache, returns false if the store
+        // is missing or unusable, the caller should fall back to rideDB.json
+        bool load(RideCache *cache, Context *context);
+
+        // read the store in directory without a ride cache, as the web api
+        // does; the item and its intervals are only valid during collect
+        static bool read(QString directory, std::function<void(RideItem &)> collect);
+
+        // write away any rides that have changed since the last save
+        bool save(const QVector<RideItem*> &rides);
+
+        // forget everything, the next save will rewrite the store
+        void invalidate();
+
+        // file names, for diagnostics and cleanup
+        QString indexFile() const { return file.indexFile(); }
+        QString sideFile() const { return file.sideFile(); }
+
+    private:
+
+        QMutex lock;
+        RideDBStoreFile file;
+};
+#endif // _GC_RideDBStore_h
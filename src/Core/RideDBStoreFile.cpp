@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RideDBStoreFile.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+#include <cstring>
+#include <cstddef>
+
+static const char indexMagic[8] = { 'G','C','R','I','D','E','D','B' };
+static const char sideMagic[8] = { 'G','C','R','I','D','E','D','T' };
+
+// newline separated, padded to keep the records aligned
+static QByteArray encodeNames(const QStringList &names)
+{
+    QByteArray encoded = names.join("\n").toUtf8();
+    while (encoded.size() % 8) encoded.append('\0');
+    return encoded;
+}
+
+RideDBStoreFile::RideDBStoreFile(QString indexName, QString sideName) :
+    indexName(indexName), sideName(sideName),
+    valid(false), generation(0), records(0), sideSize(0), sideGarbage(0)
+{
+}
+
+quint32
+RideDBStoreFile::recordSize(int metrics)
+{
+    return sizeof(RideDBStoreRecord) + 2 * metrics * sizeof(double);
+}
+
+bool
+RideDBStoreFile::canUpdate(const QStringList &current) const
+{
+    // start over when the metric definitions changed
+    // or more than half the side table is garbage
+    return valid && names == current && !(sideGarbage > 1024*1024 && sideGarbage * 2 > sideSize);
+}
+
+bool
+RideDBStoreFile::load(Restore restore)
+{
+    valid = false;
+    keySlots.clear();
+    freeSlots.clear();
+
+    QFile index(indexName), side(sideName);
+    if (!index.exists() || !side.exists()) return false;
+    if (!index.open(QFile::ReadOnly) || !side.open(QFile::ReadOnly)) return false;
+
+    qint64 isize = index.size();
+    qint64 ssize = side.size();
+    if (isize < qint64(sizeof(RideDBStoreHeader)) || ssize < qint64(sizeof(RideDBStoreSideHeader))) return false;
+
+    // unmapped when the files are closed
+    const uchar *ibase = index.map(0, isize);
+    const uchar *sbase = side.map(0, ssize);
+    if (!ibase || !sbase) return false;
+
+    RideDBStoreHeader header;
+    RideDBStoreSideHeader sheader;
+    memcpy(&header, ibase, sizeof(header));
+    memcpy(&sheader, sbase, sizeof(sheader));
+
+    // sanity check before we trust any offsets
+    quint64 base = sizeof(header) + header.namesSize;
+    if (memcmp(header.magic, indexMagic, sizeof(indexMagic)) || header.version != RIDEDB_STORE_VERSION ||
+        memcmp(sheader.magic, sideMagic, sizeof(sideMagic)) || sheader.generation != header.generation ||
+        header.recordSize != recordSize(header.metrics) || header.sideSize > quint64(ssize) ||
+        header.namesSize > quint64(isize) || base + quint64(header.records) * header.recordSize > quint64(isize))
+        return false;
+
+    QStringList stored = QString::fromUtf8(reinterpret_cast<const char*>(ibase + sizeof(header)), header.namesSize)
+                         .remove(QChar('\0')).split("\n");
+    if (header.metrics == 0) stored.clear();
+    if (stored.count() != int(header.metrics)) return false;
+
+    int n = stored.count();
+    quint64 garbage = header.sideGarbage;
+    QVector<double> values(n), counts(n);
+
+    for(quint32 slot=0; slot < header.records; slot++) {
+
+        const uchar *p = ibase + base + quint64(slot) * header.recordSize;
+        RideDBStoreRecord r;
+        memcpy(&r, p, sizeof(r));
+
+        if (!(r.flags & RecordUsed)) {
+            freeSlots << slot;
+            continue;
+        }
+
+        // side data beyond the committed length was written by an update that
+        // never completed, drop the record and let the ride refresh
+        if (r.sideOffset < sizeof(sheader) || r.sideOffset + r.sideLength > header.sideSize) {
+            freeSlots << slot;
+            continue;
+        }
+
+        // copied out, the mapping isn't aligned for doubles on every platform
+        memcpy(values.data(), p + sizeof(r), n * sizeof(double));
+        memcpy(counts.data(), p + sizeof(r) + n * sizeof(double), n * sizeof(double));
+        QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char*>(sbase + r.sideOffset), r.sideLength);
+
+        QString key = restore(stored, r, values.constData(), counts.constData(), data, double(slot) / double(header.records));
+
+        if (key.isEmpty() || keySlots.contains(key)) {
+            freeSlots << slot;
+            garbage += r.sideLength;
+        } else {
+            keySlots.insert(key, slot);
+        }
+    }
+
+    valid = true;
+    names = stored;
+    generation = header.generation;
+    records = header.records;
+    sideSize = header.sideSize;
+    sideGarbage = garbage;
+    return true;
+}
+
+bool
+RideDBStoreFile::update(const QList<Entry> &changed, const QSet<QString> &live)
+{
+    if (!valid) return false;
+
+    QFile index(indexName), side(sideName);
+    if (!index.open(QFile::ReadWrite) || !side.open(QFile::ReadWrite)) {
+        valid = false;
+        return false;
+    }
+
+    quint32 size = recordSize(names.count());
+    quint64 base = sizeof(RideDBStoreHeader) + encodeNames(names).size();
+    if (quint64(index.size()) < base + quint64(records) * size || quint64(side.size()) < sideSize) {
+        valid = false;
+        return false;
+    }
+
+    uchar *ibase = index.map(0, index.size());
+    uchar *sbase = side.map(0, side.size());
+    if (!ibase || !sbase) {
+        valid = false;
+        return false;
+    }
+
+    // an entry the caller thinks changed may be the same as on disk,
+    // e.g. a refresh that computed the same values, skip those
+    struct Change {
+        qint64 slot;
+        const Entry *entry;
+        QByteArray record;
+    };
+    QList<Change> changes;
+    RideDBStoreRecord was, is;
+
+    for(int k=0; k<changed.count(); k++) {
+
+        const Entry &entry = changed.at(k);
+        if (entry.record.size() != int(size)) {
+            index.unmap(ibase);
+            side.unmap(sbase);
+            valid = false;
+            return false;
+        }
+
+        Change change;
+        change.slot = keySlots.contains(entry.key) ? keySlots.value(entry.key) : -1;
+        change.entry = &entry;
+        change.record = entry.record;
+
+        if (change.slot >= 0) {
+            const uchar *old = ibase + base + quint64(change.slot) * size;
+            const uchar *now = reinterpret_cast<const uchar*>(entry.record.constData());
+            const size_t from = offsetof(RideDBStoreRecord, dateTime);
+            memcpy(&was, old, sizeof(was));
+            memcpy(&is, now, sizeof(is));
+
+            // unchanged if everything but the side offset matches
+            if ((was.flags & ~RecordUsed) == (is.flags & ~RecordUsed) &&
+                !memcmp(old + from, now + from, size - from) &&
+                was.sideLength == quint32(entry.side.size()) &&
+                !memcmp(sbase + was.sideOffset, entry.side.constData(), entry.side.size()))
+                continue;
+
+            sideGarbage += was.sideLength;
+        }
+        changes << change;
+    }
+
+    // slots for keys that have gone
+    QList<quint32> released;
+    QMutableHashIterator<QString, quint32> i(keySlots);
+    while (i.hasNext()) {
+        i.next();
+        if (!live.contains(i.key())) {
+            memcpy(&was, ibase + base + quint64(i.value()) * size, sizeof(was));
+            sideGarbage += was.sideLength;
+            released << i.value();
+            i.remove();
+        }
+    }
+
+    index.unmap(ibase);
+    side.unmap(sbase);
+
+    // the header is written even when nothing changed, so the store is
+    // always newer than a rideDB.json written before it
+
+    // side data first, anything past the committed length is ignored on load
+    // so an update that doesn't complete leaves the store consistent
+    quint64 offset = sideSize;
+    bool ok = side.seek(offset);
+    for(int k=0; ok && k<changes.count(); k++) {
+        Change &change = changes[k];
+
+        RideDBStoreRecord r;
+        memcpy(&r, change.record.constData(), sizeof(r));
+        r.flags |= RecordUsed;
+        r.sideOffset = offset;
+        r.sideLength = change.entry->side.size();
+        memcpy(change.record.data(), &r, sizeof(r));
+
+        ok = side.write(change.entry->side) == change.entry->side.size();
+        offset += change.entry->side.size();
+    }
+    ok = ok && side.flush();
+
+    // now the records, reusing free slots before growing
+    for(int k=0; ok && k<changes.count(); k++) {
+        Change &change = changes[k];
+        if (change.slot < 0) change.slot = freeSlots.isEmpty() ? records++ : freeSlots.takeLast();
+        ok = index.seek(base + quint64(change.slot) * size) && index.write(change.record) == change.record.size();
+        keySlots.insert(change.entry->key, change.slot);
+    }
+    quint32 unused = 0;
+    foreach(quint32 slot, released) {
+        if (!ok) break;
+        ok = index.seek(base + quint64(slot) * size) && index.write(reinterpret_cast<const char*>(&unused), sizeof(unused)) == sizeof(unused);
+        freeSlots << slot;
+    }
+
+    // and lastly the header commits the side table length
+    sideSize = offset;
+    RideDBStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = RIDEDB_STORE_VERSION;
+    header.metrics = names.count();
+    header.records = records;
+    header.recordSize = size;
+    header.namesSize = base - sizeof(header);
+    header.generation = generation;
+    header.sideSize = sideSize;
+    header.sideGarbage = sideGarbage;
+    ok = ok && index.seek(0) && index.write(reinterpret_cast<const char*>(&header), sizeof(header)) == sizeof(header);
+
+    // if anything went wrong the caller rewrites
+    if (!ok) valid = false;
+    return ok;
+}
+
+bool
+RideDBStoreFile::rewrite(const QStringList &current, const QList<Entry> &entries)
+{
+    valid = false;
+    keySlots.clear();
+    freeSlots.clear();
+
+    quint32 size = recordSize(current.count());
+
+    QSaveFile index(indexName), side(sideName);
+    if (!index.open(QIODevice::WriteOnly) || !side.open(QIODevice::WriteOnly)) return false;
+
+    // a new generation, so an index can never be paired with an old side table
+    quint64 gen = QDateTime::currentMSecsSinceEpoch();
+    if (gen <= generation) gen = generation + 1;
+
+    RideDBStoreSideHeader sheader;
+    memcpy(sheader.magic, sideMagic, sizeof(sideMagic));
+    sheader.generation = gen;
+    side.write(reinterpret_cast<const char*>(&sheader), sizeof(sheader));
+
+    QByteArray encoded = encodeNames(current);
+    RideDBStoreHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = RIDEDB_STORE_VERSION;
+    header.metrics = current.count();
+    header.recordSize = size;
+    header.namesSize = encoded.size();
+    header.generation = gen;
+
+    // header is rewritten once we know the counts
+    index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    index.write(encoded);
+
+    QHash<QString, quint32> written;
+    quint64 offset = sizeof(sheader);
+
+    foreach(const Entry &entry, entries) {
+
+        if (written.contains(entry.key) || entry.record.size() != int(size)) continue;
+
+        QByteArray record = entry.record;
+        RideDBStoreRecord r;
+        memcpy(&r, record.constData(), sizeof(r));
+        r.flags |= RecordUsed;
+        r.sideOffset = offset;
+        r.sideLength = entry.side.size();
+        memcpy(record.data(), &r, sizeof(r));
+
+        side.write(entry.side);
+        index.write(record);
+        offset += entry.side.size();
+
+        written.insert(entry.key, header.records++);
+    }
+
+    header.sideSize = offset;
+    index.seek(0);
+    index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // side table first, a new index with an old side table fails the generation check
+    if (!side.commit() || !index.commit()) return false;
+
+    valid = true;
+    names = current;
+    generation = gen;
+    records = header.records;
+    sideSize = offset;
+    sideGarbage = 0;
+    keySlots = written;
+    return true;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideDBStoreFile_h
+#define _GC_RideDBStoreFile_h 1
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVector>
+#include <functional>
+
+//
+// The files behind RideDBStore, without any knowledge of rides.
+//
+// cache/rideDB.bin is the index; a header, the names of the metrics it was
+// written with and then one fixed size record per ride, a RideDBStoreRecord
+// followed by the metric values and then the counts.
+//
+// Anything variable length is in a side table, cache/rideDB.dat, that is only
+// ever appended to; records reference their side data by offset and length.
+// The header commits the length of the side table, it is written last so an
+// update that doesn't complete leaves the store as it was.
+//
+// Records are identified by a key the caller derives from their side data,
+// they are only rewritten when the caller says they changed and are released
+// when their key is no longer live.
+//
+// Files are in host byte order, they are a cache and can always be rebuilt.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+//
+#define RIDEDB_STORE_VERSION 1
+
+// on disk layout, all fields are naturally aligned so
+// the structs have no padding and records stay 8 byte aligned
+struct RideDBStoreHeader {
+    char magic[8];
+    quint32 version;
+    quint32 metrics;        // metrics per record
+    quint32 records;        // record slots, in use or free
+    quint32 recordSize;     // bytes per record including the metric arrays
+    quint64 namesSize;      // bytes of metric names following the header
+    quint64 generation;     // must match the side table header
+    quint64 sideSize;       // committed length of the side table
+    quint64 sideGarbage;    // bytes in the side table no longer referenced
+};
+
+struct RideDBStoreSideHeader {
+    char magic[8];
+    quint64 generation;
+};
+
+struct RideDBStoreRecord {
+    quint32 flags;
+    quint32 sideLength;     // set by RideDBStoreFile
+    quint64 sideOffset;     // set by RideDBStoreFile
+    qint64 dateTime;        // msecs since epoch
+    quint64 fingerprint, crc, metacrc, timestamp;
+    qint32 dbversion, udbversion;
+    qint32 zoneRange, hrZoneRange, paceZoneRange;
+    quint32 color;
+    double weight;
+    // followed by double values[metrics] then double counts[metrics]
+};
+
+class RideDBStoreFile
+{
+    public:
+
+        // RecordUsed is ours, the rest are for the caller
+        enum { RecordUsed=0x01, RecordPlanned=0x02, RecordSamples=0x04, RecordAero=0x08 };
+
+        // a record as the caller gives it to us
+        struct Entry {
+            QString key;
+            QByteArray record;      // recordSize() bytes
+            QByteArray side;
+        };
+
+        // for each record in use; return its key to keep it, or an empty
+        // key to release it (corrupt or the ride no longer exists)
+        typedef std::function<QString(const QStringList &names, const RideDBStoreRecord &record,
+                                      const double *values, const double *counts, const QByteArray &side,
+                                      double progress)> Restore;
+
+        RideDBStoreFile(QString indexName, QString sideName);
+
+        static quint32 recordSize(int metrics);
+
+        // read the store, false if it is missing or unusable
+        bool load(Restore restore);
+
+        // write just the entries given, releasing records whose key isn't
+        // live; false if it can't and the caller should rewrite()
+        bool update(const QList<Entry> &changed, const QSet<QString> &live);
+
+        // write everything from scratch, the entries are all there is
+        bool rewrite(const QStringList &names, const QList<Entry> &entries);
+
+        // is an update with these metric names possible
+        bool canUpdate(const QStringList &names) const;
+        bool contains(const QString &key) const { return keySlots.contains(key); }
+        void invalidate() { valid = false; }
+
+        QString indexFile() const { return indexName; }
+        QString sideFile() const { return sideName; }
+
+        // for diagnostics and tests
+        QStringList metricNames() const { return names; }
+        quint32 recordCount() const { return records; }
+        quint64 sideLength() const { return sideSize; }
+        quint64 garbage() const { return sideGarbage; }
+
+    private:
+
+        QString indexName, sideName;
+
+        // state of the store on disk, as last loaded or saved
+        bool valid;
+        QStringList names;          // metric names in record order
+        quint64 generation;         // pairs the index with its side table
+        quint32 records;            // number of record slots
+        quint64 sideSize;           // committed length of the side table
+        quint64 sideGarbage;        // bytes in the side table no longer referenced
+        QHash<QString, quint32> keySlots; // key -> record slot
+        QVector<quint32> freeSlots; // record slots that can be reused
+};
+
+#endif // _GC_RideDBStoreFile_h
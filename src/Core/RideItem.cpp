@@ -31,6 +31,9 @@
 #include "Settings.h"
 #include "Colors.h" // for ColorEngine
 #include "AddIntervalDialog.h" // till we fixup ridefilecache to have offsets
+#include "PeakEngine.h" // single pass peak discovery
+#include "ZoneEngine.h" // single pass time in zone
+#include "TaskScheduler.h" // stage timings
 #include "TimeUtils.h" // time_to_string()
 #include "WPrime.h" // for matches
 
@@ -132,6 +135,8 @@ RideItem::setFrom(RideItem&here, bool temp) // used when loading cache/rideDB.js
     weight = here.weight;
     overrides_ = here.overrides_;
     samples = here.samples;
+
+    RideMetricMatrix::touch();
 }
 
 // set the metric array
@@ -150,6 +155,7 @@ RideItem::setFrom(QHash<QString, RideMetricPtr> computed)
             stdvariance_.insert(i.value()->index(), stdvariance);
         }
     }
+    RideMetricMatrix::touch();
 }
 
 // calculate metadata crc
@@ -501,12 +507,12 @@ RideItem::checkStale()
 
             // get the new zone configuration fingerprint that applies for the ride date
             unsigned long rfingerprint = static_cast<unsigned long>(context->athlete->zones(sport)->getFingerprint(dateTime.date()))
-                        + (appsettings->cvalue(context->athlete->cyclist, context->athlete->zones(sport)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
+                        + (GSettingsSnapshot::cvalue(context->athlete->cyclist, context->athlete->zones(sport)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
                         + static_cast<unsigned long>(context->athlete->paceZones(isSwim)->getFingerprint(dateTime.date()))
                         + static_cast<unsigned long>(context->athlete->hrZones(sport)->getFingerprint(dateTime.date()))
-                        + static_cast<unsigned long>(context->athlete->routes->getFingerprint())
+                        + static_cast<unsigned long>(context->athlete->routes->getFingerprint(this))
                         + static_cast<unsigned long>(getHrvFingerprint())
-                        + appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+                        + GSettingsSnapshot::cvalue(context->athlete->cyclist, GCK_DISCOVERY);
 
             if (fingerprint != rfingerprint) {
 
@@ -598,6 +604,7 @@ RideItem::refresh()
     RideFile *f;
     bool doclose = false;
     if (!isOpen()) { 
+        TaskStageTimer timer("parse");
         doclose = true;
         f = ride(); // will call us but isstale is false above
     } else f=ride_;
@@ -648,9 +655,6 @@ RideItem::refresh()
         if (context->athlete->paceZones(isSwim)) paceZoneRange = context->athlete->paceZones(isSwim)->whichRange(dateTime.date());
         else paceZoneRange = -1;
 
-        // RideFile cache refresh before metrics, as meanmax may be used in user formulas
-        RideFileCache updater(context, context->athlete->home->activities().canonicalPath() + "/" + fileName, getWeight(), ride_, true);
-
         // refresh metrics etc
         const RideMetricFactory &factory = RideMetricFactory::instance();
 
@@ -659,8 +663,25 @@ RideItem::refresh()
         metrics_.fill(0, factory.metricCount());
         count_.fill(0, factory.metricCount());
 
-        // we compute all with not specification (not an interval)
-        QHash<QString,RideMetricPtr> computed= RideMetric::computeMetrics(this, Specification(), factory.allMetrics());
+        QHash<QString,RideMetricPtr> computed;
+        {
+            // the .cpx and the metrics share one time in zone classification
+            ZoneEngine zones(ride_, Specification());
+            ZoneEngine::Scope zoneScope(&zones);
+
+            // and the columns they read, freed once they are all done
+            RideFile::ColumnsScope columnsScope(ride_);
+
+            // RideFile cache refresh before metrics, as meanmax may be used in user formulas
+            {
+                TaskStageTimer timer("cache");
+                RideFileCache updater(context, context->athlete->home->activities().canonicalPath() + "/" + fileName, getWeight(), ride_, true);
+            }
+
+            // we compute all with not specification (not an interval)
+            TaskStageTimer timer("metrics");
+            computed = RideMetric::computeMetrics(this, Specification(), factory.allMetrics());
+        }
 
         // snaffle away all the computed values into the array
         QHashIterator<QString, RideMetricPtr> i(computed);
@@ -685,16 +706,22 @@ RideItem::refresh()
             }
 
         // Update auto intervals AFTER ridefilecache as used for bests
-        updateIntervals();
+        {
+            TaskStageTimer timer("intervals");
+            updateIntervals();
+        }
+
+        // the cache's metric matrix needs refilling
+        RideMetricMatrix::touch();
 
         // update fingerprints etc, crc done above
         fingerprint = static_cast<unsigned long>(context->athlete->zones(sport)->getFingerprint(dateTime.date()))
-                    + (appsettings->cvalue(context->athlete->cyclist, context->athlete->zones(sport)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
+                    + (GSettingsSnapshot::cvalue(context->athlete->cyclist, context->athlete->zones(sport)->useCPforFTPSetting(), 0).toInt() ? 1 : 0)
                     + static_cast<unsigned long>(context->athlete->paceZones(isSwim)->getFingerprint(dateTime.date()))
                     + static_cast<unsigned long>(context->athlete->hrZones(sport)->getFingerprint(dateTime.date()))
-                    + static_cast<unsigned long>(context->athlete->routes->getFingerprint()) +
+                    + static_cast<unsigned long>(context->athlete->routes->getFingerprint(this)) +
                     + static_cast<unsigned long>(getHrvFingerprint())
-                    + appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+                    + GSettingsSnapshot::cvalue(context->athlete->cyclist, GCK_DISCOVERY);
 
         dbversion = DBSchemaVersion;
         udbversion = UserMetricSchemaVersion;
@@ -706,6 +733,9 @@ RideItem::refresh()
         // Construct the summary text used on the calendar
         metadata_.insert("Calendar Text", GlobalContext::context()->rideMetadata->calendarText(this));
 
+        // and the ride store needs to write it
+        unstored.storeRelease(1);
+
         // close if we opened it
         if (doclose) {
             close();
@@ -740,7 +770,7 @@ RideItem::getWeight(int type)
         if (weight <= 0.00) weight = metadata_.value("Weight", "0.0").toDouble();
 
         // global options and if not set default to 75 kg.
-        if (weight <= 0.00) weight = appsettings->cvalue(context->athlete->cyclist, GC_WEIGHT, "75.0").toString().toDouble();
+        if (weight <= 0.00) weight = GSettingsSnapshot::cvalue(context->athlete->cyclist, GCK_WEIGHT).toDouble();
 
         // No weight default is weird, we'll set to 80kg
         if (weight <= 0.00) weight = 80.00;
@@ -897,7 +927,7 @@ void
 RideItem::updateIntervals()
 {
     // what do we need ?
-    int discovery = appsettings->cvalue(context->athlete->cyclist, GC_DISCOVERY, 57).toInt(); // 57 does not include search for PEAKS
+    int discovery = GSettingsSnapshot::cvalue(context->athlete->cyclist, GCK_DISCOVERY);
 
     // DO NOT USE ride() since it will call a refresh !
     RideFile *f = ride_;
@@ -905,6 +935,10 @@ RideItem::updateIntervals()
     QList<IntervalItem*> deletelist = intervals_;
     intervals_.clear();
 
+    // where it went, so adding a route only makes
+    // the rides that could contain it stale
+    context->athlete->routes->index(this, samples ? f : NULL);
+
     // no ride data available ?
     if (!samples) {
         context->notifyIntervalsUpdate(this);
@@ -1017,11 +1051,15 @@ RideItem::updateIntervals()
                                 tr("1 minute"), tr("5 minutes"), tr("10 minutes"), tr("20 minutes"), tr("30 minutes"), tr("45 minutes"),
                                 tr("1 hour") };
     
+        // go hunting for all the best peaks in one pass
+        QVector<double> windows;
+        for(int i=0; durations[i] != 0; i++) windows << durations[i];
+        QVector<PeakEngine::Peak> peaks = PeakEngine(f, Specification()).peaks(RideFile::watts, true, windows);
+
         for(int i=0; durations[i] != 0; i++) {
 
-            // go hunting for best peak
             QList<AddIntervalDialog::AddedInterval> results;
-            AddIntervalDialog::findPeaks(context, true, f, Specification(), RideFile::watts, RideFile::original, durations[i], 1, results, "", "");
+            if (peaks[i].found) results << AddIntervalDialog::AddedInterval(peaks[i].start, peaks[i].stop, peaks[i].avg);
 
             // did we get one ?
             if (results.count() > 0 && results[0].avg > 0 && results[0].stop > 0) {
@@ -1052,11 +1090,15 @@ RideItem::updateIntervals()
                                 tr("1 hour") };
 
         bool metric = appsettings->value(this, context->athlete->paceZones(f->isSwim())->paceSetting(), GlobalContext::context()->useMetricUnits).toBool();
+        // go hunting for all the best peaks in one pass
+        QVector<double> windows;
+        for(int i=0; durations[i] != 0; i++) windows << durations[i];
+        QVector<PeakEngine::Peak> peaks = PeakEngine(f, Specification()).peaks(RideFile::kph, true, windows);
+
         for(int i=0; durations[i] != 0; i++) {
 
-            // go hunting for best peak
             QList<AddIntervalDialog::AddedInterval> results;
-            AddIntervalDialog::findPeaks(context, true, f, Specification(), RideFile::kph, RideFile::original, durations[i], 1, results, "", "");
+            if (peaks[i].found) results << AddIntervalDialog::AddedInterval(peaks[i].start, peaks[i].stop, peaks[i].avg);
 
             // did we get one ?
             if (results.count() > 0 && results[0].avg > 0 && results[0].stop > 0) {
@@ -27,6 +27,7 @@
 #include <QString>
 #include <QMap>
 #include <QVector>
+#include <QAtomicInt>
 
 class RideFile;
 class RideFileCache;
@@ -101,6 +102,7 @@ class RideItem : public QObject
         bool isstale;     // metric data is out of date and needs recomputing
         bool isedit;      // is being edited at the moment
         bool skipsave;    // on exit we don't save the state to force rebuild at startup
+        QAtomicInt unstored {1}; // changed since RideDBStore last wrote it
 
         // set from another, e.g. during load of rideDB.json
         void setFrom(RideItem&, bool temp=false);
@@ -32,6 +32,8 @@
 #include <QXmlSimpleReader>
 #include <QDebug>
 
+#include <algorithm>
+
 Q_DECLARE_LOGGING_CATEGORY(gcRoutes)
 Q_LOGGING_CATEGORY(gcRoutes, "gc.routes")
 
@@ -40,17 +42,19 @@ Q_LOGGING_CATEGORY(gcRoutes, "gc.routes")
 
 #define pi 3.14159265358979323846
 
+double deg2rad(double deg);
+
 /*
  * RouteSegment
  *
  */
-RouteSegment::RouteSegment() : minLat(180), maxLat(-180), minLon(180), maxLon(-180)
+RouteSegment::RouteSegment() : minLat(180), maxLat(-180), minLon(180), maxLon(-180), anywhere(false)
 {
 
     _id = QUuid::createUuid(); // in case it isn't set yet
 }
 
-RouteSegment::RouteSegment(Routes *routes) : routes(routes)
+RouteSegment::RouteSegment(Routes *routes) : routes(routes), anywhere(false)
 {
     _id = QUuid::createUuid(); // in case it isn't set yet
 }
@@ -105,13 +109,26 @@ RouteSegment::setMaxLon(double _maxLon) {
     maxLon = _maxLon;
 }
 
-QList<RoutePoint> RouteSegment::getPoints() {
+const QList<RoutePoint> &RouteSegment::getPoints() const {
     return points;
 }
 
 int
 RouteSegment::addPoint(RoutePoint _point)
 {
+    // a ride must pass within 100m of the first point and every other point
+    // except the last to match (see search below), so as each point is added
+    // we need the one before it, or the first point itself
+    const RoutePoint *required = NULL;
+    if (points.count() == 0) required = &_point;
+    else if (points.count() > 1) required = &points.last();
+
+    if (required) {
+        RouteIndex::box b;
+        if (!RouteIndex::near(required->lat, required->lon, 0.1, b)) anywhere = true;
+        else if (boxes.isEmpty() || !(boxes.last() == b)) boxes << b;
+    }
+
     points.append(_point);
 
     // Update Min-Max
@@ -145,15 +162,21 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
     int lastpoint = -1; // Last point to match
     double start = -1, stop = -1; // Start and stop secs
 
-    for (int n=0; n< this->getPoints().count();n++) {
-        RoutePoint routepoint = this->getPoints().at(n);
+    const QVector<RideFilePoint*> &data = ride->dataPoints();
+
+    for (int n=0; n< points.count();n++) {
+        const RoutePoint &routepoint = points.at(n);
+
+        // the same for every sample we compare with
+        double sinlat = sin(deg2rad(routepoint.lat));
+        double coslat = cos(deg2rad(routepoint.lat));
 
         bool resetroute = false;
         bool present = false;
         RideFilePoint* point;
 
-        for (int i=lastpoint+1; i<ride->dataPoints().count();i++) {
-            point = ride->dataPoints().at(i);
+        for (int i=lastpoint+1; i<data.count();i++) {
+            point = data.at(i);
 
             double minimumdistance = -1;
 
@@ -164,7 +187,7 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
                 if (start == -1) {
                     diverge = 0;
                     // Calculate distance to route point
-                    double _dist = distance(routepoint.lat, routepoint.lon, point->lat, point->lon) ;
+                    double _dist = distance(sinlat, coslat, routepoint.lat, routepoint.lon, point->lat, point->lon) ;
                     minimumdistance = _dist;
 
                     if (precision == -1 || _dist<precision)
@@ -183,11 +206,11 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
 
                 if (start != -1) {
                     int end = i+10;
-                    for (int j=i; j<ride->dataPoints().count() && j<end;j++) {
-                        RideFilePoint* nextpoint = ride->dataPoints().at(j);
+                    for (int j=i; j<data.count() && j<end;j++) {
+                        RideFilePoint* nextpoint = data.at(j);
 
                         if (nextpoint->lat != 0 && nextpoint->lon !=0 && ceil(nextpoint->lat) != 180 && ceil(nextpoint->lon) != 180) {
-                            double _nextdist = distance(routepoint.lat, routepoint.lon, nextpoint->lat, nextpoint->lon) ;
+                            double _nextdist = distance(sinlat, coslat, routepoint.lat, routepoint.lon, nextpoint->lat, nextpoint->lon) ;
 
                             if (minimumdistance ==-1 || _nextdist<minimumdistance){
                                 //new minimumdistance
@@ -253,7 +276,7 @@ RouteSegment::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
         
         stop = point->secs;
         
-        if (n == this->getPoints().count()-1) {
+        if (n == points.count()-1) {
 
             // Add the interval and continue search
             qCDebug(gcRoutes) << "    >>> Route identified in ride: " << name << " start: " << start << " stop: " << stop << " (distance " << precision << "km)\r\n";
@@ -310,6 +333,29 @@ RouteSegment::distance(double lat1, double lon1, double lat2, double lon2) {
   return (_dist);
 }
 
+double
+RouteSegment::distance(double sinlat1, double coslat1, double lat1, double lon1, double lat2, double lon2) {
+  double _theta, _dist;
+  _theta = lon1 - lon2;
+  if (_theta == 0 && (lat1 - lat2) == 0)
+      _dist = 0;
+  else {
+      _dist = sinlat1 * sin(deg2rad(lat2)) + coslat1 * cos(deg2rad(lat2)) * cos(deg2rad(_theta));
+      _dist = acos(_dist) * 6371;
+  }
+  return (_dist);
+}
+
+bool
+RouteSegment::candidate(const QVector<quint32> &tiles) const
+{
+    if (anywhere) return true;
+
+    foreach(const RouteIndex::box &b, boxes)
+        if (!RouteIndex::overlaps(tiles, b)) return false;
+    return true;
+}
+
 
 
 /*
@@ -323,11 +369,16 @@ Routes::Routes(Context *context, const QDir &home)
     this->home = home;
     this->context = context;
     readRoutes();
+
+    // where each ride has been
+    tiles.read(context->athlete->home->cache().canonicalPath() + "/routetiles.bin");
+    connect(context, SIGNAL(rideDeleted(RideItem*)), this, SLOT(rideDeleted(RideItem*)));
 }
 
 Routes::~Routes()
 {
     writeRoutes();
+    tiles.write(context->athlete->home->cache().canonicalPath() + "/routetiles.bin");
 }
 
 quint16
@@ -341,6 +392,20 @@ Routes::getFingerprint() const
     return qChecksum(ba);
 }
 
+quint16
+Routes::getFingerprint(RideItem *item) const
+{
+    // not refreshed since we started indexing, could be anywhere
+    QVector<quint32> visited;
+    if (!tiles.find(item->fileName, visited)) return getFingerprint();
+
+    QByteArray ba;
+    foreach(const RouteSegment &segment, routes)
+        if (segment.candidate(visited)) ba += segment.id().toByteArray();
+
+    return qChecksum(ba);
+}
+
 void
 Routes::readRoutes()
 {
@@ -409,11 +474,42 @@ Routes::writeRoutes()
     RouteParser::serialize(file, routes);
 }
 
+void
+Routes::rideDeleted(RideItem *item)
+{
+    tiles.remove(item->fileName);
+}
+
+void
+Routes::index(RideItem *item, RideFile *ride)
+{
+    QVector<quint32> visited;
+
+    // the same samples RouteSegment::search will look at
+    if (ride) {
+        foreach(const RideFilePoint *point, ride->dataPoints()) {
+            quint32 tile;
+            if (point->lat != 0 && point->lon != 0 &&
+                ceil(point->lat) != 180 && ceil(point->lon) != 180 &&
+                RouteIndex::tileAt(point->lat, point->lon, tile) &&
+                (visited.isEmpty() || visited.last() != tile))
+                visited << tile;
+        }
+        std::sort(visited.begin(), visited.end());
+        visited.erase(std::unique(visited.begin(), visited.end()), visited.end());
+    }
+
+    tiles.update(item->fileName, visited);
+}
+
 void
 Routes::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
 {
     if (ride) {
 
+        QVector<quint32> visited;
+        bool indexed = tiles.find(item->fileName, visited);
+
         // search all segments
         for (int routecount=0;routecount<routes.count();routecount++) {
             RouteSegment *segment = &routes[routecount];
@@ -422,7 +518,8 @@ Routes::search(RideItem *item, RideFile*ride, QList<IntervalItem*>&here)
             if (ride->getMinPoint(RideFile::lat).toDouble()<segment->getMinLat()+0.001 &&
                 ride->getMaxPoint(RideFile::lat).toDouble()>segment->getMaxLat()-0.001 &&
                 ride->getMinPoint(RideFile::lon).toDouble()<segment->getMinLon()+0.001 &&
-                ride->getMaxPoint(RideFile::lon).toDouble()>segment->getMaxLon()-0.001   )
+                ride->getMaxPoint(RideFile::lon).toDouble()>segment->getMaxLon()-0.001 &&
+                (!indexed || segment->candidate(visited)))
 
             segment->search(item, ride, here);
         }
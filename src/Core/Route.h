@@ -27,6 +27,7 @@
 #include <QFile>
 
 #include "Context.h"
+#include "RouteIndex.h"
 
 class  RideFile;
 class  Routes;
@@ -43,7 +44,7 @@ class RouteSegment // represents a segment we match against
         QString getName();
         void setName(QString _name);
         QUuid id() const { return _id; }
-        QList<RoutePoint> getPoints();
+        const QList<RoutePoint> &getPoints() const;
         void setId(QUuid x) { _id = x; }
 
         double getMinLat();
@@ -62,8 +63,14 @@ class RouteSegment // represents a segment we match against
         // find segments in ridefiles
         void search(RideItem *, RideFile*, QList<IntervalItem*>&);
 
+        // could a ride that has been in these tiles contain the segment
+        bool candidate(const QVector<quint32> &tiles) const;
+
     private:
 
+        // as distance() when the sine and cosine of lat1 are known
+        double distance(double sinlat1, double coslat1, double lat1, double lon1, double lat2, double lon2);
+
         Routes *routes;
         QUuid _id; // unique id
 
@@ -72,6 +79,10 @@ class RouteSegment // represents a segment we match against
 
         double minLat, maxLat;
         double minLon, maxLon;
+
+        // tiles a ride must visit to match, see RouteIndex
+        QVector<RouteIndex::box> boxes;
+        bool anywhere;
 };
 
 struct RoutePoint // represents a point within a segment
@@ -97,6 +108,10 @@ class Routes : public QObject { // top-level object with API and map of segments
         // checksum changes as routes added
         quint16 getFingerprint() const;
 
+        // checksum of the routes that could be in the ride, so adding
+        // a route doesn't change it for rides that are elsewhere
+        quint16 getFingerprint(RideItem *item) const;
+
         // managing the list of route segments
         void readRoutes();
         int newRoute(QString name);
@@ -109,12 +124,19 @@ class Routes : public QObject { // top-level object with API and map of segments
         // find in a ride
         void search(RideItem*, RideFile* ride, QList<IntervalItem*>&here);
 
+        // remember where a ride has been, ride is NULL when it has no data
+        void index(RideItem *item, RideFile *ride);
+
+    public slots:
+        void rideDeleted(RideItem *item);
+
     protected:
         QList<RouteSegment> routes;
 
     private:
         QDir home;
         Context *context;
+        RouteIndex tiles;
 };
 
 #endif // ROUTE_H
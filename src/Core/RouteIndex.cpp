@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RouteIndex.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <cmath>
+
+static const quint32 RouteIndexMagic = 0x47525449; // GRTI
+
+bool
+RouteIndex::tileAt(double lat, double lon, quint32 &t)
+{
+    if (!(lat >= -90 && lat <= 90 && lon >= -180 && lon <= 180)) return false;
+
+    int row = std::min(int(floor((lat + 90) / tile)), 17999);
+    int col = std::min(int(floor((lon + 180) / tile)), columns-1);
+    t = quint32(row) * columns + quint32(col);
+    return true;
+}
+
+bool
+RouteIndex::near(double lat, double lon, double km, box &b)
+{
+    // a degree of latitude is 111.19km on the sphere used by
+    // RouteSegment::distance, leave some room for rounding
+    double dlat = 1.05 * km / 111.0;
+    double maxlat = fabs(lat) + dlat;
+    if (maxlat >= 89) return false;
+
+    // longitude is widest at the furthest from the equator
+    double dlon = dlat / cos(maxlat * M_PI / 180.0);
+    if (lon - dlon <= -180 || lon + dlon >= 180) return false;
+
+    quint32 low, high;
+    if (!tileAt(lat - dlat, lon - dlon, low) || !tileAt(lat + dlat, lon + dlon, high)) return false;
+
+    b.row0 = low / columns;
+    b.col0 = low % columns;
+    b.row1 = high / columns;
+    b.col1 = high % columns;
+    return true;
+}
+
+bool
+RouteIndex::overlaps(const QVector<quint32> &tiles, const box &b)
+{
+    for (int row=b.row0; row<=b.row1; row++) {
+        quint32 first = quint32(row) * columns + quint32(b.col0);
+        quint32 last = quint32(row) * columns + quint32(b.col1);
+        QVector<quint32>::const_iterator it = std::lower_bound(tiles.begin(), tiles.end(), first);
+        if (it != tiles.end() && *it <= last) return true;
+    }
+    return false;
+}
+
+void
+RouteIndex::update(const QString &fileName, const QVector<quint32> &tiles)
+{
+    QMutexLocker locker(&lock);
+
+    QHash<QString, QVector<quint32> >::iterator it = rides.find(fileName);
+    if (it != rides.end() && it.value() == tiles) return;
+
+    rides.insert(fileName, tiles);
+    changed = true;
+}
+
+bool
+RouteIndex::find(const QString &fileName, QVector<quint32> &tiles) const
+{
+    QMutexLocker locker(&lock);
+
+    QHash<QString, QVector<quint32> >::const_iterator it = rides.find(fileName);
+    if (it == rides.end()) return false;
+
+    tiles = it.value();
+    return true;
+}
+
+void
+RouteIndex::remove(const QString &fileName)
+{
+    QMutexLocker locker(&lock);
+    if (rides.remove(fileName)) changed = true;
+}
+
+bool
+RouteIndex::read(const QString &filename)
+{
+    QMutexLocker locker(&lock);
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != RouteIndexMagic || version != ROUTE_INDEX_VERSION) return false;
+
+    QHash<QString, QVector<quint32> > loaded;
+    in >> loaded;
+    if (in.status() != QDataStream::Ok) return false;
+
+    rides = loaded;
+    changed = false;
+    return true;
+}
+
+bool
+RouteIndex::write(const QString &filename)
+{
+    QMutexLocker locker(&lock);
+    if (!changed) return true;
+
+    // written to a temporary and renamed, so it is never half written
+    QSaveFile file(filename);
+    if (!file.open(QFile::WriteOnly)) return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << RouteIndexMagic << quint32(ROUTE_INDEX_VERSION) << rides;
+
+    if (!file.commit()) return false;
+    changed = false;
+    return true;
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RouteIndex_h
+#define _GC_RouteIndex_h 1
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+
+//
+// The GPS track for every ride summarised as the grid tiles it passes
+// through, so route segments are only searched for in rides that could
+// contain them.
+//
+// Tiles are 0.01 degrees square (about 1.1km north to south). A route is
+// only matched when a ride passes within 100m of its points, so for each
+// point we work out the block of tiles the ride must have visited; if the
+// ride hasn't been in all of them the route cannot be in it. Near the poles
+// and the date line we don't try and the route is always searched for.
+//
+// The tiles are saved in cache/routetiles.bin alongside the ride cache and
+// are updated whenever a ride is refreshed.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+//
+#define ROUTE_INDEX_VERSION 1
+
+class RouteIndex
+{
+    public:
+
+        // tiles inclusive, rows are latitude and columns longitude
+        struct box {
+            qint32 row0, row1, col0, col1;
+            bool operator==(const box &x) const { return row0==x.row0 && row1==x.row1 && col0==x.col0 && col1==x.col1; }
+        };
+
+        static const int columns = 36000;
+        static constexpr double tile = 0.01;
+
+        // tile for a position, false if it isn't a valid one
+        static bool tileAt(double lat, double lon, quint32 &tile);
+
+        // the tiles a position within km of lat, lon must be in, false
+        // when we can't tell (too close to a pole or the date line)
+        static bool near(double lat, double lon, double km, box &b);
+
+        // tiles is sorted, has it been anywhere in the box
+        static bool overlaps(const QVector<quint32> &tiles, const box &b);
+
+        // the tiles for each ride, as at the last refresh
+        void update(const QString &fileName, const QVector<quint32> &tiles);
+        bool find(const QString &fileName, QVector<quint32> &tiles) const;
+        void remove(const QString &fileName);
+
+        bool read(const QString &filename);
+        bool write(const QString &filename);
+
+    private:
+
+        mutable QMutex lock;
+        QHash<QString, QVector<quint32> > rides;
+        bool changed = false;
+};
+#endif // _GC_RouteIndex_h
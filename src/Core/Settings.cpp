@@ -23,6 +23,7 @@
 #include "Colors.h"
 #include <QSettings>
 #include <QDebug>
+#include <QMutex>
 
 #include <QFontDatabase>
 
@@ -171,6 +172,8 @@ GSettings::setValue(QString key, QVariant value)
         systemsettings->setValue(keyVar, value);
     }
 
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
 }
 
 void
@@ -196,6 +199,9 @@ GSettings::remove(const QString &key)
         keyVar.remove(QRegularExpression("^<.*>"));
         systemsettings->remove(keyVar);
     }
+
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
 }
 
 // access to athlete specific config
@@ -260,6 +266,9 @@ GSettings::setCValue(QString athleteName, QString key, QVariant value) {
         systemsettings->setValue(athleteName + "/" + keyVar,value);
 
     }
+
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
 }
 
 // other functions unsed from QSettings which GSettings needs to implement
@@ -378,6 +387,8 @@ GSettings::initializeQSettingsGlobal(QString athletesRootDir) {
     }
     syncQSettingsGlobal();
 
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
 }
 
 void
@@ -416,6 +427,9 @@ GSettings::initializeQSettingsAthlete(QString athletesRootDir, QString athleteNa
         }
         syncQSettingsAllAthletes();
     }
+
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
 }
 
 void
@@ -478,6 +492,78 @@ GSettings::clearGlobalAndAthletes() {
     syncQSettings();
     global->clear();
     athlete.clear();
+
+    // values read since are stale
+    GSettingsSnapshot::invalidate();
+}
+
+
+// -----------------------------settings snapshot for hot paths------------------------------//
+
+QAtomicInt GSettingsSnapshot::version;
+
+// the values this thread has read since the settings last changed
+struct GSettingsThreadSnapshot {
+    int version = -1;
+    QHash<QPair<const void*, QString>, QVariant> handles;
+    QHash<QPair<QString, QString>, QVariant> keys;
+};
+static thread_local GSettingsThreadSnapshot snapshot;
+
+// threads that miss read the settings one at a time
+static QMutex snapshotReadLock;
+
+static QVariant snapshotRead(const QString &key, const QString &athleteName)
+{
+    QMutexLocker locker(&snapshotReadLock);
+    if (athleteName.isEmpty()) return appsettings->value(NULL, key, QVariant());
+    else return appsettings->cvalue(athleteName, key, QVariant());
+}
+
+static void snapshotCurrent(int version)
+{
+    if (snapshot.version != version) {
+        snapshot.handles.clear();
+        snapshot.keys.clear();
+        snapshot.version = version;
+    }
+}
+
+const QVariant &
+GSettingsSnapshot::read(const void *handle, const char *key, const QString &athleteName)
+{
+    snapshotCurrent(version.loadAcquire());
+
+    QPair<const void*, QString> id(handle, athleteName);
+    QHash<QPair<const void*, QString>, QVariant>::const_iterator it = snapshot.handles.constFind(id);
+    if (it != snapshot.handles.constEnd()) return it.value();
+    return snapshot.handles.insert(id, snapshotRead(key, athleteName)).value();
+}
+
+const QVariant &
+GSettingsSnapshot::read(const QString &key, const QString &athleteName)
+{
+    snapshotCurrent(version.loadAcquire());
+
+    QPair<QString, QString> id(key, athleteName);
+    QHash<QPair<QString, QString>, QVariant>::const_iterator it = snapshot.keys.constFind(id);
+    if (it != snapshot.keys.constEnd()) return it.value();
+    return snapshot.keys.insert(id, snapshotRead(key, athleteName)).value();
+}
+
+QVariant
+GSettingsSnapshot::value(const QString &key, const QVariant &def)
+{
+    const QVariant &v = read(key, QString());
+    return v.isValid() ? v : def;
+}
+
+QVariant
+GSettingsSnapshot::cvalue(QString athleteName, const QString &key, const QVariant &def)
+{
+    if (athleteName.isEmpty()) return def;
+    const QVariant &v = read(key, athleteName);
+    return v.isValid() ? v : def;
 }
 
 
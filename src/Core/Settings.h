@@ -440,6 +440,9 @@
 // --------------------------------------------------------------------------------
 #include <QSettings>
 #include <QFileInfo>
+#include <QHash>
+#include <QPair>
+#include <QAtomicInt>
 
 // Helper Class for the Athlete QSettings
 
@@ -554,6 +557,61 @@ private:
 
 
 extern GSettings *appsettings;
+
+// A setting that is read on a hot path, e.g. for every ride when the ride
+// cache refreshes, its key and default are fixed at compile time and its
+// address identifies it in the snapshot below
+template<typename T>
+struct GSettingKey
+{
+    const char *key;
+    T def;
+};
+
+inline const GSettingKey<QString> GCK_WBALFORM = { GC_WBALFORM, "int" };
+inline const GSettingKey<int> GCK_WBALTAU = { GC_WBALTAU, 300 };
+inline const GSettingKey<int> GCK_DISCOVERY = { GC_DISCOVERY, 57 };   // 57 does not include search for PEAKS
+inline const GSettingKey<QString> GCK_WEIGHT = { GC_WEIGHT, "75.0" };
+
+// Settings as last read, for threads that read them a lot. Each thread
+// keeps the values it has read and reads them again only after a setting is
+// changed or configChanged is signalled, so apart from the first read there
+// is no key parsing, no QSettings and no lock; the version is an atomic int.
+class GSettingsSnapshot
+{
+public:
+    template<typename T> static T value(const GSettingKey<T> &key);
+    template<typename T> static T cvalue(QString athleteName, const GSettingKey<T> &key);
+
+    // for keys made at runtime, e.g. per sport or per data processor
+    static QVariant value(const QString &key, const QVariant &def = 0);
+    static QVariant cvalue(QString athleteName, const QString &key, const QVariant &def = 0);
+
+    // all threads read them again, when settings change
+    static void invalidate() { version.ref(); }
+
+private:
+    // an invalid QVariant when the setting isn't there
+    static const QVariant &read(const void *handle, const char *key, const QString &athleteName);
+    static const QVariant &read(const QString &key, const QString &athleteName);
+
+    static QAtomicInt version;
+};
+
+template<typename T> T
+GSettingsSnapshot::value(const GSettingKey<T> &key)
+{
+    const QVariant &v = read(&key, key.key, QString());
+    return v.isValid() ? v.value<T>() : key.def;
+}
+
+template<typename T> T
+GSettingsSnapshot::cvalue(QString athleteName, const GSettingKey<T> &key)
+{
+    if (athleteName.isEmpty()) return key.def;
+    const QVariant &v = read(&key, key.key, athleteName);
+    return v.isValid() ? v.value<T>() : key.def;
+}
 extern int OperatingSystem;
 
 #define WINDOWS 1
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TaskScheduler.h"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <algorithm>
+
+// which worker is this thread, -1 if it isn't one
+static thread_local int workerIndex = -1;
+
+TaskScheduler &
+TaskScheduler::instance()
+{
+    static TaskScheduler scheduler;
+    return scheduler;
+}
+
+TaskScheduler::TaskScheduler() : queued(0), next(0), stopping(false)
+{
+    int count = QThread::idealThreadCount();
+    if (count < 1) count = 1;
+
+    for(int i=0; i<count; i++) workers << new TaskWorker(this, i);
+    foreach(TaskWorker *worker, workers) worker->start();
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    sleepLock.lock();
+    stopping = true;
+    wake.wakeAll();
+    sleepLock.unlock();
+
+    foreach(TaskWorker *worker, workers) {
+        worker->wait();
+        delete worker;
+    }
+}
+
+int
+TaskScheduler::currentWorker()
+{
+    return workerIndex;
+}
+
+void
+TaskScheduler::submit(std::function<void()> run, TaskGroup *group)
+{
+    if (group) group->pending.ref();
+
+    // tasks submitted from a task stay local, others are spread about
+    int index = currentWorker();
+    if (index < 0) index = (next.fetchAndAddRelaxed(1) & 0x7fffffff) % workers.count();
+
+    TaskWorker *worker = workers[index];
+    queued.ref();
+    worker->lock.lock();
+    worker->queue.append(Task(run, group));
+    worker->lock.unlock();
+
+    // lock so we can't slip in between an idle worker
+    // checking the queue and going to sleep
+    QMutexLocker locker(&sleepLock);
+    wake.wakeOne();
+}
+
+bool
+TaskScheduler::take(int index, Task &task, TaskGroup *group)
+{
+    if (queued.loadAcquire() <= 0) return false;
+
+    // newest from our own queue, it is most likely to be hot in cache
+    // and is usually a sub-task of whatever we are waiting on
+    if (index >= 0) {
+        TaskWorker *worker = workers[index];
+        QMutexLocker locker(&worker->lock);
+        for (int i=worker->queue.count()-1; i>=0; i--) {
+            if (group && worker->queue[i].group != group) continue;
+            task = worker->queue.takeAt(i);
+            queued.deref();
+            return true;
+        }
+    }
+
+    // steal the oldest from the others
+    int start = index < 0 ? 0 : index + 1;
+    for (int i=0; i<workers.count(); i++) {
+        TaskWorker *victim = workers[(start + i) % workers.count()];
+        QMutexLocker locker(&victim->lock);
+        for (int j=0; j<victim->queue.count(); j++) {
+            if (group && victim->queue[j].group != group) continue;
+            task = victim->queue.takeAt(j);
+            queued.deref();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+TaskScheduler::runPending(TaskGroup *group)
+{
+    int index = currentWorker();
+    if (index < 0) return false; // only workers help out
+
+    Task task;
+    if (!take(index, task, group)) return false;
+    execute(task);
+    return true;
+}
+
+void
+TaskScheduler::execute(Task &task)
+{
+    task.run();
+    if (task.group) task.group->done();
+}
+
+void
+TaskWorker::run()
+{
+    workerIndex = index;
+
+    forever {
+        TaskScheduler::Task task;
+        if (scheduler->take(index, task)) {
+            scheduler->execute(task);
+            continue;
+        }
+
+        // nothing to do, sleep until something is submitted
+        QMutexLocker locker(&scheduler->sleepLock);
+        if (scheduler->stopping) return;
+        if (scheduler->queued.loadAcquire() <= 0) scheduler->wake.wait(&scheduler->sleepLock, 100);
+    }
+}
+
+void
+TaskGroup::run(std::function<void()> task)
+{
+    scheduler.submit(task, this);
+}
+
+void
+TaskGroup::done()
+{
+    // hold the lock so the waiter can't return (and destroy
+    // the group) until we have finished signalling it
+    QMutexLocker locker(&lock);
+    if (!pending.deref()) finished.wakeAll();
+}
+
+void
+TaskGroup::wait()
+{
+    while (pending.loadAcquire() > 0) {
+
+        // help out with our own tasks if we're a worker, anything else
+        // could run for much longer than we need to wait
+        if (scheduler.runPending(this)) continue;
+
+        // nothing queued (our tasks are running elsewhere) so wait for them
+        QMutexLocker locker(&lock);
+        if (pending.loadAcquire() > 0) finished.wait(&lock, 10);
+    }
+
+    // the last done() may still be signalling
+    QMutexLocker locker(&lock);
+}
+
+void
+TaskScheduler::addTiming(const QString &stage, qint64 nsecs)
+{
+    QMutexLocker locker(&timingLock);
+    Stage &add = stages[stage];
+    add.nsecs += nsecs;
+    add.count++;
+}
+
+void
+TaskScheduler::resetTimings()
+{
+    QMutexLocker locker(&timingLock);
+    stages.clear();
+}
+
+QString
+TaskScheduler::timings() const
+{
+    QMutexLocker locker(&timingLock);
+
+    QStringList names = stages.keys();
+    std::sort(names.begin(), names.end());
+
+    QString returning = QString("%1 workers").arg(workers.count());
+    foreach(QString name, names) {
+        const Stage &stage = stages[name];
+        returning += QString("\n%1: %2 calls, %3 ms total, %4 ms avg").arg(name)
+                                                                 .arg(stage.count)
+                                                                 .arg(stage.nsecs / 1000000)
+                                                                 .arg(stage.count ? double(stage.nsecs) / stage.count / 1000000.0 : 0, 0, 'f', 2);
+    }
+    return returning;
+}
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_TaskScheduler_h
+#define _GC_TaskScheduler_h 1
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <functional>
+
+//
+// A single work-stealing task scheduler shared by all the background
+// computation, so nested parallel work (rides in the RideCache refresh,
+// mean max series within a ride) runs on one pool of threads sized to the
+// machine instead of each level starting threads of its own.
+//
+// Each worker has its own queue; it runs the newest task from its own queue
+// first and when empty steals the oldest task from another worker. A worker
+// that waits on a TaskGroup runs that group's queued tasks while it waits,
+// so tasks may submit more tasks and wait for them without running out of
+// threads, and a wait is never held up by unrelated work.
+//
+// Time spent in each named stage is accumulated via TaskStageTimer so a
+// refresh can report where the time went; RideCache logs them to the
+// gc.ridecache category when each refresh ends.
+//
+class TaskGroup;
+class TaskWorker;
+
+class TaskScheduler
+{
+    public:
+
+        static TaskScheduler &instance();
+        ~TaskScheduler();
+
+        int workerCount() const { return workers.count(); }
+
+        // queue a task, on the calling worker's queue if called from a task
+        void submit(std::function<void()> task, TaskGroup *group=NULL);
+
+        // per stage timings
+        void addTiming(const QString &stage, qint64 nsecs);
+        void resetTimings();
+        QString timings() const;
+
+    protected:
+
+        friend class ::TaskWorker;
+        friend class ::TaskGroup;
+
+        struct Task {
+            Task() : group(NULL) {}
+            Task(std::function<void()> run, TaskGroup *group) : run(run), group(group) {}
+            std::function<void()> run;
+            TaskGroup *group;
+        };
+
+        // get a task, own queue first then steal, false if none queued;
+        // only tasks in the group when one is given
+        bool take(int worker, Task &task, TaskGroup *group=NULL);
+
+        // run one of the group's queued tasks on the calling worker, false if none
+        bool runPending(TaskGroup *group);
+
+        void execute(Task &task);
+
+        // worker index for the calling thread, -1 if not a worker
+        static int currentWorker();
+
+        QVector<TaskWorker*> workers;
+        QAtomicInt queued;      // tasks waiting in all the queues
+        QAtomicInt next;        // round robin for external submits
+        bool stopping;
+
+        QMutex sleepLock;       // idle workers wait here
+        QWaitCondition wake;
+
+        struct Stage {
+            Stage() : nsecs(0), count(0) {}
+            qint64 nsecs;
+            int count;
+        };
+        mutable QMutex timingLock;
+        QHash<QString, Stage> stages;
+
+    private:
+        TaskScheduler();
+};
+
+class TaskWorker : public QThread
+{
+    public:
+        TaskWorker(TaskScheduler *scheduler, int index) : scheduler(scheduler), index(index) {}
+
+    protected:
+        friend class ::TaskScheduler;
+
+        virtual void run() override;
+
+        TaskScheduler *scheduler;
+        int index;
+
+        QMutex lock;
+        QList<TaskScheduler::Task> queue;
+};
+
+// a set of tasks that can be waited on together
+class TaskGroup
+{
+    public:
+        TaskGroup(TaskScheduler &scheduler = TaskScheduler::instance()) : scheduler(scheduler) {}
+        ~TaskGroup() { wait(); }
+
+        void run(std::function<void()> task);
+
+        // wait for all the tasks in the group to complete; workers run
+        // the group's queued tasks while they wait, other threads block
+        void wait();
+
+    protected:
+        friend class ::TaskScheduler;
+        void done();
+
+    private:
+        TaskScheduler &scheduler;
+        QAtomicInt pending;
+        QMutex lock;
+        QWaitCondition finished;
+};
+
+// accumulate the time spent in a stage whilst in scope
+class TaskStageTimer
+{
+    public:
+        TaskStageTimer(const QString &stage) : stage(stage) { timer.start(); }
+        ~TaskStageTimer() { TaskScheduler::instance().addTiming(stage, timer.nsecsElapsed()); }
+
+    private:
+        QString stage;
+        QElapsedTimer timer;
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TextIndex.h"
+
+#include <algorithm>
+#include <iterator>
+
+TextIndex::TextIndex()
+{
+}
+
+quint64
+TextIndex::signature(const QStringList &texts)
+{
+    const quint64 prime = 1099511628211ULL;
+    quint64 sig = 14695981039346656037ULL;
+    foreach(const QString &text, texts) {
+        sig = (sig ^ qHash(text)) * prime;
+        sig = (sig ^ quint64(text.length())) * prime;
+    }
+    return sig;
+}
+
+QSet<quint64>
+TextIndex::trigrams(const QStringList &texts)
+{
+    QSet<quint64> returning;
+    foreach(const QString &text, texts) {
+        QString folded = text.toCaseFolded();
+        const QChar *p = folded.constData();
+        for (int i=0; i+3 <= folded.length(); i++) returning.insert(trigram(p+i));
+    }
+    return returning;
+}
+
+void
+TextIndex::clear()
+{
+    documents.clear();
+    unused.clear();
+    ids.clear();
+    postings.clear();
+}
+
+bool
+TextIndex::contains(const QString &key, quint64 signature) const
+{
+    int id = ids.value(key, -1);
+    return id >= 0 && documents[id].signature == signature;
+}
+
+void
+TextIndex::update(const QString &key, quint64 signature, const QStringList &texts)
+{
+    QSet<quint64> before, after = trigrams(texts);
+
+    int id = ids.value(key, -1);
+    if (id >= 0) {
+        before = trigrams(documents[id].texts);
+    } else if (unused.count()) {
+        id = unused.takeLast();
+        ids.insert(key, id);
+    } else {
+        id = documents.count();
+        documents.resize(id+1);
+        ids.insert(key, id);
+    }
+
+    document &d = documents[id];
+    d.key = key;
+    d.signature = signature;
+    d.texts = texts;
+
+    // only the trigrams that changed
+    foreach(quint64 gram, before) {
+        if (after.contains(gram)) continue;
+        QVector<int> &list = postings[gram];
+        QVector<int>::iterator it = std::lower_bound(list.begin(), list.end(), id);
+        if (it != list.end() && *it == id) list.erase(it);
+        if (list.isEmpty()) postings.remove(gram);
+    }
+    foreach(quint64 gram, after) {
+        if (before.contains(gram)) continue;
+        QVector<int> &list = postings[gram];
+        QVector<int>::iterator it = std::lower_bound(list.begin(), list.end(), id);
+        if (it == list.end() || *it != id) list.insert(it, id);
+    }
+}
+
+void
+TextIndex::remove(const QString &key)
+{
+    int id = ids.value(key, -1);
+    if (id < 0) return;
+
+    foreach(quint64 gram, trigrams(documents[id].texts)) {
+        QVector<int> &list = postings[gram];
+        QVector<int>::iterator it = std::lower_bound(list.begin(), list.end(), id);
+        if (it != list.end() && *it == id) list.erase(it);
+        if (list.isEmpty()) postings.remove(gram);
+    }
+
+    documents[id] = document();
+    ids.remove(key);
+    unused << id;
+}
+
+QSet<QString>
+TextIndex::search(const QStringList &tokens) const
+{
+    QVector<bool> found(documents.count(), false);
+
+    foreach(const QString &token, tokens) {
+
+        QString folded = token.toCaseFolded();
+        QVector<int> candidates;
+
+        if (folded.length() < 3) {
+
+            // too short to have a trigram, check everything
+            for (int id=0; id<documents.count(); id++)
+                if (documents[id].key != "") candidates << id;
+
+        } else {
+
+            // the shortest postings first, so the intersection stays small
+            QVector<const QVector<int>*> lists;
+            QSet<quint64> seen;
+            const QChar *p = folded.constData();
+            bool missing = false;
+            for (int i=0; i+3 <= folded.length() && !missing; i++) {
+                quint64 gram = trigram(p+i);
+                if (seen.contains(gram)) continue;
+                seen.insert(gram);
+
+                QHash<quint64, QVector<int> >::const_iterator it = postings.find(gram);
+                if (it == postings.end()) missing = true;
+                else lists << &it.value();
+            }
+            if (missing) continue;
+
+            std::sort(lists.begin(), lists.end(), [](const QVector<int> *a, const QVector<int> *b) {
+                return a->count() < b->count();
+            });
+
+            candidates = *lists[0];
+            for (int i=1; i<lists.count() && candidates.count(); i++) {
+                QVector<int> both;
+                std::set_intersection(candidates.begin(), candidates.end(),
+                                      lists[i]->begin(), lists[i]->end(), std::back_inserter(both));
+                candidates = both;
+            }
+        }
+
+        // the trigrams may be in different texts or in a different order
+        foreach(int id, candidates) {
+            if (found[id]) continue;
+            foreach(const QString &text, documents[id].texts) {
+                if (text.contains(token, Qt::CaseInsensitive)) {
+                    found[id] = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    QSet<QString> returning;
+    for (int id=0; id<found.count(); id++)
+        if (found[id]) returning.insert(documents[id].key);
+    return returning;
+}
+
+void
+TextIndex::write(QDataStream &out) const
+{
+    // ids are renumbered without the removed documents
+    QVector<int> renumber(documents.count(), -1);
+    int next = 0;
+    for (int id=0; id<documents.count(); id++)
+        if (documents[id].key != "") renumber[id] = next++;
+
+    out << qint32(next);
+    foreach(const document &d, documents) {
+        if (d.key == "") continue;
+        out << d.key << d.signature << d.texts;
+    }
+
+    out << qint32(postings.count());
+    QHash<quint64, QVector<int> >::const_iterator it = postings.constBegin();
+    for (; it != postings.constEnd(); ++it) {
+        out << it.key() << qint32(it.value().count());
+        foreach(int id, it.value()) out << qint32(renumber[id]);
+    }
+}
+
+bool
+TextIndex::read(QDataStream &in)
+{
+    clear();
+
+    qint32 count;
+    in >> count;
+    if (in.status() != QDataStream::Ok || count < 0) return false;
+
+    documents.resize(count);
+    for (int id=0; id<count; id++) {
+        document &d = documents[id];
+        in >> d.key >> d.signature >> d.texts;
+        if (in.status() != QDataStream::Ok || d.key == "") { clear(); return false; }
+        ids.insert(d.key, id);
+    }
+
+    qint32 grams;
+    in >> grams;
+    if (in.status() != QDataStream::Ok || grams < 0) { clear(); return false; }
+
+    postings.reserve(grams);
+    for (int i=0; i<grams; i++) {
+        quint64 gram;
+        qint32 n;
+        in >> gram >> n;
+        if (in.status() != QDataStream::Ok || n < 0 || n > count) { clear(); return false; }
+
+        QVector<int> &list = postings[gram];
+        list.resize(n);
+        for (int j=0; j<n; j++) {
+            qint32 id;
+            in >> id;
+            if (id < 0 || id >= count) { clear(); return false; }
+            list[j] = id;
+        }
+    }
+    if (in.status() != QDataStream::Ok) { clear(); return false; }
+
+    return true;
+}
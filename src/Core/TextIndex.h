@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_TextIndex_h
+#define _GC_TextIndex_h 1
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QDataStream>
+
+//
+// Inverted index for substring searches over a set of documents, each of
+// which is a list of texts (e.g. the metadata values and interval names
+// for a ride).
+//
+// Every text is case folded and split into trigrams, each trigram has a
+// sorted list of the documents that contain it. A token of three or more
+// characters can only be in a document that has all of its trigrams, so
+// the candidates are the intersection of their postings. The candidates are
+// then checked with QString::contains, so the results are exactly the same
+// as searching the texts of every document; shorter tokens just check
+// every document.
+//
+class TextIndex
+{
+    public:
+
+        TextIndex();
+
+        // add a document, or replace its texts
+        void update(const QString &key, quint64 signature, const QStringList &texts);
+        void remove(const QString &key);
+        void clear();
+
+        // is the document indexed with this signature
+        bool contains(const QString &key, quint64 signature) const;
+        QStringList keys() const { return ids.keys(); }
+        int count() const { return ids.count(); }
+
+        // documents with a text that contains any of the tokens, ignoring case
+        QSet<QString> search(const QStringList &tokens) const;
+
+        // save and restore, including the postings
+        void write(QDataStream &out) const;
+        bool read(QDataStream &in);
+
+        // a signature for the texts, to see if they changed
+        static quint64 signature(const QStringList &texts);
+
+    private:
+
+        struct document {
+            QString key;                // empty when removed
+            quint64 signature;
+            QStringList texts;
+        };
+
+        static QSet<quint64> trigrams(const QStringList &texts);
+        static quint64 trigram(const QChar *p) {
+            return (quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | quint64(p[2].unicode());
+        }
+
+        QVector<document> documents;    // by id
+        QVector<int> unused;            // ids of removed documents
+        QHash<QString, int> ids;
+        QHash<quint64, QVector<int> > postings; // document ids, ascending
+};
+#endif // _GC_TextIndex_h
@@ -217,7 +217,7 @@ DataProcessorFactory::autoProcess(RideFile *ride, QString mode, QString op)
         i.next();
 
         // if we're being run manually, run all that are defined
-        if (appsettings->value(NULL, i.value()->configKeyAutomation(i.key()), "Manual").toString() == mode)
+        if (GSettingsSnapshot::value(i.value()->configKeyAutomation(i.key()), "Manual").toString() == mode)
             i.value()->postProcess(ride, NULL, op);
     }
 
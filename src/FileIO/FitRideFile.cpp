@@ -32,6 +32,7 @@
 #include <QDebug>
 #include <QTime>
 #include <cstdio>
+#include <cstring>
 #include <stdint.h>
 #include <sstream>
 #include <time.h>
@@ -466,6 +467,12 @@ struct FitFileParser
     //
     QFile &file;
     QStringList &errors;
+
+    // the file is mapped (or read in one go if it can't be) and decoded
+    // from memory rather than reading a few bytes at a time from the QFile
+    const uchar *data;
+    qint64 length, pos;
+    QByteArray contents;
     RideFile *rideFile;
     time_t start_time;
     time_t last_time;
@@ -519,7 +526,8 @@ struct FitFileParser
     // errors will go into the errors list also passed by reference
     //
     FitFileParser(QFile &file, QStringList &errors) :
-        file(file), errors(errors), rideFile(NULL), start_time(0),
+        file(file), errors(errors), data(NULL), length(0), pos(0),
+        rideFile(NULL), start_time(0),
         last_time(0), last_distance(0.00f), interval(0), calibration(0),
         devices(0), stopped(true), isLapSwim(false), last_length(0.0),
         last_RR(0.0),
@@ -532,10 +540,25 @@ struct FitFileParser
     // has problems. sheesh. this is definitely a *FIXME*
     struct TruncatedRead {};
     void read_unknown( int size, int *count = NULL ) {
-        if (!file.seek(file.pos() + size))
+        take(size, count);
+    }
+
+    // the next size bytes
+    const uchar *take(int size, int *count = NULL) {
+        if (size < 0 || pos + size > length)
             throw TruncatedRead();
+        const uchar *p = data + pos;
+        pos += size;
         if (count)
             (*count) += size;
+        return p;
+    }
+
+    // QFile::canReadLine() looked for a newline in the data it had buffered
+    // ahead (16k), which is what we used to detect a second file following
+    bool canReadLine() const {
+        qint64 ahead = qMin(length - pos, qint64(16384));
+        return ahead > 0 && memchr(data + pos, '\n', ahead) != NULL;
     }
 
     //
@@ -579,150 +602,136 @@ struct FitFileParser
     // base types
 
     fit_string_value read_text(int len, int *count = NULL) {
-        char c;
+        return decode_text(take(len, count), len);
+    }
+
+    fit_value_t read_int8(int *count = NULL) {
+        return decode_int8(take(1, count));
+    }
+
+    fit_value_t read_uint8(int *count = NULL) {
+        return decode_uint8(take(1, count));
+    }
+
+    fit_value_t read_byte(int *count = NULL) {
+        return decode_byte(take(1, count));
+    }
+
+    fit_value_t read_uint8z(int *count = NULL) {
+        return decode_uint8z(take(1, count));
+    }
+
+    fit_value_t read_int16(bool is_big_endian, int *count = NULL) {
+        return decode_int16(take(2, count), is_big_endian);
+    }
+
+    fit_value_t read_uint16(bool is_big_endian, int *count = NULL) {
+        return decode_uint16(take(2, count), is_big_endian);
+    }
+
+    fit_value_t read_uint16z(bool is_big_endian, int *count = NULL) {
+        return decode_uint16z(take(2, count), is_big_endian);
+    }
+
+    fit_value_t read_int32(bool is_big_endian, int *count = NULL) {
+        return decode_int32(take(4, count), is_big_endian);
+    }
+
+    fit_value_t read_uint32(bool is_big_endian, int *count = NULL) {
+        return decode_uint32(take(4, count), is_big_endian);
+    }
+
+    fit_value_t read_uint32z(bool is_big_endian, int *count = NULL) {
+        return decode_uint32z(take(4, count), is_big_endian);
+    }
+
+    fit_float_value read_float32(bool is_big_endian, int *count = NULL) {
+        return decode_float32(take(4, count), is_big_endian);
+    }
+
+    // decode a base type from memory, the caller has checked there
+    // are enough bytes; NA values are mapped to NA_VALUE as above
+
+    static fit_string_value decode_text(const uchar *p, int len) {
         fit_string_value res = "";
         for (int i = 0; i < len; ++i) {
-            if (file.read(&c, 1) != 1)
-                throw TruncatedRead();
-            if (count)
-                *count += 1;
-
+            char c = p[i];
             if (c != 0)
                 res += c;
         }
         return res;
     }
 
-    fit_value_t read_int8(int *count = NULL) {
-        qint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
+    static fit_value_t decode_int8(const uchar *p) {
+        qint8 i = *p;
         return i == 0x7f ? NA_VALUE : i;
     }
 
-    fit_value_t read_uint8(int *count = NULL) {
-        quint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
+    static fit_value_t decode_uint8(const uchar *p) {
+        quint8 i = *p;
         return i == 0xff ? NA_VALUE : i;
     }
 
-    fit_value_t read_byte(int *count = NULL) {
-        quint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
-        return i;
+    static fit_value_t decode_byte(const uchar *p) {
+        return *p;
     }
 
-    fit_value_t read_uint8z(int *count = NULL) {
-        quint8 i;
-        if (file.read(reinterpret_cast<char*>( &i), 1) != 1)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 1;
-
+    static fit_value_t decode_uint8z(const uchar *p) {
+        quint8 i = *p;
         return i == 0x00 ? NA_VALUE : i;
     }
 
-    fit_value_t read_int16(bool is_big_endian, int *count = NULL) {
-        qint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<qint16>( i )
-            : qFromLittleEndian<qint16>( i );
+    static fit_value_t decode_int16(const uchar *p, bool is_big_endian) {
+        qint16 i = is_big_endian
+            ? qFromBigEndian<qint16>( p )
+            : qFromLittleEndian<qint16>( p );
 
         return i == 0x7fff ? NA_VALUE : i;
     }
 
-    fit_value_t read_uint16(bool is_big_endian, int *count = NULL) {
-        quint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint16>( i )
-            : qFromLittleEndian<quint16>( i );
+    static fit_value_t decode_uint16(const uchar *p, bool is_big_endian) {
+        quint16 i = is_big_endian
+            ? qFromBigEndian<quint16>( p )
+            : qFromLittleEndian<quint16>( p );
 
         return i == 0xffff ? NA_VALUE : i;
     }
 
-    fit_value_t read_uint16z(bool is_big_endian, int *count = NULL) {
-        quint16 i;
-        if (file.read(reinterpret_cast<char*>(&i), 2) != 2)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 2;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint16>( i )
-            : qFromLittleEndian<quint16>( i );
+    static fit_value_t decode_uint16z(const uchar *p, bool is_big_endian) {
+        quint16 i = is_big_endian
+            ? qFromBigEndian<quint16>( p )
+            : qFromLittleEndian<quint16>( p );
 
         return i == 0x0000 ? NA_VALUE : i;
     }
 
-    fit_value_t read_int32(bool is_big_endian, int *count = NULL) {
-        qint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
-
-        i = is_big_endian
-            ? qFromBigEndian<qint32>( i )
-            : qFromLittleEndian<qint32>( i );
+    static fit_value_t decode_int32(const uchar *p, bool is_big_endian) {
+        qint32 i = is_big_endian
+            ? qFromBigEndian<qint32>( p )
+            : qFromLittleEndian<qint32>( p );
 
         return i == 0x7fffffff ? NA_VALUE : i;
     }
 
-    fit_value_t read_uint32(bool is_big_endian, int *count = NULL) {
-        quint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint32>( i )
-            : qFromLittleEndian<quint32>( i );
+    static fit_value_t decode_uint32(const uchar *p, bool is_big_endian) {
+        quint32 i = is_big_endian
+            ? qFromBigEndian<quint32>( p )
+            : qFromLittleEndian<quint32>( p );
 
         return i == 0xffffffff ? NA_VALUE : i;
     }
 
-    fit_value_t read_uint32z(bool is_big_endian, int *count = NULL) {
-        quint32 i;
-        if (file.read(reinterpret_cast<char*>(&i), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
-
-        i = is_big_endian
-            ? qFromBigEndian<quint32>( i )
-            : qFromLittleEndian<quint32>( i );
+    static fit_value_t decode_uint32z(const uchar *p, bool is_big_endian) {
+        quint32 i = is_big_endian
+            ? qFromBigEndian<quint32>( p )
+            : qFromLittleEndian<quint32>( p );
 
         return i == 0x00000000 ? NA_VALUE : i;
     }
 
-    fit_float_value read_float32(bool is_big_endian, int *count = NULL) {
+    static fit_float_value decode_float32(const uchar *p, bool is_big_endian) {
         float f;
-        if (file.read(reinterpret_cast<char*>(&f), 4) != 4)
-            throw TruncatedRead();
-        if (count)
-            (*count) += 4;
+        memcpy(&f, p, 4);
 
         if (is_big_endian) {
             f = qbswap(f);
@@ -4055,10 +4064,12 @@ genericnext:
 
             // the chars ".FIT" for no other reason than it appears if you open
             // the file in a text editor (they haven't heard of magic numbers)
-            char fit_str[5];
-            if (file.read(fit_str, 4) != 4) {
+            char fit_str[5] = { 0 };
+            if (length - pos < 4) {
                 errors << "truncated header";
                 stop = true;
+            } else {
+                memcpy(fit_str, take(4), 4);
             }
             fit_str[4] = '\0';
             if (strcmp(fit_str, ".FIT") != 0) {
@@ -4215,6 +4226,14 @@ genericnext:
                 }
             }
 
+            // work out where each field is in the data messages that follow
+            // so they can be decoded straight from memory
+            def.size = 0;
+            for (FitField &field : def.fields) {
+                field.offset = def.size;
+                def.size += field.size;
+            }
+
         } else {
 
             //
@@ -4261,9 +4280,11 @@ genericnext:
                                                                    local_msg_num, def.global_msg_num, time_offset ); }
 
 
-            // now we just work through the definition and extract the field values
-            // from the file directly
+            // the whole message is in memory, the definition tells us where
+            // each field is so we just work through it extracting the values
+            const uchar *message = take(def.size, &count);
             std::vector<FitValue> values;
+            values.reserve(def.fields.size());
             for(const FitField &field : def.fields) {
 
                 // we store the value into a struct that has members
@@ -4271,85 +4292,88 @@ genericnext:
                 // integers are in 'v' and strings are in 's'
                 FitValue value;
                 int size;
+                const uchar *p = message + field.offset;
 
                 // see FITbasetypes at the top of the file for the basic types
-                // that are supported. Note that the read_XXXX routines will
+                // that are supported. Note that the decode_XXXX routines will
                 // check for FIT NA values and set to NA_VALUE where needed
                 //
                 // It is worth noting that size > the sizeof(type) indicates
-                // a list or array of values
+                // a list or array of values, and a field smaller than its
+                // type is never decoded, it would read past the field
                 switch (field.type) {
 
                     // Enumerated type (8 bit)
                     case 0: size = 1;
 
                             if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8(&count);;
+                                value.type = SingleValue; value.v = decode_uint8(p);
                              } else { // Multi-values
                                 value.type = ListValue;
                                 value.list.clear();
                                 for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint8(&count));
+                                    value.list.append(decode_uint8(p + i*size));
                                 }
                                 size = field.size;
                             }
                             break;
 
                     // Signed Int 8bit
-                    case 1: value.type = SingleValue; value.v = read_int8(&count); size = 1;  break;
+                    case 1: size = 1; value.type = SingleValue; value.v = field.size >= size ? decode_int8(p) : NA_VALUE; break;
 
 
                     // Unsigned Int 8bit
                     case 2: size = 1;
                             if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8(&count);
+                                value.type = SingleValue; value.v = decode_uint8(p);
                             } else { // Multi-values
                                 value.type = ListValue;
                                 value.list.clear();
                                 for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint8(&count));
+                                    value.list.append(decode_uint8(p + i*size));
                                 }
                                 size = field.size;
                             }
                             break;
 
                     // Signed Int 16
-                    case 3: value.type = SingleValue; value.v = read_int16(def.is_big_endian, &count); size = 2;  break;
+                    case 3: size = 2; value.type = SingleValue; value.v = field.size >= size ? decode_int16(p, def.is_big_endian) : NA_VALUE; break;
 
                     // Unsigned Int 16
                     case 4: size = 2;
                             if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint16(def.is_big_endian, &count);
+                                value.type = SingleValue; value.v = decode_uint16(p, def.is_big_endian);
                             } else { // Multi-values
                                 value.type = ListValue;
                                 value.list.clear();
                                 for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint16(def.is_big_endian, &count));
+                                    value.list.append(decode_uint16(p + i*size, def.is_big_endian));
                                 }
                                 size = field.size;
                             }
                             break;
 
                     // Signed Int 32
-                    case 5: value.type = SingleValue; value.v = read_int32(def.is_big_endian, &count); size = 4;  break;
+                    case 5: size = 4; value.type = SingleValue; value.v = field.size >= size ? decode_int32(p, def.is_big_endian) : NA_VALUE; break;
 
                     // Unsigned Int 32
                     case 6: size = 4;
                             if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint32(def.is_big_endian, &count);
+                                value.type = SingleValue; value.v = decode_uint32(p, def.is_big_endian);
                             } else if (field.size<size) {
                                 // Some device (eg Coros Pace 2) seems to declare uint32 with size 1
                                 value.type = SingleValue;
+                                value.v = NA_VALUE;
                                 if (field.size == 1)
-                                    value.v = read_uint8(&count);
+                                    value.v = decode_uint8(p);
                                 if (field.size == 2)
-                                    value.v = read_uint16(def.is_big_endian, &count);
+                                    value.v = decode_uint16(p, def.is_big_endian);
                                 size = field.size;
                             } else { // Multi-values
                                 value.type = ListValue;
                                 value.list.clear();
                                 for (int i=0;i<field.size/size;i++) {
-                                    value.list.append(read_uint32(def.is_big_endian, &count));
+                                    value.list.append(decode_uint32(p + i*size, def.is_big_endian));
                                 }
                                 size = field.size;
                             }
@@ -4358,7 +4382,7 @@ genericnext:
                     // String
                     case 7:
                         value.type = StringValue;
-                        value.s = read_text(field.size, &count);
+                        value.s = decode_text(p, field.size);
                         size = field.size;
                         break;
 
@@ -4367,14 +4391,14 @@ genericnext:
                         size = 4;
                         if (field.size==size) {
                             value.type = FloatValue;
-                            value.f = read_float32(def.is_big_endian, &count);
+                            value.f = decode_float32(p, def.is_big_endian);
                             if (value.f != value.f) // No NAN
                                 value.f = 0;
                         } else { // Multi-values
                             value.type = ListValue;
                             value.list.clear();
                             for (int i=0;i<field.size/size;i++) {
-                                value.list.append(read_float32(def.is_big_endian, &count));
+                                value.list.append(decode_float32(p + i*size, def.is_big_endian));
                             }
                             size = field.size;
                         }
@@ -4385,29 +4409,29 @@ genericnext:
 
                     case 10: size = 1;
                              if (field.size==size) {
-                                value.type = SingleValue; value.v = read_uint8z(&count); size = 1;
+                                value.type = SingleValue; value.v = decode_uint8z(p); size = 1;
                              } else { // Multi-values
                                  value.type = ListValue;
                                  value.list.clear();
                                  for (int i=0;i<field.size/size;i++) {
-                                     value.list.append(read_uint8z(&count));
+                                     value.list.append(decode_uint8z(p + i*size));
                                  }
                                  size = field.size;
                              }
                              break;
 
                     // Unsigned Int 16bit - A zero value signifies an invalid value (unimplemented)
-                    case 11: value.type = SingleValue; value.v = read_uint16z(def.is_big_endian, &count); size = 2; break;
+                    case 11: size = 2; value.type = SingleValue; value.v = field.size >= size ? decode_uint16z(p, def.is_big_endian) : NA_VALUE; break;
 
                     // Unsigned Int 32bit - A zero value signifies an invalid value (unimplemented)
-                    case 12: value.type = SingleValue; value.v = read_uint32z(def.is_big_endian, &count); size = 4; break;
+                    case 12: size = 4; value.type = SingleValue; value.v = field.size >= size ? decode_uint32z(p, def.is_big_endian) : NA_VALUE; break;
 
                     // 8 bit byte
                     case 13:
                              value.type = ListValue;
                              value.list.clear();
                              for (int i=0;i<field.size;i++) {
-                                value.list.append(read_byte(&count));
+                                value.list.append(decode_byte(p + i));
                              }
                              size = value.list.size();
                              break;
@@ -4417,12 +4441,11 @@ genericnext:
                     // case 15: Unsigned Int 64 bit
                     // case 16: Unsigned Int 64 bit Zero is an invalid value
 
-                    // if in doubt just read the number of bytes for the
+                    // if in doubt just skip the number of bytes for the
                     // data type and discard it
                     default:
                         if (FIT_DEBUG && FIT_DEBUG_LEVEL>3)  { fprintf(stderr, "unknown type: %d size: %d \n", field.type, field.size);  }
 
-                        if (field.size > 0) read_unknown( field.size, &count );
                         value.type = SingleValue;
                         value.v = NA_VALUE;
                         unknown_base_type.insert(field.type);
@@ -4430,15 +4453,19 @@ genericnext:
                         break;
                 }
 
-                // Size is greater than expected
+                // Size is greater than expected, the rest is skipped since
+                // the next field is at its own offset. Smaller than expected
+                // (e.g. a uint16 declared as 1 byte) has no value.
                 // Note we already check above for arrays
-                // So this is likely a redundant check
                 if (size < field.size) {
                     if (FIT_DEBUG && FIT_DEBUG_LEVEL>4)  { fprintf(stderr, "   warning : size=%d for type=%d (num=%d)\n",
                                                                            field.size, field.type, field.num); }
-
-                    // jump over unaccounted for data
-                    read_unknown( field.size-size, &count );
+                } else if (size > field.size && value.type == SingleValue) {
+                    value.v = NA_VALUE;
+                } else if (value.type == ListValue && value.list.isEmpty()) {
+                    // a list type smaller than one value has no value, not an empty list
+                    value.type = SingleValue;
+                    value.v = NA_VALUE;
                 }
 
                 // add to the container
@@ -4627,6 +4654,15 @@ genericnext:
             return NULL;
         }
 
+        // all of it, mapped if we can
+        length = file.size();
+        data = file.map(0, length);
+        if (data == NULL) {
+            contents = file.readAll();
+            data = reinterpret_cast<const uchar*>(contents.constData());
+            length = contents.size();
+        }
+
         int data_size = 0;
         weatherXdata = new XDataSeries();
         weatherXdata->name = "WEATHER";
@@ -4718,7 +4754,7 @@ genericnext:
 
                 // second file ?
                 try {
-                    while (file.canReadLine()) {
+                    while (canReadLine()) {
                         read_header(stop, errors, data_size);
                         if (!stop) {
 
@@ -66,6 +66,7 @@ struct FitField {
     int type; // FIT base_type
     int size; // in bytes
     int deve_idx; // Developer Data Index
+    int offset; // in the data message
 };
 
 struct FitFieldDefinition {
@@ -97,6 +98,7 @@ struct FitMessage {
     int local_msg_num;
     bool is_big_endian;
     std::vector<FitField> fields;
+    int size; // of the data message, in bytes
 };
 
 enum fitValueType { SingleValue, ListValue, FloatValue, StringValue };
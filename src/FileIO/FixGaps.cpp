@@ -164,6 +164,11 @@ FixGaps::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
     int dropouts = 0;
     double dropouttime = 0.0;
 
+    // the points to add and the row each will be at, we add them all at
+    // the end rather than as we go since every insert moves the points after
+    QVector<RideFilePoint> adds;
+    QVector<int> rows;
+
     // put it all in a LUW
     ride->command->startLUW("Fix Gaps in Recording");
 
@@ -222,43 +227,44 @@ FixGaps::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
 
                 // add the points
                 for(int i=0; i<count; i++) {
-                    RideFilePoint *add = new RideFilePoint(last->secs+((i+1)*ride->recIntSecs()),
-                                                           last->cad+((i+1)*caddelta),
-                                                           last->hr + ((i+1)*hrdelta),
-                                                           last->km + ((i+1)*kmdelta),
-                                                           last->kph + ((i+1)*kphdelta),
-                                                           last->nm + ((i+1)*nmdelta),
-                                                           last->watts + ((i+1)*pwrdelta),
-                                                           last->alt + ((i+1)*altdelta),
-                                                           last->lon + ((i+1)*londelta),
-                                                           last->lat + ((i+1)*latdelta),
-                                                           last->headwind + ((i+1)*hwdelta),
-                                                           last->slope + ((i+1)*slopedelta),
-                                                           last->temp + ((i+1)*temperaturedelta),
-                                                           last->lrbalance>=0 ? last->lrbalance + ((i+1)*lrbalancedelta) : last->lrbalance,
-                                                           last->lte + ((i+1)*ltedelta),
-                                                           last->rte + ((i+1)*rtedelta),
-                                                           last->lps + ((i+1)*lpsdelta),
-                                                           last->rps + ((i+1)*rpsdelta),
-                                                           last->lpco + ((i+1)*lpcodelta),
-                                                           last->rpco + ((i+1)*rpcodelta),
-                                                           last->lppb + ((i+1)*lppbdelta),
-                                                           last->rppb + ((i+1)*rppbdelta),
-                                                           last->lppe + ((i+1)*lppedelta),
-                                                           last->rppe + ((i+1)*rppedelta),
-                                                           last->lpppb + ((i+1)*lpppbdelta),
-                                                           last->rpppb + ((i+1)*rpppbdelta),
-                                                           last->lpppe + ((i+1)*lpppedelta),
-                                                           last->rpppe + ((i+1)*rpppedelta),
-                                                           last->smo2 + ((i+1)*smo2delta),
-                                                           last->thb + ((i+1)*thbdelta),
-                                                           last->rvert + ((i+1)*rvertdelta),
-                                                           last->rcad + ((i+1)*rcaddelta),
-                                                           last->rcontact + ((i+1)*rcontactdelta),
-                                                           last->tcore + ((i+1)*tcoredelta),
-                                                           last->interval);
-
-                    ride->command->insertPoint(position++, add);
+                    RideFilePoint add(last->secs+((i+1)*ride->recIntSecs()),
+                                      last->cad+((i+1)*caddelta),
+                                      last->hr + ((i+1)*hrdelta),
+                                      last->km + ((i+1)*kmdelta),
+                                      last->kph + ((i+1)*kphdelta),
+                                      last->nm + ((i+1)*nmdelta),
+                                      last->watts + ((i+1)*pwrdelta),
+                                      last->alt + ((i+1)*altdelta),
+                                      last->lon + ((i+1)*londelta),
+                                      last->lat + ((i+1)*latdelta),
+                                      last->headwind + ((i+1)*hwdelta),
+                                      last->slope + ((i+1)*slopedelta),
+                                      last->temp + ((i+1)*temperaturedelta),
+                                      last->lrbalance>=0 ? last->lrbalance + ((i+1)*lrbalancedelta) : last->lrbalance,
+                                      last->lte + ((i+1)*ltedelta),
+                                      last->rte + ((i+1)*rtedelta),
+                                      last->lps + ((i+1)*lpsdelta),
+                                      last->rps + ((i+1)*rpsdelta),
+                                      last->lpco + ((i+1)*lpcodelta),
+                                      last->rpco + ((i+1)*rpcodelta),
+                                      last->lppb + ((i+1)*lppbdelta),
+                                      last->rppb + ((i+1)*rppbdelta),
+                                      last->lppe + ((i+1)*lppedelta),
+                                      last->rppe + ((i+1)*rppedelta),
+                                      last->lpppb + ((i+1)*lpppbdelta),
+                                      last->rpppb + ((i+1)*rpppbdelta),
+                                      last->lpppe + ((i+1)*lpppedelta),
+                                      last->rpppe + ((i+1)*rpppedelta),
+                                      last->smo2 + ((i+1)*smo2delta),
+                                      last->thb + ((i+1)*thbdelta),
+                                      last->rvert + ((i+1)*rvertdelta),
+                                      last->rcad + ((i+1)*rcaddelta),
+                                      last->rcontact + ((i+1)*rcontactdelta),
+                                      last->tcore + ((i+1)*tcoredelta),
+                                      last->interval);
+
+                    rows << position + adds.count();
+                    adds << add;
                 }
 
             // stationary or greater than stop seconds... fill with zeroes
@@ -272,35 +278,39 @@ FixGaps::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op="
 
                 // add zero value points
                 for(int i=0; i<count; i++) {
-                    RideFilePoint *add = new RideFilePoint(last->secs+((i+1)*ride->recIntSecs()),
-                                                           0,
-                                                           0,
-                                                           last->km + ((i+1)*kmdelta),
-                                                           0,
-                                                           0,
-                                                           0,
-                                                           last->alt,
-                                                           0,
-                                                           0,
-                                                           0,
-                                                           0,
-                                                           0,
-                                                           0,
-                                                           0.0, 0.0, 0.0, 0.0, //pedal torque / smoothness
-                                                           0.0, 0.0, // pedal platform offset
-                                                           0.0, 0.0, 0.0, 0.0, //pedal power phase
-                                                           0.0, 0.0, 0.0, 0.0, //pedal peak power phase
-                                                           0.0, 0.0, // smO2 / thb
-                                                           0.0, 0.0, 0.0, // running dynamics
-                                                           0.0,
-                                                           last->interval);
-                    ride->command->insertPoint(position++, add);
+                    RideFilePoint add(last->secs+((i+1)*ride->recIntSecs()),
+                                      0,
+                                      0,
+                                      last->km + ((i+1)*kmdelta),
+                                      0,
+                                      0,
+                                      0,
+                                      last->alt,
+                                      0,
+                                      0,
+                                      0,
+                                      0,
+                                      0,
+                                      0,
+                                      0.0, 0.0, 0.0, 0.0, //pedal torque / smoothness
+                                      0.0, 0.0, // pedal platform offset
+                                      0.0, 0.0, 0.0, 0.0, //pedal power phase
+                                      0.0, 0.0, 0.0, 0.0, //pedal peak power phase
+                                      0.0, 0.0, // smO2 / thb
+                                      0.0, 0.0, 0.0, // running dynamics
+                                      0.0,
+                                      last->interval);
+                    rows << position + adds.count();
+                    adds << add;
                 }
             }
         }
         last = point;
     }
 
+    // splice them all in at once
+    ride->command->insertPoints(rows, adds);
+
     // end the Logical unit of work here
     ride->command->endLUW();
 
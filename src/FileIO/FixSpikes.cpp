@@ -180,6 +180,9 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
     int spikes = 0;
     double spiketime = 0.0;
 
+    // power with the spikes fixed
+    QVector<double> fixed;
+
     bool medAlgo;
     double variance, max;
     int medianWinSize; // this nummber must be odd to align the centre of the median window with the point being tested/corrected
@@ -217,6 +220,10 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
 
         LTMOutliers *outliers = new LTMOutliers(secs.data(), power.data(), power.count(), windowsize, false);
         ride->command->startLUW("Fix Spikes in Recording");
+
+        // fixed as we go, a spike next to one fixed sees the fixed value
+        fixed = power;
+
         for (int i=0; i<secs.count(); i++) {
 
             // An entry is a fixup candidate only if its variance is high AND it is above a concerning power level.
@@ -233,10 +240,10 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
             int pos = outliers->getIndexForRank(i);
             double left=0.0, right=0.0;
 
-            if (pos > 0) left = ride->dataPoints()[pos-1]->watts;
-            if (pos < (ride->dataPoints().count()-1)) right = ride->dataPoints()[pos+1]->watts;
+            if (pos > 0) left = fixed[pos-1];
+            if (pos < (fixed.count()-1)) right = fixed[pos+1];
 
-            ride->command->setPointValue(pos, RideFile::watts, (left+right)/2.0);
+            fixed[pos] = (left+right)/2.0;
         }
 
         delete outliers;
@@ -252,10 +259,14 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
         int halfMedianWin = medianWinSize / 2;
 
         ride->command->startLUW("Fix Spikes Median in Recording");
-        int numDataPnts = ride->dataPoints().count();
-        for (int dataPntPosn = 0; dataPntPosn < ride->dataPoints().count(); dataPntPosn++) {
 
-            double wattsAtPnt = ride->dataPoints()[dataPntPosn]->watts;
+        // fixed as we go, later windows see the points already fixed
+        foreach (RideFilePoint *point, ride->dataPoints()) fixed.append(point->watts);
+
+        int numDataPnts = fixed.count();
+        for (int dataPntPosn = 0; dataPntPosn < numDataPnts; dataPntPosn++) {
+
+            double wattsAtPnt = fixed[dataPntPosn];
 
             // load median window with values
             for (int medianWin = 0; medianWin < medianWinSize; medianWin++) {
@@ -268,17 +279,17 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
                     // At the beginning of the ride, the left-hand side of the median window doesn't align with any ride data, it's
                     // somewhat arbitrary how to pad this data, but choosing a single data point to replicate runs the risk of
                     // skewing the median filter so choose some reasonably close ride data to avoid this scenario.
-                    data[medianWin] = ride->dataPoints()[dataPntPosn + medianWin + halfMedianWin + 1]->watts;
+                    data[medianWin] = fixed[dataPntPosn + medianWin + halfMedianWin + 1];
                 }
                 else if (dp > numDataPnts - 1) {
                     // Again at the end of the ride, the right-hand side of the median window doesn't align with any ride data, it's
                     // best to avoid a single data point to replicate as this runs the risk of skewing the median filter
                     // so choose some reasonably close ride data to avoid this scenario.
-                    data[medianWin] = ride->dataPoints()[dataPntPosn - halfMedianWin - (medianWinSize - medianWin)]->watts;
+                    data[medianWin] = fixed[dataPntPosn - halfMedianWin - (medianWinSize - medianWin)];
                 }
                 else {
                     // The Median window lies completely within the ride data.
-                    data[medianWin] = ride->dataPoints()[dp]->watts;
+                    data[medianWin] = fixed[dp];
                 }
             }
 
@@ -295,12 +306,14 @@ FixSpikes::postProcess(RideFile *ride, DataProcessorConfig *config=0, QString op
             spiketime += ride->recIntSecs();
 
             // Fix data point
-            ride->command->setPointValue(dataPntPosn, RideFile::watts, medianVal);
+            fixed[dataPntPosn] = medianVal;
         }
 
         delete[] data;
     }
 
+    // all the fixes as one change to the power series
+    ride->command->setPointValues(0, RideFile::watts, fixed);
     ride->command->endLUW();
 
     ride->setTag("Spikes", QString("%1").arg(spikes));
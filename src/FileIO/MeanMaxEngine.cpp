@@ -0,0 +1,710 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MeanMaxEngine.h"
+
+#include <cmath> // for pow()
+#include <QMutexLocker>
+
+//----------------------------------------------------------------------
+// Mark Rages' Algorithm for Fast Find of Mean-Max
+//----------------------------------------------------------------------
+
+/*
+
+   A Faster Mean-Max Algorithm
+
+   Premises:
+
+   1 - maximum average power for a given interval occurs at maximum
+       energy for the interval, because the interval time is fixed;
+
+   2 - the energy in an interval enclosing a smaller interval will
+       always be equal or greater than an interval;
+
+   3 - finding maximum of means is a search algorithm, so biggest
+       gains are found in reducing the search space as quickly as
+       possible.
+
+   Algorithm
+
+   note: I find it easier to reason with concrete numbers, so I will
+   describe the algorithm in terms of power and 60 second max-mean:
+
+   To find the maximum average power for one minute:
+
+   1 - integrate the watts over the entire ride to get accumulated
+       energy in joules.  This is a monotonic function (assuming watts
+       are positive).  The final value is the energy for the whole
+       ride.  Once this is done, the energy for any section can be
+       found with a single subtraction.
+
+   2 - divide the energy into overlapping two-minute sections.
+       Section one = 0:00 -> 2:00, section two = 1:00 -> 3:00, etc.
+
+       Example:  Find 60s MM in 5-minute file
+
+       +----------+----------+----------+----------+----------+
+       | minute 1 | minute 2 | minute 3 | minute 4 | minute 5 |
+       +----------+----------+----------+----------+----------+
+       |             |_MEAN_MAX_|                             |
+       +---------------------+---------------------+----------+
+       |      segment 1      |      segment 3      |
+       +----------+----------+----------+----------+----------+
+                  |      segment 2      |      segment 4      |
+                  +---------------------+---------------------+
+
+       So no matter where the MEAN_MAX segment is located in time, it
+       will be wholly contained in one segment.
+
+       In practice, it is a little faster to make the windows smaller
+       and overlap more:
+       +----------+----------+----------+----------+----------+
+       | minute 1 | minute 2 | minute 3 | minute 4 | minute 5 |
+       +----------+----------+----------+----------+----------+
+       |             |_MEAN_MAX_|                             |
+       +-------------+----------------------------------------+
+          |  segment 1  |
+          +--+----------+--+
+          |  segment 2  |
+          +--+----------+--+
+             |  segment 3  |
+             +--+----------+--+
+                |  segment 4  |
+                +--+----------+--+
+                   |  segment 5  |
+                   +--+----------+--+
+                      |  segment 6  |
+                      +--+----------+--+
+                         |  segment 7  |
+                         +--+----------+--+
+                            |  segment 8  |
+                            +--+----------+--+
+                               |  segment 9  |
+                               +-------------+
+                                            ... etc.
+
+       ( This is because whenever the actual mean max energy is
+         greater than a segment energy, we can skip the detail
+         comparison within that segment altogether.  The exact
+         tradeoff for optimum performance depends on the distribution
+         of the data.  It's a pretty shallow curve.  Values in the 1
+         minute to 1.5 minute range seem to work pretty well. )
+
+   3 - for each two minute section, subtract the accumulated energy at
+       the end of the section from the accumulated energy at the
+       beginning of the section.  That gives the energy for that section.
+
+   4 - in the first section, go second-by-second to find the maximum
+       60-second energy.  This is our candidate for 60-second energy
+
+   5 - go down the sorted list of sections.  If the energy in the next
+       section is less than the 60-second energy in the best candidate so
+       far, skip to the next section without examining it carefully,
+       because the section cannot possibly have a one-minute section with
+       greater energy.
+
+       while (section->energy > candidate) {
+         candidate=max(candidate, search(section, 60));
+         section++;
+       }
+
+   6. candidate is the mean max for 60 seconds.
+
+   Enhancements that are not implemented:
+
+     - The two-minute overlapping sections can be reused for 59
+       seconds, etc.  The algorithm will degrade to exhaustive search
+       if the looked-for interval is much smaller than the enclosing
+       interval.
+
+     - The sections can be sorted by energy in reverse order before
+       step #4.  Then the search in #5 can be terminated early, the
+       first time it fails.  In practice, the comparisons in the
+       search outnumber the saved comparisons.  But this might be a
+       useful optimization if the windows are reused per the previous
+       idea.
+
+*/
+
+static double
+partial_max_mean(const double *dataseries_i, int start, int end, int length, int *offset)
+{
+    int i=0;
+    double candidate=0;
+
+    int best_i=0;
+
+    for (i=start; i<(1+end-length); i++) {
+        double test_energy=dataseries_i[length+i]-dataseries_i[i];
+        if (test_energy>candidate) {
+            candidate=test_energy;
+            best_i=i;
+        }
+    }
+    if (offset) *offset=best_i;
+
+    return candidate;
+}
+
+
+double
+MeanMaxEngine::dividedMaxMean(const double *dataseries_i, int datalength, int length, int *offset)
+{
+    int shift=length;
+
+    //if sorting data the following is an important speedup hack
+    if (shift>180) shift=180;
+
+    int window_length=length+shift;
+
+    if (window_length>datalength) window_length=datalength;
+
+    // put down as many windows as will fit without overrunning data
+    int start=0;
+    int end=0;
+    double energy=0;
+
+    double candidate=0;
+    int this_offset=0;
+
+    for (start=0; start+window_length<=datalength; start+=shift) {
+        end=start+window_length;
+        energy=dataseries_i[end]-dataseries_i[start];
+
+        if (energy < candidate) {
+          continue;
+        }
+        double window_mm=partial_max_mean(dataseries_i, start, end, length, &this_offset);
+
+        if (window_mm>candidate) {
+            candidate=window_mm;
+            if (offset) *offset=this_offset;
+        }
+    }
+
+    // if the overlapping windows don't extend to the end of the data,
+    // let's tack another one on at the end
+
+    if (end<datalength) {
+        start=datalength-window_length;
+        end=datalength;
+        energy=dataseries_i[end]-dataseries_i[start];
+
+        if (energy >= candidate) {
+
+            double window_mm=partial_max_mean(dataseries_i, start, end, length, &this_offset);
+
+            if (window_mm>candidate) {
+                candidate=window_mm;
+                if (offset) *offset=this_offset;
+            }
+        }
+    }
+
+    return candidate;
+}
+
+//----------------------------------------------------------------------
+// Incremental search
+//----------------------------------------------------------------------
+
+MeanMaxEngine::MeanMaxEngine(transform type, double recIntSecs, double decimals, double weight)
+    : type(type), recIntSecs(recIntSecs), decimals(decimals), weight(weight),
+      valid(false), count(0), exact(false), positive(false), total_secs(0), searched_(0), appending(false)
+{
+}
+
+void
+MeanMaxEngine::setup(transform type, double recIntSecs, double decimals, double weight)
+{
+    QMutexLocker locker(&lock);
+
+    if (type == this->type && recIntSecs == this->recIntSecs &&
+        decimals == this->decimals && weight == this->weight) return;
+
+    this->type = type;
+    this->recIntSecs = recIntSecs;
+    this->decimals = decimals;
+    this->weight = weight;
+    valid = false;
+
+    // the samples appended so far were prepared the old way
+    if (appending) forget();
+}
+
+void
+MeanMaxEngine::clear()
+{
+    QMutexLocker locker(&lock);
+    forget();
+}
+
+void
+MeanMaxEngine::forget()
+{
+    valid = false;
+    count = 0;
+    hashes.clear();
+    best.clear();
+    offset.clear();
+    appending = false;
+    integrated.clear();
+}
+
+int
+MeanMaxEngine::nextDuration(int i)
+{
+    // increments to limit search scope
+    if (i<120) i++;
+    else if (i<600) i+= 2;
+    else if (i<1200) i += 5;
+    else if (i<3600) i += 20;
+    else if (i<7200) i += 120;
+    else i += 300;
+    return i;
+}
+
+bool
+MeanMaxEngine::update(const double *secs, const double *values, double defaultValue, int count)
+{
+    QMutexLocker locker(&lock);
+
+    QVector<double> prepared;
+    int total_secs = 0;
+
+    // append doesn't keep the hashes, so we can't tell what changed
+    if (appending) forget();
+
+    if (!prepare(secs, values, defaultValue, count, prepared, total_secs)) {
+
+        // nothing to remember
+        forget();
+        return false;
+    }
+
+    search(prepared);
+    this->total_secs = total_secs;
+    return true;
+}
+
+MeanMaxEngine::Preparer::Preparer(transform type, double recIntSecs, double decimals, double weight)
+    : type(type), recIntSecs(recIntSecs), decimals(decimals), weight(weight),
+      started(false), offset(0), lastsecs(0), lastpoint(0), lastAlt(0), index(0), sum(0), ewma(0)
+{
+    // IsoPower - rolling 30s avg ^ 4, xPower - 25s EWA ^ 4 (as BikeScore.cpp)
+    // no point doing a rolling average if the sample rate is greater
+    // than the rolling average window!!
+    int rollingwindowsize = (type == XPower) ? 25 / recIntSecs : 30 / recIntSecs;
+    smooth = rollingwindowsize > 1;
+    if (type == IsoPower && smooth) rolling.resize(rollingwindowsize);
+
+    exp = recIntSecs / ((25.0f / recIntSecs) + recIntSecs);
+    rem = 1.0f - exp;
+}
+
+void
+MeanMaxEngine::Preparer::add(double secs, double value, QVector<double> &prepared)
+{
+    // decritize the data series - seems wrong, since it just
+    // rounds to the nearest second - what if the recIntSecs
+    // is less than a second? Has been used for a long while
+    // so going to leave in tact for now - apart from the
+    // addition of code to fill in gaps in recording since
+    // they affect the IsoPower/xPower algorithm badly and will skew
+    // the calculations of >6m since windowsize is used to
+    // determine segment duration rather than examining the
+    // timestamps on each sample
+    // the decrit will also pull timestamps back to start at
+    // zero, since some files have a very large start time
+    // that creates work for nil effect (but increases compute
+    // time drastically).
+    if (!started) {
+        started = true;
+        offset = secs;
+    }
+
+    // drag back to start at 1s or whatever recIntSecs is !
+    // (offset applied on all samples is from the first sample)
+    double psecs = secs - offset + recIntSecs;
+
+    // fill in any gaps in recording - use same dodgy rounding as before
+    int gap = (psecs - lastsecs - recIntSecs) / recIntSecs;
+
+    // gap more than an hour, damn that ride file is a mess
+    if (gap > 3600) gap = 1;
+
+    for(int i=0; i<gap; i++) {
+        prepared.append(apply(0));
+        lastpoint = round(lastsecs+((i+1)*recIntSecs *1000.0)/1000);
+    }
+    lastsecs = psecs;
+
+    double s = round(psecs * 1000.0) / 1000;
+    if (std::isnan(value)) value = 0; // has no int to round to, count it as a dropout
+    if (s > 0) {
+        prepared.append(apply((int) round(value*double(decimals))));
+        lastpoint = s;
+    }
+}
+
+// Pre-process the data for IsoPower, xPower and VAM
+double
+MeanMaxEngine::Preparer::apply(double value)
+{
+    // VAM - adjust to Vertical Ascent per Hour
+    if (type == Vam) {
+
+        // handle drops gracefully (and first sample too)
+        // if you manage to rise >5m in a second thats a data error too!
+        if (!lastAlt || (value - lastAlt) > 5) lastAlt=value;
+
+        // NOTE: It is 360 not 3600 because Altitude is factored for decimal places
+        //       since it is the base data series, but we are calculating VAM
+        //       And we multiply by 10 at the end!
+        double vam = (((value - lastAlt) * 360)/recIntSecs) * 10;
+        if (vam < 0) vam = 0;
+        lastAlt = value;
+        return vam;
+    }
+
+    // IsoPower - convert to a rolling average for the given windowsize
+    if (type == IsoPower && smooth) {
+
+        sum += value;
+        sum -= rolling[index];
+
+        rolling[index] = value;
+
+        // move index on/round
+        index = (index >= rolling.count()-1) ? 0 : index+1;
+
+        return pow(sum/(double)rolling.count(),4.0f); // raise rolling average to 4th power
+    }
+
+    // xPower - convert to a EWMA
+    if (type == XPower && smooth) {
+
+        // dgr : BikeScore has weighting value from first point
+        ewma = (value * exp) + (ewma * rem);
+        return pow(ewma, 4.0f);
+    }
+
+    if (type == PerKg) return value / weight;
+
+    return value;
+}
+
+bool
+MeanMaxEngine::prepare(const double *secs, const double *values, double defaultValue, int count,
+                       QVector<double> &prepared, int &total_secs) const
+{
+    Preparer preparer(type, recIntSecs, decimals, weight);
+
+    prepared.reserve(count);
+    for (int j=0; j<count; j++) preparer.add(secs[j], values ? values[j] : defaultValue, prepared);
+
+    // don't bother with insufficient data
+    if (!prepared.count()) return false;
+
+    total_secs = (int) ceil(preparer.lastPoint());
+
+    // don't allow data more than two days
+    // was one week, but no single ride is longer
+    // than 2 days, even if you are doing RAAM
+    if (total_secs > 2*24*60*60) return false;
+
+    // don't allow if badly parsed or time goes backwards
+    if (total_secs < 0) return false;
+
+    return true;
+}
+
+// FNV-1a over the bits of the samples
+quint64
+MeanMaxEngine::hash(const double *samples, int count)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char*>(samples);
+    const size_t length = size_t(count) * sizeof(double);
+    quint64 h = 14695981039346656037ULL;
+    for (size_t i=0; i<length; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+// best energy over windows of length starting from..to, updating
+// the candidate only when better, as partial_max_mean does
+static void
+scan(const double *integrated, int length, int from, int to, double &candidate, int &offset)
+{
+    for (int j=from; j<=to; j++) {
+        double energy = integrated[length+j] - integrated[j];
+        if (energy > candidate) {
+            candidate = energy;
+            offset = j;
+        }
+    }
+}
+
+void
+MeanMaxEngine::search(const QVector<double> &prepared)
+{
+    const int n = valid ? count : 0;
+    const int m = prepared.count();
+    const double *samples = prepared.constData();
+
+    // integrate the series, as we always have
+    QVector<double> integrated(m+1);
+    double acc = 0;
+    bool isexact = true, ispositive = true;
+    for (int i=0; i<m; i++) {
+        integrated[i] = acc;
+        acc += prepared[i];
+
+        double v = prepared[i];
+        if (!(v >= 0)) ispositive = false; // NaN too
+        if (v != floor(v)) isexact = false;
+    }
+    integrated[m] = acc;
+
+    // whole numbers are only summed exactly up to 2^53
+    if (!(acc < 9007199254740992.0)) isexact = false;
+
+    // where have the samples changed since last time? to within a block,
+    // first may be earlier and last later, so we search more, not less
+    const int blocks = n ? hashes.count() : 0;
+    int b = 0;
+    for (; b<blocks; b++) {
+        int from = b * Block, to = qMin(from + Block, n);
+        if (to > m || hash(samples + from, to - from) != hashes[b]) break;
+    }
+    int first = qMin(b * Block, n);
+    int last = first - 1;
+    if (n == m) {
+        b = blocks - 1;
+        while (b >= 0 && b * Block >= first && hash(samples + b * Block, qMin(Block, n - b * Block)) == hashes[b]) b--;
+        if (b >= 0) last = qMax(last, qMin((b+1) * Block, n) - 1);
+    }
+
+    const bool incremental = valid && positive && ispositive;
+    const bool appended = incremental && first == n && m >= n; // or unchanged
+    const bool edited = incremental && !appended && n == m;
+    const bool local = edited && exact && isexact;
+
+    QVector<double> nbest;
+    QVector<int> noffset;
+    const double *data = integrated.constData();
+    searched_ = 0;
+
+    int k=0;
+    for (int i=1; i<m; i=nextDuration(i), k++) {
+
+        double candidate = 0;
+        int where = -1;
+
+        // what we found last time
+        bool known = k < best.count();
+        if (known) {
+            candidate = best[k];
+            where = offset[k];
+        }
+
+        // windows to search, if not all of them
+        int from = 0, to = -1;
+        bool partial = false;
+
+        if (known && appended) {
+
+            // just the windows that end in the new samples
+            from = qMax(0, n-i+1);
+            to = m-i;
+            partial = true;
+
+        } else if (known && local && (where < 0 || where > last || where+i <= first)) {
+
+            // just the windows that overlap the edit, the rest are unchanged
+            from = qMax(0, first-i+1);
+            to = qMin(last, m-i);
+            partial = true;
+
+        } else if (known && edited && !local && (where < 0 || where+i <= first)) {
+
+            // just the windows that end after the first change
+            from = qMax(0, first-i+1);
+            to = m-i;
+            partial = true;
+        }
+
+        // a long way to scan, the divided search is quicker
+        if (partial && to - from > m / 4) partial = false;
+
+        if (partial) {
+
+            scan(data, i, from, to, candidate, where);
+
+        } else {
+
+            // search all
+            where = -1;
+            candidate = dividedMaxMean(data, m, i, &where);
+            searched_++;
+        }
+
+        nbest << candidate;
+        noffset << where;
+    }
+
+    valid = true;
+    count = m;
+    hashes.resize((m + Block - 1) / Block);
+    for (b=0; b<hashes.count(); b++) hashes[b] = hash(samples + b * Block, qMin(Block, m - b * Block));
+    exact = isexact;
+    positive = ispositive;
+    best = nbest;
+    offset = noffset;
+}
+
+bool
+MeanMaxEngine::append(const double *secs, const double *values, double defaultValue, int count)
+{
+    QMutexLocker locker(&lock);
+
+    // a new series
+    if (!appending) {
+        forget();
+        appending = true;
+        preparer = Preparer(type, recIntSecs, decimals, weight);
+        integrated << 0;
+        positive = true;
+    }
+
+    QVector<double> prepared;
+    for (int j=0; j<count; j++) preparer.add(secs[j], values ? values[j] : defaultValue, prepared);
+
+    // carry the running totals on, as search() integrates them
+    double acc = integrated.last();
+    for (int i=0; i<prepared.count(); i++) {
+        double v = prepared[i];
+        if (!(v >= 0)) positive = false; // NaN too
+        acc += v;
+        integrated << acc;
+    }
+
+    // as prepare(), nothing worth computing
+    const int n = this->count, m = integrated.count() - 1;
+    total_secs = (int) ceil(preparer.lastPoint());
+    if (!m || total_secs > 2*24*60*60 || total_secs < 0) {
+        valid = false;
+        best.clear();
+        offset.clear();
+        return false;
+    }
+
+    const double *data = integrated.constData();
+    const int known = best.count();
+    searched_ = 0;
+
+    int k=0;
+    for (int i=1; i<m; i=nextDuration(i), k++) {
+
+        if (k == best.count()) {
+            best << 0;
+            offset << -1;
+        }
+
+        if (positive) {
+
+            // the windows that end in the new samples, all of them
+            // for a duration that is only now long enough
+            scan(data, i, k < known ? qMax(0, n-i+1) : 0, m-i, best[k], offset[k]);
+
+        } else {
+
+            // not exhaustive with negative values, search all as search() does
+            offset[k] = -1;
+            best[k] = dividedMaxMean(data, m, i, &offset[k]);
+            searched_++;
+        }
+    }
+
+    valid = true;
+    this->count = m;
+    exact = false;
+    return true;
+}
+
+QVector<float>
+MeanMaxEngine::bests() const
+{
+    QMutexLocker locker(&lock);
+
+    if (!valid) return QVector<float>();
+
+    // the bests go in here...
+    QVector <double> ride_bests(total_secs + 1);
+
+    int k=0;
+    for (int i=1; i<count; i=nextDuration(i), k++) {
+
+        // snaffle it away
+        int sec = i*recIntSecs;
+        double val = best[k] / (double)i;
+
+        if (sec < ride_bests.size()) {
+            if (type == IsoPower || type == XPower)
+                ride_bests[sec] = pow(val, 0.25f);
+            else
+                ride_bests[sec] = val;
+        }
+    }
+
+    //
+    // FILL IN THE GAPS AND FILL TARGET ARRAY
+    //
+    // We want to present a full set of bests for
+    // every duration so the data interface for this
+    // cache can remain the same, but the level of
+    // accuracy/granularity can change in here in the
+    // future if some fancy new algorithm arrives
+    //
+
+    // XXX seems we can end up with 0 at the end ?
+    // XXX don't know why, so, for now, just clean that
+    while (ride_bests.size() && ride_bests[ride_bests.size()-1] == 0)
+        ride_bests.resize(ride_bests.size()-1);
+
+    double last = 0;
+
+    // only care about first 3 minutes MAX for delta series
+    if (type == Delta && ride_bests.count() > 180) ride_bests.resize(180);
+
+    QVector<float> returning(ride_bests.count());
+
+    // bounds check, it might be empty!
+    if (ride_bests.size()) {
+        for (int i=ride_bests.size()-1; i; i--) {
+            if (ride_bests[i] == 0) ride_bests[i]=last;
+            else last = ride_bests[i];
+
+            returning[i] = ride_bests[i];
+        }
+    }
+    return returning;
+}
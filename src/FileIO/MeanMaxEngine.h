@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_MeanMaxEngine_h
+#define _GC_MeanMaxEngine_h 1
+
+#include <QVector>
+#include <QMutex>
+
+//
+// Mean-max search for a single data series that remembers what it found,
+// so it can be run again after the data has changed and only search the
+// windows that are affected by the change.
+//
+// The samples are prepared exactly as MeanMaxComputer always has (gaps in
+// recording filled with zeroes, scaled for decimal places and then any
+// rolling average etc applied) and compared with those from the last
+// update. Only a hash of each block of them is kept, not the samples, so a
+// change is placed to within a block. A NaN sample is counted as zero, like
+// a gap in recording. Then for each duration;
+//
+//  - samples added at the end; only the new windows at the end are searched
+//  - samples edited; when every value is a whole number the running totals
+//    are exact, so only windows overlapping the edit are searched, otherwise
+//    all windows that end after the first change are searched
+//  - the best window overlapped the change, there are lots of windows to
+//    scan, or anything else; the whole series is searched with Mark Rages'
+//    algorithm, as before
+//
+// Unchanged windows have the same running totals, so the energies compared
+// are the same doubles and the results are identical to a full search. When
+// there are negative values the divided search is not exhaustive, so we
+// always do a full search, to get the same answer as before.
+//
+// Samples recorded live can be added with append() instead; they are
+// prepared one at a time, carrying the gap filling and rolling averages on
+// from the last, and the running totals are kept, so each new sample only
+// costs the one window for each duration that ends with it.
+//
+class MeanMaxEngine
+{
+    public:
+
+        // how the samples are prepared before searching
+        enum transform { Plain, Delta, Vam, IsoPower, XPower, PerKg };
+
+        MeanMaxEngine(transform type=Plain, double recIntSecs=1, double decimals=1, double weight=0);
+
+        // the next update will search everything if these change
+        void setup(transform type, double recIntSecs, double decimals, double weight);
+
+        // compute from samples; secs and values are count long and values may
+        // be NULL (all defaultValue). Returns false when there is nothing worth
+        // computing (as MeanMaxComputer) and the bests are then empty
+        bool update(const double *secs, const double *values, double defaultValue, int count);
+
+        // add samples recorded after those appended before, the results are
+        // the same as an update() with all of them. The first append after
+        // construction, clear() or an update() starts a new series and an
+        // update() after appending searches everything
+        bool append(const double *secs, const double *values, double defaultValue, int count);
+
+        // best for each duration in seconds, index 0 is unused
+        QVector<float> bests() const;
+
+        // forget everything
+        void clear();
+
+        // full searches made by the last update, for diagnostics
+        int searched() const { return searched_; }
+
+        // the durations (in samples) we search for, 1, 2, 3 ... 120, 122 etc
+        static int nextDuration(int length);
+
+        // Mark Rages' search for the best energy over length samples of the
+        // integrated data series, which is datalength+1 long
+        static double dividedMaxMean(const double *integrated, int datalength, int length, int *offset);
+
+    private:
+
+        // prepares samples one at a time, so appending gives the same
+        // values as preparing the whole series
+        class Preparer
+        {
+            public:
+                Preparer(transform type=Plain, double recIntSecs=1, double decimals=1, double weight=0);
+
+                // the sample, after any zeros to fill a gap before it
+                void add(double secs, double value, QVector<double> &prepared);
+                double lastPoint() const { return lastpoint; }
+
+            private:
+                double apply(double value);
+
+                transform type;
+                double recIntSecs, decimals, weight;
+
+                bool started;
+                double offset, lastsecs, lastpoint;
+                double lastAlt;             // Vam
+                QVector<double> rolling;    // IsoPower
+                int index;
+                double sum;
+                double exp, rem, ewma;      // XPower
+                bool smooth;
+        };
+
+        bool prepare(const double *secs, const double *values, double defaultValue, int count,
+                     QVector<double> &prepared, int &total_secs) const;
+        void search(const QVector<double> &prepared);
+        void forget();
+
+        // samples in each hash
+        static const int Block = 256;
+        static quint64 hash(const double *samples, int count);
+
+        mutable QMutex lock;
+
+        transform type;
+        double recIntSecs, decimals, weight;
+
+        // state as at the last update
+        bool valid;
+        int count;                      // prepared samples
+        QVector<quint64> hashes;        // of each Block of them, the last may be short
+        bool exact;                     // all whole numbers, running totals are exact
+        bool positive;                  // no negative values, divided search is exhaustive
+        QVector<double> best;           // best energy for each duration
+        QVector<int> offset;            // where it was found, -1 if not found
+        int total_secs;
+        int searched_;
+
+        // as we append
+        bool appending;
+        Preparer preparer;
+        QVector<double> integrated;     // running totals of the prepared samples
+};
+#endif // _GC_MeanMaxEngine_h
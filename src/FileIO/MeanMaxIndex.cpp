@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MeanMaxIndex.h"
+#include "RideFileCache.h"
+#include "Context.h"
+#include "Athlete.h"
+#include "RideCache.h"
+#include "RideItem.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QMutexLocker>
+
+static const quint32 MeanMaxIndexMagic = 0x474d4d49; // GMMI
+
+MeanMaxIndex::MeanMaxIndex(Context *context) : context(context)
+{
+    directory = context->athlete->home->cache().canonicalPath() + "/meanmax";
+    QDir().mkpath(directory);
+}
+
+quint64
+MeanMaxIndex::signature(quint64 sig, RideItem *item)
+{
+    const quint64 prime = 1099511628211ULL;
+    sig = (sig ^ qHash(item->fileName)) * prime;
+    sig = (sig ^ quint64(item->crc)) * prime;
+    sig = (sig ^ quint64(item->fingerprint)) * prime;
+    sig = (sig ^ quint64(item->timestamp)) * prime;
+    sig = (sig ^ quint64(1000.0f * item->weight)) * prime;
+    return sig;
+}
+
+static QDate
+weekStart(QDate date)
+{
+    return date.addDays(1 - date.dayOfWeek());
+}
+
+QString
+MeanMaxIndex::key(blocktype type, QDate start, QString sport) const
+{
+    // sport names are user defined, keep them filename safe
+    QString safe;
+    foreach(QChar c, sport) safe += c.isLetterOrNumber() ? c : QChar('_');
+
+    switch (type) {
+    case Year: return QString("%1-Y%2").arg(safe).arg(start.toString("yyyy"));
+    case Month: return QString("%1-M%2").arg(safe).arg(start.toString("yyyyMM"));
+    default:
+    case Week: return QString("%1-W%2").arg(safe).arg(start.toString("yyyyMMdd"));
+    }
+}
+
+QString
+MeanMaxIndex::fileName(const QString &key) const
+{
+    return directory + "/" + key + ".mmx";
+}
+
+bool
+MeanMaxIndex::aggregate(RideFileCache &into, QDate from, QDate to, QString sport)
+{
+    // blocks that could be used are within whole years, plus the
+    // weeks that straddle the new year at either end
+    QDate first = weekStart(QDate(from.year(), 1, 1));
+    QDate last = weekStart(QDate(to.year(), 12, 31)).addDays(6);
+
+    // work out the signature for every block, and the rides in the range
+    // by sport for the days that are not in a block; take a copy of the ride
+    // list since we may be called from a thread
+    QVector<RideItem*> all = context->athlete->rideCache->rides();
+    QHash<QString, QList<RideItem*> > days;
+    QHash<QString, entry> entries;
+    QStringList sports;
+
+    // only the lookups are locked, the blocks are read and written without it;
+    // they are saved whole so another thread never sees one half written
+    lock.lock();
+    foreach(RideItem *item, all) {
+
+        QDate date = item->dateTime.date();
+        if (date < first || date > last) continue;
+        if (sport != "" && item->sport != sport) continue;
+
+        // for all sports we aggregate each sport then combine them
+        if (date >= from && date <= to && !sports.contains(item->sport)) sports << item->sport;
+
+        QStringList keys;
+        keys << key(Week, weekStart(date), item->sport)
+             << key(Month, QDate(date.year(), date.month(), 1), item->sport)
+             << key(Year, QDate(date.year(), 1, 1), item->sport);
+
+        foreach(QString k, keys) {
+            entry &e = entries[k];
+            e.signature = signature(e.signature, item);
+            if (item->isStale()) e.settled = false;
+            e.rides << item;
+        }
+
+        if (date >= from && date <= to) days[item->sport + date.toString(Qt::ISODate)] << item;
+    }
+    lock.unlock();
+
+    QList<span> plan = spans(from, to);
+
+    bool complete = true;
+    foreach(QString s, sports) {
+
+        RideFileCache bests(context);
+
+        foreach(span x, plan) {
+
+            if (x.type == Day) {
+                // just the rides on the day
+                if (!rides(bests, days.value(s + x.start.toString(Qt::ISODate)))) complete = false;
+            } else {
+                if (!block(bests, entries, x.type, x.start, s)) complete = false;
+            }
+        }
+
+        into.aggregate(bests);
+    }
+
+    if (!complete) into.incomplete = true;
+    return complete;
+}
+
+QList<MeanMaxIndex::span>
+MeanMaxIndex::spans(QDate from, QDate to)
+{
+    QList<span> returning;
+
+    QDate date = from;
+    while (date <= to) {
+
+        QDate nextYear = date.addYears(1);
+        QDate nextMonth = date.addMonths(1);
+        QDate sunday = date.addDays(6);
+
+        // weeks that run into the next month only if
+        // that month isn't going to be used whole
+        bool week = date.dayOfWeek() == 1 && sunday <= to &&
+                    (sunday.month() == date.month() ||
+                     QDate(sunday.year(), sunday.month(), 1).addMonths(1).addDays(-1) > to);
+
+        span add;
+        add.start = date;
+        if (date.dayOfYear() == 1 && nextYear.addDays(-1) <= to) {
+            add.type = Year;
+            date = nextYear;
+        } else if (date.day() == 1 && nextMonth.addDays(-1) <= to) {
+            add.type = Month;
+            date = nextMonth;
+        } else if (week) {
+            add.type = Week;
+            date = date.addDays(7);
+        } else {
+            add.type = Day;
+            date = date.addDays(1);
+        }
+        returning << add;
+    }
+    return returning;
+}
+
+bool
+MeanMaxIndex::rides(RideFileCache &into, const QList<RideItem*> &list)
+{
+    bool complete = true;
+
+    foreach(RideItem *item, list) {
+
+        // get its cached values (will NOT! refresh if needed...)
+        RideFileCache rideCache(context, context->athlete->home->activities().canonicalPath() + "/" + item->fileName, item->getWeight(), NULL, false, false);
+        if (rideCache.incomplete == true) {
+            // ack, data not available !
+            complete = false;
+        } else {
+            into.aggregate(rideCache, item->dateTime.date());
+        }
+    }
+    return complete;
+}
+
+bool
+MeanMaxIndex::block(RideFileCache &into, const QHash<QString, entry> &entries, blocktype type, QDate start, QString sport)
+{
+    QString k = key(type, start, sport);
+
+    // no rides, nothing to do
+    if (!entries.contains(k)) return true;
+    const entry e = entries.value(k);
+
+    // up to date on disk?
+    RideFileCache bests(context);
+    if (read(bests, k, e.signature)) {
+        into.aggregate(bests);
+        return true;
+    }
+
+    // aggregate it again, years from their months
+    bool complete = true;
+    if (type == Year) {
+        for (int month=1; month<=12; month++)
+            if (!block(bests, entries, Month, QDate(start.year(), month, 1), sport)) complete = false;
+    } else {
+        if (!rides(bests, e.rides)) complete = false;
+    }
+
+    if (complete && e.settled) write(bests, k, e.signature);
+
+    into.aggregate(bests);
+    return complete;
+}
+
+bool
+MeanMaxIndex::read(RideFileCache &into, const QString &key, quint64 signature)
+{
+    QFile file(fileName(key));
+    if (!file.open(QFile::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic, version, cacheversion;
+    quint64 sig;
+    QByteArray data;
+    in >> magic >> version >> cacheversion >> sig;
+
+    // stale or from another version
+    if (in.status() != QDataStream::Ok || magic != MeanMaxIndexMagic || version != MEANMAX_INDEX_VERSION ||
+        cacheversion != RideFileCacheVersion || sig != signature) return false;
+
+    in >> data;
+    if (in.status() != QDataStream::Ok) return false;
+
+    QByteArray unpacked = qUncompress(data);
+    QDataStream arrays(unpacked);
+    arrays.setVersion(QDataStream::Qt_5_0);
+
+    if (!into.readAggregate(arrays)) {
+        into.resetAggregate();
+        return false;
+    }
+    return true;
+}
+
+void
+MeanMaxIndex::write(RideFileCache &from, const QString &key, quint64 signature)
+{
+    QByteArray unpacked;
+    QDataStream arrays(&unpacked, QIODevice::WriteOnly);
+    arrays.setVersion(QDataStream::Qt_5_0);
+    from.writeAggregate(arrays);
+
+    // written to a temporary and renamed, so a block is never half written
+    QSaveFile file(fileName(key));
+    if (!file.open(QFile::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << MeanMaxIndexMagic << quint32(MEANMAX_INDEX_VERSION) << quint32(RideFileCacheVersion) << signature;
+    out << qCompress(unpacked);
+    file.commit();
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_MeanMaxIndex_h
+#define _GC_MeanMaxIndex_h 1
+#include "GoldenCheetah.h"
+
+#include <QString>
+#include <QDate>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+
+class Context;
+class RideItem;
+class RideFileCache;
+
+//
+// Pre-aggregated mean-max (and distribution, time in zone) data for each
+// sport by week, month and year, so a date range can be aggregated from a
+// handful of blocks instead of reading the .cpx file for every ride.
+//
+// A date range is split into the largest blocks that fit; whole years, then
+// whole months, then whole weeks (Monday to Sunday) and whatever days are
+// left over are aggregated from the rides themselves. Years are aggregated
+// from their months, weeks and months from their rides.
+//
+// Blocks are saved in cache/meanmax, one file per block, with a signature
+// of the rides they were aggregated from (filename, crc, zone fingerprint,
+// weight and timestamp). When a ride is added, deleted or refreshed the
+// signature no longer matches and the block is aggregated again. Blocks
+// with rides that are stale, or whose .cpx is not available, are used but
+// never saved.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+//
+#define MEANMAX_INDEX_VERSION 1
+
+class MeanMaxIndex
+{
+    public:
+
+        MeanMaxIndex(Context *context);
+
+        // aggregate rides from..to (inclusive) into an empty aggregate, for a
+        // single sport or all of them when sport is empty. returns false if
+        // data for any of the rides was not available
+        bool aggregate(RideFileCache &into, QDate from, QDate to, QString sport);
+
+        // combine a ride into the signature for a set of rides, anything that
+        // changes the .cpx or which rides are in the set changes it
+        static quint64 signature(quint64 sig, RideItem *item);
+
+        enum blocktype { Week, Month, Year, Day };
+
+        // the largest blocks that cover from..to (inclusive), in date order
+        struct span {
+            blocktype type;
+            QDate start;
+        };
+        static QList<span> spans(QDate from, QDate to);
+
+    private:
+
+        // rides in a block and their signature
+        struct entry {
+            entry() : signature(0), settled(true) {}
+            quint64 signature;
+            bool settled;               // no stale rides
+            QList<RideItem*> rides;
+        };
+
+        QString key(blocktype type, QDate start, QString sport) const;
+        QString fileName(const QString &key) const;
+
+        // get a block, from disk or by aggregating it again
+        bool block(RideFileCache &into, const QHash<QString, entry> &entries, blocktype type, QDate start, QString sport);
+        bool rides(RideFileCache &into, const QList<RideItem*> &list);
+
+        bool read(RideFileCache &into, const QString &key, quint64 signature);
+        void write(RideFileCache &from, const QString &key, quint64 signature);
+
+        Context *context;
+        QString directory;
+
+        // held while the ride list is scanned for the rides to aggregate
+        QMutex lock;
+};
+#endif // _GC_MeanMaxIndex_h
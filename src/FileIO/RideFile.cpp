@@ -29,6 +29,8 @@
 #include "Colors.h"
 #include "Units.h"
 #include "SplineLookup.h"
+#include "MeanMaxEngine.h"
+#include "RideFileRows.h"
 
 #include <QJsonObject>
 #include <QJsonArray>
@@ -69,7 +71,7 @@ const QChar deltaChar(0x0394);
 RideFile::RideFile(const QDateTime &startTime, double recIntSecs) :
             wstale(true), startTime_(startTime), recIntSecs_(recIntSecs),
             data(NULL), wprime_(NULL),
-            weight_(0), totalCount(0), totalTemp(0), dstale(true)
+            weight_(0), totalCount(0), totalTemp(0), dstale(true), columnsScopes(0)
 {
     command = new RideFileCommand(this);
 
@@ -84,7 +86,7 @@ RideFile::RideFile(const QDateTime &startTime, double recIntSecs) :
 // and we want to get special fields and ESPECIALLY "CP" and "Weight"
 RideFile::RideFile(RideFile *p) :
     wstale(true), recIntSecs_(p->recIntSecs_), data(NULL), wprime_(NULL),
-    weight_(p->weight_), totalCount(0), totalTemp(0), dstale(true)
+    weight_(p->weight_), totalCount(0), totalTemp(0), dstale(true), columnsScopes(0)
 {
     startTime_ = p->startTime_;
     tags_ = p->tags_;
@@ -105,7 +107,7 @@ RideFile::RideFile(RideFile *p) :
 
 RideFile::RideFile() : 
     wstale(true), recIntSecs_(0.0), data(NULL), wprime_(NULL),
-    weight_(0), totalCount(0), totalTemp(0), dstale(true)
+    weight_(0), totalCount(0), totalTemp(0), dstale(true), columnsScopes(0)
 {
     command = new RideFileCommand(this);
 
@@ -126,6 +128,7 @@ RideFile::~RideFile()
         //delete interval;
     delete command;
     if (wprime_) delete wprime_;
+    qDeleteAll(meanmax_);
 
     // delete any Xdata
     QMapIterator<QString,XDataSeries*> it(xdata_);
@@ -1669,6 +1672,7 @@ void RideFile::appendOrUpdatePoint(double secs, double cad, double hr, double km
     if (forceAppend) { // note forceAppend = true above do not convert to else clause
         dataPoints_.append(point);
     }
+    pointsChanged();
 
     dataPresent.secs     |= (secs != 0);
     dataPresent.cad      |= (cad != 0);
@@ -1810,6 +1814,7 @@ RideFile::updatePoint(RideFilePoint *point, const RideFilePoint *oldPoint){
 void
 RideFile::setDataPresent(SeriesType series, bool value)
 {
+    invalidateColumns();
     switch (series) {
         case secs : dataPresent.secs = value; break;
         case cad : dataPresent.cad = value; break;
@@ -1858,7 +1863,7 @@ RideFile::setDataPresent(SeriesType series, bool value)
 }
 
 bool
-RideFile::isDataPresent(SeriesType series)
+RideFile::isDataPresent(SeriesType series) const
 {
     switch (series) {
         case secs : return dataPresent.secs; break;
@@ -1945,6 +1950,13 @@ RideFile::setPointValue(double secs, SeriesType series, double value) {
 
 void
 RideFile::setPointValue(int index, SeriesType series, double value)
+{
+    pointsChanged();
+    setValue(index, series, value);
+}
+
+void
+RideFile::setValue(int index, SeriesType series, double value)
 {
     switch (series) {
         case secs : dataPoints_[index]->secs = value; break;
@@ -1989,6 +2001,14 @@ RideFile::setPointValue(int index, SeriesType series, double value)
     }
 }
 
+void
+RideFile::setPointValues(SeriesType series, const QVector<int> &rows, const QVector<double> &values)
+{
+    // once for all the rows, not for each of them
+    invalidateColumns();
+    for (int i=0; i<rows.count(); i++) setValue(rows[i], series, values[i]);
+}
+
 double
 RideFilePoint::value(RideFile::SeriesType series) const
 {
@@ -2106,6 +2126,214 @@ RideFilePoint::setValue(RideFile::SeriesType series, double value)
     }
 }
 
+// all the series that can be held in a column
+static QList<RideFile::SeriesType>
+storedSeries()
+{
+    QList<RideFile::SeriesType> returning;
+    for (int i=0; i<static_cast<int>(RideFile::none); i++) {
+        RideFile::SeriesType series = static_cast<RideFile::SeriesType>(i);
+        if (RideFileColumns::isStored(series)) returning << series;
+    }
+    return returning;
+}
+
+RideFileColumnsPtr
+RideFile::columns() const
+{
+    static const QList<SeriesType> all = storedSeries();
+    return columns(all);
+}
+
+RideFileColumnsPtr
+RideFile::columns(const QList<SeriesType> &series) const
+{
+    // refresh threads may all ask at once
+    QMutexLocker locker(&columnsLock);
+
+    // points were changed one at a time since, so nothing built is kept
+    if (pointsChanged_.fetchAndStoreOrdered(0)) {
+        columns_.clear();
+        scoped_.clear();
+        staleColumns.clear();
+    }
+
+    // the last snapshot, if anyone still has it, without
+    // the derived series recalculated since it was built
+    RideFileColumnsPtr current = columns_.toStrongRef();
+    if (!current.isNull() && !staleColumns.isEmpty()) {
+        RideFileColumns *next = new RideFileColumns(*current);
+        next->drop(staleColumns);
+        current = RideFileColumnsPtr(next);
+    }
+    staleColumns.clear();
+
+    bool built = !current.isNull();
+    for (int i=0; built && i<series.count(); i++) built = current->isBuilt(series[i]);
+
+    if (!built) {
+        // what has been handed out is never changed, so the series that are
+        // missing go in a new snapshot that shares the columns already built
+        RideFileColumns *next = current.isNull() ? new RideFileColumns() : new RideFileColumns(*current);
+        next->build(this, series);
+        current = RideFileColumnsPtr(next);
+    }
+
+    columns_ = current;
+    if (columnsScopes) scoped_ = current;
+    return current;
+}
+
+void
+RideFile::invalidateColumns()
+{
+    // columns() may be building them on a refresh thread,
+    // anyone still holding them keeps their snapshot
+    QMutexLocker locker(&columnsLock);
+    pointsChanged_.storeRelease(0);
+    columns_.clear();
+    scoped_.clear();
+    staleColumns.clear();
+}
+
+void
+RideFile::invalidateColumns(const QList<SeriesType> &series)
+{
+    QMutexLocker locker(&columnsLock);
+    if (columns_.isNull()) return;
+
+    // dropped when next asked for, the rest are shared
+    foreach(SeriesType x, series) if (!staleColumns.contains(x)) staleColumns << x;
+}
+
+RideFile::ColumnsScope::ColumnsScope(const RideFile *ride) : ride(ride)
+{
+    QMutexLocker locker(&ride->columnsLock);
+    ride->columnsScopes++;
+}
+
+RideFile::ColumnsScope::~ColumnsScope()
+{
+    QMutexLocker locker(&ride->columnsLock);
+    if (--ride->columnsScopes == 0) ride->scoped_.clear();
+}
+
+MeanMaxEngine *
+RideFile::meanMaxEngine(SeriesType series) const
+{
+    // computed for each series in parallel
+    QMutexLocker locker(&meanmaxLock);
+
+    MeanMaxEngine *engine = meanmax_.value(series, NULL);
+    if (engine == NULL) {
+        engine = new MeanMaxEngine();
+        meanmax_.insert(series, engine);
+    }
+    return engine;
+}
+
+//
+// Columnar copy of the samples
+//
+bool
+RideFileColumns::isStored(RideFile::SeriesType series)
+{
+    switch (series) {
+
+        // computed on demand, not held in RideFilePoint
+        case RideFile::vam :
+        case RideFile::wattsKg :
+        case RideFile::wprime :
+        case RideFile::wbal :
+        case RideFile::clength :
+        case RideFile::aPowerKg :
+        case RideFile::index :
+        case RideFile::none :
+            return false;
+
+        default:
+            return series >= 0 && series < RideFile::none;
+    }
+}
+
+double
+RideFileColumns::defaultValue(RideFile::SeriesType series)
+{
+    // whatever a blank RideFilePoint holds
+    static const RideFilePoint blank;
+    return blank.value(series);
+}
+
+// is there anything worth holding for this series?
+static bool
+columnPresent(const RideFile *ride, RideFile::SeriesType series)
+{
+    switch (series) {
+        case RideFile::secs : return true; // always needed as the time base
+        case RideFile::IsoPower : return ride->areDataPresent()->np;
+        case RideFile::xPower : return ride->areDataPresent()->xp;
+        default: return ride->isDataPresent(series);
+    }
+}
+
+void
+RideFileColumns::build(const RideFile *ride, const QList<RideFile::SeriesType> &series)
+{
+    const QVector<RideFilePoint*> &points = ride->dataPoints();
+    count_ = points.count();
+
+    foreach(RideFile::SeriesType x, series) {
+
+        if (isBuilt(x)) continue;
+        built_[x] = true;
+        if (count_ == 0 || !columnPresent(ride, x)) continue;
+
+        QVector<double> &column = columns_[x];
+        column.resize(count_);
+        double *into = column.data();
+        for (int j=0; j<count_; j++) into[j] = points[j]->value(x);
+    }
+}
+
+void
+RideFileColumns::drop(const QList<RideFile::SeriesType> &series)
+{
+    foreach(RideFile::SeriesType x, series) {
+        if (!isStored(x)) continue;
+        columns_[x] = QVector<double>();
+        built_[x] = false;
+    }
+}
+
+void
+RideFileColumns::clear()
+{
+    for (int i=0; i<static_cast<int>(RideFile::none); i++) {
+        columns_[i] = QVector<double>();
+        built_[i] = false;
+    }
+    count_ = 0;
+}
+
+qint64
+RideFileColumns::memoryUsage() const
+{
+    qint64 bytes = 0;
+    for (int i=0; i<static_cast<int>(RideFile::none); i++) bytes += columns_[i].capacity() * sizeof(double);
+    return bytes;
+}
+
+RideFilePoint
+RideFileSample::point() const
+{
+    RideFilePoint p;
+    for (int i=0; i<static_cast<int>(RideFile::none); i++) {
+        RideFile::SeriesType series = static_cast<RideFile::SeriesType>(i);
+        if (columns->isPresent(series)) p.setValue(series, columns->value(index_, series));
+    }
+    return p;
+}
+
 double
 RideFile::getPointValue(int index, SeriesType series) const
 {
@@ -2320,6 +2548,7 @@ RideFile::minimumFor(SeriesType series)
 void
 RideFile::deletePoint(int index)
 {
+    pointsChanged();
     delete dataPoints_[index];
     dataPoints_.remove(index);
 }
@@ -2327,6 +2556,7 @@ RideFile::deletePoint(int index)
 void
 RideFile::deletePoints(int index, int count)
 {
+    invalidateColumns();
     for(int i=index; i<(index+count); i++) delete dataPoints_[i];
     dataPoints_.remove(index, count);
 }
@@ -2334,9 +2564,35 @@ RideFile::deletePoints(int index, int count)
 void
 RideFile::insertPoint(int index, RideFilePoint *point)
 {
+    pointsChanged();
     dataPoints_.insert(index, point);
 }
 
+// rows are ascending and each point goes in the row it will
+// have once they are all inserted, so we move existing points once
+void
+RideFile::insertPoints(const QVector<int> &rows, const QVector<RideFilePoint *> &points)
+{
+    invalidateColumns();
+
+    // we own the points, so drop them if they can't go in
+    bool inserted = RideFileRows::insert(dataPoints_, rows, points);
+    Q_ASSERT(inserted);
+    if (!inserted) qDeleteAll(points);
+}
+
+// the reverse of insertPoints, rows are ascending
+void
+RideFile::deletePoints(const QVector<int> &rows)
+{
+    invalidateColumns();
+
+    QVector<RideFilePoint*> removed;
+    bool deleted = RideFileRows::remove(dataPoints_, rows, removed);
+    Q_ASSERT(deleted);
+    if (deleted) qDeleteAll(removed);
+}
+
 void
 RideFile::insertXDataPoint(QString _xdata, int index, XDataPoint *point)
 {
@@ -2354,6 +2610,7 @@ RideFile::deleteXDataPoints(QString _xdata, int index, int count)
 void
 RideFile::appendPoints(QVector <struct RideFilePoint *> newRows)
 {
+    invalidateColumns();
     dataPoints_ += newRows;
 }
 
@@ -2369,6 +2626,7 @@ RideFile::emitSaved()
 {
     weight_ = 0;
     wstale = dstale = true;
+    invalidateColumns();
     emit saved();
 }
 
@@ -2377,6 +2635,7 @@ RideFile::emitReverted()
 {
     weight_ = 0;
     wstale = dstale = true;
+    invalidateColumns();
     emit reverted();
 }
 
@@ -2385,6 +2644,7 @@ RideFile::emitModified()
 {
     weight_ = 0;
     wstale = dstale = true;
+    invalidateColumns();
     emit modified();
 }
 
@@ -3041,8 +3301,12 @@ RideFile::recalculateDerivedSeries(bool force)
     avgPoint->apower = APcount ? (APtotal / APcount) : 0;
     totalPoint->apower = APtotal;
 
-    // and we're done
+    // and we're done, any columns copied the old derived values
+    // but the rest are still good for whoever reads them next
     dstale=false;
+    invalidateColumns(QList<SeriesType>() << IsoPower << xPower << aPower << aTISS << anTISS
+                                          << wattsd << cadd << nmd << hrd << kphd
+                                          << gear << slope << hhb << o2hb << tcore);
 }
 
 #ifdef GC_HAVE_SAMPLERATE
@@ -25,8 +25,12 @@
 #include <QFile>
 #include <QList>
 #include <QMap>
+#include <QHash>
 #include <QVector>
 #include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QSharedPointer>
 #include <QRegExp>
 
 class RideItem;
@@ -39,18 +43,25 @@ class XDataSeries;
 class XDataPoint;
 struct RideFilePoint;
 struct RideFileDataPresent;
+class RideFileColumns;
+typedef QSharedPointer<const RideFileColumns> RideFileColumnsPtr;
+class MeanMaxEngine;
 class RideFileInterval;
 class EditorData;      // attached to a RideFile
 class RideFileCommand; // for manipulating ride data
 class Context;      // for context; cyclist, homedir
 
-// This file defines four classes:
+// This file defines six classes:
 //
 // RideFile, as the name suggests, represents the data stored in a ride file,
 // regardless of what type of file it is (.raw, .srm, .csv).
 //
 // RideFilePoint represents the data for a single sample in a RideFile.
 //
+// RideFileColumns holds the same samples as contiguous per-series arrays
+// (structure-of-arrays) for code that scans whole series at a time, and
+// RideFileSample is a lightweight view of one sample held in it.
+//
 // RideFileReader is an abstract base class for function-objects that take a
 // filename and return a RideFile object representing the ride stored in the
 // corresponding file.
@@ -331,6 +342,36 @@ class RideFile : public QObject // QObject to emit signals
 
         const QVector<RideFilePoint*> &dataPoints() const { return dataPoints_; }
 
+        // Working with COLUMNS -- the samples above held as one contiguous
+        // array per series. It is a second copy of the samples alongside
+        // dataPoints(), trading memory for faster whole-series passes, so
+        // only the series asked for are built, on first use, and they are
+        // dropped whenever the samples are changed through the methods below
+        // (just the derived series when they are recalculated). What is
+        // returned is a snapshot that is never changed, hold on to it for as
+        // long as it is read. The ride does not hold it, so it is freed when
+        // the last reader lets go, unless a ColumnsScope is keeping it for
+        // the readers that follow (e.g. the cache and metrics in a refresh).
+        // Callers that update RideFilePoints directly must call emitModified()
+        // (or use the command) afterwards. Like the derived series, call
+        // recalculateDerivedSeries() first.
+        RideFileColumnsPtr columns() const; // every stored series
+        RideFileColumnsPtr columns(const QList<SeriesType> &series) const;
+
+        // keeps the columns built while it is in scope, so each reader
+        // doesn't build them again, and frees them when it goes
+        class ColumnsScope {
+            public:
+                ColumnsScope(const RideFile *ride);
+                ~ColumnsScope();
+            private:
+                const RideFile *ride;
+        };
+
+        // Mean-max search state for each series, kept between computes so that
+        // after an edit only the windows affected need to be searched again
+        MeanMaxEngine *meanMaxEngine(SeriesType series) const;
+
         // recalculate all the derived data series
         // might want to move to a factory for these
         // at some point, but for now hard coded
@@ -344,7 +385,7 @@ class RideFile : public QObject // QObject to emit signals
 
         // Working with DATAPRESENT flags
         inline const RideFileDataPresent *areDataPresent() const { return &dataPresent; }
-        bool isDataPresent(SeriesType series);
+        bool isDataPresent(SeriesType series) const;
         QVector<SeriesType> arePresent(); // list of what is present
 
         // Working with FIRST CLASS variables
@@ -436,6 +477,9 @@ class RideFile : public QObject // QObject to emit signals
         void deletePoints(int index, int count);
         void insertPoint(int index, RideFilePoint *point);
         void appendPoints(QVector <struct RideFilePoint *> newRows);
+        void setPointValues(SeriesType series, const QVector<int> &rows, const QVector<double> &values);
+        void insertPoints(const QVector<int> &rows, const QVector<RideFilePoint *> &points);
+        void deletePoints(const QVector<int> &rows);
         void setDataPresent(SeriesType, bool);
         void insertXDataPoint(QString xdata, int index, XDataPoint *point);
         void deleteXDataPoints(QString xdata, int index, int count);
@@ -495,6 +539,24 @@ class RideFile : public QObject // QObject to emit signals
 
         bool dstale; // is derived data up to date?
 
+        // columnar copy of dataPoints_, see columns(). The methods that change
+        // a single point only mark them changed, without taking the lock, and
+        // they are dropped when next asked for or at the end of the command
+        void invalidateColumns();
+        void invalidateColumns(const QList<SeriesType> &series);
+        void pointsChanged() { pointsChanged_.storeRelease(1); }
+        void setValue(int index, SeriesType series, double value); // without marking
+        mutable QAtomicInt pointsChanged_;
+        mutable QWeakPointer<const RideFileColumns> columns_; // whilst anyone reads it
+        mutable RideFileColumnsPtr scoped_;                   // whilst a ColumnsScope holds it
+        mutable QList<SeriesType> staleColumns;               // recalculated since it was built
+        mutable int columnsScopes;
+        mutable QMutex columnsLock;
+
+        // see meanMaxEngine()
+        mutable QHash<int, MeanMaxEngine*> meanmax_;
+        mutable QMutex meanmaxLock;
+
         // data required to compute headwind based on weather broadcast
         double windSpeed_, windHeading_;
 };
@@ -573,6 +635,82 @@ struct RideFilePoint
     void setValue(RideFile::SeriesType series, double value);
 };
 
+// Structure-of-arrays copy of the samples in a RideFile, one contiguous
+// array per series so whole-series passes (mean max, distributions, metrics)
+// read consecutive memory instead of striding across RideFilePoints.
+// Only the series asked for are built. Series that are not present are never
+// allocated and read back as the default RideFilePoint value for that series
+// (e.g. RideFile::NA for temp), as do series that were not asked for.
+class RideFileSample;
+class RideFileColumns {
+
+    public:
+
+        RideFileColumns() { clear(); }
+
+        // the series given that are not built already
+        void build(const RideFile *ride, const QList<RideFile::SeriesType> &series);
+        void drop(const QList<RideFile::SeriesType> &series);
+        void clear();
+
+        int count() const { return count_; }
+        bool isBuilt(RideFile::SeriesType series) const {
+            return !isStored(series) || built_[series];
+        }
+        bool isPresent(RideFile::SeriesType series) const {
+            return series >= 0 && series < RideFile::none && !columns_[series].isEmpty();
+        }
+
+        // contiguous array of count() values, or NULL if the series is not present
+        const double *column(RideFile::SeriesType series) const {
+            return isPresent(series) ? columns_[series].constData() : NULL;
+        }
+        // the column itself, implicitly shared so it can be held on to
+        // after the columns are rebuilt, or empty if the series is not present
+        QVector<double> array(RideFile::SeriesType series) const {
+            return isPresent(series) ? columns_[series] : QVector<double>();
+        }
+        double value(int index, RideFile::SeriesType series) const {
+            return isPresent(series) ? columns_[series].at(index) : defaultValue(series);
+        }
+        inline RideFileSample sample(int index) const;
+
+        // the series RideFilePoint::value() returns, the rest are computed
+        // on demand (wbal, vam, wattsKg etc) and are never held in a column
+        static bool isStored(RideFile::SeriesType series);
+        static double defaultValue(RideFile::SeriesType series);
+
+        // bytes held by the columns, for diagnostics
+        qint64 memoryUsage() const;
+
+    private:
+        int count_;
+        QVector<double> columns_[RideFile::none];
+        bool built_[RideFile::none];
+};
+
+// A view of a single sample held in RideFileColumns that offers the same
+// value() accessor as RideFilePoint, so per-sample code can run against
+// either storage. Cheap to copy, only valid while the columns are held.
+class RideFileSample {
+
+    public:
+        RideFileSample(const RideFileColumns *columns, int index) : columns(columns), index_(index) {}
+
+        int index() const { return index_; }
+        double value(RideFile::SeriesType series) const { return columns->value(index_, series); }
+        double secs() const { return columns->value(index_, RideFile::secs); }
+
+        // materialise as a RideFilePoint, e.g. to pass to older code
+        RideFilePoint point() const;
+
+    private:
+        const RideFileColumns *columns;
+        int index_;
+};
+
+inline RideFileSample RideFileColumns::sample(int index) const { return RideFileSample(this, index); }
+
 class RideFileIterator {
 
     public:
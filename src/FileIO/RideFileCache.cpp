@@ -26,6 +26,10 @@
 #include "PaceZones.h"
 #include "WPrime.h" // for wbal zones
 #include "LTMSettings.h" // getAllBestsFor needs this
+#include "TaskScheduler.h"
+#include "MeanMaxEngine.h"
+#include "MeanMaxIndex.h"
+#include "ZoneEngine.h"
 
 #include <cmath> // for pow()
 #include <QDebug>
@@ -315,63 +319,23 @@ static long countForMeanMax(RideFileCacheHeader head, RideFile::SeriesType serie
     return 0;
 }
 
-QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float> &wpk, QDate from, QDate to, QVector<QDate>*dates, QString sport)
+QVector<float> RideFileCache::meanMaxPowerFor(Context *context, QVector<float> &wpk, QDate from, QDate to, QVector<QDate>*dates, QString sport, bool *complete)
 {
     QVector<float> returning;
-    QVector<float> returningwpk;
-    bool first = true;
-
-    // look at all the rides
-    QList<RideItem*> rides = context->athlete->rideCache->rides(); // Create a copy of the ride list to prevent a crash
-    for (RideItem *item : rides) {
-
-        if (item->dateTime.date() < from || item->dateTime.date() > to) continue; // not one we want
-
-        if (item->sport != sport) continue; // they don't want these
-
-        // get the power data
-        if (first == true) {
 
-            // first time through the whole thing is going to be best
-            returning =  meanMaxPowerFor(context, returningwpk, context->athlete->home->activities().canonicalPath() + "/" + item->fileName);
+    // aggregate from the index, weeks are usually pre-aggregated
+    RideFileCache bests(context);
+    bool ok = context->athlete->meanmaxIndex->aggregate(bests, from, to, sport);
+    if (complete) *complete = ok;
 
-            // set a;; dates to this
-            if (dates) {
-                dates->resize(returning.size());
-                for(int i=0; i<dates->size(); i++) (*dates)[i]=item->dateTime.date();
-            }
-            first = false;
-
-        } else {
-
-            QVector<float> thiswpk;
-
-            // next time through we should only pick out better times
-            QVector<float> ridebest = meanMaxPowerFor(context, thiswpk, context->athlete->home->activities().canonicalPath() + "/" + item->fileName);
-
-            // do we need to increase the returning array?
-            if (returning.size() < ridebest.size()) returning.resize(ridebest.size());
-            if (dates && dates->size() < ridebest.size()) dates->resize(ridebest.size());
-
-            // now update where its a better number
-            for (int i=0; i<ridebest.size(); i++) {
-                if (ridebest[i] > returning[i]) {
-                    returning[i] = ridebest[i];
-                    (*dates)[i]=item->dateTime.date();
-                }
-           }
-
-            // do we need to increase the returning array?
-            if (returningwpk.size() < thiswpk.size()) returningwpk.resize(thiswpk.size());
-
-            // now update where its a better number
-            for (int i=0; i<thiswpk.size(); i++)
-                if (thiswpk[i] > returningwpk[i]) returningwpk[i] =thiswpk[i];
-        }
-    }
+    returning.resize(bests.wattsMeanMaxDouble.size());
+    for (int i=0; i<returning.size(); i++) returning[i] = bests.wattsMeanMaxDouble[i];
+    if (dates) *dates = bests.wattsMeanMaxDate;
 
     // set aggregated wpk
-    wpk = returningwpk;
+    wpk.resize(bests.wattsKgMeanMaxDouble.size());
+    for (int i=0; i<wpk.size(); i++) wpk[i] = bests.wattsKgMeanMaxDouble[i];
+
     return returning;
 }
 
@@ -929,53 +893,44 @@ void RideFileCache::RideFileCache::compute()
         return;
     }
 
-    // all the mean maxes
-    MeanMaxComputer thread1(ride, wattsMeanMax, RideFile::watts); thread1.start();
-    MeanMaxComputer thread2(ride, hrMeanMax, RideFile::hr); thread2.start();
-    MeanMaxComputer thread3(ride, cadMeanMax, RideFile::cad); thread3.start();
-    MeanMaxComputer thread4(ride, nmMeanMax, RideFile::nm); thread4.start();
-    MeanMaxComputer thread5(ride, kphMeanMax, RideFile::kph); thread5.start();
-    MeanMaxComputer thread6(ride, xPowerMeanMax, RideFile::xPower); thread6.start();
-    MeanMaxComputer thread7(ride, npMeanMax, RideFile::IsoPower); thread7.start();
-    MeanMaxComputer thread8(ride, vamMeanMax, RideFile::vam); thread8.start();
-    MeanMaxComputer thread9(ride, wattsKgMeanMax, RideFile::wattsKg); thread9.start();
-    MeanMaxComputer thread10(ride, aPowerMeanMax, RideFile::aPower); thread10.start();
-    MeanMaxComputer thread11(ride, kphdMeanMax, RideFile::kphd); thread11.start();
-    MeanMaxComputer thread12(ride, wattsdMeanMax, RideFile::wattsd); thread12.start();
-    MeanMaxComputer thread13(ride, caddMeanMax, RideFile::cadd); thread13.start();
-    MeanMaxComputer thread14(ride, nmdMeanMax, RideFile::nmd); thread14.start();
-    MeanMaxComputer thread15(ride, hrdMeanMax, RideFile::hrd); thread15.start();
-    MeanMaxComputer thread16(ride, aPowerKgMeanMax, RideFile::aPowerKg); thread16.start();
-
-    // all the different distributions
-    computeDistribution(wattsDistribution, RideFile::watts);
-    computeDistribution(hrDistribution, RideFile::hr);
-    computeDistribution(cadDistribution, RideFile::cad);
-    computeDistribution(gearDistribution, RideFile::gear);
-    computeDistribution(nmDistribution, RideFile::nm);
-    computeDistribution(kphDistribution, RideFile::kph);
-    computeDistribution(wattsKgDistribution, RideFile::wattsKg);
-    computeDistribution(aPowerDistribution, RideFile::aPower);
-    computeDistribution(smo2Distribution, RideFile::smo2);
-    computeDistribution(wbalDistribution, RideFile::wbal);
-
-    // wait for them threads
-    thread1.wait();
-    thread2.wait();
-    thread3.wait();
-    thread4.wait();
-    thread5.wait();
-    thread6.wait();
-    thread7.wait();
-    thread8.wait();
-    thread9.wait();
-    thread10.wait();
-    thread11.wait();
-    thread12.wait();
-    thread13.wait();
-    thread14.wait();
-    thread15.wait();
-    thread16.wait();
+    // all the mean maxes, as tasks on the shared scheduler
+    // rather than a thread each; if we are already running in
+    // a task (RideCache refresh) waiting will help run them
+    TaskGroup group;
+    MeanMaxComputer thread1(ride, wattsMeanMax, RideFile::watts); group.run([&thread1]() { TaskStageTimer timer("meanmax"); thread1.run(); });
+    MeanMaxComputer thread2(ride, hrMeanMax, RideFile::hr); group.run([&thread2]() { TaskStageTimer timer("meanmax"); thread2.run(); });
+    MeanMaxComputer thread3(ride, cadMeanMax, RideFile::cad); group.run([&thread3]() { TaskStageTimer timer("meanmax"); thread3.run(); });
+    MeanMaxComputer thread4(ride, nmMeanMax, RideFile::nm); group.run([&thread4]() { TaskStageTimer timer("meanmax"); thread4.run(); });
+    MeanMaxComputer thread5(ride, kphMeanMax, RideFile::kph); group.run([&thread5]() { TaskStageTimer timer("meanmax"); thread5.run(); });
+    MeanMaxComputer thread6(ride, xPowerMeanMax, RideFile::xPower); group.run([&thread6]() { TaskStageTimer timer("meanmax"); thread6.run(); });
+    MeanMaxComputer thread7(ride, npMeanMax, RideFile::IsoPower); group.run([&thread7]() { TaskStageTimer timer("meanmax"); thread7.run(); });
+    MeanMaxComputer thread8(ride, vamMeanMax, RideFile::vam); group.run([&thread8]() { TaskStageTimer timer("meanmax"); thread8.run(); });
+    MeanMaxComputer thread9(ride, wattsKgMeanMax, RideFile::wattsKg); group.run([&thread9]() { TaskStageTimer timer("meanmax"); thread9.run(); });
+    MeanMaxComputer thread10(ride, aPowerMeanMax, RideFile::aPower); group.run([&thread10]() { TaskStageTimer timer("meanmax"); thread10.run(); });
+    MeanMaxComputer thread11(ride, kphdMeanMax, RideFile::kphd); group.run([&thread11]() { TaskStageTimer timer("meanmax"); thread11.run(); });
+    MeanMaxComputer thread12(ride, wattsdMeanMax, RideFile::wattsd); group.run([&thread12]() { TaskStageTimer timer("meanmax"); thread12.run(); });
+    MeanMaxComputer thread13(ride, caddMeanMax, RideFile::cadd); group.run([&thread13]() { TaskStageTimer timer("meanmax"); thread13.run(); });
+    MeanMaxComputer thread14(ride, nmdMeanMax, RideFile::nmd); group.run([&thread14]() { TaskStageTimer timer("meanmax"); thread14.run(); });
+    MeanMaxComputer thread15(ride, hrdMeanMax, RideFile::hrd); group.run([&thread15]() { TaskStageTimer timer("meanmax"); thread15.run(); });
+    MeanMaxComputer thread16(ride, aPowerKgMeanMax, RideFile::aPowerKg); group.run([&thread16]() { TaskStageTimer timer("meanmax"); thread16.run(); });
+
+    // all the different distributions, whilst the mean maxes run
+    {
+        TaskStageTimer timer("distributions");
+        computeDistribution(wattsDistribution, RideFile::watts);
+        computeDistribution(hrDistribution, RideFile::hr);
+        computeDistribution(cadDistribution, RideFile::cad);
+        computeDistribution(gearDistribution, RideFile::gear);
+        computeDistribution(nmDistribution, RideFile::nm);
+        computeDistribution(kphDistribution, RideFile::kph);
+        computeDistribution(wattsKgDistribution, RideFile::wattsKg);
+        computeDistribution(aPowerDistribution, RideFile::aPower);
+        computeDistribution(smo2Distribution, RideFile::smo2);
+        computeDistribution(wbalDistribution, RideFile::wbal);
+    }
+
+    // wait for them tasks
+    group.wait();
 
     // setup the doubles the users use
     doubleArray(wattsMeanMaxDouble, wattsMeanMax, RideFile::watts);
@@ -1010,222 +965,9 @@ void RideFileCache::RideFileCache::compute()
 }
 
 //----------------------------------------------------------------------
-// Mark Rages' Algorithm for Fast Find of Mean-Max
+// Mean-Max, see MeanMaxEngine for Mark Rages' Algorithm
 //----------------------------------------------------------------------
 
-/*
-
-   A Faster Mean-Max Algorithm
-
-   Premises:
-
-   1 - maximum average power for a given interval occurs at maximum
-       energy for the interval, because the interval time is fixed;
-
-   2 - the energy in an interval enclosing a smaller interval will
-       always be equal or greater than an interval;
-
-   3 - finding maximum of means is a search algorithm, so biggest
-       gains are found in reducing the search space as quickly as
-       possible.
-
-   Algorithm
-
-   note: I find it easier to reason with concrete numbers, so I will
-   describe the algorithm in terms of power and 60 second max-mean:
-
-   To find the maximum average power for one minute:
-
-   1 - integrate the watts over the entire ride to get accumulated
-       energy in joules.  This is a monotonic function (assuming watts
-       are positive).  The final value is the energy for the whole
-       ride.  Once this is done, the energy for any section can be
-       found with a single subtraction.
-
-   2 - divide the energy into overlapping two-minute sections.
-       Section one = 0:00 -> 2:00, section two = 1:00 -> 3:00, etc.
-
-       Example:  Find 60s MM in 5-minute file
-
-       +----------+----------+----------+----------+----------+
-       | minute 1 | minute 2 | minute 3 | minute 4 | minute 5 |
-       +----------+----------+----------+----------+----------+
-       |             |_MEAN_MAX_|                             |
-       +---------------------+---------------------+----------+
-       |      segment 1      |      segment 3      |
-       +----------+----------+----------+----------+----------+
-                  |      segment 2      |      segment 4      |
-                  +---------------------+---------------------+
-
-       So no matter where the MEAN_MAX segment is located in time, it
-       will be wholly contained in one segment.
-
-       In practice, it is a little faster to make the windows smaller
-       and overlap more:
-       +----------+----------+----------+----------+----------+
-       | minute 1 | minute 2 | minute 3 | minute 4 | minute 5 |
-       +----------+----------+----------+----------+----------+
-       |             |_MEAN_MAX_|                             |
-       +-------------+----------------------------------------+
-          |  segment 1  |
-          +--+----------+--+
-          |  segment 2  |
-          +--+----------+--+
-             |  segment 3  |
-             +--+----------+--+
-                |  segment 4  |
-                +--+----------+--+
-                   |  segment 5  |
-                   +--+----------+--+
-                      |  segment 6  |
-                      +--+----------+--+
-                         |  segment 7  |
-                         +--+----------+--+
-                            |  segment 8  |
-                            +--+----------+--+
-                               |  segment 9  |
-                               +-------------+
-                                            ... etc.
-
-       ( This is because whenever the actual mean max energy is
-         greater than a segment energy, we can skip the detail
-         comparison within that segment altogether.  The exact
-         tradeoff for optimum performance depends on the distribution
-         of the data.  It's a pretty shallow curve.  Values in the 1
-         minute to 1.5 minute range seem to work pretty well. )
-
-   3 - for each two minute section, subtract the accumulated energy at
-       the end of the section from the accumulated energy at the
-       beginning of the section.  That gives the energy for that section.
-
-   4 - in the first section, go second-by-second to find the maximum
-       60-second energy.  This is our candidate for 60-second energy
-
-   5 - go down the sorted list of sections.  If the energy in the next
-       section is less than the 60-second energy in the best candidate so
-       far, skip to the next section without examining it carefully,
-       because the section cannot possibly have a one-minute section with
-       greater energy.
-
-       while (section->energy > candidate) {
-         candidate=max(candidate, search(section, 60));
-         section++;
-       }
-
-   6. candidate is the mean max for 60 seconds.
-
-   Enhancements that are not implemented:
-
-     - The two-minute overlapping sections can be reused for 59
-       seconds, etc.  The algorithm will degrade to exhaustive search
-       if the looked-for interval is much smaller than the enclosing
-       interval.
-
-     - The sections can be sorted by energy in reverse order before
-       step #4.  Then the search in #5 can be terminated early, the
-       first time it fails.  In practice, the comparisons in the
-       search outnumber the saved comparisons.  But this might be a
-       useful optimization if the windows are reused per the previous
-       idea.
-
-*/
-
-static data_t *
-integrate_series(cpintdata &data)
-{
-    // would be better to do pure QT and use QVector -- but no memory leak
-    data_t *integrated= (data_t *)malloc(sizeof(data_t)*(data.points.size()+1)); 
-    int i;
-    data_t acc=0;
-
-    for (i=0; i<data.points.size(); i++) {
-        integrated[i]=acc;
-        acc+=data.points[i].value;
-    }
-    integrated[i]=acc;
-
-    return integrated;
-}
-
-static data_t
-partial_max_mean(data_t *dataseries_i, int start, int end, int length, int *offset)
-{
-    int i=0;
-    data_t candidate=0;
-
-    int best_i=0;
-
-    for (i=start; i<(1+end-length); i++) {
-        data_t test_energy=dataseries_i[length+i]-dataseries_i[i];
-        if (test_energy>candidate) {
-            candidate=test_energy;
-            best_i=i;
-        }
-    }
-    if (offset) *offset=best_i;
-
-    return candidate;
-}
-
-
-static data_t
-divided_max_mean(data_t *dataseries_i, int datalength, int length, int *offset)
-{
-    int shift=length;
-
-    //if sorting data the following is an important speedup hack
-    if (shift>180) shift=180;
-
-    int window_length=length+shift;
-
-    if (window_length>datalength) window_length=datalength;
-
-    // put down as many windows as will fit without overrunning data
-    int start=0;
-    int end=0;
-    data_t energy=0;
-
-    data_t candidate=0;
-    int this_offset=0;
-
-    for (start=0; start+window_length<=datalength; start+=shift) {
-        end=start+window_length;
-        energy=dataseries_i[end]-dataseries_i[start];
-
-        if (energy < candidate) {
-          continue;
-        }
-        data_t window_mm=partial_max_mean(dataseries_i, start, end, length, &this_offset);
-
-        if (window_mm>candidate) {
-            candidate=window_mm;
-            if (offset) *offset=this_offset;
-        }
-    }
-
-    // if the overlapping windows don't extend to the end of the data,
-    // let's tack another one on at the end
-
-    if (end<datalength) {
-        start=datalength-window_length;
-        end=datalength;
-        energy=dataseries_i[end]-dataseries_i[start];
-
-        if (energy >= candidate) {
-
-            data_t window_mm=partial_max_mean(dataseries_i, start, end, length, &this_offset);
-
-            if (window_mm>candidate) {
-                candidate=window_mm;
-                if (offset) *offset=this_offset;
-            }
-        }
-    }
-
-    return candidate;
-}
-
-
 void
 MeanMaxComputer::run()
 {
@@ -1253,232 +995,36 @@ MeanMaxComputer::run()
     // e.g. 145.456 becomes 1455 if we want decimals
     // and becomes 145 if we don't
     double decimals =  pow(10, RideFileCache::decimalsFor(series));
-    //double decimals = RideFile::decimalsFor(baseSeries) ? 10 : 1;
-
-    // decritize the data series - seems wrong, since it just
-    // rounds to the nearest second - what if the recIntSecs
-    // is less than a second? Has been used for a long while
-    // so going to leave in tact for now - apart from the
-    // addition of code to fill in gaps in recording since
-    // they affect the IsoPower/xPower algorithm badly and will skew
-    // the calculations of >6m since windowsize is used to
-    // determine segment duration rather than examining the
-    // timestamps on each sample
-    // the decrit will also pull timestamps back to start at
-    // zero, since some files have a very large start time
-    // that creates work for nil effect (but increases compute
-    // time drastically).
-    cpintdata data;
-    data.rec_int_ms = (int) round(ride->recIntSecs() * 1000.0);
-    double lastsecs = 0;
-    bool first = true;
-    double offset = 0;
-    foreach (const RideFilePoint *p, ride->dataPoints()) {
-
-        // get offset to apply on all samples if first sample
-        if (first == true) {
-            offset = p->secs;
-            first = false;
-        }
-
-        // drag back to start at 1s or whatever recIntSecs() is !
-        double psecs = p->secs - offset + ride->recIntSecs();
-
-        // fill in any gaps in recording - use same dodgy rounding as before
-        int count = (psecs - lastsecs - ride->recIntSecs()) / ride->recIntSecs();
-
-        // gap more than an hour, damn that ride file is a mess
-        if (count > 3600) count = 1;
-
-        for(int i=0; i<count; i++)
-            data.points.append(cpintpoint(round(lastsecs+((i+1)*ride->recIntSecs() *1000.0)/1000), 0));
-        lastsecs = psecs;
-
-        double secs = round(psecs * 1000.0) / 1000;
-        if (secs > 0) data.points.append(cpintpoint(secs, (int) round(p->value(baseSeries)*double(decimals))));
-    }
-
-
-    // don't bother with insufficient data
-    if (!data.points.count()) return;
-
-    int total_secs = (int) ceil(data.points.back().secs);
-
-    // don't allow data more than two days
-    // was one week, but no single ride is longer
-    // than 2 days, even if you are doing RAAM
-    if (total_secs > 2*24*60*60) return;
-
-    // don't allow if badly parsed or time goes backwards
-    if (total_secs < 0) return;
-
-    //
-    // Pre-process the data for IsoPower, xPower and VAM
-    //
-
-    // VAM - adjust to Vertical Ascent per Hour
-    if (series == RideFile::vam) {
-
-        double lastAlt=0;
-
-        for (int i=0; i<data.points.size(); i++) {
-
-            // handle drops gracefully (and first sample too)
-            // if you manage to rise >5m in a second thats a data error too!
-            if (!lastAlt || (data.points[i].value - lastAlt) > 5) lastAlt=data.points[i].value;
-
-            // NOTE: It is 360 not 3600 because Altitude is factored for decimal places
-            //       since it is the base data series, but we are calculating VAM
-            //       And we multiply by 10 at the end!
-            double vam = (((data.points[i].value - lastAlt) * 360)/ride->recIntSecs()) * 10;
-            if (vam < 0) vam = 0;
-            lastAlt = data.points[i].value;
-            data.points[i].value = vam;
-        }
-    }
-
-    // IsoPower - rolling 30s avg ^ 4
-    if (series == RideFile::IsoPower) {
-
-        int rollingwindowsize = 30 / ride->recIntSecs();
-
-        // no point doing a rolling average if the
-        // sample rate is greater than the rolling average
-        // window!!
-        if (rollingwindowsize > 1) {
-
-            QVector<double> rolling(rollingwindowsize);
-            int index = 0;
-            double sum = 0;
-
-            // loop over the data and convert to a rolling
-            // average for the given windowsize
-            for (int i=0; i<data.points.size(); i++) {
-
-                sum += data.points[i].value;
-                sum -= rolling[index];
-
-                rolling[index] = data.points[i].value;
-                data.points[i].value = pow(sum/(double)rollingwindowsize,4.0f); // raise rolling average to 4th power
-
-                // move index on/round
-                index = (index >= rollingwindowsize-1) ? 0 : index+1;
-            }
-        }
-    }
-
-    // xPower - 25s EWA - uses same algorithm as BikeScore.cpp
-    if (series == RideFile::xPower) {
 
-        const double exp = ride->recIntSecs() / ((25.0f / ride->recIntSecs()) + ride->recIntSecs());
-        const double rem = 1.0f - exp;
-
-        int rollingwindowsize = 25 / ride->recIntSecs();
-        double ewma = 0.0;
-        double sum = 0.0; // as we ramp up
-
-        // no point doing a rolling average if the
-        // sample rate is greater than the rolling average
-        // window!!
-        if (rollingwindowsize > 1) {
-
-            // loop over the data and convert to a EWMA
-            for (int i=0; i<data.points.size(); i++) {
-
-                // dgr : BikeScore has weighting value from first point
-                if (false && i < rollingwindowsize) {
-
-                    // get up to speed
-                    sum += data.points[i].value;
-                    ewma = sum / (i+1);
-
-                } else {
-
-                    // we're up to speed
-                    ewma = (data.points[i].value * exp) + (ewma * rem);
-                }
-                data.points[i].value = pow(ewma, 4.0f);
-            }
-        }
-    }
-
-    if (series == RideFile::wattsKg || series == RideFile::aPowerKg) {
-        for (int i=0; i<data.points.size(); i++) {
-            double wattsKg = data.points[i].value / ride->getWeight();
-            data.points[i].value = wattsKg;
-        }
-    }
-
-
-    // the bests go in here...
-    QVector <double> ride_bests(total_secs + 1);
-
-    data_t *dataseries_i = integrate_series(data);
-
-    for (int i=1; i<data.points.size();) {
-
-        int offset;
-        data_t c=divided_max_mean(dataseries_i,data.points.size(),i,&offset);
-
-        // snaffle it away
-        int sec = i*ride->recIntSecs();
-        data_t val = c / (data_t)i;
-
-        if (sec < ride_bests.size()) {
-            if (series == RideFile::IsoPower || series == RideFile::xPower)
-                ride_bests[sec] = pow(val, 0.25f);
-            else
-                ride_bests[sec] = val;
-        }
-
-
-        // increments to limit search scope
-        if (i<120) i++;
-        else if (i<600) i+= 2;
-        else if (i<1200) i += 5;
-        else if (i<3600) i += 20;
-        else if (i<7200) i += 120;
-        else i += 300;
-    }
-    free(dataseries_i);
-
-    //
-    // FILL IN THE GAPS AND FILL TARGET ARRAY
-    //
-    // We want to present a full set of bests for
-    // every duration so the data interface for this
-    // cache can remain the same, but the level of
-    // accuracy/granularity can change in here in the
-    // future if some fancy new algorithm arrives
-    //
-
-    // XXX seems we can end up with 0 at the end ?
-    // XXX don't know why, so, for now, just clean that
-    while (ride_bests.size() && ride_bests[ride_bests.size()-1] == 0)
-        ride_bests.resize(ride_bests.size()-1);
-
-    double last = 0;
-
-    // only care about first 3 minutes MAX for delta series
-    if ((series == RideFile::kphd  || series == RideFile::wattsd || series == RideFile::cadd ||
-        series == RideFile::nmd  || series == RideFile::hrd) && ride_bests.count() > 180) {
-        ride_bests.resize(180);
-        array.resize(180);
-    } else {
-        array.resize(ride_bests.count());
-    }
-
-    // bounds check, it might be empty!
-    if (ride_bests.size()) {
-        for (int i=ride_bests.size()-1; i; i--) {
-            if (ride_bests[i] == 0) ride_bests[i]=last;
-            else last = ride_bests[i];
-
-            // convert from double to long, preserving the
-            // precision by applying a multiplier
-            array[i] = ride_bests[i]; // * decimals; -- we did that earlier
-        }
+    // how the samples are prepared
+    MeanMaxEngine::transform type = MeanMaxEngine::Plain;
+    switch (series) {
+    case RideFile::kphd:
+    case RideFile::wattsd:
+    case RideFile::cadd:
+    case RideFile::nmd:
+    case RideFile::hrd: type = MeanMaxEngine::Delta; break;
+    case RideFile::vam: type = MeanMaxEngine::Vam; break;
+    case RideFile::IsoPower: type = MeanMaxEngine::IsoPower; break;
+    case RideFile::xPower: type = MeanMaxEngine::XPower; break;
+    case RideFile::wattsKg:
+    case RideFile::aPowerKg: type = MeanMaxEngine::PerKg; break;
+    default: break;
     }
+    double weight = type == MeanMaxEngine::PerKg ? ride->getWeight() : 0;
+
+    // the ride keeps the engine, so when it has been edited since
+    // the last time only the windows affected are searched again
+    RideFileColumnsPtr columns = ride->columns(QList<RideFile::SeriesType>() << RideFile::secs << baseSeries);
+    MeanMaxEngine *engine = ride->meanMaxEngine(series);
+    engine->setup(type, ride->recIntSecs(), decimals, weight);
+    if (!engine->update(columns->column(RideFile::secs), columns->column(baseSeries),
+                        RideFileColumns::defaultValue(baseSeries), columns->count())) return;
+
+    // fill target array
+    QVector<float> bests = engine->bests();
+    array.resize(bests.count());
+    for (int i=bests.size()-1; i>0; i--) array[i] = bests[i];
 }
 
 // self-contained static routine to perform the fast search algorithm
@@ -1511,7 +1057,7 @@ void RideFileCache::fastSearch(QVector<int>&input, QVector<int>&ride_bests, QVec
     for (int i=1; i<input.count();) {
 
         int offset;
-        data_t c=divided_max_mean(dataseries_i,input.count(),i,&offset);
+        data_t c=MeanMaxEngine::dividedMaxMean(dataseries_i,input.count(),i,&offset);
 
         // snaffle it away
         data_t val = c / (data_t)i;
@@ -1541,6 +1087,17 @@ void RideFileCache::fastSearch(QVector<int>&input, QVector<int>&ride_bests, QVec
     }
 }
 
+static void addTimeInZone(QVector<float> &into, const ZoneTimes &times)
+{
+    for (int i=0; i<times.zones.count() && i<into.count(); i++) into[i] += times.zones[i];
+}
+
+// zero, I, II and III
+static void addPolarized(QVector<float> &into, const ZoneTimes &times)
+{
+    for (int i=0; i<4 && i<into.count(); i++) into[i] += times.cp[i];
+}
+
 void
 RideFileCache::computeDistribution(QVector<float> &array, RideFile::SeriesType series)
 {
@@ -1569,28 +1126,16 @@ RideFileCache::computeDistribution(QVector<float> &array, RideFile::SeriesType s
     int paceZoneRange = context->athlete->paceZones(ride->isSwim()) ? context->athlete->paceZones(ride->isSwim())->whichRange(ride->startTime().date()) : -1;
 
     CP=0;
-    int AeTP=0;
-    if (zoneRange != -1) {
-        CP=context->athlete->zones(ride->sport())->getCP(zoneRange);
-        AeTP=context->athlete->zones(ride->sport())->getAeT(zoneRange);
-    }
+    if (zoneRange != -1) CP=context->athlete->zones(ride->sport())->getCP(zoneRange);
 
     if (zoneRange != -1) WPRIME=context->athlete->zones(ride->sport())->getWprime(zoneRange);
     else WPRIME=0;
 
     LTHR=0;
-    int AeTHR=0;
-    if (hrZoneRange != -1) {
-        LTHR=context->athlete->hrZones(ride->sport())->getLT(hrZoneRange);
-        AeTHR=context->athlete->hrZones(ride->sport())->getAeT(hrZoneRange);
-    }
+    if (hrZoneRange != -1) LTHR=context->athlete->hrZones(ride->sport())->getLT(hrZoneRange);
 
     CV=0;
-    double AeTV=0;
-    if (paceZoneRange != -1) {
-        CV=context->athlete->paceZones(ride->isSwim())->getCV(paceZoneRange);
-        AeTV=context->athlete->paceZones(ride->isSwim())->getAeT(paceZoneRange);
-    }
+    if (paceZoneRange != -1) CV=context->athlete->paceZones(ride->isSwim())->getCV(paceZoneRange);
 
     // setup the array based upon the ride
     int decimals = decimalsFor(series); //RideFile::decimalsFor(series) ? 1 : 0;
@@ -1630,70 +1175,47 @@ RideFileCache::computeDistribution(QVector<float> &array, RideFile::SeriesType s
 
     } else {
 
-        foreach(RideFilePoint *dp, ride->dataPoints()) {
-            double value = dp->value(baseSeries);
+        RideFileColumnsPtr columns = ride->columns(QList<RideFile::SeriesType>() << baseSeries);
+        for (int j=0; j<columns->count(); j++) {
+            RideFileSample dp = columns->sample(j);
+            double value = dp.value(baseSeries);
             if (series == RideFile::wattsKg || series == RideFile::aPowerKg) {
                 value /= ride->getWeight();
             }
 
             float lvalue = value * pow(10, decimals);
 
-            // watts time in zone
-            if (series == RideFile::watts && zoneRange != -1) {
-                int index = context->athlete->zones(ride->sport())->whichZone(zoneRange, dp->value(series));
-                if (index >=0) wattsTimeInZone[index] += ride->recIntSecs();
-            }
+            int offset = lvalue - min;
+            if (offset >= 0 && offset < array.size()) array[offset] += ride->recIntSecs();
+        }
+
+        // time in zone, all the zones and polarized zones are classified in a
+        // single pass, when refreshing a ride it is the same classification
+        // the metrics use since RideItem::refresh installs one ZoneEngine
+        if (series == RideFile::watts && zoneRange != -1) {
+            ZoneTimes times = ZoneEngine::timesFor(ride, Specification(), series, ZoneEngine::bounds(context->athlete->zones(ride->sport()), zoneRange));
+            addTimeInZone(wattsTimeInZone, times);
 
             // Polarized zones :- I(<AeTP), II (<CP and >0.85*CP), III (>CP)
-            if (series == RideFile::watts && zoneRange != -1 && CP) {
-                if (dp->value(series) < 1) // I zero watts
-                    wattsCPTimeInZone[0] += ride->recIntSecs();
-                else if (dp->value(series) < AeTP) // I
-                    wattsCPTimeInZone[1] += ride->recIntSecs();
-                else if (dp->value(series) < CP) // II
-                    wattsCPTimeInZone[2] += ride->recIntSecs();
-                else // III
-                    wattsCPTimeInZone[3] += ride->recIntSecs();
-            }
+            if (CP) addPolarized(wattsCPTimeInZone, times);
+        }
 
-            // hr time in zone
-            if (series == RideFile::hr && hrZoneRange != -1) {
-                int index = context->athlete->hrZones(ride->sport())->whichZone(hrZoneRange, dp->value(series));
-                if (index >= 0) hrTimeInZone[index] += ride->recIntSecs();
-            }
+        // hr time in zone
+        if (series == RideFile::hr && hrZoneRange != -1) {
+            ZoneTimes times = ZoneEngine::timesFor(ride, Specification(), series, ZoneEngine::bounds(context->athlete->hrZones(ride->sport()), hrZoneRange));
+            addTimeInZone(hrTimeInZone, times);
 
             // Polarized zones :- I(<AeTHR), II (<LTHR and >0.9*LTHR), III (>LTHR)
-            if (series == RideFile::hr && hrZoneRange != -1 && LTHR) {
-                if (dp->value(series) < 1) // I zero
-                    hrCPTimeInZone[0] += ride->recIntSecs();
-                else if (dp->value(series) < AeTHR) // I
-                    hrCPTimeInZone[1] += ride->recIntSecs();
-                else if (dp->value(series) < LTHR) // II
-                    hrCPTimeInZone[2] += ride->recIntSecs();
-                else // III
-                    hrCPTimeInZone[3] += ride->recIntSecs();
-            }
+            if (LTHR) addPolarized(hrCPTimeInZone, times);
+        }
 
-            // pace time in zone, only for running and swimming activities
-            if (series == RideFile::kph && paceZoneRange != -1 && (ride->isRun() || ride->isSwim())) {
-                int index = context->athlete->paceZones(ride->isSwim())->whichZone(paceZoneRange, dp->value(series));
-                if (index >= 0) paceTimeInZone[index] += ride->recIntSecs();
-            }
+        // pace time in zone, only for running and swimming activities
+        if (series == RideFile::kph && paceZoneRange != -1 && (ride->isRun() || ride->isSwim())) {
+            ZoneTimes times = ZoneEngine::timesFor(ride, Specification(), series, ZoneEngine::bounds(context->athlete->paceZones(ride->isSwim()), paceZoneRange));
+            addTimeInZone(paceTimeInZone, times);
 
             // Polarized Pace Zones: I(<AeTV), II (>=AeTV and <CV), III (>=CV)
-            if (series == RideFile::kph && paceZoneRange != -1 && CV && (ride->isRun() || ride->isSwim())) {
-                if (dp->value(series) < 0.1) // I zero
-                    paceCPTimeInZone[0] += ride->recIntSecs();
-                else if (dp->value(series) < AeTV) // I
-                    paceCPTimeInZone[1] += ride->recIntSecs();
-                else if (dp->value(series) < CV) // II
-                    paceCPTimeInZone[2] += ride->recIntSecs();
-                else // III
-                    paceCPTimeInZone[3] += ride->recIntSecs();
-            }
-
-            int offset = lvalue - min;
-            if (offset >= 0 && offset < array.size()) array[offset] += ride->recIntSecs();
+            if (CV) addPolarized(paceCPTimeInZone, times);
         }
     }
 }
@@ -1717,6 +1239,22 @@ static void meanMaxAggregate(QVector<double> &into, QVector<double> &other, QVec
         }
 }
 
+// as above, but from another aggregate. when the same best was found in
+// both we keep the earliest date, as if the rides were aggregated in order
+static void meanMaxAggregate(QVector<double> &into, QVector<double> &other, QVector<QDate>&dates, QVector<QDate>&otherDates)
+{
+    if (into.size() < other.size()) {
+        into.resize(other.size());
+        dates.resize(other.size());
+    }
+
+    for (int i=0; i<other.size() && i<otherDates.size(); i++)
+        if (other[i] > into[i] || (other[i] == into[i] && other[i] > 0 && otherDates[i] < dates[i])) {
+            into[i] = other[i];
+            dates[i] = otherDates[i];
+        }
+}
+
 // resize into and then sum the arrays
 static void distAggregate(QVector<double> &into, QVector<double> &other)
 {
@@ -1725,29 +1263,39 @@ static void distAggregate(QVector<double> &into, QVector<double> &other)
 
 }
 
-RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filter, QStringList files, bool onhome, RideItem *rideItem)
-               : start(start), end(end), incomplete(false), context(context), rideFileName(""), ride(0)
+// the arrays we aggregate, in the order they are stored in the index
+void RideFileCache::aggregateArrays(QList<QVector<double>*> &meanmax, QList<QVector<QDate>*> &dates,
+                                    QList<QVector<double>*> &distributions, QList<QVector<float>*> &zones)
 {
+    meanmax << &wattsMeanMaxDouble << &hrMeanMaxDouble << &cadMeanMaxDouble << &nmMeanMaxDouble
+            << &kphMeanMaxDouble << &kphdMeanMaxDouble << &wattsdMeanMaxDouble << &caddMeanMaxDouble
+            << &nmdMeanMaxDouble << &hrdMeanMaxDouble << &xPowerMeanMaxDouble << &npMeanMaxDouble
+            << &vamMeanMaxDouble << &wattsKgMeanMaxDouble << &aPowerMeanMaxDouble << &aPowerKgMeanMaxDouble;
+
+    dates << &wattsMeanMaxDate << &hrMeanMaxDate << &cadMeanMaxDate << &nmMeanMaxDate
+          << &kphMeanMaxDate << &kphdMeanMaxDate << &wattsdMeanMaxDate << &caddMeanMaxDate
+          << &nmdMeanMaxDate << &hrdMeanMaxDate << &xPowerMeanMaxDate << &npMeanMaxDate
+          << &vamMeanMaxDate << &wattsKgMeanMaxDate << &aPowerMeanMaxDate << &aPowerKgMeanMaxDate;
+
+    distributions << &wattsDistributionDouble << &hrDistributionDouble << &cadDistributionDouble
+                  << &gearDistributionDouble << &nmDistributionDouble << &kphDistributionDouble
+                  << &xPowerDistributionDouble << &npDistributionDouble << &wattsKgDistributionDouble
+                  << &aPowerDistributionDouble << &smo2DistributionDouble << &wbalDistributionDouble;
+
+    zones << &paceTimeInZone << &hrTimeInZone << &wattsTimeInZone
+          << &paceCPTimeInZone << &hrCPTimeInZone << &wattsCPTimeInZone << &wbalTimeInZone;
+}
 
-    // remember parameters for getting heat
-    this->filter = filter;
-    this->files = files;
-    this->onhome = onhome;
-
-    // Oh lets get from the cache if we can -- but not if filtered
-    if (!filter && !context->isfiltered && !rideItem) {
-
-        // oh and not if we're onhome and homefiltered
-        if ((onhome && !context->ishomefiltered) || !onhome) {
-            foreach(RideFileCache *p, context->athlete->cpxCache) {
-                if (p->start == start && p->end == end) {
-                    *this = *p;
-                    return;
-                }
-            }
-        }
-    }
+// an empty aggregate
+RideFileCache::RideFileCache(Context *context)
+               : incomplete(false), context(context), rideFileName(""), ride(0),
+                 filter(false), onhome(false)
+{
+    resetAggregate();
+}
 
+void RideFileCache::resetAggregate()
+{
     // resize all the arrays to zero - expand as neccessary
     xPowerMeanMax.resize(0);
     npMeanMax.resize(0);
@@ -1788,76 +1336,189 @@ RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filt
     paceTimeInZone.resize(10);
     paceCPTimeInZone.resize(4);
     wbalTimeInZone.resize(4);
+}
+
+void RideFileCache::aggregate(RideFileCache &rideCache, QDate rideDate)
+{
+    // lets aggregate
+    meanMaxAggregate(wattsMeanMaxDouble, rideCache.wattsMeanMaxDouble, wattsMeanMaxDate, rideDate);
+    meanMaxAggregate(hrMeanMaxDouble, rideCache.hrMeanMaxDouble, hrMeanMaxDate, rideDate);
+    meanMaxAggregate(cadMeanMaxDouble, rideCache.cadMeanMaxDouble, cadMeanMaxDate, rideDate);
+    meanMaxAggregate(nmMeanMaxDouble, rideCache.nmMeanMaxDouble, nmMeanMaxDate, rideDate);
+    meanMaxAggregate(kphMeanMaxDouble, rideCache.kphMeanMaxDouble, kphMeanMaxDate, rideDate);
+    meanMaxAggregate(kphdMeanMaxDouble, rideCache.kphdMeanMaxDouble, kphdMeanMaxDate, rideDate);
+    meanMaxAggregate(wattsdMeanMaxDouble, rideCache.wattsdMeanMaxDouble, wattsdMeanMaxDate, rideDate);
+    meanMaxAggregate(caddMeanMaxDouble, rideCache.caddMeanMaxDouble, caddMeanMaxDate, rideDate);
+    meanMaxAggregate(nmdMeanMaxDouble, rideCache.nmdMeanMaxDouble, nmdMeanMaxDate, rideDate);
+    meanMaxAggregate(hrdMeanMaxDouble, rideCache.hrdMeanMaxDouble, hrdMeanMaxDate, rideDate);
+    meanMaxAggregate(xPowerMeanMaxDouble, rideCache.xPowerMeanMaxDouble, xPowerMeanMaxDate, rideDate);
+    meanMaxAggregate(npMeanMaxDouble, rideCache.npMeanMaxDouble, npMeanMaxDate, rideDate);
+    meanMaxAggregate(vamMeanMaxDouble, rideCache.vamMeanMaxDouble, vamMeanMaxDate, rideDate);
+    meanMaxAggregate(wattsKgMeanMaxDouble, rideCache.wattsKgMeanMaxDouble, wattsKgMeanMaxDate, rideDate);
+    meanMaxAggregate(aPowerMeanMaxDouble, rideCache.aPowerMeanMaxDouble, aPowerMeanMaxDate, rideDate);
+    meanMaxAggregate(aPowerKgMeanMaxDouble, rideCache.aPowerKgMeanMaxDouble, aPowerKgMeanMaxDate, rideDate);
+
+    distAggregate(wattsDistributionDouble, rideCache.wattsDistributionDouble);
+    distAggregate(hrDistributionDouble, rideCache.hrDistributionDouble);
+    distAggregate(cadDistributionDouble, rideCache.cadDistributionDouble);
+    distAggregate(gearDistributionDouble, rideCache.gearDistributionDouble);
+    distAggregate(nmDistributionDouble, rideCache.nmDistributionDouble);
+    distAggregate(kphDistributionDouble, rideCache.kphDistributionDouble);
+    distAggregate(xPowerDistributionDouble, rideCache.xPowerDistributionDouble);
+    distAggregate(npDistributionDouble, rideCache.npDistributionDouble);
+    distAggregate(wattsKgDistributionDouble, rideCache.wattsKgDistributionDouble);
+    distAggregate(aPowerDistributionDouble, rideCache.aPowerDistributionDouble);
+    distAggregate(smo2DistributionDouble, rideCache.smo2DistributionDouble);
+    distAggregate(wbalDistributionDouble, rideCache.wbalDistributionDouble);
+
+    // cumulate timeinzones
+    for (int i=0; i<10; i++) {
+        paceTimeInZone[i] += rideCache.paceTimeInZone[i];
+        hrTimeInZone[i] += rideCache.hrTimeInZone[i];
+        wattsTimeInZone[i] += rideCache.wattsTimeInZone[i];
+        if (i<4) {
+            paceCPTimeInZone[i] += rideCache.paceCPTimeInZone[i];
+            hrCPTimeInZone[i] += rideCache.hrCPTimeInZone[i];
+            wattsCPTimeInZone[i] += rideCache.wattsCPTimeInZone[i];
+            wbalTimeInZone[i] += rideCache.wbalTimeInZone[i];
+        }
+    }
+}
+
+void RideFileCache::aggregate(RideFileCache &other)
+{
+    QList<QVector<double>*> meanmax, othermeanmax, distributions, otherdistributions;
+    QList<QVector<QDate>*> dates, otherdates;
+    QList<QVector<float>*> zones, otherzones;
+
+    aggregateArrays(meanmax, dates, distributions, zones);
+    other.aggregateArrays(othermeanmax, otherdates, otherdistributions, otherzones);
+
+    for (int i=0; i<meanmax.count(); i++)
+        meanMaxAggregate(*meanmax[i], *othermeanmax[i], *dates[i], *otherdates[i]);
+
+    for (int i=0; i<distributions.count(); i++)
+        distAggregate(*distributions[i], *otherdistributions[i]);
+
+    for (int i=0; i<zones.count(); i++)
+        for (int j=0; j<zones[i]->count() && j<otherzones[i]->count(); j++)
+            (*zones[i])[j] += (*otherzones[i])[j];
+
+    if (other.incomplete) incomplete = true;
+}
+
+// the index stores dates as runs, since a best is often
+// from the same date for lots of durations
+void RideFileCache::writeAggregate(QDataStream &out)
+{
+    QList<QVector<double>*> meanmax, distributions;
+    QList<QVector<QDate>*> dates;
+    QList<QVector<float>*> zones;
+    aggregateArrays(meanmax, dates, distributions, zones);
+
+    for (int i=0; i<meanmax.count(); i++) {
+        out << *meanmax[i];
+
+        QVector<QDate> &d = *dates[i];
+        QVector<qint64> runs;
+        for (int j=0; j<d.count(); ) {
+            int k=j;
+            while (k < d.count() && d[k] == d[j]) k++;
+            runs << d[j].toJulianDay() << qint64(k-j);
+            j = k;
+        }
+        out << runs;
+    }
+    for (int i=0; i<distributions.count(); i++) out << *distributions[i];
+    for (int i=0; i<zones.count(); i++) out << *zones[i];
+}
+
+bool RideFileCache::readAggregate(QDataStream &in)
+{
+    QList<QVector<double>*> meanmax, distributions;
+    QList<QVector<QDate>*> dates;
+    QList<QVector<float>*> zones;
+    aggregateArrays(meanmax, dates, distributions, zones);
+
+    for (int i=0; i<meanmax.count(); i++) {
+        in >> *meanmax[i];
+
+        QVector<qint64> runs;
+        in >> runs;
+        QVector<QDate> &d = *dates[i];
+        d.clear();
+        for (int j=0; j+1<runs.count(); j += 2)
+            for (qint64 k=0; k<runs[j+1]; k++) d << QDate::fromJulianDay(runs[j]);
+        if (d.count() != meanmax[i]->count()) return false;
+    }
+    for (int i=0; i<distributions.count(); i++) in >> *distributions[i];
+    for (int i=0; i<zones.count(); i++) in >> *zones[i];
+
+    return in.status() == QDataStream::Ok;
+}
+
+RideFileCache::RideFileCache(Context *context, QDate start, QDate end, bool filter, QStringList files, bool onhome, RideItem *rideItem)
+               : start(start), end(end), incomplete(false), context(context), rideFileName(""), ride(0)
+{
+
+    // remember parameters for getting heat
+    this->filter = filter;
+    this->files = files;
+    this->onhome = onhome;
+
+    // Oh lets get from the cache if we can -- but not if filtered
+    if (!filter && !context->isfiltered && !rideItem) {
+
+        // oh and not if we're onhome and homefiltered
+        if ((onhome && !context->ishomefiltered) || !onhome) {
+            foreach(RideFileCache *p, context->athlete->cpxCache) {
+                if (p->start == start && p->end == end) {
+                    *this = *p;
+                    return;
+                }
+            }
+        }
+    }
+
+    // resize all the arrays to zero - expand as neccessary
+    resetAggregate();
 
     // set cursor busy whilst we aggregate -- bit of feedback
     // and less intrusive than a popup box
     context->mainWindow->setCursor(Qt::WaitCursor);
 
-    // Iterate over the ride files (not the cpx files since they /might/ not
-    // exist, or /might/ be out of date.
-    foreach (RideItem *item, context->athlete->rideCache->rides()) {
+    // when there is no filtering we can use the pre-aggregated weeks, months
+    // and years from the index, the sport is just a filter on the index
+    if (!filter && !context->isfiltered && (!onhome || !context->ishomefiltered)) {
 
-        QDate rideDate = item->dateTime.date();
+        if (!context->athlete->meanmaxIndex->aggregate(*this, start, end, rideItem ? rideItem->sport : QString()))
+            incomplete = true;
 
-        if (((filter == true && files.contains(item->fileName)) || filter == false) &&
-            rideDate >= start && rideDate <= end) {
+    } else {
 
-            // skip globally filtered values
-            if (context->isfiltered && !context->filters.contains(item->fileName)) continue;
-            if (onhome && context->ishomefiltered && !context->homeFilters.contains(item->fileName)) continue;
-            // skip other sports if rideItem is given
-            if (rideItem && (rideItem->sport != item->sport)) continue;
-
-            // get its cached values (will NOT! refresh if needed...)
-            // the true means it will check only
-            RideFileCache rideCache(context, context->athlete->home->activities().canonicalPath() + "/" + item->fileName, item->getWeight(), NULL, false, false);
-            if (rideCache.incomplete == true) {
-                // ack, data not available !
-                incomplete = true;
-            } else {
-
-                // lets aggregate
-                meanMaxAggregate(wattsMeanMaxDouble, rideCache.wattsMeanMaxDouble, wattsMeanMaxDate, rideDate);
-                meanMaxAggregate(hrMeanMaxDouble, rideCache.hrMeanMaxDouble, hrMeanMaxDate, rideDate);
-                meanMaxAggregate(cadMeanMaxDouble, rideCache.cadMeanMaxDouble, cadMeanMaxDate, rideDate);
-                meanMaxAggregate(nmMeanMaxDouble, rideCache.nmMeanMaxDouble, nmMeanMaxDate, rideDate);
-                meanMaxAggregate(kphMeanMaxDouble, rideCache.kphMeanMaxDouble, kphMeanMaxDate, rideDate);
-                meanMaxAggregate(kphdMeanMaxDouble, rideCache.kphdMeanMaxDouble, kphdMeanMaxDate, rideDate);
-                meanMaxAggregate(wattsdMeanMaxDouble, rideCache.wattsdMeanMaxDouble, wattsdMeanMaxDate, rideDate);
-                meanMaxAggregate(caddMeanMaxDouble, rideCache.caddMeanMaxDouble, caddMeanMaxDate, rideDate);
-                meanMaxAggregate(nmdMeanMaxDouble, rideCache.nmdMeanMaxDouble, nmdMeanMaxDate, rideDate);
-                meanMaxAggregate(hrdMeanMaxDouble, rideCache.hrdMeanMaxDouble, hrdMeanMaxDate, rideDate);
-                meanMaxAggregate(xPowerMeanMaxDouble, rideCache.xPowerMeanMaxDouble, xPowerMeanMaxDate, rideDate);
-                meanMaxAggregate(npMeanMaxDouble, rideCache.npMeanMaxDouble, npMeanMaxDate, rideDate);
-                meanMaxAggregate(vamMeanMaxDouble, rideCache.vamMeanMaxDouble, vamMeanMaxDate, rideDate);
-                meanMaxAggregate(wattsKgMeanMaxDouble, rideCache.wattsKgMeanMaxDouble, wattsKgMeanMaxDate, rideDate);
-                meanMaxAggregate(aPowerMeanMaxDouble, rideCache.aPowerMeanMaxDouble, aPowerMeanMaxDate, rideDate);
-                meanMaxAggregate(aPowerKgMeanMaxDouble, rideCache.aPowerKgMeanMaxDouble, aPowerKgMeanMaxDate, rideDate);
-
-                distAggregate(wattsDistributionDouble, rideCache.wattsDistributionDouble);
-                distAggregate(hrDistributionDouble, rideCache.hrDistributionDouble);
-                distAggregate(cadDistributionDouble, rideCache.cadDistributionDouble);
-                distAggregate(gearDistributionDouble, rideCache.gearDistributionDouble);
-                distAggregate(nmDistributionDouble, rideCache.nmDistributionDouble);
-                distAggregate(kphDistributionDouble, rideCache.kphDistributionDouble);
-                distAggregate(xPowerDistributionDouble, rideCache.xPowerDistributionDouble);
-                distAggregate(npDistributionDouble, rideCache.npDistributionDouble);
-                distAggregate(wattsKgDistributionDouble, rideCache.wattsKgDistributionDouble);
-                distAggregate(aPowerDistributionDouble, rideCache.aPowerDistributionDouble);
-                distAggregate(smo2DistributionDouble, rideCache.smo2DistributionDouble);
-                distAggregate(wbalDistributionDouble, rideCache.wbalDistributionDouble);
-
-                // cumulate timeinzones
-                for (int i=0; i<10; i++) {
-                    paceTimeInZone[i] += rideCache.paceTimeInZone[i];
-                    hrTimeInZone[i] += rideCache.hrTimeInZone[i];
-                    wattsTimeInZone[i] += rideCache.wattsTimeInZone[i];
-                    if (i<4) {
-                        paceCPTimeInZone[i] += rideCache.paceCPTimeInZone[i];
-                        hrCPTimeInZone[i] += rideCache.hrCPTimeInZone[i];
-                        wattsCPTimeInZone[i] += rideCache.wattsCPTimeInZone[i];
-                        wbalTimeInZone[i] += rideCache.wbalTimeInZone[i];
-                    }
+        // Iterate over the ride files (not the cpx files since they /might/ not
+        // exist, or /might/ be out of date.
+        foreach (RideItem *item, context->athlete->rideCache->rides()) {
+
+            QDate rideDate = item->dateTime.date();
+
+            if (((filter == true && files.contains(item->fileName)) || filter == false) &&
+                rideDate >= start && rideDate <= end) {
+
+                // skip globally filtered values
+                if (context->isfiltered && !context->filters.contains(item->fileName)) continue;
+                if (onhome && context->ishomefiltered && !context->homeFilters.contains(item->fileName)) continue;
+                // skip other sports if rideItem is given
+                if (rideItem && (rideItem->sport != item->sport)) continue;
+
+                // get its cached values (will NOT! refresh if needed...)
+                // the true means it will check only
+                RideFileCache rideCache(context, context->athlete->home->activities().canonicalPath() + "/" + item->fileName, item->getWeight(), NULL, false, false);
+                if (rideCache.incomplete == true) {
+                    // ack, data not available !
+                    incomplete = true;
+                } else {
+                    aggregate(rideCache, rideDate);
                 }
             }
         }
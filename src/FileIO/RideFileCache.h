@@ -170,7 +170,8 @@ class RideFileCache
         static bool checkStale(Context *context, RideItem*item);
 
         // Just get mean max values for power & wpk for a ride
-        static QVector<float> meanMaxPowerFor(Context *context, QVector<float>&wpk, QDate from, QDate to, QVector<QDate> *dates, QString sport="Bike");
+        // complete is set false if data for any of the rides was not available
+        static QVector<float> meanMaxPowerFor(Context *context, QVector<float>&wpk, QDate from, QDate to, QVector<QDate> *dates, QString sport="Bike", bool *complete=NULL);
         static QVector<float> meanMaxPowerFor(Context *context, QVector<float>&wpk, QString filename);
 
         // Fast standalone search reads input and outputs into ride_bests
@@ -241,6 +242,18 @@ class RideFileCache
         //void computeMeanMax(QVector<float>&, RideFile::SeriesType);      // compute mean max arrays
         void computeDistribution(QVector<float>&, RideFile::SeriesType); // compute the distributions
 
+        // aggregating for a date range, MeanMaxIndex keeps these for weeks,
+        // months and years so we don't need to read every .cpx file
+        friend class MeanMaxIndex;
+        RideFileCache(Context *context);        // an empty aggregate
+        void resetAggregate();                  // clear the aggregated arrays
+        void aggregate(RideFileCache &ride, QDate rideDate); // add a single ride
+        void aggregate(RideFileCache &other);   // add another aggregate, earliest date wins a tie
+        void writeAggregate(QDataStream &out);
+        bool readAggregate(QDataStream &in);
+        void aggregateArrays(QList<QVector<double>*> &meanmax, QList<QVector<QDate>*> &dates,
+                             QList<QVector<double>*> &distributions, QList<QVector<float>*> &zones);
+
 
     private:
 
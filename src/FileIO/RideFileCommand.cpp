@@ -19,15 +19,10 @@
 #include "RideFile.h"
 #include "RideFileCommand.h"
 #include "RideEditor.h"
+#include "RideFileRows.h"
 #include <cmath>
 #include <float.h>
 
-// comparing doubles is nasty
-static bool doubles_equal(double a, double b)
-{
-    double errorB = b * DBL_EPSILON;
-    return (a >= b - errorB) && (a <= b + errorB);
-}
 //----------------------------------------------------------------------
 // The public interface to the commands
 //----------------------------------------------------------------------
@@ -89,6 +84,33 @@ RideFileCommand::insertPoint(int index, RideFilePoint *points)
     doCommand(cmd);
 }
 
+void
+RideFileCommand::setPointValues(int index, RideFile::SeriesType series, QVector<double> values)
+{
+    // we only keep the values that change
+    QVector<int> rows;
+    QVector<double> oldvalues, newvalues;
+    RideFileRows::changes(index, values, [this, series](int row) { return ride->getPointValue(row, series); },
+                          rows, oldvalues, newvalues);
+    if (rows.isEmpty()) return;
+
+    SetPointValuesCommand *cmd = new SetPointValuesCommand(ride, series, rows, oldvalues, newvalues);
+    doCommand(cmd);
+}
+
+void
+RideFileCommand::insertPoints(QVector<int> rows, QVector<RideFilePoint> points)
+{
+    if (rows.isEmpty()) return;
+
+    // rows past the end or out of order can't be undone, so never do them
+    Q_ASSERT(rows.count() == points.count() && RideFileRows::valid(rows, ride->dataPoints().count() + points.count()));
+    if (rows.count() != points.count() || !RideFileRows::valid(rows, ride->dataPoints().count() + points.count())) return;
+
+    InsertPointsCommand *cmd = new InsertPointsCommand(ride, rows, points);
+    doCommand(cmd);
+}
+
 void
 RideFileCommand::insertXDataPoint(QString xdata, int index, XDataPoint *points)
 {
@@ -348,7 +370,7 @@ bool
 SetPointValueCommand::doCommand()
 {
     // check it has changed first!
-    if (!doubles_equal(oldvalue, newvalue)) {
+    if (!RideFileRows::equal(oldvalue, newvalue)) {
         ride->setPointValue(row,series,newvalue);
     }
     return true;
@@ -357,12 +379,36 @@ SetPointValueCommand::doCommand()
 bool
 SetPointValueCommand::undoCommand()
 {
-    if (!doubles_equal(oldvalue, newvalue)) {
+    if (!RideFileRows::equal(oldvalue, newvalue)) {
         ride->setPointValue(row,series,oldvalue);
     }
     return true;
 }
 
+// Set a series across many points
+SetPointValuesCommand::SetPointValuesCommand(RideFile *ride, RideFile::SeriesType series, QVector<int> rows,
+            QVector<double> oldvalues, QVector<double> newvalues) :
+            RideCommand(ride), // base class looks after these
+            series(series), rows(rows), oldvalues(oldvalues), newvalues(newvalues)
+{
+    type = RideCommand::SetPointValues;
+    description = tr("Set Values");
+}
+
+bool
+SetPointValuesCommand::doCommand()
+{
+    ride->setPointValues(series, rows, newvalues);
+    return true;
+}
+
+bool
+SetPointValuesCommand::undoCommand()
+{
+    ride->setPointValues(series, rows, oldvalues);
+    return true;
+}
+
 // Remove a point
 DeletePointCommand::DeletePointCommand(RideFile *ride, int row, RideFilePoint point) :
         RideCommand(ride), // base class looks after these
@@ -433,6 +479,31 @@ InsertPointCommand::undoCommand()
     return true;
 }
 
+// Insert points, wherever they go
+InsertPointsCommand::InsertPointsCommand(RideFile *ride, QVector<int> rows, QVector<RideFilePoint> points) :
+        RideCommand(ride), // base class looks after these
+        rows(rows), points(points)
+{
+    type = RideCommand::InsertPoints;
+    description = tr("Insert Points");
+}
+
+bool
+InsertPointsCommand::doCommand()
+{
+    QVector<RideFilePoint *> newPoints(points.count());
+    for (int i=0; i<points.count(); i++) newPoints[i] = new RideFilePoint(points[i]);
+    ride->insertPoints(rows, newPoints);
+    return true;
+}
+
+bool
+InsertPointsCommand::undoCommand()
+{
+    ride->deletePoints(rows);
+    return true;
+}
+
 // Append points
 AppendPointsCommand::AppendPointsCommand(RideFile *ride, int row, QVector<RideFilePoint> points) :
         RideCommand(ride), // base class looks after these
@@ -635,7 +706,7 @@ bool
 SetXDataPointValueCommand::doCommand()
 {
     XDataSeries *series = ride->xdata(xdata);
-    if (series && !doubles_equal(oldvalue, newvalue)) {
+    if (series && !RideFileRows::equal(oldvalue, newvalue)) {
         switch(col){
         case 0:
             series->datapoints[row]->secs = newvalue;
@@ -653,7 +724,7 @@ bool
 SetXDataPointValueCommand::undoCommand()
 {
     XDataSeries *series = ride->xdata(xdata);
-    if (series && !doubles_equal(oldvalue, newvalue)) {
+    if (series && !RideFileRows::equal(oldvalue, newvalue)) {
         switch(col){
         case 0:
             series->datapoints[row]->secs = oldvalue;
@@ -52,6 +52,13 @@ class RideFileCommand : public QObject
         void deletePoint(int index);
         void deletePoints(int index, int count);
         void insertPoint(int index, RideFilePoint *point);
+
+        // bulk changes as a single command, rather than a command per point
+        // setPointValues replaces the series from index with values and
+        // insertPoints puts each point at the row it has once they are all
+        // inserted, rows must be in ascending order
+        void setPointValues(int index, RideFile::SeriesType series, QVector<double> values);
+        void insertPoints(QVector<int> rows, QVector<RideFilePoint> points);
         void appendPoints(QVector <struct RideFilePoint> newRows);
         void setDataPresent(RideFile::SeriesType, bool);
 
@@ -106,7 +113,8 @@ class RideCommand
         // supported command types
         enum commandtype { NoOp, LUW, SetPointValue, DeletePoint, DeletePoints, InsertPoint, AppendPoints, SetDataPresent,
                            removeXData, addXData, RemoveXDataSeries, AddXDataSeries,
-                           SetXDataPointValue, DeleteXDataPoints, InsertXDataPoint, AppendXDataPoints };
+                           SetXDataPointValue, DeleteXDataPoints, InsertXDataPoint, AppendXDataPoints,
+                           SetPointValues, InsertPoints };
         typedef enum commandtype CommandType;
 
 
@@ -209,6 +217,22 @@ class SetPointValueCommand : public RideCommand
         double oldvalue, newvalue;
 };
 
+class SetPointValuesCommand : public RideCommand
+{
+    Q_DECLARE_TR_FUNCTIONS(SetPointValuesCommand)
+
+    public:
+        SetPointValuesCommand(RideFile *ride, RideFile::SeriesType series, QVector<int> rows,
+                              QVector<double> oldvalues, QVector<double> newvalues);
+        bool doCommand();
+        bool undoCommand();
+
+        // state, only the rows that changed
+        RideFile::SeriesType series;
+        QVector<int> rows;
+        QVector<double> oldvalues, newvalues;
+};
+
 class SetXDataPointValueCommand : public RideCommand
 {
     Q_DECLARE_TR_FUNCTIONS(SetXDataPointValueCommand)
@@ -282,6 +306,22 @@ class InsertPointCommand : public RideCommand
         int row;
         RideFilePoint point;
 };
+class InsertPointsCommand : public RideCommand
+{
+    Q_DECLARE_TR_FUNCTIONS(InsertPointsCommand)
+
+    public:
+        InsertPointsCommand(RideFile *ride, QVector<int> rows, QVector<RideFilePoint> points);
+        bool doCommand();
+        bool undoCommand();
+
+        // is it one block of rows?
+        bool contiguous() const { return rows.count() && rows.last() - rows.first() + 1 == rows.count(); }
+
+        // state, the row each point ends up at, ascending
+        QVector<int> rows;
+        QVector<RideFilePoint> points;
+};
 class InsertXDataPointCommand : public RideCommand
 {
     Q_DECLARE_TR_FUNCTIONS(InsertXDataPointCommand)
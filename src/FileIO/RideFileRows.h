@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RideFileRows_h
+#define _GC_RideFileRows_h 1
+
+#include <QVector>
+#include <float.h>
+
+//
+// The passes behind the bulk RideFileCommands, insertPoints and
+// setPointValues, and their undo.
+//
+// Rows are where each item is once they are all inserted, so they must be
+// strictly ascending and inside the vector they end up in; anything else is
+// rejected rather than guessed at. Inserting then removing the same rows
+// leaves the vector as it was, which is what undo and redo rely upon.
+//
+class RideFileRows
+{
+    public:
+
+        // strictly ascending and all in 0..count-1
+        static bool valid(const QVector<int> &rows, int count) {
+            for (int i=0; i<rows.count(); i++) {
+                if (rows[i] < 0 || rows[i] >= count) return false;
+                if (i && rows[i] <= rows[i-1]) return false;
+            }
+            return true;
+        }
+
+        // items go in at rows, the rest keep their order and are moved once
+        template<class T>
+        static bool insert(QVector<T> &into, const QVector<int> &rows, const QVector<T> &items) {
+            if (rows.count() != items.count() || !valid(rows, into.count() + items.count())) return false;
+
+            QVector<T> merged(into.count() + items.count());
+            int from=0, next=0;
+            for (int i=0; i<merged.count(); i++) {
+                if (next < rows.count() && rows[next] == i) merged[i] = items[next++];
+                else merged[i] = into[from++];
+            }
+            into.swap(merged);
+            return true;
+        }
+
+        // the reverse of insert, the items removed are returned in removed
+        template<class T>
+        static bool remove(QVector<T> &from, const QVector<int> &rows, QVector<T> &removed) {
+            if (!valid(rows, from.count())) return false;
+
+            removed.clear();
+            removed.reserve(rows.count());
+            int to=0, next=0;
+            for (int i=0; i<from.count(); i++) {
+                if (next < rows.count() && rows[next] == i) {
+                    removed << from[i];
+                    next++;
+                } else {
+                    from[to++] = from[i];
+                }
+            }
+            from.resize(to);
+            return true;
+        }
+
+        // the same to within rounding
+        static bool equal(double a, double b) {
+            double errorB = b * DBL_EPSILON;
+            return (a >= b - errorB) && (a <= b + errorB);
+        }
+
+        // the rows from index whose current value changes to the one in values,
+        // with the old and new value for each, so they can be replayed both ways
+        template<class Current>
+        static void changes(int index, const QVector<double> &values, Current current,
+                            QVector<int> &rows, QVector<double> &oldvalues, QVector<double> &newvalues) {
+            for (int i=0; i<values.count(); i++) {
+                double was = current(index+i);
+                if (!equal(was, values[i])) {
+                    rows << index+i;
+                    oldvalues << was;
+                    newvalues << values[i];
+                }
+            }
+        }
+};
+#endif // _GC_RideFileRows_h
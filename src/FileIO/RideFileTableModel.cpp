@@ -295,10 +295,9 @@ RideFileTableModel::insertRows(int row, int count, const QModelIndex &)
 {
     if (row >= ride->dataPoints().count()) return false;
     else {
-        while (count--) {
-            struct RideFilePoint *p = new RideFilePoint;
-            ride->command->insertPoint(row, p);
-        }
+        QVector<int> rows(count);
+        for (int i=0; i<count; i++) rows[i] = row+i;
+        ride->command->insertPoints(rows, QVector<RideFilePoint>(count));
         return true;
     }
 }
@@ -415,6 +414,16 @@ RideFileTableModel::beginCommand(bool undo, RideCommand *cmd)
             else beginRemoveRows(QModelIndex(), ap->row, ap->row + ap->count - 1);
             break;
         }
+
+        case RideCommand::InsertPoints:
+        {
+            // rows scattered through the ride are easier to reset
+            InsertPointsCommand *ip = (InsertPointsCommand *)cmd;
+            if (!ip->contiguous()) beginResetModel();
+            else if (!undo) beginInsertRows(QModelIndex(), ip->rows.first(), ip->rows.last());
+            else beginRemoveRows(QModelIndex(), ip->rows.first(), ip->rows.last());
+            break;
+        }
         default:
             break;
     }
@@ -432,6 +441,13 @@ RideFileTableModel::endCommand(bool undo, RideCommand *cmd)
             dataChanged(cell, cell);
             break;
         }
+        case RideCommand::SetPointValues:
+        {
+            SetPointValuesCommand *spv = (SetPointValuesCommand*)cmd;
+            int column = headingsType.indexOf(spv->series);
+            dataChanged(index(spv->rows.first(), column), index(spv->rows.last(), column));
+            break;
+        }
         case RideCommand::InsertPoint:
             if (!undo) endInsertRows();
             else endRemoveRows();
@@ -448,6 +464,12 @@ RideFileTableModel::endCommand(bool undo, RideCommand *cmd)
             else endInsertRows();
             break;
 
+        case RideCommand::InsertPoints:
+            if (!((InsertPointsCommand *)cmd)->contiguous()) endResetModel();
+            else if (!undo) endInsertRows();
+            else endRemoveRows();
+            break;
+
         case RideCommand::SetDataPresent:
             setHeadings();
             emit layoutChanged();
@@ -46,6 +46,7 @@ SolveCPDialog::SolveCPDialog(QWidget *parent, Context *context) : QDialog(parent
     // Widget creation
     //
     solver = new CPSolver(context);
+    solver->setChains(0); // all cores
 
     QFont bolden;
     bolden.setWeight(QFont::Bold);
@@ -210,13 +210,13 @@ static bool workoutTimeAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class TimeRecording : public RideMetric {
+class TimeRecording : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(TimeRecording)
-    double secsRecording;
+    double secsRecording, recIntSecs;
 
     public:
 
-    TimeRecording() : secsRecording(0.0)
+    TimeRecording() : secsRecording(0.0), recIntSecs(0.0)
     {
         setSymbol("time_recording");
         setInternalName("Time Recording");
@@ -231,20 +231,26 @@ class TimeRecording : public RideMetric {
         setDescription(tr("Time when device was recording, excludes gaps in recording due to pauses or missing samples"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         secsRecording = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        // loop through and count
-        for (RideFileIterator it(item->ride(), spec); it.hasNext(); it.next())
-            secsRecording += item->ride()->recIntSecs();
+    // count them all
+    void accumulate(const RideFilePoint *) {
+        secsRecording += recIntSecs;
+    }
+
+    void finalise() {
         setValue(secsRecording);
     }
 
@@ -258,13 +264,13 @@ static bool timeRecordingAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class TimeRiding : public RideMetric {
+class TimeRiding : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(TimeRiding)
-    double secsMovingOrPedaling;
+    double secsMovingOrPedaling, recIntSecs;
 
     public:
 
-    TimeRiding() : secsMovingOrPedaling(0.0)
+    TimeRiding() : secsMovingOrPedaling(0.0), recIntSecs(0.0)
     {
         setSymbol("time_riding");
         setInternalName("Time Moving");
@@ -279,28 +285,33 @@ class TimeRiding : public RideMetric {
         setDescription(tr("Time with speed or cadence different from zero"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         secsMovingOrPedaling = 0;
 
         // must have speed and cadence
-        if (item->ride()->areDataPresent()->kph || item->ride()->areDataPresent()->cad ) {
-
-            // loop through and count
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                if ((point->kph > 0.0) || (point->cad > 0.0))
-                    secsMovingOrPedaling += item->ride()->recIntSecs();
-            }
+        if (!item->ride()->areDataPresent()->kph && !item->ride()->areDataPresent()->cad) {
+            setValue(secsMovingOrPedaling);
+            return false;
         }
+
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if ((point->kph > 0.0) || (point->cad > 0.0))
+            secsMovingOrPedaling += recIntSecs;
+    }
+
+    void finalise() {
         setValue(secsMovingOrPedaling);
     }
 
@@ -314,14 +325,16 @@ static bool timeRidingAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class TimeCarrying : public RideMetric {
+class TimeCarrying : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(TimeCarrying)
     double secsCarrying;
     double prevalt;
+    double hysteresis, recIntSecs;
+    bool first;
 
     public:
 
-    TimeCarrying() : secsCarrying(0.0), prevalt(0.0)
+    TimeCarrying() : secsCarrying(0.0), prevalt(0.0), hysteresis(0.0), recIntSecs(0.0), first(true)
     {
         setSymbol("time_carrying");
         setInternalName("Time Carrying");
@@ -336,52 +349,56 @@ class TimeCarrying : public RideMetric {
         setDescription(tr("Time with low speed and elevation gain but no power nor cadence"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         secsCarrying = 0;
 
-        if (item->ride()->areDataPresent()->kph) {
+        if (!item->ride()->areDataPresent()->kph) {
+            setValue(secsCarrying);
+            return false;
+        }
 
-            // hysteresis can be configured, we default to 3.0
-            double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
-            if (hysteresis <= 0.1) hysteresis = 3.00;
+        // hysteresis can be configured, we default to 3.0
+        hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        if (hysteresis <= 0.1) hysteresis = 3.00;
 
-            RideFileIterator it(item->ride(), spec);
-            bool first = true;
+        recIntSecs = item->ride()->recIntSecs();
+        first = true;
+        return true;
+    }
 
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
+    void accumulate(const RideFilePoint *point) {
 
-                // only consider pushing/carrying with elevation gain
-                if (first) {
-                    first = false;
-                    prevalt = point->alt;
-                }
-                else if (point->alt > prevalt + hysteresis) {
-                    prevalt = point->alt;
-                }
-                else if (point->alt < prevalt - hysteresis) {
-                    prevalt = point->alt;
-                }
-
-                if ((point->kph > 0.0) &&          // we are moving
-                    (point->kph < 8.0) &&          // but slow (even slower than 8 kph)
-                    (point->alt > prevalt) &&  // gaining height
-                    (point->cad == 0.0) &&     // but no cadence
-                    (point->watts == 0.0))     // and no power
-
-                    secsCarrying += item->ride()->recIntSecs();
-            }
+        // only consider pushing/carrying with elevation gain
+        if (first) {
+            first = false;
+            prevalt = point->alt;
         }
-        setValue(secsCarrying);
+        else if (point->alt > prevalt + hysteresis) {
+            prevalt = point->alt;
+        }
+        else if (point->alt < prevalt - hysteresis) {
+            prevalt = point->alt;
+        }
+
+        if ((point->kph > 0.0) &&          // we are moving
+            (point->kph < 8.0) &&          // but slow (even slower than 8 kph)
+            (point->alt > prevalt) &&  // gaining height
+            (point->cad == 0.0) &&     // but no cadence
+            (point->watts == 0.0))     // and no power
+
+            secsCarrying += recIntSecs;
+    }
 
+    void finalise() {
+        setValue(secsCarrying);
     }
 
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
@@ -395,14 +412,16 @@ static bool timeCarryingAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class ElevationGainCarrying : public RideMetric {
+class ElevationGainCarrying : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(ElevationGain)
     double elegain;
     double prevalt;
+    double hysteresis;
+    bool first;
 
     public:
 
-    ElevationGainCarrying() : elegain(0.0), prevalt(0.0)
+    ElevationGainCarrying() : elegain(0.0), prevalt(0.0), hysteresis(0.0), first(true)
     {
         setSymbol("elevation_gain_carrying");
         setInternalName("Elevation Gain Carrying");
@@ -417,43 +436,45 @@ class ElevationGainCarrying : public RideMetric {
         setDescription(tr("Elevation gained at low speed with no power nor cadence"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
-        bool first = true;
+        elegain = 0;
+        first = true;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
+    void accumulate(const RideFilePoint *point) {
 
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (first) {
-                first = false;
-                prevalt = point->alt;
-            }
-            else if (point->alt > prevalt + hysteresis) {
-                if ((point->kph > 0.0) &&
-                    (point->kph < 8.0) &&
-                    (point->watts == 0.0) &&
-                    (point->cad == 0.0)) {
-                    elegain += point->alt - prevalt;
-                };
-                prevalt = point->alt;
-            }
-            else if (point->alt < prevalt - hysteresis) {
-                prevalt = point->alt;
-            }
+        if (first) {
+            first = false;
+            prevalt = point->alt;
+        }
+        else if (point->alt > prevalt + hysteresis) {
+            if ((point->kph > 0.0) &&
+                (point->kph < 8.0) &&
+                (point->watts == 0.0) &&
+                (point->cad == 0.0)) {
+                elegain += point->alt - prevalt;
+            };
+            prevalt = point->alt;
+        }
+        else if (point->alt < prevalt - hysteresis) {
+            prevalt = point->alt;
         }
+    }
+
+    void finalise() {
         setValue(elegain);
     }
 
@@ -830,14 +851,16 @@ static bool athleteFatPAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class ElevationGain : public RideMetric {
+class ElevationGain : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(ElevationGain)
     double elegain;
     double prevalt;
+    double hysteresis;
+    bool first;
 
     public:
 
-    ElevationGain() : elegain(0.0), prevalt(0.0)
+    ElevationGain() : elegain(0.0), prevalt(0.0), hysteresis(0.0), first(true)
     {
         setSymbol("elevation_gain");
         setInternalName("Elevation Gain");
@@ -852,37 +875,40 @@ class ElevationGain : public RideMetric {
         setDescription(tr("Elevation Gain in meters of feets"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
-        bool first = true;
-        RideFileIterator it(item->ride(), spec);
+        elegain = 0;
+        first = true;
+        return true;
+    }
 
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+    void accumulate(const RideFilePoint *point) {
 
-            if (first) {
-                first = false;
-                prevalt = point->alt;
-            }
-            else if (point->alt > prevalt + hysteresis) {
-                elegain += point->alt - prevalt;
-                prevalt = point->alt;
-            }
-            else if (point->alt < prevalt - hysteresis) {
-                prevalt = point->alt;
-            }
+        if (first) {
+            first = false;
+            prevalt = point->alt;
+        }
+        else if (point->alt > prevalt + hysteresis) {
+            elegain += point->alt - prevalt;
+            prevalt = point->alt;
         }
+        else if (point->alt < prevalt - hysteresis) {
+            prevalt = point->alt;
+        }
+    }
+
+    void finalise() {
         setValue(elegain);
     }
 
@@ -897,14 +923,16 @@ static bool elevationGainAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class ElevationLoss : public RideMetric {
+class ElevationLoss : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(ElevationLoss)
     double eleLoss;
     double prevalt;
+    double hysteresis;
+    bool first;
 
     public:
 
-    ElevationLoss() : eleLoss(0.0), prevalt(0.0)
+    ElevationLoss() : eleLoss(0.0), prevalt(0.0), hysteresis(0.0), first(true)
     {
         setSymbol("elevation_loss");
         setInternalName("Elevation Loss");
@@ -920,37 +948,40 @@ class ElevationLoss : public RideMetric {
     }
 
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         // hysteresis can be configured, we default to 3.0
-        double hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
+        hysteresis = appsettings->value(NULL, GC_ELEVATION_HYSTERESIS).toDouble();
         if (hysteresis <= 0.1) hysteresis = 3.00;
 
-        bool first = true;
+        eleLoss = 0;
+        first = true;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+    void accumulate(const RideFilePoint *point) {
 
-            if (first) {
-                first = false;
-                prevalt = point->alt;
-            }
-            else if (point->alt < prevalt - hysteresis) {
-                eleLoss += prevalt - point->alt;
-                prevalt = point->alt;
-            }
-            else if (point->alt > prevalt + hysteresis) {
-                prevalt = point->alt;
-            }
+        if (first) {
+            first = false;
+            prevalt = point->alt;
+        }
+        else if (point->alt < prevalt - hysteresis) {
+            eleLoss += prevalt - point->alt;
+            prevalt = point->alt;
+        }
+        else if (point->alt > prevalt + hysteresis) {
+            prevalt = point->alt;
         }
+    }
+
+    void finalise() {
         setValue(eleLoss);
     }
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim; }
@@ -964,13 +995,13 @@ static bool elevationLossAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class TotalWork : public RideMetric {
+class TotalWork : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(TotalWork)
-    double joules;
+    double joules, recIntSecs;
 
     public:
 
-    TotalWork() : joules(0.0)
+    TotalWork() : joules(0.0), recIntSecs(0.0)
     {
         setSymbol("total_work");
         setInternalName("Work");
@@ -984,24 +1015,26 @@ class TotalWork : public RideMetric {
         setDescription(tr("Total Work in kJ computed from power data"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         joules = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+    void accumulate(const RideFilePoint *point) {
+        if (point->watts >= 0.0)
+            joules += point->watts * recIntSecs;
+    }
 
-            if (point->watts >= 0.0)
-                joules += point->watts * item->ride()->recIntSecs();
-        }
+    void finalise() {
         setValue(joules/1000);
     }
 
@@ -1016,14 +1049,15 @@ static bool totalWorkAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgSpeed : public RideMetric {
+class AvgSpeed : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgSpeed)
     double secsMoving;
     double km;
+    double recIntSecs;
 
     public:
 
-    AvgSpeed() : secsMoving(0.0), km(0.0)
+    AvgSpeed() : secsMoving(0.0), km(0.0), recIntSecs(0.0)
     {
         setSymbol("average_speed");
         setInternalName("Average Speed");
@@ -1039,7 +1073,7 @@ class AvgSpeed : public RideMetric {
         setDescription(tr("Average Speed in kph or mph, computed from distance over time when speed not zero"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &deps) {
 
         assert(deps.contains("total_distance"));
         km = deps.value("total_distance")->value(true);
@@ -1047,15 +1081,8 @@ class AvgSpeed : public RideMetric {
         if (item->ride()->areDataPresent()->kph) {
 
             secsMoving = 0;
-
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                if (point->kph > 0.0) secsMoving += item->ride()->recIntSecs();
-            }
-
-            setValue(secsMoving ? km / secsMoving * 3600.0 : 0.0);
-            setCount(secsMoving);
+            recIntSecs = item->ride()->recIntSecs();
+            return true;
 
         } else {
 
@@ -1064,10 +1091,20 @@ class AvgSpeed : public RideMetric {
             secsMoving = deps.value("workout_time")->value(true);
             setValue(secsMoving ? km / secsMoving * 3600.0 : 0.0);
             setCount(secsMoving);
+            return false;
 
         }
     }
 
+    void accumulate(const RideFilePoint *point) {
+        if (point->kph > 0.0) secsMoving += recIntSecs;
+    }
+
+    void finalise() {
+        setValue(secsMoving ? km / secsMoving * 3600.0 : 0.0);
+        setCount(secsMoving);
+    }
+
     MetricClass classification() const { return Undefined; }
     MetricValidity validity() const { return Unknown; }
     RideMetric *clone() const { return new AvgSpeed(*this); }
@@ -1079,7 +1116,7 @@ static bool avgSpeedAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgPower : public RideMetric {
+struct AvgPower : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgPower)
 
     double count, total;
@@ -1100,26 +1137,27 @@ struct AvgPower : public RideMetric {
         setDescription(tr("Average Power from all samples with power greater than or equal to zero"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->watts || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
-    
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        return true;
+    }
 
-            if (point->watts >= 0.0) {
-                total += point->watts;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->watts >= 0.0) {
+            total += point->watts;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1135,7 +1173,7 @@ static bool avgPowerAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgSmO2 : public RideMetric {
+struct AvgSmO2 : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgSmO2)
 
     double count, total;
@@ -1156,26 +1194,27 @@ struct AvgSmO2 : public RideMetric {
         setDescription(tr("Average Muscle Oxygen Saturation, the percentage of hemoglobin that is carrying oxygen."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->smo2 || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->smo2 > 0.0f) {  // SmO2 should always be > 0.0f
-                total += point->smo2;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->smo2 > 0.0f) {  // SmO2 should always be > 0.0f
+            total += point->smo2;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1190,7 +1229,7 @@ struct AvgSmO2 : public RideMetric {
 static bool avgSmO2Added =
     RideMetricFactory::instance().addMetric(AvgSmO2());
 
-struct AvgtHb : public RideMetric {
+struct AvgtHb : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgtHb)
 
     double count, total;
@@ -1212,26 +1251,28 @@ struct AvgtHb : public RideMetric {
         setDescription(tr("Average total hemoglobin concentration. The total grams of hemoglobin per deciliter."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->thb || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        total = count = 0.0f;
+        total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->thb > 0.0f) {
-                total += point->thb;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->thb > 0.0f) {
+            total += point->thb;
+            ++count;
         }
-        setValue(count > 0.0f ? total / count : 0.0f);
+    }
+
+    void finalise() {
+        setValue(count > 0 ? total / count : 0.0f);
         setCount(count);
     }
 
@@ -1247,7 +1288,7 @@ static bool avgtHbAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AAvgPower : public RideMetric {
+struct AAvgPower : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AAvgPower)
 
     double count, total;
@@ -1268,25 +1309,27 @@ struct AAvgPower : public RideMetric {
         setDescription(tr("Average altitude power. Recorded power adjusted to take into account the effect of altitude on vo2max and thus power output."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->apower >= 0.0) {
-                total += point->apower;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->apower >= 0.0) {
+            total += point->apower;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1301,7 +1344,7 @@ static bool aavgPowerAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct NonZeroPower : public RideMetric {
+struct NonZeroPower : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(NonZeroPower)
 
     double count, total;
@@ -1322,25 +1365,27 @@ struct NonZeroPower : public RideMetric {
         setDescription(tr("Average Power without zero values, it gives inflated values when frequent coasting is present"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->watts || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->watts > 0.0) {
-                total += point->watts;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->watts > 0.0) {
+            total += point->watts;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1356,7 +1401,7 @@ static bool nonZeroPowerAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgHeartRate : public RideMetric {
+struct AvgHeartRate : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgHeartRate)
 
     double total, count;
@@ -1377,24 +1422,27 @@ struct AvgHeartRate : public RideMetric {
         setDescription(tr("Average Heart Rate computed for samples when hr is greater than zero"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->hr || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->hr > 0) {
-                total += point->hr;
-                ++count;
-            }
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->hr > 0) {
+            total += point->hr;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1409,7 +1457,7 @@ struct AvgHeartRate : public RideMetric {
 static bool avgHeartRateAdded =
     RideMetricFactory::instance().addMetric(AvgHeartRate());
 
-struct AvgCoreTemp : public RideMetric {
+struct AvgCoreTemp : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgCoreTemp)
 
     double total, count;
@@ -1431,26 +1479,27 @@ struct AvgCoreTemp : public RideMetric {
         setDescription(tr("Average Core Temperature. The core body temperature estimate is based on HR data"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->tcore > 0) {
-                total += point->tcore;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->tcore > 0) {
+            total += point->tcore;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
@@ -1467,14 +1516,14 @@ static bool avgCTAdded =
 
 ///////////////////////////////////////////////////////////////////////////////
 
-struct HeartBeats : public RideMetric {
+struct HeartBeats : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(HeartBeats)
 
-    double total;
+    double total, recIntSecs;
 
     public:
 
-    HeartBeats()
+    HeartBeats() : total(0.0), recIntSecs(0.0)
     {
         setSymbol("heartbeats");
         setInternalName("Heartbeats");
@@ -1487,22 +1536,25 @@ struct HeartBeats : public RideMetric {
         setDescription(tr("Total Heartbeats"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            total += (point->hr / 60) * item->ride()->recIntSecs();
-        }
+    void accumulate(const RideFilePoint *point) {
+        total += (point->hr / 60) * recIntSecs;
+    }
+
+    void finalise() {
         setValue(total);
     }
 
@@ -1764,7 +1816,7 @@ static bool hrnpAdded = addHrNp();
 
 ///////////////////////////////////////////////////////////////////////////////
 
-struct AvgCadence : public RideMetric {
+struct AvgCadence : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgCadence)
 
     double total, count;
@@ -1785,25 +1837,27 @@ struct AvgCadence : public RideMetric {
         setDescription(tr("Average Cadence, computed when Cadence > 0"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->cad > 0) {
-                total += point->cad;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad > 0) {
+            total += point->cad;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : count);
         setCount(count);
     }
@@ -1820,7 +1874,7 @@ static bool avgCadenceAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgTemp : public RideMetric {
+struct AvgTemp : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgTemp)
 
     double total, count;
@@ -1854,27 +1908,28 @@ struct AvgTemp : public RideMetric {
     }
 
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (item->ride() == NULL || !item->ride()->areDataPresent()->temp || item->ride()->dataPoints().count() == 0) {
             setValue(RideFile::NA);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->temp != RideFile::NA) {
-                total += point->temp;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->temp != RideFile::NA) {
+            total += point->temp;
+            ++count;
         }
+    }
 
-        setValue(count > 0 ? (total / count) : count);
+    void finalise() {
+        setValue(count > 0 ? total / count : count);
         setCount(count);
     }
 
@@ -1888,7 +1943,7 @@ static bool avgTempAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxPower : public RideMetric {
+class MaxPower : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxPower)
     double max;
     public:
@@ -1906,21 +1961,24 @@ class MaxPower : public RideMetric {
         setDescription(tr("Maximum Power"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->watts >= max)
-                max = point->watts;
-        }
+        max = 0;
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->watts >= max) max = point->watts;
+    }
+
+    void finalise() {
         setValue(max);
     }
     bool isRelevantForRide(const RideItem *ride) const { return ride->present.contains("P") || (!ride->isSwim && !ride->isRun); }
@@ -1934,7 +1992,7 @@ static bool maxPowerAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxSmO2 : public RideMetric {
+class MaxSmO2 : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxSmO2)
     double max;
     public:
@@ -1952,21 +2010,24 @@ class MaxSmO2 : public RideMetric {
         setDescription(tr("Maximum Muscle Oxygen Saturation, the percentage of hemoglobin that is carrying oxygen."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->smo2 >= max)
-                max = point->smo2;
-        }
+        max = 0;
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->smo2 >= max) max = point->smo2;
+    }
+
+    void finalise() {
         setValue(max);
     }
 
@@ -1980,7 +2041,7 @@ class MaxSmO2 : public RideMetric {
 static bool maxSmO2Added =
     RideMetricFactory::instance().addMetric(MaxSmO2());
 
-class MaxtHb : public RideMetric {
+class MaxtHb : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxtHb)
     double max;
     public:
@@ -1999,22 +2060,24 @@ class MaxtHb : public RideMetric {
         setDescription(tr("Maximum total hemoglobin concentration. The total grams of hemoglobin per deciliter."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        max = 0;
+        return true;
+    }
 
-            if (point->thb >= max)
-                max = point->thb;
-        }
+    void accumulate(const RideFilePoint *point) {
+        if (point->thb >= max) max = point->thb;
+    }
+
+    void finalise() {
         setValue(max);
     }
 
@@ -2030,11 +2093,12 @@ static bool maxtHbAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MinSmO2 : public RideMetric {
+class MinSmO2 : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MinSmO2)
     double min;
+    bool notset;
     public:
-    MinSmO2() : min(0.0)
+    MinSmO2() : min(0.0), notset(true)
     {
         setSymbol("min_smo2");
         setInternalName("Min SmO2");
@@ -2047,27 +2111,28 @@ class MinSmO2 : public RideMetric {
         setDescription(tr("Minimum Muscle Oxygen Saturation, the percentage of hemoglobin that is carrying oxygen."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        bool notset = true;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        notset = true;
+        return true;
+    }
 
-            if (point->smo2 >= 0.0f && (notset || point->smo2 < min)) {
-                min = point->smo2;
-                if (point->smo2 > 0.0f && notset)
-                  notset = false;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->smo2 >= 0.0f && (notset || point->smo2 < min)) {
+            min = point->smo2;
+            if (point->smo2 > 0.0f && notset)
+              notset = false;
         }
+    }
+
+    void finalise() {
         setValue(min);
     }
 
@@ -2079,11 +2144,12 @@ class MinSmO2 : public RideMetric {
 static bool minSmO2Added =
     RideMetricFactory::instance().addMetric(MinSmO2());
 
-class MintHb : public RideMetric {
+class MintHb : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MintHb)
     double min;
+    bool notset;
     public:
-    MintHb() : min(0.0)
+    MintHb() : min(0.0), notset(true)
     {
         setSymbol("min_tHb");
         setInternalName("Min tHb");
@@ -2098,25 +2164,27 @@ class MintHb : public RideMetric {
         setDescription(tr("Minimum total hemoglobin concentration. The total grams of hemoglobin per deciliter."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        bool notset = true;
+        notset = true;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->thb > 0.0f && (notset || point->thb < min)) {
-                min = point->thb;
-                notset = false;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->thb > 0.0f && (notset || point->thb < min)) {
+            min = point->thb;
+            notset = false;
         }
+    }
+
+    void finalise() {
         setValue(min);
     }
     MetricClass classification() const { return Undefined; }
@@ -2129,7 +2197,7 @@ static bool mintHb =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxHr : public RideMetric {
+class MaxHr : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxHr)
     double max;
     public:
@@ -2147,21 +2215,24 @@ class MaxHr : public RideMetric {
         setDescription(tr("Maximum Heart Rate."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->hr >= max)
-                max = point->hr;
-        }
+        max = 0;
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->hr >= max) max = point->hr;
+    }
+
+    void finalise() {
         setValue(max);
     }
 
@@ -2177,11 +2248,12 @@ static bool maxHrAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MinHr : public RideMetric {
+class MinHr : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MinHr)
     double min;
+    bool notset;
     public:
-    MinHr() : min(0.0)
+    MinHr() : min(0.0), notset(true)
     {
         setSymbol("min_heartrate");
         setInternalName("Min Heartrate");
@@ -2195,27 +2267,28 @@ class MinHr : public RideMetric {
         setDescription(tr("Minimum Heart Rate."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        bool notset = true;
+        notset = true;
         min = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->hr > 0 && (notset || point->hr < min)) {
-                min = point->hr;
-                notset = false;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->hr > 0 && (notset || point->hr < min)) {
+            min = point->hr;
+            notset = false;
         }
+    }
+
+    void finalise() {
         setValue(min);
     }
 
@@ -2231,7 +2304,7 @@ static bool minHrAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxCT : public RideMetric {
+class MaxCT : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxCT)
     double max;
     public:
@@ -2250,22 +2323,24 @@ class MaxCT : public RideMetric {
         setDescription(tr("Maximum Core Temperature. The core body temperature estimate is based on HR data"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        max = 0;
+        return true;
+    }
 
-            if (point->tcore >= max)
-                max = point->tcore;
-        }
+    void accumulate(const RideFilePoint *point) {
+        if (point->tcore >= max) max = point->tcore;
+    }
+
+    void finalise() {
         setValue(max);
     }
 
@@ -2281,11 +2356,12 @@ static bool maxCTAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxSpeed : public RideMetric {
+class MaxSpeed : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxSpeed)
+    double max;
     public:
 
-    MaxSpeed()
+    MaxSpeed() : max(0.0)
     {
         setSymbol("max_speed");
         setInternalName("Max Speed");
@@ -2302,25 +2378,28 @@ class MaxSpeed : public RideMetric {
     }
 
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double max = 0.0;
+        max = 0.0;
+        if (!item->ride()->areDataPresent()->kph) {
+            setValue(max);
+            return false;
+        }
+        return true;
+    }
 
-        if (item->ride()->areDataPresent()->kph) {
+    void accumulate(const RideFilePoint *point) {
+        if (point->kph > max) max = point->kph;
+    }
 
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                    if (point->kph > max) max = point->kph;
-            }
-        }
+    void finalise() {
         setValue(max);
     }
 
@@ -2334,11 +2413,12 @@ static bool maxSpeedAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxCadence : public RideMetric {
+class MaxCadence : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxCadence)
+    double max;
     public:
 
-    MaxCadence()
+    MaxCadence() : max(0.0)
     {
         setSymbol("max_cadence");
         setInternalName("Max Cadence");
@@ -2352,23 +2432,24 @@ class MaxCadence : public RideMetric {
         setDescription(tr("Maximum Cadence"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double max = 0.0;
+        max = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->cad > max) max = point->cad;
-        }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad > max) max = point->cad;
+    }
 
+    void finalise() {
         setValue(max);
     }
 
@@ -2384,11 +2465,12 @@ static bool maxCadenceAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxTemp : public RideMetric {
+class MaxTemp : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxTemp)
+    double max;
     public:
 
-    MaxTemp()
+    MaxTemp() : max(0.0)
     {
         setSymbol("max_temp");
         setInternalName("Max Temp");
@@ -2411,22 +2493,24 @@ class MaxTemp : public RideMetric {
         return RideMetric::toString(useMetricUnits);
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->temp) {
             setValue(RideFile::NA);
             setCount(0);
-            return;
+            return false;
         }
 
-        double max = RideFile::NA;
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->temp != RideFile::NA && point->temp > max) max = point->temp;
-        }
+        max = RideFile::NA;
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->temp != RideFile::NA && point->temp > max) max = point->temp;
+    }
 
+    void finalise() {
         setValue(max);
     }
 
@@ -2440,11 +2524,12 @@ static bool maxTempAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MinTemp : public RideMetric {
+class MinTemp : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MinTemp)
+    double min;
     public:
 
-    MinTemp()
+    MinTemp() : min(0.0)
     {
         setSymbol("min_temp");
         setInternalName("Min Temp");
@@ -2467,22 +2552,24 @@ class MinTemp : public RideMetric {
         return RideMetric::toString(useMetricUnits);
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->temp) {
             setValue(RideFile::NA);
             setCount(0);
-            return;
+            return false;
         }
 
-        double min = 10000;
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->temp != RideFile::NA && point->temp < min) min = point->temp;
-        }
+        min = 10000;
+        return true;
+    }
+
+    void accumulate(const RideFilePoint *point) {
+        if (point->temp != RideFile::NA && point->temp < min) min = point->temp;
+    }
 
+    void finalise() {
         setValue(min < 10000 ? min : (double)(RideFile::NA));
     }
 
@@ -2815,13 +2902,14 @@ static bool maxPowerVarianceAdded = addMaxPowerVariance();
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLTE : public RideMetric {
+class AvgLTE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLTE)
+    double total, samples;
 
     public:
 
-    AvgLTE()
+    AvgLTE() : total(0.0), samples(0.0)
     {
         setSymbol("average_lte");
         setInternalName("Average Left Torque Effectiveness");
@@ -2836,31 +2924,29 @@ class AvgLTE : public RideMetric {
         setDescription(tr("It measures how much of the power delivered to the left pedal is pushing it forward, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->watts || !item->ride()->areDataPresent()->lte) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double samples = 0.0f;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        total = samples = 0;
+        return true;
+    }
 
-            if (point->lte && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
-                samples ++;
-                total += point->lte;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lte && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
+            samples ++;
+            total += point->lte;
         }
+    }
 
+    void finalise() {
         if (total > 0.0f && samples > 0.0f) setValue(total / samples);
         else setValue(0.0);
-
     }
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
@@ -2870,13 +2956,14 @@ class AvgLTE : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRTE : public RideMetric {
+class AvgRTE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRTE)
+    double total, samples;
 
     public:
 
-    AvgRTE()
+    AvgRTE() : total(0.0), samples(0.0)
     {
         setSymbol("average_rte");
         setInternalName("Average Right Torque Effectiveness");
@@ -2891,30 +2978,29 @@ class AvgRTE : public RideMetric {
         setDescription(tr("It measures how much of the power delivered to the right pedal is pushing it forward, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->watts || !item->ride()->areDataPresent()->rte) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double samples = 0.0f;
+        total = samples = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->rte && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
-                samples ++;
-                total += point->rte;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rte && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
+            samples ++;
+            total += point->rte;
         }
+    }
 
+    void finalise() {
         if (total > 0.0f && samples > 0.0f) setValue(total / samples);
         else setValue(0.0);
-
     }
     bool isRelevantForRide(const RideItem *ride) const { return !ride->isSwim && !ride->isRun; }
     MetricClass classification() const { return Undefined; }
@@ -2924,13 +3010,14 @@ class AvgRTE : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPS : public RideMetric {
+class AvgLPS : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPS)
+    double total, samples;
 
     public:
 
-    AvgLPS()
+    AvgLPS() : total(0.0), samples(0.0)
     {
         setSymbol("average_lps");
         setInternalName("Average Left Pedal Smoothness");
@@ -2945,27 +3032,27 @@ class AvgLPS : public RideMetric {
         setDescription(tr("It measures how smoothly power is delivered to the left pedal throughout the revolution, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->watts || !item->ride()->areDataPresent()->lps) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double samples = 0.0f;
+        total = samples = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->lps && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
-                samples ++;
-                total += point->lps;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lps && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
+            samples ++;
+            total += point->lps;
         }
+    }
 
+    void finalise() {
         if (total > 0.0f && samples > 0.0f) setValue(total / samples);
         else setValue(0.0);
     }
@@ -2978,13 +3065,14 @@ class AvgLPS : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPS : public RideMetric {
+class AvgRPS : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRPS)
+    double total, samples;
 
     public:
 
-    AvgRPS()
+    AvgRPS() : total(0.0), samples(0.0)
     {
         setSymbol("average_rps");
         setInternalName("Average Right Pedal Smoothness");
@@ -2999,27 +3087,27 @@ class AvgRPS : public RideMetric {
         setDescription(tr("It measures how smoothly power is delivered to the right pedal throughout the revolution, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->watts || !item->ride()->areDataPresent()->rps) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double samples = 0.0f;
+        total = samples = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->rps && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
-                samples ++;
-                total += point->rps;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rps && point->watts > 0.0f && point->cad && point->lrbalance != RideFile::NA) {
+            samples ++;
+            total += point->rps;
         }
+    }
 
+    void finalise() {
         if (total > 0.0f && samples > 0.0f) setValue(total / samples);
         else setValue(0.0);
     }
@@ -3031,13 +3119,14 @@ class AvgRPS : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPCO : public RideMetric {
+class AvgLPCO : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPCO)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgLPCO()
+    AvgLPCO() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_lpco");
         setInternalName("Average Left Pedal Center Offset");
@@ -3053,27 +3142,28 @@ class AvgLPCO : public RideMetric {
         setDescription(tr("Platform center offset is the location on the left pedal platform where you apply force, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->lpco) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->cad) {
-                secs += item->ride()->recIntSecs();
-                total += point->lpco;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad) {
+            secs += recIntSecs;
+            total += point->lpco;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3086,13 +3176,14 @@ class AvgLPCO : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPCO : public RideMetric {
+class AvgRPCO : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRPCO)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgRPCO()
+    AvgRPCO() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_rpco");
         setInternalName("Average Right Pedal Center Offset");
@@ -3108,27 +3199,28 @@ class AvgRPCO : public RideMetric {
         setDescription(tr("Platform center offset is the location on the right pedal platform where you apply force, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->rpco) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->cad) {
-                secs += item->ride()->recIntSecs();
-                total += point->rpco;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad) {
+            secs += recIntSecs;
+            total += point->rpco;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3140,13 +3232,14 @@ class AvgRPCO : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPPB : public RideMetric {
+class AvgLPPB : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPPB)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgLPPB()
+    AvgLPPB() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_lppb");
         setInternalName("Average Left Power Phase Start");
@@ -3160,27 +3253,28 @@ class AvgLPPB : public RideMetric {
         setDescription(tr("It is the left pedal stroke angle where you start producing positive power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->lppb) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->lppe>0) { // use for average if we have an end
-                secs += item->ride()->recIntSecs();
-                total += point->lppb + (point->lppb>180?-360:0);
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lppe>0) { // use for average if we have an end
+            secs += recIntSecs;
+            total += point->lppb + (point->lppb>180?-360:0);
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3192,13 +3286,13 @@ class AvgLPPB : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPPB : public RideMetric {
+class AvgRPPB : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRTPP)
 
     public:
 
-    AvgRPPB()
+    AvgRPPB() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_rppb");
         setInternalName("Average Right Power Phase Start");
@@ -3212,27 +3306,28 @@ class AvgRPPB : public RideMetric {
         setDescription(tr("It is the right pedal stroke angle where you start producing positive power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->rppb) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->rppe>0) { // use for average if we have an end
-                secs += item->ride()->recIntSecs();
-                total += point->rppb + (point->rppb>180?-360:0);
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rppe>0) { // use for average if we have an end
+            secs += recIntSecs;
+            total += point->rppb + (point->rppb>180?-360:0);
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3246,13 +3341,14 @@ class AvgRPPB : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPPE : public RideMetric {
+class AvgLPPE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPPE)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgLPPE()
+    AvgLPPE() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_lppe");
         setInternalName("Average Left Power Phase End");
@@ -3266,27 +3362,28 @@ class AvgLPPE : public RideMetric {
         setDescription(tr("It is the left pedal stroke angle where you end producing positive power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->lppe) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->lppe > 0) {
-                secs += item->ride()->recIntSecs();
-                total += point->lppe;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lppe > 0) {
+            secs += recIntSecs;
+            total += point->lppe;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3298,13 +3395,14 @@ class AvgLPPE : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPPE : public RideMetric {
+class AvgRPPE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRPPE)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgRPPE()
+    AvgRPPE() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_rppe");
         setInternalName("Average Right Power Phase End");
@@ -3318,28 +3416,28 @@ class AvgRPPE : public RideMetric {
         setDescription(tr("It is the right pedal stroke angle where you end producing positive power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->rppe) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-            if (point->rppe > 0) { // end has to be > 0
-                secs += item->ride()->recIntSecs();
-                total += point->rppe;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rppe > 0) { // end has to be > 0
+            secs += recIntSecs;
+            total += point->rppe;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3352,13 +3450,14 @@ class AvgRPPE : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPPPB : public RideMetric {
+class AvgLPPPB : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPPPB)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgLPPPB()
+    AvgLPPPB() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_lpppb");
         setInternalName("Average Left Peak Power Phase Start");
@@ -3371,28 +3470,28 @@ class AvgLPPPB : public RideMetric {
         setDescription(tr("It is the left pedal stroke angle where you start producing peak power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->lpppb) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-            if (point->lpppe>0) { // use for average if we have an end
-                secs += item->ride()->recIntSecs();
-                total += point->lpppb + (point->lpppb>180?-360:0);
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lpppe>0) { // use for average if we have an end
+            secs += recIntSecs;
+            total += point->lpppb + (point->lpppb>180?-360:0);
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3404,13 +3503,14 @@ class AvgLPPPB : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPPPB : public RideMetric {
+class AvgRPPPB : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRPPPB)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgRPPPB()
+    AvgRPPPB() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_rpppb");
         setInternalName("Average Right Peak Power Phase Start");
@@ -3424,28 +3524,28 @@ class AvgRPPPB : public RideMetric {
         setDescription(tr("It is the right pedal stroke angle where you start producing peak power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->rpppb) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-            if (point->rpppe>0) { // use for average if we have an end
-                secs += item->ride()->recIntSecs();
-                total += point->rpppb + (point->rpppb>180?-360:0);
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rpppe>0) { // use for average if we have an end
+            secs += recIntSecs;
+            total += point->rpppb + (point->rpppb>180?-360:0);
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3458,13 +3558,14 @@ class AvgRPPPB : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgLPPPE : public RideMetric {
+class AvgLPPPE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgLPPPE)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgLPPPE()
+    AvgLPPPE() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_lpppe");
         setInternalName("Average Left Peak Power Phase End");
@@ -3478,27 +3579,28 @@ class AvgLPPPE : public RideMetric {
         setDescription(tr("It is the left pedal stroke angle where you end producing peak power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->lppe) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->lpppe > 0) { // end has to be > 0
-                secs += item->ride()->recIntSecs();
-                total += point->lpppe;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->lpppe > 0) { // end has to be > 0
+            secs += recIntSecs;
+            total += point->lpppe;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -3510,13 +3612,14 @@ class AvgLPPPE : public RideMetric {
 
 //////////////////////////////////////////////////////////////////////////////
 
-class AvgRPPPE : public RideMetric {
+class AvgRPPPE : public AccumulatingMetric {
 
     Q_DECLARE_TR_FUNCTIONS(AvgRPPPE)
+    double total, secs, recIntSecs;
 
     public:
 
-    AvgRPPPE()
+    AvgRPPPE() : total(0.0), secs(0.0), recIntSecs(0.0)
     {
         setSymbol("average_rpppe");
         setInternalName("Average Right Peak Power Phase End");
@@ -3530,28 +3633,28 @@ class AvgRPPPE : public RideMetric {
         setDescription(tr("It is the right pedal stroke angle where you end producing peak power, on average."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride()) || !item->ride()->areDataPresent()->rpppe) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double total = 0.0f;
-        double secs = 0.0f;
-
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
+        total = secs = 0;
+        recIntSecs = item->ride()->recIntSecs();
+        return true;
+    }
 
-            if (point->rpppe > 0) { // end has to be > 0
-                secs += item->ride()->recIntSecs();
-                total += point->rpppe;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rpppe > 0) { // end has to be > 0
+            secs += recIntSecs;
+            total += point->rpppe;
         }
+    }
 
+    void finalise() {
         if (secs > 0.0f) setValue(total / secs);
         else setValue(0.0);
     }
@@ -18,12 +18,12 @@
 
 
 #include "CPSolver.h"
-#include <ctime>
 
 CPSolver::CPSolver(Context *context)
-   : context(context)
+   : context(context), chains(1)
 {
     integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    data.setIntegral(integral);
 }
 
 // set the data to solve
@@ -49,9 +49,12 @@ CPSolver::setData(CPSolverConstraints constraints, QList<RideItem*> rides)
             // ok, now we have a point we need to get the power data
             // from the start to the point of exhaustion into a
             // 1 second sample array
-            data << power1s(item->ride(), rp->secs);
+            data.add(power1s(item->ride(), rp->secs));
         }
     }
+
+    // decay tables for the integral
+    data.prepare(constraints.tf, constraints.tto);
 }
 
 // get a 1s array to the point secs
@@ -73,96 +76,13 @@ CPSolver::power1s(RideFile *f, double secs)
 double
 CPSolver::cost(WBParms parms)
 {
-    // returning sum(W'bal ^ 2)
-
-    // loop through each ride for now, but avoid foreach()
-    // since it will make a copy of the contents which has
-    // a significant performance impact
-    double sumwb2=0;
-    for(int i=0; i<data.count();i++)  sumwb2 += pow(compute(data[i], parms),2);
-
-    //qDebug()<<"cost="<<QString("%1").arg(sumwb2, 0, 'g', 7);
-
-    // what we got - normalise to number of fits
-    return (sumwb2/data.count()) /1000.0f;
+    return data.cost(parms);
 }
 
 double
 CPSolver::compute(QVector<int> &ride, WBParms parms)
 {
-    // compute w'bal for the ride using the paramters
-    // XXX for now we use the integral model
-    double I=0.00f;
-    int t=0;
-    double wpbal=parms.W;
-    foreach(int watts, ride) {
-
-        if (integral) {
-
-            // INTEGRAL
-            I += exp(((double)(t) / parms.TAU)) * (watts > parms.CP ? watts-parms.CP : 0);
-            wpbal = parms.W - (exp(-((double)(t) / parms.TAU)) * I);
-
-        } else {
-
-
-            // DIFFERENTIAL
-            wpbal  += watts < parms.CP ? ((double(parms.TAU)/100.0f) * (parms.W - wpbal)/parms.W * (parms.CP - watts) ) : (parms.CP-watts);
-        }
-
-        t++;
-    }
-
-    // we solve for W'bal=500 as it is not possible to completely
-    // exhaust W', 500 is the point at which most athletes will
-    // fail to continue, on average.
-    // See: http://www.ncbi.nlm.nih.gov/pubmed/24509723
-    return wpbal - 500;
-}
-
-// get us a neighbour
-WBParms
-CPSolver::neighbour(WBParms p, int k, int kmax)
-{
-    WBParms returning;
-
-    // a crucial aspect of the simulated annealling algorithm is that
-    // we search a wide space for solutions as we start searching, but
-    // as time passes we look in a much smaller range; i.e. we distribute
-    // across the search space up front, but hone in as we get nearer the end
-
-    // wild ass guesses at the beginning down to very closest neighbours
-    // start at 150% and drop down to 1%
-    double factor = (double(kmax - k) / (double(kmax)));
-
-    // range from where we are now from hi to lo
-    // value range (e.g. 400 is range of CP between 100-500)
-    int CPrange = 3 + ((constraints.cpto - constraints.cpf) * factor);
-    int Wrange = 101 + ((constraints.wto - constraints.wf) * factor);
-    int TAUrange = 3 + ((constraints.tto - constraints.tf) * factor);
-    int it=0;
-
-    // scale rand() to our range (32767 is typical for RAND_MAX)
-    double f = double(Wrange) / double(RAND_MAX);
-
-    do {
-        returning.CP = p.CP + (rand()%CPrange - (CPrange/2));
-        returning.W = p.W + (int(double(rand())*f)%Wrange - (Wrange/2));
-        returning.TAU = p.TAU + (rand()%TAUrange - (TAUrange/2));
-
-    } while (it++ < 3 && (returning.CP < constraints.cpf || returning.CP > constraints.cpto ||
-                          returning.W > constraints.cpto || returning.W < constraints.cpf ||
-                          returning.TAU < constraints.tf || returning.TAU > constraints.tto));
-
-    // if we failed to randomise just check bounds
-    if (returning.CP > constraints.cpto) returning.CP = constraints.cpto;
-    if (returning.CP < constraints.cpf) returning.CP = constraints.cpf;
-    if (returning.W > constraints.wto) returning.W = constraints.wto;
-    if (returning.W < constraints.wf) returning.W = constraints.wf;
-    if (returning.TAU > constraints.tto) returning.TAU = constraints.tto;
-    if (returning.TAU < constraints.tf) returning.TAU = constraints.tf;
-
-    return returning;
+    return data.compute(ride, parms);
 }
 
 void
@@ -181,57 +101,32 @@ CPSolver::start()
     // to flag when to stop
     halt = false;
 
-    // set starting conditions at maximals
-    s0.CP =   constraints.cpto;
-    s0.W =    constraints.wto;
-    s0.TAU =  constraints.tto;
-
     QElapsedTimer p;
     p.start();
 
-    // initial conditions
-    srand((unsigned int) time (NULL)); // seed ONCE!
-    double E = cost(s0);
-    double Ebest = E;
-    WBParms s = s0;
-    WBParms sbest = s;
-
-    // 10,000 iterations at most
-    int k=0;
-    int kmax = 100000;
+    // 100,000 iterations at most, shared between the chains
+    CPSolverSearch search(&data, constraints, chains, 100000, QRandomGenerator::global()->generate());
+    double Ebest = search.bestCost();
+    WBParms sbest = search.best();
 
     // give up when we're on it or run out of loops
-    while (halt == false && k < kmax) {
-
-        WBParms snew = neighbour(s, k, kmax);
-        double Enew = cost(snew);
+    int k=0;
+    while (halt == false && search.step()) {
 
         // progress update k=0 means stop so we offset by one
-        emit current(k+1, snew,Enew);
-
-        // probability - always 1 if better, but randomly accept higher
-        double random = double(rand()%101)/100.00f;
-        double temp = temperature(double(k)/double(kmax));
-        double prob = probability(E,Enew,temp);
-
-        if (prob > random) {
-            s = snew;
-            E = Enew;
+        foreach (CPSolverChain *chain, search.list()) {
+            for (int i=0; i<chain->trail.count() && halt == false; i++)
+                emit current(++k, chain->trail[i].first, chain->trail[i].second);
         }
 
         // is it better than our very best?
-        if (E < Ebest) {
-            Ebest = E;
-            sbest = s;
+        if (search.bestCost() < Ebest) {
+            Ebest = search.bestCost();
+            sbest = search.best();
 
             // k of zero means stop so we offset by one
-            emit newBest(k+1, sbest, Ebest);
-            //qDebug()<<k<<"new best"<<Ebest <<s.CP<<s.W<<s.TAU;
+            emit newBest(search.iterations(), sbest, Ebest);
         }
-
-        // don't run forever
-        k++;
-
     }
 
     // k of zero means stop
@@ -239,19 +134,6 @@ CPSolver::start()
     //qDebug()<<"TOOK"<<p.elapsed();
 }
 
-double
-CPSolver::temperature(double alpha)
-{
-    return (1.0-(0.02*alpha));
-}
-
-double
-CPSolver::probability(double sold, double snew, double temperature)
-{
-    if(snew < sold ) return 1.0;
-    return(exp((sold - snew)/temperature));
-}
-
 void
 CPSolver::pause()
 {
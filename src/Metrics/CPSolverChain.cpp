@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "CPSolverChain.h"
+#include "TaskScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+//
+// CPSolverSeries
+//
+void
+CPSolverSeries::decay(double tau, double *table)
+{
+    for (int j=0; j<DecayBlock; j++) table[j] = exp(-double(DecayBlock-1-j) / tau);
+    table[DecayBlock] = exp(-double(DecayBlock) / tau);
+}
+
+void
+CPSolverSeries::prepare(int taufrom, int tauto)
+{
+    this->taufrom = taufrom;
+    this->tauto = tauto;
+
+    tables.resize((tauto - taufrom + 1) * (DecayBlock + 1));
+    for (int tau=taufrom; tau<=tauto; tau++)
+        decay(tau, tables.data() + (tau - taufrom) * (DecayBlock + 1));
+}
+
+// excess over CP for each sample weighted by the table, in four
+// independent sums so the compiler can vectorise it
+static inline double blockSum(const int *watts, int n, double CP, const double *table)
+{
+    double s0=0, s1=0, s2=0, s3=0;
+    int j=0;
+    for (; j+4<=n; j+=4) {
+        s0 += table[j] * std::max(watts[j] - CP, 0.0);
+        s1 += table[j+1] * std::max(watts[j+1] - CP, 0.0);
+        s2 += table[j+2] * std::max(watts[j+2] - CP, 0.0);
+        s3 += table[j+3] * std::max(watts[j+3] - CP, 0.0);
+    }
+    for (; j<n; j++) s0 += table[j] * std::max(watts[j] - CP, 0.0);
+    return (s0 + s1) + (s2 + s3);
+}
+
+double
+CPSolverSeries::integralWbal(const int *watts, int n, double CP, double W, const double *table)
+{
+    // blocks are aligned to the end, so the odd ones at the start go
+    // against the end of the table and decay that bit further
+    int odd = n % DecayBlock;
+    double sum = blockSum(watts, odd, CP, table + DecayBlock - odd);
+
+    for (int i=odd; i<n; i += DecayBlock)
+        sum = sum * table[DecayBlock] + blockSum(watts + i, DecayBlock, CP, table);
+
+    return W - sum;
+}
+
+double
+CPSolverSeries::compute(const QVector<int> &watts, const WBParms &parms) const
+{
+    double wpbal=parms.W;
+
+    if (integral) {
+
+        // INTEGRAL
+        int tau = int(parms.TAU);
+        if (tau == parms.TAU && tau >= taufrom && tau <= tauto) {
+            wpbal = integralWbal(watts.constData(), watts.count(), parms.CP, parms.W,
+                                 tables.constData() + (tau - taufrom) * (DecayBlock + 1));
+        } else {
+            double table[DecayBlock+1];
+            decay(parms.TAU, table);
+            wpbal = integralWbal(watts.constData(), watts.count(), parms.CP, parms.W, table);
+        }
+
+    } else {
+
+        // DIFFERENTIAL
+        for (int i=0; i<watts.count(); i++) {
+            int w = watts[i];
+            wpbal  += w < parms.CP ? ((double(parms.TAU)/100.0f) * (parms.W - wpbal)/parms.W * (parms.CP - w) ) : (parms.CP-w);
+        }
+    }
+
+    // we solve for W'bal=500 as it is not possible to completely
+    // exhaust W', 500 is the point at which most athletes will
+    // fail to continue, on average.
+    // See: http://www.ncbi.nlm.nih.gov/pubmed/24509723
+    return wpbal - 500;
+}
+
+double
+CPSolverSeries::cost(const WBParms &parms) const
+{
+    // returning sum(W'bal ^ 2)
+    double sumwb2=0;
+    for(int i=0; i<data.count();i++)  sumwb2 += pow(compute(data[i], parms),2);
+
+    // what we got - normalise to number of fits
+    return (sumwb2/data.count()) /1000.0f;
+}
+
+//
+// CPSolverChain
+//
+CPSolverChain::CPSolverChain(const CPSolverSeries *series, CPSolverConstraints constraints, quint32 seed)
+    : E(0), Ebest(0), series(series), constraints(constraints), generator(seed)
+{
+}
+
+void
+CPSolverChain::start(WBParms s)
+{
+    this->s = sbest = s;
+    E = Ebest = series->cost(s);
+}
+
+WBParms
+CPSolverChain::random()
+{
+    return WBParms(constraints.cpf + generator.bounded(constraints.cpto - constraints.cpf + 1),
+                   constraints.wf + generator.bounded(constraints.wto - constraints.wf + 1),
+                   constraints.tf + generator.bounded(constraints.tto - constraints.tf + 1));
+}
+
+// get us a neighbour
+WBParms
+CPSolverChain::neighbour(WBParms p, int k, int kmax)
+{
+    WBParms returning;
+
+    // a crucial aspect of the simulated annealling algorithm is that
+    // we search a wide space for solutions as we start searching, but
+    // as time passes we look in a much smaller range; i.e. we distribute
+    // across the search space up front, but hone in as we get nearer the end
+
+    // wild ass guesses at the beginning down to very closest neighbours
+    // start at 150% and drop down to 1%
+    double factor = (double(kmax - k) / (double(kmax)));
+
+    // range from where we are now from hi to lo
+    // value range (e.g. 400 is range of CP between 100-500)
+    int CPrange = 3 + ((constraints.cpto - constraints.cpf) * factor);
+    int Wrange = 101 + ((constraints.wto - constraints.wf) * factor);
+    int TAUrange = 3 + ((constraints.tto - constraints.tf) * factor);
+    int it=0;
+
+    do {
+        returning.CP = p.CP + (int(generator.bounded(CPrange)) - (CPrange/2));
+        returning.W = p.W + (int(generator.bounded(Wrange)) - (Wrange/2));
+        returning.TAU = p.TAU + (int(generator.bounded(TAUrange)) - (TAUrange/2));
+
+    } while (it++ < 3 && (returning.CP < constraints.cpf || returning.CP > constraints.cpto ||
+                          returning.W > constraints.cpto || returning.W < constraints.cpf ||
+                          returning.TAU < constraints.tf || returning.TAU > constraints.tto));
+
+    // if we failed to randomise just check bounds
+    if (returning.CP > constraints.cpto) returning.CP = constraints.cpto;
+    if (returning.CP < constraints.cpf) returning.CP = constraints.cpf;
+    if (returning.W > constraints.wto) returning.W = constraints.wto;
+    if (returning.W < constraints.wf) returning.W = constraints.wf;
+    if (returning.TAU > constraints.tto) returning.TAU = constraints.tto;
+    if (returning.TAU < constraints.tf) returning.TAU = constraints.tf;
+
+    return returning;
+}
+
+void
+CPSolverChain::run(int k, int n, int kmax)
+{
+    trail.resize(0);
+
+    for (int end=qMin(k+n, kmax); k<end; k++) {
+
+        WBParms snew = neighbour(s, k, kmax);
+        double Enew = series->cost(snew);
+        trail << QPair<WBParms, double>(snew, Enew);
+
+        // probability - always 1 if better, but randomly accept higher
+        double random = double(generator.bounded(101))/100.00f;
+        double temp = temperature(double(k)/double(kmax));
+        double prob = probability(E,Enew,temp);
+
+        if (prob > random) {
+            s = snew;
+            E = Enew;
+        }
+
+        // is it better than our very best?
+        if (E < Ebest) {
+            Ebest = E;
+            sbest = s;
+        }
+    }
+}
+
+double
+CPSolverChain::temperature(double alpha)
+{
+    return (1.0-(0.02*alpha));
+}
+
+double
+CPSolverChain::probability(double sold, double snew, double temperature)
+{
+    if(snew < sold ) return 1.0;
+    return(exp((sold - snew)/temperature));
+}
+
+//
+// CPSolverSearch
+//
+CPSolverSearch::CPSolverSearch(const CPSolverSeries *series, CPSolverConstraints constraints,
+                               int count, int kmax, quint32 seed) : k(0)
+{
+    if (count <= 0) count = TaskScheduler::instance().workerCount();
+    if (count <= 0) count = 1;
+
+    // share the iterations out
+    this->kmax = qMax(1, kmax / count);
+
+    for (int i=0; i<count; i++) {
+        CPSolverChain *chain = new CPSolverChain(series, constraints, seed + i);
+
+        // the first at the maximals as we always have, the rest anywhere
+        if (i == 0) chain->start(WBParms(constraints.cpto, constraints.wto, constraints.tto));
+        else chain->start(chain->random());
+
+        if (i == 0 || chain->Ebest < Ebest) {
+            sbest = chain->sbest;
+            Ebest = chain->Ebest;
+        }
+        chains << chain;
+    }
+}
+
+CPSolverSearch::~CPSolverSearch()
+{
+    qDeleteAll(chains);
+}
+
+bool
+CPSolverSearch::step()
+{
+    if (k >= kmax) return false;
+
+    int n = qMin(int(Epoch), kmax - k);
+    if (chains.count() == 1) {
+        chains[0]->run(k, n, kmax);
+    } else {
+        TaskGroup epoch;
+        foreach (CPSolverChain *chain, chains) epoch.run([chain, this, n]() { chain->run(k, n, kmax); });
+        epoch.wait();
+    }
+    k += n;
+
+    // best of all
+    foreach (CPSolverChain *chain, chains) {
+        if (chain->Ebest < Ebest) {
+            Ebest = chain->Ebest;
+            sbest = chain->sbest;
+        }
+    }
+
+    // the worse half carry on from there
+    QList<CPSolverChain*> ranked = chains;
+    std::sort(ranked.begin(), ranked.end(), [](const CPSolverChain *a, const CPSolverChain *b) { return a->E < b->E; });
+    for (int i=(ranked.count()+1)/2; i<ranked.count(); i++) ranked[i]->moveTo(sbest, Ebest);
+
+    return true;
+}
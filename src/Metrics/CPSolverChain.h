@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_CPSolverChain_h
+#define _GC_CPSolverChain_h 1
+
+#include <QList>
+#include <QVector>
+#include <QPair>
+#include <QRandomGenerator>
+
+//
+// The simulated annealing behind the CPSolver, kept apart from the rides
+// and the dialog so it can run on the task scheduler.
+//
+// CPSolverSeries holds the power leading up to each exhaustion point and
+// computes the cost of a set of parameters. The integral W'bal at the end of
+// a series is W' less the excess power over CP decayed back from the end, so
+// rather than an exp() per sample it is summed a block at a time against a
+// table of the decay across a block, with the blocks chained together by the
+// decay over a whole block. A table is prepared for every whole tau in the
+// constraints, the same tables for all the chains.
+//
+// CPSolverSearch runs a number of independent chains, each over its share of
+// the iterations, in epochs. Between epochs the worse half of the chains
+// carry on from the best solution found so far by any chain.
+//
+
+// W'bal parameters passed around as a set
+class WBParms {
+public:
+    WBParms() : CP(0), W(0), TAU(0) {}
+    WBParms(double CP, double W, double TAU) : CP(CP), W(W), TAU(TAU) {}
+    double CP, W, TAU; // the parameters
+    double wpbal; // the result (used to pass back)
+};
+
+class CPSolverConstraints {
+    public:
+    CPSolverConstraints() : cpf(100), cpto(500), wf(5000), wto(50000), tf(300), tto(700) { check(); }
+    CPSolverConstraints(int cpf, int cpto, int wf, int wto, int tf, int tto) :
+    cpf(cpf), cpto(cpto), wf(wf), wto(wto), tf(tf), tto(tto) { check(); }
+    int cpf, cpto, wf, wto, tf, tto;
+    int ccpf, ccpto, cwf, cwto; // configured bounds for selected rides
+
+    void setConfig(int ccpf, int ccpto, int cwf, int cwto) {
+        this->ccpf = ccpf;
+        this->ccpto = ccpto;
+        this->cwf = cwf;
+        this->cwto = cwto;
+    }
+
+    // swap if malformed
+    void check() {
+        if (cpf > cpto) { int t=cpto; cpto=cpf; cpf=t; }
+        if (wf > wto) { int t=wto; wto=wf; wf=t; }
+        if (tf > tto) { int t=tto; tto=tf; tf=t; }
+    }
+};
+
+class CPSolverSeries
+{
+    public:
+
+        static const int DecayBlock = 256;
+
+        CPSolverSeries() : integral(true), taufrom(0), tauto(-1) {}
+
+        void setIntegral(bool x) { integral = x; }
+        bool isIntegral() const { return integral; }
+
+        void add(const QVector<int> &watts) { data << watts; }
+        void clear() { data.clear(); tables.clear(); tauto = taufrom-1; }
+        int count() const { return data.count(); }
+        const QVector<int> &series(int i) const { return data[i]; }
+
+        // decay tables for each whole tau in the range
+        void prepare(int taufrom, int tauto);
+
+        // mean of the squared ending W'bal less 500, in kJ
+        double cost(const WBParms &parms) const;
+
+        // ending W'bal less 500 for one series
+        double compute(const QVector<int> &watts, const WBParms &parms) const;
+
+        // integral W'bal at the end of n samples, table as from decay()
+        static double integralWbal(const int *watts, int n, double CP, double W, const double *table);
+
+        // [j] the decay over DecayBlock-1-j secs, [DecayBlock] over a whole block
+        static void decay(double tau, double *table);
+
+    private:
+
+        bool integral;
+        QList<QVector<int> > data;
+
+        int taufrom, tauto;
+        QVector<double> tables;     // DecayBlock+1 for each tau
+};
+
+class CPSolverChain
+{
+    public:
+
+        CPSolverChain(const CPSolverSeries *series, CPSolverConstraints constraints, quint32 seed);
+
+        // begin at s
+        void start(WBParms s);
+
+        // carry on from another chain's solution
+        void moveTo(WBParms s, double E) { this->s = s; this->E = E; }
+
+        // iterations k to k+n-1 of kmax
+        void run(int k, int n, int kmax);
+
+        WBParms neighbour(WBParms, int k, int kmax);
+        WBParms random();
+
+        static double probability(double,double,double);
+        static double temperature(double);
+
+        WBParms s, sbest;
+        double E, Ebest;
+
+        // each evaluation in the last run, for the display
+        QVector<QPair<WBParms, double> > trail;
+
+    private:
+
+        const CPSolverSeries *series;
+        CPSolverConstraints constraints;
+        QRandomGenerator generator;
+};
+
+class CPSolverSearch
+{
+    public:
+
+        // chains of 0 is one for each worker thread
+        CPSolverSearch(const CPSolverSeries *series, CPSolverConstraints constraints,
+                       int chains, int kmax, quint32 seed);
+        ~CPSolverSearch();
+
+        // run the next epoch of all the chains, false once finished
+        bool step();
+
+        // evaluations so far, across all the chains
+        int iterations() const { return k * chains.count(); }
+
+        const QList<CPSolverChain*> &list() const { return chains; }
+        WBParms best() const { return sbest; }
+        double bestCost() const { return Ebest; }
+
+        static const int Epoch = 1000; // iterations of each chain between sharing
+
+    private:
+
+        QList<CPSolverChain*> chains;
+        int k, kmax;                // for each chain
+        WBParms sbest;
+        double Ebest;
+};
+#endif // _GC_CPSolverChain_h
@@ -25,6 +25,12 @@
 #include "Specification.h"
 
 #include "Banister.h"
+#include "MeanMaxIndex.h"
+#include "TaskScheduler.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
 
 Q_DECLARE_LOGGING_CATEGORY(gcEstimator)
 Q_LOGGING_CATEGORY(gcEstimator, "gc.estimator")
@@ -90,6 +96,7 @@ Estimator::Estimator(Context *context) : context(context)
 {
     // used to flag when we need to stop
     abort = false;
+    loaded = false;
 
     // lazy start signal
     connect(&singleshot, SIGNAL(timeout()), this, SLOT(calculate()));
@@ -147,58 +154,11 @@ Estimator::calculate()
     start();
 }
 
-// threaded code here
-void
-Estimator::run()
+// fit the models to the bests for six weeks, as we always have
+static QList<PDEstimate>
+fitEstimates(Context *context, QString sport, QDate begin, QDate end, QVector<float> bests, QVector<float> bestsWPK)
 {
-  bool first = true;
-
-  foreach (QString sport, GlobalContext::context()->rideMetadata->sports()) {
-
-    sport = RideFile::sportTag(sport); // Normalize sport name
-
-    printd("%s Estimates start.\n", sport.toStdString().c_str());
-
-    // this needs to be done once all the other metrics
-    // Calculate a *weekly* estimate of CP, W' etc using
-    // bests data from the previous 6 weeks
-    RollingBests bests(6);
-    RollingBests bestsWPK(6);
-
-    // clear any previous calculations
     QList<PDEstimate> est;
-    QList<Performance> perfs;
-
-    // we do this by aggregating power data into bests
-    // for each week, and having a rolling set of 6 aggregates
-    // then aggregating those up into a rolling 6 weeks 'bests'
-    // which we feed to the models to get the estimates for that
-    // point in time based upon the available data
-    QDate from, to;
-
-    // what dates have any power data ?
-    foreach(RideItem *item, rides) {
-
-        // has power and matches sport
-        if (item->present.contains("P") && item->sport == sport) {
-
-            // no date set
-            if (from == QDate()) from = item->dateTime.date();
-            if (to == QDate()) to = item->dateTime.date();
-
-            // later...
-            if (item->dateTime.date() < from) from = item->dateTime.date();
-
-            // earlier...
-            if (item->dateTime.date() > to) to = item->dateTime.date();
-        }
-    }
-
-    // if we don't have 2 rides or more then skip this
-    if (from == to || to == QDate()) {
-        printd("%s Estimator ends, less than 2 rides with power data.\n", sport.toStdString().c_str());
-        continue;
-    }
 
     // set up the models we support
     CP2Model p2model(context);
@@ -218,136 +178,380 @@ Estimator::run()
     models << &wsmodel;
 #endif
 
-    // from starts a week having first ride with Power data / looking at the next 7 days of data with Power
-    // calculate Estimates for all data per week including the week of the last Power recording
-    QDate date = from.addDays((1-from.dayOfWeek())); // Weeks start on monday in GC
-    while (date <= to) {
+    // we now have the data
+    foreach(PDModel *model, models) {
+
+        PDEstimate add;
+
+        // set the data
+        model->setData(bests);
+        model->saveParameters(add.parameters); // save the computed parms
+
+        add.sport = sport;
+        add.wpk = false;
+        add.from = begin;
+        add.to = end;
+        add.model = model->code();
+        add.WPrime = model->hasWPrime() ? model->WPrime() : 0;
+        add.CP = model->hasCP() ? model->CP() : 0;
+        add.PMax = model->hasPMax() ? model->PMax() : 0;
+        add.FTP = model->hasFTP() ? model->FTP() : 0;
+
+        if (add.CP && add.WPrime) add.EI = add.WPrime / add.CP ;
+
+        // so long as the important model derived values are sensible ...
+        if (add.WPrime > 1000 && add.CP > 100 && add.CP < 1000) {
+            printd("%s Estimates for %s - %s (%s): CP=%.f W'=%.f\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str(), add.CP, add.WPrime);
+            est << add;
+        } else {
+            printd("%s Estimates for %s - %s (%s): Not available\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str());
+        }
 
-        // check if we've been asked to stop
-        if (abort == true) {
-            printd("Model estimator aborted.\n");
-            abort = false;
-            return;
+        // set the wpk data
+        model->setData(bestsWPK);
+        model->saveParameters(add.parameters); // save the computed parms
+
+        add.wpk = true;
+        add.from = begin;
+        add.to = end;
+        add.model = model->code();
+        add.WPrime = model->hasWPrime() ? model->WPrime() : 0;
+        add.CP = model->hasCP() ? model->CP() : 0;
+        add.PMax = model->hasPMax() ? model->PMax() : 0;
+        add.FTP = model->hasFTP() ? model->FTP() : 0;
+        if (add.CP && add.WPrime) add.EI = add.WPrime / add.CP ;
+
+        // so long as the model derived values are sensible ...
+        if ((!model->hasWPrime() || add.WPrime > 10.0f) &&
+            (!model->hasCP() || (add.CP > 1.0f && add.CP < 10.0)) &&
+            (!model->hasPMax() || add.PMax > 1.0f) &&
+            (!model->hasFTP() || add.FTP > 1.0f)) {
+            printd("%s WPK Estimates for %s - %s (%s): CP=%.1f W'=%.1f\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str(), add.CP, add.WPrime);
+            est << add;
+        } else {
+            printd("%s WPK Estimates for %s - %s (%s): Not available\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str());
         }
+    }
+    return est;
+}
 
-        QDate begin = date;
-        QDate end = date.addDays(6);
+// threaded code here
+void
+Estimator::run()
+{
+    // weeks from the last run, from the cache at startup
+    if (!loaded) {
+        load();
+        loaded = true;
+    }
+
+    // the weeks for each sport with power data, weeks whose six weeks
+    // include a changed week are fitted in parallel once we have them all
+    struct Fitting {
+        QString sport;
+        QMap<QDate, Week> weeks;
+        QVector<QDate> refit;
+        QVector<bool> complete; // every week the refit used was complete
+        QVector<QList<PDEstimate> > results;
+    };
+    QList<Fitting*> fittings;
+    TaskGroup fits;
+
+    foreach (QString sport, GlobalContext::context()->rideMetadata->sports()) {
 
-        printd("%s Model progress %d/%d/%d\n", sport.toStdString().c_str(), date.year(), date.month(), date.day());
+        sport = RideFile::sportTag(sport); // Normalize sport name
 
-        // bests is a rolling 6 weeks sets of bests
-        QVector<float> wpk; // for getting the wpk values
+        printd("%s Estimates start.\n", sport.toStdString().c_str());
 
-        // include only rides or runs or ..........................................................vvvvv
-        QVector<QDate> weekdates;
-        QVector<float> week = RideFileCache::meanMaxPowerFor(context, wpk, begin, end, &weekdates, sport);
+        // this needs to be done once all the other metrics
+        // Calculate a *weekly* estimate of CP, W' etc using
+        // bests data from the previous 6 weeks
 
-        // lets extract the best performance of the week first.
-        // only care about performances between 3-20 minutes.
-        Performance bestperformance(end,0,0,0);
-        for (int t=240; t<week.length() && t<weekdates.length() && t<3600; t++) {
+        // we do this by aggregating power data into bests
+        // for each week, and having a rolling set of 6 aggregates
+        // then aggregating those up into a rolling 6 weeks 'bests'
+        // which we feed to the models to get the estimates for that
+        // point in time based upon the available data
+        QDate from, to;
 
-            double p = double(week[t]);
-            if (week[t]<=0) continue;
+        // what dates have any power data ?
+        // and which rides are in each week
+        QHash<QDate, quint64> signatures;
+        foreach(RideItem *item, rides) {
 
-            double pix = powerIndex(p, t, sport);
-            if (pix > bestperformance.powerIndex) {
-                bestperformance.duration = t;
-                bestperformance.power = p;
-                bestperformance.powerIndex = pix;
-                bestperformance.when = weekdates[t];
-                bestperformance.sport = sport;
+            if (item->sport != sport) continue;
 
-                // for filter, saves having to convert as we go
-                bestperformance.x = bestperformance.when.toJulianDay();
+            QDate date = item->dateTime.date();
+            QDate monday = date.addDays(1-date.dayOfWeek());
+            signatures[monday] = MeanMaxIndex::signature(signatures.value(monday), item);
+
+            // has power and matches sport
+            if (item->present.contains("P")) {
+
+                // no date set
+                if (from == QDate()) from = date;
+                if (to == QDate()) to = date;
+
+                // later...
+                if (date < from) from = date;
+
+                // earlier...
+                if (date > to) to = date;
             }
         }
-        if (bestperformance.duration > 0) perfs << bestperformance;
 
-        bests.addBests(week);
-        bestsWPK.addBests(wpk);
+        // if we don't have 2 rides or more then skip this
+        if (from == to || to == QDate()) {
+            printd("%s Estimator ends, less than 2 rides with power data.\n", sport.toStdString().c_str());
+            continue;
+        }
+
+        Fitting *fitting = new Fitting;
+        fitting->sport = sport;
+        fittings << fitting;
 
-        // we now have the data
-        foreach(PDModel *model, models) {
+        const QMap<QDate, Week> previous = weeks.value(sport);
+        QList<QDate> changed;
 
-            PDEstimate add;
+        // from starts a week having first ride with Power data / looking at the next 7 days of data with Power
+        // calculate Estimates for all data per week including the week of the last Power recording
+        QDate date = from.addDays((1-from.dayOfWeek())); // Weeks start on monday in GC
+        while (date <= to) {
 
-            // set the data
-            model->setData(bests.aggregate());
-            model->saveParameters(add.parameters); // save the computed parms
+            // check if we've been asked to stop
+            if (abort == true) {
+                printd("Model estimator aborted.\n");
+                qDeleteAll(fittings);
+                abort = false;
+                return;
+            }
 
-            add.sport = sport;
-            add.wpk = false;
-            add.from = begin;
-            add.to = end;
-            add.model = model->code();
-            add.WPrime = model->hasWPrime() ? model->WPrime() : 0;
-            add.CP = model->hasCP() ? model->CP() : 0;
-            add.PMax = model->hasPMax() ? model->PMax() : 0;
-            add.FTP = model->hasFTP() ? model->FTP() : 0;
+            QDate begin = date;
+            QDate end = date.addDays(6);
 
-            if (add.CP && add.WPrime) add.EI = add.WPrime / add.CP ;
+            // the bests for the week, unless the rides are the same as last time
+            Week week = previous.value(begin);
+            quint64 signature = signatures.value(begin);
+            if (reread(previous, begin, signature)) {
 
-            // so long as the important model derived values are sensible ...
-            if (add.WPrime > 1000 && add.CP > 100 && add.CP < 1000) {
-                printd("%s Estimates for %s - %s (%s): CP=%.f W'=%.f\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str(), add.CP, add.WPrime);
-                est << add;
-            } else {
-                printd("%s Estimates for %s - %s (%s): Not available\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str());
+                printd("%s Model progress %d/%d/%d\n", sport.toStdString().c_str(), date.year(), date.month(), date.day());
+
+                // include only rides or runs or .................................................vvvvv
+                week = Week();
+                week.signature = signature;
+                week.bests = RideFileCache::meanMaxPowerFor(context, week.wpk, begin, end, &week.dates, sport, &week.complete);
+                changed << begin;
             }
+            fitting->weeks.insert(begin, week);
 
-            // set the wpk data
-            model->setData(bestsWPK.aggregate());
-            model->saveParameters(add.parameters); // save the computed parms
-
-            add.wpk = true;
-            add.from = begin;
-            add.to = end;
-            add.model = model->code();
-            add.WPrime = model->hasWPrime() ? model->WPrime() : 0;
-            add.CP = model->hasCP() ? model->CP() : 0;
-            add.PMax = model->hasPMax() ? model->PMax() : 0;
-            add.FTP = model->hasFTP() ? model->FTP() : 0;
-            if (add.CP && add.WPrime) add.EI = add.WPrime / add.CP ;
-
-            // so long as the model derived values are sensible ...
-            if ((!model->hasWPrime() || add.WPrime > 10.0f) &&
-                (!model->hasCP() || (add.CP > 1.0f && add.CP < 10.0)) &&
-                (!model->hasPMax() || add.PMax > 1.0f) &&
-                (!model->hasFTP() || add.FTP > 1.0f)) {
-                printd("%s WPK Estimates for %s - %s (%s): CP=%.1f W'=%.1f\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str(), add.CP, add.WPrime);
-                est << add;
-            } else {
-                printd("%s WPK Estimates for %s - %s (%s): Not available\n", sport.toStdString().c_str(), add.from.toString().toStdString().c_str(), add.to.toString().toStdString().c_str(), add.model.toStdString().c_str());
+            // go forward a week
+            date = date.addDays(7);
+        }
+
+        // weeks that have gone, e.g. the first ride with power was deleted, are changes too
+        fitting->refit = refits(previous, fitting->weeks, changed);
+        fitting->results.resize(fitting->refit.count());
+        fitting->complete.fill(true, fitting->refit.count());
+
+        printd("%s %d of %d weeks to fit.\n", sport.toStdString().c_str(), fitting->refit.count(), fitting->weeks.count());
+
+        for (int i=0; i<fitting->refit.count(); i++) {
+
+            QDate begin = fitting->refit[i];
+            QDate end = begin.addDays(6);
+
+            RollingBests bests(6);
+            RollingBests bestsWPK(6);
+            for (QDate week = begin.addDays(-35); week <= begin; week = week.addDays(7)) {
+                if (!fitting->weeks.contains(week)) continue;
+                if (!fitting->weeks[week].complete) fitting->complete[i] = false;
+                bests.addBests(fitting->weeks[week].bests);
+                bestsWPK.addBests(fitting->weeks[week].wpk);
             }
 
+            QList<PDEstimate> *result = fitting->results.data() + i;
+            QVector<float> watts = bests.aggregate(), wpk = bestsWPK.aggregate();
+            fits.run([this, result, sport, begin, end, watts, wpk]() {
+                if (abort) return;
+                *result = fitEstimates(context, sport, begin, end, watts, wpk);
+            });
         }
+    }
 
-        // go forward a week
-        date = date.addDays(7);
+    // wait for the fitting to complete
+    fits.wait();
+    if (abort == true) {
+        printd("Model estimator aborted.\n");
+        qDeleteAll(fittings);
+        abort = false;
+        return;
     }
 
-    // filter performances
-    perfs = filter(perfs);
-
-    // now update them
-    lock.lock();
-    if (first) {
-        first = false;
-        estimates = est;
-        performances = perfs;
-    } else {
-        estimates.append(est);
-        performances.append(perfs);
+    bool first = true;
+    foreach(Fitting *fitting, fittings) {
+
+        QString sport = fitting->sport;
+        QList<PDEstimate> est;
+        QList<Performance> perfs;
+
+        for (int i=0; i<fitting->refit.count(); i++) {
+            Week &week = fitting->weeks[fitting->refit[i]];
+            week.estimates = fitting->results[i];
+
+            // fitted with bests that were missing rides, do it again next time
+            week.fitted = fitting->complete[i];
+        }
+
+        QMapIterator<QDate, Week> it(fitting->weeks);
+        while (it.hasNext()) {
+            it.next();
+
+            const Week &week = it.value();
+            QDate end = it.key().addDays(6);
+
+            // lets extract the best performance of the week first.
+            // only care about performances between 3-20 minutes.
+            Performance bestperformance(end,0,0,0);
+            for (int t=240; t<week.bests.length() && t<week.dates.length() && t<3600; t++) {
+
+                double p = double(week.bests[t]);
+                if (week.bests[t]<=0) continue;
+
+                double pix = powerIndex(p, t, sport);
+                if (pix > bestperformance.powerIndex) {
+                    bestperformance.duration = t;
+                    bestperformance.power = p;
+                    bestperformance.powerIndex = pix;
+                    bestperformance.when = week.dates[t];
+                    bestperformance.sport = sport;
+
+                    // for filter, saves having to convert as we go
+                    bestperformance.x = bestperformance.when.toJulianDay();
+                }
+            }
+            if (bestperformance.duration > 0) perfs << bestperformance;
+
+            est << week.estimates;
+        }
+        weeks.insert(sport, fitting->weeks);
+
+        // filter performances
+        perfs = filter(perfs);
+
+        // now update them
+        lock.lock();
+        if (first) {
+            first = false;
+            estimates = est;
+            performances = perfs;
+        } else {
+            estimates.append(est);
+            performances.append(perfs);
+        }
+        lock.unlock();
+
+        // debug dump peak performances
+        foreach(Performance p, performances) {
+            printd("%s %f Peak: %f for %f secs on %s\n", sport.toStdString().c_str(), p.powerIndex, p.power, p.duration, p.when.toString().toStdString().c_str());
+        }
+        printd("%s Estimates end.\n", sport.toStdString().c_str());
     }
-    lock.unlock();
+    qDeleteAll(fittings);
 
-    // debug dump peak performances
-    foreach(Performance p, performances) {
-        printd("%s %f Peak: %f for %f secs on %s\n", sport.toStdString().c_str(), p.powerIndex, p.power, p.duration, p.when.toString().toStdString().c_str());
+    // for next time
+    save();
+}
+
+//
+// Weeks are saved in the cache so a restart only needs to fit the
+// weeks that have changed since.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+//
+static const quint32 EstimatorCacheVersion = 1;
+
+void
+Estimator::load()
+{
+    QFile file(context->athlete->home->cache().canonicalPath() + "/estimator.bin");
+    if (!file.open(QFile::ReadOnly)) return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+
+    quint32 version, sports;
+    in >> version >> sports;
+    if (version != EstimatorCacheVersion) return;
+
+    QHash<QString, QMap<QDate, Week> > loading;
+    for (quint32 s=0; s<sports && in.status() == QDataStream::Ok; s++) {
+
+        QString sport;
+        quint32 count;
+        in >> sport >> count;
+
+        QMap<QDate, Week> &sportweeks = loading[sport];
+        for (quint32 w=0; w<count && in.status() == QDataStream::Ok; w++) {
+
+            QDate date;
+            Week week;
+            week.complete = true; // only complete weeks are saved
+            quint32 estimates;
+            in >> date >> week.signature >> week.bests >> week.wpk >> week.dates >> week.fitted >> estimates;
+
+            for (quint32 e=0; e<estimates && in.status() == QDataStream::Ok; e++) {
+                PDEstimate add;
+                in >> add.from >> add.to >> add.model >> add.WPrime >> add.CP >> add.FTP >> add.PMax >> add.EI
+                   >> add.wpk >> add.sport >> add.parameters;
+                week.estimates << add;
+            }
+            sportweeks.insert(date, week);
+        }
+    }
+
+    // all or nothing, its only a cache
+    if (in.status() == QDataStream::Ok) weeks = loading;
+}
+
+void
+Estimator::save()
+{
+    QSaveFile file(context->athlete->home->cache().canonicalPath() + "/estimator.bin");
+    if (!file.open(QFile::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+
+    out << EstimatorCacheVersion << quint32(weeks.count());
+    QHashIterator<QString, QMap<QDate, Week> > sports(weeks);
+    while (sports.hasNext()) {
+        sports.next();
+
+        // as MeanMaxIndex, weeks that were missing rides or fitted
+        // with them are used but not kept, they are computed again
+        QMap<QDate, Week> keep;
+        QMapIterator<QDate, Week> it(sports.value());
+        while (it.hasNext()) {
+            it.next();
+            if (it.value().complete && it.value().fitted) keep.insert(it.key(), it.value());
+        }
+
+        out << sports.key() << quint32(keep.count());
+        it = keep;
+        while (it.hasNext()) {
+            it.next();
+
+            const Week &week = it.value();
+            out << it.key() << week.signature << week.bests << week.wpk << week.dates << week.fitted
+                << quint32(week.estimates.count());
+            foreach(const PDEstimate &add, week.estimates)
+                out << add.from << add.to << add.model << add.WPrime << add.CP << add.FTP << add.PMax << add.EI
+                    << add.wpk << add.sport << add.parameters;
+        }
     }
-    printd("%s Estimates end.\n", sport.toStdString().c_str());
-  }
+    file.commit();
 }
 
 Performance Estimator::getPerformanceForDate(QDate date, QString sport)
@@ -67,6 +67,44 @@ class Estimator : public QThread {
         // filter marks performances as submax
         QList<Performance> filter(QList<Performance>);
 
+        // a week of bests for a sport, and the estimates fitted to the six
+        // weeks ending with it. Kept between runs (and saved in the cache)
+        // so only weeks that see a changed ride are fitted again
+        class Week {
+            public:
+                Week() : signature(0), fitted(false), complete(false) {}
+
+                quint64 signature;      // rides in the week
+                QVector<float> bests, wpk;
+                QVector<QDate> dates;
+                QList<PDEstimate> estimates;
+                bool fitted;
+                bool complete;          // bests had data for every ride
+        };
+
+        // a week's bests are read again when its rides have changed
+        // or they were missing rides last time
+        static bool reread(const QMap<QDate, Week> &previous, QDate week, quint64 signature) {
+            return !previous.contains(week) || previous[week].signature != signature || !previous[week].complete;
+        }
+
+        // weeks to fit again, bests are a rolling six weeks so a week that
+        // was read again, or has gone, changes the estimates for it and the
+        // next five weeks
+        static QVector<QDate> refits(const QMap<QDate, Week> &previous, const QMap<QDate, Week> &weeks, QList<QDate> changed) {
+            foreach(QDate week, previous.keys()) if (!weeks.contains(week)) changed << week;
+
+            QVector<QDate> returning;
+            QMapIterator<QDate, Week> it(weeks);
+            while (it.hasNext()) {
+                it.next();
+                bool refit = !it.value().fitted;
+                for (int k=0; k<6 && !refit; k++) if (changed.contains(it.key().addDays(-7*k))) refit = true;
+                if (refit) returning << it.key();
+            }
+            return returning;
+        }
+
     public slots:
 
         // setup and run estimators
@@ -89,6 +127,12 @@ class Estimator : public QThread {
         QTimer singleshot;
 
         bool abort;
+
+        QHash<QString, QMap<QDate, Week> > weeks; // by sport, then week commencing
+        bool loaded;
+
+        void load();
+        void save();
 };
 
 #endif
@@ -23,6 +23,7 @@
 #include "Context.h"
 #include "Athlete.h"
 #include "Specification.h"
+#include "ZoneEngine.h"
 #include <cmath>
 #include <assert.h>
 #include <QApplication>
@@ -61,14 +62,12 @@ public:
 
         // get zone ranges
         if (item->context->athlete->hrZones(item->sport) && item->hrZoneRange >= 0 && item->ride()->areDataPresent()->hr) {
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (item->context->athlete->hrZones(item->sport)->whichZone(item->hrZoneRange, point->hr) == level)
-                    seconds += item->ride()->recIntSecs();
-            }
+
+            // every zone is found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::hr,
+                                                   ZoneEngine::bounds(item->context->athlete->hrZones(item->sport), item->hrZoneRange));
+            seconds = level >= 0 && level < times.zones.count() ? times.zones[level] : 0;
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -782,16 +781,11 @@ public:
         // get zone ranges
         if (item->context->athlete->hrZones(item->sport) && item->hrZoneRange >= 0 && item->ride()->areDataPresent()->hr) {
 
-            int AeT = item->context->athlete->hrZones(item->sport)->getAeT(item->hrZoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->hr < AeT)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::hr,
+                                                   ZoneEngine::bounds(item->context->athlete->hrZones(item->sport), item->hrZoneRange));
+            seconds = times.polarized[0];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -846,17 +840,11 @@ public:
         // get zone ranges
         if (item->context->athlete->hrZones(item->sport) && item->hrZoneRange >= 0 && item->ride()->areDataPresent()->hr) {
 
-            int AeT = item->context->athlete->hrZones(item->sport)->getAeT(item->hrZoneRange);
-            int LT = item->context->athlete->hrZones(item->sport)->getLT(item->hrZoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->hr >= AeT && point->hr < LT)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::hr,
+                                                   ZoneEngine::bounds(item->context->athlete->hrZones(item->sport), item->hrZoneRange));
+            seconds = times.polarized[1];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -911,16 +899,11 @@ public:
         // get zone ranges
         if (item->context->athlete->hrZones(item->sport) && item->hrZoneRange >= 0 && item->ride()->areDataPresent()->hr) {
 
-            int LT = item->context->athlete->hrZones(item->sport)->getLT(item->hrZoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->hr >= LT)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::hr,
+                                                   ZoneEngine::bounds(item->context->athlete->hrZones(item->sport), item->hrZoneRange));
+            seconds = times.polarized[2];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
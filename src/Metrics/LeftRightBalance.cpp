@@ -25,7 +25,7 @@
 #include <cmath>
 #include <QApplication>
 
-class LeftRightBalance : public RideMetric {
+class LeftRightBalance : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(LeftRightBalance)
     double count, total;
 
@@ -46,25 +46,27 @@ class LeftRightBalance : public RideMetric {
         setDescription(tr("Left/Right Balance shows the proportion of power coming from each pedal for rides and the proportion of Ground Contact Time from each leg for runs."));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (((point->watts > 0.0f && point->cad) || (point->rcontact && point->rcad)) && point->lrbalance != RideFile::NA) {
-                total += point->lrbalance;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (((point->watts > 0.0f && point->cad) || (point->rcontact && point->rcad)) && point->lrbalance != RideFile::NA) {
+            total += point->lrbalance;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : 0);
         setCount(count);
     }
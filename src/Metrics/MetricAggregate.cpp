@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "MetricAggregate.h"
+
+#include <cmath>
+
+// sum of values, in four independent sums so the compiler can vectorise it
+static double sum(const double *values, int n)
+{
+    double s0=0, s1=0, s2=0, s3=0;
+    int i=0;
+    for (; i+4<=n; i+=4) {
+        s0 += values[i];
+        s1 += values[i+1];
+        s2 += values[i+2];
+        s3 += values[i+3];
+    }
+    for (; i<n; i++) s0 += values[i];
+    return (s0 + s1) + (s2 + s3);
+}
+
+// count weighted sum and sum of counts, zeroes only when aggZero
+static void weighted(const double *values, const double *counts, int n, bool aggZero, double &total, double &count)
+{
+    double t0=0, t1=0, c0=0, c1=0;
+    int i=0;
+    for (; i+2<=n; i+=2) {
+        double w0 = (aggZero || values[i]) ? counts[i] : 0;
+        double w1 = (aggZero || values[i+1]) ? counts[i+1] : 0;
+        t0 += values[i] * w0;
+        t1 += values[i+1] * w1;
+        c0 += w0;
+        c1 += w1;
+    }
+    for (; i<n; i++) {
+        double w = (aggZero || values[i]) ? counts[i] : 0;
+        t0 += values[i] * w;
+        c0 += w;
+    }
+    total += t0 + t1;
+    count += c0 + c1;
+}
+
+double
+MetricAggregate::aggregate(int type, const double *values, const double *counts, int n, bool aggZero)
+{
+    double rvalue = 0;
+
+    switch (type) {
+
+    case RunningTotal:
+    case Total:
+        return sum(values, n);
+
+    case Low:
+        for (int i=0; i<n; i++) if (values[i] < rvalue) rvalue = values[i];
+        return rvalue;
+
+    case Peak:
+        for (int i=0; i<n; i++) if (values[i] > rvalue) rvalue = values[i];
+        return rvalue;
+
+    case MeanSquareRoot:
+        {
+            // a running mean, each step depends on the last
+            double rcount = 0;
+            for (int i=0; i<n; i++) {
+                rvalue = sqrt((pow(rvalue, 2)*rcount + pow(values[i],2)*counts[i])/(rcount + counts[i]));
+                rcount += counts[i];
+            }
+            return rvalue;
+        }
+
+    default:
+    case Average:
+        {
+            // average should be calculated taking into account
+            // the duration of the ride, otherwise high value but
+            // short rides will skew the overall average
+            double rcount = 0;
+            weighted(values, counts, n, aggZero, rvalue, rcount);
+            return rcount ? rvalue / rcount : rvalue;
+        }
+    }
+}
+
+void
+MetricAggregate::grouped(int type, const double *values, const double *counts, const double *means,
+                         const int *groups, int n, bool aggZero, QVector<int> &keys, QVector<double> &results)
+{
+    keys.resize(0);
+    results.resize(0);
+
+    double secs=0;          // counts in the group so far
+    double ymean_prev=0;    // StdDev mean of the group so far
+
+    for (int i=0; i<n; i++) {
+
+        double value = values[i];
+        double seconds = counts[i];
+
+        // first in a new group
+        if (keys.isEmpty() || groups[i] > keys.last()) {
+            keys << groups[i];
+            results << value;
+            if (means) ymean_prev = means[i];
+
+            // only count if nonzero or we aggregate zeroes
+            secs = (value || aggZero) ? seconds : 0;
+            continue;
+        }
+
+        // sum totals, average averages and choose best for Peaks
+        double &y = results.last();
+        switch (type) {
+        case Total:
+            y += value;
+            break;
+        case RunningTotal:
+            // the trends chart always kept the first value in the group
+            break;
+        default:
+        case Average:
+            if (value || aggZero) y = ((y*secs)+(seconds*value)) / (secs+seconds);
+            break;
+        case Low:
+            if (value < y) y = value;
+            break;
+        case Peak:
+            if (value > y) y = value;
+            break;
+        case MeanSquareRoot:
+            if (value) y = sqrt((pow(y,2)*secs + pow(value,2)*seconds)/(secs+seconds));
+            break;
+        case StdDev:
+            if (value && means) {
+                // Combining two standard deviations using
+                // the formula:
+                //
+                //   sqrt(((n1-1)*S1^2+(n2-1)*S2^2+n1*(ymean_1-ymean)^2+n2*(ymean_2-ymean)^2)/(n1+n2))
+                //
+                // where:
+                //
+                //   ymean = (n1*ymean_1 + n2*ymean_2)/(n1+n2)
+                double ymean_next = means[i];
+                double ymean = (secs*ymean_prev + ymean_next*seconds)/(secs + seconds);
+
+                y = pow(y,2)*(secs-1) + pow(value,2)*(seconds-1);
+                y += pow(ymean_prev - ymean,2)*secs + pow(ymean_next - ymean,2)*seconds;
+                y /= (secs + seconds);
+                y = sqrt(y);
+
+                ymean_prev = ymean;
+            }
+            break;
+        }
+
+        // increment group counter if nonzero or we aggregate zeroes
+        if (value || aggZero) secs += seconds;
+    }
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_MetricAggregate_h
+#define _GC_MetricAggregate_h 1
+
+#include <QVector>
+
+//
+// Aggregating a metric across rides, over arrays of the values and counts
+// of the rides to include, as gathered from the RideCache metric matrix.
+//
+// aggregate() is the single value for a season that RideCache::getAggregate
+// returns, and grouped() the value for each day, week or month that the
+// trends chart plots. The arithmetic follows what those did ride by ride, so
+// they give the same answers; averages are weighted by the counts and only
+// include zero values when the metric aggregates zeroes.
+//
+class MetricAggregate
+{
+    public:
+
+        // the same values as RideMetric::MetricType
+        enum Type { Total=0, Average, Peak, Low, RunningTotal, MeanSquareRoot, StdDev };
+
+        // all n values, a count of zero leaves a value out of an average
+        static double aggregate(int type, const double *values, const double *counts, int n, bool aggZero);
+
+        // a result for each run of values with the same group, groups are in
+        // ascending order. means are the std means of each value and are only
+        // used by StdDev, they may be NULL for anything else. A RunningTotal
+        // is the first value in each group, as the trends chart had it.
+        static void grouped(int type, const double *values, const double *counts, const double *means,
+                            const int *groups, int n, bool aggZero, QVector<int> &keys, QVector<double> &results);
+};
+#endif // _GC_MetricAggregate_h
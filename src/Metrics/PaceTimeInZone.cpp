@@ -20,6 +20,7 @@
 #include "RideMetric.h"
 #include "RideItem.h"
 #include "Specification.h"
+#include "ZoneEngine.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "PaceZones.h"
@@ -66,14 +67,11 @@ class PaceZoneTime : public RideMetric {
 
         // get zone ranges
         if (zone && zoneRange >= 0) {
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (zone->whichZone(zoneRange, point->kph) == level)
-                    seconds += item->ride()->recIntSecs();
-            }
+
+            // every zone is found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::kph, ZoneEngine::bounds(zone, zoneRange));
+            seconds = level >= 0 && level < times.zones.count() ? times.zones[level] : 0;
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -797,16 +795,10 @@ class PaceZoneTimeI : public RideMetric {
         // get zone ranges
         if (zone && zoneRange >= 0) {
 
-            double AeT = zone->getAeT(zoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->kph < AeT)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::kph, ZoneEngine::bounds(zone, zoneRange));
+            seconds = times.polarized[0];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -866,17 +858,10 @@ class PaceZoneTimeII : public RideMetric {
         // get zone ranges
         if (zone && zoneRange >= 0) {
 
-            double AeT = zone->getAeT(zoneRange);
-            double CV = zone->getCV(zoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->kph >= AeT && point->kph < CV)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::kph, ZoneEngine::bounds(zone, zoneRange));
+            seconds = times.polarized[1];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -936,16 +921,10 @@ class PaceZoneTimeIII : public RideMetric {
         // get zone ranges
         if (zone && zoneRange >= 0) {
 
-            double CV = zone->getCV(zoneRange);
-
-            // iterate and compute
-            RideFileIterator it(item->ride(), spec);
-            while (it.hasNext()) {
-                struct RideFilePoint *point = it.next();
-                totalSecs += item->ride()->recIntSecs();
-                if (point->kph >= CV)
-                    seconds += item->ride()->recIntSecs();
-            }
+            // the polarized zones are found in the same pass, see ZoneEngine
+            ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::kph, ZoneEngine::bounds(zone, zoneRange));
+            seconds = times.polarized[2];
+            totalSecs = times.total;
         }
         setValue(seconds);
         setCount(totalSecs);
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "PeakEngine.h"
+
+#include <QMutexLocker>
+
+QMutex &
+PeakEngine::registryLock()
+{
+    static QMutex lock;
+    return lock;
+}
+
+QHash<int, QVector<double> > &
+PeakEngine::registry()
+{
+    static QHash<int, QVector<double> > windows;
+    return windows;
+}
+
+// engine in use by computeMetrics on this thread
+static thread_local PeakEngine *current = NULL;
+
+PeakEngine::PeakEngine(RideFile *ride, Specification spec) : ride(ride), spec(spec), start(-1), stop(-1)
+{
+    if (ride && ride->dataPoints().count()) {
+        RideFileIterator it(ride, spec);
+        start = it.firstIndex();
+        stop = it.lastIndex();
+    }
+}
+
+PeakEngine::~PeakEngine()
+{
+    if (current == this) current = NULL;
+}
+
+PeakEngine::Scope::Scope(PeakEngine *engine) : previous(current)
+{
+    current = engine;
+}
+
+PeakEngine::Scope::~Scope()
+{
+    current = previous;
+}
+
+void
+PeakEngine::registerWindow(RideFile::SeriesType series, bool byTime, double window)
+{
+    QMutexLocker locker(&registryLock());
+
+    QVector<double> &windows = registry()[key(series, byTime)];
+    if (!windows.contains(window)) windows << window;
+}
+
+bool
+PeakEngine::matches(RideFile *ride, Specification &spec) const
+{
+    return this->ride == ride && this->spec.secsStart() == spec.secsStart() && this->spec.secsEnd() == spec.secsEnd();
+}
+
+PeakEngine::Peak
+PeakEngine::peakFor(RideFile *ride, Specification spec, RideFile::SeriesType series, bool byTime, double window)
+{
+    if (current && current->matches(ride, spec)) return current->peak(series, byTime, window);
+
+    // not from computeMetrics, just do this one
+    PeakEngine engine(ride, spec);
+    QVector<double> windows;
+    windows << window;
+    return engine.peaks(series, byTime, windows).first();
+}
+
+PeakEngine::Peak
+PeakEngine::peak(RideFile::SeriesType series, bool byTime, double window)
+{
+    const QMap<double, Peak> &known = memo[key(series, byTime)];
+    QMap<double, Peak>::const_iterator it = known.find(window);
+    if (it != known.end()) return it.value();
+
+    // first time for this series, or a window nobody registered
+    QVector<double> windows;
+    if (known.isEmpty()) {
+        QMutexLocker locker(&registryLock());
+        windows = registry().value(key(series, byTime));
+    }
+    if (!windows.contains(window)) windows << window;
+
+    compute(series, byTime, windows);
+    return memo[key(series, byTime)].value(window);
+}
+
+QVector<PeakEngine::Peak>
+PeakEngine::peaks(RideFile::SeriesType series, bool byTime, const QVector<double> &windows)
+{
+    QMap<double, Peak> &known = memo[key(series, byTime)];
+
+    QVector<double> missing;
+    foreach(double window, windows)
+        if (!known.contains(window) && !missing.contains(window)) missing << window;
+    if (missing.count()) compute(series, byTime, missing);
+
+    QVector<Peak> returning;
+    foreach(double window, windows) returning << known.value(window);
+    return returning;
+}
+
+//
+// The single pass, a sliding window per requested size driven by the same
+// samples. Each window keeps its own running total and uses exactly the
+// same rules (and floating point operations) as AddIntervalDialog::findPeaks
+// so the results do not change, only the number of passes.
+//
+void
+PeakEngine::compute(RideFile::SeriesType series, bool byTime, QVector<double> windows)
+{
+    QMap<double, Peak> &known = memo[key(series, byTime)];
+
+    struct Window {
+        double size;
+        double total;
+        int first;
+        Peak best;
+    };
+
+    // not in scope, or too long for the ride (checked against the
+    // whole ride, not just the interval, as findPeaks does)
+    QVector<Window> work;
+    if (start >= 0 && stop >= start) {
+
+        const RideFilePoint *last = ride->dataPoints().last();
+        double secsDelta = ride->recIntSecs();
+
+        foreach(double window, windows) {
+            if (byTime && window > last->secs + secsDelta) continue;
+            if (!byTime && window > last->km*1000) continue;
+
+            Window add;
+            add.size = window;
+            add.total = 0;
+            add.first = start;
+            work << add;
+        }
+    }
+
+    if (work.count()) {
+
+        RideFileColumnsPtr columns = ride->columns(QList<RideFile::SeriesType>() << RideFile::secs << RideFile::km << series);
+        const double *secs = columns->column(RideFile::secs);
+        const double *km = columns->column(RideFile::km);
+        const double *values = columns->column(series);
+        double secsDelta = ride->recIntSecs();
+        double defaultValue = RideFileColumns::defaultValue(series);
+
+        for (int index=start; index <= stop; index++) {
+
+            double value = values ? values[index] : defaultValue;
+            double kmHere = km ? km[index] : 0;
+
+            for (int w=0; w<work.count(); w++) {
+                Window &window = work[w];
+
+                // discard samples until duration is < size + secsDelta,
+                // or distance from the second sample is < size
+                if (byTime) {
+                    while (window.first < index && (secs[index] - secs[window.first] + secsDelta) >= window.size + secsDelta) {
+                        window.total -= values ? values[window.first] : defaultValue;
+                        window.first++;
+                    }
+                } else {
+                    while ((index - window.first) > 1 && 1000*(kmHere - (km ? km[window.first+1] : 0)) >= window.size) {
+                        window.total -= values ? values[window.first] : defaultValue;
+                        window.first++;
+                    }
+                }
+
+                // add sample until duration or distance is >= size
+                window.total += value;
+                double duration = secs[index] - secs[window.first] + secsDelta;
+                double distance = 1000*(kmHere - (km ? km[window.first] : 0));
+
+                if ((byTime && duration >= window.size) || (!byTime && distance >= window.size)) {
+
+                    // highest average wins, earliest start for a tie
+                    double avg = window.total * secsDelta / duration;
+                    if (!window.best.found || avg > window.best.avg) {
+                        window.best.found = true;
+                        window.best.start = secs[window.first];
+                        window.best.stop = secs[index];
+                        window.best.avg = avg;
+                    }
+                }
+            }
+        }
+    }
+
+    // remember, including those that were not found
+    foreach(double window, windows) known.insert(window, Peak());
+    foreach(const Window &window, work) known.insert(window.size, window.best);
+}
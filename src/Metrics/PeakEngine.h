@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_PeakEngine_h
+#define _GC_PeakEngine_h 1
+#include "GoldenCheetah.h"
+
+#include <QHash>
+#include <QMap>
+#include <QVector>
+#include <QMutex>
+
+#include "RideFile.h"
+#include "Specification.h"
+
+//
+// Best average of a data series over a fixed time or distance window.
+//
+// The peak metrics (PeakPower, PeakPace, PeakHr, BestTime, W/kg) and the
+// peak interval discovery in RideItem used to call AddIntervalDialog::findPeaks
+// once each, walking the whole ride with a sliding window and sorting every
+// window it found, dozens of times per ride or interval.
+//
+// The engine walks the samples once per series and keeps a running total for
+// every window size that has been registered for that series, so all of the
+// durations (or distances) are found in a single pass. Results are memoised
+// for the lifetime of the engine. RideMetric::computeMetrics installs one for
+// each RideItem or interval it computes, so the metrics share the results.
+//
+// The arithmetic mirrors findPeaks with maxIntervals=1, so the averages and
+// start/stop of the peak are exactly the same as before.
+//
+class PeakEngine
+{
+    public:
+
+        struct Peak {
+            Peak() : found(false), start(0), stop(0), avg(0) {}
+            bool found;
+            double start, stop, avg;
+        };
+
+        PeakEngine(RideFile *ride, Specification spec);
+        ~PeakEngine();
+
+        // get the peak for a given window, computing all the windows
+        // registered for the series in the same pass if not known yet
+        Peak peak(RideFile::SeriesType series, bool byTime, double window);
+
+        // get peaks for a list of windows, in the same order
+        QVector<Peak> peaks(RideFile::SeriesType series, bool byTime, const QVector<double> &windows);
+
+        // metrics register the windows they will ask for when they are
+        // constructed so the first request computes them all at once
+        static void registerWindow(RideFile::SeriesType series, bool byTime, double window);
+
+        // used by metrics; uses the engine installed for this ride and
+        // specification on the calling thread, or a temporary one if none
+        static Peak peakFor(RideFile *ride, Specification spec, RideFile::SeriesType series, bool byTime, double window);
+
+        // install/remove as the engine for the calling thread
+        class Scope {
+            public:
+                Scope(PeakEngine *engine);
+                ~Scope();
+            private:
+                PeakEngine *previous;
+        };
+
+    private:
+
+        bool matches(RideFile *ride, Specification &spec) const;
+        void compute(RideFile::SeriesType series, bool byTime, QVector<double> windows);
+
+        static int key(RideFile::SeriesType series, bool byTime) { return (int(series) << 1) | (byTime ? 1 : 0); }
+
+        RideFile *ride;
+        Specification spec;
+        int start, stop; // sample index range in scope, -1 if empty
+
+        // memoised results by key() then window
+        QHash<int, QMap<double, Peak> > memo;
+
+        // registered windows by key(), function statics since metrics
+        // register from their constructors during static initialisation
+        static QMutex &registryLock();
+        static QHash<int, QVector<double> > &registry();
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "RideMetric.h"
 #include "RideItem.h"
 #include "AddIntervalDialog.h"
+#include "PeakEngine.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "Specification.h"
@@ -111,7 +112,7 @@ class PeakHr : public RideMetric {
     {
         setType(RideMetric::Peak);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::hr, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -123,7 +124,8 @@ class PeakHr : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::hr, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::hr, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0 && results.first().avg < 300) hr = results.first().avg;
         else hr = 0.0;
 
@@ -19,6 +19,7 @@
 
 #include "RideMetric.h"
 #include "AddIntervalDialog.h"
+#include "PeakEngine.h"
 #include "RideItem.h"
 #include "Context.h"
 #include "Athlete.h"
@@ -60,7 +61,7 @@ class PeakPace : public RideMetric {
     QString toString(double v) const {
         return time_to_string(v*60, true);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::kph, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -72,7 +73,8 @@ class PeakPace : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::kph, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0 && results.first().avg > 0 && results.first().avg < 36) pace = 60.0 / results.first().avg;
         else pace = 0.0;
 
@@ -410,7 +412,7 @@ class PeakPaceSwim : public RideMetric {
     QString toString(double v) const {
         return time_to_string(v*60, true);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::kph, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -422,7 +424,8 @@ class PeakPaceSwim : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::kph, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0 && results.first().avg > 0 && results.first().avg < 9) pace = 6.0 / results.first().avg;
         else pace = 0.0;
         setValue(pace);
@@ -746,7 +749,7 @@ class BestTime : public RideMetric {
     QString toString(double v) const {
         return time_to_string(v*60, true);
     }
-    void setMeters(double meters) { this->meters=meters; }
+    void setMeters(double meters) { this->meters=meters; PeakEngine::registerWindow(RideFile::kph, false, meters); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -758,7 +761,8 @@ class BestTime : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, false, item->ride(), spec, RideFile::kph, RideFile::original, meters, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::kph, false, meters);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0) secs = results.first().stop - results.first().start;
         else secs = 0.0;
 
@@ -1143,7 +1147,7 @@ class PeakPaceHr : public RideMetric {
     {
         setType(RideMetric::Peak);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::kph, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -1156,7 +1160,8 @@ class PeakPaceHr : public RideMetric {
 
         // find peak pace interval
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::kph, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::kph, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
 
         // work out average hr during that interval
         if (results.count() > 0) {
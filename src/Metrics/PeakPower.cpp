@@ -19,6 +19,7 @@
 #include "RideMetric.h"
 #include "RideItem.h"
 #include "AddIntervalDialog.h"
+#include "PeakEngine.h"
 #include "Context.h"
 #include "Athlete.h"
 #include "Specification.h"
@@ -284,7 +285,7 @@ class PeakPower : public RideMetric {
     {
         setType(RideMetric::Peak);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::watts, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -296,7 +297,8 @@ class PeakPower : public RideMetric {
         }
 
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::watts, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0 && results.first().avg < 3000) watts = results.first().avg;
         else watts = 0.0;
 
@@ -623,7 +625,7 @@ class PeakPowerHr : public RideMetric {
     {
         setType(RideMetric::Peak);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::watts, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -636,7 +638,8 @@ class PeakPowerHr : public RideMetric {
 
         // find peak power interval
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::watts, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
 
         // work out average hr during that interval
         if (results.count() > 0) {
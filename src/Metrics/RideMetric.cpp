@@ -20,11 +20,15 @@
 #include "RideItem.h"
 #include "IntervalItem.h"
 #include "Specification.h"
+#include "PeakEngine.h"
+#include "ZoneEngine.h"
 #include "UserMetricSettings.h"
 #include "TimeUtils.h"
 #include "Zones.h"
 #include "HrZones.h"
 
+#include <algorithm>
+
 // DB Schema Version - YOU MUST UPDATE THIS IF THE SCHEMA VERSION CHANGES!!!
 // Schema version will change if a) the default metadata.xml is updated
 //                            or b) new metrics are added / old changed
@@ -191,25 +195,147 @@ RideMetric::userMetricFingerprint(QList<UserMetricSettings> these)
     return qChecksum(fingers);
 }
 
+void
+RideMetricFactory::schedule(QVector<int> &order, QVector<QVector<int> > &deps) const
+{
+    QMutexLocker locker(&scheduleMutex);
+
+    if (!scheduled) {
+
+        int n = metricNames.count();
+
+        // dependencies by index, and who depends on each
+        QVector<QVector<int> > dependents(n);
+        QVector<int> waiting(n, 0);
+        scheduleDeps = QVector<QVector<int> >(n);
+        for (int i=0; i<n; i++) {
+            foreach(const QString &dep, dependencies(metricNames[i])) {
+                RideMetric *m = metrics.value(dep, NULL);
+                if (m == NULL) continue; // checkDependencies will complain
+                scheduleDeps[i] << m->index();
+                dependents[m->index()] << i;
+                waiting[i]++;
+            }
+        }
+
+        // a level at a time, those with no dependencies first
+        scheduleOrder.resize(0);
+        QVector<int> level;
+        for (int i=0; i<n; i++) if (waiting[i] == 0) level << i;
+        while (!level.isEmpty()) {
+            scheduleOrder += level;
+            QVector<int> next;
+            foreach(int i, level)
+                foreach(int j, dependents[i])
+                    if (--waiting[j] == 0) next << j;
+            std::sort(next.begin(), next.end());
+            level = next;
+        }
+
+        // a dependency loop, these will never be ready so
+        // they go last; checkDependencies will complain
+        if (scheduleOrder.count() < n)
+            for (int i=0; i<n; i++)
+                if (waiting[i] > 0) scheduleOrder << i;
+        scheduled = true;
+    }
+
+    // shared copies, cheap
+    order = scheduleOrder;
+    deps = scheduleDeps;
+}
+
+void
+AccumulatingMetric::compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps)
+{
+    if (!begin(item, spec, deps)) return;
+
+    RideFileIterator it(item->ride(), spec);
+    while (it.hasNext()) accumulate(it.next());
+    finalise();
+}
+
+// a metric has been computed
+static void
+completed(RideItem *item, Specification spec, RideMetric *m, QHash<QString,RideMetric*> &done, bool users)
+{
+    // override the computed value if set by user, but not for intervals
+    if (!spec.interval() && item->ride() && item->ride()->metricOverrides.contains(m->symbol()))
+        m->override(item->ride()->metricOverrides.value(m->symbol()));
+
+    // all computed add to the return list
+    done.insert(m->symbol(), m);
+
+    // put into value array too. user metrics will interrogate
+    // this for symbol values, rather than the metric pointer
+    // this is crucial, even though RideItem and IntervalItem both
+    // update their values directly. But only need to bother if the
+    // user has defined any local metrics.
+    if (users) {
+        if (spec.interval()) spec.interval()->metrics()[m->index()] = m->value();
+        else item->metrics()[m->index()] = m->value();
+    }
+}
+
+// one pass over the samples for all the accumulators waiting on it
+static void
+accumulate(RideItem *item, Specification spec, QVector<AccumulatingMetric*> &pending, QVector<char> &waiting,
+           QHash<QString,RideMetric*> &done, bool users)
+{
+    if (pending.isEmpty()) return;
+
+    AccumulatingMetric * const *ms = pending.constData();
+    int n = pending.count();
+
+    RideFileIterator it(item->ride(), spec);
+    while (it.hasNext()) {
+        const RideFilePoint *point = it.next();
+        for (int i=0; i<n; i++) ms[i]->accumulate(point);
+    }
+
+    foreach(AccumulatingMetric *m, pending) {
+        m->finalise();
+        waiting[m->index()] = 0;
+        completed(item, spec, m, done, users);
+    }
+    pending.resize(0);
+}
+
 QHash<QString,RideMetricPtr>
 RideMetric::computeMetrics(RideItem *item, Specification spec, const QStringList &metrics)
 {
     const RideMetricFactory &factory = RideMetricFactory::instance();
 
-    // generate worklist from metrics we know
-    // bear in mind this can change as users add
-    // and remove user metrics
-    // builtin User metrics are computed after builtins
+    // every metric after its dependencies, this changes
+    // as users add and remove user metrics
+    QVector<int> order;
+    QVector<QVector<int> > deps;
+    factory.schedule(order, deps);
+
+    // the metrics asked for and all they depend upon
+    // User metrics are computed after builtins, in the order asked,
     // since they don't have explicit dependencies set, yet.
-    QStringList builtin;
+    QVector<char> wanted(factory.metricCount(), 0);
+    QVector<int> todo;
     QStringList user;
-    foreach(QString metric, metrics)
-        if (factory.haveMetric(metric)) {
-            if (factory.rideMetric(metric)->isUser())
-                user << metric;
-            else
-                builtin << metric;
+    foreach(QString metric, metrics) {
+        if (!factory.haveMetric(metric)) continue;
+
+        const RideMetric *m = factory.rideMetric(metric);
+        if (m->isUser()) {
+            if (!wanted[m->index()]) user << metric;
+            wanted[m->index()] = 1;
+        } else {
+            todo << m->index();
         }
+    }
+    while (!todo.isEmpty()) {
+        int i = todo.takeLast();
+        if (wanted[i]) continue;
+        wanted[i] = 1;
+        todo += deps[i];
+    }
+    bool users = !user.isEmpty();
 
     // this is what we've completed as we go
     QHash<QString,RideMetric*> done;
@@ -222,64 +348,59 @@ RideMetric::computeMetrics(RideItem *item, Specification spec, const QStringList
     if (!spec.interval() && item->metrics().size() < factory.metricCount())
         item->metrics().resize(factory.metricCount());
 
-    // working through the todo list...
-    while (!builtin.isEmpty() || !user.isEmpty()) {
+    // the peak metrics share one pass over the samples per series
+    // (the ride is already open, don't open it here if it isn't)
+    PeakEngine peaks(item->ride(false), spec);
+    PeakEngine::Scope peakScope(&peaks);
 
-        // next one to do, builtins first then user defined
-        QString symbol = builtin.isEmpty() ? user.takeFirst() :
-                                             builtin.takeFirst();
+    // and the time in zone metrics one classification of each series
+    ZoneEngine zones(item->ride(false), spec);
+    ZoneEngine::Scope zoneScope(&zones);
 
-        // doesn't exist !
-        if (!factory.haveMetric(symbol)) continue;
+    // accumulators wait for the next pass over the samples, which is
+    // made when a metric needs one of them or when we're done
+    QVector<AccumulatingMetric*> pending;
+    QVector<char> waiting(factory.metricCount(), 0);
 
-        // does this one have any dependencies?
-        const QVector<QString> &deps = factory.dependencies(symbol);
+    foreach(int i, order) {
 
-        bool ready = true;
+        const QString &symbol = factory.metricName(i);
+        if (!wanted[i] || factory.rideMetric(symbol)->isUser()) continue;
 
-        // if the dependencies aren't done yet add to the end of the list
-        foreach (QString dep, deps) {
-            if (!done.contains(dep)) {
-                ready = false;
-                if (!builtin.contains(dep))
-                    builtin.append(dep);
+        foreach(int dep, deps[i]) {
+            if (waiting[dep]) {
+                accumulate(item, spec, pending, waiting, done, users);
+                break;
             }
         }
 
-        // if all our depencies are computed we can do this one
-        if (ready) {
-
-            // we clone so we can remain thread safe
-            // do not be tempted to change this (!)
-            RideMetric *m = factory.newMetric(symbol);
-            m->setValue(0.0);
-            m->setCount(0);
-            m->compute(item, spec, done);
-
-            // override the computed value if set by user, but not for intervals
-            if (!spec.interval() && item->ride() && item->ride()->metricOverrides.contains(symbol))
-                m->override(item->ride()->metricOverrides.value(symbol));
-
-            // all computed add to the return list
-            done.insert(symbol, m);
-
-            // put into value array too. user metrics will interrogate
-            // this for symbol values, rather than the metric pointer
-            // this is crucial, even though RideItem and IntervalItem both
-            // update their values directly. But only need to bother if the
-            // user has defined any local metrics.
-            if (user.count()) {
-                if (spec.interval()) spec.interval()->metrics()[m->index()] = m->value();
-                else item->metrics()[m->index()] = m->value();
+        // we clone so we can remain thread safe
+        // do not be tempted to change this (!)
+        RideMetric *m = factory.newMetric(symbol);
+        m->setValue(0.0);
+        m->setCount(0);
+
+        if (m->isAccumulator()) {
+            AccumulatingMetric *a = static_cast<AccumulatingMetric*>(m);
+            if (a->begin(item, spec, done)) {
+                pending << a;
+                waiting[i] = 1;
+                continue;
             }
-
         } else {
-
-            // we need to wait for our dependencies so add
-            // to the back of the list 
-            if (!builtin.contains(symbol))
-                builtin.append(symbol);
+            m->compute(item, spec, done);
         }
+        completed(item, spec, m, done, users);
+    }
+    accumulate(item, spec, pending, waiting, done, users);
+
+    // then the user metrics
+    foreach(QString symbol, user) {
+        RideMetric *m = factory.newMetric(symbol);
+        m->setValue(0.0);
+        m->setCount(0);
+        m->compute(item, spec, done);
+        completed(item, spec, m, done, users);
     }
 
     // lets prepate the results using a shared pointer
@@ -28,6 +28,7 @@
 #include <QDebug>
 #include <QMutex>
 #include <QList>
+#include <QSet>
 
 #include "RideFile.h"
 #include "UserMetricSettings.h"
@@ -165,6 +166,9 @@ public:
     // Compute the ride metric from a file.
     virtual void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps) = 0;
 
+    // is computed sample by sample, see AccumulatingMetric below
+    virtual bool isAccumulator() const { return false; }
+
     // is a time value, ie. render as hh:mm:ss
     virtual bool isTime() const { return false; }
 
@@ -256,6 +260,34 @@ public:
         MetricType type_;
 };
 
+//
+// A metric computed in one pass over the samples, in order.
+//
+// Rather than iterate over the samples itself it is handed each sample in
+// turn, so computeMetrics can compute all of them from a single pass over
+// the ride instead of a pass each. begin() is called first, once all the
+// dependencies have been computed, and returns false when there is nothing
+// to accumulate (the value has already been set, e.g. there is no data).
+// Then accumulate() is called for every sample in the specification and
+// finally finalise() sets the value and count.
+//
+// Metrics that need random access to the samples, or more than one pass
+// over them, implement compute() instead.
+//
+class AccumulatingMetric : public RideMetric {
+
+public:
+
+    bool isAccumulator() const { return true; }
+
+    virtual bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps) = 0;
+    virtual void accumulate(const RideFilePoint *point) = 0;
+    virtual void finalise() = 0;
+
+    // when computed on its own it makes its own pass
+    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps);
+};
+
 
 //
 // The interface between a UserMetric and the codebase
@@ -367,7 +399,14 @@ private:
     QHash<QString,QVector<QString>*> dependencyMap;
     bool dependenciesChecked;
 
-    RideMetricFactory() : dependenciesChecked(false) {}
+    // the computation order, worked out when first needed
+    // and again after metrics are added or removed
+    mutable QMutex scheduleMutex;
+    mutable bool scheduled;
+    mutable QVector<int> scheduleOrder;
+    mutable QVector<QVector<int> > scheduleDeps;
+
+    RideMetricFactory() : dependenciesChecked(false), scheduled(false) {}
     RideMetricFactory(const RideMetricFactory &other);
     RideMetricFactory &operator=(const RideMetricFactory &other);
 
@@ -377,10 +416,24 @@ private:
             foreach(const QString &dependency, *dependencyMap[dependee])
                 if (!metrics.contains(dependency))
                     qDebug()<<"metric dep error:"<<dependency;
+            QSet<QString> seen;
+            if (dependsOn(dependee, dependee, seen))
+                qDebug()<<"metric dep loop:"<<dependee;
         }
         const_cast<RideMetricFactory*>(this)->dependenciesChecked = true;
     }
 
+    // does symbol depend upon dependency, directly or through others
+    bool dependsOn(const QString &symbol, const QString &dependency, QSet<QString> &seen) const {
+        foreach(const QString &dep, dependencies(symbol)) {
+            if (dep == dependency) return true;
+            if (seen.contains(dep)) continue;
+            seen.insert(dep);
+            if (dependsOn(dep, dependency, seen)) return true;
+        }
+        return false;
+    }
+
     public:
 
     QMutex mutex;
@@ -434,6 +487,7 @@ private:
                 metricNames.takeAt(firstUser);
                 metricTypes.remove(firstUser);
             }
+            unschedule();
         }
     }
 
@@ -445,6 +499,7 @@ private:
         metrics.insert(metric.symbol(), newMetric);
         metricNames.append(metric.symbol());
         metricTypes.append(metric.type());
+        unschedule();
         if (deps) {
             QVector<QString> *copy = new QVector<QString>;
             for (int i = 0; i < deps->size(); ++i)
@@ -460,6 +515,15 @@ private:
         QVector<QString> *result = dependencyMap.value(symbol);
         return result ? *result : noDeps;
     }
+
+    // the index of every metric, ordered so each comes after the metrics
+    // it depends upon, and the indexes of the dependencies of each metric
+    void schedule(QVector<int> &order, QVector<QVector<int> > &deps) const;
+
+    void unschedule() {
+        QMutexLocker locker(&scheduleMutex);
+        scheduled = false;
+    }
 };
 
 #endif // _GC_RideMetric_h
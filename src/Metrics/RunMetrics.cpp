@@ -31,7 +31,7 @@
 #include <QVector>
 #include <QApplication>
 
-struct AvgRunCadence : public RideMetric {
+struct AvgRunCadence : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgRunCadence)
 
     double total, count;
@@ -52,29 +52,30 @@ struct AvgRunCadence : public RideMetric {
         setDescription(tr("Average Running Cadence, computed when Cadence > 0"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->cad > 0) {
-                total += point->cad;
-                ++count;
-            } else if (point->rcad > 0) {
-                total += point->rcad;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad > 0) {
+            total += point->cad;
+            ++count;
+        } else if (point->rcad > 0) {
+            total += point->rcad;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : count);
         setCount(count);
     }
@@ -91,11 +92,12 @@ static bool avgRunCadenceAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-class MaxRunCadence : public RideMetric {
+class MaxRunCadence : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(MaxRunCadence)
+    double max;
     public:
 
-    MaxRunCadence()
+    MaxRunCadence() : max(0.0)
     {
         setSymbol("max_run_cadence");
         setInternalName("Max Running Cadence");
@@ -109,24 +111,25 @@ class MaxRunCadence : public RideMetric {
         setDescription(tr("Maximum Running Cadence"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
-        double max = 0.0;
+        max = 0.0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            if (point->cad > max) max = point->cad;
-            if (point->rcad > max) max = point->rcad;
-        }
+    void accumulate(const RideFilePoint *point) {
+        if (point->cad > max) max = point->cad;
+        if (point->rcad > max) max = point->rcad;
+    }
 
+    void finalise() {
         setValue(max);
     }
 
@@ -142,7 +145,7 @@ static bool maxRunCadenceAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgRunGroundContactTime : public RideMetric {
+struct AvgRunGroundContactTime : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgRunGroundContactTime)
 
     double total, count;
@@ -163,26 +166,27 @@ struct AvgRunGroundContactTime : public RideMetric {
         setDescription(tr("Average Ground Contact Time"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->rcontact > 0) {
-                total += point->rcontact;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rcontact > 0) {
+            total += point->rcontact;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : count);
         setCount(count);
     }
@@ -199,7 +203,7 @@ static bool avgRunGroundContactTimeAdded =
 
 //////////////////////////////////////////////////////////////////////////////
 
-struct AvgRunVerticalOscillation  : public RideMetric {
+struct AvgRunVerticalOscillation  : public AccumulatingMetric {
     Q_DECLARE_TR_FUNCTIONS(AvgRunVerticalOscillation)
 
     double total, count;
@@ -222,26 +226,27 @@ struct AvgRunVerticalOscillation  : public RideMetric {
         setDescription(tr("Average Vertical Oscillation"));
     }
 
-    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
+    bool begin(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         // no ride or no samples
         if (spec.isEmpty(item->ride())) {
             setValue(RideFile::NIL);
             setCount(0);
-            return;
+            return false;
         }
 
         total = count = 0;
+        return true;
+    }
 
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-
-            if (point->rvert > 0) {
-                total += point->rvert;
-                ++count;
-            }
+    void accumulate(const RideFilePoint *point) {
+        if (point->rvert > 0) {
+            total += point->rvert;
+            ++count;
         }
+    }
+
+    void finalise() {
         setValue(count > 0 ? total / count : count);
         setCount(count);
     }
@@ -23,6 +23,7 @@
 #include "Athlete.h"
 #include "Specification.h"
 #include "Zones.h"
+#include "ZoneEngine.h"
 #include <cmath>
 #include <assert.h>
 #include <QApplication>
@@ -57,19 +58,12 @@ class ZoneTime : public RideMetric {
             return;
         }
 
-        double totalSecs = 0.0;
-        seconds = 0;
-
-        // iterate and compute
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            totalSecs += item->ride()->recIntSecs();
-            if (item->context->athlete->zones(item->sport)->whichZone(item->zoneRange, point->watts) == level)
-                seconds += item->ride()->recIntSecs();
-        }
+        // every zone is found in the same pass, see ZoneEngine
+        ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::watts,
+                                               ZoneEngine::bounds(item->context->athlete->zones(item->sport), item->zoneRange));
+        seconds = level >= 0 && level < times.zones.count() ? times.zones[level] : 0;
         setValue(seconds);
-        setCount(totalSecs);
+        setCount(times.total);
     }
 
     MetricClass classification() const { return Undefined; }
@@ -759,20 +753,12 @@ class ZoneTimeI : public RideMetric {
             return;
         }
 
-        int AeT = item->context->athlete->zones(item->sport)->getAeT(item->zoneRange);
-        double totalSecs = 0.0;
-        seconds = 0;
-
-        // iterate and compute
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            totalSecs += item->ride()->recIntSecs();
-            if (point->watts < AeT)
-                seconds += item->ride()->recIntSecs();
-        }
+        // the polarized zones are found in the same pass, see ZoneEngine
+        ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::watts,
+                                               ZoneEngine::bounds(item->context->athlete->zones(item->sport), item->zoneRange));
+        seconds = times.polarized[0];
         setValue(seconds);
-        setCount(totalSecs);
+        setCount(times.total);
     }
 
     MetricClass classification() const { return Undefined; }
@@ -818,21 +804,12 @@ class ZoneTimeII : public RideMetric {
             return;
         }
 
-        int AeT = item->context->athlete->zones(item->sport)->getAeT(item->zoneRange);
-        int CP = item->context->athlete->zones(item->sport)->getCP(item->zoneRange);
-        double totalSecs = 0.0;
-        seconds = 0;
-
-        // iterate and compute
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            totalSecs += item->ride()->recIntSecs();
-            if (point->watts >= AeT && point->watts < CP)
-                seconds += item->ride()->recIntSecs();
-        }
+        // the polarized zones are found in the same pass, see ZoneEngine
+        ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::watts,
+                                               ZoneEngine::bounds(item->context->athlete->zones(item->sport), item->zoneRange));
+        seconds = times.polarized[1];
         setValue(seconds);
-        setCount(totalSecs);
+        setCount(times.total);
     }
 
     MetricClass classification() const { return Undefined; }
@@ -878,20 +855,12 @@ class ZoneTimeIII : public RideMetric {
             return;
         }
 
-        int CP = item->context->athlete->zones(item->sport)->getCP(item->zoneRange);
-        double totalSecs = 0.0;
-        seconds = 0;
-
-        // iterate and compute
-        RideFileIterator it(item->ride(), spec);
-        while (it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            totalSecs += item->ride()->recIntSecs();
-            if (point->watts >= CP)
-                seconds += item->ride()->recIntSecs();
-        }
+        // the polarized zones are found in the same pass, see ZoneEngine
+        ZoneTimes times = ZoneEngine::timesFor(item->ride(), spec, RideFile::watts,
+                                               ZoneEngine::bounds(item->context->athlete->zones(item->sport), item->zoneRange));
+        seconds = times.polarized[2];
         setValue(seconds);
-        setCount(totalSecs);
+        setCount(times.total);
     }
 
     MetricClass classification() const { return Undefined; }
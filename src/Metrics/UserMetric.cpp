@@ -237,32 +237,20 @@ UserMetric::compute(RideItem *item, Specification spec, const QHash<QString,Ride
     //qDebug()<<"BEFORE";
     if (!spec.isEmpty(item->ride()) && fbefore) {
         RideFileIterator it(item->ride(), spec, RideFileIterator::Before);
-
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fbefore, Result(0), 0, const_cast<RideItem*>(item), point, c, spec);
-        }
+        root->evalSamples(rt, fbefore, it, const_cast<RideItem*>(item), c, spec);
     }
 
     //qDebug()<<"SAMPLE";
     // process samples, if there are any and a function exists
     if (!spec.isEmpty(item->ride()) && fsample) {
         RideFileIterator it(item->ride(), spec);
-
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fsample, Result(0), 0, const_cast<RideItem*>(item), point, c, spec);
-        }
+        root->evalSamples(rt, fsample, it, const_cast<RideItem*>(item), c, spec);
     }
 
     //qDebug()<<"AFTER";
     if (!spec.isEmpty(item->ride()) && fafter) {
         RideFileIterator it(item->ride(), spec, RideFileIterator::After);
-
-        while(it.hasNext()) {
-            struct RideFilePoint *point = it.next();
-            root->eval(rt, fafter, Result(0), 0, const_cast<RideItem*>(item), point, c, spec);
-        }
+        root->evalSamples(rt, fafter, it, const_cast<RideItem*>(item), c, spec);
     }
 
 
@@ -52,6 +52,7 @@
 #include "RideItem.h"
 #include "Units.h" // for MILES_PER_KM
 #include "Settings.h" // for GC_WBALFORM
+#include "ZoneEngine.h"
 
 #include <qwt_spline_cubic.h> // smoothing
 
@@ -90,13 +91,13 @@ WPrime::WPrime()
 {
     // XXX will need to reset metrics when they are added
     minY = maxY = 0;
-    wasIntegral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    wasIntegral = (GSettingsSnapshot::value(GCK_WBALFORM) == "int");
 }
 
 void
 WPrime::check()
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    bool integral = (GSettingsSnapshot::value(GCK_WBALFORM) == "int");
     if (integral == wasIntegral) return;
     else if (rideFile) {
         wasIntegral = integral;
@@ -108,7 +109,7 @@ WPrime::check()
 void
 WPrime::setRide(RideFile *input)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    bool integral = (GSettingsSnapshot::value(GCK_WBALFORM) == "int");
 
     QElapsedTimer time; // for profiling performance of the code
     time.start();
@@ -377,7 +378,7 @@ WPrime::setRide(RideFile *input)
 void
 WPrime::setWatts(Context *context, QVector<int>&wattsArray, int CP, int WPRIME)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    bool integral = (GSettingsSnapshot::value(GCK_WBALFORM) == "int");
 
     QElapsedTimer time; // for profiling performance of the code
     time.start();
@@ -407,7 +408,7 @@ WPrime::setWatts(Context *context, QVector<int>&wattsArray, int CP, int WPRIME)
             if (value >= CP) EXP += value; // total expenditure above CP
         }
 
-        TAU = appsettings->cvalue(context->athlete->cyclist, GC_WBALTAU, 300).toInt();
+        TAU = GSettingsSnapshot::cvalue(context->athlete->cyclist, GCK_WBALTAU);
 
         // lets run forward from 0s to end of ride
         values.resize(last+1);
@@ -471,7 +472,7 @@ WPrime::setWatts(Context *context, QVector<int>&wattsArray, int CP, int WPRIME)
 void
 WPrime::setErg(ErgFile *input)
 {
-    bool integral = (appsettings->value(NULL, GC_WBALFORM, "int").toString() == "int");
+    bool integral = (GSettingsSnapshot::value(GCK_WBALFORM) == "int");
 
     QElapsedTimer time; // for profiling performance of the code
     time.start();
@@ -521,7 +522,7 @@ WPrime::setErg(ErgFile *input)
             if (value >= CP) EXP += value; // total expenditure above CP
         }
 
-        TAU = appsettings->cvalue(input->context->athlete->cyclist, GC_WBALTAU, 300).toInt();
+        TAU = GSettingsSnapshot::cvalue(input->context->athlete->cyclist, GCK_WBALTAU);
 
         // lets run forward from 0s to end of ride
         values.resize(last+1);
@@ -1060,31 +1061,12 @@ class WZoneTime : public RideMetric {
     bool isTime() const { return true; }
     void setLevel(int level) { this->level=level-1; } // zones start from zero not 1
 
-    void compute(RideItem *item, Specification, const QHash<QString,RideMetric*> &) {
+    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
         double WPRIME = item->zoneRange >= 0 ? item->context->athlete->zones(item->sport)->getWprime(item->zoneRange) : 20000;
 
-        // 4 zones
-        QVector<double> tiz(4);
-        tiz.fill(0.0f);
-
-        if (item->ride()->wprimeData() && item->ride()->wprimeData()->ydata().count()) {
-
-            foreach(int value, item->ride()->wprimeData()->ydata()) {
-
-                // percent is PERCENT OF W' USED
-                double percent = 100.0f - ((double (value) / WPRIME) * 100.0f);
-                if (percent < 0.0f) percent = 0.0f;
-                if (percent > 100.0f) percent = 100.0f;
-
-                // and zones in 1s increments
-                if (percent <= 25.0f) tiz[0]++;
-                else if (percent <= 50.0f) tiz[1]++;
-                else if (percent <= 75.0f) tiz[2]++;
-                else tiz[3]++;
-            }
-
-        } 
+        // 4 zones, all found in the same pass, see ZoneEngine
+        QVector<double> tiz = ZoneEngine::wbalFor(item->ride(), spec, WPRIME);
         setValue(tiz[level]);
     }
 
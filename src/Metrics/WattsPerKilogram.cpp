@@ -18,6 +18,7 @@
 
 #include "RideMetric.h"
 #include "AddIntervalDialog.h"
+#include "PeakEngine.h"
 #include "RideItem.h"
 #include "Zones.h"
 #include "Context.h"
@@ -78,7 +79,7 @@ class PeakWPK : public RideMetric {
         setImperialUnits(tr("w/kg"));
         setPrecision(2);
     }
-    void setSecs(double secs) { this->secs=secs; }
+    void setSecs(double secs) { this->secs=secs; PeakEngine::registerWindow(RideFile::watts, true, secs); }
 
     void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &) {
 
@@ -91,7 +92,8 @@ class PeakWPK : public RideMetric {
 
         weight = item->ride()->getWeight();
         QList<AddIntervalDialog::AddedInterval> results;
-        AddIntervalDialog::findPeaks(item->context, true, item->ride(), spec, RideFile::watts, RideFile::original, secs, 1, results, "", "");
+        PeakEngine::Peak peak = PeakEngine::peakFor(item->ride(), spec, RideFile::watts, true, secs);
+        if (peak.found) results << AddIntervalDialog::AddedInterval(peak.start, peak.stop, peak.avg);
         if (results.count() > 0 && results.first().avg < 3000) wpk = results.first().avg / weight;
         else wpk = 0.0;
         setValue(wpk);
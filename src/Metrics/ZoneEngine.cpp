@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ZoneEngine.h"
+#include "Zones.h"
+#include "HrZones.h"
+#include "PaceZones.h"
+#include "WPrime.h"
+
+// engine in use by computeMetrics on this thread
+static thread_local ZoneEngine *current = NULL;
+
+ZoneEngine::ZoneEngine(RideFile *ride, Specification spec) : ride(ride), spec(spec), start(-1), stop(-1)
+{
+    if (ride && ride->dataPoints().count()) {
+        RideFileIterator it(ride, spec);
+        start = it.firstIndex();
+        stop = it.lastIndex();
+    }
+}
+
+ZoneEngine::~ZoneEngine()
+{
+    if (current == this) current = NULL;
+}
+
+ZoneEngine::Scope::Scope(ZoneEngine *engine) : previous(current)
+{
+    // keep one already installed for the same ride and specification,
+    // so its classification is shared with whoever installed it
+    if (!(current && current->matches(engine->ride, engine->spec))) current = engine;
+}
+
+ZoneEngine::Scope::~Scope()
+{
+    current = previous;
+}
+
+bool
+ZoneEngine::matches(RideFile *ride, Specification &spec) const
+{
+    return this->ride == ride && this->spec.secsStart() == spec.secsStart() && this->spec.secsEnd() == spec.secsEnd();
+}
+
+const ZoneTimes &
+ZoneEngine::times(RideFile::SeriesType series, const ZoneBounds &bounds)
+{
+    for (int i=0; i<memo.count(); i++)
+        if (memo[i].series == series && memo[i].bounds == bounds) return memo[i].times;
+
+    Memo add;
+    add.series = series;
+    add.bounds = bounds;
+
+    if (start >= 0 && stop >= start) {
+        RideFileColumnsPtr columns = ride->columns(QList<RideFile::SeriesType>() << series);
+        const double *values = columns->column(series);
+        int n = stop - start + 1;
+
+        if (values) {
+            add.times = ZoneHistogram::classify(values + start, n, ride->recIntSecs(), bounds);
+        } else {
+            QVector<double> missing(n, RideFileColumns::defaultValue(series));
+            add.times = ZoneHistogram::classify(missing.constData(), n, ride->recIntSecs(), bounds);
+        }
+    } else {
+        add.times.zones.fill(0, bounds.lo.count());
+    }
+
+    memo << add;
+    return memo.last().times;
+}
+
+const QVector<double> &
+ZoneEngine::wbal(double WPRIME)
+{
+    for (int i=0; i<wbalMemo.count(); i++)
+        if (wbalMemo[i].first == WPRIME) return wbalMemo[i].second;
+
+    QVector<double> values;
+    if (ride && ride->wprimeData()) values = ride->wprimeData()->ydata();
+
+    wbalMemo << QPair<double, QVector<double> >(WPRIME, ZoneHistogram::wbal(values, WPRIME));
+    return wbalMemo.last().second;
+}
+
+ZoneTimes
+ZoneEngine::timesFor(RideFile *ride, Specification spec, RideFile::SeriesType series, const ZoneBounds &bounds)
+{
+    if (current && current->matches(ride, spec)) return current->times(series, bounds);
+
+    // not from computeMetrics, just do this one
+    ZoneEngine engine(ride, spec);
+    return engine.times(series, bounds);
+}
+
+QVector<double>
+ZoneEngine::wbalFor(RideFile *ride, Specification spec, double WPRIME)
+{
+    if (current && current->matches(ride, spec)) return current->wbal(WPRIME);
+
+    ZoneEngine engine(ride, spec);
+    return engine.wbal(WPRIME);
+}
+
+//
+// Zone boundaries, the polarized ones are AeT and CP/LT/CV
+//
+ZoneBounds
+ZoneEngine::bounds(const Zones *zones, int range)
+{
+    ZoneBounds returning;
+    if (zones == NULL || range < 0) return returning;
+
+    foreach(int lo, zones->getZoneLows(range)) returning.lo << lo;
+    foreach(int hi, zones->getZoneHighs(range)) returning.hi << hi;
+    returning.aet = zones->getAeT(range);
+    returning.threshold = zones->getCP(range);
+    returning.zero = 1;
+    return returning;
+}
+
+ZoneBounds
+ZoneEngine::bounds(const HrZones *zones, int range)
+{
+    ZoneBounds returning;
+    if (zones == NULL || range < 0) return returning;
+
+    foreach(int lo, zones->getZoneLows(range)) returning.lo << lo;
+    foreach(int hi, zones->getZoneHighs(range)) returning.hi << hi;
+    returning.aet = zones->getAeT(range);
+    returning.threshold = zones->getLT(range);
+    returning.zero = 1;
+    return returning;
+}
+
+ZoneBounds
+ZoneEngine::bounds(const PaceZones *zones, int range)
+{
+    ZoneBounds returning;
+    if (zones == NULL || range < 0) return returning;
+
+    returning.lo = zones->getZoneLows(range).toVector();
+    returning.hi = zones->getZoneHighs(range).toVector();
+    returning.aet = zones->getAeT(range);
+    returning.threshold = zones->getCV(range);
+    returning.zero = 0.1;
+    return returning;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_ZoneEngine_h
+#define _GC_ZoneEngine_h 1
+#include "GoldenCheetah.h"
+
+#include <QList>
+#include <QVector>
+
+#include "RideFile.h"
+#include "Specification.h"
+#include "ZoneHistogram.h"
+
+class Zones;
+class HrZones;
+class PaceZones;
+
+//
+// Time in zone for a ride, shared by the time in zone metrics.
+//
+// There are 26 or so time in zone metrics each for power, HR and pace, and
+// each one used to walk the whole ride calling whichZone() for every sample
+// to find the time in just its own zone. The engine classifies the samples
+// of a series once with ZoneHistogram and keeps the result, so all of them
+// (and the polarized ones) come from a single pass. RideMetric::computeMetrics
+// installs one for each RideItem or interval it computes, as with PeakEngine.
+// RideItem::refresh installs one around the .cpx refresh and the metrics, so
+// the time in zone for the cache and the metrics are classified once.
+//
+class ZoneEngine
+{
+    public:
+
+        ZoneEngine(RideFile *ride, Specification spec);
+        ~ZoneEngine();
+
+        // time in zone for the samples of a series in scope
+        const ZoneTimes &times(RideFile::SeriesType series, const ZoneBounds &bounds);
+
+        // W'bal time in zone, for the whole ride
+        const QVector<double> &wbal(double WPRIME);
+
+        // the boundaries of a zone range
+        static ZoneBounds bounds(const Zones *zones, int range);
+        static ZoneBounds bounds(const HrZones *zones, int range);
+        static ZoneBounds bounds(const PaceZones *zones, int range);
+
+        // used by metrics; uses the engine installed for this ride and
+        // specification on the calling thread, or a temporary one if none
+        static ZoneTimes timesFor(RideFile *ride, Specification spec, RideFile::SeriesType series, const ZoneBounds &bounds);
+        static QVector<double> wbalFor(RideFile *ride, Specification spec, double WPRIME);
+
+        // install/remove as the engine for the calling thread, unless
+        // one for the same ride and specification is already installed
+        class Scope {
+            public:
+                Scope(ZoneEngine *engine);
+                ~Scope();
+            private:
+                ZoneEngine *previous;
+        };
+
+    private:
+
+        bool matches(RideFile *ride, Specification &spec) const;
+
+        RideFile *ride;
+        Specification spec;
+        int start, stop; // sample index range in scope, -1 if empty
+
+        // memoised results
+        struct Memo {
+            RideFile::SeriesType series;
+            ZoneBounds bounds;
+            ZoneTimes times;
+        };
+        QList<Memo> memo;
+        QList<QPair<double, QVector<double> > > wbalMemo;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "ZoneHistogram.h"
+
+ZoneTimes
+ZoneHistogram::classify(const double *values, int n, double secs, const ZoneBounds &bounds)
+{
+    ZoneTimes returning;
+
+    int zones = qMin(bounds.lo.count(), bounds.hi.count());
+    const double *lo = bounds.lo.constData();
+    const double *hi = bounds.hi.constData();
+    const double aet = bounds.aet;
+    const double threshold = bounds.threshold;
+    const double zero = bounds.zero;
+
+    // counts, the polarized ones are branch free
+    QVector<int> counts(zones);
+    int *zcount = counts.data();
+    int p0=0, p1=0, p2=0;
+    int c0=0, c1=0, c2=0, c3=0;
+
+    for (int i=0; i<n; i++) {
+        const double v = values[i];
+
+        // note: the "end" of range is actually in the next zone,
+        // negative, nan, inf or way high are in no zone at all
+        for (int j=0; j<zones; j++) {
+            if (v >= lo[j] && v < hi[j]) {
+                zcount[j]++;
+                break;
+            }
+        }
+
+        // I(<AeT), II (>=AeT and <threshold), III (>=threshold)
+        const int belowAeT = v < aet;
+        const int belowThreshold = v < threshold;
+        p0 += belowAeT;
+        p1 += (v >= aet) & belowThreshold;
+        p2 += v >= threshold;
+
+        // zero, then I, II, III, in that order and anything else is III
+        const int isZero = v < zero;
+        const int notZero = 1 - isZero;
+        c0 += isZero;
+        c1 += notZero & belowAeT;
+        c2 += notZero & (1 - belowAeT) & belowThreshold;
+        c3 += notZero & (1 - belowAeT) & (1 - belowThreshold);
+    }
+
+    returning.zones.resize(zones);
+    for (int j=0; j<zones; j++) returning.zones[j] = zcount[j] * secs;
+    returning.polarized[0] = p0 * secs;
+    returning.polarized[1] = p1 * secs;
+    returning.polarized[2] = p2 * secs;
+    returning.cp[0] = c0 * secs;
+    returning.cp[1] = c1 * secs;
+    returning.cp[2] = c2 * secs;
+    returning.cp[3] = c3 * secs;
+    returning.total = n * secs;
+    return returning;
+}
+
+QVector<double>
+ZoneHistogram::wbal(const QVector<double> &values, double WPRIME)
+{
+    int tiz[4] = { 0, 0, 0, 0 };
+
+    foreach(int value, values) {
+
+        // percent is PERCENT OF W' USED
+        double percent = 100.0f - ((double (value) / WPRIME) * 100.0f);
+        if (percent < 0.0f) percent = 0.0f;
+        if (percent > 100.0f) percent = 100.0f;
+
+        // and zones in 1s increments
+        if (percent <= 25.0f) tiz[0]++;
+        else if (percent <= 50.0f) tiz[1]++;
+        else if (percent <= 75.0f) tiz[2]++;
+        else tiz[3]++;
+    }
+    return QVector<double>() << tiz[0] << tiz[1] << tiz[2] << tiz[3];
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_ZoneHistogram_h
+#define _GC_ZoneHistogram_h 1
+
+#include <QVector>
+
+//
+// Time in zone for a series of samples, every zone at once.
+//
+// The zone boundaries of a range (power, HR or pace) are copied into flat
+// arrays, then each sample is classified once and counted into its zone, the
+// polarized zones the time in zone metrics use, and the polarized zones the
+// RideFileCache keeps (which have a separate zone for zero). The rules are the
+// same as whichZone() and the comparisons the metrics and cache made, so the
+// times only change in how the seconds are summed: counts of samples are
+// multiplied by the sample interval once at the end.
+//
+
+// boundaries of the zones in a zone range
+struct ZoneBounds
+{
+    ZoneBounds() : aet(0), threshold(0), zero(0) {}
+
+    QVector<double> lo, hi;     // a sample is in the first zone where lo <= value < hi
+    double aet, threshold;      // polarized I below aet, II up to threshold, III above
+    double zero;                // the cache counts samples below this as zero
+
+    bool operator==(const ZoneBounds &other) const {
+        return lo == other.lo && hi == other.hi && aet == other.aet &&
+               threshold == other.threshold && zero == other.zero;
+    }
+};
+
+// seconds in each zone
+struct ZoneTimes
+{
+    ZoneTimes() : total(0) {
+        polarized[0] = polarized[1] = polarized[2] = 0;
+        cp[0] = cp[1] = cp[2] = cp[3] = 0;
+    }
+
+    QVector<double> zones;      // as ZoneBounds
+    double polarized[3];        // I, II and III as the time in zone metrics
+    double cp[4];               // zero, I, II and III as the RideFileCache
+    double total;               // all samples
+};
+
+class ZoneHistogram
+{
+    public:
+
+        // n samples secs apart, in a single pass
+        static ZoneTimes classify(const double *values, int n, double secs, const ZoneBounds &bounds);
+
+        // W'bal in 4 zones of percent of W' used, 1s samples
+        static QVector<double> wbal(const QVector<double> &values, double WPRIME);
+};
+#endif // _GC_ZoneHistogram_h
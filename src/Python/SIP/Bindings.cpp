@@ -26,6 +26,7 @@
 
 #undef slots
 #include <datetime.h> // for Python datetime macros
+#include "sipAPIgoldencheetah.h" // to hand back a PythonDataSeries in a dict
 #define slots Q_SLOTS
 
 long Bindings::threadid() const
@@ -607,6 +608,13 @@ Bindings::series(int type, PyObject* activity, int compareindex) const
         editedRideFiles->append(f);
     }
 
+    // stored series are shared straight from the ride's columns
+    if (pCount && RideFileColumns::isStored(seriesType)) {
+        RideFileColumnsPtr columns = f->columns(QList<RideFile::SeriesType>() << seriesType);
+        if (columns->isPresent(seriesType) && it.firstIndex() + pCount <= columns->count())
+            return new PythonDataSeries(seriesName(type), columns->array(seriesType), it.firstIndex(), pCount, readOnly, seriesType, f);
+    }
+
     PythonDataSeries* ds = new PythonDataSeries(seriesName(type), pCount, readOnly, seriesType, f);
     it.toFront();
     for(int i=0; i<pCount && it.hasNext(); i++) {
@@ -639,10 +647,7 @@ Bindings::activityWbal(PyObject* activity, int compareindex) const
         if (pCount == 0) idxStart = i;
         pCount++;
     }
-    PythonDataSeries* ds = new PythonDataSeries("WBal", pCount);
-    for(int i=0; i<pCount; i++) ds->data[i] = w->ydata()[i+idxStart];
-
-    return ds;
+    return new PythonDataSeries("WBal", w->ydata(), idxStart, pCount);
 }
 
 // get the xdata series for the currently selected ride
@@ -777,38 +782,6 @@ Bindings::seriesPresent(int type, PyObject* activity, int compareindex) const
     return f->isDataPresent(static_cast<RideFile::SeriesType>(type));
 }
 
-PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count, bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile)
-    : name(name), count(count), data(NULL), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile)
-{
-    if (count > 0) data = new double[count];
-}
-
-PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count) : name(name), count(count), data(NULL),
-    readOnly(true), seriesType(RideFile::none), rideFile(NULL)
-{
-    if (count > 0) data = new double[count];
-}
-
-// default constructor and copy constructor
-PythonDataSeries::PythonDataSeries() : name(QString()), count(0), data(NULL),
-    readOnly(true), seriesType(RideFile::none), rideFile(NULL) {}
-PythonDataSeries::PythonDataSeries(PythonDataSeries *clone)
-{
-    if (clone) *this = *clone;
-    else {
-        name = QString();
-        count = 0;
-        data = NULL;
-    }
-}
-
-PythonDataSeries::~PythonDataSeries()
-{
-    if (data) delete[] data;
-    data=NULL;
-    rideFile = NULL;
-}
-
 PythonXDataSeries::PythonXDataSeries(QString xdata, QString series, QString unit, int count, bool readOnly, RideFile *rideFile)
     : xdata(xdata), series(series), colIdx(-1), unit(unit), readOnly(readOnly), rideFile(rideFile), shape(1), data(count)
 {
@@ -1041,7 +1014,7 @@ Bindings::activityMetrics(RideItem* item) const
 }
 
 PyObject*
-Bindings::seasonMetrics(bool all, QString filter, bool compare) const
+Bindings::seasonMetrics(bool all, QString filter, bool compare, bool series) const
 {
     Context *context = python->contexts.value(threadid()).context;
     if (context == NULL) return NULL;
@@ -1072,7 +1045,7 @@ Bindings::seasonMetrics(bool all, QString filter, bool compare) const
                 const CompareDateRange &p = checked[idx];
 
                 // create a tuple (metrics, color)
-                PyObject* sm = seasonMetrics(all, DateRange(p.start, p.end), filter);
+                PyObject* sm = seasonMetrics(all, DateRange(p.start, p.end), filter, series);
                 PyObject* tuple = Py_BuildValue("(Os)", sm, p.color.name().toUtf8().constData());
                 Py_DECREF(sm);
                 // add to back and move on
@@ -1088,7 +1061,7 @@ Bindings::seasonMetrics(bool all, QString filter, bool compare) const
 
             // create a tuple (metrics, color)
             DateRange range = context->currentDateRange();
-            PyObject* sm = seasonMetrics(all, range, filter);
+            PyObject* sm = seasonMetrics(all, range, filter, series);
             PyObject* tuple = Py_BuildValue("(Os)", sm, "#FF00FF");
             Py_DECREF(sm);
             // add to back and move on
@@ -1101,12 +1074,12 @@ Bindings::seasonMetrics(bool all, QString filter, bool compare) const
 
         // just a dict of metrics
         DateRange range = context->currentDateRange();
-        return seasonMetrics(all, range, filter);
+        return seasonMetrics(all, range, filter, series);
     }
 }
 
 PyObject*
-Bindings::seasonMetrics(bool all, DateRange range, QString filter) const
+Bindings::seasonMetrics(bool all, DateRange range, QString filter, bool series) const
 {
     Context *context = python->contexts.value(threadid()).context;
     if (context == NULL || context->athlete == NULL || context->athlete->rideCache == NULL) return NULL;
@@ -1204,16 +1177,15 @@ Bindings::seasonMetrics(bool all, DateRange range, QString filter) const
         name = name.replace(" ","_");
         name = name.replace("'","_");
 
-        // set a list of metric values
-        PyObject* metriclist = PyList_New(rides);
-
+        // gather the metric values into one array
+        QVector<double> values(rides);
         for (int idx = 0; idx < rides; idx++) {
             RideItem *item = snapshot[idx];
-            PyList_SET_ITEM(metriclist, idx, PyFloat_FromDouble(item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion()) + (useMetricUnits ? 0.0f : metric->conversionSum())));
+            values[idx] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion()) + (useMetricUnits ? 0.0f : metric->conversionSum());
         }
 
-        // add to the dict
-        PyDict_SetItemString_Steal(dict, name.toUtf8().constData(), metriclist);
+        // add to the dict, a list unless asked for series
+        PyDict_SetItemString_Steal(dict, name.toUtf8().constData(), valueList(name, values, series));
     }
 
     //
@@ -1872,7 +1844,7 @@ Bindings::metrics(QString metric, bool all, QString filter) const
 }
 
 PyObject*
-Bindings::activityMeanmax(bool compare) const
+Bindings::activityMeanmax(bool compare, bool series) const
 {
     Context *context = python->contexts.value(threadid()).context;
     if (context == NULL) return NULL;
@@ -1901,7 +1873,7 @@ Bindings::activityMeanmax(bool compare) const
                 const CompareInterval &p = checked[idx];
 
                 // create a tuple (meanmax, color)
-                PyObject* am = activityMeanmax(p.rideItem);
+                PyObject* am = activityMeanmax(p.rideItem, series);
                 PyObject* tuple = Py_BuildValue("(Os)", am, p.color.name().toUtf8().constData());
                 Py_DECREF(am);
                 PyList_SET_ITEM(list, idx, tuple);
@@ -1914,7 +1886,7 @@ Bindings::activityMeanmax(bool compare) const
             if (context->currentRideItem()==NULL) return NULL;
             PyObject* list = PyList_New(1);
 
-            PyObject* am = activityMeanmax(context->currentRideItem());
+            PyObject* am = activityMeanmax(context->currentRideItem(), series);
             PyObject* tuple = Py_BuildValue("(Os)", am, "#FF00FF");
             Py_DECREF(am);
             PyList_SET_ITEM(list, 0, tuple);
@@ -1926,12 +1898,12 @@ Bindings::activityMeanmax(bool compare) const
         // not compare, so just return a dict
         RideItem *item = python->contexts.value(threadid()).item;
         if (item == NULL) item = const_cast<RideItem*>(context->currentRideItem());
-        return activityMeanmax(item);
+        return activityMeanmax(item, series);
     }
 }
 
 PyObject*
-Bindings::seasonMeanmax(bool all, QString filter, bool compare) const
+Bindings::seasonMeanmax(bool all, QString filter, bool compare, bool series) const
 {
     Context *context = python->contexts.value(threadid()).context;
     if (context == NULL) return NULL;
@@ -1962,7 +1934,7 @@ Bindings::seasonMeanmax(bool all, QString filter, bool compare) const
                 const CompareDateRange &p = checked[idx];
 
                 // create a tuple (meanmax, color)
-                PyObject* sm = seasonMeanmax(all, DateRange(p.start, p.end), filter);
+                PyObject* sm = seasonMeanmax(all, DateRange(p.start, p.end), filter, series);
                 PyObject* tuple = Py_BuildValue("(Os)", sm, p.color.name().toUtf8().constData());
                 Py_DECREF(sm);
                 // add to back and move on
@@ -1978,7 +1950,7 @@ Bindings::seasonMeanmax(bool all, QString filter, bool compare) const
 
             // create a tuple (meanmax, color)
             DateRange range = context->currentDateRange();
-            PyObject* sm = seasonMeanmax(all, range, filter);
+            PyObject* sm = seasonMeanmax(all, range, filter, series);
             PyObject* tuple = Py_BuildValue("(Os)", sm, "#FF00FF");
             Py_DECREF(sm);
             // add to back and move on
@@ -1992,12 +1964,12 @@ Bindings::seasonMeanmax(bool all, QString filter, bool compare) const
         // just a datafram of meanmax
         DateRange range = context->currentDateRange();
 
-        return seasonMeanmax(all, range, filter);
+        return seasonMeanmax(all, range, filter, series);
     }
 }
 
 PyObject*
-Bindings::seasonMeanmax(bool all, DateRange range, QString filter) const
+Bindings::seasonMeanmax(bool all, DateRange range, QString filter, bool series) const
 {
     Context *context = python->contexts.value(threadid()).context;
     if (context == NULL) return NULL;
@@ -2025,17 +1997,17 @@ Bindings::seasonMeanmax(bool all, DateRange range, QString filter) const
     // RideFileCache for a date range with our filters (if any)
     RideFileCache cache(context, range.from, range.to, filt, filelist, true, NULL);
 
-    return rideFileCacheMeanmax(&cache);
+    return rideFileCacheMeanmax(&cache, series);
 }
 
 PyObject*
-Bindings::activityMeanmax(const RideItem* item) const
+Bindings::activityMeanmax(const RideItem* item, bool series) const
 {
-    return rideFileCacheMeanmax(const_cast<RideItem*>(item)->fileCache());
+    return rideFileCacheMeanmax(const_cast<RideItem*>(item)->fileCache(), series);
 }
 
 PyObject*
-Bindings::rideFileCacheMeanmax(RideFileCache* cache) const
+Bindings::rideFileCacheMeanmax(RideFileCache* cache, bool series) const
 {
     if (PyDateTimeAPI == NULL) PyDateTime_IMPORT;// import datetime if necessary
 
@@ -2047,30 +2019,28 @@ Bindings::rideFileCacheMeanmax(RideFileCache* cache) const
     //
     // Now we need to add lists to the ans dict...
     //
-    foreach(RideFile::SeriesType series, cache->meanMaxList()) {
+    foreach(RideFile::SeriesType type, cache->meanMaxList()) {
 
-        QVector <double> values = cache->meanMaxArray(series);
+        QVector <double> values = cache->meanMaxArray(type);
 
         // don't add empty ones but we always add power
-        if (series != RideFile::watts && values.count()==0) continue;
-
+        if (type != RideFile::watts && values.count()==0) continue;
 
-        // set a list
-        PyObject* list = PyList_New(values.count());
 
         // will have different sizes e.g. when a daterange
         // since longest ride with e.g. power may be different
         // to longest ride with heartrate
-        for(int j=0; j<values.count(); j++) PyList_SET_ITEM(list, j, PyFloat_FromDouble(values[j]));
+        QString name = RideFile::seriesName(type, true);
+        PyObject* list = valueList(name, values, series);
 
         // add to the dict
-        PyDict_SetItemString_Steal(ans, RideFile::seriesName(series, true).toUtf8().constData(), list);
+        PyDict_SetItemString_Steal(ans, name.toUtf8().constData(), list);
 
         // if is power add the dates
-        if(series == RideFile::watts) {
+        if(type == RideFile::watts) {
 
             // dates
-            QVector<QDate> dates = cache->meanMaxDates(series);
+            QVector<QDate> dates = cache->meanMaxDates(type);
             PyObject* datelist = PyList_New(dates.count());
             // will have different sizes e.g. when a daterange
             // since longest ride with e.g. power may be different
@@ -2553,3 +2523,21 @@ Bindings::PyDict_SetItemString_Steal
     Py_DECREF(val);
     return ret;
 }
+
+PyObject*
+Bindings::dataSeries(PythonDataSeries *ds) const
+{
+    return sipConvertFromNewType(ds, sipType_PythonDataSeries, NULL);
+}
+
+PyObject*
+Bindings::valueList(QString name, QVector<double> values, bool series) const
+{
+    // shares the array, writing to it from a script copies it first
+    if (series) return dataSeries(new PythonDataSeries(name, values, 0, values.count(), false));
+
+    // scripts append to and slice these, so by default a list of floats
+    PyObject* list = PyList_New(values.count());
+    for(int j=0; j<values.count(); j++) PyList_SET_ITEM(list, j, PyFloat_FromDouble(values[j]));
+    return list;
+}
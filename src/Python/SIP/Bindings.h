@@ -18,10 +18,24 @@ class PythonDataSeries {
     public:
         PythonDataSeries(QString name, Py_ssize_t count, bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile);
         PythonDataSeries(QString name, Py_ssize_t count);
+
+        // count values from offset in values, without copying them
+        PythonDataSeries(QString name, QVector<double> values, int offset, Py_ssize_t count,
+                         bool readOnly=true, RideFile::SeriesType seriesType=RideFile::none, RideFile *rideFile=NULL);
         PythonDataSeries(PythonDataSeries*);
+        PythonDataSeries(const PythonDataSeries &);
+        PythonDataSeries &operator=(const PythonDataSeries &);
         PythonDataSeries();
         ~PythonDataSeries();
 
+        // data is shared with the ride (or cache), so get a copy of
+        // our own before writing to it
+        void detach();
+
+        // sequence protocol beyond len and indexing, so it can stand in for a list
+        PyObject* slice(PyObject *slice) const;
+        bool equals(PyObject *other) const;
+
         QString name;
         Py_ssize_t count;
         double *data;
@@ -29,6 +43,13 @@ class PythonDataSeries {
         bool readOnly;
         int seriesType;
         RideFile *rideFile;
+
+    private:
+        void copy(const PythonDataSeries &other);
+
+        // held for as long as we are, the buffers handed to numpy
+        // point into them
+        QVector<double> values, own;
 };
 
 class PythonXDataSeries {
@@ -96,14 +117,14 @@ class Bindings {
 
         // working with metrics
         PyObject* activityMetrics(bool compare=false) const;
-        PyObject* seasonMetrics(bool all=false, QString filter=QString(), bool compare=false) const;
+        PyObject* seasonMetrics(bool all=false, QString filter=QString(), bool compare=false, bool series=false) const;
         PythonDataSeries *metrics(QString metric, bool all=false, QString filter=QString()) const;
         PyObject* seasonPmc(bool all=false, QString metric=QString("BikeStress"), QString type=QString("Actual")) const;
         PyObject* seasonMeasures(bool all=false, QString group=QString("Body")) const;
 
         // working with meanmax data
-        PyObject* activityMeanmax(bool compare=false) const;
-        PyObject* seasonMeanmax(bool all=false, QString filter=QString(), bool compare=false) const;
+        PyObject* activityMeanmax(bool compare=false, bool series=false) const;
+        PyObject* seasonMeanmax(bool all=false, QString filter=QString(), bool compare=false, bool series=false) const;
         PyObject* seasonPeaks(QString series, int duration, bool all=false, QString filter=QString(), bool compare=false) const;
 
         // working with intervals
@@ -139,16 +160,23 @@ class Bindings {
 
         // get a dict populated with metrics and metadata
         PyObject* activityMetrics(RideItem* item) const;
-        PyObject* seasonMetrics(bool all, DateRange range, QString filter) const;
+        PyObject* seasonMetrics(bool all, DateRange range, QString filter, bool series) const;
         PyObject* seasonIntervals(bool all, DateRange range, QString type) const;
 
-        // get a dict populated with meanmax data
-        PyObject* activityMeanmax(const RideItem* item) const;
-        PyObject* seasonMeanmax(bool all, DateRange range, QString filter) const;
-        PyObject* rideFileCacheMeanmax(RideFileCache* cache) const;
+        // get a dict populated with meanmax data, as lists
+        // or as PythonDataSeries sharing the cache's arrays
+        PyObject* activityMeanmax(const RideItem* item, bool series) const;
+        PyObject* seasonMeanmax(bool all, DateRange range, QString filter, bool series) const;
+        PyObject* rideFileCacheMeanmax(RideFileCache* cache, bool series) const;
         PyObject* seasonPeaks(bool all, DateRange range, QString filter, QList<RideFile::SeriesType> series, QList<int> durations) const;
 
         int PyDict_SetItemString_Steal(PyObject *p, const char *key, PyObject *val) const;
+
+        // hand a series to python, which then owns it
+        PyObject* dataSeries(PythonDataSeries *ds) const;
+
+        // values as a list of floats, or a PythonDataSeries sharing them
+        PyObject* valueList(QString name, QVector<double> values, bool series) const;
 };
 
 #endif // _Bindings_h
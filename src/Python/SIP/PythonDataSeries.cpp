@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "Bindings.h"
+
+PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count, bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile)
+    : name(name), count(count), data(NULL), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile)
+{
+    if (count > 0) {
+        values.resize(count);
+        data = values.data();
+    }
+}
+
+PythonDataSeries::PythonDataSeries(QString name, Py_ssize_t count) : name(name), count(count), data(NULL),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL)
+{
+    if (count > 0) {
+        values.resize(count);
+        data = values.data();
+    }
+}
+
+PythonDataSeries::PythonDataSeries(QString name, QVector<double> values, int offset, Py_ssize_t count,
+                                   bool readOnly, RideFile::SeriesType seriesType, RideFile *rideFile)
+    : name(name), count(count), data(NULL), readOnly(readOnly), seriesType(seriesType), rideFile(rideFile), values(values)
+{
+    // never written through, see detach()
+    if (count > 0) data = const_cast<double*>(this->values.constData()) + offset;
+}
+
+// default constructor and copy constructor
+PythonDataSeries::PythonDataSeries() : name(QString()), count(0), data(NULL),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL) {}
+PythonDataSeries::PythonDataSeries(PythonDataSeries *clone) : name(QString()), count(0), data(NULL),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL)
+{
+    if (clone) copy(*clone);
+}
+
+PythonDataSeries::PythonDataSeries(const PythonDataSeries &other) : name(QString()), count(0), data(NULL),
+    readOnly(true), seriesType(RideFile::none), rideFile(NULL)
+{
+    copy(other);
+}
+
+PythonDataSeries &
+PythonDataSeries::operator=(const PythonDataSeries &other)
+{
+    if (this != &other) copy(other);
+    return *this;
+}
+
+void
+PythonDataSeries::copy(const PythonDataSeries &other)
+{
+    name = other.name;
+    count = other.count;
+    readOnly = other.readOnly;
+    seriesType = other.seriesType;
+    rideFile = other.rideFile;
+
+    // still shared with the ride it points into values we now hold too,
+    // but a copy of its own that may have been written is copied again
+    values = other.values;
+    if (other.count > 0 && other.own.count()) {
+        own = QVector<double>(other.data, other.data + other.count);
+        data = own.data();
+    } else {
+        own.clear();
+        data = other.data;
+    }
+}
+
+PythonDataSeries::~PythonDataSeries()
+{
+    data=NULL;
+    rideFile = NULL;
+}
+
+void
+PythonDataSeries::detach()
+{
+    if (count <= 0 || own.count()) return;
+
+    own = QVector<double>(data, data + count);
+    data = own.data();
+}
+
+// a list of the values in slice, as slicing a list gives
+PyObject*
+PythonDataSeries::slice(PyObject *slice) const
+{
+    Py_ssize_t start, stop, step, length;
+    if (PySlice_GetIndicesEx(slice, count, &start, &stop, &step, &length) < 0) return NULL;
+
+    PyObject* list = PyList_New(length);
+    if (list == NULL) return NULL;
+    for (Py_ssize_t i=0, j=start; i<length; i++, j+=step) PyList_SET_ITEM(list, i, PyFloat_FromDouble(data[j]));
+    return list;
+}
+
+// the same values as any other sequence of numbers, as a list compares
+bool
+PythonDataSeries::equals(PyObject *other) const
+{
+    if (!PySequence_Check(other) || PyUnicode_Check(other) || PyBytes_Check(other)) return false;
+    if (PySequence_Size(other) != count) {
+        PyErr_Clear();
+        return false;
+    }
+
+    for (Py_ssize_t i=0; i<count; i++) {
+        PyObject* item = PySequence_GetItem(other, i);
+        double value = item ? PyFloat_AsDouble(item) : 0;
+        Py_XDECREF(item);
+        if (PyErr_Occurred()) {
+            PyErr_Clear(); // not a number, so not equal
+            return false;
+        }
+        if (value != data[i]) return false;
+    }
+    return true;
+}
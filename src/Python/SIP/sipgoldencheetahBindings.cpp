@@ -8,20 +8,20 @@
 #include "sipAPIgoldencheetah.h"
 #define slots Q_SLOTS
 
-#line 342 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 360 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 //#include "Bindings.h"
 #line 12 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahBindings.cpp"
 
 #line 28 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include <qstring.h>
 #line 16 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahBindings.cpp"
-#line 138 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 156 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include <qstringlist.h>
 #line 19 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahBindings.cpp"
 #line 59 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include "Bindings.h"
 #line 22 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahBindings.cpp"
-#line 248 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 266 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include "Bindings.h"
 #line 25 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahBindings.cpp"
 
@@ -612,7 +612,7 @@ static PyObject *meth_Bindings_activityMetrics(PyObject *sipSelf, PyObject *sipA
 }
 
 
-PyDoc_STRVAR(doc_Bindings_seasonMetrics, "seasonMetrics(self, all: bool = False, filter: str = '', compare: bool = False) -> Any");
+PyDoc_STRVAR(doc_Bindings_seasonMetrics, "seasonMetrics(self, all: bool = False, filter: str = '', compare: bool = False, series: bool = False) -> Any");
 
 extern "C" {static PyObject *meth_Bindings_seasonMetrics(PyObject *, PyObject *, PyObject *);}
 static PyObject *meth_Bindings_seasonMetrics(PyObject *sipSelf, PyObject *sipArgs, PyObject *sipKwds)
@@ -625,19 +625,21 @@ static PyObject *meth_Bindings_seasonMetrics(PyObject *sipSelf, PyObject *sipArg
         ::QString* a1 = &a1def;
         int a1State = 0;
         bool a2 = 0;
+        bool a3 = 0;
         ::Bindings *sipCpp;
 
         static const char *sipKwdList[] = {
             sipName_all,
             sipName_filter,
             sipName_compare,
+            sipName_series,
         };
 
-        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|bJ1b", &sipSelf, sipType_Bindings, &sipCpp, &a0, sipType_QString, &a1, &a1State, &a2))
+        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|bJ1bb", &sipSelf, sipType_Bindings, &sipCpp, &a0, sipType_QString, &a1, &a1State, &a2, &a3))
         {
             PyObject * sipRes;
 
-            sipRes = sipCpp->seasonMetrics(a0, *a1, a2);
+            sipRes = sipCpp->seasonMetrics(a0, *a1, a2, a3);
             sipReleaseType(a1, sipType_QString, a1State);
 
             return sipRes;
@@ -767,7 +769,7 @@ static PyObject *meth_Bindings_seasonMeasures(PyObject *sipSelf, PyObject *sipAr
 }
 
 
-PyDoc_STRVAR(doc_Bindings_activityMeanmax, "activityMeanmax(self, compare: bool = False) -> Any");
+PyDoc_STRVAR(doc_Bindings_activityMeanmax, "activityMeanmax(self, compare: bool = False, series: bool = False) -> Any");
 
 extern "C" {static PyObject *meth_Bindings_activityMeanmax(PyObject *, PyObject *, PyObject *);}
 static PyObject *meth_Bindings_activityMeanmax(PyObject *sipSelf, PyObject *sipArgs, PyObject *sipKwds)
@@ -776,17 +778,19 @@ static PyObject *meth_Bindings_activityMeanmax(PyObject *sipSelf, PyObject *sipA
 
     {
         bool a0 = 0;
+        bool a1 = 0;
         ::Bindings *sipCpp;
 
         static const char *sipKwdList[] = {
             sipName_compare,
+            sipName_series,
         };
 
-        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|b", &sipSelf, sipType_Bindings, &sipCpp, &a0))
+        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|bb", &sipSelf, sipType_Bindings, &sipCpp, &a0, &a1))
         {
             PyObject * sipRes;
 
-            sipRes = sipCpp->activityMeanmax(a0);
+            sipRes = sipCpp->activityMeanmax(a0, a1);
 
             return sipRes;
         }
@@ -798,7 +802,7 @@ static PyObject *meth_Bindings_activityMeanmax(PyObject *sipSelf, PyObject *sipA
 }
 
 
-PyDoc_STRVAR(doc_Bindings_seasonMeanmax, "seasonMeanmax(self, all: bool = False, filter: str = '', compare: bool = False) -> Any");
+PyDoc_STRVAR(doc_Bindings_seasonMeanmax, "seasonMeanmax(self, all: bool = False, filter: str = '', compare: bool = False, series: bool = False) -> Any");
 
 extern "C" {static PyObject *meth_Bindings_seasonMeanmax(PyObject *, PyObject *, PyObject *);}
 static PyObject *meth_Bindings_seasonMeanmax(PyObject *sipSelf, PyObject *sipArgs, PyObject *sipKwds)
@@ -811,19 +815,21 @@ static PyObject *meth_Bindings_seasonMeanmax(PyObject *sipSelf, PyObject *sipArg
         ::QString* a1 = &a1def;
         int a1State = 0;
         bool a2 = 0;
+        bool a3 = 0;
         ::Bindings *sipCpp;
 
         static const char *sipKwdList[] = {
             sipName_all,
             sipName_filter,
             sipName_compare,
+            sipName_series,
         };
 
-        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|bJ1b", &sipSelf, sipType_Bindings, &sipCpp, &a0, sipType_QString, &a1, &a1State, &a2))
+        if (sipParseKwdArgs(&sipParseErr, sipArgs, sipKwds, sipKwdList, SIP_NULLPTR, "B|bJ1bb", &sipSelf, sipType_Bindings, &sipCpp, &a0, sipType_QString, &a1, &a1State, &a2, &a3))
         {
             PyObject * sipRes;
 
-            sipRes = sipCpp->seasonMeanmax(a0, *a1, a2);
+            sipRes = sipCpp->seasonMeanmax(a0, *a1, a2, a3);
             sipReleaseType(a1, sipType_QString, a1State);
 
             return sipRes;
@@ -17,6 +17,74 @@
 #line 16 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
 
+extern "C" {static PyObject *slot_PythonDataSeries___ne__(PyObject *, PyObject *);}
+static PyObject *slot_PythonDataSeries___ne__(PyObject *sipSelf, PyObject *sipArg)
+{
+    ::PythonDataSeries *sipCpp = reinterpret_cast< ::PythonDataSeries *>(sipGetCppPtr((sipSimpleWrapper *)sipSelf, sipType_PythonDataSeries));
+
+    if (!sipCpp)
+        return SIP_NULLPTR;
+
+    PyObject *sipParseErr = SIP_NULLPTR;
+
+    {
+        PyObject * a0;
+
+        if (sipParseArgs(&sipParseErr, sipArg, "1P0", &a0))
+        {
+            bool sipRes = 0;
+
+#line 143 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+        sipRes = !sipCpp->equals(a0);
+#line 38 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+
+            return PyBool_FromLong(sipRes);
+        }
+    }
+
+    Py_XDECREF(sipParseErr);
+
+    if (sipParseErr == Py_None)
+        return SIP_NULLPTR;
+
+    return sipPySlotExtend(&sipModuleAPI_goldencheetah, ne_slot, sipType_PythonDataSeries, sipSelf, sipArg);
+}
+
+
+extern "C" {static PyObject *slot_PythonDataSeries___eq__(PyObject *, PyObject *);}
+static PyObject *slot_PythonDataSeries___eq__(PyObject *sipSelf, PyObject *sipArg)
+{
+    ::PythonDataSeries *sipCpp = reinterpret_cast< ::PythonDataSeries *>(sipGetCppPtr((sipSimpleWrapper *)sipSelf, sipType_PythonDataSeries));
+
+    if (!sipCpp)
+        return SIP_NULLPTR;
+
+    PyObject *sipParseErr = SIP_NULLPTR;
+
+    {
+        PyObject * a0;
+
+        if (sipParseArgs(&sipParseErr, sipArg, "1P0", &a0))
+        {
+            bool sipRes = 0;
+
+#line 139 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+        sipRes = sipCpp->equals(a0);
+#line 72 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+
+            return PyBool_FromLong(sipRes);
+        }
+    }
+
+    Py_XDECREF(sipParseErr);
+
+    if (sipParseErr == Py_None)
+        return SIP_NULLPTR;
+
+    return sipPySlotExtend(&sipModuleAPI_goldencheetah, eq_slot, sipType_PythonDataSeries, sipSelf, sipArg);
+}
+
+
 extern "C" {static PyObject *slot_PythonDataSeries___iter__(PyObject *);}
 static PyObject *slot_PythonDataSeries___iter__(PyObject *sipSelf)
 {
@@ -30,9 +98,9 @@ static PyObject *slot_PythonDataSeries___iter__(PyObject *sipSelf)
         {
             PyObject * sipRes = SIP_NULLPTR;
 
-#line 125 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 135 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = PySeqIter_New(sipSelf);
-#line 34 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 102 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
             return sipRes;
         }
@@ -60,13 +128,14 @@ static int slot_PythonDataSeries___setitem__(PyObject *sipSelf, PyObject *sipArg
         {
             sipErrorState sipError = sipErrorNone;
 
-#line 104 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 113 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (sipCpp->readOnly) {
             PyErr_SetString(PyExc_AttributeError, "Object is read-only");
             sipError = sipErrorFail;
         } else {
             if (a0 < 0) a0 += sipCpp->count;
             if (a0 >= 0 && a0 < sipCpp->count) {
+                sipCpp->detach();
                 sipCpp->data[a0] = a1;
                 RideFile *rideFile = sipCpp->rideFile;
                 if (rideFile) {
@@ -79,7 +148,7 @@ static int slot_PythonDataSeries___setitem__(PyObject *sipSelf, PyObject *sipArg
                 sipError = sipErrorFail;
             }
         }
-#line 81 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 150 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
             if (sipError == sipErrorFail)
                 return -1;
@@ -117,7 +186,7 @@ static PyObject *slot_PythonDataSeries___getitem__(PyObject *sipSelf, PyObject *
             double sipRes = 0;
             sipErrorState sipError = sipErrorNone;
 
-#line 94 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 98 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (a0 < 0) a0 += sipCpp->count;
         if (a0 >= 0 && a0 < sipCpp->count) {
             sipRes = sipCpp->data[a0];
@@ -125,7 +194,7 @@ static PyObject *slot_PythonDataSeries___getitem__(PyObject *sipSelf, PyObject *
             PyErr_SetString(PyExc_IndexError, "Index out of range");
             sipError = sipErrorFail;
         }
-#line 127 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 196 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
             if (sipError == sipErrorFail)
                 return 0;
@@ -139,6 +208,31 @@ static PyObject *slot_PythonDataSeries___getitem__(PyObject *sipSelf, PyObject *
         }
     }
 
+    {
+        PyObject * a0;
+
+        if (sipParseArgs(&sipParseErr, sipArg, "1T", &PySlice_Type, &a0))
+        {
+            PyObject * sipRes = SIP_NULLPTR;
+            sipErrorState sipError = sipErrorNone;
+
+#line 108 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+        sipRes = sipCpp->slice(a0);
+        if (sipRes == NULL) sipError = sipErrorFail;
+#line 221 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+
+            if (sipError == sipErrorFail)
+                return 0;
+
+            if (sipError == sipErrorNone)
+            {
+            return sipRes;
+            }
+
+            sipAddException(sipError, &sipParseErr);
+        }
+    }
+
     sipNoMethod(sipParseErr, sipName_PythonDataSeries, sipName___getitem__, SIP_NULLPTR);
 
     return SIP_NULLPTR;
@@ -158,9 +252,9 @@ static Py_ssize_t slot_PythonDataSeries___len__(PyObject *sipSelf)
         {
             Py_ssize_t sipRes = 0;
 
-#line 90 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 94 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = sipCpp->count;
-#line 162 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 256 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
             return sipRes;
         }
@@ -183,9 +277,9 @@ static PyObject *slot_PythonDataSeries___str__(PyObject *sipSelf)
         {
             ::QString*sipRes = 0;
 
-#line 86 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 90 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = new QString(sipCpp->name);
-#line 187 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 281 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
             return sipConvertFromNewType(sipRes, sipType_QString, SIP_NULLPTR);
         }
@@ -204,16 +298,20 @@ static void release_PythonDataSeries(void *sipCppV, int)
 
 
 extern "C" {static int getbuffer_PythonDataSeries(PyObject *, void *, Py_buffer *, int);}
-static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffer *sipBuffer, int )
+static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffer *sipBuffer, int sipFlags)
 {
     ::PythonDataSeries *sipCpp = reinterpret_cast< ::PythonDataSeries *>(sipCppV);
     int sipRes;
 
 #line 63 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+    // shares the ride's memory read-only, asking to write gets a copy of our own
+    bool writable = (sipFlags & PyBUF_WRITABLE) == PyBUF_WRITABLE;
+    if (writable) sipCpp->detach();
+
     sipBuffer->obj = sipSelf;
     sipBuffer->buf = (void*)sipCpp->data;
     sipBuffer->len = sipCpp->count * sizeof(double);
-    sipBuffer->readonly = 0;
+    sipBuffer->readonly = writable ? 0 : 1;
     sipBuffer->itemsize = sizeof(double);
     sipBuffer->format = (char*)"d";  // double
     sipBuffer->ndim = 1;
@@ -224,7 +322,7 @@ static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffe
 
     Py_INCREF(sipSelf);  // need to increase the reference count
     sipRes = 0;
-#line 226 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 324 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 
     return sipRes;
 }
@@ -233,9 +331,9 @@ static int getbuffer_PythonDataSeries(PyObject *sipSelf, void *sipCppV, Py_buffe
 extern "C" {static void releasebuffer_PythonDataSeries(PyObject *, void *, Py_buffer *);}
 static void releasebuffer_PythonDataSeries(PyObject *, void *, Py_buffer *)
 {
-#line 80 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 84 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
     // we do not require any special release function
-#line 237 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
+#line 335 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonDataSeries.cpp"
 }
 
 
@@ -308,6 +406,8 @@ static void *init_type_PythonDataSeries(sipSimpleWrapper *, PyObject *sipArgs, P
 
 /* Define this type's Python slots. */
 static sipPySlotDef slots_PythonDataSeries[] = {
+    {(void *)slot_PythonDataSeries___ne__, ne_slot},
+    {(void *)slot_PythonDataSeries___eq__, eq_slot},
     {(void *)slot_PythonDataSeries___iter__, iter_slot},
     {(void *)slot_PythonDataSeries___setitem__, setitem_slot},
     {(void *)slot_PythonDataSeries___getitem__, getitem_slot},
@@ -8,7 +8,7 @@
 #include "sipAPIgoldencheetah.h"
 #define slots Q_SLOTS
 
-#line 248 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 266 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include "Bindings.h"
 #line 12 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonXDataSeries.cpp"
 
@@ -32,7 +32,7 @@ static PyObject *meth_PythonXDataSeries_append(PyObject *sipSelf, PyObject *sipA
         {
             sipErrorState sipError = sipErrorNone;
 
-#line 310 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 328 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (sipCpp->readOnly) {
             PyErr_SetString(PyExc_AttributeError, "Object is read-only");
             sipError = sipErrorFail;
@@ -77,7 +77,7 @@ static PyObject *meth_PythonXDataSeries_remove(PyObject *sipSelf, PyObject *sipA
         {
             sipErrorState sipError = sipErrorNone;
 
-#line 321 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 339 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (sipCpp->readOnly) {
             PyErr_SetString(PyExc_AttributeError, "Object is read-only");
             sipError = sipErrorFail;
@@ -120,7 +120,7 @@ static PyObject *slot_PythonXDataSeries___iter__(PyObject *sipSelf)
         {
             PyObject * sipRes = SIP_NULLPTR;
 
-#line 332 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 350 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = PySeqIter_New(sipSelf);
 #line 124 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonXDataSeries.cpp"
 
@@ -150,7 +150,7 @@ static int slot_PythonXDataSeries___setitem__(PyObject *sipSelf, PyObject *sipAr
         {
             sipErrorState sipError = sipErrorNone;
 
-#line 293 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 311 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (sipCpp->readOnly) {
             PyErr_SetString(PyExc_AttributeError, "Object is read-only");
             sipError = sipErrorFail;
@@ -203,7 +203,7 @@ static PyObject *slot_PythonXDataSeries___getitem__(PyObject *sipSelf, PyObject
             double sipRes = 0;
             sipErrorState sipError = sipErrorNone;
 
-#line 283 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 301 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         if (a0 < 0) a0 += sipCpp->count();
         if (a0 >= 0 && a0 < sipCpp->count()) {
             sipRes = sipCpp->get(a0);
@@ -244,7 +244,7 @@ static Py_ssize_t slot_PythonXDataSeries___len__(PyObject *sipSelf)
         {
             Py_ssize_t sipRes = 0;
 
-#line 279 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 297 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = sipCpp->count();
 #line 248 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonXDataSeries.cpp"
 
@@ -269,7 +269,7 @@ static PyObject *slot_PythonXDataSeries___str__(PyObject *sipSelf)
         {
             ::QString*sipRes = 0;
 
-#line 275 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 293 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
         sipRes = new QString(sipCpp->name());
 #line 273 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonXDataSeries.cpp"
 
@@ -295,7 +295,7 @@ static int getbuffer_PythonXDataSeries(PyObject *sipSelf, void *sipCppV, Py_buff
     ::PythonXDataSeries *sipCpp = reinterpret_cast< ::PythonXDataSeries *>(sipCppV);
     int sipRes;
 
-#line 252 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 270 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
     sipBuffer->obj = sipSelf;
     sipBuffer->buf = sipCpp->rawDataPtr();
     sipBuffer->len = sipCpp->count() * sizeof(double);
@@ -319,7 +319,7 @@ static int getbuffer_PythonXDataSeries(PyObject *sipSelf, void *sipCppV, Py_buff
 extern "C" {static void releasebuffer_PythonXDataSeries(PyObject *, void *, Py_buffer *);}
 static void releasebuffer_PythonXDataSeries(PyObject *, void *, Py_buffer *)
 {
-#line 269 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 287 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
     // we do not require any special release function
 #line 323 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahPythonXDataSeries.cpp"
 }
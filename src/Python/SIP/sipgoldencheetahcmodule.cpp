@@ -11,10 +11,10 @@
 #line 59 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include "Bindings.h"
 #line 12 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahcmodule.cpp"
-#line 248 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 266 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 #include "Bindings.h"
 #line 15 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahcmodule.cpp"
-#line 342 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
+#line 360 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/goldencheetah.sip"
 //#include "Bindings.h"
 #line 18 "/home/poncho/Documents/Development/GoldenCheetah/src/Python/SIP/build/goldencheetah/sipgoldencheetahcmodule.cpp"
 
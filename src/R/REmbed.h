@@ -42,6 +42,12 @@
 #include "R_ext/GraphicsEngine.h"
 #include "R_ext/GraphicsDevice.h"
 
+// lazy vectors, the header is only C++ safe from 3.6
+#if R_VERSION >= R_Version(3,6,0)
+#define GC_R_ALTREP 1
+#include <R_ext/Altrep.h>
+#endif
+
 // remap
 #include "RLibrary.h"
 
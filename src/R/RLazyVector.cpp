@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "RLazyVector.h"
+
+#include <cstring>
+
+//
+// Sources
+//
+void
+RVectorSource::values(R_xlen_t i, R_xlen_t n, double *buf) const
+{
+    for (R_xlen_t j=0; j<n; j++) buf[j] = value(i+j);
+}
+
+double
+RArraySource::value(R_xlen_t i) const
+{
+    if (array.isEmpty()) return NA_REAL;
+
+    double v = array.at(offset + i);
+    if (zeroIsNA && v == 0) return NA_REAL;
+    return v;
+}
+
+void
+RArraySource::values(R_xlen_t i, R_xlen_t n, double *buf) const
+{
+    if (array.isEmpty() || zeroIsNA) {
+        RVectorSource::values(i, n, buf);
+        return;
+    }
+    memcpy(buf, array.constData() + offset + i, n * sizeof(double));
+}
+
+//
+// ALTREP class, data1 is an external pointer to the source and data2 is
+// R_NilValue until the values are materialised into a REALSXP
+//
+static bool lazy = false;
+
+#ifdef GC_R_ALTREP
+static R_altrep_class_t lazyClass;
+
+static RVectorSource *sourceOf(SEXP x)
+{
+    return static_cast<RVectorSource*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+static void lazyFinalize(SEXP ptr)
+{
+    delete static_cast<RVectorSource*>(R_ExternalPtrAddr(ptr));
+}
+
+static R_xlen_t lazyLength(SEXP x)
+{
+    return sourceOf(x)->length();
+}
+
+static double lazyElt(SEXP x, R_xlen_t i)
+{
+    SEXP data = R_altrep_data2(x);
+    if (data != R_NilValue) return REAL(data)[i];
+    return sourceOf(x)->value(i);
+}
+
+static R_xlen_t lazyRegion(SEXP x, R_xlen_t i, R_xlen_t n, double *buf)
+{
+    R_xlen_t length = sourceOf(x)->length();
+    if (i + n > length) n = length - i;
+    if (n <= 0) return 0;
+
+    SEXP data = R_altrep_data2(x);
+    if (data != R_NilValue) memcpy(buf, REAL(data) + i, n * sizeof(double));
+    else sourceOf(x)->values(i, n, buf);
+    return n;
+}
+
+// R wants the memory, so now we copy
+static void *lazyDataptr(SEXP x, Rboolean)
+{
+    SEXP data = R_altrep_data2(x);
+    if (data == R_NilValue) {
+        RVectorSource *source = sourceOf(x);
+        PROTECT(data = Rf_allocVector(REALSXP, source->length()));
+        source->values(0, source->length(), REAL(data));
+        R_set_altrep_data2(x, data);
+        UNPROTECT(1);
+    }
+    return REAL(data);
+}
+
+static const void *lazyDataptrOrNull(SEXP x)
+{
+    SEXP data = R_altrep_data2(x);
+    if (data == R_NilValue) return NULL;
+    return REAL(data);
+}
+#endif
+
+void
+RLazyVector::initialise(DllInfo *info)
+{
+#ifdef GC_R_ALTREP
+    if (lazy || !GC_R_hasAltrep()) return;
+
+    lazyClass = R_make_altreal_class("gc_lazy_real", "GoldenCheetah", info);
+    R_set_altrep_Length_method(lazyClass, lazyLength);
+    R_set_altreal_Elt_method(lazyClass, lazyElt);
+    R_set_altreal_Get_region_method(lazyClass, lazyRegion);
+    R_set_altvec_Dataptr_method(lazyClass, lazyDataptr);
+    R_set_altvec_Dataptr_or_null_method(lazyClass, lazyDataptrOrNull);
+    lazy = true;
+#else
+    Q_UNUSED(info);
+#endif
+}
+
+bool
+RLazyVector::isLazy()
+{
+    return lazy;
+}
+
+SEXP
+RLazyVector::create(RVectorSource *source)
+{
+    SEXP ans;
+
+#ifdef GC_R_ALTREP
+    if (lazy) {
+        SEXP ptr;
+        PROTECT(ptr = R_MakeExternalPtr(source, R_NilValue, R_NilValue));
+        R_RegisterCFinalizerEx(ptr, lazyFinalize, TRUE);
+        ans = R_new_altrep(lazyClass, ptr, R_NilValue);
+        UNPROTECT(1);
+        return ans;
+    }
+#endif
+
+    // no ALTREP, copy them now
+    ans = Rf_allocVector(REALSXP, source->length());
+    source->values(0, source->length(), REAL(ans));
+    delete source;
+    return ans;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_RLazyVector_h
+#define _GC_RLazyVector_h 1
+
+#include "REmbed.h"
+
+#include <QVector>
+
+//
+// Numeric columns handed to R without copying them up front.
+//
+// An RVectorSource provides the values of a column when asked and an
+// RLazyVector wraps one in an R ALTREP real vector. R can ask for its length,
+// single elements or a region at a time without the column being copied,
+// only when it wants the data pointer (most vectorised arithmetic) are the
+// values copied into an ordinary R vector that is kept with it from then on.
+// So a script that uses 3 metrics of a season's data frame only ever copies
+// those 3 columns.
+//
+// The source belongs to the R object and is deleted when it is garbage
+// collected, so sources hold implicitly shared copies of the arrays they
+// read rather than pointers to rides that may have gone by then.
+//
+// When the R runtime doesn't have ALTREP create() copies the values into a
+// plain vector straight away, as we always did.
+//
+
+class RVectorSource
+{
+    public:
+        virtual ~RVectorSource() {}
+
+        virtual R_xlen_t length() const = 0;
+        virtual double value(R_xlen_t i) const = 0;
+
+        // n values from i into buf
+        virtual void values(R_xlen_t i, R_xlen_t n, double *buf) const;
+};
+
+// count values of array from offset, or all NA if the array is empty
+// lat and lon use zeroIsNA as 0,0 means no position
+class RArraySource : public RVectorSource
+{
+    public:
+        RArraySource(const QVector<double> &array, int offset, int count, bool zeroIsNA=false)
+            : array(array), offset(offset), count(count), zeroIsNA(zeroIsNA) {}
+
+        R_xlen_t length() const { return count; }
+        double value(R_xlen_t i) const;
+        void values(R_xlen_t i, R_xlen_t n, double *buf) const;
+
+    private:
+        QVector<double> array;
+        int offset, count;
+        bool zeroIsNA;
+};
+
+// metric index from the metrics of each ride, scaled for units
+class RMetricSource : public RVectorSource
+{
+    public:
+        RMetricSource(const QVector<QVector<double> > &rides, int index, double scale=1.0, double offset=0.0)
+            : rides(rides), index(index), scale(scale), offset(offset) {}
+
+        R_xlen_t length() const { return rides.count(); }
+        double value(R_xlen_t i) const { return rides.at(i).at(index) * scale + offset; }
+
+    private:
+        QVector<QVector<double> > rides;
+        int index;
+        double scale, offset;
+};
+
+class RLazyVector
+{
+    public:
+
+        // register the ALTREP class, once R is up
+        static void initialise(DllInfo *info);
+        static bool isLazy();
+
+        // a REALSXP of the values in source, taking ownership of it
+        // the caller must PROTECT it, as with Rf_allocVector
+        static SEXP create(RVectorSource *source);
+};
+#endif // _GC_RLazyVector_h
@@ -123,6 +123,24 @@ extern SEXP GC_Rf_install(const char *);
 extern SEXP GC_Rf_setAttrib(SEXP, SEXP, SEXP);
 extern Rboolean (GC_Rf_isNull)(SEXP s);
 extern const char *(GC_R_CHAR)(SEXP x);
+extern SEXP GC_R_MakeExternalPtr(void *p, SEXP tag, SEXP prot);
+extern void *GC_R_ExternalPtrAddr(SEXP s);
+extern void GC_R_RegisterCFinalizerEx(SEXP s, R_CFinalizer_t fun, Rboolean onexit);
+
+// ALTREP, optional as older versions of R don't have it
+#ifdef GC_R_ALTREP
+extern bool GC_R_hasAltrep(void);
+extern R_altrep_class_t GC_R_make_altreal_class(const char *cname, const char *pname, DllInfo *info);
+extern SEXP GC_R_new_altrep(R_altrep_class_t aclass, SEXP data1, SEXP data2);
+extern SEXP GC_R_altrep_data1(SEXP x);
+extern SEXP GC_R_altrep_data2(SEXP x);
+extern void GC_R_set_altrep_data2(SEXP x, SEXP v);
+extern void GC_R_set_altrep_Length_method(R_altrep_class_t cls, R_altrep_Length_method_t fun);
+extern void GC_R_set_altvec_Dataptr_method(R_altrep_class_t cls, R_altvec_Dataptr_method_t fun);
+extern void GC_R_set_altvec_Dataptr_or_null_method(R_altrep_class_t cls, R_altvec_Dataptr_or_null_method_t fun);
+extern void GC_R_set_altreal_Elt_method(R_altrep_class_t cls, R_altreal_Elt_method_t fun);
+extern void GC_R_set_altreal_Get_region_method(R_altrep_class_t cls, R_altreal_Get_region_method_t fun);
+#endif
 
 // Graphics Device
 #ifdef R_RGB // only redo graphics device if its included
@@ -214,6 +232,23 @@ extern double *pGC_R_NaReal;          // XXX TODO NaReal value
 #define INTEGER                     GC_INTEGER
 #define LOGICAL                     GC_LOGICAL
 #define R_CHAR                      GC_R_CHAR
+#define R_MakeExternalPtr           GC_R_MakeExternalPtr
+#define R_ExternalPtrAddr           GC_R_ExternalPtrAddr
+#define R_RegisterCFinalizerEx      GC_R_RegisterCFinalizerEx
+
+// ALTREP
+#ifdef GC_R_ALTREP
+#define R_make_altreal_class        GC_R_make_altreal_class
+#define R_new_altrep                GC_R_new_altrep
+#define R_altrep_data1              GC_R_altrep_data1
+#define R_altrep_data2              GC_R_altrep_data2
+#define R_set_altrep_data2          GC_R_set_altrep_data2
+#define R_set_altrep_Length_method  GC_R_set_altrep_Length_method
+#define R_set_altvec_Dataptr_method GC_R_set_altvec_Dataptr_method
+#define R_set_altvec_Dataptr_or_null_method GC_R_set_altvec_Dataptr_or_null_method
+#define R_set_altreal_Elt_method    GC_R_set_altreal_Elt_method
+#define R_set_altreal_Get_region_method GC_R_set_altreal_Get_region_method
+#endif
 
 // Graphics device
 #define GEcreateDevDesc             GC_GEcreateDevDesc
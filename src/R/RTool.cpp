@@ -18,6 +18,7 @@
 
 #include "RTool.h"
 #include "RGraphicsDevice.h"
+#include "RLazyVector.h"
 #include "GcUpgrade.h"
 
 #include "RideCache.h"
@@ -269,6 +270,9 @@ RTool::RTool()
         if (majorN > 3 || (majorN == 3 && minorN > 3)) R_registerRoutines(info, (const R_CMethodDef*)(cMethods34), callMethods, NULL, NULL);
         else R_registerRoutines(info, (const R_CMethodDef*)(cMethods33), callMethods, NULL, NULL);
 
+        // data frames hold lazy vectors where ALTREP is available (3.5 or higher)
+        if (majorN > 3 || (majorN == 3 && minorN > 4)) RLazyVector::initialise(info);
+
         // what version are we running?
         #ifdef GC_WANT_ALLDEBUG
         fprintf(stderr,"R loaded. [Compiled=%s.%s, Loaded=%d.%d, Loaded DeviceEngine=%d]\n", R_MAJOR, R_MINOR, majorN, minorN, GC_R_GE_getVersion());
@@ -1251,11 +1255,18 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
     //
     // METRICS
     //
-    for(int i=0; i<factory.metricCount();i++) {
+    // the metrics of each ride are shared by all the metric vectors, which
+    // only pick out their own values when the script uses them
+    QVector<QVector<double> > values;
+    values.reserve(rides);
+    foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
+        if (!specification.pass(item)) continue;
+        if (all || range.pass(item->dateTime.date())) values << item->metrics();
+    }
 
-        // set a vector
-        SEXP m;
-        PROTECT(m=Rf_allocVector(REALSXP, rides));
+    bool useMetricUnits = GlobalContext::context()->useMetricUnits;
+
+    for(int i=0; i<factory.metricCount();i++) {
 
         QString symbol = factory.metricName(i);
         const RideMetric *metric = factory.rideMetric(symbol);
@@ -1263,16 +1274,10 @@ RTool::dfForDateRange(bool all, DateRange range, SEXP filter)
         name = name.replace(" ","_");
         name = name.replace("'","_");
 
-        bool useMetricUnits = GlobalContext::context()->useMetricUnits;
-
-        int index=0;
-        foreach(RideItem *item, rtool->context->athlete->rideCache->rides()) {
-            if (!specification.pass(item)) continue;
-            if (all || range.pass(item->dateTime.date())) {
-                REAL(m)[index++] = item->metrics()[i] * (useMetricUnits ? 1.0f : metric->conversion())
-                                                      + (useMetricUnits ? 0.0f : metric->conversionSum());
-            }
-        }
+        // set a vector
+        SEXP m;
+        PROTECT(m=RLazyVector::create(new RMetricSource(values, i, useMetricUnits ? 1.0f : metric->conversion(),
+                                                                   useMetricUnits ? 0.0f : metric->conversionSum())));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, m);
@@ -2144,11 +2149,13 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
     // return a data frame for the ride passed
     QList<SEXP> returning;
 
-    // how many series?
+    // how many series, and which of them can be shared from the ride's columns
     int seriescount=0;
+    QList<RideFile::SeriesType> stored;
     for(int i=0; i<static_cast<int>(RideFile::none); i++) {
         RideFile::SeriesType series = static_cast<RideFile::SeriesType>(i);
         if (i > 15 && !f->isDataPresent(series)) continue;
+        if (f->isDataPresent(series) && RideFileColumns::isStored(series)) stored << series;
         seriescount++;
     }
 
@@ -2167,6 +2174,7 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
     // start at first sample in ride
     int index=0;
     int pcount=0;
+    RideFileColumnsPtr columns = f->columns(stored);
 
     while(index < f->dataPoints().count()) {
 
@@ -2228,20 +2236,26 @@ RTool::dfForActivity(RideFile *f, int split, QString join)
             // lets not add lots of NA for the more obscure data series
             if (s > 15 && !f->isDataPresent(series)) continue;
 
-            // set a vector
-            SEXP vector = PROTECT(Rf_allocVector(REALSXP, points));
-            pcount++;
+            // set a vector, stored series are shared from the ride's columns
+            // and absent ones are all NA, so only derived series are copied
+            SEXP vector;
+            bool latlon = (series == RideFile::lat || series == RideFile::lon);
+            if (!f->isDataPresent(series)) {
+                vector = PROTECT(RLazyVector::create(new RArraySource(QVector<double>(), 0, points)));
+
+            } else if (columns->isPresent(series) && stop <= columns->count()) {
+                vector = PROTECT(RLazyVector::create(new RArraySource(columns->array(series), index, points, latlon)));
 
-            for(int j=index; j<stop; j++) {
-                if (f->isDataPresent(series)) {
-                    if (f->dataPoints()[j]->value(series) == 0 && (series == RideFile::lat || series == RideFile::lon))
+            } else {
+                vector = PROTECT(Rf_allocVector(REALSXP, points));
+                for(int j=index; j<stop; j++) {
+                    if (f->dataPoints()[j]->value(series) == 0 && latlon)
                         REAL(vector)[j-index] = NA_REAL;
                     else
                         REAL(vector)[j-index] = f->dataPoints()[j]->value(series);
-                } else {
-                    REAL(vector)[j-index] = NA_REAL;
                 }
             }
+            pcount++;
 
             // add to the list
             SET_VECTOR_ELT(ans, next, vector);
@@ -2632,14 +2646,13 @@ RTool::dfForRideFileCache(RideFileCache *cache)
         if (values.count()==0) continue;
 
 
-        // set a vector
-        SEXP vector;
-        PROTECT(vector=Rf_allocVector(REALSXP, values.count()));
-
+        // set a vector, it shares the cache's array so it outlives
+        // a cache for a date range that goes when we return.
         // will have different sizes e.g. when a daterange
         // since longest ride with e.g. power may be different
         // to longest ride with heartrate
-        for(int j=0; j<values.count(); j++) REAL(vector)[j] = values[j];
+        SEXP vector;
+        PROTECT(vector=RLazyVector::create(new RArraySource(values, 0, values.count())));
 
         // add to the list
         SET_VECTOR_ELT(ans, next, vector);
@@ -1762,7 +1762,7 @@ void ErgFile::finalize()
         Laps.append(lap);
     }
 
-    if (appsettings->value(nullptr, TRAIN_COALESCE_SECTIONS, false).toBool()) {
+    if (GSettingsSnapshot::value(TRAIN_COALESCE_SECTIONS, false).toBool()) {
         coalesceSections();
     } else {
         coalescedSections = false;
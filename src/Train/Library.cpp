@@ -35,6 +35,7 @@
 
 #include "ErgFile.h"
 #include "VideoSyncFile.h"
+#include "LibraryImport.h"
 
 QList<Library*> libraries;       // keep track of all the library search paths (global)
 
@@ -91,6 +92,7 @@ Library::importFiles(Context *context, QStringList files, LibraryBatchImportConf
 {
     QStringList videos, workouts, videosyncs;
     MediaHelper helper;
+    LibraryImport importer(context);
 
     // sort the wheat from the chaff
     foreach(QString file, files) {
@@ -101,21 +103,14 @@ Library::importFiles(Context *context, QStringList files, LibraryBatchImportConf
         // media just check file name
         if (helper.isMedia(file)) videos << file;
 
-        // if it is a workout we parse it to check
-        if (ErgFile::isWorkout(file)) {
-            ErgFile *p = new ErgFile(file, ErgFileFormat::unknown, context);
-            if (p->isValid()) workouts << file;
-            delete p;
-        }
-
-        // if it is a VideoSync we parse it to check
-        if (VideoSyncFile::isVideoSync(file)) {
-            int mode = 0;
-            VideoSyncFile *p = new VideoSyncFile(file, mode, context);
-            if (p->isValid()) videosyncs << file;
-            delete p;
-        }
+        // if it is a workout or VideoSync we parse it to check,
+        // they are all parsed at once below
+        if (ErgFile::isWorkout(file)) importer.addWorkout(file);
+        if (VideoSyncFile::isVideoSync(file)) importer.addVideoSync(file);
     }
+    importer.wait();
+    workouts = importer.workouts();
+    videosyncs = importer.videoSyncs();
 
     // nothing to dialog about...
     if (!videos.count() && !workouts.count() && !videosyncs.count()) {
@@ -282,19 +277,27 @@ Library::refreshWorkouts
 (Context *context)
 {
     QAbstractTableModel *model = trainDB->getWorkoutModel();
-    trainDB->startLUW();
-    bool ok = true;
+
+    // parse them all, the metrics depend upon the zones so
+    // even unchanged files are read again
+    LibraryImport importer(context);
+    QStringList filepaths;
     for (int i = 0; i < model->rowCount(); ++i) {
         QString type = model->data(model->index(i, TdbWorkoutModelIdx::type)).toString();
         if (type != "code") {
             QString filepath = model->data(model->index(i, TdbWorkoutModelIdx::filepath)).toString();
-            ErgFile ergfile(filepath, ErgFileFormat::unknown, context);
-            if (ergfile.isValid()) {
-                ok &= trainDB->importWorkout(filepath, ergfile, ImportMode::update);
-            } else {
-                trainDB->deleteWorkout(filepath);
-                qDebug() << "Library::refreshWorkouts:" << i << "/" << model->rowCount() << ": Removing" << filepath << "- file does not parse correctly: Does it exist?";
-            }
+            importer.addWorkout(filepath);
+            filepaths << filepath;
+        }
+    }
+    importer.wait();
+
+    trainDB->startLUW();
+    bool ok = importer.write(ImportMode::update);
+    for (int i = 0; i < filepaths.count(); ++i) {
+        if (importer.workout(filepaths[i]) == nullptr) {
+            trainDB->deleteWorkout(filepaths[i]);
+            qDebug() << "Library::refreshWorkouts:" << i << "/" << filepaths.count() << ": Removing" << filepaths[i] << "- file does not parse correctly: Does it exist?";
         }
     }
     trainDB->endLUW();
@@ -326,6 +329,7 @@ LibrarySearchDialog::LibrarySearchDialog(Context *context) : context(context)
     setMinimumWidth(600 *dpiXFactor);
 
     searcher = NULL;
+    importer = NULL;
 
     findWorkouts = new QCheckBox(tr("Workout files (.erg, .mrc, .zwo etc)"), this);
     findWorkouts->setChecked(true);
@@ -394,6 +398,7 @@ LibrarySearchDialog::LibrarySearchDialog(Context *context) : context(context)
     workoutCountTitle->setFixedWidth(80 *dpiXFactor);
     videosyncCount->setFixedWidth(80 *dpiXFactor);
     videosyncCountTitle->setFixedWidth(80 *dpiXFactor);
+    importLabel = new QLabel(this);
 
     cancelButton = new QPushButton(tr("Cancel"), this);
     cancelButton->setDefault(false);
@@ -429,6 +434,7 @@ LibrarySearchDialog::LibrarySearchDialog(Context *context) : context(context)
     progressLayout->addWidget(mediaCount, 1,1);
     progressLayout->addWidget(workoutCount, 1,2);
     progressLayout->addWidget(videosyncCount, 1,3);
+    progressLayout->addWidget(importLabel, 2,0,1,4);
     progressLayout->setColumnStretch(0, 6);
     progressLayout->setColumnStretch(1, 1);
     progressLayout->setColumnStretch(2, 1);
@@ -563,6 +569,16 @@ LibrarySearchDialog::search()
         workoutCount->setText(QString("%1").arg(workoutCountN));
         mediaCount->setText(QString("%1").arg(videoCountN));
         videosyncCount->setText(QString("%1").arg(videosyncCountN));
+        workoutsFound.clear();
+        videosFound.clear();
+        videosyncsFound.clear();
+
+        // files are read as they are found, whilst the search continues
+        if (importer) delete importer;
+        importer = new LibraryImport(context, this);
+        importer->skipKnown();
+        connect(importer, SIGNAL(progress(int,int)), this, SLOT(importing()));
+        importLabel->setText("");
         QTreeWidgetItem *item = searchPathTable->invisibleRootItem()->child(pathIndex);
         if (!item) return; // avoid crash
         QString path = item->text(0);
@@ -589,6 +605,7 @@ LibrarySearchDialog::foundWorkout(QString name)
 {
     workoutCount->setText(QString("%1").arg(++workoutCountN));
     workoutsFound << name;
+    if (importer) importer->addWorkout(name);
 }
 
 void
@@ -603,6 +620,24 @@ LibrarySearchDialog::foundVideoSync(QString name)
 {
     videosyncCount->setText(QString("%1").arg(++videosyncCountN));
     videosyncsFound << name;
+    if (importer) importer->addVideoSync(name);
+}
+
+void
+LibrarySearchDialog::importing()
+{
+    if (!importer) return;
+
+    if (importer->count(LibraryImport::Written)) {
+        importLabel->setText(QString(tr("Saved %1 files")).arg(importer->count(LibraryImport::Written)));
+        importLabel->repaint(); // whilst saving we don't return to the event loop
+    } else {
+        importLabel->setText(QString(tr("Checked %1 of %2 files, %3 unchanged, %4 read"))
+                             .arg(importer->count(LibraryImport::Hashed))
+                             .arg(importer->count(LibraryImport::Queued))
+                             .arg(importer->count(LibraryImport::Unchanged))
+                             .arg(importer->count(LibraryImport::Parsed)));
+    }
 }
 
 void
@@ -615,6 +650,7 @@ LibrarySearchDialog::cancel()
             searcher = NULL;
             // we will NOT get a done signal...
         }
+        if (importer) importer->abort();
 
         // ...so lets clean up
         setSearching(false);
@@ -669,43 +705,7 @@ LibrarySearchDialog::removeReference()
 void
 LibrarySearchDialog::updateDB()
 {
-    // wipe away all data but personal data: tags, rating, etc
-    // To keep personal data, we are not deleting workouts table and tags related tables
-    trainDB->rebuildDBButUserDataTables();
-
-    trainDB->startLUW();
-
-    // workouts
-    // If the workout existed already, it won't be modified
-    foreach(QString ergFile, workoutsFound) {
-        ErgFile file(ergFile, ErgFileFormat::unknown, context);
-        if (file.isValid()) {
-            trainDB->importWorkout(ergFile, file);
-        }
-    }
-    // Now, we can delete old workouts in the table that have not been scanned now
-    QStringList workouts = trainDB->getWorkouts();
-    for (const QString &workout : workouts) {
-        if (!workoutsFound.contains(workout)) {
-            trainDB->deleteWorkout(workout);
-        }
-    }
-
-
-
-    // videos
-    foreach(QString video, videosFound) {
-        trainDB->importVideo(video);
-    }
-
-    // videosyncs
-    foreach(QString videosync, videosyncsFound) {
-        int mode=0;
-        VideoSyncFile file(videosync, mode, context);
-        trainDB->importVideoSync(videosync, file);
-    }
-
-    // Now check and re-add references, if there are any
+    // Check and re-add references, if there are any
     // these are files which were drag-n-dropped into the
     // GC train window, but which were referenced not
     // copied into the workout directory.
@@ -717,26 +717,65 @@ LibrarySearchDialog::updateDB()
             if (!QFile(r).exists()) continue;
 
             // is a video?
-            if (helper.isMedia(r)) trainDB->importVideo(r);
+            if (helper.isMedia(r)) videosFound << r;
 
             // is a videosync?
             if (VideoSyncFile::isVideoSync(r)) {
-                int mode=0;
-                VideoSyncFile file(r, mode, context);
-                if (file.isValid()) {
-                    trainDB->importVideoSync(r, file);
-                }
+                videosyncsFound << r;
+                if (importer) importer->addVideoSync(r);
             }
 
             // is a workout?
             if (ErgFile::isWorkout(r)) {
-                ErgFile file(r, ErgFileFormat::unknown, context);
-                if (file.isValid()) {
-                    trainDB->importWorkout(r, file);
-                }
+                workoutsFound << r;
+                if (importer) importer->addWorkout(r);
             }
         }
     }
+
+    // most were read whilst searching, wait for the rest
+    if (importer) {
+        pathLabel->setText(tr("Reading files..."));
+        pathLabel->repaint();
+        importer->wait();
+    }
+
+    trainDB->startLUW();
+
+    // workouts and videosyncs
+    // files that haven't changed since they were imported are left
+    // as they are, the rest are added or updated keeping personal
+    // data: tags, rating, etc
+    if (importer) importer->write();
+
+    // videos
+    foreach(QString video, videosFound) {
+        trainDB->importVideo(video);
+    }
+
+    // Now, we can delete old entries in the tables that have not been scanned now
+    QSet<QString> found(workoutsFound.begin(), workoutsFound.end());
+    QStringList workouts = trainDB->getWorkouts();
+    for (const QString &workout : workouts) {
+        if (!found.contains(workout)) {
+            trainDB->deleteWorkout(workout);
+        }
+    }
+    found = QSet<QString>(videosyncsFound.begin(), videosyncsFound.end());
+    QStringList videosyncs = trainDB->getVideoSyncs();
+    for (const QString &videosync : videosyncs) {
+        if (!found.contains(videosync)) {
+            trainDB->deleteVideoSync(videosync);
+        }
+    }
+    found = QSet<QString>(videosFound.begin(), videosFound.end());
+    QStringList videos = trainDB->getVideos();
+    for (const QString &video : videos) {
+        if (!found.contains(video)) {
+            trainDB->deleteVideo(video);
+        }
+    }
+
     trainDB->endLUW();
 }
 
@@ -807,6 +846,7 @@ WorkoutImportDialog::WorkoutImportDialog(Context *context, QStringList files) :
     setFixedSize(450 *dpiXFactor, 450 *dpiYFactor);
 
     MediaHelper helper;
+    importer = new LibraryImport(context, this);
 
     // sort the wheat from the chaff
     foreach(QString file, files) {
@@ -817,21 +857,14 @@ WorkoutImportDialog::WorkoutImportDialog(Context *context, QStringList files) :
         // media just check file name
         if (helper.isMedia(file)) videos << file;
 
-        // if it is a workout we parse it to check
-        if (ErgFile::isWorkout(file)) {
-            ErgFile *p = new ErgFile(file, ErgFileFormat::unknown, context);
-            if (p->isValid()) workouts << file;
-            delete p;
-        }
-        // if it is a videosync we parse it to check
-        if (VideoSyncFile::isVideoSync(file)) {
-            int mode = 0;
-            VideoSyncFile *p = new VideoSyncFile(file, mode, context);
-            if (p->isValid()) videosyncs << file;
-            delete p;
-        }
-
+        // if it is a workout or videosync we parse it to check,
+        // they are all parsed at once below and kept for import
+        if (ErgFile::isWorkout(file)) importer->addWorkout(file);
+        if (VideoSyncFile::isVideoSync(file)) importer->addVideoSync(file);
     }
+    importer->wait();
+    workouts = importer->workouts();
+    videosyncs = importer->videoSyncs();
 
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -928,8 +961,8 @@ WorkoutImportDialog::import()
         if (!QFile(workout).exists()) continue;
 
         // cannot read or not valid
-        ErgFile file(workout, ErgFileFormat::unknown, context);
-        if (!file.isValid()) continue;
+        const ErgFileBase *file = importer->workout(workout);
+        if (!file) continue;
 
         // get target name
         QString target = workoutDir + "/" + QFileInfo(workout).fileName();
@@ -945,7 +978,7 @@ WorkoutImportDialog::import()
         }
 
         // add to library now
-        trainDB->importWorkout(target, file);
+        trainDB->importWorkout(target, *file);
     }
 
     // set target directory
@@ -963,9 +996,8 @@ WorkoutImportDialog::import()
         if (!QFile(videosync).exists()) continue;
 
         // cannot read or not valid
-        int mode=0;
-        VideoSyncFile file(videosync, mode, context);
-        if (!file.isValid()) continue;
+        const VideoSyncFileBase *file = importer->videoSync(videosync);
+        if (!file) continue;
 
         // get target name
         QString target = videosyncDir + "/" + QFileInfo(videosync).fileName();
@@ -981,7 +1013,7 @@ WorkoutImportDialog::import()
         }
 
         // add to library now
-        trainDB->importVideoSync(target, file);
+        trainDB->importVideoSync(target, *file);
     }
 
     trainDB->endLUW();
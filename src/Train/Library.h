@@ -59,6 +59,7 @@ class Library : QObject
 extern QList<Library *> libraries;        // keep track of all Library search paths for all users
 
 class LibrarySearch;
+class LibraryImport;
 class LibrarySearchDialog : public QDialog
 {
     Q_OBJECT
@@ -74,6 +75,7 @@ class LibrarySearchDialog : public QDialog
         void foundWorkout(QString);
         void foundVideo(QString);
         void foundVideoSync(QString);
+        void importing();
 
         void addDirectory();
         void removeDirectory();
@@ -84,6 +86,7 @@ class LibrarySearchDialog : public QDialog
         Context *context;
         Library *library;
         LibrarySearch *searcher;
+        LibraryImport *importer;
         bool searching;
         int pathIndex, workoutCountN, videoCountN, videosyncCountN;
 
@@ -110,6 +113,7 @@ class LibrarySearchDialog : public QDialog
         QTreeWidgetItem *allPaths;
         QLabel *pathLabelTitle, *mediaCountTitle, *videosyncCountTitle, *workoutCountTitle;
         QLabel *pathLabel, *mediaCount, *videosyncCount, *workoutCount;
+        QLabel *importLabel;
         QPushButton *cancelButton,
                     *searchButton;
 };
@@ -154,6 +158,7 @@ class WorkoutImportDialog : public QDialog
         QStringList files;
  
         QStringList videos, videosyncs, workouts;
+        LibraryImport *importer;
 
         QTreeWidget *fileTable;
         QPushButton *okButton, *cancelButton;
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "LibraryImport.h"
+
+#include "ErgFile.h"
+#include "VideoSyncFile.h"
+
+#include <QFile>
+#include <QCryptographicHash>
+
+LibraryImport::LibraryImport(Context *context, QObject *parent) : QObject(parent), context(context)
+{
+}
+
+LibraryImport::~LibraryImport()
+{
+    // tasks still running refer to the items
+    abort();
+    wait();
+    qDeleteAll(items);
+}
+
+void
+LibraryImport::skipKnown()
+{
+    knownHashes = trainDB->getFileHashes();
+
+    QStringList workouts = trainDB->getWorkouts();
+    knownWorkouts = QSet<QString>(workouts.begin(), workouts.end());
+    QStringList videosyncs = trainDB->getVideoSyncs();
+    knownVideoSyncs = QSet<QString>(videosyncs.begin(), videosyncs.end());
+}
+
+void
+LibraryImport::addWorkout(QString filepath)
+{
+    add(filepath, true);
+}
+
+void
+LibraryImport::addVideoSync(QString filepath)
+{
+    add(filepath, false);
+}
+
+void
+LibraryImport::add(QString filepath, bool isWorkout)
+{
+    Item *item;
+    {
+        QMutexLocker locker(&lock);
+        QHash<QString, Item*> &queued = isWorkout ? workoutItems : videoSyncItems;
+        if (queued.contains(filepath)) return;
+
+        item = new Item(filepath, isWorkout);
+        items << item;
+        queued.insert(filepath, item);
+    }
+    counts[Queued].ref();
+
+    group.run([this, item]() { TaskStageTimer timer("library import"); process(item); });
+}
+
+void
+LibraryImport::abort()
+{
+    aborted.storeRelease(1);
+}
+
+void
+LibraryImport::wait()
+{
+    group.wait();
+}
+
+// hash then parse, on a worker thread
+void
+LibraryImport::process(Item *item)
+{
+    if (aborted.loadAcquire()) return;
+
+    item->hash = contentHash(item->filepath);
+    counts[Hashed].ref();
+
+    // unchanged since we last imported it
+    const QSet<QString> &known = item->isWorkout ? knownWorkouts : knownVideoSyncs;
+    if (!item->hash.isEmpty() && knownHashes.value(item->filepath) == item->hash && known.contains(item->filepath)) {
+        item->state = Skipped;
+        counts[Unchanged].ref();
+
+    } else if (item->isWorkout) {
+        ErgFile file(item->filepath, ErgFileFormat::unknown, context);
+        if (file.isValid()) {
+            item->erg = file;
+            item->state = Valid;
+        } else item->state = Invalid;
+        counts[Parsed].ref();
+
+    } else {
+        int mode = 0;
+        VideoSyncFile file(item->filepath, mode, context);
+        if (file.isValid()) {
+            item->sync = file;
+            item->state = Valid;
+        } else item->state = Invalid;
+        counts[Parsed].ref();
+    }
+
+    // don't flood the event loop, every so often and when all are done
+    int n = done.fetchAndAddOrdered(1) + 1;
+    int queued = counts[Queued].loadAcquire();
+    if (n % 64 == 0 || n == queued) emit progress(n, queued);
+}
+
+QStringList
+LibraryImport::workouts() const
+{
+    QMutexLocker locker(&lock);
+    QStringList ret;
+    foreach (Item *item, items)
+        if (item->isWorkout && (item->state == Valid || item->state == Skipped)) ret << item->filepath;
+    return ret;
+}
+
+QStringList
+LibraryImport::videoSyncs() const
+{
+    QMutexLocker locker(&lock);
+    QStringList ret;
+    foreach (Item *item, items)
+        if (!item->isWorkout && (item->state == Valid || item->state == Skipped)) ret << item->filepath;
+    return ret;
+}
+
+const ErgFileBase *
+LibraryImport::workout(QString filepath) const
+{
+    QMutexLocker locker(&lock);
+    Item *item = workoutItems.value(filepath, nullptr);
+    return (item && item->state == Valid) ? &item->erg : nullptr;
+}
+
+const VideoSyncFileBase *
+LibraryImport::videoSync(QString filepath) const
+{
+    QMutexLocker locker(&lock);
+    Item *item = videoSyncItems.value(filepath, nullptr);
+    return (item && item->state == Valid) ? &item->sync : nullptr;
+}
+
+bool
+LibraryImport::write(ImportMode importMode)
+{
+    wait();
+
+    QList<Item*> all;
+    {
+        QMutexLocker locker(&lock);
+        all = items;
+    }
+
+    bool ok = true;
+    int n = 0;
+    foreach (Item *item, all) {
+        if (item->state != Valid) continue;
+
+        bool imported;
+        if (item->isWorkout) imported = trainDB->importWorkout(item->filepath, item->erg, importMode);
+        else imported = trainDB->importVideoSync(item->filepath, item->sync, importMode);
+
+        // only remember what made it in, so a failure is retried next time
+        if (imported && !item->hash.isEmpty()) trainDB->setFileHash(item->filepath, item->hash);
+        ok &= imported;
+
+        counts[Written].ref();
+        if (++n % 64 == 0) emit progress(done.loadAcquire(), counts[Queued].loadAcquire());
+    }
+    emit progress(done.loadAcquire(), counts[Queued].loadAcquire());
+    return ok;
+}
+
+QString
+LibraryImport::contentHash(QString filepath)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    while (!file.atEnd()) {
+        hash.addData(file.read(65536));
+    }
+    return hash.result().toHex();
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_LibraryImport_h
+#define _GC_LibraryImport_h 1
+
+#include "TaskScheduler.h"
+#include "TrainDB.h"
+#include "ErgFileBase.h"
+#include "VideoSyncFileBase.h"
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QStringList>
+
+class Context;
+
+//
+// Importing workouts and videosyncs into the library.
+//
+// Files are queued as they are found and each is hashed and then parsed on
+// the task scheduler, so reading them keeps up with the directory walk and
+// uses every core. Only the metadata TrainDB keeps is held on to, not the
+// parsed points.
+//
+// With skipKnown() a file TrainDB already holds whose content hash is the
+// same as when it was last imported is not parsed or written again, so a
+// rescan of a large collection only reads what has changed.
+//
+// TrainDB is only ever used from the thread that owns it, by skipKnown()
+// and write(), which does all the inserts in the caller's transaction.
+//
+class LibraryImport : public QObject
+{
+    Q_OBJECT
+
+    public:
+
+        // stages a file goes through, for progress
+        enum Stage { Queued=0, Hashed, Unchanged, Parsed, Written, Stages };
+
+        LibraryImport(Context *context, QObject *parent=nullptr);
+        ~LibraryImport();
+
+        // read the hashes of what TrainDB holds, before any files are added
+        void skipKnown();
+
+        // queue a file to hash and parse, the same file is only queued once
+        void addWorkout(QString filepath);
+        void addVideoSync(QString filepath);
+
+        // stop parsing, anything not yet started is dropped
+        void abort();
+
+        // block until all the files queued have been parsed
+        void wait();
+
+        // the files that are valid in the order they were queued, including
+        // those skipped as unchanged; call after wait()
+        QStringList workouts() const;
+        QStringList videoSyncs() const;
+
+        // what was parsed, null if it was skipped or isn't valid
+        const ErgFileBase *workout(QString filepath) const;
+        const VideoSyncFileBase *videoSync(QString filepath) const;
+
+        // write all that was parsed to TrainDB and remember the hashes, the
+        // caller brackets it with startLUW/endLUW
+        bool write(ImportMode importMode = ImportMode::insertOrUpdate);
+
+        int count(Stage stage) const { return counts[stage].loadAcquire(); }
+
+        // md5 of the file content as hex, empty if it can't be read
+        static QString contentHash(QString filepath);
+
+    signals:
+        // emitted as files are done, from the worker threads
+        void progress(int done, int queued);
+
+    private:
+
+        enum State { Pending=0, Skipped, Valid, Invalid };
+
+        struct Item {
+            Item(QString filepath, bool isWorkout) : filepath(filepath), isWorkout(isWorkout), state(Pending) {}
+            QString filepath;
+            QString hash;
+            bool isWorkout;
+            State state;
+            ErgFileBase erg;
+            VideoSyncFileBase sync;
+        };
+
+        void add(QString filepath, bool isWorkout);
+        void process(Item *item);
+
+        Context *context;
+
+        // what TrainDB had when skipKnown() was called, read-only after
+        QHash<QString, QString> knownHashes;
+        QSet<QString> knownWorkouts, knownVideoSyncs;
+
+        mutable QMutex lock;
+        QList<Item*> items;
+        QHash<QString, Item*> workoutItems, videoSyncItems;
+
+        TaskGroup group;
+        QAtomicInt aborted;
+        QAtomicInt done;
+        QAtomicInt counts[Stages];
+};
+
+#endif // _GC_LibraryImport_h
@@ -21,6 +21,8 @@
 #include "RealtimeData.h"
 #include "Units.h"
 
+#include <cstring>
+
 #ifdef Q_CC_MSVC
 // 'strcpy': This function or variable may be unsafe.
 #pragma warning(disable:4996)
@@ -68,6 +70,45 @@ bool RealtimeController::doesLoad() { return false; }
 void RealtimeController::getRealtimeData(RealtimeData &) { }
 void RealtimeController::pushRealtimeData(RealtimeData &) { } // update realtime data with current values
 
+TelemetrySample
+RealtimeController::telemetrySample(const RealtimeData &rtData, quint32 channels)
+{
+    TelemetrySample sample;
+    memset(&sample, 0, sizeof(sample));
+
+    sample.channels = channels;
+    sample.cad = rtData.getCadence();
+    sample.hr = rtData.getHr();
+    sample.km = rtData.getDistance();
+    sample.kph = rtData.getSpeed();
+    sample.watts = rtData.getWatts();
+    sample.alt = rtData.getAltitude();
+    sample.lon = rtData.getLongitude();
+    sample.lat = rtData.getLatitude();
+    sample.slope = rtData.getSlope();
+    sample.temp = rtData.getTemp();
+    sample.interval = rtData.getLap();
+    sample.lrbalance = rtData.getLRBalance();
+    sample.lte = rtData.getLTE();
+    sample.rte = rtData.getRTE();
+    sample.lps = rtData.getLPS();
+    sample.rps = rtData.getRPS();
+    sample.smo2 = rtData.getSmO2();
+    sample.thb = rtData.gettHb();
+    sample.o2hb = rtData.getO2Hb();
+    sample.hhb = rtData.getHHb();
+    sample.target = rtData.getLoad();
+    sample.rppb = rtData.getRppb();
+    sample.rppe = rtData.getRppe();
+    sample.rpppb = rtData.getRpppb();
+    sample.rpppe = rtData.getRpppe();
+    sample.lppb = rtData.getLppb();
+    sample.lppe = rtData.getLppe();
+    sample.lpppb = rtData.getLpppb();
+    sample.lpppe = rtData.getLpppe();
+    return sample;
+}
+
 // Estimate Power From Speed
 //
 // Simply mapping current speed sample to power has significant error for intervals
@@ -23,6 +23,7 @@
 #include "RealtimeData.h"
 #include "CalibrationData.h"
 #include "TrainSidebar.h"
+#include "TelemetryRecorder.h"
 #include "PolynomialRegression.h"
 
 #include "GoldenCheetah.h"
@@ -100,6 +101,13 @@ public:
     virtual void getRealtimeData(RealtimeData &rtData); // update realtime data with current values
     virtual void pushRealtimeData(RealtimeData &rtData); // update realtime data with current values
 
+    // record the channels as they arrive from the device's own thread, returns those it
+    // will, the rest must be recorded when polled; null recorder to stop
+    virtual quint32 setRecorder(TelemetryRecorder *, int, quint32) { return 0; }
+
+    // the channels of telemetry for recording
+    static TelemetrySample telemetrySample(const RealtimeData &rtData, quint32 channels);
+
     // only relevant for Computrainer like devices
     virtual void setLoad(double) { return; }
     virtual void setGradient(double) { return; }
@@ -129,6 +137,7 @@ public:
     // post process, based upon device configuration
     void processRealtimeData(RealtimeData &rtData);
     void processSetup();
+    bool estimatesPower() const { return polyFit != NULL; } // power is worked out when polled
 
 signals:
     void setNotification(QString text, int timeout);
@@ -23,7 +23,9 @@
 #include <qwt_plot_curve.h>
 #include <qwt_plot_canvas.h>
 #include <qwt_plot_grid.h>
+#include <qwt_scale_engine.h>
 #include "RealtimePlot.h"
+#include "LogTimeScaleDraw.h"
 #include "Context.h"
 #include "Colors.h"
 
@@ -538,3 +540,67 @@ RealtimePlot::setSmoothing(int value)
 {
     smooth = value;
 }
+
+RealtimeBestsPlot::RealtimeBestsPlot(Context *context) : context(context)
+{
+    setAxisTitle(QwtAxis::YLeft, tr("Watts"));
+    setAxisTitle(QwtAxis::XBottom, tr("Session Bests"));
+    setAxisMaxMinor(QwtAxis::YLeft, 0);
+
+    // Log scale on x-axis, as the CP chart
+    LogTimeScaleDraw *ltsd = new LogTimeScaleDraw;
+    ltsd->setTickLength(QwtScaleDiv::MajorTick, 3);
+    setAxisScaleDraw(QwtAxis::XBottom, ltsd);
+    setAxisScaleEngine(QwtAxis::XBottom, new QwtLogScaleEngine);
+    setAxisScale(QwtAxis::XBottom, 1, 3600);
+    axisWidget(QwtAxis::YLeft)->scaleDraw()->setTickLength(QwtScaleDiv::MajorTick, 3);
+
+    bestsCurve = new QwtPlotCurve(tr("Session Bests"));
+    bestsCurve->setRenderHint(QwtPlotItem::RenderAntialiased);
+    bestsCurve->attach(this);
+    bestsCurve->setYAxis(QwtAxis::YLeft);
+
+    static_cast<QwtPlotCanvas*>(canvas())->setFrameStyle(QFrame::NoFrame);
+
+    connect(context, SIGNAL(configChanged(qint32)), this, SLOT(configChanged(qint32)));
+
+    // set to current config
+    configChanged(CONFIG_APPEARANCE); // set colors
+}
+
+void
+RealtimeBestsPlot::configChanged(qint32)
+{
+    double width = appsettings->value(this, GC_LINEWIDTH, 0.5*dpiXFactor).toDouble();
+
+    setCanvasBackground(GColor(CTRAINPLOTBACKGROUND));
+
+    QPalette pal;
+    pal.setColor(QPalette::WindowText, GColor(CPOWER));
+    pal.setColor(QPalette::Text, GColor(CPOWER));
+    axisWidget(QwtAxis::YLeft)->setPalette(pal);
+    pal.setColor(QPalette::WindowText, GColor(CPLOTMARKER));
+    pal.setColor(QPalette::Text, GColor(CPLOTMARKER));
+    axisWidget(QwtAxis::XBottom)->setPalette(pal);
+
+    QPen bestspen = QPen(GColor(CRIDECP));
+    bestspen.setWidth(width);
+    bestsCurve->setPen(bestspen);
+
+    replot();
+}
+
+void
+RealtimeBestsPlot::setBests(const QVector<float> &bests)
+{
+    // index 0 is unused, the rest are a second apart
+    QVector<double> x, y;
+    for (int i=1; i<bests.count(); i++) {
+        x << i;
+        y << bests[i];
+    }
+    bestsCurve->setSamples(x, y);
+    setAxisScale(QwtAxis::XBottom, 1, qMax(60, int(bests.count())));
+
+    if (isVisible()) replot();
+}
@@ -318,5 +318,24 @@ class RealtimePlot : public QwtPlot
 
 
 
+// best power for each duration so far this session, as the
+// recorder finds it, over a log scale of seconds as the CP chart
+class RealtimeBestsPlot : public QwtPlot
+{
+    Q_OBJECT
+    G_OBJECT
+
+    public:
+    RealtimeBestsPlot(Context *context);
+
+    public slots:
+    void configChanged(qint32);
+    void setBests(const QVector<float> &bests);
+
+    private:
+    Context *context;
+    QwtPlotCurve *bestsCurve;
+};
+
 #endif // _GC_RealtimePlot_h
 
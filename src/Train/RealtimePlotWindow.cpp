@@ -64,6 +64,10 @@ RealtimePlotWindow::RealtimePlotWindow(Context *context) :
     showPow30s->setCheckState(Qt::Checked);
     cl->addWidget(showPow30s);
 
+    showBests = new QCheckBox(tr("Session Bests"), this);
+    showBests->setCheckState(Qt::Unchecked);
+    cl->addWidget(showBests);
+
     showSmO2 = new QCheckBox(tr("SmO2"), this);
     showSmO2->setCheckState(Qt::Checked);
     cl->addWidget(showSmO2);
@@ -100,11 +104,15 @@ RealtimePlotWindow::RealtimePlotWindow(Context *context) :
     QVBoxLayout *layout = new QVBoxLayout;
     rtPlot = new RealtimePlot(context);
     layout->addWidget(rtPlot);
+    bestsPlot = new RealtimeBestsPlot(context);
+    bestsPlot->setVisible(false);
+    layout->addWidget(bestsPlot);
     setChartLayout(layout);
 
     // common controls
     connect(showPower, SIGNAL(stateChanged(int)), this, SLOT(setShowPower(int)));
     connect(showPow30s, SIGNAL(stateChanged(int)), this, SLOT(setShowPow30s(int)));
+    connect(showBests, SIGNAL(stateChanged(int)), this, SLOT(setShowBests(int)));
     connect(showHr, SIGNAL(stateChanged(int)), this, SLOT(setShowHr(int)));
     connect(showSpeed, SIGNAL(stateChanged(int)), this, SLOT(setShowSpeed(int)));
     connect(showCad, SIGNAL(stateChanged(int)), this, SLOT(setShowCad(int)));
@@ -118,6 +126,7 @@ RealtimePlotWindow::RealtimePlotWindow(Context *context) :
 
     // get updates..
     connect(context, SIGNAL(telemetryUpdate(RealtimeData)), this, SLOT(telemetryUpdate(RealtimeData)));
+    connect(context, SIGNAL(sessionBests(QVector<float>)), bestsPlot, SLOT(setBests(QVector<float>)));
     connect(context, SIGNAL(configChanged(qint32)), this, SLOT(configChanged(qint32)));
 
     // lets initialise all the smoothing variables
@@ -304,6 +313,14 @@ RealtimePlotWindow::setShowPow30s(int value)
     rtPlot->replot();
 }
 
+void
+RealtimePlotWindow::setShowBests(int value)
+{
+    showBests->setChecked(value);
+    bestsPlot->setVisible(value == Qt::Checked);
+    if (value == Qt::Checked) bestsPlot->replot();
+}
+
 void
 RealtimePlotWindow::setShowPower(int value)
 {
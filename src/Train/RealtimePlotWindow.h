@@ -51,6 +51,7 @@ class RealtimePlotWindow : public GcChartWindow
     Q_PROPERTY(int showtHb READ isShowtHb WRITE setShowtHb USER true)
     Q_PROPERTY(int showSmO2 READ isShowSmO2 WRITE setShowSmO2 USER true)
     Q_PROPERTY(int showPow30s READ isShowPow30s WRITE setShowPow30s USER true)
+    Q_PROPERTY(int showBests READ isShowBests WRITE setShowBests USER true)
     Q_PROPERTY(int smoothing READ smoothing WRITE setSmoothing USER true)
 
     public:
@@ -68,6 +69,7 @@ class RealtimePlotWindow : public GcChartWindow
         int isShowtHb() const { return showtHb->checkState(); }
         int isShowSmO2() const { return showSmO2->checkState(); }
         int isShowPow30s() const { return showPow30s->checkState(); }
+        int isShowBests() const { return showBests->checkState(); }
         int smoothing() const { return smoothSlider->value(); }
 
    public slots:
@@ -88,6 +90,7 @@ class RealtimePlotWindow : public GcChartWindow
         void setShowSmO2(int state);
         void setShowtHb(int state);
         void setShowPow30s(int state);
+        void setShowBests(int state);
         void setShowHr(int state);
         void setShowSpeed(int state);
         void setShowCad(int state);
@@ -98,6 +101,7 @@ class RealtimePlotWindow : public GcChartWindow
 
         Context *context;
         RealtimePlot *rtPlot;
+        RealtimeBestsPlot *bestsPlot;
         bool active;
 
         // Common controls
@@ -112,6 +116,7 @@ class RealtimePlotWindow : public GcChartWindow
         QCheckBox *showSmO2;
         QCheckBox *showtHb;
         QCheckBox *showPow30s;
+        QCheckBox *showBests;
         QSlider *smoothSlider;
         QLineEdit *smoothLineEdit;
 
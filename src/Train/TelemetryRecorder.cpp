@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "TelemetryRecorder.h"
+
+#include <QTextStream>
+#include <QSaveFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+
+static const quint32 TelemetryMagic = 0x4754454c; // GTEL
+
+// written as is, the file only lives for the session on this machine
+struct TelemetryHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 size;               // sizeof(TelemetrySample)
+};
+
+TelemetryRecorder::TelemetryRecorder() : base(0), running(0), stopping(0), lost(0),
+    powerTick(0), powerMsecs(0), powerWatts(0), hasPower(false), bestsVersion(0)
+{
+    clock.start();
+}
+
+TelemetryRecorder::~TelemetryRecorder()
+{
+    close();
+}
+
+bool
+TelemetryRecorder::open(QString filename)
+{
+    close();
+
+    file.setFileName(filename);
+    if (!file.open(QFile::WriteOnly | QFile::Truncate)) return false;
+
+    TelemetryHeader header = { TelemetryMagic, TELEMETRY_RECORDER_VERSION, quint32(sizeof(TelemetrySample)) };
+    file.write((const char*)&header, sizeof(header));
+
+    // anything left over from last time
+    TelemetrySample discard;
+    for (int i=0; i<Sources; i++) while (samples[i].pop(discard)) ;
+
+    running = 0;
+    stopping = 0;
+    lost = 0;
+
+    // a new session
+    power.clear();
+    powerTick = powerMsecs = 0;
+    powerWatts = 0;
+    hasPower = false;
+    bestsVersion.fetchAndAddRelease(1);
+
+    start();
+    return true;
+}
+
+bool
+TelemetryRecorder::push(int source, const TelemetrySample &sample)
+{
+    if (samples[source].push(sample)) return true;
+    lost.fetchAndAddRelaxed(1);
+    return false;
+}
+
+void
+TelemetryRecorder::setSessionTime(qint64 msecs, bool running)
+{
+    base.storeRelease(clock.elapsed() - msecs);
+    this->running.storeRelease(running ? 1 : 0);
+}
+
+void
+TelemetryRecorder::close()
+{
+    if (!file.isOpen()) return;
+
+    running = 0;
+    stopping = 1;
+    wait();
+
+    // anything pushed since the thread last looked
+    drain();
+    file.close();
+}
+
+void
+TelemetryRecorder::drain()
+{
+    TelemetrySample sample;
+    QVector<TelemetrySample> watts;
+    bool wrote = false;
+    for (int i=0; i<Sources; i++) {
+        while (samples[i].pop(sample)) {
+            file.write((const char*)&sample, sizeof(sample));
+            if (sample.channels & TelemetrySample::Power) watts << sample;
+            wrote = true;
+        }
+    }
+
+    // handed to the OS, so if we crash all but the last
+    // moments can be recovered when we next start
+    if (wrote) file.flush();
+
+    if (watts.count()) best(watts);
+}
+
+void
+TelemetryRecorder::best(const QVector<TelemetrySample> &drained)
+{
+    // in order, as convert() does
+    QVector<TelemetrySample> watts = drained;
+    std::stable_sort(watts.begin(), watts.end(), [](const TelemetrySample &a, const TelemetrySample &b) { return a.msecs < b.msecs; });
+
+    // the latest watts in each second, a second is only complete once
+    // a sample arrives for a later one. Seconds without any are gaps in
+    // recording and counted as zero by the search, a sample that arrives
+    // late from a slower source only counts in the second being collected
+    QVector<double> secs, values;
+    foreach(const TelemetrySample &x, watts) {
+        qint64 tick = (qMax(qint64(0), x.msecs) + 999) / 1000;
+        if (hasPower && tick > powerTick) {
+            secs << powerTick;
+            values << powerWatts;
+        }
+        if (!hasPower || tick > powerTick) {
+            powerTick = tick;
+            powerMsecs = x.msecs;
+            powerWatts = x.watts;
+        } else if (x.msecs >= powerMsecs) {
+            powerMsecs = x.msecs;
+            powerWatts = x.watts;
+        }
+        hasPower = true;
+    }
+
+    // only the windows ending in the new seconds are searched
+    if (secs.count() && power.append(secs.constData(), values.constData(), 0, secs.count()))
+        bestsVersion.fetchAndAddRelease(1);
+}
+
+void
+TelemetryRecorder::run()
+{
+    while (!stopping) {
+        drain();
+        msleep(250);
+    }
+}
+
+bool
+TelemetryRecorder::convert(QString from, QString to, int interval)
+{
+    QFile in(from);
+    if (!in.open(QFile::ReadOnly)) return false;
+
+    TelemetryHeader header;
+    if (in.read((char*)&header, sizeof(header)) != sizeof(header) || header.magic != TelemetryMagic ||
+        header.version != TELEMETRY_RECORDER_VERSION || header.size != sizeof(TelemetrySample)) return false;
+
+    QSaveFile out(to);
+    if (!out.open(QFile::WriteOnly | QFile::Truncate)) return false;
+
+    QTextStream stream(&out);
+    stream << "secs, cad, hr, km, kph, nm, watts, alt, lon, lat, headwind, slope, temp, interval, lrbalance, lte, rte, lps, rps, smo2, thb, o2hb, hhb, target, rppb, rppe, rpppb, rpppe, lppb, lppe, lpppb, lpppe\n";
+
+    // the sources are written as they are drained, so
+    // put them back in order, a truncated last sample is
+    // what we'd expect after a crash
+    QVector<TelemetrySample> samples;
+    TelemetrySample sample;
+    while (in.read((char*)&sample, sizeof(sample)) == sizeof(sample)) samples << sample;
+    std::stable_sort(samples.begin(), samples.end(), [](const TelemetrySample &a, const TelemetrySample &b) { return a.msecs < b.msecs; });
+
+    // the latest value of each channel
+    TelemetrySample s;
+    memset(&s, 0, sizeof(s));
+
+    for (int i=0; i<samples.count(); ) {
+
+        // everything up to the end of the interval the next sample is in
+        qint64 tick = (qMax(qint64(0), samples[i].msecs) + interval - 1) / interval;
+        for (; i<samples.count() && samples[i].msecs <= tick * interval; i++) {
+            const TelemetrySample &x = samples[i];
+            if (x.channels & TelemetrySample::Cadence) s.cad = x.cad;
+            if (x.channels & TelemetrySample::HeartRate) s.hr = x.hr;
+            if (x.channels & TelemetrySample::Distance) s.km = x.km;
+            if (x.channels & TelemetrySample::Speed) s.kph = x.kph;
+            if (x.channels & TelemetrySample::Power) {
+                s.watts = x.watts;
+                s.lrbalance = x.lrbalance;
+                s.lte = x.lte;
+                s.rte = x.rte;
+                s.lps = x.lps;
+                s.rps = x.rps;
+                s.rppb = x.rppb;
+                s.rppe = x.rppe;
+                s.rpppb = x.rpppb;
+                s.rpppe = x.rpppe;
+                s.lppb = x.lppb;
+                s.lppe = x.lppe;
+                s.lpppb = x.lpppb;
+                s.lpppe = x.lpppe;
+            }
+            if (x.channels & TelemetrySample::Moxy) {
+                s.smo2 = x.smo2;
+                s.thb = x.thb;
+                s.o2hb = x.o2hb;
+                s.hhb = x.hhb;
+            }
+            if (x.channels & TelemetrySample::Temp) s.temp = x.temp;
+            if (x.channels & TelemetrySample::Location) {
+                s.alt = x.alt;
+                s.lon = x.lon;
+                s.lat = x.lat;
+            }
+            if (x.channels & TelemetrySample::Workout) {
+                s.slope = x.slope;
+                s.target = x.target;
+                s.interval = x.interval;
+            }
+        }
+
+        // location data needs more than the default precision of 6
+        stream << (tick * interval) / 1000.0
+               << "," << s.cad
+               << "," << s.hr
+               << "," << s.km
+               << "," << s.kph
+               << "," << 0 // nm
+               << "," << s.watts
+               << "," << QString::number(s.alt, 'g', 20)
+               << "," << QString::number(s.lon, 'g', 20)
+               << "," << QString::number(s.lat, 'g', 20)
+               << "," // headwind
+               << "," << s.slope
+               << "," << s.temp
+               << "," << s.interval
+               << "," << s.lrbalance
+               << "," << s.lte
+               << "," << s.rte
+               << "," << s.lps
+               << "," << s.rps
+               << "," << s.smo2
+               << "," << s.thb
+               << "," << s.o2hb
+               << "," << s.hhb
+               << "," << s.target
+               << "," << s.rppb
+               << "," << s.rppe
+               << "," << s.rpppb
+               << "," << s.rpppe
+               << "," << s.lppb
+               << "," << s.lppe
+               << "," << s.lpppb
+               << "," << s.lpppe
+               << "," << "\n";
+    }
+    stream.flush();
+
+    return out.commit();
+}
+
+QStringList
+TelemetryRecorder::recover(QString directory, int interval)
+{
+    QStringList returning;
+
+    QDir dir(directory);
+    foreach(QFileInfo info, dir.entryInfoList(QStringList() << "*.tlm", QDir::Files)) {
+
+        // left by a crash, or by a stop that didn't finish converting
+        QString csv = info.absolutePath() + "/" + info.completeBaseName() + ".csv";
+        if (convert(info.absoluteFilePath(), csv, interval)) {
+            QFile::remove(info.absoluteFilePath());
+            returning << csv;
+        }
+    }
+    return returning;
+}
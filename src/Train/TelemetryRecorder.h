@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 GoldenCheetah Developers
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef _GC_TelemetryRecorder_h
+#define _GC_TelemetryRecorder_h 1
+
+#include <QThread>
+#include <QAtomicInt>
+#include <QString>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include "MeanMaxEngine.h"
+
+//
+// Records the telemetry for a train session.
+//
+// Samples are pushed as the telemetry arrives; by device controllers that
+// record from their own thread at the rate the sensors send, and by the
+// train view for the channels it works out itself (distance, the workout
+// and location) or polls from devices that don't record. Each source has
+// a single producer, single consumer ring buffer that never blocks or takes
+// a lock, and a background thread takes them out and appends them to a
+// binary file as they are. Neither the devices nor the GUI thread wait on
+// the disk, and a stalled GUI thread doesn't stop the devices recording.
+//
+// Each sample is timestamped with the session time and only holds the
+// channels its source supplies. When the session ends the binary file is
+// converted to the GoldenCheetah CSV format with one row each recording
+// interval, holding the latest value of each channel, so the ride can be
+// imported along with the r-r, vo2, tcore and position files recorded
+// alongside it. A binary file left behind by a crash is converted by
+// recover() the next time the train view starts.
+//
+// The background thread also appends the power, a second at a time, to a
+// mean-max search as it writes it, so the best power for each duration
+// this session can be shown as it is ridden without the GUI thread doing
+// the search.
+//
+// change history
+// version  date       who                     what
+// 1        Oct 2026   GoldenCheetah Devs      initial version
+// 2        Oct 2026   GoldenCheetah Devs      samples from many sources, with the channels they hold
+//
+#define TELEMETRY_RECORDER_VERSION 2
+
+struct TelemetrySample
+{
+    // the channels a sample holds, the other values are ignored
+    enum channel { Cadence=0x1, HeartRate=0x2, Distance=0x4, Speed=0x8,
+                   Power=0x10,      // watts, balance, effectiveness, smoothness and pedal phases
+                   Moxy=0x20,       // smo2, thb, o2hb and hhb
+                   Temp=0x40,
+                   Location=0x80,   // alt, lon and lat
+                   Workout=0x100,   // slope, target and interval
+                   All=0x1ff };
+
+    qint64 msecs;               // session time
+    quint32 channels;
+    double km, alt, lon, lat;   // need the precision
+    float cad, hr, kph, watts, slope, temp, target;
+    float lrbalance, lte, rte, lps, rps;
+    float smo2, thb, o2hb, hhb;
+    float rppb, rppe, rpppb, rpppe, lppb, lppe, lpppb, lpppe;
+    qint32 interval;
+};
+
+// N must be a power of 2, push from one thread and pop from one other
+template <class T, int N>
+class TelemetryRing
+{
+    public:
+
+        TelemetryRing() : head(0), tail(0) {}
+
+        bool push(const T &x) {
+            unsigned int h = head.loadRelaxed();
+            if (h - unsigned(tail.loadAcquire()) == unsigned(N)) return false; // full
+            items[h & (N-1)] = x;
+            head.storeRelease(h+1);
+            return true;
+        }
+
+        bool pop(T &x) {
+            unsigned int t = tail.loadRelaxed();
+            if (unsigned(head.loadAcquire()) == t) return false; // empty
+            x = items[t & (N-1)];
+            tail.storeRelease(t+1);
+            return true;
+        }
+
+    private:
+
+        QAtomicInt head, tail;  // free running, wrap together
+        T items[N];
+};
+
+class TelemetryRecorder : public QThread
+{
+    public:
+
+        // sources of samples, each pushes from a single thread
+        static const int Sources = 8;
+
+        TelemetryRecorder();
+        ~TelemetryRecorder();
+
+        // start recording to filename, false if it can't be written
+        bool open(QString filename);
+
+        // add a sample, from the one thread that records for source; false
+        // if the writer has fallen too far behind to take it
+        bool push(int source, const TelemetrySample &sample);
+
+        // the session clock, set from the GUI thread as the session starts,
+        // pauses and resumes and read by all the sources
+        void setSessionTime(qint64 msecs, bool running);
+        qint64 sessionTime() const { return clock.elapsed() - base.loadAcquire(); }
+        bool isRecording() const { return running.loadAcquire(); }
+
+        // write whatever is left and stop
+        void close();
+        int dropped() const { return lost.loadRelaxed(); }
+        QString fileName() const { return file.fileName(); }
+
+        // best watts for each duration this session, in seconds, as
+        // MeanMaxEngine::bests(). The version changes when they do
+        QVector<float> sessionBests() const { return power.bests(); }
+        int sessionBestsVersion() const { return bestsVersion.loadAcquire(); }
+
+        // write the samples as GoldenCheetah CSV, one row for each
+        // interval ms that has any
+        static bool convert(QString from, QString to, int interval);
+
+        // convert the binary files a crash left in directory to CSV
+        // alongside them, returns the CSV files written
+        static QStringList recover(QString directory, int interval);
+
+    protected:
+
+        void run() override;
+
+    private:
+
+        void drain();
+        void best(const QVector<TelemetrySample> &drained);
+
+        QFile file;
+        QElapsedTimer clock;
+        QAtomicInteger<qint64> base;
+        QAtomicInt running, stopping, lost;
+        TelemetryRing<TelemetrySample, 1024> samples[Sources]; // over 4 minutes each at 4 a second
+
+        // session bests, only touched by the thread draining
+        MeanMaxEngine power;
+        qint64 powerTick;           // the second being collected
+        qint64 powerMsecs;          // and the latest sample in it
+        float powerWatts;
+        bool hasPower;
+        QAtomicInt bestsVersion;
+};
+#endif // _GC_TelemetryRecorder_h
@@ -112,6 +112,14 @@
     "displayname TEXT NOT NULL," \
     "PRIMARY KEY(filepath)"
 
+// content of the files when they were last imported, so
+// a rescan can skip those that haven't changed
+#define TABLE_FILEHASH "filehash"
+#define FIELDS_FILEHASH \
+    "filepath TEXT NOT NULL UNIQUE," \
+    "hash TEXT NOT NULL," \
+    "PRIMARY KEY(filepath)"
+
 
 static int TrainDBSchemaVersion = 2;
 TrainDB *trainDB;
@@ -517,6 +525,66 @@ TrainDB::getWorkoutHashes
 }
 
 
+QStringList
+TrainDB::getVideos
+() const
+{
+    QStringList ret;
+    QSqlQuery query(connection());
+    query.prepare("SELECT filepath FROM video");
+    if (query.exec()) {
+        while (query.next()) {
+            ret << query.value(0).toString();
+        }
+    }
+    return ret;
+}
+
+
+QStringList
+TrainDB::getVideoSyncs
+() const
+{
+    QStringList ret;
+    QSqlQuery query(connection());
+    query.prepare("SELECT filepath FROM videosync WHERE source IS NOT 'gcdefault'");
+    if (query.exec()) {
+        while (query.next()) {
+            ret << query.value(0).toString();
+        }
+    }
+    return ret;
+}
+
+
+QHash<QString, QString>
+TrainDB::getFileHashes
+() const
+{
+    QHash<QString, QString> ret;
+    QSqlQuery query(connection());
+    query.prepare("SELECT filepath, hash FROM filehash");
+    if (query.exec()) {
+        while (query.next()) {
+            ret.insert(query.value(0).toString(), query.value(1).toString());
+        }
+    }
+    return ret;
+}
+
+
+bool
+TrainDB::setFileHash
+(QString filepath, QString hash) const
+{
+    QSqlQuery query(connection());
+    query.prepare("INSERT OR REPLACE INTO filehash (filepath, hash) VALUES (:filepath, :hash)");
+    query.bindValue(":filepath", filepath);
+    query.bindValue(":hash", hash);
+    return query.exec();
+}
+
+
 ///////////////////////// Helpers for Taggable / Workout
 
 bool
@@ -730,7 +798,8 @@ TrainDB::checkDBVersion
                << TABLE_VIDEO
                << TABLE_VIDEOSYNC
                << TABLE_TAGSTORE
-               << TABLE_WORKOUT_TAG;
+               << TABLE_WORKOUT_TAG
+               << TABLE_FILEHASH;
 
     // can we get a version number?
     QSqlQuery query("SELECT table_name, schema_version, creation_date FROM version", connection());
@@ -1290,6 +1359,7 @@ TrainDB::createAllDataTables
     if (ret > 0) {
         ok &= createDefaultEntriesWorkoutTags();
     }
+    ok &= createTable(TABLE_FILEHASH, FIELDS_FILEHASH) != -1;
     return ok;
 }
 
@@ -1303,6 +1373,7 @@ TrainDB::dropAllDataTables
     ok &= dropTable(TABLE_VIDEOSYNC);
     ok &= dropTable(TABLE_TAGSTORE);
     ok &= dropTable(TABLE_WORKOUT_TAG);
+    ok &= dropTable(TABLE_FILEHASH);
     return ok;
 }
 
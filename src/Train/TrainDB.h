@@ -163,6 +163,12 @@ class TrainDB : public QObject, public TagStore
 
         virtual QStringList getWorkouts() const;
         virtual QHash<QString, QString> getWorkoutHashes() const;
+        QStringList getVideos() const;
+        QStringList getVideoSyncs() const;
+
+        // content hashes of the files as last imported, filepath -> hash
+        QHash<QString, QString> getFileHashes() const;
+        bool setFileHash(QString filepath, QString hash) const;
 
         // Implementation of TagStore
         virtual void deferTagSignals(bool deferred);
@@ -374,7 +374,6 @@ TrainSidebar::TrainSidebar(Context *context) : GcWindow(context), context(contex
 
     // now the GUI is setup lets sort our control variables
     gui_timer = new QTimer(this);
-    disk_timer = new QTimer(this);
     load_timer = new QTimer(this);
     start_timer = new QTimer(this);
     start_timer->setSingleShot(true);
@@ -386,7 +385,13 @@ TrainSidebar::TrainSidebar(Context *context) : GcWindow(context), context(contex
     secs_to_start = 0;
 
     rrFile = posFile = recordFile = vo2File = tcoreFile = NULL;
-    lastRecordSecs = 0;
+    polledChannels = TelemetrySample::All;
+    bestsVersion = recorder.sessionBestsVersion();
+
+    // convert any recording left behind by a crash, so it can be imported
+    if (context->athlete->home->records().exists())
+        TelemetryRecorder::recover(context->athlete->home->records().canonicalPath(), SAMPLERATE);
+
     status = 0;
     setStatusFlags(RT_MODE_ERGO);         // ergo mode by default
     mode = ErgFileFormat::erg;
@@ -407,7 +412,6 @@ TrainSidebar::TrainSidebar(Context *context) : GcWindow(context), context(contex
     displayCoreTemp = displaySkinTemp = displayHeatStrain = 0.0;
 
     connect(gui_timer, SIGNAL(timeout()), this, SLOT(guiUpdate()));
-    connect(disk_timer, SIGNAL(timeout()), this, SLOT(diskUpdate()));
     connect(load_timer, SIGNAL(timeout()), this, SLOT(loadUpdate()));
     connect(start_timer, SIGNAL(timeout()), this, SLOT(Start()));
 
@@ -1012,6 +1016,19 @@ TrainSidebar::workoutTreeWidgetSelectionChanged()
     }
 }
 
+// the channels of telemetry we take from a device, slow changing
+// channels such as moxy and temperature are recorded as we poll
+quint32
+TrainSidebar::deviceChannels(int dev) const
+{
+    quint32 channels = 0;
+    if (dev == bpmTelemetry) channels |= TelemetrySample::HeartRate;
+    if (dev == rpmTelemetry) channels |= TelemetrySample::Cadence;
+    if (dev == kphTelemetry && !useSimulatedSpeed) channels |= TelemetrySample::Speed;
+    if (dev == wattsTelemetry) channels |= TelemetrySample::Power;
+    return channels;
+}
+
 /*
  * Calculate Lap State with respect to distance.
  * Doesn't apply to time-based workouts.
@@ -1305,7 +1322,7 @@ void TrainSidebar::Start()       // when start button is pressed
 
         //foreach(int dev, activeDevices) Devices[dev].controller->restart();
         //gui_timer->start(REFRESHRATE);
-        if (status & RT_RECORDING) disk_timer->start(SAMPLERATE);
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, true);
         load_period.restart();
         load_timer->start(LOADRATE);
 
@@ -1331,7 +1348,7 @@ void TrainSidebar::Start()       // when start button is pressed
         setStatusFlags(RT_PAUSED);
         //foreach(int dev, activeDevices) Devices[dev].controller->pause();
         //gui_timer->stop();
-        if (status & RT_RECORDING) disk_timer->stop();
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, false);
         load_timer->stop();
         load_msecs += load_period.restart();
 
@@ -1459,17 +1476,21 @@ void TrainSidebar::Start()       // when start button is pressed
 
             if (recordFile) delete recordFile;
             recordFile = new QFile(fulltarget);
-            lastRecordSecs = 0;
-            if (!recordFile->open(QFile::WriteOnly | QFile::Truncate)) {
+
+            // samples are recorded as binary and written to the CSV file when we stop
+            if (!recorder.open(fulltarget.left(fulltarget.length() - 4) + ".tlm")) {
                 clearStatusFlags(RT_RECORDING);
             } else {
-
-                // CSV File header
-
-                QTextStream recordFileStream(recordFile);
-                recordFileStream << "secs, cad, hr, km, kph, nm, watts, alt, lon, lat, headwind, slope, temp, interval, lrbalance, lte, rte, lps, rps, smo2, thb, o2hb, hhb, target, rppb, rppe, rpppb, rpppe, lppb, lppe, lpppb, lpppe\n";
-
-                disk_timer->start(SAMPLERATE);  // start screen
+                // devices that can record as telemetry arrives do,
+                // we record the rest as we poll them
+                polledChannels = TelemetrySample::All;
+                int source = 1;
+                foreach(int dev, activeDevices) {
+                    quint32 channels = deviceChannels(dev);
+                    if (channels && source < TelemetryRecorder::Sources)
+                        polledChannels &= ~Devices[dev].controller->setRecorder(&recorder, source++, channels);
+                }
+                recorder.setSessionTime(session_elapsed_msec + session_time.elapsed(), true);
             }
         }
         gui_timer->start(REFRESHRATE);      // start recording
@@ -1492,7 +1513,7 @@ void TrainSidebar::Pause()        // pause capture to recalibrate
         clearStatusFlags(RT_PAUSED);
         foreach(int dev, activeDevices) Devices[dev].controller->restart();
         gui_timer->start(REFRESHRATE);
-        if (status & RT_RECORDING) disk_timer->start(SAMPLERATE);
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, true);
         load_period.restart();
         load_timer->start(LOADRATE);
 
@@ -1512,7 +1533,7 @@ void TrainSidebar::Pause()        // pause capture to recalibrate
         foreach(int dev, activeDevices) Devices[dev].controller->pause();
         setStatusFlags(RT_PAUSED);
         gui_timer->stop();
-        if (status & RT_RECORDING) disk_timer->stop();
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, false);
         load_timer->stop();
         load_msecs += load_period.restart();
 
@@ -1570,10 +1591,12 @@ void TrainSidebar::Stop(int deviceStatus)        // when stop button is pressed
     slope = 0.0;
 
     if (status & RT_RECORDING) {
-        disk_timer->stop();
 
-        // close and reset File
-        recordFile->close();
+        // write whatever is still buffered, then convert to CSV
+        foreach(int dev, activeDevices) Devices[dev].controller->setRecorder(NULL, 0, 0);
+        recorder.close();
+        bool converted = (deviceStatus != DEVICE_ERROR) && TelemetryRecorder::convert(recorder.fileName(), recordFile->fileName(), SAMPLERATE);
+        QFile::remove(recorder.fileName());
 
         // Request mutual exclusion with ANT+/BTLE threads to change status and close rr/vo2 files
         rrMutex.lock();
@@ -1618,7 +1641,7 @@ void TrainSidebar::Stop(int deviceStatus)        // when stop button is pressed
             tcoreFile=NULL;
         }
 
-        if(deviceStatus == DEVICE_ERROR)
+        if(deviceStatus == DEVICE_ERROR || !converted)
         {
             recordFile->remove();
         }
@@ -2173,8 +2196,52 @@ void TrainSidebar::guiUpdate()           // refreshes the telemetry
             // Update Derived data series
             rtData.updateDerived();
 
+            // record what the devices don't record themselves, and what we work out
+            if ((status&RT_RECORDING) && (status&RT_RUNNING) && ((status&RT_PAUSED) == 0) && recorder.isRecording()) {
+                TelemetrySample sample;
+                sample.msecs = recorder.sessionTime();
+                sample.channels = polledChannels;
+                sample.cad = displayCadence;
+                sample.hr = displayHeartRate;
+                sample.km = displayDistance;
+                sample.kph = displaySpeed;
+                sample.watts = displayPower;
+                sample.alt = displayAltitude;
+                sample.lon = displayLongitude;
+                sample.lat = displayLatitude;
+                sample.slope = slope;
+                sample.temp = displayTemp;
+                sample.interval = displayWorkoutLap;
+                sample.lrbalance = displayLRBalance;
+                sample.lte = displayLTE;
+                sample.rte = displayRTE;
+                sample.lps = displayLPS;
+                sample.rps = displayRPS;
+                sample.smo2 = displaySMO2;
+                sample.thb = displayTHB;
+                sample.o2hb = displayO2HB;
+                sample.hhb = displayHHB;
+                sample.target = load;
+                sample.rppb = displayRppb;
+                sample.rppe = displayRppe;
+                sample.rpppb = displayRpppb;
+                sample.rpppe = displayRpppe;
+                sample.lppb = displayLppb;
+                sample.lppe = displayLppe;
+                sample.lpppb = displayLpppb;
+                sample.lpppe = displayLpppe;
+                recorder.push(0, sample);
+            }
+
             // go update the displays...
             context->notifyTelemetryUpdate(rtData); // signal everyone to update telemetry
+
+            // the recorder searches the power as it writes it, we just pass it on
+            int version = recorder.sessionBestsVersion();
+            if (version != bestsVersion) {
+                bestsVersion = version;
+                context->notifySessionBests(recorder.sessionBests());
+            }
         }
 
 #ifdef Q_OS_MAC
@@ -2230,90 +2297,6 @@ void TrainSidebar::warnnoConfig()
     QMessageBox::warning(this, tr("No Devices Configured"), tr("Please configure a device in Preferences."));
 }
 
-template<class T, typename T_GetMethod, typename T_SetMethod, typename T_arg>
-struct ScopedOp
-{
-    T* m_pt;
-    T_SetMethod m_setMethod;
-    T_arg m_argSave;
-
-    ScopedOp(T* pt, T_GetMethod getMethod, T_SetMethod setMethod, T_arg argNew) : m_pt(pt), m_setMethod(setMethod) {
-        m_argSave = (m_pt->*getMethod)();
-        (m_pt->*m_setMethod)(argNew);
-    }
-
-    virtual ~ScopedOp() { (m_pt->*m_setMethod)(m_argSave); }
-};
-
-struct ScopedPrecision : ScopedOp<QTextStream, int (QTextStream::*)() const, void (QTextStream::*)(int), int> {
-    ScopedPrecision(QTextStream* pc, int tempPrecision) : ScopedOp::ScopedOp(pc, &QTextStream::realNumberPrecision, &QTextStream::setRealNumberPrecision, tempPrecision) {}
-};
-
-//----------------------------------------------------------------------
-// DISK UPDATE FUNCTIONS
-//----------------------------------------------------------------------
-void TrainSidebar::diskUpdate()
-{
-    int  secs;
-
-    long torq = 0;
-    QTextStream recordFileStream(recordFile);
-
-    if (calibrating) return;
-
-    // convert from milliseconds to secondes
-    total_msecs = session_elapsed_msec + session_time.elapsed();
-    secs = round(total_msecs / 1000.0);
-
-    if (secs <= lastRecordSecs) return; // Avoid duplicates
-    lastRecordSecs = secs;
-
-    // GoldenCheetah CVS Format "secs, cad, hr, km, kph, nm, watts, alt, lon, lat, headwind, slope, temp, interval, lrbalance, lte, rte, lps, rps, smo2, thb, o2hb, hhb, target, rppb, rppe, rpppb, rpppe, lppb, lppe, lpppb, lpppe\n";
-
-    recordFileStream    << secs
-                        << "," << displayCadence
-                        << "," << displayHeartRate
-                        << "," << displayDistance
-                        << "," << displaySpeed
-                        << "," << torq
-                        << "," << displayPower;
-
-    // QTextStream default precision is 6, location data needs much more than that.
-    // Avoid extra precision for other fields since it isn't needed and would grow
-    // the intermediate file for no reason.
-    {
-        ScopedPrecision tempPrecision(&recordFileStream, 20);
-
-        recordFileStream << "," << displayAltitude
-                         << "," << displayLongitude
-                         << "," << displayLatitude;
-    }
-
-    recordFileStream    << "," // headwind
-                        << "," << slope
-                        << "," << displayTemp
-                        << "," << displayWorkoutLap
-                        << "," << displayLRBalance
-                        << "," << displayLTE
-                        << "," << displayRTE
-                        << "," << displayLPS
-                        << "," << displayRPS
-                        << "," << displaySMO2
-                        << "," << displayTHB
-                        << "," << displayO2HB
-                        << "," << displayHHB
-                        << "," << load
-                        << "," << displayRppb
-                        << "," << displayRppe
-                        << "," << displayRpppb
-                        << "," << displayRpppe
-                        << "," << displayLppb
-                        << "," << displayLppe
-                        << "," << displayLpppb
-                        << "," << displayLpppe
-                        << "," << "\n";
-}
-
 //----------------------------------------------------------------------
 // WORKOUT MODE
 //----------------------------------------------------------------------
@@ -2396,7 +2379,7 @@ void TrainSidebar::toggleCalibration()
 
         clearStatusFlags(RT_CALIBRATING);
         load_timer->start(LOADRATE);
-        if (status & RT_RECORDING) disk_timer->start(SAMPLERATE);
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, true);
         context->notifyUnPause(); // get video started again, amongst other things
 
         // back to ergo/slope mode and restore load/gradient
@@ -2428,7 +2411,7 @@ void TrainSidebar::toggleCalibration()
         lap_elapsed_msec += lap_time.elapsed();
 
         setStatusFlags(RT_CALIBRATING);
-        if (status & RT_RECORDING) disk_timer->stop();
+        if (status & RT_RECORDING) recorder.setSessionTime(session_elapsed_msec, false);
         load_timer->stop();
         load_msecs += load_period.restart();
 
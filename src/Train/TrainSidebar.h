@@ -34,6 +34,7 @@
 #include "PhysicsUtility.h"
 #include "MultiFilterProxyModel.h"
 #include "InfoWidget.h"
+#include "TelemetryRecorder.h"
 
 // standard stuff
 #include <QDir>
@@ -72,7 +73,7 @@
 // msecs constants for timers
 #define REFRESHRATE    200 // screen refresh in milliseconds
 #define STREAMRATE     200 // rate at which we stream updates to remote peer
-#define SAMPLERATE     1000 // disk update in milliseconds
+#define SAMPLERATE     1000 // recording interval in milliseconds
 #define LOADRATE       1000 // rate at which load is adjusted
 
 // device treeview node types
@@ -201,7 +202,6 @@ class TrainSidebar : public GcWindow
 
         // Timed actions
         void guiUpdate();           // refreshes the telemetry
-        void diskUpdate();          // writes to CSV file
         void loadUpdate();          // sets Load on CT like devices
 
         // When no config has been setup
@@ -282,6 +282,7 @@ class TrainSidebar : public GcWindow
         double displayTemp;
 
         void maintainLapDistanceState();
+        quint32 deviceChannels(int dev) const; // recorded by the device as they arrive
 
         RealtimeDataSession rtData;
 
@@ -290,7 +291,9 @@ class TrainSidebar : public GcWindow
         QString codeWorkoutKey;     // traindb-key of the workout in the case of a code-workout; empty otherwise
         QString codeWorkoutTitle;   // title of the workout in the case of a code-workout; empty otherwise
         QFile *recordFile;      // where we record!
-        int lastRecordSecs;     // to avoid duplicates
+        TelemetryRecorder recorder; // samples as they are recorded, converted to recordFile at the end
+        quint32 polledChannels; // recorded as we poll, the devices record the rest themselves
+        int bestsVersion;       // of the session bests last sent
         QMutex rrMutex;         // to coordinate async recording from ANT+ thread
         QFile *rrFile;          // r-r records, if any received.
         QMutex posMutex;        // to coordinate async recording from ANT+ thread
@@ -321,8 +324,7 @@ class TrainSidebar : public GcWindow
 
         QTimer      *gui_timer,     // refresh the gui
                     *load_timer,    // change the load on the device
-                    *start_timer,   // delayed start
-                    *disk_timer;    // write to .CSV file
+                    *start_timer;   // delayed start
 
         bool autoConnect;
         bool pendingConfigChange;
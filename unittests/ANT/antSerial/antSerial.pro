@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testANTSerial.cpp \
+          ../../../src/ANT/ANTSerial.cpp
+
+include(../../unittests.pri)
@@ -0,0 +1,273 @@
+#include "ANT/ANTSerial.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+
+// as ANT::receiveByte used to, one byte at a time
+class ByteParser
+{
+    public:
+        void receive(unsigned char byte) {
+            switch (state) {
+            case 0:
+                if (byte == 0xA4) { state = 1; checksum = byte; rx[0] = byte; }
+                break;
+            case 1:
+                if (byte == 0 || byte > 9) state = 0;
+                else { rx[1] = byte; checksum ^= byte; length = byte; bytes = 0; state = 2; }
+                break;
+            case 2:
+                rx[2] = byte; checksum ^= byte; state = 3;
+                break;
+            case 3:
+                rx[3 + bytes] = byte; checksum ^= byte;
+                if (++bytes >= length) state = 4;
+                break;
+            case 4:
+                if (checksum == byte) messages << QByteArray((const char*)rx, rx[1] + 3);
+                state = 0;
+                break;
+            }
+        }
+
+        QList<QByteArray> messages;
+
+    private:
+        int state = 0, length = 0, bytes = 0;
+        unsigned char checksum = 0, rx[12];
+};
+
+static QByteArray message(QRandomGenerator &random, int length)
+{
+    QByteArray m;
+    m.append(char(0xA4));
+    m.append(char(length));
+    for (int i=0; i<length+1; i++) m.append(char(random.bounded(256)));
+
+    unsigned char checksum = 0;
+    foreach(char c, m) checksum ^= (unsigned char)c;
+    m.append(char(checksum));
+    return m;
+}
+
+static QList<QByteArray> frame(ANTFramer &framer, const QByteArray &stream, QRandomGenerator &random)
+{
+    QList<QByteArray> returning;
+    unsigned char rx[12];
+
+    for (int i=0; i<stream.size(); ) {
+        int n = qMin(qMin(1 + int(random.bounded(64)), framer.space()), int(stream.size()) - i);
+        framer.append((const uint8_t*)stream.constData() + i, n);
+        i += n;
+        while (framer.next(rx)) returning << QByteArray((const char*)rx, rx[1] + 3);
+    }
+    return returning;
+}
+
+class TestANTSerial: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    // A4 01 4A 00 is a reset, its checksum is A4^01^4A^00 = EF
+    void framerEdges() {
+        const QByteArray reset("\xa4\x01\x4a\x00\xef", 5);
+        unsigned char rx[12];
+
+        ANTFramer framer;
+        QVERIFY(!framer.next(rx));
+        QCOMPARE(framer.space(), 1024);
+
+        // split over two reads
+        framer.append((const uint8_t*)reset.constData(), 3);
+        QVERIFY(!framer.next(rx));
+        framer.append((const uint8_t*)reset.constData() + 3, 2);
+        QVERIFY(framer.next(rx));
+        QCOMPARE(QByteArray((const char*)rx, 4), reset.left(4));
+        QCOMPARE(framer.count(), 0);
+
+        // a bad checksum is dropped whole
+        framer.append((const uint8_t*)"\xa4\x01\x4a\x00\xee", 5);
+        QVERIFY(!framer.next(rx));
+        QCOMPARE(framer.count(), 0);
+
+        // a length of 0 skips the sync and the length
+        framer.append((const uint8_t*)"\xa4\x00", 2);
+        framer.append((const uint8_t*)reset.constData(), reset.size());
+        QVERIFY(framer.next(rx));
+        QCOMPARE(QByteArray((const char*)rx, 4), reset.left(4));
+
+        // so a sync read as a length takes the message with it
+        framer.append((const uint8_t*)"\xa4", 1);
+        framer.append((const uint8_t*)reset.constData(), reset.size());
+        QVERIFY(!framer.next(rx));
+        QCOMPARE(framer.count(), 0);
+    }
+
+    // the longest message is 9 bytes, A4^09^4E = E3 with zero data
+    void framerLengths() {
+        QByteArray longest("\xa4\x09\x4e", 3);
+        longest.append(QByteArray(9, '\0'));
+        longest.append(char(0xe3));
+        unsigned char rx[12];
+
+        ANTFramer framer;
+        framer.append((const uint8_t*)longest.constData(), longest.size());
+        QVERIFY(framer.next(rx));
+        QCOMPARE(QByteArray((const char*)rx, 12), longest.left(12));
+
+        // one more is too long
+        QByteArray toolong = longest;
+        toolong[1] = char(10);
+        framer.append((const uint8_t*)toolong.constData(), toolong.size());
+        QVERIFY(!framer.next(rx));
+        QCOMPARE(framer.count(), 0);
+    }
+
+    // a message that runs off the end of the ring
+    void framerWraps() {
+        const QByteArray reset("\xa4\x01\x4a\x00\xef", 5);
+        unsigned char rx[12];
+
+        ANTFramer framer;
+        QByteArray noise(1020, '\0');
+        framer.append((const uint8_t*)noise.constData(), noise.size());
+        QCOMPARE(framer.space(), 4);
+        QVERIFY(!framer.next(rx));
+        QCOMPARE(framer.space(), 1024);
+
+        framer.append((const uint8_t*)reset.constData(), reset.size());
+        QVERIFY(framer.next(rx));
+        QCOMPARE(QByteArray((const char*)rx, 4), reset.left(4));
+
+        // full, and no more than that is taken
+        QByteArray full(1030, '\0');
+        framer.append((const uint8_t*)full.constData(), full.size());
+        QCOMPARE(framer.space(), 0);
+    }
+
+    void framerMatchesByteParser() {
+        QRandomGenerator random(42);
+
+        for (int trial=0; trial<500; trial++) {
+
+            // good and bad messages, bad lengths and noise
+            QByteArray stream;
+            for (int i=0; i<200; i++) {
+                int what = random.bounded(10);
+                if (what < 6) {
+                    QByteArray m = message(random, 1 + random.bounded(9));
+                    if (random.bounded(8) == 0) m[m.size()-1] = char(m[m.size()-1] ^ 1);
+                    stream.append(m);
+                } else if (what < 8) {
+                    stream.append(char(0xA4));
+                    stream.append(char(random.bounded(2) ? 0 : 10 + random.bounded(246)));
+                } else {
+                    stream.append(char(random.bounded(256)));
+                }
+            }
+
+            ByteParser parser;
+            foreach(char c, stream) parser.receive((unsigned char)c);
+
+            ANTFramer framer;
+            QCOMPARE(frame(framer, stream, random), parser.messages);
+        }
+    }
+
+    void parseAntlog() {
+        QRandomGenerator random(7);
+        QByteArray m1 = message(random, 9), m2 = message(random, 3);
+
+        // as ANTLogger writes them, message padded to 12 without a checksum
+        QByteArray antlog;
+        qint64 millis = 1700000000000;
+        foreach(QByteArray m, QList<QByteArray>() << m1 << m2 << m1) {
+            antlog.append(antlog.size() == 21 ? 'S' : 'R');
+            for (int i=0; i<8; i++) antlog.append(char((millis >> (8*i)) & 0xff));
+            antlog.append(m.left(m.size()-1).leftJustified(12, '\0'));
+            millis += 250;
+        }
+
+        QByteArray bytes;
+        QVector<int> offsets;
+        QVector<qint64> times;
+        QVERIFY(ANTReplay::parse(antlog, bytes, offsets, times));
+        QCOMPARE(bytes, m1 + m1);
+        QCOMPARE(offsets, QVector<int>() << 0 << m1.size());
+        QCOMPARE(times, QVector<qint64>() << 1700000000000 << 1700000000500);
+
+        // anything else is raw bytes
+        QVERIFY(!ANTReplay::parse(m1 + m2, bytes, offsets, times));
+    }
+
+#ifndef WIN32
+    void replayThroughPty() {
+        QRandomGenerator random(3);
+        QList<QByteArray> messages;
+        QByteArray capture;
+        for (int i=0; i<100; i++) {
+            messages << message(random, 1 + random.bounded(9));
+            capture.append(messages.last());
+            messages.last().chop(1);
+        }
+
+        QTemporaryDir dir;
+        QFile file(dir.path() + "/capture.raw");
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write(capture);
+        file.close();
+
+        ANTReplay replay(file.fileName(), false);
+        QVERIFY(replay.open());
+
+        // opened as ANT::openPort does
+        int fd = open(replay.device().toLatin1(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+        QVERIFY(fd != -1);
+        struct termios settings;
+        tcgetattr(fd, &settings);
+        cfmakeraw(&settings);
+        tcsetattr(fd, TCSANOW, &settings);
+        replay.start();
+
+        // written to the device is thrown away
+        QCOMPARE(int(write(fd, "\xa4\x01\x4a\x00\xef", 5)), 5);
+
+        ANTFramer framer;
+        QList<QByteArray> received;
+        unsigned char rx[12];
+        QElapsedTimer timer;
+        timer.start();
+        while (received.count() < messages.count() && timer.elapsed() < 5000) {
+            struct pollfd fds;
+            fds.fd = fd;
+            fds.events = POLLIN;
+            fds.revents = 0;
+            if (poll(&fds, 1, 50) <= 0) continue;
+
+            uint8_t buf[64];
+            int rc = read(fd, buf, qMin(int(sizeof(buf)), framer.space()));
+            if (rc <= 0) continue;
+            framer.append(buf, rc);
+            while (framer.next(rx)) received << QByteArray((const char*)rx, rx[1] + 3);
+        }
+        close(fd);
+
+        QCOMPARE(received, messages);
+    }
+#endif
+};
+
+QTEST_MAIN(TestANTSerial)
+#include "testANTSerial.moc"
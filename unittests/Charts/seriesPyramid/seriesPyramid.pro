@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testSeriesPyramid.cpp \
+          ../../../src/Charts/SeriesPyramid.cpp
+
+include(../../unittests.pri)
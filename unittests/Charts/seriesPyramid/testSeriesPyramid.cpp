@@ -0,0 +1,311 @@
+#include "Charts/SeriesPyramid.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+#include <limits>
+
+
+class TestSeriesPyramid: public QObject
+{
+    Q_OBJECT
+
+private:
+
+    // a ride-ish series, one sample a second with the odd spike
+    void series(int n, QVector<double> &x, QVector<double> &y) {
+        QRandomGenerator random(42);
+        x.resize(n);
+        y.resize(n);
+        double watts = 200;
+        for (int i=0; i<n; i++) {
+            watts = qBound(0.0, watts + random.bounded(40.0) - 20.0, 600.0);
+            x[i] = i / 60.0;
+            y[i] = (random.bounded(500) == 0) ? 1500 : watts;
+        }
+    }
+
+    // a series in runs of power separated by freewheeling (zeros) and by
+    // recording gaps, one sample a second
+    void gappedSeries(int n, QVector<double> &x, QVector<double> &y) {
+        QRandomGenerator random(3);
+        x.resize(n);
+        y.resize(n);
+        double secs = 0;
+        for (int i=0; i<n; ) {
+            int run = 1 + random.bounded(1000);
+            for (int j=0; j<run && i<n; j++, i++) {
+                x[i] = secs++;
+                y[i] = 100 + random.bounded(400.0);
+            }
+            if (random.bounded(2)) {
+                int zeros = 1 + random.bounded(20);
+                for (int j=0; j<zeros && i<n; j++, i++) {
+                    x[i] = secs++;
+                    y[i] = 0;
+                }
+            } else {
+                secs += 4 + random.bounded(600); // > 3s between samples
+            }
+        }
+    }
+
+    // the segments QwtPlotGappedCurve draws, from..to in x for each; when
+    // the gaps are marked a Break is drawn as no data at the next sample
+    QVector<QPair<double,double> > drawn(const SeriesPyramid &pyramid, const QVector<int> &indices,
+                                         double gap, double na, bool marked) {
+        QVector<double> x, y;
+        for (int k=0; k<indices.count(); k++) {
+            int i = indices[k] == SeriesPyramid::Break ? indices[k+1] : indices[k];
+            x << pyramid.x(i);
+            y << (indices[k] == SeriesPyramid::Break ? na : pyramid.y(i));
+        }
+
+        QVector<QPair<double,double> > segments;
+        double last = 0;
+        for (int i=0; i<x.count(); i++) {
+            double yprev = i ? y[i-1] : 0;
+            if ((y[i] < na - 0.001 || y[i] > na + 0.001) && (marked || x[i] - last <= gap) &&
+                (yprev < na - 0.001 || yprev > na + 0.001))
+                segments << qMakePair(x[i-1], x[i]);
+            last = x[i];
+        }
+        return segments;
+    }
+
+private slots:
+
+    void empty() {
+        SeriesPyramid pyramid(NULL, NULL, 0);
+        QCOMPARE(pyramid.count(), 0);
+        QCOMPARE(pyramid.lowerBound(5), 0);
+
+        QVector<int> indices;
+        pyramid.decimate(0, 10, 100, indices);
+        QVERIFY(indices.isEmpty());
+    }
+
+    void oneSample() {
+        double x = 0, y = 250;
+        SeriesPyramid pyramid(&x, &y, 1);
+
+        int min, max;
+        pyramid.range(0, 1, min, max);
+        QCOMPARE(min, 0);
+        QCOMPARE(max, 0);
+
+        QVector<int> indices;
+        pyramid.decimate(0, 1, 1, indices);
+        QCOMPARE(indices, QVector<int>() << 0);
+    }
+
+    // 1 at 2 and 4, 9 at 1 and 5; the first of equal values is taken
+    void ties() {
+        QVector<double> x = QVector<double>() << 0 << 1 << 2 << 3 << 4 << 5;
+        QVector<double> y = QVector<double>() << 3 << 9 << 1 << 7 << 1 << 9;
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        int min, max;
+        pyramid.range(0, 6, min, max);
+        QCOMPARE(min, 2);
+        QCOMPARE(max, 1);
+        pyramid.range(3, 6, min, max);
+        QCOMPARE(min, 4);
+        QCOMPARE(max, 5);
+
+        // a block of 4 then one of 2, and the range is clamped to the series
+        QVector<int> indices;
+        pyramid.decimate(-5, 2000, 1, indices);
+        QCOMPARE(indices, QVector<int>() << 0 << 1 << 2 << 4 << 5);
+
+        // all the same is the first one
+        y.fill(5);
+        SeriesPyramid flat(x.constData(), y.constData(), x.count());
+        flat.range(0, 6, min, max);
+        QCOMPARE(min, 0);
+        QCOMPARE(max, 0);
+    }
+
+    // freewheeling drops power to zero, a bucket with a zero in it has to
+    // draw it so the curve dips there like the full series does
+    void zeroMinBucket() {
+        QVector<double> x(16), y(16);
+        for (int i=0; i<16; i++) {
+            x[i] = i;
+            y[i] = 100;
+        }
+        y[5] = 0;
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        // two blocks of 8, the first keeps its first 100 and the zero
+        QVector<int> indices;
+        pyramid.decimate(0, 16, 2, indices);
+        QCOMPARE(indices, QVector<int>() << 0 << 5 << 8 << 15);
+        QCOMPARE(y[indices[1]], 0.0);
+    }
+
+    // zoomed in every sample is drawn, the breaks are where the curve
+    // would have broken the line itself
+    void breaksWhenAllDrawn() {
+        QVector<double> x, y;
+        gappedSeries(5000, x, y);
+
+        SeriesPyramid plain(x.constData(), y.constData(), x.count());
+        QVector<int> all;
+        plain.decimate(0, x.count(), x.count(), all);
+
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+        pyramid.setBreaks(3, 0);
+        QVector<int> indices;
+        pyramid.decimate(0, x.count(), x.count(), indices);
+        QVERIFY(indices.count() > all.count());
+
+        QCOMPARE(drawn(pyramid, indices, 3, 0, true), drawn(plain, all, 3, 0, false));
+    }
+
+    // zoomed out the line still breaks at every gap and zero, and runs
+    // that cross blocks are drawn from end to end
+    void breaksAfterDecimation() {
+        QVector<double> x, y;
+        gappedSeries(100000, x, y);
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+        pyramid.setBreaks(3, 0);
+
+        QVector<int> indices;
+        pyramid.decimate(0, x.count(), 1000, indices);
+        QVERIFY(indices.count() < 8 * 1000 + 4);
+        QCOMPARE(indices.first(), 0);
+        QCOMPARE(indices.last(), x.count()-1);
+
+        // runs of the full series, first and last sample of each
+        QVector<QPair<int,int> > runs;
+        for (int i=1; i<x.count(); i++) {
+            bool joined = y[i] != 0 && y[i-1] != 0 && x[i] - x[i-1] <= 3;
+            if (!joined) continue;
+            if (runs.count() && runs.last().second == i-1) runs.last().second = i;
+            else runs << qMakePair(i-1, i);
+        }
+
+        // nothing is drawn across a break
+        QVector<QPair<double,double> > segments = drawn(pyramid, indices, 3, 0, true);
+        QVERIFY(segments.count() > 0);
+        foreach (const auto &segment, segments) {
+            int from = pyramid.lowerBound(segment.first), to = pyramid.lowerBound(segment.second);
+            bool inside = false;
+            foreach (const auto &run, runs) if (run.first <= from && to <= run.second) inside = true;
+            QVERIFY(inside);
+        }
+
+        // and runs longer than two blocks (of 128 here) are drawn all the way
+        int longer = 0;
+        foreach (const auto &run, runs) {
+            if (run.second - run.first < 256) continue;
+            longer++;
+            double reached = x[run.first];
+            foreach (const auto &segment, segments) {
+                if (segment.first <= reached && segment.second > reached) reached = segment.second;
+            }
+            QCOMPARE(reached, x[run.second]);
+        }
+        QVERIFY(longer > 10);
+    }
+
+    // nan fails every comparison so is never picked over a number
+    void nan() {
+        QVector<double> x = QVector<double>() << 0 << 1 << 2;
+        QVector<double> y = QVector<double>() << 2 << std::numeric_limits<double>::quiet_NaN() << 1;
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        int min, max;
+        pyramid.range(0, 3, min, max);
+        QCOMPARE(min, 2);
+        QCOMPARE(max, 0);
+    }
+
+    void rangeMatchesScan() {
+        QVector<double> x, y;
+        series(5000, x, y);
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        QRandomGenerator random(7);
+        for (int t=0; t<500; t++) {
+            int from = random.bounded(x.count());
+            int to = from + 1 + random.bounded(x.count() - from);
+
+            double lo = y[from], hi = y[from];
+            for (int i=from; i<to; i++) {
+                lo = qMin(lo, y[i]);
+                hi = qMax(hi, y[i]);
+            }
+
+            int min, max;
+            pyramid.range(from, to, min, max);
+            QVERIFY(min >= from && min < to && max >= from && max < to);
+            QCOMPARE(y[min], lo);
+            QCOMPARE(y[max], hi);
+        }
+    }
+
+    void decimateKeepsPeaks() {
+        QVector<double> x, y;
+        series(100000, x, y);
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        QRandomGenerator random(11);
+        for (int t=0; t<100; t++) {
+            int from = random.bounded(x.count());
+            int to = from + 1 + random.bounded(x.count() - from);
+            int buckets = 100 + random.bounded(2000);
+
+            QVector<int> indices;
+            pyramid.decimate(from, to, buckets, indices);
+
+            // in order, within range, both ends and not too many
+            QCOMPARE(indices.first(), from);
+            QCOMPARE(indices.last(), to-1);
+            for (int i=1; i<indices.count(); i++) QVERIFY(indices[i] > indices[i-1]);
+            QVERIFY(indices.count() <= 4 * buckets + 4);
+
+            // the highest and lowest are always drawn
+            double lo = y[from], hi = y[from], dlo = y[from], dhi = y[from];
+            for (int i=from; i<to; i++) {
+                lo = qMin(lo, y[i]);
+                hi = qMax(hi, y[i]);
+            }
+            foreach (int i, indices) {
+                dlo = qMin(dlo, y[i]);
+                dhi = qMax(dhi, y[i]);
+            }
+            QCOMPARE(dlo, lo);
+            QCOMPARE(dhi, hi);
+        }
+    }
+
+    void decimateSmallRangeIsEverything() {
+        QVector<double> x, y;
+        series(1000, x, y);
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        QVector<int> indices;
+        pyramid.decimate(100, 300, 500, indices);
+        QCOMPARE(indices.count(), 200);
+        for (int i=0; i<indices.count(); i++) QCOMPARE(indices[i], 100 + i);
+
+        pyramid.decimate(10, 10, 500, indices);
+        QVERIFY(indices.isEmpty());
+    }
+
+    void lowerBound() {
+        QVector<double> x, y;
+        series(1000, x, y);
+        SeriesPyramid pyramid(x.constData(), y.constData(), x.count());
+
+        QCOMPARE(pyramid.lowerBound(-1), 0);
+        QCOMPARE(pyramid.lowerBound(x[500]), 500);
+        QCOMPARE(pyramid.lowerBound(x[500] + 0.001), 501);
+        QCOMPARE(pyramid.lowerBound(1e9), 1000);
+    }
+};
+
+QTEST_MAIN(TestSeriesPyramid)
+#include "testSeriesPyramid.moc"
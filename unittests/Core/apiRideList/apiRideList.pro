@@ -0,0 +1,19 @@
+QT += testlib core gui widgets core5compat network
+
+# APIWebService.h pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json \
+               ../../../contrib/httpserver
+
+SOURCES = testAPIRideList.cpp \
+          ../../../src/Core/APIRideList.cpp \
+          ../../../contrib/httpserver/httprequest.cpp \
+          ../../../contrib/httpserver/httpresponse.cpp \
+          ../../../contrib/httpserver/httpcookie.cpp
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES}
@@ -0,0 +1,275 @@
+#include "Core/APIWebService.h"
+
+#include <QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QSettings>
+#include <QScopedPointer>
+
+
+// a ride on date with metrics 250, 1.5 and 3600
+static APIRideSnapshot::ride ride(QDate date, QString notes = QString())
+{
+    APIRideSnapshot::ride r;
+    r.date = date;
+    r.time = QTime(7, 30, 0);
+    r.fileName = date.toString("yyyy_MM_dd") + "_07_30_00.json";
+    r.metrics << 250 << 1.5 << 3600;
+    r.metadata.insert("Route", "Loop");
+    if (notes != "") r.metadata.insert("Notes", notes);
+    return r;
+}
+
+// rides on the 1st, two on the 3rd, the 5th and the 9th
+static APIRideSnapshot snapshot()
+{
+    APIRideSnapshot s;
+    s.sorted = true;
+    s.rides << ride(QDate(2026,1,1)) << ride(QDate(2026,1,3)) << ride(QDate(2026,1,3))
+            << ride(QDate(2026,1,5)) << ride(QDate(2026,1,9));
+    return s;
+}
+
+// the body of a response, put back together if it was sent chunked
+static QByteArray body(const QByteArray &response)
+{
+    int end = response.indexOf("\r\n\r\n");
+    if (end < 0) return QByteArray();
+    QByteArray head = response.left(end), rest = response.mid(end + 4);
+    if (!head.contains("Transfer-Encoding: chunked")) return rest;
+
+    QByteArray returning;
+    while (rest.size()) {
+        int eol = rest.indexOf("\r\n");
+        bool ok;
+        int size = rest.left(eol).toInt(&ok, 16);
+        if (!ok || size == 0) break;
+        returning += rest.mid(eol + 2, size);
+        rest = rest.mid(eol + 2 + size + 2);
+    }
+    return returning;
+}
+
+
+class TestAPIRideList: public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir dir;
+    QTcpServer server;
+    QScopedPointer<QTcpSocket> client, connection;
+
+    // a request sent by a client and read off the socket as the
+    // connection handler does, the response goes back to the client
+    void send(QByteArray text, HttpRequest &request) {
+        client.reset(new QTcpSocket);
+        client->connectToHost(QHostAddress::LocalHost, server.serverPort());
+        QVERIFY(client->waitForConnected(5000));
+        QVERIFY(server.waitForNewConnection(5000));
+        connection.reset(server.nextPendingConnection());
+
+        client->write(text);
+        QVERIFY(client->waitForBytesWritten(5000));
+        while (request.getStatus() != HttpRequest::complete && request.getStatus() != HttpRequest::abort) {
+            if (!connection->bytesAvailable() && !connection->waitForReadyRead(5000)) break;
+            request.readFromSocket(connection.data());
+        }
+        QCOMPARE(request.getStatus(), HttpRequest::complete);
+    }
+
+    // everything the client has been sent so far, a big body only
+    // goes out as the client reads it so both sides are kept going
+    QByteArray received() {
+        QByteArray returning;
+        do {
+            connection->waitForBytesWritten(100);
+            while (client->waitForReadyRead(100)) returning += client->readAll();
+        } while (connection->bytesToWrite());
+        return returning + client->readAll();
+    }
+
+    // the etag for a GET of path, for the data at version
+    QByteArray etag(QByteArray path, QString version) {
+        QSettings settings(dir.path() + "/http.ini", QSettings::IniFormat);
+        HttpRequest request(&settings);
+        send("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n", request);
+        return APIWebService::etag(request, version);
+    }
+
+private slots:
+
+    void initTestCase() {
+        QVERIFY(dir.isValid());
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+    }
+
+    void dateRange_data() {
+        QTest::addColumn<QDate>("since");
+        QTest::addColumn<QDate>("before");
+        QTest::addColumn<int>("first");
+        QTest::addColumn<int>("count");
+
+        QTest::addRow("everything") << QDate(1900,1,1) << QDate(3000,1,1) << 0 << 5;
+        QTest::addRow("on rides") << QDate(2026,1,3) << QDate(2026,1,5) << 1 << 3;
+        QTest::addRow("between rides") << QDate(2026,1,2) << QDate(2026,1,4) << 1 << 2;
+        QTest::addRow("one day") << QDate(2026,1,3) << QDate(2026,1,3) << 1 << 2;
+        QTest::addRow("first") << QDate(2025,1,1) << QDate(2026,1,1) << 0 << 1;
+        QTest::addRow("last") << QDate(2026,1,9) << QDate(2027,1,1) << 4 << 1;
+        QTest::addRow("no rides") << QDate(2026,1,6) << QDate(2026,1,8) << 4 << 0;
+        QTest::addRow("before all") << QDate(2025,1,1) << QDate(2025,12,31) << 0 << 0;
+        QTest::addRow("after all") << QDate(2026,2,1) << QDate(2026,3,1) << 5 << 0;
+        QTest::addRow("backwards") << QDate(2026,1,5) << QDate(2026,1,3) << 3 << 0;
+    }
+
+    // the binary search finds the same rides as checking every one
+    void dateRange() {
+        QFETCH(QDate, since);
+        QFETCH(QDate, before);
+        QFETCH(int, first);
+        QFETCH(int, count);
+
+        APIRideSnapshot s = snapshot();
+        QVector<APIRideSnapshot::ride>::const_iterator from, to;
+        s.range(since, before, from, to);
+        QCOMPARE(int(from - s.rides.constBegin()), first);
+        QCOMPARE(int(to - from), count);
+
+        int inRange = 0;
+        foreach(const APIRideSnapshot::ride &r, s.rides) if (r.date >= since && r.date <= before) inRange++;
+        QCOMPARE(int(to - from), inRange);
+    }
+
+    // not in date order, so it is all checked as it is listed
+    void dateRangeUnsorted() {
+        APIRideSnapshot s = snapshot();
+        s.sorted = false;
+        std::swap(s.rides[0], s.rides[4]);
+
+        QVector<APIRideSnapshot::ride>::const_iterator from, to;
+        s.range(QDate(2026,1,3), QDate(2026,1,3), from, to);
+        QVERIFY(from == s.rides.constBegin());
+        QVERIFY(to == s.rides.constEnd());
+    }
+
+    // only the columns asked for, in the order they were asked for
+    void projection() {
+        APIRideSnapshot::ride r = ride(QDate(2026,1,3), "said \"hi\"\nthen\tleft");
+        listRideSettings settings;
+
+        QCOMPARE(APIWebService::rideLine(r, settings),
+                 QByteArray("2026/01/03,07:30:00,2026_01_03_07_30_00.json,250,1.5,3600\n"));
+
+        settings.wanted << 2 << 0;
+        QCOMPARE(APIWebService::rideLine(r, settings),
+                 QByteArray("2026/01/03,07:30:00,2026_01_03_07_30_00.json,3600,250\n"));
+
+        // start date is days since 1900, start time seconds since midnight
+        settings.wanted = QList<int>() << 1;
+        settings.metawanted << "Route" << "Notes" << "Start Date" << "Start Time" << "Missing";
+        QCOMPARE(APIWebService::rideLine(r, settings),
+                 QByteArray("2026/01/03,07:30:00,2026_01_03_07_30_00.json,1.5,"
+                            "\"Loop\",\"said 'hi'\\nthen\\tleft\",\"46023\",\"27000\",\"\"\n"));
+    }
+
+    // the same request for the same data, whatever order the parameters are in
+    void etagIsForRequestAndVersion() {
+        QByteArray tag = etag("/athlete?metrics=Duration&since=2026/01/01", "v1");
+        QVERIFY(tag.startsWith("\"") && tag.endsWith("\""));
+        QCOMPARE(etag("/athlete?metrics=Duration&since=2026/01/01", "v1"), tag);
+        QCOMPARE(etag("/athlete?since=2026/01/01&metrics=Duration", "v1"), tag);
+
+        QVERIFY(etag("/athlete?metrics=Duration&since=2026/01/01", "v2") != tag);
+        QVERIFY(etag("/athlete?metrics=Duration&since=2026/01/02", "v1") != tag);
+        QVERIFY(etag("/other?metrics=Duration&since=2026/01/01", "v1") != tag);
+    }
+
+    void notModified_data() {
+        QTest::addColumn<QByteArray>("header");
+        QTest::addColumn<bool>("matches");
+
+        QTest::addRow("none") << QByteArray() << false;
+        QTest::addRow("same") << QByteArray("If-None-Match: %1") << true;
+        QTest::addRow("any case") << QByteArray("if-none-match: %1") << true;
+        QTest::addRow("weak") << QByteArray("If-None-Match: W/%1") << true;
+        QTest::addRow("in a list") << QByteArray("If-None-Match: \"other\", %1") << true;
+        QTest::addRow("anything") << QByteArray("If-None-Match: *") << true;
+        QTest::addRow("another") << QByteArray("If-None-Match: \"other\"") << false;
+    }
+
+    // a client with the current version gets a 304 and nothing more
+    void notModified() {
+        QFETCH(QByteArray, header);
+        QFETCH(bool, matches);
+
+        QByteArray tag = etag("/athlete?since=2026/01/01", "v1");
+        if (header.size()) header = header.replace("%1", tag) + "\r\n";
+
+        QSettings settings(dir.path() + "/http.ini", QSettings::IniFormat);
+        HttpRequest request(&settings);
+        send("GET /athlete?since=2026/01/01 HTTP/1.1\r\nHost: localhost\r\n" + header + "\r\n", request);
+        HttpResponse response(connection.data());
+
+        QCOMPARE(APIWebService::notModified(request, response, tag), matches);
+        QCOMPARE(response.getHeaders().value("ETag"), tag);
+
+        QByteArray sent = received();
+        if (matches) {
+            QVERIFY(sent.startsWith("HTTP/1.1 304 Not Modified\r\n"));
+            QVERIFY(sent.contains("\r\nETag: " + tag + "\r\n"));
+            QCOMPARE(body(sent), QByteArray());
+        } else {
+            QCOMPARE(sent, QByteArray());
+        }
+    }
+
+    // a body goes out as it is written, not when it is finished, and
+    // is only kept for the cache while it is small enough
+    void bodyIsStreamed() {
+        QSettings settings(dir.path() + "/http.ini", QSettings::IniFormat);
+        HttpRequest request(&settings);
+        send("GET /athlete/meanmax/bests HTTP/1.1\r\nHost: localhost\r\n\r\n", request);
+        HttpResponse response(connection.data());
+
+        QByteArray line(999, 'x');
+        line += "\n";
+        QByteArray expected;
+
+        APIResponseBody sending(response);
+        for (int i=0; i<100; i++) {
+            sending.write(line);
+            expected += line;
+        }
+        QByteArray sent = received();
+        QVERIFY(sent.startsWith("HTTP/1.1 200"));
+        QVERIFY(sent.contains("Transfer-Encoding: chunked"));
+
+        QVERIFY(sending.finish());
+        QCOMPARE(sending.kept, expected);
+        sent += received();
+        QCOMPARE(body(sent), expected);
+    }
+
+    void bigBodyIsNotKept() {
+        QSettings settings(dir.path() + "/http.ini", QSettings::IniFormat);
+        HttpRequest request(&settings);
+        send("GET /athlete/activity/big.json HTTP/1.1\r\nHost: localhost\r\n\r\n", request);
+        HttpResponse response(connection.data());
+
+        QByteArray block(1024 * 1024, 'x');
+        APIResponseBody sending(response);
+        QByteArray sent;
+        for (int i=0; i<5; i++) {
+            sending.write(block);
+            sent += received();
+        }
+        QVERIFY(!sending.finish());
+        QVERIFY(sending.kept.isEmpty());
+
+        sent += received();
+        QCOMPARE(body(sent).size(), 5 * block.size());
+    }
+};
+
+QTEST_MAIN(TestAPIRideList)
+#include "testAPIRideList.moc"
@@ -0,0 +1,15 @@
+QT += testlib core gui widgets core5compat
+
+# DataFilter.h pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json
+
+SOURCES = testDataFilterProgram.cpp stubs.cpp
+GC_OBJS = DataFilterProgram Utils DataFilter_yacc DataFilter_lex
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES}
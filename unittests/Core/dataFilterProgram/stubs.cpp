@@ -0,0 +1,81 @@
+//
+// Everything the test links in place of the application.
+//
+// Only DataFilterProgram and the DataFilter lexer and parser are linked.
+// The definitions below live in DataFilter.cpp, RideFile.cpp, RideMetric.cpp
+// and RideItem.cpp, which need most of the application to link, so they
+// are stood in for here and nowhere else.
+//
+#include "Core/DataFilter.h"
+#include "Core/RideItem.h"
+#include "FileIO/RideFile.h"
+#include "Metrics/RideMetric.h"
+
+// DataFilter.cpp, the parser's error list and the tree it built
+QStringList DataFiltererrors;
+Leaf *DataFilterroot;
+
+// DataFilter.cpp, as it is there
+void Leaf::clear(Leaf *leaf)
+{
+    if (leaf == NULL) return; // critical to avoid crashes
+
+    // compiled programs go with the tree
+    delete leaf->program;
+    leaf->program = NULL;
+    delete leaf->vector;
+    leaf->vector = NULL;
+
+    switch(leaf->type) {
+    case Leaf::Script :
+    case Leaf::String : delete leaf->lvalue.s; break;
+    case Leaf::Symbol : delete leaf->lvalue.n; break;
+    case Leaf::Logical  :
+    case Leaf::BinaryOperation :
+    case Leaf::Operation : clear(leaf->lvalue.l);
+                           clear(leaf->rvalue.l);
+                           delete leaf->lvalue.l;
+                           delete leaf->rvalue.l;
+                           break;
+    case Leaf::UnaryOperation : clear(leaf->lvalue.l);
+                           delete leaf->lvalue.l;
+                           break;
+    case Leaf::Function :  clear(leaf->lvalue.l);
+                           delete leaf->lvalue.l;
+                           clear(leaf->series);
+                           delete leaf->series;
+                           foreach (Leaf* l, leaf->fparms) { clear(l); delete l; }
+                           leaf->fparms.clear();
+                           break;
+    case Leaf::Compound :  foreach (Leaf* l, *(leaf->lvalue.b)) { clear(l); delete l; }
+                           delete leaf->lvalue.b;
+                           break;
+    case Leaf::Conditional : clear(leaf->lvalue.l);
+                           clear(leaf->rvalue.l);
+                           clear(leaf->cond.l);
+                           delete leaf->lvalue.l;
+                           delete leaf->rvalue.l;
+                           delete leaf->cond.l;
+                           break;
+    case Leaf::Index :
+    case Leaf::Select :    clear(leaf->lvalue.l);
+                           delete leaf->lvalue.l;
+                           foreach (Leaf* l, leaf->fparms) { clear(l); delete l; }
+                           leaf->fparms.clear();
+                           break;
+    case Leaf::Float :
+    case Leaf::Integer :   break;
+
+    default: break;
+    }
+
+}
+
+// referenced by DataFilterProgram for metrics and sample data, which the
+// programs in the test never read, so these are never called
+RideFile::SeriesType RideFile::seriesForSymbol(QString) { return RideFile::none; }
+bool RideFileColumns::isStored(RideFile::SeriesType) { return false; }
+double RideFilePoint::value(RideFile::SeriesType) const { return 0; }
+double RideMetric::getForSymbol(QString, const QHash<QString,RideMetric*> *) { return 0; }
+QString RideItem::getText(QString, QString fallback) const { return fallback; }
+RideMetricFactory *RideMetricFactory::_instance = NULL;
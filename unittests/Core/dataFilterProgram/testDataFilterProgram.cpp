@@ -0,0 +1,407 @@
+#include "Core/DataFilterProgram.h"
+#include "Core/DataFilter.h"
+
+#include "DataFilter_yacc.h"
+
+#include <QTest>
+#include <cmath>
+
+
+// the parser, linked as built for DataFilter, see stubs.cpp
+extern void DataFilter_setString(QString);
+extern void DataFilter_clearString();
+extern int DataFilterparse();
+extern QStringList DataFiltererrors;
+extern Leaf *DataFilterroot;
+
+
+// builds trees as the parser would, and owns them
+class Tree
+{
+    public:
+        ~Tree() {
+            foreach(Leaf *leaf, leaves) {
+                if (leaf->type == Leaf::Symbol) delete leaf->lvalue.n;
+                if (leaf->type == Leaf::Compound) delete leaf->lvalue.b;
+                delete leaf->program;
+                delete leaf->vector;
+                delete leaf;
+            }
+        }
+
+        Leaf *number(double value) {
+            Leaf *leaf = make(Leaf::Float);
+            leaf->lvalue.f = value;
+            return leaf;
+        }
+
+        Leaf *integer(int value) {
+            Leaf *leaf = make(Leaf::Integer);
+            leaf->lvalue.i = value;
+            return leaf;
+        }
+
+        Leaf *symbol(QString name) {
+            Leaf *leaf = make(Leaf::Symbol);
+            leaf->lvalue.n = new QString(name);
+            return leaf;
+        }
+
+        // arithmetic is a BinaryOperation, compares and assignments an Operation
+        Leaf *operation(int op, Leaf *lhs, Leaf *rhs) {
+            bool binary = op == ADD || op == SUBTRACT || op == MULTIPLY || op == DIVIDE || op == POW;
+            Leaf *leaf = make(binary ? Leaf::BinaryOperation : Leaf::Operation);
+            leaf->op = op;
+            leaf->lvalue.l = lhs;
+            leaf->rvalue.l = rhs;
+            return leaf;
+        }
+
+        Leaf *assign(QString name, Leaf *value) { return operation(ASSIGN, symbol(name), value); }
+
+        Leaf *loop(Leaf *cond, Leaf *body) {
+            Leaf *leaf = make(Leaf::Conditional);
+            leaf->op = WHILE;
+            leaf->cond.l = cond;
+            leaf->lvalue.l = body;
+            return leaf;
+        }
+
+        Leaf *block(QList<Leaf*> statements) {
+            Leaf *leaf = make(Leaf::Compound);
+            leaf->lvalue.b = new QList<Leaf*>(statements);
+            return leaf;
+        }
+
+        Leaf *function(QString name, QList<Leaf*> parms) {
+            Leaf *leaf = make(Leaf::Function);
+            leaf->function = name;
+            leaf->fparms = parms;
+            return leaf;
+        }
+
+    private:
+        Leaf *make(int type) {
+            Leaf *leaf = new Leaf(0, 0);
+            leaf->type = static_cast<decltype(leaf->type)>(type);
+            leaves << leaf;
+            return leaf;
+        }
+
+        QList<Leaf*> leaves;
+};
+
+//
+// The expected values are what Leaf::eval returns walking the same tree;
+// a while loop runs its body while count++ < 1000000 and the condition
+// holds and is worth the value of the last body run, or 0, an assignment
+// is worth the value assigned and a block the value of its last statement.
+//
+class TestDataFilterProgram: public QObject
+{
+    Q_OBJECT
+
+private:
+
+    // compile and run, the tree must have been lowered whole
+    double run(DataFilterRuntime &df, Leaf *root) {
+        DataFilterProgram::compile(&df, root);
+        if (root->program == NULL) {
+            QTest::qFail("not compiled", __FILE__, __LINE__);
+            return 0;
+        }
+        return root->program->run(&df, NULL, NULL, NULL);
+    }
+
+    // walk the tree as Leaf::eval does for numbers, the compiled program
+    // must give the same answer; Leaf::eval itself needs the whole of
+    // DataFilter.cpp, and so most of the application, to link
+    double walk(DataFilterRuntime &df, Leaf *leaf) {
+        if (leaf == NULL) return 0;
+
+        switch(leaf->type) {
+        case Leaf::Float : return leaf->lvalue.f;
+        case Leaf::Integer : return leaf->lvalue.i;
+        case Leaf::Symbol : return df.symbols.value(*(leaf->lvalue.n)).number();
+
+        case Leaf::Logical :
+            if (leaf->op == AND) return walk(df, leaf->lvalue.l) && walk(df, leaf->rvalue.l);
+            if (leaf->op == OR) return walk(df, leaf->lvalue.l) || walk(df, leaf->rvalue.l);
+            return walk(df, leaf->lvalue.l); // parenthesis
+
+        case Leaf::UnaryOperation :
+            if (leaf->op == '-') return walk(df, leaf->lvalue.l) * -1;
+            if (leaf->op == '!') return !walk(df, leaf->lvalue.l);
+            return 0;
+
+        case Leaf::BinaryOperation :
+        case Leaf::Operation :
+        {
+            if (leaf->op == ASSIGN) {
+                double value = walk(df, leaf->rvalue.l);
+                df.symbols.insert(*(leaf->lvalue.l->lvalue.n), Result(value));
+                return value;
+            }
+            double lhs = walk(df, leaf->lvalue.l);
+            if (leaf->op == ELVIS) return lhs ? lhs : walk(df, leaf->rvalue.l);
+            double rhs = walk(df, leaf->rvalue.l);
+            switch(leaf->op) {
+            case ADD: return lhs + rhs;
+            case SUBTRACT: return lhs - rhs;
+            case DIVIDE: return rhs ? lhs / rhs : 0;
+            case MULTIPLY: return lhs * rhs;
+            case POW: return pow(lhs, rhs);
+            case EQ: return lhs == rhs;
+            case NEQ: return lhs != rhs;
+            case LT: return lhs < rhs;
+            case LTE: return lhs <= rhs;
+            case GT: return lhs > rhs;
+            case GTE: return lhs >= rhs;
+            }
+            return 0;
+        }
+
+        case Leaf::Conditional :
+            if (leaf->op == WHILE) {
+                int count = 0;
+                double returning = 0;
+                while (count++ < 1000000 && walk(df, leaf->cond.l)) returning = walk(df, leaf->lvalue.l);
+                return returning;
+            }
+            if (walk(df, leaf->cond.l)) return walk(df, leaf->lvalue.l);
+            return walk(df, leaf->rvalue.l);
+
+        case Leaf::Compound :
+        {
+            double returning = 0;
+            foreach(Leaf *statement, *(leaf->lvalue.b)) returning = walk(df, statement);
+            return returning;
+        }
+
+        case Leaf::Function :
+            if (leaf->function == "round") {
+                double factor = 1;
+                if (leaf->fparms.count() == 2) factor = pow(10, walk(df, leaf->fparms[1]));
+                return round(walk(df, leaf->fparms[0]) * factor) / factor;
+            }
+            if (leaf->function == "max" || leaf->function == "min") {
+                double value = walk(df, leaf->fparms[0]);
+                for(int i=1; i<leaf->fparms.count(); i++) {
+                    double next = walk(df, leaf->fparms[i]);
+                    if (leaf->function == "max" ? next > value : next < value) value = next;
+                }
+                return value;
+            }
+            if (leaf->function == "sqrt") return sqrt(walk(df, leaf->fparms[0]));
+            if (leaf->function == "floor") return floor(walk(df, leaf->fparms[0]));
+            return 0;
+
+        default:
+            return 0;
+        }
+    }
+
+    // parse the expression as DataFilter does, then compile and run it with
+    // the symbols and walk it with the same symbols; the answers and the
+    // symbols left behind must be the same
+    void equivalent(QString expression, QHash<QString,double> symbols) {
+        DataFiltererrors.clear();
+        DataFilterroot = NULL;
+        DataFilter_setString(expression);
+        DataFilterparse();
+        DataFilter_clearString();
+        Leaf *root = DataFilterroot;
+        QVERIFY2(root && DataFiltererrors.isEmpty(), qPrintable(expression));
+
+        DataFilterRuntime compiled, walked;
+        foreach(QString name, symbols.keys()) {
+            compiled.symbols.insert(name, Result(symbols.value(name)));
+            walked.symbols.insert(name, Result(symbols.value(name)));
+        }
+
+        double expected = walk(walked, root);
+        double actual = run(compiled, root);
+        root->clear(root);
+        delete root;
+
+        QCOMPARE(actual, expected);
+        foreach(QString name, symbols.keys())
+            QCOMPARE(compiled.symbols.value(name).number(), walked.symbols.value(name).number());
+    }
+
+private slots:
+
+    // x <- 0; while (x < 5000000) { x <- x + 1000000 }
+    // the body holds 1000000 in a register, the loop count must not be there
+    void whileKeepsCount() {
+        DataFilterRuntime df;
+        df.symbols.insert("x", Result(0.0));
+
+        Tree t;
+        Leaf *root = t.block(QList<Leaf*>()
+            << t.assign("x", t.integer(0))
+            << t.loop(t.operation(LT, t.symbol("x"), t.integer(5000000)),
+                      t.block(QList<Leaf*>() << t.assign("x", t.operation(ADD, t.symbol("x"), t.integer(1000000))))));
+
+        QCOMPARE(run(df, root), 5000000.0);
+        QCOMPARE(df.symbols.value("x").number(), 5000000.0);
+    }
+
+    // k <- 7; while (0) { k <- 5 } is worth 0 and leaves k alone
+    void whileNeverRuns() {
+        DataFilterRuntime df;
+        df.symbols.insert("k", Result(7.0));
+
+        Tree t;
+        Leaf *root = t.loop(t.integer(0), t.block(QList<Leaf*>() << t.assign("k", t.integer(5))));
+
+        QCOMPARE(run(df, root), 0.0);
+        QCOMPARE(df.symbols.value("k").number(), 7.0);
+    }
+
+    // k <- 0; while (1) { k <- k + 1 } stops after 1000000 runs of the body
+    void whileIsBounded() {
+        DataFilterRuntime df;
+        df.symbols.insert("k", Result(0.0));
+
+        Tree t;
+        Leaf *root = t.block(QList<Leaf*>()
+            << t.assign("k", t.integer(0))
+            << t.loop(t.integer(1), t.block(QList<Leaf*>() << t.assign("k", t.operation(ADD, t.symbol("k"), t.integer(1))))));
+
+        QCOMPARE(run(df, root), 1000000.0);
+        QCOMPARE(df.symbols.value("k").number(), 1000000.0);
+    }
+
+    // i <- 0; n <- 0;
+    // while (i < 3) { j <- 0; while (j < 4) { j <- j + 1; n <- n + 1000000 }; i <- i + 1 }
+    void nestedWhile() {
+        DataFilterRuntime df;
+        df.symbols.insert("i", Result(0.0));
+        df.symbols.insert("j", Result(0.0));
+        df.symbols.insert("n", Result(0.0));
+
+        Tree t;
+        Leaf *inner = t.loop(t.operation(LT, t.symbol("j"), t.integer(4)),
+                             t.block(QList<Leaf*>()
+                                 << t.assign("j", t.operation(ADD, t.symbol("j"), t.integer(1)))
+                                 << t.assign("n", t.operation(ADD, t.symbol("n"), t.integer(1000000)))));
+        Leaf *outer = t.loop(t.operation(LT, t.symbol("i"), t.integer(3)),
+                             t.block(QList<Leaf*>()
+                                 << t.assign("j", t.integer(0))
+                                 << inner
+                                 << t.assign("i", t.operation(ADD, t.symbol("i"), t.integer(1)))));
+        Leaf *root = t.block(QList<Leaf*>()
+            << t.assign("i", t.integer(0))
+            << t.assign("n", t.integer(0))
+            << outer);
+
+        QCOMPARE(run(df, root), 3.0);
+        QCOMPARE(df.symbols.value("i").number(), 3.0);
+        QCOMPARE(df.symbols.value("j").number(), 4.0);
+        QCOMPARE(df.symbols.value("n").number(), 12000000.0);
+    }
+
+    // round(3.14159, 2)
+    void roundDp() {
+        DataFilterRuntime df;
+        Tree t;
+        Leaf *root = t.function("round", QList<Leaf*>() << t.number(3.14159) << t.integer(2));
+        QCOMPARE(run(df, root), 3.14);
+    }
+
+    // round(x, dp) and 1 + round(x, dp) with x = 2.71828, dp = 3
+    void roundDpSymbols() {
+        DataFilterRuntime df;
+        df.symbols.insert("x", Result(2.71828));
+        df.symbols.insert("dp", Result(3.0));
+
+        Tree t;
+        Leaf *root = t.function("round", QList<Leaf*>() << t.symbol("x") << t.symbol("dp"));
+        QCOMPARE(run(df, root), 2.718);
+
+        Leaf *offset = t.operation(ADD, t.integer(1), t.function("round", QList<Leaf*>() << t.symbol("x") << t.symbol("dp")));
+        QCOMPARE(run(df, offset), 3.718);
+    }
+
+    // round(1250, -2) rounds half away from zero to 1300, round(-2.5) to -3
+    void roundEdges() {
+        DataFilterRuntime df;
+        df.symbols.insert("x", Result(-2.5));
+
+        Tree t;
+        Leaf *hundreds = t.function("round", QList<Leaf*>() << t.integer(1250) << t.integer(-2));
+        QCOMPARE(run(df, hundreds), 1300.0);
+
+        Leaf *half = t.function("round", QList<Leaf*>() << t.symbol("x"));
+        QCOMPARE(run(df, half), -3.0);
+    }
+
+    void equivalentArithmetic_data() {
+        QTest::addColumn<QString>("expression");
+        QTest::newRow("precedence") << "x + y * 3 - x / y ^ 2";
+        QTest::newRow("divide by zero") << "x / (y - y) + 1";
+        QTest::newRow("unary") << "-x * -(y - 10)";
+        QTest::newRow("less") << "x < y";
+        QTest::newRow("at least") << "x >= 2.71828";
+        QTest::newRow("equal") << "y = 4";
+        QTest::newRow("not equal") << "x <> x";
+        QTest::newRow("logic") << "x > 2 && y < 3 || !(x > y)";
+        QTest::newRow("ternary") << "x > y ? max(x, y, 3.5) : min(x, -y, 0)";
+        QTest::newRow("elvis") << "(y - 4) ?: sqrt(x)";
+        QTest::newRow("functions") << "floor(x * 10) + sqrt(y) + max(x)";
+    }
+
+    // x = 2.71828, y = 4
+    void equivalentArithmetic() {
+        QFETCH(QString, expression);
+        QHash<QString,double> symbols;
+        symbols.insert("x", 2.71828);
+        symbols.insert("y", 4);
+        equivalent(expression, symbols);
+    }
+
+    void equivalentRound_data() {
+        QTest::addColumn<QString>("expression");
+        QTest::newRow("no places") << "round(x) + round(-2.5) + round(0.5)";
+        QTest::newRow("places") << "round(x, 2) + round(x, dp)";
+        QTest::newRow("negative places") << "round(1250, -2) + round(x * 1000, 0 - dp)";
+        QTest::newRow("nested") << "round(round(x, dp) * 10, dp - 1)";
+
+        // the places are evaluated before the value, each block changes x
+        QTest::newRow("order") << "round({ x <- x * 2; x / 3; }, { x <- 1; x; }) + x";
+    }
+
+    // x = 2.71828, dp = 3
+    void equivalentRound() {
+        QFETCH(QString, expression);
+        QHash<QString,double> symbols;
+        symbols.insert("x", 2.71828);
+        symbols.insert("dp", 3);
+        equivalent(expression, symbols);
+    }
+
+    void equivalentWhile_data() {
+        QTest::addColumn<QString>("expression");
+        QTest::newRow("count") << "{ i <- 0; n <- 0; while (i < 10) { n <- n + round(i / 3, 1); i <- i + 1; } n; }";
+        QTest::newRow("never") << "{ n <- 5; while (i > 100) { n <- 0; } }";
+        QTest::newRow("bounded") << "{ n <- 0; while (1) { n <- n + 1; } }";
+        QTest::newRow("nested") << "{ i <- 0; n <- 0; while (i < 3) { j <- 0; while (j < i + 2) { n <- n + i * j; j <- j + 1; } i <- i + 1; } }";
+        QTest::newRow("if in body") << "{ i <- 0; n <- 0; while (i < 20) { if (i > 9) { n <- n + 1000000; } else n <- n - 1; i <- i + 1; } n; }";
+        QTest::newRow("large constants") << "{ n <- 0; while (n < 5000000) { n <- n + 1000000; } }";
+    }
+
+    // i, j and n start at 0
+    void equivalentWhile() {
+        QFETCH(QString, expression);
+        QHash<QString,double> symbols;
+        symbols.insert("i", 0);
+        symbols.insert("j", 0);
+        symbols.insert("n", 0);
+        equivalent(expression, symbols);
+    }
+};
+
+
+QTEST_MAIN(TestDataFilterProgram)
+#include "testDataFilterProgram.moc"
@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testRideDBStore.cpp \
+          ../../../src/Core/RideDBStoreFile.cpp
+
+include(../../unittests.pri)
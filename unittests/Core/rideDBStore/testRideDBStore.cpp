@@ -0,0 +1,302 @@
+#include "Core/RideDBStoreFile.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <cstring>
+
+
+static QByteArray record(int metrics, qint64 dateTime, double value)
+{
+    QByteArray bytes(RideDBStoreFile::recordSize(metrics), '\0');
+    RideDBStoreRecord r;
+    memset(&r, 0, sizeof(r));
+    r.flags = RideDBStoreFile::RecordSamples;
+    r.dateTime = dateTime;
+    r.weight = 72.5;
+    memcpy(bytes.data(), &r, sizeof(r));
+
+    double *values = reinterpret_cast<double*>(bytes.data() + sizeof(r));
+    for (int i=0; i<metrics; i++) {
+        values[i] = value + i;
+        values[metrics + i] = 1;
+    }
+    return bytes;
+}
+
+// the side data is just the key, as the ride's filename is for RideDBStore
+static RideDBStoreFile::Entry entry(QString key, int metrics, double value)
+{
+    RideDBStoreFile::Entry e;
+    e.key = key;
+    e.record = record(metrics, 1000 * key.length(), value);
+    e.side = key.toUtf8();
+    return e;
+}
+
+struct Restored {
+    qint64 dateTime;
+    double weight, first, count;
+    quint32 flags;
+};
+
+// load everything, keeping all the records
+static QHash<QString, Restored> load(RideDBStoreFile &file, bool &ok)
+{
+    QHash<QString, Restored> restored;
+    ok = file.load([&restored](const QStringList &names, const RideDBStoreRecord &r, const double *values,
+                               const double *counts, const QByteArray &side, double) -> QString {
+        Restored x;
+        x.dateTime = r.dateTime;
+        x.weight = r.weight;
+        x.first = names.count() ? values[0] : 0;
+        x.count = names.count() ? counts[0] : 0;
+        x.flags = r.flags;
+        QString key = QString::fromUtf8(side);
+        restored.insert(key, x);
+        return key;
+    });
+    return restored;
+}
+
+static QByteArray contents(QString filename)
+{
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) return QByteArray();
+    return file.readAll();
+}
+
+static void replace(QString filename, QByteArray bytes)
+{
+    QFile file(filename);
+    if (file.open(QFile::WriteOnly | QFile::Truncate)) file.write(bytes);
+}
+
+class TestRideDBStore: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void format() {
+        QTemporaryDir dir;
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QStringList names = QStringList() << "a" << "bb" << "ccc";
+        QVERIFY(file.rewrite(names, QList<RideDBStoreFile::Entry>() << entry("activities/one", 3, 10) << entry("planned/two", 3, 20)));
+
+        // no padding anywhere, so the layout is the same on every platform
+        QCOMPARE(sizeof(RideDBStoreHeader), size_t(56));
+        QCOMPARE(sizeof(RideDBStoreSideHeader), size_t(16));
+        QCOMPARE(sizeof(RideDBStoreRecord), size_t(88));
+        QCOMPARE(RideDBStoreFile::recordSize(3), quint32(88 + 3 * 16));
+
+        // header, "a\nbb\nccc" is 8 bytes so needs no padding, then the records
+        QByteArray index = contents(file.indexFile());
+        QCOMPARE(index.size(), 56 + 8 + 2 * 136);
+        RideDBStoreHeader header;
+        memcpy(&header, index.constData(), sizeof(header));
+        QCOMPARE(QByteArray(header.magic, 8), QByteArray("GCRIDEDB"));
+        QCOMPARE(header.version, quint32(RIDEDB_STORE_VERSION));
+        QCOMPARE(header.metrics, quint32(3));
+        QCOMPARE(header.records, quint32(2));
+        QCOMPARE(header.recordSize, quint32(136));
+        QCOMPARE(header.namesSize, quint64(8));
+        QCOMPARE(header.sideSize, quint64(16 + 14 + 11));
+        QCOMPARE(header.sideGarbage, quint64(0));
+        QCOMPARE(index.mid(56, 8), QByteArray("a\nbb\nccc"));
+
+        RideDBStoreRecord first, second;
+        memcpy(&first, index.constData() + 64, sizeof(first));
+        memcpy(&second, index.constData() + 64 + 136, sizeof(second));
+        QCOMPARE(first.flags, quint32(RideDBStoreFile::RecordUsed | RideDBStoreFile::RecordSamples));
+        QCOMPARE(first.sideOffset, quint64(16));
+        QCOMPARE(first.sideLength, quint32(14));
+        QCOMPARE(second.sideOffset, quint64(16 + 14));
+        QCOMPARE(second.sideLength, quint32(11));
+
+        double values[6];
+        memcpy(values, index.constData() + 64 + 136 + 88, sizeof(values));
+        QCOMPARE(values[0], 20.0);
+        QCOMPARE(values[2], 22.0);
+        QCOMPARE(values[3], 1.0);
+
+        // side table is the header then the side data back to back
+        QByteArray side = contents(file.sideFile());
+        RideDBStoreSideHeader sheader;
+        memcpy(&sheader, side.constData(), sizeof(sheader));
+        QCOMPARE(QByteArray(sheader.magic, 8), QByteArray("GCRIDEDT"));
+        QCOMPARE(sheader.generation, header.generation);
+        QCOMPARE(side.mid(16), QByteArray("activities/oneplanned/two"));
+    }
+
+    void reload() {
+        QTemporaryDir dir;
+        QStringList names = QStringList() << "a" << "b";
+        {
+            RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+            QVERIFY(file.rewrite(names, QList<RideDBStoreFile::Entry>() << entry("one", 2, 10) << entry("three", 2, 30)));
+        }
+
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QVERIFY(!file.canUpdate(names));
+
+        bool ok;
+        QHash<QString, Restored> restored = load(file, ok);
+        QVERIFY(ok);
+        QCOMPARE(file.metricNames(), names);
+        QCOMPARE(restored.count(), 2);
+        QCOMPARE(restored["one"].first, 10.0);
+        QCOMPARE(restored["one"].dateTime, qint64(3000));
+        QCOMPARE(restored["three"].first, 30.0);
+        QCOMPARE(restored["three"].count, 1.0);
+        QCOMPARE(restored["three"].weight, 72.5);
+        QVERIFY(file.contains("one"));
+        QVERIFY(!file.contains("two"));
+        QVERIFY(file.canUpdate(names));
+        QVERIFY(!file.canUpdate(QStringList() << "a" << "c"));
+    }
+
+    // an empty store and a record with no metrics
+    void emptyStore() {
+        QTemporaryDir dir;
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+
+        bool ok;
+        load(file, ok);
+        QVERIFY(!ok);
+
+        QVERIFY(file.rewrite(QStringList(), QList<RideDBStoreFile::Entry>()));
+        QCOMPARE(load(file, ok).count(), 0);
+        QVERIFY(ok);
+        QCOMPARE(file.recordCount(), quint32(0));
+
+        QVERIFY(file.rewrite(QStringList(), QList<RideDBStoreFile::Entry>() << entry("one", 0, 0)));
+        QHash<QString, Restored> restored = load(file, ok);
+        QVERIFY(ok);
+        QCOMPARE(restored.keys(), QStringList() << "one");
+    }
+
+    void updateOnlyChanged() {
+        QTemporaryDir dir;
+        QStringList names = QStringList() << "a";
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QVERIFY(file.rewrite(names, QList<RideDBStoreFile::Entry>() << entry("aa", 1, 1) << entry("bbb", 1, 2) << entry("cccc", 1, 3)));
+        QCOMPARE(file.sideLength(), quint64(16 + 2 + 3 + 4));
+
+        // the same as on disk is not written again
+        QVERIFY(file.update(QList<RideDBStoreFile::Entry>() << entry("aa", 1, 1), QSet<QString>() << "aa" << "bbb" << "cccc"));
+        QCOMPARE(file.sideLength(), quint64(16 + 2 + 3 + 4));
+        QCOMPARE(file.garbage(), quint64(0));
+
+        // bbb changed and cccc was deleted
+        QVERIFY(file.update(QList<RideDBStoreFile::Entry>() << entry("bbb", 1, 5), QSet<QString>() << "aa" << "bbb"));
+        QCOMPARE(file.sideLength(), quint64(16 + 2 + 3 + 4 + 3));
+        QCOMPARE(file.garbage(), quint64(3 + 4));
+        QCOMPARE(file.recordCount(), quint32(3));
+
+        // a new one reuses the slot cccc had
+        QVERIFY(file.update(QList<RideDBStoreFile::Entry>() << entry("d", 1, 7), QSet<QString>() << "aa" << "bbb" << "d"));
+        QCOMPARE(file.recordCount(), quint32(3));
+
+        RideDBStoreFile reloaded(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        bool ok;
+        QHash<QString, Restored> restored = load(reloaded, ok);
+        QVERIFY(ok);
+        QCOMPARE(restored.count(), 3);
+        QCOMPARE(restored["aa"].first, 1.0);
+        QCOMPARE(restored["bbb"].first, 5.0);
+        QCOMPARE(restored["d"].first, 7.0);
+        QVERIFY(!restored.contains("cccc"));
+        QCOMPARE(reloaded.garbage(), quint64(3 + 4));
+    }
+
+    // the web api reads the store the ride cache is updating, as RideDBStore::read does
+    void readAlongsideWriter() {
+        QTemporaryDir dir;
+        QStringList names = QStringList() << "a";
+        RideDBStoreFile writer(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QVERIFY(writer.rewrite(names, QList<RideDBStoreFile::Entry>() << entry("aa", 1, 1) << entry("bbb", 1, 2)));
+
+        bool ok;
+        RideDBStoreFile reader(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QHash<QString, Restored> restored = load(reader, ok);
+        QVERIFY(ok);
+        QCOMPARE(restored.count(), 2);
+
+        // reading changes nothing, so the writer still only writes what changed
+        QByteArray index = contents(dir.path() + "/rideDB.bin");
+        QByteArray side = contents(dir.path() + "/rideDB.dat");
+        load(reader, ok);
+        QCOMPARE(contents(dir.path() + "/rideDB.bin"), index);
+        QCOMPARE(contents(dir.path() + "/rideDB.dat"), side);
+
+        QVERIFY(writer.canUpdate(names));
+        QVERIFY(writer.update(QList<RideDBStoreFile::Entry>() << entry("bbb", 1, 5) << entry("c", 1, 6), QSet<QString>() << "bbb" << "c"));
+
+        // and the reader sees the update
+        restored = load(reader, ok);
+        QVERIFY(ok);
+        QCOMPARE(restored.count(), 2);
+        QCOMPARE(restored["bbb"].first, 5.0);
+        QCOMPARE(restored["c"].first, 6.0);
+        QVERIFY(!restored.contains("aa"));
+    }
+
+    // the records were written but not the header that commits their side data
+    void incompleteUpdateIgnored() {
+        QTemporaryDir dir;
+        QStringList names = QStringList() << "a";
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QVERIFY(file.rewrite(names, QList<RideDBStoreFile::Entry>() << entry("aa", 1, 1) << entry("bbb", 1, 2)));
+        QByteArray before = contents(file.indexFile());
+
+        QVERIFY(file.update(QList<RideDBStoreFile::Entry>() << entry("bbb", 1, 9), QSet<QString>() << "aa" << "bbb"));
+        QByteArray after = contents(file.indexFile());
+        replace(file.indexFile(), before.left(sizeof(RideDBStoreHeader)) + after.mid(sizeof(RideDBStoreHeader)));
+
+        RideDBStoreFile reloaded(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        bool ok;
+        QHash<QString, Restored> restored = load(reloaded, ok);
+        QVERIFY(ok);
+        QCOMPARE(restored.keys(), QStringList() << "aa");
+        QVERIFY(!reloaded.contains("bbb"));
+    }
+
+    void mismatchRejected() {
+        QTemporaryDir dir;
+        RideDBStoreFile file(dir.path() + "/rideDB.bin", dir.path() + "/rideDB.dat");
+        QVERIFY(file.rewrite(QStringList() << "a", QList<RideDBStoreFile::Entry>() << entry("aa", 1, 1)));
+        QByteArray side = contents(file.sideFile());
+        QByteArray index = contents(file.indexFile());
+        bool ok;
+
+        // a side table from another generation
+        QByteArray other = side;
+        other[8] = char(other[8] ^ 0x1);
+        replace(file.sideFile(), other);
+        load(file, ok);
+        QVERIFY(!ok);
+        replace(file.sideFile(), side);
+
+        // another version
+        other = index;
+        other[8] = char(RIDEDB_STORE_VERSION + 1);
+        replace(file.indexFile(), other);
+        load(file, ok);
+        QVERIFY(!ok);
+
+        // records beyond the end of the file
+        replace(file.indexFile(), index.left(index.size() - 1));
+        load(file, ok);
+        QVERIFY(!ok);
+
+        replace(file.indexFile(), index);
+        QCOMPARE(load(file, ok).count(), 1);
+        QVERIFY(ok);
+    }
+};
+
+
+QTEST_MAIN(TestRideDBStore)
+#include "testRideDBStore.moc"
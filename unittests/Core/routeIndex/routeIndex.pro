@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testRouteIndex.cpp \
+          ../../../src/Core/RouteIndex.cpp
+
+include(../../unittests.pri)
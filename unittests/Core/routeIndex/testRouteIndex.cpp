@@ -0,0 +1,159 @@
+#include "Core/RouteIndex.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QFile>
+
+#include <cmath>
+
+
+// as RouteSegment::distance
+static double distance(double lat1, double lon1, double lat2, double lon2)
+{
+    double theta = (lon1 - lon2) * M_PI / 180.0;
+    if (lon1 == lon2 && lat1 == lat2) return 0;
+    double d = sin(lat1 * M_PI / 180.0) * sin(lat2 * M_PI / 180.0) +
+               cos(lat1 * M_PI / 180.0) * cos(lat2 * M_PI / 180.0) * cos(theta);
+    return acos(d) * 6371;
+}
+
+static QVector<quint32> track(const QVector<double> &lat, const QVector<double> &lon)
+{
+    QVector<quint32> tiles;
+    for (int i=0; i<lat.count(); i++) {
+        quint32 tile;
+        if (RouteIndex::tileAt(lat[i], lon[i], tile)) tiles << tile;
+    }
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+    return tiles;
+}
+
+class TestRouteIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    // the corners of the grid, a point inside a tile, and positions that aren't
+    void tiles() {
+        quint32 t;
+        QVERIFY(RouteIndex::tileAt(-90, -180, t));
+        QCOMPARE(t, quint32(0));
+
+        // +90 and +180 are in the last row and column
+        QVERIFY(RouteIndex::tileAt(90, 180, t));
+        QCOMPARE(t, quint32(17999 * 36000 + 35999));
+
+        // row 9000, column 18000
+        QVERIFY(RouteIndex::tileAt(0.005, 0.005, t));
+        QCOMPARE(t, quint32(324018000));
+
+        QVERIFY(!RouteIndex::tileAt(90.0001, 0, t));
+        QVERIFY(!RouteIndex::tileAt(0, -180.5, t));
+        QVERIFY(!RouteIndex::tileAt(std::nan(""), 0, t));
+        QVERIFY(!RouteIndex::tileAt(0, std::nan(""), t));
+    }
+
+    // no distance is the tile the point is in, and only that tile overlaps
+    void singleTile() {
+        RouteIndex::box b;
+        QVERIFY(RouteIndex::near(0.005, 0.005, 0, b));
+        QCOMPARE(b.row0, 9000);
+        QCOMPARE(b.row1, 9000);
+        QCOMPARE(b.col0, 18000);
+        QCOMPARE(b.col1, 18000);
+
+        QVERIFY(RouteIndex::overlaps(QVector<quint32>() << 324018000, b));
+        QVERIFY(!RouteIndex::overlaps(QVector<quint32>() << 324017999 << 324018001, b));
+        QVERIFY(!RouteIndex::overlaps(QVector<quint32>() << 324018000 + 36000, b));
+
+        // 89 degrees is as close to a pole as we go
+        QVERIFY(RouteIndex::near(88.995, 0, 0, b));
+        QVERIFY(!RouteIndex::near(89, 0, 0, b));
+        QVERIFY(!RouteIndex::near(-89, 0, 0, b));
+    }
+
+    void nearbyRidesOverlap() {
+        QRandomGenerator random(42);
+
+        for (int n=0; n<20000; n++) {
+            double lat = random.bounded(160.0) - 80.0;
+            double lon = random.bounded(359.0) - 179.5;
+
+            // a ride sample just within 100m in some direction
+            double bearing = random.bounded(2 * M_PI);
+            double km = 0.0999 * sqrt(random.bounded(1.0));
+            double rlat = lat + (km * cos(bearing)) / 111.19;
+            double rlon = lon + (km * sin(bearing)) / (111.19 * cos(rlat * M_PI / 180.0));
+            if (distance(lat, lon, rlat, rlon) > 0.1) continue;
+
+            RouteIndex::box b;
+            if (!RouteIndex::near(lat, lon, 0.1, b)) continue;
+
+            QVERIFY(RouteIndex::overlaps(track(QVector<double>() << rlat, QVector<double>() << rlon), b));
+        }
+    }
+
+    void distantRidesDont() {
+        RouteIndex::box b;
+        QVERIFY(RouteIndex::near(45.9, 6.5, 0.1, b));
+
+        // 5km north and east
+        QVector<quint32> tiles = track(QVector<double>() << 45.945 << 45.9, QVector<double>() << 6.5 << 6.565);
+        QVERIFY(!RouteIndex::overlaps(tiles, b));
+        QVERIFY(!RouteIndex::overlaps(QVector<quint32>(), b));
+    }
+
+    void polesAndDateLine() {
+        RouteIndex::box b;
+        QVERIFY(!RouteIndex::near(89.5, 10, 0.1, b));
+        QVERIFY(!RouteIndex::near(10, 179.9995, 0.1, b));
+        QVERIFY(!RouteIndex::near(10, -179.9995, 0.1, b));
+    }
+
+    void saveAndRead() {
+        QTemporaryDir dir;
+        QString filename = dir.path() + "/routetiles.bin";
+
+        RouteIndex index;
+        QVector<quint32> tiles = track(QVector<double>() << 45.9 << 46.0, QVector<double>() << 6.5 << 6.6);
+        index.update("2026_01_01_10_00_00.json", tiles);
+        index.update("2026_01_02_10_00_00.json", QVector<quint32>());
+        QVERIFY(index.write(filename));
+
+        RouteIndex loaded;
+        QVector<quint32> found;
+        QVERIFY(loaded.read(filename));
+        QVERIFY(loaded.find("2026_01_01_10_00_00.json", found));
+        QCOMPARE(found, tiles);
+        QVERIFY(loaded.find("2026_01_02_10_00_00.json", found));
+        QVERIFY(found.isEmpty());
+        QVERIFY(!loaded.find("missing.json", found));
+    }
+
+    // an index that never changed isn't written, one emptied is
+    void saveEmpty() {
+        QTemporaryDir dir;
+        QString filename = dir.path() + "/routetiles.bin";
+
+        RouteIndex index;
+        QVERIFY(index.write(filename));
+        QVERIFY(!QFile::exists(filename));
+
+        index.update("2026_01_01_10_00_00.json", QVector<quint32>() << 1);
+        index.remove("2026_01_01_10_00_00.json");
+        QVERIFY(index.write(filename));
+
+        RouteIndex loaded;
+        QVector<quint32> found;
+        QVERIFY(loaded.read(filename));
+        QVERIFY(!loaded.find("2026_01_01_10_00_00.json", found));
+    }
+
+};
+
+
+QTEST_MAIN(TestRouteIndex)
+#include "testRouteIndex.moc"
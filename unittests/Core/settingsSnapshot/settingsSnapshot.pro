@@ -0,0 +1,15 @@
+QT += testlib core gui widgets core5compat
+
+# Settings.cpp pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json
+
+SOURCES = testSettingsSnapshot.cpp \
+          ../../../src/Core/Settings.cpp
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES}
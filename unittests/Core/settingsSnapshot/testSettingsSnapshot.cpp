@@ -0,0 +1,118 @@
+#include "Core/Settings.h"
+#include "Gui/Colors.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QSemaphore>
+
+#include <functional>
+
+
+// only used when migrating settings from before v3.3
+QStringList GCColor::getConfigKeys() { return QStringList(); }
+
+
+class TestSettingsSnapshot: public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+    GSettings *saved;
+
+    // read on another thread, as the ride cache refresh does
+    static QVariant elsewhere(std::function<QVariant()> read) {
+        QVariant returning;
+        QThread *thread = QThread::create([&]() { returning = read(); });
+        thread->start();
+        thread->wait();
+        delete thread;
+        return returning;
+    }
+
+private slots:
+
+    // settings in a file of their own, not the user's
+    void initTestCase() {
+        QVERIFY(dir.isValid());
+        saved = appsettings;
+        appsettings = new GSettings(dir.path() + "/gc.ini", QSettings::IniFormat);
+    }
+
+    void cleanupTestCase() {
+        delete appsettings;
+        appsettings = saved;
+        GSettingsSnapshot::invalidate();
+    }
+
+    void defaults() {
+        QCOMPARE(GSettingsSnapshot::value(GCK_DISCOVERY), 57);
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", GCK_WEIGHT), QString("75.0"));
+        QCOMPARE(GSettingsSnapshot::cvalue("", GCK_WEIGHT), QString("75.0"));
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", "<athlete-preferences>cpforftp/Run", 0).toInt(), 0);
+    }
+
+    void setValue() {
+        QCOMPARE(GSettingsSnapshot::value(GCK_DISCOVERY), 57);
+        appsettings->setValue(GC_DISCOVERY, 12);
+        QCOMPARE(GSettingsSnapshot::value(GCK_DISCOVERY), 12);
+
+        appsettings->remove(GC_DISCOVERY);
+        QCOMPARE(GSettingsSnapshot::value(GCK_DISCOVERY), 57);
+    }
+
+    void setCValue() {
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", GCK_WEIGHT), QString("75.0"));
+        appsettings->setCValue("Alice", GC_WEIGHT, "68.5");
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", GCK_WEIGHT), QString("68.5"));
+
+        // only for that athlete
+        QCOMPARE(GSettingsSnapshot::cvalue("Bob", GCK_WEIGHT), QString("75.0"));
+
+        appsettings->setCValue("Alice", GC_WEIGHT, "70.0");
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", GCK_WEIGHT), QString("70.0"));
+    }
+
+    // keys made at runtime are cached by name
+    void setCValueByName() {
+        const QString key = "<athlete-preferences>cpforftp/Run";
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", key, 0).toInt(), 0);
+        appsettings->setCValue("Alice", key, 1);
+        QCOMPARE(GSettingsSnapshot::cvalue("Alice", key, 0).toInt(), 1);
+        QCOMPARE(GSettingsSnapshot::cvalue("Bob", key, 0).toInt(), 0);
+    }
+
+    // a thread that read the setting before it was changed
+    // reads the new value after
+    void otherThreads() {
+        std::function<QVariant()> read = []() { return QVariant(GSettingsSnapshot::cvalue("Carol", GCK_WEIGHT)); };
+
+        QCOMPARE(elsewhere(read).toString(), QString("75.0"));
+        appsettings->setCValue("Carol", GC_WEIGHT, "55.0");
+        QCOMPARE(elsewhere(read).toString(), QString("55.0"));
+
+        // and one that stays running
+        QString before, after;
+        QSemaphore changed, readit;
+        QThread *thread = QThread::create([&]() {
+            before = read().toString();
+            readit.release();
+            changed.acquire();
+            after = read().toString();
+        });
+        thread->start();
+        readit.acquire();
+        appsettings->setCValue("Carol", GC_WEIGHT, "56.0");
+        changed.release();
+        thread->wait();
+        delete thread;
+
+        QCOMPARE(before, QString("55.0"));
+        QCOMPARE(after, QString("56.0"));
+    }
+};
+
+
+QTEST_MAIN(TestSettingsSnapshot)
+#include "testSettingsSnapshot.moc"
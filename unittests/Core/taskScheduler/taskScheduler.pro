@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testTaskScheduler.cpp \
+          ../../../src/Core/TaskScheduler.cpp
+
+include(../../unittests.pri)
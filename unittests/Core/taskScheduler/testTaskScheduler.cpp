@@ -0,0 +1,84 @@
+#include "Core/TaskScheduler.h"
+
+#include <QTest>
+#include <QAtomicInt>
+#include <QVector>
+
+
+class TestTaskScheduler: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void runsAllTasks() {
+        QAtomicInt count(0);
+        TaskGroup group;
+        for (int i=0; i<1000; i++) group.run([&count]() { count.ref(); });
+        group.wait();
+        QCOMPARE(count.loadAcquire(), 1000);
+    }
+
+    void nestedGroupsComplete() {
+        // more outer tasks than workers, each waiting on inner tasks,
+        // must not run out of threads
+        int outer = TaskScheduler::instance().workerCount() * 4;
+        QVector<int> results(outer);
+        TaskGroup group;
+        for (int i=0; i<outer; i++) {
+            group.run([&results, i]() {
+                QAtomicInt sum(0);
+                TaskGroup inner;
+                for (int j=1; j<=16; j++) inner.run([&sum, j]() { sum.fetchAndAddRelaxed(j); });
+                inner.wait();
+                results[i] = sum.loadAcquire();
+            });
+        }
+        group.wait();
+        for (int i=0; i<outer; i++) QCOMPARE(results[i], 136);
+    }
+
+    void waitRunsOnlyItsGroup() {
+        // a task waiting on its inner group must not pick up unrelated
+        // work queued behind it, which would hold up its return
+        QAtomicInt nested(0);
+        QAtomicInt result(0);
+        TaskGroup other;
+        TaskGroup group;
+        group.run([&nested, &result, &other]() {
+            QThread *waiter = QThread::currentThread();
+            QAtomicInt waiting(1);
+            QAtomicInt sum(0);
+
+            TaskGroup inner;
+            for (int j=1; j<=16; j++) inner.run([&sum, j]() { sum.fetchAndAddRelaxed(j); });
+            for (int j=0; j<16; j++) {
+                other.run([&nested, waiter, &waiting]() {
+                    if (QThread::currentThread() == waiter && waiting.loadAcquire()) nested.ref();
+                });
+            }
+            inner.wait();
+            waiting.storeRelease(0);
+
+            // the unrelated tasks refer to waiting
+            other.wait();
+            result.storeRelease(sum.loadAcquire());
+        });
+        group.wait();
+
+        // compare here, a failure on a worker thread won't fail the test
+        QCOMPARE(result.loadAcquire(), 136);
+        QCOMPARE(nested.loadAcquire(), 0);
+    }
+
+    void stageTimings() {
+        TaskScheduler::instance().resetTimings();
+        {
+            TaskStageTimer timer("test");
+        }
+        QVERIFY(TaskScheduler::instance().timings().contains("test: 1 calls"));
+    }
+};
+
+
+QTEST_MAIN(TestTaskScheduler)
+#include "testTaskScheduler.moc"
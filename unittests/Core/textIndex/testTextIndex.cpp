@@ -0,0 +1,199 @@
+#include "Core/TextIndex.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+#include <QBuffer>
+
+
+// what FreeSearch did before the index, check every text
+static QSet<QString> scan(const QHash<QString, QStringList> &documents, const QStringList &tokens)
+{
+    QSet<QString> returning;
+    QHashIterator<QString, QStringList> it(documents);
+    while (it.hasNext()) {
+        it.next();
+        foreach(const QString &token, tokens)
+            foreach(const QString &text, it.value())
+                if (text.contains(token, Qt::CaseInsensitive)) returning.insert(it.key());
+    }
+    return returning;
+}
+
+static QString words(QRandomGenerator &random, int count)
+{
+    static const QStringList vocabulary = QStringList() << "Tempo" << "tempo" << "VO2max" << "sweet spot"
+        << "intervals" << "Col du Galibier" << "rain" << "Über" << "recovery" << "FTP test" << "race" << "hills";
+    QStringList returning;
+    for (int i=0; i<count; i++) returning << vocabulary[random.bounded(vocabulary.count())];
+    return returning.join(" ");
+}
+
+class TestTextIndex: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void substringsIgnoreCase() {
+        TextIndex index;
+        index.update("a", 1, QStringList() << "Morning Tempo ride" << "Lap 1");
+        index.update("b", 2, QStringList() << "Recovery spin");
+        index.update("c", 3, QStringList());
+
+        QCOMPARE(index.search(QStringList() << "tempo"), QSet<QString>() << "a");
+        QCOMPARE(index.search(QStringList() << "EMP"), QSet<QString>() << "a");
+        QCOMPARE(index.search(QStringList() << "spin" << "lap"), QSet<QString>() << "a" << "b");
+        QCOMPARE(index.search(QStringList() << "p"), QSet<QString>() << "a" << "b");
+        QCOMPARE(index.search(QStringList() << "tempo spin"), QSet<QString>());
+
+        // trigrams in different texts don't match
+        QCOMPARE(index.search(QStringList() << "ride Lap"), QSet<QString>());
+    }
+
+    // nothing indexed, nothing to search for, and texts shorter than a trigram
+    void emptyAndShort() {
+        TextIndex index;
+        QCOMPARE(index.search(QStringList() << "tempo"), QSet<QString>());
+        QCOMPARE(index.search(QStringList()), QSet<QString>());
+
+        index.update("a", 1, QStringList() << "Z");
+        index.update("b", 2, QStringList() << "");
+        index.update("c", 3, QStringList());
+        index.update("d", 4, QStringList() << "ABC");
+
+        // an empty token is in every text but a document with none
+        QCOMPARE(index.search(QStringList() << ""), QSet<QString>() << "a" << "b" << "d");
+        QCOMPARE(index.search(QStringList() << "z"), QSet<QString>() << "a");
+        QCOMPARE(index.search(QStringList() << "abc"), QSet<QString>() << "d");
+        QCOMPARE(index.search(QStringList() << "abcd"), QSet<QString>());
+        QCOMPARE(index.search(QStringList() << "zz"), QSet<QString>());
+    }
+
+    // case folding beyond ASCII, one character to one character
+    void unicodeCase() {
+        TextIndex index;
+        index.update("a", 1, QStringList() << QString::fromUtf8("Über die Alpen"));
+        index.update("b", 2, QStringList() << QString::fromUtf8("Lac de Neuchâtel"));
+        index.update("c", 3, QStringList() << QString::fromUtf8("Straße"));
+        index.update("d", 4, QStringList() << QString::fromUtf8("Club ride 🚴 fast"));
+
+        QCOMPARE(index.search(QStringList() << QString::fromUtf8("über")), QSet<QString>() << "a");
+        QCOMPARE(index.search(QStringList() << QString::fromUtf8("ÜBER")), QSet<QString>() << "a");
+        QCOMPARE(index.search(QStringList() << QString::fromUtf8("NEUCHÂTEL")), QSet<QString>() << "b");
+
+        // accents are not stripped
+        QCOMPARE(index.search(QStringList() << "neuchatel"), QSet<QString>());
+
+        // capital sharp s folds to ß, but ß is not expanded to ss
+        QCOMPARE(index.search(QStringList() << QString::fromUtf8("STRAẞE")), QSet<QString>() << "c");
+        QCOMPARE(index.search(QStringList() << "strasse"), QSet<QString>());
+
+        // a surrogate pair is two of the three characters in a trigram
+        QCOMPARE(index.search(QStringList() << QString::fromUtf8("🚴 F")), QSet<QString>() << "d");
+    }
+
+    void updateAndRemove() {
+        TextIndex index;
+        index.update("a", 1, QStringList() << "threshold");
+        QVERIFY(index.contains("a", 1));
+        QVERIFY(!index.contains("a", 2));
+
+        index.update("a", 2, QStringList() << "endurance");
+        QCOMPARE(index.search(QStringList() << "thresh"), QSet<QString>());
+        QCOMPARE(index.search(QStringList() << "durance"), QSet<QString>() << "a");
+
+        index.remove("a");
+        QCOMPARE(index.count(), 0);
+        QCOMPARE(index.search(QStringList() << "durance"), QSet<QString>());
+
+        // removed ids are reused
+        index.update("b", 3, QStringList() << "endurance");
+        QCOMPARE(index.search(QStringList() << "durance"), QSet<QString>() << "b");
+    }
+
+    // as FreeSearchIndex::refresh does after a ride's metadata or name changed
+    // under it, the signature no longer matches so its texts are replaced
+    void changedItemIsFound() {
+        TextIndex index;
+        QStringList before = QStringList() << "Easy spin" << "Calendar: Easy spin";
+        index.update("2026_01_05_07_00_00.json", TextIndex::signature(before), before);
+        index.update("2026_01_06_07_00_00.json", TextIndex::signature(QStringList() << "Hill repeats"),
+                     QStringList() << "Hill repeats");
+
+        // the calendar text was rewritten in the background
+        QStringList after = QStringList() << "Easy spin" << "Calendar: Easy spin, Zwift";
+        QVERIFY(TextIndex::signature(after) != TextIndex::signature(before));
+        QVERIFY(!index.contains("2026_01_05_07_00_00.json", TextIndex::signature(after)));
+        index.update("2026_01_05_07_00_00.json", TextIndex::signature(after), after);
+
+        QCOMPARE(index.search(QStringList() << "zwift"), QSet<QString>() << "2026_01_05_07_00_00.json");
+        QCOMPARE(index.search(QStringList() << "easy"), QSet<QString>() << "2026_01_05_07_00_00.json");
+        QCOMPARE(index.count(), 2);
+
+        // and shifted to another day, a full check adds the new name and drops the old
+        index.update("2026_01_12_07_00_00.json", TextIndex::signature(after), after);
+        index.remove("2026_01_05_07_00_00.json");
+
+        QCOMPARE(index.search(QStringList() << "zwift"), QSet<QString>() << "2026_01_12_07_00_00.json");
+        QCOMPARE(index.search(QStringList() << "hill"), QSet<QString>() << "2026_01_06_07_00_00.json");
+        QCOMPARE(index.keys().count(), 2);
+        QVERIFY(!index.keys().contains("2026_01_05_07_00_00.json"));
+    }
+
+    void matchesScan() {
+        QRandomGenerator random(42);
+        QHash<QString, QStringList> documents;
+        TextIndex index;
+
+        for (int i=0; i<500; i++) {
+            QString key = QString("ride%1.json").arg(i);
+            QStringList texts;
+            for (int j=random.bounded(4); j>=0; j--) texts << words(random, 1 + random.bounded(6));
+            documents.insert(key, texts);
+            index.update(key, TextIndex::signature(texts), texts);
+        }
+
+        // some edits and deletes
+        for (int i=0; i<100; i++) {
+            QString key = QString("ride%1.json").arg(random.bounded(500));
+            if (i % 3 == 0) {
+                documents.remove(key);
+                index.remove(key);
+            } else {
+                QStringList texts = QStringList() << words(random, 3);
+                documents.insert(key, texts);
+                index.update(key, TextIndex::signature(texts), texts);
+            }
+        }
+
+        QList<QStringList> queries;
+        queries << (QStringList() << "tempo") << (QStringList() << "über") << (QStringList() << "spot int")
+                << (QStringList() << "gal" << "rain") << (QStringList() << "x") << (QStringList() << "")
+                << (QStringList() << "max hills") << (QStringList() << "nothing here");
+
+        foreach(const QStringList &tokens, queries)
+            QCOMPARE(index.search(tokens), scan(documents, tokens));
+
+        // and after being saved and read back
+        QByteArray saved;
+        QBuffer buffer(&saved);
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream out(&buffer);
+        index.write(out);
+        buffer.close();
+
+        TextIndex loaded;
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream in(&buffer);
+        QVERIFY(loaded.read(in));
+        QCOMPARE(loaded.count(), documents.count());
+
+        foreach(const QStringList &tokens, queries)
+            QCOMPARE(loaded.search(tokens), scan(documents, tokens));
+    }
+
+};
+
+
+QTEST_MAIN(TestTextIndex)
+#include "testTextIndex.moc"
@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testTextIndex.cpp \
+          ../../../src/Core/TextIndex.cpp
+
+include(../../unittests.pri)
@@ -0,0 +1,27 @@
+QT += testlib core gui widgets core5compat network
+
+# FitRideFile.cpp pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json \
+               ../../../contrib/lmfit
+
+SOURCES = testFitDecoder.cpp \
+          ../../../src/FileIO/FitRideFile.cpp \
+          ../../../src/FileIO/RideFile.cpp \
+          ../../../src/FileIO/RideFileCommand.cpp \
+          ../../../src/FileIO/MeanMaxEngine.cpp \
+          ../../../src/Core/SplineLookup.cpp \
+          ../../../contrib/qzip/zip.cpp
+
+# RideItem is only constructed when writing, but it is a QObject
+HEADERS = ../../../src/FileIO/RideFile.h \
+          ../../../src/FileIO/RideFileCommand.h \
+          ../../../src/Core/RideItem.h
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES} $${LIBZ_INCLUDE}
+LIBS += $${LIBZ_LIBS}
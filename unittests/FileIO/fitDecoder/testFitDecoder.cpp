@@ -0,0 +1,412 @@
+#include "FileIO/FitRideFile.h"
+#include "FileIO/DataProcessor.h"
+#include "Core/Athlete.h"
+#include "Core/Context.h"
+#include "Core/RideItem.h"
+#include "Core/Settings.h"
+#include "Core/Units.h"
+#include "FileIO/FilterHRV.h"
+#include "Gui/Colors.h"
+#include "Metrics/RideMetric.h"
+#include "Metrics/WPrime.h"
+#include "Metrics/Zones.h"
+#include "Core/Specification.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QtEndian>
+
+
+// the rest of the tree the reader refers to, none of it is reached
+// by decoding the records, developer fields and file ids below
+GSettings *appsettings = NULL;
+QVariant GSettings::value(const QObject *, const QString, const QVariant def) { return def; }
+QVariant GSettings::cvalue(QString, QString, QVariant def) { return def; }
+GlobalContext *GlobalContext::context() { return NULL; }
+QColor GCColor::getColor(int) { return QColor(); }
+QString kphToPace(double, bool, bool) { return QString(); }
+void FilterHrv(XDataSeries *, double, double, double, int) {}
+double Athlete::getWeight(QDate, RideFile *) { return 0; }
+double Athlete::getHeight(RideFile *) { return 0; }
+int Zones::whichRange(const QDate &) const { return -1; }
+int Zones::getCP(int) const { return 0; }
+WPrime::WPrime() {}
+void WPrime::setRide(RideFile *) {}
+DateRange::DateRange(QDate, QDate, QString, QColor) : valid(false) {}
+DateRange::DateRange(const DateRange &) : valid(false) {}
+DateRange &DateRange::operator=(const DateRange &) { return *this; }
+PlanFilter::PlanFilter(PlanFilterType) {}
+Specification::Specification() : it(NULL), recintsecs(0), ri(NULL) {}
+double Specification::secsStart() const { return -1; }
+double Specification::secsEnd() const { return -1; }
+QString gcroot;
+DataProcessorFactory *DataProcessorFactory::instance_ = NULL;
+DataProcessorFactory &DataProcessorFactory::instance() { if (!instance_) instance_ = new DataProcessorFactory(); return *instance_; }
+QMap<QString,DataProcessor*> DataProcessorFactory::getProcessors(bool) const { return processors; }
+RideItem::RideItem(RideFile *ride, Context *context) : ride_(ride), fileCache_(NULL), context(context) {}
+RideItem::~RideItem() {}
+void RideItem::modified() {}
+void RideItem::reverted() {}
+void RideItem::saved() {}
+void RideItem::notifyRideDataChanged() {}
+void RideItem::notifyRideMetadataChanged() {}
+QHash<QString,RideMetricPtr> RideMetric::computeMetrics(RideItem *, Specification, const QStringList &) { return QHash<QString,RideMetricPtr>(); }
+
+// the product names etc, these files don't need them and they
+// would be fetched from the website the first time a file is read
+extern bool loaded;
+
+// FIT base types, as they appear in a field definition
+enum { Enum = 0x00, Sint8 = 0x01, Uint8 = 0x02, Sint16 = 0x83, Uint16 = 0x84,
+       Sint32 = 0x85, Uint32 = 0x86, String = 0x07 };
+
+// seconds from the unix epoch to the FIT epoch, 1989-12-31 UTC
+static const qint64 FIT_EPOCH = 631065600;
+
+// a FIT file put together a message at a time, with a 14 byte header
+// and both CRCs left at 0 since the reader doesn't check them
+class FitFile
+{
+    public:
+        // type is the developer data index for a developer field
+        struct Field { int num, size, type; };
+
+        void define(int local, int global, QList<Field> fields, QList<Field> developer = QList<Field>(), bool bigEndian = false) {
+            messages.append(char(0x40 | (developer.isEmpty() ? 0 : 0x20) | local));
+            messages.append(char(0));
+            messages.append(char(bigEndian ? 1 : 0));
+            append(global, 2, bigEndian);
+            messages.append(char(fields.count()));
+            sizes[local].clear();
+            foreach(Field field, fields) {
+                messages.append(char(field.num));
+                messages.append(char(field.size));
+                messages.append(char(field.type));
+                sizes[local] << field.size;
+            }
+            if (!developer.isEmpty()) {
+                messages.append(char(developer.count()));
+                foreach(Field field, developer) {
+                    messages.append(char(field.num));
+                    messages.append(char(field.size));
+                    messages.append(char(field.type));
+                    sizes[local] << field.size;
+                }
+            }
+            endian[local] = bigEndian;
+        }
+
+        // values in the order they were defined, strings are padded with 0
+        void data(int local, QVariantList values) {
+            messages.append(char(local));
+            append(local, values);
+        }
+
+        // with the time as an offset from the last timestamp, local 0-3 only
+        void compressed(int local, int offset, QVariantList values) {
+            messages.append(char(0x80 | (local << 5) | offset));
+            append(local, values);
+        }
+
+        QByteArray bytes() const {
+            QByteArray returning;
+            returning.append(char(14));
+            returning.append(char(0x20)); // protocol 2.0
+            returning.append(char(0x5c)); // profile 21.40, little endian
+            returning.append(char(0x08));
+            quint32 size = qToLittleEndian<quint32>(messages.size());
+            returning.append(reinterpret_cast<const char*>(&size), 4);
+            returning.append(".FIT");
+            returning.append(2, char(0));
+            returning.append(messages);
+            returning.append(2, char(0));
+            return returning;
+        }
+
+    private:
+        void append(qint64 value, int size, bool bigEndian) {
+            for (int i=0; i<size; i++) {
+                int shift = 8 * (bigEndian ? size - 1 - i : i);
+                messages.append(char((value >> shift) & 0xff));
+            }
+        }
+
+        void append(int local, QVariantList values) {
+            for (int i=0; i<values.count(); i++) {
+                int size = sizes[local][i];
+                if (values[i].typeId() == QMetaType::QString) {
+                    QByteArray text = values[i].toString().toLatin1().left(size);
+                    messages.append(text);
+                    messages.append(size - text.size(), char(0));
+                } else {
+                    append(values[i].toLongLong(), size, endian[local]);
+                }
+            }
+        }
+
+        QByteArray messages;
+        QMap<int, QList<int> > sizes;
+        QMap<int, bool> endian;
+};
+
+// a file_id from a device no one has heard of
+static void fileId(FitFile &fit)
+{
+    fit.define(0, 0, QList<FitFile::Field>() << FitFile::Field { 0, 1, Enum }
+                                             << FitFile::Field { 1, 2, Uint16 }
+                                             << FitFile::Field { 2, 2, Uint16 });
+    fit.data(0, QVariantList() << 4 << 9999 << 7);
+}
+
+// records as a bike computer with a power meter writes them,
+// sample i is at 1000000000+i seconds into the FIT epoch
+static QList<FitFile::Field> recordFields()
+{
+    return QList<FitFile::Field>() << FitFile::Field { 253, 4, Uint32 }
+                                   << FitFile::Field { 0, 4, Sint32 }
+                                   << FitFile::Field { 1, 4, Sint32 }
+                                   << FitFile::Field { 2, 2, Uint16 }
+                                   << FitFile::Field { 3, 1, Uint8 }
+                                   << FitFile::Field { 4, 1, Uint8 }
+                                   << FitFile::Field { 5, 4, Uint32 }
+                                   << FitFile::Field { 6, 2, Uint16 }
+                                   << FitFile::Field { 7, 2, Uint16 }
+                                   << FitFile::Field { 13, 1, Sint8 };
+}
+
+static QVariantList record(int i)
+{
+    return QVariantList() << 1000000000 + i << 0x20000000 << -0x10000000 << 3000 + 5 * i
+                          << 120 + i << 80 + i << 500 * i << 8000 << 200 + 10 * i << -3;
+}
+
+// the size of a record message, header included
+static const int RECORD_SIZE = 1 + 4 + 4 + 4 + 2 + 1 + 1 + 4 + 2 + 2 + 1;
+
+
+class TestFitDecoder: public QObject
+{
+    Q_OBJECT
+
+    QTemporaryDir dir;
+
+    // read as the import does, with any errors it reports
+    RideFile *read(const QByteArray &fit, QStringList &errors) {
+        QFile file(dir.path() + "/ride.fit");
+        if (!file.open(QFile::WriteOnly | QFile::Truncate)) return NULL;
+        file.write(fit);
+        file.close();
+        return FitFileReader().openRideFile(file, errors);
+    }
+
+    // sample i as the fields from record(i) are decoded
+    void compareRecord(const RideFilePoint *p, int i) {
+        QCOMPARE(p->secs, double(i + 1));
+        QCOMPARE(p->lat, 0x20000000 * 180.0 / 0x7fffffff);
+        QCOMPARE(p->lon, -0x10000000 * 180.0 / 0x7fffffff);
+        QCOMPARE(p->alt, 100.0 + i);
+        QCOMPARE(p->hr, 120.0 + i);
+        QCOMPARE(p->cad, 80.0 + i);
+        QCOMPARE(p->km, 500 * i / 100000.0);
+        QCOMPARE(p->kph, 8000 * 3.6 / 1000.0);
+        QCOMPARE(p->watts, 200.0 + 10 * i);
+        QCOMPARE(p->temp, -3.0);
+    }
+
+private slots:
+
+    void initTestCase() {
+        QVERIFY(dir.isValid());
+        gcroot = dir.path();
+        loaded = true;
+    }
+
+    // the same samples and metadata the reader gave when it read a field at a time
+    void records() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 20, recordFields());
+        for (int i=0; i<3; i++) fit.data(1, record(i));
+
+        // and the rest from a big endian device
+        fit.define(1, 20, recordFields(), QList<FitFile::Field>(), true);
+        for (int i=3; i<5; i++) fit.data(1, record(i));
+
+        QStringList errors;
+        RideFile *ride = read(fit.bytes(), errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList());
+
+        QCOMPARE(ride->deviceType(), QString("Unknown FIT Device 9999:7"));
+        QCOMPARE(ride->fileFormat(), QString("Flexible and Interoperable Data Transfer (FIT)"));
+        QCOMPARE(ride->recIntSecs(), 1.0);
+
+        // the first sample is 1s into the ride
+        QCOMPARE(ride->startTime().toSecsSinceEpoch(), FIT_EPOCH + 1000000000 - 1);
+        QCOMPARE(ride->dataPoints().count(), 5);
+        for (int i=0; i<5; i++) compareRecord(ride->dataPoints()[i], i);
+        QVERIFY(ride->xdata("DEVELOPER") == NULL);
+        QVERIFY(ride->xdata("EXTRA") == NULL);
+        delete ride;
+    }
+
+    // time is the offset in the header from the first timestamp, less the
+    // second the reader puts before it, the same as it always has been
+    void compressedTimestamps() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 20, QList<FitFile::Field>() << FitFile::Field { 253, 4, Uint32 }
+                                                  << FitFile::Field { 3, 1, Uint8 }
+                                                  << FitFile::Field { 7, 2, Uint16 });
+        fit.define(2, 20, QList<FitFile::Field>() << FitFile::Field { 3, 1, Uint8 }
+                                                  << FitFile::Field { 7, 2, Uint16 });
+        fit.data(1, QVariantList() << 1000000000 << 130 << 300);
+        for (int i=1; i<4; i++) fit.compressed(2, i + 1, QVariantList() << 130 + i << 300 + i);
+
+        QStringList errors;
+        RideFile *ride = read(fit.bytes(), errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList());
+
+        QCOMPARE(ride->dataPoints().count(), 4);
+        for (int i=0; i<4; i++) {
+            const RideFilePoint *p = ride->dataPoints()[i];
+            QCOMPARE(p->secs, double(i + 1));
+            QCOMPARE(p->hr, 130.0 + i);
+            QCOMPARE(p->watts, 300.0 + i);
+        }
+        delete ride;
+    }
+
+    // one developer field of its own and one standing in for power
+    void developerFields() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 206, QList<FitFile::Field>() << FitFile::Field { 0, 1, Uint8 }
+                                                   << FitFile::Field { 1, 1, Uint8 }
+                                                   << FitFile::Field { 2, 1, Uint8 }
+                                                   << FitFile::Field { 3, 16, String }
+                                                   << FitFile::Field { 6, 1, Uint8 }
+                                                   << FitFile::Field { 8, 8, String }
+                                                   << FitFile::Field { 15, 1, Uint8 });
+        fit.data(1, QVariantList() << 0 << 0 << int(Uint16) << "Balance Score" << 10 << "pts" << 0xff);
+        fit.data(1, QVariantList() << 0 << 1 << int(Uint16) << "Power2" << 0xff << "W" << 7);
+
+        fit.define(2, 20, QList<FitFile::Field>() << FitFile::Field { 253, 4, Uint32 }
+                                                  << FitFile::Field { 3, 1, Uint8 },
+                          QList<FitFile::Field>() << FitFile::Field { 0, 2, 0 }
+                                                  << FitFile::Field { 1, 2, 0 });
+        for (int i=0; i<3; i++) fit.data(2, QVariantList() << 1000000000 + i << 100 + i << 1235 + 10 * i << 250 + i);
+
+        QStringList errors;
+        RideFile *ride = read(fit.bytes(), errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList());
+
+        QCOMPARE(ride->dataPoints().count(), 3);
+        for (int i=0; i<3; i++) {
+            QCOMPARE(ride->dataPoints()[i]->hr, 100.0 + i);
+            QCOMPARE(ride->dataPoints()[i]->watts, 250.0 + i);
+        }
+
+        // both are kept as they were recorded, scaled
+        XDataSeries *developer = ride->xdata("DEVELOPER");
+        QVERIFY(developer != NULL);
+        QCOMPARE(developer->valuename, QStringList() << "Balance Score" << "Power2");
+        QCOMPARE(developer->unitname, QStringList() << "pts" << "W");
+        QCOMPARE(developer->datapoints.count(), 3);
+        for (int i=0; i<3; i++) {
+            QCOMPARE(developer->datapoints[i]->secs, double(i + 1));
+            QCOMPARE(developer->datapoints[i]->number[0], 123.5 + i);
+            QCOMPARE(developer->datapoints[i]->number[1], 250.0 + i);
+        }
+        delete ride;
+    }
+
+    // the reader used to read these a field at a time, so a field smaller
+    // than its type left the rest of the message misread; now each field
+    // is found at its own offset, and one too short for its type has no value
+    void undersizedFields() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 20, QList<FitFile::Field>() << FitFile::Field { 253, 4, Uint32 }
+                                                  << FitFile::Field { 7, 1, Uint16 }
+                                                  << FitFile::Field { 3, 1, Uint8 }
+                                                  << FitFile::Field { 9, 1, Sint16 }
+                                                  << FitFile::Field { 5, 2, Uint32 }
+                                                  << FitFile::Field { 4, 1, Uint8 });
+        fit.data(1, QVariantList() << 1000000000 << 200 << 150 << 5 << 1234 << 90);
+
+        QStringList errors;
+        RideFile *ride = read(fit.bytes(), errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList());
+
+        QCOMPARE(ride->dataPoints().count(), 1);
+        const RideFilePoint *p = ride->dataPoints()[0];
+        QCOMPARE(p->watts, 0.0);
+        QCOMPARE(p->slope, 0.0);
+        QCOMPARE(p->hr, 150.0);
+        QCOMPARE(p->cad, 90.0);
+
+        // a uint32 in 2 bytes, as Coros devices write them, is read as is
+        QCOMPARE(p->km, 1234 / 100000.0);
+        delete ride;
+    }
+
+    // everything before the cut is kept
+    void truncatedBody() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 20, recordFields());
+        for (int i=0; i<4; i++) fit.data(1, record(i));
+
+        // part way through the last record, the header says there is more
+        QByteArray bytes = fit.bytes();
+        bytes.chop(2 + RECORD_SIZE / 2);
+
+        QStringList errors;
+        RideFile *ride = read(bytes, errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList() << "truncated file body");
+
+        QCOMPARE(ride->deviceType(), QString("Unknown FIT Device 9999:7"));
+        QCOMPARE(ride->dataPoints().count(), 3);
+        for (int i=0; i<3; i++) compareRecord(ride->dataPoints()[i], i);
+        delete ride;
+    }
+
+    // and the same when the cut is part way through a definition
+    void truncatedDefinition() {
+        FitFile fit;
+        fileId(fit);
+        fit.define(1, 20, recordFields());
+        for (int i=0; i<2; i++) fit.data(1, record(i));
+        fit.define(2, 20, recordFields());
+
+        QByteArray bytes = fit.bytes();
+        bytes.chop(2 + 10);
+
+        QStringList errors;
+        RideFile *ride = read(bytes, errors);
+        QVERIFY(ride != NULL);
+        QCOMPARE(errors, QStringList() << "truncated file body");
+
+        QCOMPARE(ride->dataPoints().count(), 2);
+        for (int i=0; i<2; i++) compareRecord(ride->dataPoints()[i], i);
+        delete ride;
+    }
+
+    // but not if the header is cut short
+    void truncatedHeader() {
+        FitFile fit;
+        fileId(fit);
+
+        QStringList errors;
+        QVERIFY(read(fit.bytes().left(6), errors) == NULL);
+        QCOMPARE(errors, QStringList() << "truncated file header");
+    }
+};
+
+QTEST_MAIN(TestFitDecoder)
+#include "testFitDecoder.moc"
@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testMeanMaxEngine.cpp \
+          ../../../src/FileIO/MeanMaxEngine.cpp
+
+include(../../unittests.pri)
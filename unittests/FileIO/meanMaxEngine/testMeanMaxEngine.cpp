@@ -0,0 +1,258 @@
+#include "FileIO/MeanMaxEngine.h"
+
+#include <QTest>
+#include <QVector>
+#include <QRandomGenerator>
+
+#include <limits>
+
+
+// a ride with a power like series, secs from 0 at 1s
+static void makeRide(int count, QVector<double> &secs, QVector<double> &values, quint32 seed=42)
+{
+    QRandomGenerator random(seed);
+    secs.resize(count);
+    values.resize(count);
+    double level = 200;
+    for (int i=0; i<count; i++) {
+        if (i % 300 == 0) level = 100 + random.bounded(250);
+        secs[i] = i;
+        values[i] = level + random.bounded(60) - 30;
+    }
+}
+
+static QVector<float> fresh(MeanMaxEngine::transform type, const QVector<double> &secs, const QVector<double> &values)
+{
+    MeanMaxEngine engine(type, 1, 1, 75);
+    engine.update(secs.constData(), values.constData(), 0, secs.count());
+    return engine.bests();
+}
+
+class TestMeanMaxEngine: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void editMatchesFullSearch_data() {
+        QTest::addColumn<int>("type");
+        QTest::addRow("plain") << int(MeanMaxEngine::Plain);
+        QTest::addRow("xpower") << int(MeanMaxEngine::XPower);
+        QTest::addRow("isopower") << int(MeanMaxEngine::IsoPower);
+        QTest::addRow("perkg") << int(MeanMaxEngine::PerKg);
+    }
+
+    void editMatchesFullSearch() {
+        QFETCH(int, type);
+        MeanMaxEngine::transform t = static_cast<MeanMaxEngine::transform>(type);
+
+        QVector<double> secs, values;
+        makeRide(4*3600, secs, values);
+
+        MeanMaxEngine engine(t, 1, 1, 75);
+        QVERIFY(engine.update(secs.constData(), values.constData(), 0, secs.count()));
+
+        // spike then flatten the same samples, the second undoes bests set by the first
+        for (int i=7200; i<7260; i++) values[i] = 1500;
+        QVERIFY(engine.update(secs.constData(), values.constData(), 0, secs.count()));
+        QCOMPARE(engine.bests(), fresh(t, secs, values));
+
+        for (int i=7200; i<7260; i++) values[i] = 0;
+        QVERIFY(engine.update(secs.constData(), values.constData(), 0, secs.count()));
+        QCOMPARE(engine.bests(), fresh(t, secs, values));
+
+        // a small edit near the end
+        values[secs.count()-100] += 5;
+        QVERIFY(engine.update(secs.constData(), values.constData(), 0, secs.count()));
+        QCOMPARE(engine.bests(), fresh(t, secs, values));
+    }
+
+    void localEditSearchesLess() {
+        QVector<double> secs, values;
+        makeRide(4*3600, secs, values);
+
+        MeanMaxEngine engine;
+        engine.update(secs.constData(), values.constData(), 0, secs.count());
+        int full = engine.searched();
+
+        // nudge a few samples down, away from the best efforts
+        for (int i=100; i<110; i++) values[i] -= 1;
+        engine.update(secs.constData(), values.constData(), 0, secs.count());
+        QVERIFY(engine.searched() < full);
+        QCOMPARE(engine.bests(), fresh(MeanMaxEngine::Plain, secs, values));
+    }
+
+    // a ride that grows only searches the new windows at the end
+    void growMatchesFullSearch() {
+        QVector<double> secs, values;
+        makeRide(3600, secs, values, 7);
+
+        MeanMaxEngine engine;
+        for (int n=600; n<=secs.count(); n+=600) {
+            QVERIFY(engine.update(secs.constData(), values.constData(), 0, n));
+            QCOMPARE(engine.bests(), fresh(MeanMaxEngine::Plain, secs.mid(0, n), values.mid(0, n)));
+        }
+    }
+
+    void appendMatchesFullSearch_data() {
+        QTest::addColumn<int>("type");
+        QTest::addColumn<int>("chunk");
+        QTest::addRow("plain by 1") << int(MeanMaxEngine::Plain) << 1;
+        QTest::addRow("plain by 97") << int(MeanMaxEngine::Plain) << 97;
+        QTest::addRow("vam by 13") << int(MeanMaxEngine::Vam) << 13;
+        QTest::addRow("xpower by 1") << int(MeanMaxEngine::XPower) << 1;
+        QTest::addRow("isopower by 7") << int(MeanMaxEngine::IsoPower) << 7;
+        QTest::addRow("perkg by 50") << int(MeanMaxEngine::PerKg) << 50;
+        QTest::addRow("delta by 11") << int(MeanMaxEngine::Delta) << 11;
+    }
+
+    // samples appended as they are recorded give the same bests as all of them at once
+    void appendMatchesFullSearch() {
+        QFETCH(int, type);
+        QFETCH(int, chunk);
+        MeanMaxEngine::transform t = static_cast<MeanMaxEngine::transform>(type);
+
+        QVector<double> secs, values;
+        makeRide(2400, secs, values, 11);
+
+        // a recording gap, a dropout and, for delta, going negative part way
+        for (int i=1200; i<secs.count(); i++) secs[i] += 20;
+        values[700] = std::numeric_limits<double>::quiet_NaN();
+        if (t == MeanMaxEngine::Delta) for (int i=1800; i<values.count(); i++) values[i] -= 400;
+
+        MeanMaxEngine engine(t, 1, 1, 75);
+        for (int n=0; n<secs.count(); n+=chunk) {
+            int m = qMin(chunk, secs.count() - n);
+            engine.append(secs.constData() + n, values.constData() + n, 0, m);
+            if (n % 600 < chunk || n + m == secs.count())
+                QCOMPARE(engine.bests(), fresh(t, secs.mid(0, n + m), values.mid(0, n + m)));
+        }
+    }
+
+    // only the windows ending in a new sample are scanned, not searched again
+    void appendSearchesNothing() {
+        QVector<double> secs, values;
+        makeRide(3600, secs, values);
+
+        MeanMaxEngine engine;
+        for (int i=0; i<secs.count(); i++) {
+            engine.append(secs.constData() + i, values.constData() + i, 0, 1);
+            QCOMPARE(engine.searched(), 0);
+        }
+
+        // an update starts again
+        QVERIFY(engine.update(secs.constData(), values.constData(), 0, 600));
+        QCOMPARE(engine.bests(), fresh(MeanMaxEngine::Plain, secs.mid(0, 600), values.mid(0, 600)));
+        QVERIFY(engine.searched() > 0);
+
+        // and so does an append after it
+        QVERIFY(engine.append(secs.constData(), values.constData(), 0, 300));
+        QCOMPARE(engine.bests(), fresh(MeanMaxEngine::Plain, secs.mid(0, 300), values.mid(0, 300)));
+    }
+
+    void benchmarkAppend() {
+        QVector<double> secs, values;
+        makeRide(4*3600, secs, values);
+
+        MeanMaxEngine engine;
+        engine.append(secs.constData(), values.constData(), 0, secs.count() - 1);
+
+        double next = secs.last();
+        QBENCHMARK {
+            engine.append(&next, values.constData(), 0, 1);
+            next++;
+        }
+    }
+
+    void negativeValues() {
+        QVector<double> secs, values;
+        makeRide(3600, secs, values, 3);
+        for (int i=0; i<values.count(); i++) values[i] -= 200;
+
+        MeanMaxEngine engine(MeanMaxEngine::Delta);
+        engine.update(secs.constData(), values.constData(), 0, secs.count());
+        values[1000] = 50;
+        engine.update(secs.constData(), values.constData(), 0, secs.count());
+        QCOMPARE(engine.bests(), fresh(MeanMaxEngine::Delta, secs, values));
+        QVERIFY(engine.bests().count() <= 180);
+    }
+
+    // nothing to search, and a single sample has no durations
+    void emptyAndOneSample() {
+        MeanMaxEngine engine;
+        QVERIFY(!engine.update(NULL, NULL, 0, 0));
+        QVERIFY(engine.bests().isEmpty());
+
+        double secs[] = { 0 }, values[] = { 250 };
+        QVERIFY(engine.update(secs, values, 0, 1));
+        QVERIFY(engine.bests().isEmpty());
+
+        // the second sample gives a 1s best, 0s is always 0
+        double two[] = { 0, 1 }, watts[] = { 250, 300 };
+        QVERIFY(engine.update(two, watts, 0, 2));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 300);
+    }
+
+    // 100,300,200 is 300 for 1s and (300+200)/2 for 2s, the whole 3s isn't searched
+    void knownSeries() {
+        double secs[] = { 0, 1, 2 }, values[] = { 100, 300, 200 };
+        MeanMaxEngine engine;
+        QVERIFY(engine.update(secs, values, 0, 3));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 300 << 250);
+
+        // edited down, 200 for 1s and (100+200)/2 for 2s
+        values[1] = 100;
+        QVERIFY(engine.update(secs, values, 0, 3));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 200 << 150);
+
+        // and back again
+        values[1] = 300;
+        QVERIFY(engine.update(secs, values, 0, 3));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 300 << 250);
+    }
+
+    // a recording gap of 2s is filled with zeros, 100,100,0,0,100
+    void gapIsZero() {
+        double secs[] = { 0, 1, 4 }, values[] = { 100, 100, 100 };
+        MeanMaxEngine engine;
+        QVERIFY(engine.update(secs, values, 0, 3));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 100 << 100 << float(200.0/3.0) << 50);
+    }
+
+    // a NaN sample counts as 0, 100,NaN,300 is 300 for 1s and 150 for 2s
+    void nanIsZero() {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        double secs[] = { 0, 1, 2 }, values[] = { 100, nan, 300 };
+        MeanMaxEngine engine;
+        QVERIFY(engine.update(secs, values, 0, 3));
+        QCOMPARE(engine.bests(), QVector<float>() << 0 << 300 << 150);
+    }
+
+    void benchmarkFullSearch() {
+        QVector<double> secs, values;
+        makeRide(12*3600, secs, values);
+
+        QBENCHMARK {
+            MeanMaxEngine engine;
+            engine.update(secs.constData(), values.constData(), 0, secs.count());
+        }
+    }
+
+    void benchmarkEdit() {
+        QVector<double> secs, values;
+        makeRide(12*3600, secs, values);
+
+        MeanMaxEngine engine;
+        engine.update(secs.constData(), values.constData(), 0, secs.count());
+
+        int n=0;
+        QBENCHMARK {
+            values[20000] += (n++ & 1) ? 1 : -1;
+            engine.update(secs.constData(), values.constData(), 0, secs.count());
+        }
+    }
+};
+
+
+QTEST_MAIN(TestMeanMaxEngine)
+#include "testMeanMaxEngine.moc"
@@ -0,0 +1,189 @@
+#include "FileIO/MeanMaxIndex.h"
+#include "FileIO/RideFileCache.h"
+#include "Core/RideItem.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+
+// aggregating needs an athlete and their .cpx files, only the spans are
+// tested; these are referenced by the rest of MeanMaxIndex.cpp
+double RideItem::getWeight(int) { return 0; }
+RideFileCache::RideFileCache(Context *) {}
+RideFileCache::RideFileCache(Context *, QString, double, RideFile *, bool, bool) {}
+void RideFileCache::resetAggregate() {}
+void RideFileCache::aggregate(RideFileCache &, QDate) {}
+void RideFileCache::aggregate(RideFileCache &) {}
+void RideFileCache::writeAggregate(QDataStream &) {}
+bool RideFileCache::readAggregate(QDataStream &) { return false; }
+
+
+// a ride's bests, by duration
+struct Ride {
+    QDate date;
+    QVector<double> bests;
+};
+
+// best for each duration and the earliest date it was done, as
+// RideFileCache::aggregate keeps them
+struct Bests {
+    QVector<double> values;
+    QVector<QDate> dates;
+
+    void add(int i, double value, QDate date) {
+        if (values.count() <= i) {
+            values.resize(i+1);
+            dates.resize(i+1);
+        }
+        if (!dates[i].isValid() || value > values[i] || (value == values[i] && date < dates[i])) {
+            values[i] = value;
+            dates[i] = date;
+        }
+    }
+    void add(const QVector<double> &v, QDate date) {
+        for (int i=0; i<v.count(); i++) add(i, v[i], date);
+    }
+    void add(const Bests &other) {
+        for (int i=0; i<other.values.count(); i++)
+            if (other.dates[i].isValid()) add(i, other.values[i], other.dates[i]);
+    }
+};
+
+class TestMeanMaxIndex: public QObject
+{
+    Q_OBJECT
+
+private:
+
+    // the last day of a span
+    static QDate end(const MeanMaxIndex::span &x) {
+        switch (x.type) {
+        case MeanMaxIndex::Year: return x.start.addYears(1).addDays(-1);
+        case MeanMaxIndex::Month: return x.start.addMonths(1).addDays(-1);
+        case MeanMaxIndex::Week: return x.start.addDays(6);
+        default: return x.start;
+        }
+    }
+
+    static QString describe(const QList<MeanMaxIndex::span> &spans) {
+        QStringList returning;
+        foreach(MeanMaxIndex::span x, spans) {
+            QString type = x.type == MeanMaxIndex::Year ? "Y" : x.type == MeanMaxIndex::Month ? "M" :
+                           x.type == MeanMaxIndex::Week ? "W" : "D";
+            returning << type + x.start.toString("yyyyMMdd");
+        }
+        return returning.join(" ");
+    }
+
+    // rides from..to with bests for up to 60s, a ride every other day or so
+    static QList<Ride> rides(QDate from, QDate to) {
+        QRandomGenerator random(42);
+        QList<Ride> returning;
+        for (QDate date=from; date<=to; date=date.addDays(1 + random.bounded(3))) {
+            int count = 1 + random.bounded(2);
+            for (int j=0; j<count; j++) {
+                Ride ride;
+                ride.date = date;
+                ride.bests.resize(1 + random.bounded(60));
+                double best = 300 + random.bounded(700);
+                for (int i=0; i<ride.bests.count(); i++) {
+                    ride.bests[i] = best;
+                    best = qMax(1.0, best - random.bounded(20)); // same power often ties
+                }
+                returning << ride;
+            }
+        }
+        return returning;
+    }
+
+    static Bests between(const QList<Ride> &rides, QDate from, QDate to) {
+        Bests returning;
+        foreach(const Ride &ride, rides)
+            if (ride.date >= from && ride.date <= to) returning.add(ride.bests, ride.date);
+        return returning;
+    }
+
+private slots:
+
+    void knownRanges_data() {
+        QTest::addColumn<QDate>("from");
+        QTest::addColumn<QDate>("to");
+        QTest::addColumn<QString>("spans");
+
+        QTest::newRow("year") << QDate(2026,1,1) << QDate(2026,12,31) << "Y20260101";
+        QTest::newRow("month") << QDate(2026,3,1) << QDate(2026,3,31) << "M20260301";
+        QTest::newRow("weeks") << QDate(2026,3,2) << QDate(2026,3,15) << "W20260302 W20260309";
+        QTest::newRow("days either side") << QDate(2026,2,25) << QDate(2026,4,3)
+                                          << "D20260225 D20260226 D20260227 D20260228 M20260301 D20260401 D20260402 D20260403";
+
+        // a week into July is only used when July isn't used whole
+        QTest::newRow("week into month") << QDate(2026,6,29) << QDate(2026,7,12) << "W20260629 W20260706";
+        QTest::newRow("month not week") << QDate(2026,6,29) << QDate(2026,7,31) << "D20260629 D20260630 M20260701";
+
+        QTest::newRow("over new year") << QDate(2025,12,1) << QDate(2027,1,31) << "M20251201 Y20260101 M20270101";
+        QTest::newRow("one day") << QDate(2026,5,13) << QDate(2026,5,13) << "D20260513";
+        QTest::newRow("backwards") << QDate(2026,5,13) << QDate(2026,5,12) << "";
+    }
+
+    void knownRanges() {
+        QFETCH(QDate, from);
+        QFETCH(QDate, to);
+        QFETCH(QString, spans);
+        QCOMPARE(describe(MeanMaxIndex::spans(from, to)), spans);
+    }
+
+    // every day once, in order, blocks on their boundaries
+    void spansCoverRange() {
+        QRandomGenerator random(7);
+        QDate base(2024,1,1);
+        for (int t=0; t<2000; t++) {
+            QDate from = base.addDays(random.bounded(1200));
+            QDate to = from.addDays(random.bounded(800));
+
+            QDate next = from;
+            foreach(MeanMaxIndex::span x, MeanMaxIndex::spans(from, to)) {
+                QCOMPARE(x.start, next);
+                QVERIFY(end(x) <= to);
+                if (x.type == MeanMaxIndex::Year) QCOMPARE(x.start.dayOfYear(), 1);
+                if (x.type == MeanMaxIndex::Month) QCOMPARE(x.start.day(), 1);
+                if (x.type == MeanMaxIndex::Week) QCOMPARE(x.start.dayOfWeek(), 1);
+                next = end(x).addDays(1);
+            }
+            QCOMPARE(next, to.addDays(1));
+        }
+    }
+
+    // rolling up the rides through the spans, years from their months as
+    // MeanMaxIndex::block does, is the same as aggregating every ride
+    void rollUpMatchesBruteForce() {
+        QList<Ride> all = rides(QDate(2024,1,1), QDate(2027,12,31));
+
+        QRandomGenerator random(11);
+        for (int t=0; t<300; t++) {
+            QDate from = QDate(2024,1,1).addDays(random.bounded(1000));
+            QDate to = from.addDays(random.bounded(from.daysTo(QDate(2027,12,31)) + 1));
+
+            Bests rolled;
+            foreach(MeanMaxIndex::span x, MeanMaxIndex::spans(from, to)) {
+                if (x.type == MeanMaxIndex::Year) {
+                    Bests year;
+                    for (int month=1; month<=12; month++) {
+                        QDate start(x.start.year(), month, 1);
+                        year.add(between(all, start, start.addMonths(1).addDays(-1)));
+                    }
+                    rolled.add(year);
+                } else {
+                    rolled.add(between(all, x.start, end(x)));
+                }
+            }
+
+            Bests brute = between(all, from, to);
+            QCOMPARE(rolled.values, brute.values);
+            QCOMPARE(rolled.dates, brute.dates);
+        }
+    }
+};
+
+
+QTEST_MAIN(TestMeanMaxIndex)
+#include "testMeanMaxIndex.moc"
@@ -0,0 +1,186 @@
+#include "FileIO/RideFile.h"
+#include "Core/Athlete.h"
+#include "Core/Context.h"
+#include "Core/Settings.h"
+#include "Core/Units.h"
+#include "FileIO/FilterHRV.h"
+#include "Gui/Colors.h"
+#include "Metrics/WPrime.h"
+#include "Metrics/Zones.h"
+#include "Core/Specification.h"
+
+#include <QTest>
+
+
+// the rest of the tree RideFile.cpp refers to, none of it is
+// reached by appending, editing and deleting samples
+GSettings *appsettings = NULL;
+QVariant GSettings::value(const QObject *, const QString, const QVariant def) { return def; }
+QVariant GSettings::cvalue(QString, QString, QVariant def) { return def; }
+GlobalContext *GlobalContext::context() { return NULL; }
+QColor GCColor::getColor(int) { return QColor(); }
+QString kphToPace(double, bool, bool) { return QString(); }
+void FilterHrv(XDataSeries *, double, double, double, int) {}
+double Athlete::getWeight(QDate, RideFile *) { return 0; }
+double Athlete::getHeight(RideFile *) { return 0; }
+int Zones::whichRange(const QDate &) const { return -1; }
+int Zones::getCP(int) const { return 0; }
+WPrime::WPrime() {}
+void WPrime::setRide(RideFile *) {}
+DateRange::DateRange(QDate, QDate, QString, QColor) : valid(false) {}
+DateRange::DateRange(const DateRange &) : valid(false) {}
+DateRange &DateRange::operator=(const DateRange &) { return *this; }
+PlanFilter::PlanFilter(PlanFilterType) {}
+Specification::Specification() : it(NULL), recintsecs(0), ri(NULL) {}
+double Specification::secsStart() const { return -1; }
+double Specification::secsEnd() const { return -1; }
+
+// 1s samples with power and heartrate
+static void makeRide(RideFile &ride, int count)
+{
+    for (int i=0; i<count; i++) {
+        RideFilePoint p;
+        p.secs = i;
+        p.watts = 100 + i;
+        p.hr = 120;
+        ride.appendPoint(p);
+    }
+}
+
+class TestRideFileColumns: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void builtOnlyAsAsked() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFileColumnsPtr columns = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        QCOMPARE(columns->count(), 10);
+        QVERIFY(columns->isPresent(RideFile::watts));
+        QCOMPARE(columns->value(3, RideFile::watts), 103.0);
+
+        // not asked for, and not present, so nothing is held
+        QVERIFY(!columns->isPresent(RideFile::hr));
+        QVERIFY(!columns->isPresent(RideFile::cad));
+
+        // not present even when asked for
+        columns = ride.columns();
+        QVERIFY(columns->isPresent(RideFile::hr));
+        QVERIFY(!columns->isPresent(RideFile::cad));
+        QCOMPARE(columns->value(3, RideFile::cad), 0.0);
+    }
+
+    void freedWithTheLastReader() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFileColumnsPtr columns = ride.columns();
+        QWeakPointer<const RideFileColumns> held = columns;
+
+        // shared while read, the ride doesn't keep it
+        QCOMPARE(ride.columns().data(), columns.data());
+        columns.clear();
+        QVERIFY(held.isNull());
+    }
+
+    void keptWhileScoped() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        QWeakPointer<const RideFileColumns> held;
+        {
+            RideFile::ColumnsScope scope(&ride);
+            held = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+
+            // one reader after another get the same columns
+            QVERIFY(!held.isNull());
+            QCOMPARE(ride.columns(QList<RideFile::SeriesType>() << RideFile::watts).data(), held.data());
+        }
+        QVERIFY(held.isNull());
+    }
+
+    void setPointValue() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFileColumnsPtr before = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        ride.setPointValue(3, RideFile::watts, 500);
+        RideFileColumnsPtr after = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+
+        // a new snapshot, the one handed out is never changed
+        QVERIFY(after != before);
+        QCOMPARE(after->value(3, RideFile::watts), 500.0);
+        QCOMPARE(before->value(3, RideFile::watts), 103.0);
+    }
+
+    // a point changed while the columns are scoped still
+    // drops them, and a bulk set drops them once
+    void setPointValues() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFile::ColumnsScope scope(&ride);
+        RideFileColumnsPtr before = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        ride.setPointValue(1, RideFile::watts, 7);
+        RideFileColumnsPtr after = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        QVERIFY(after != before);
+        QCOMPARE(after->value(1, RideFile::watts), 7.0);
+
+        ride.setPointValues(RideFile::watts, QVector<int>() << 2 << 4, QVector<double>() << 20 << 40);
+        RideFileColumnsPtr set = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        QVERIFY(set != after);
+        QCOMPARE(set->value(1, RideFile::watts), 7.0);
+        QCOMPARE(set->value(2, RideFile::watts), 20.0);
+        QCOMPARE(set->value(4, RideFile::watts), 40.0);
+        QCOMPARE(after->value(2, RideFile::watts), 102.0);
+    }
+
+    void deletePoints() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFileColumnsPtr before = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        ride.deletePoints(2, 3);
+        RideFileColumnsPtr after = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+
+        QCOMPARE(before->count(), 10);
+        QCOMPARE(after->count(), 7);
+        QCOMPARE(after->value(2, RideFile::watts), 105.0);
+
+        // and by rows
+        ride.deletePoints(QVector<int>() << 0 << 6);
+        after = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        QCOMPARE(after->count(), 5);
+        QCOMPARE(after->value(0, RideFile::watts), 101.0);
+    }
+
+    void appendPoints() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 10);
+
+        RideFileColumnsPtr before = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+        RideFilePoint *add = new RideFilePoint();
+        add->secs = 10;
+        add->watts = 999;
+        ride.appendPoints(QVector<RideFilePoint*>() << add);
+        RideFileColumnsPtr after = ride.columns(QList<RideFile::SeriesType>() << RideFile::watts);
+
+        QCOMPARE(before->count(), 10);
+        QCOMPARE(after->count(), 11);
+        QCOMPARE(after->value(10, RideFile::watts), 999.0);
+
+        // as the train view and importers append them
+        RideFilePoint p;
+        p.secs = 11;
+        p.watts = 42;
+        ride.appendPoint(p);
+        QCOMPARE(ride.columns(QList<RideFile::SeriesType>() << RideFile::watts)->value(11, RideFile::watts), 42.0);
+    }
+};
+
+
+QTEST_MAIN(TestRideFileColumns)
+#include "testRideFileColumns.moc"
@@ -0,0 +1,5 @@
+QT += testlib core
+
+SOURCES = testRideFileRows.cpp
+
+include(../../unittests.pri)
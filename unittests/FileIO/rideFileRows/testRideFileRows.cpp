@@ -0,0 +1,171 @@
+#include "FileIO/RideFileRows.h"
+
+#include <QTest>
+#include <QVector>
+
+
+// rows as FixGaps builds them, each gap filled at 1s up to the next sample
+static void fillGaps(const QVector<double> &secs, QVector<int> &rows, QVector<double> &adds)
+{
+    for (int position=1; position<secs.count(); position++) {
+        int count = secs[position] - secs[position-1] - 1;
+        for (int i=0; i<count; i++) {
+            rows << position + adds.count();
+            adds << secs[position-1] + i + 1;
+        }
+    }
+}
+
+// as SetPointValuesCommand does and undoes
+static void apply(QVector<double> &series, const QVector<int> &rows, const QVector<double> &values)
+{
+    for (int i=0; i<rows.count(); i++) series[rows[i]] = values[i];
+}
+
+class TestRideFileRows: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void valid() {
+        QVERIFY(RideFileRows::valid(QVector<int>(), 0));
+        QVERIFY(RideFileRows::valid(QVector<int>() << 0 << 1 << 2, 3));
+        QVERIFY(RideFileRows::valid(QVector<int>() << 2, 3));
+
+        // past the end, negative, duplicate and out of order
+        QVERIFY(!RideFileRows::valid(QVector<int>() << 3, 3));
+        QVERIFY(!RideFileRows::valid(QVector<int>() << 0, 0));
+        QVERIFY(!RideFileRows::valid(QVector<int>() << -1, 3));
+        QVERIFY(!RideFileRows::valid(QVector<int>() << 1 << 1, 3));
+        QVERIFY(!RideFileRows::valid(QVector<int>() << 2 << 1, 3));
+    }
+
+    void insert() {
+        QVector<int> into = QVector<int>() << 10 << 20 << 30;
+        QVERIFY(RideFileRows::insert(into, QVector<int>() << 0 << 2 << 5, QVector<int>() << 1 << 2 << 3));
+        QCOMPARE(into, QVector<int>() << 1 << 10 << 2 << 20 << 30 << 3);
+
+        // into nothing, and nothing into something
+        QVector<int> empty;
+        QVERIFY(RideFileRows::insert(empty, QVector<int>() << 0 << 1, QVector<int>() << 7 << 8));
+        QCOMPARE(empty, QVector<int>() << 7 << 8);
+        QVERIFY(RideFileRows::insert(empty, QVector<int>(), QVector<int>()));
+        QCOMPARE(empty, QVector<int>() << 7 << 8);
+    }
+
+    void insertRejected() {
+        const QVector<int> before = QVector<int>() << 10 << 20;
+        QVector<int> into = before;
+
+        // past the end, there would only be 3 rows
+        QVERIFY(!RideFileRows::insert(into, QVector<int>() << 3, QVector<int>() << 1));
+
+        // duplicates and out of order
+        QVERIFY(!RideFileRows::insert(into, QVector<int>() << 1 << 1, QVector<int>() << 1 << 2));
+        QVERIFY(!RideFileRows::insert(into, QVector<int>() << 2 << 0, QVector<int>() << 1 << 2));
+
+        // a row for each item
+        QVERIFY(!RideFileRows::insert(into, QVector<int>() << 0, QVector<int>() << 1 << 2));
+        QCOMPARE(into, before);
+    }
+
+    void remove() {
+        QVector<int> from = QVector<int>() << 1 << 10 << 2 << 20 << 30 << 3;
+        QVector<int> removed;
+        QVERIFY(RideFileRows::remove(from, QVector<int>() << 0 << 2 << 5, removed));
+        QCOMPARE(from, QVector<int>() << 10 << 20 << 30);
+        QCOMPARE(removed, QVector<int>() << 1 << 2 << 3);
+
+        // all of them
+        QVERIFY(RideFileRows::remove(from, QVector<int>() << 0 << 1 << 2, removed));
+        QVERIFY(from.isEmpty());
+        QCOMPARE(removed, QVector<int>() << 10 << 20 << 30);
+    }
+
+    void removeRejected() {
+        QVector<int> from = QVector<int>() << 10 << 20;
+        QVector<int> removed;
+        QVERIFY(!RideFileRows::remove(from, QVector<int>() << 2, removed));
+        QVERIFY(!RideFileRows::remove(from, QVector<int>() << 0 << 0, removed));
+        QVERIFY(!RideFileRows::remove(from, QVector<int>() << 1 << 0, removed));
+        QCOMPARE(from, QVector<int>() << 10 << 20);
+    }
+
+    // 0,1,2,6,7,10 has 3,4,5 and 8,9 missing
+    void fixGapsUndoRedo() {
+        const QVector<double> ride = QVector<double>() << 0 << 1 << 2 << 6 << 7 << 10;
+        QVector<int> rows;
+        QVector<double> adds;
+        fillGaps(ride, rows, adds);
+        QCOMPARE(rows, QVector<int>() << 3 << 4 << 5 << 8 << 9);
+        QCOMPARE(adds, QVector<double>() << 3 << 4 << 5 << 8 << 9);
+
+        QVector<double> filled;
+        for (int i=0; i<=10; i++) filled << i;
+
+        QVector<double> secs = ride, removed;
+        for (int redo=0; redo<2; redo++) {
+            QVERIFY(RideFileRows::insert(secs, rows, adds));
+            QCOMPARE(secs, filled);
+
+            QVERIFY(RideFileRows::remove(secs, rows, removed));
+            QCOMPARE(secs, ride);
+            QCOMPARE(removed, adds);
+        }
+    }
+
+    // a ride with no gaps has nothing to insert
+    void fixGapsNone() {
+        QVector<int> rows;
+        QVector<double> adds;
+        fillGaps(QVector<double>() << 0 << 1 << 2, rows, adds);
+        QVERIFY(rows.isEmpty());
+        fillGaps(QVector<double>() << 5, rows, adds);
+        QVERIFY(rows.isEmpty());
+    }
+
+    // the spike at 900 is replaced by the mean of its neighbours
+    void fixSpikesUndoRedo() {
+        const QVector<double> power = QVector<double>() << 100 << 105 << 900 << 110 << 0 << 108;
+        const QVector<double> fixed = QVector<double>() << 100 << 105 << 107.5 << 110 << 0 << 108;
+
+        QVector<int> rows;
+        QVector<double> oldvalues, newvalues;
+        RideFileRows::changes(0, fixed, [&power](int row) { return power[row]; }, rows, oldvalues, newvalues);
+        QCOMPARE(rows, QVector<int>() << 2);
+        QCOMPARE(oldvalues, QVector<double>() << 900);
+        QCOMPARE(newvalues, QVector<double>() << 107.5);
+
+        QVector<double> series = power;
+        for (int redo=0; redo<2; redo++) {
+            apply(series, rows, newvalues);
+            QCOMPARE(series, fixed);
+            apply(series, rows, oldvalues);
+            QCOMPARE(series, power);
+        }
+    }
+
+    // from an index, and nothing when nothing changes
+    void changes() {
+        const QVector<double> power = QVector<double>() << 100 << 105 << 900 << 110;
+        auto current = [&power](int row) { return power[row]; };
+
+        QVector<int> rows;
+        QVector<double> oldvalues, newvalues;
+        RideFileRows::changes(2, QVector<double>() << 900 << 111, current, rows, oldvalues, newvalues);
+        QCOMPARE(rows, QVector<int>() << 3);
+        QCOMPARE(oldvalues, QVector<double>() << 110);
+        QCOMPARE(newvalues, QVector<double>() << 111);
+
+        rows.clear();
+        RideFileRows::changes(0, power, current, rows, oldvalues, newvalues);
+        QVERIFY(rows.isEmpty());
+        RideFileRows::changes(0, QVector<double>(), current, rows, oldvalues, newvalues);
+        QVERIFY(rows.isEmpty());
+    }
+};
+
+
+QTEST_MAIN(TestRideFileRows)
+#include "testRideFileRows.moc"
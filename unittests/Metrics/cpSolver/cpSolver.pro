@@ -0,0 +1,9 @@
+QT += testlib core
+
+INCLUDEPATH += ../../../src/Core
+
+SOURCES = testCPSolver.cpp \
+          ../../../src/Metrics/CPSolverChain.cpp \
+          ../../../src/Core/TaskScheduler.cpp
+
+include(../../unittests.pri)
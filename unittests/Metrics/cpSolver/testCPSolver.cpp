@@ -0,0 +1,179 @@
+#include "Metrics/CPSolverChain.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+#include <cmath>
+
+
+// as CPSolver always did, an exp() for each sample
+static double perSample(const QVector<int> &ride, WBParms parms)
+{
+    double I=0.00f;
+    int t=0;
+    double wpbal=parms.W;
+    foreach(int watts, ride) {
+        I += exp(((double)(t) / parms.TAU)) * (watts > parms.CP ? watts-parms.CP : 0);
+        wpbal = parms.W - (exp(-((double)(t) / parms.TAU)) * I);
+        t++;
+    }
+    return wpbal - 500;
+}
+
+// a fixed season of exhaustion points, 20 efforts of 20 to 60 minutes
+static void season(CPSolverSeries &series)
+{
+    QRandomGenerator random(42);
+    for (int i=0; i<20; i++) {
+        QVector<int> watts(1200 + random.bounded(2400));
+        int level = 200;
+        for (int j=0; j<watts.count(); j++) {
+            if (j % 120 == 0) level = 150 + random.bounded(250);
+            watts[j] = level + random.bounded(40) - 20;
+        }
+        series.add(watts);
+    }
+}
+
+class TestCPSolver: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void integralMatchesPerSample() {
+        QRandomGenerator random(7);
+        CPSolverConstraints constraints;
+        CPSolverSeries series;
+        series.prepare(constraints.tf, constraints.tto);
+
+        foreach (int count, QList<int>() << 0 << 1 << 255 << 256 << 257 << 3600 << 10001) {
+            QVector<int> watts(count);
+            for (int i=0; i<count; i++) watts[i] = random.bounded(600);
+
+            // tabled, and worked out for a tau outside the tables
+            foreach (double tau, QList<double>() << 300 << 457 << 700 << 250.5 << 900) {
+                WBParms parms(250, 20000, tau);
+                QVERIFY(fabs(series.compute(watts, parms) - perSample(watts, parms)) < 1e-6);
+            }
+        }
+    }
+
+    // W'bal is what's left of W' less the 500 we solve for
+    void emptyAndOneSample_data() {
+        QTest::addColumn<bool>("integral");
+        QTest::addRow("integral") << true;
+        QTest::addRow("differential") << false;
+    }
+
+    void emptyAndOneSample() {
+        QFETCH(bool, integral);
+        CPSolverSeries series;
+        series.setIntegral(integral);
+        series.prepare(300, 700);
+        WBParms parms(250, 20000, 300);
+
+        QCOMPARE(series.compute(QVector<int>(), parms), 19500.0);
+
+        // at or below CP nothing is used, W' is already full
+        QCOMPARE(series.compute(QVector<int>() << 250, parms), 19500.0);
+        QCOMPARE(series.compute(QVector<int>() << 100, parms), 19500.0);
+
+        // 100 over CP for a second
+        QCOMPARE(series.compute(QVector<int>() << 350, parms), 19400.0);
+
+        // and the cost of that one series, 19400^2 / 1000
+        series.add(QVector<int>() << 350);
+        QCOMPARE(series.cost(parms), 376360.0);
+    }
+
+    // the excess a second before the end has decayed by exp(-1/tau),
+    // 256 seconds before is the first sample of the block before
+    void decayAcrossBlocks() {
+        CPSolverSeries series;
+        series.prepare(300, 700);
+
+        foreach (double tau, QList<double>() << 300 << 700 << 250.5) {
+            WBParms parms(250, 20000, tau);
+
+            QVector<int> watts = QVector<int>() << 350 << 350;
+            QVERIFY(fabs(series.compute(watts, parms) - (19400 - 100 * exp(-1 / tau))) < 1e-9);
+
+            foreach (int count, QList<int>() << 256 << 257 << 513) {
+                watts = QVector<int>(count, 200);
+                watts[0] = 350;
+                double expected = 19500 - 100 * exp(-(count - 1) / tau);
+                QVERIFY(fabs(series.compute(watts, parms) - expected) < 1e-9);
+            }
+        }
+    }
+
+    // bounds the wrong way round are swapped
+    void constraintsSwapped() {
+        CPSolverConstraints constraints(500, 100, 50000, 5000, 700, 300);
+        QCOMPARE(constraints.cpf, 100);
+        QCOMPARE(constraints.cpto, 500);
+        QCOMPARE(constraints.wf, 5000);
+        QCOMPARE(constraints.wto, 50000);
+        QCOMPARE(constraints.tf, 300);
+        QCOMPARE(constraints.tto, 700);
+    }
+
+    void searchKeepsBest_data() {
+        QTest::addColumn<int>("chains");
+        QTest::addRow("single") << 1;
+        QTest::addRow("parallel") << 4;
+    }
+
+    void searchKeepsBest() {
+        QFETCH(int, chains);
+
+        CPSolverConstraints constraints;
+        CPSolverSeries series;
+        season(series);
+        series.prepare(constraints.tf, constraints.tto);
+
+        double start = series.cost(WBParms(constraints.cpto, constraints.wto, constraints.tto));
+        CPSolverSearch search(&series, constraints, chains, 20000, 1);
+        QCOMPARE(search.list().count(), chains);
+
+        int epochs = 0;
+        while (search.step()) epochs++;
+        QCOMPARE(search.iterations(), 20000);
+        QCOMPARE(epochs, (20000 / chains + CPSolverSearch::Epoch - 1) / CPSolverSearch::Epoch);
+
+        WBParms best = search.best();
+        QVERIFY(search.bestCost() <= start);
+        QCOMPARE(search.bestCost(), series.cost(best));
+        QVERIFY(best.CP >= constraints.cpf && best.CP <= constraints.cpto);
+        QVERIFY(best.W >= constraints.wf && best.W <= constraints.wto);
+        QVERIFY(best.TAU >= constraints.tf && best.TAU <= constraints.tto);
+        foreach (CPSolverChain *chain, search.list()) QVERIFY(chain->Ebest >= search.bestCost());
+    }
+
+    void benchmarkCost() {
+        CPSolverConstraints constraints;
+        CPSolverSeries series;
+        season(series);
+        series.prepare(constraints.tf, constraints.tto);
+
+        QBENCHMARK {
+            series.cost(WBParms(250, 20000, 400));
+        }
+    }
+
+    void benchmarkSolve() {
+        CPSolverConstraints constraints;
+        CPSolverSeries series;
+        season(series);
+        series.prepare(constraints.tf, constraints.tto);
+
+        QBENCHMARK {
+            CPSolverSearch search(&series, constraints, 0, 100000, 1);
+            while (search.step()) ;
+        }
+    }
+};
+
+QTEST_MAIN(TestCPSolver)
+#include "testCPSolver.moc"
@@ -0,0 +1,161 @@
+#include "Metrics/Estimator.h"
+
+#include <QTest>
+
+
+typedef QMap<QDate, Estimator::Week> Weeks;
+
+// weeks as the last run left them, fitted with complete bests
+static Weeks fitted(QDate monday, int count)
+{
+    Weeks returning;
+    for (int i=0; i<count; i++) {
+        Estimator::Week week;
+        week.signature = i+1;
+        week.fitted = true;
+        week.complete = true;
+        returning.insert(monday.addDays(7*i), week);
+    }
+    return returning;
+}
+
+// the weeks for this run as Estimator::run reads them, given the signature
+// of the rides in each week now; returns the weeks that were read again
+static QList<QDate> read(const Weeks &previous, const QMap<QDate, quint64> &signatures, Weeks &weeks)
+{
+    QList<QDate> changed;
+    QMapIterator<QDate, quint64> it(signatures);
+    while (it.hasNext()) {
+        it.next();
+        Estimator::Week week = previous.value(it.key());
+        if (Estimator::reread(previous, it.key(), it.value())) {
+            week = Estimator::Week();
+            week.signature = it.value();
+            week.complete = true;
+            changed << it.key();
+        }
+        weeks.insert(it.key(), week);
+    }
+    return changed;
+}
+
+static QMap<QDate, quint64> signatures(const Weeks &weeks)
+{
+    QMap<QDate, quint64> returning;
+    QMapIterator<QDate, Estimator::Week> it(weeks);
+    while (it.hasNext()) {
+        it.next();
+        returning.insert(it.key(), it.value().signature);
+    }
+    return returning;
+}
+
+static QVector<QDate> mondays(QDate monday, int from, int to)
+{
+    QVector<QDate> returning;
+    for (int i=from; i<=to; i++) returning << monday.addDays(7*i);
+    return returning;
+}
+
+class TestEstimatorWeeks: public QObject
+{
+    Q_OBJECT
+
+private:
+    const QDate monday = QDate(2026,3,2);
+
+private slots:
+
+    void firstRun() {
+        Weeks weeks;
+        QList<QDate> changed = read(Weeks(), signatures(fitted(monday, 10)), weeks);
+        QCOMPARE(changed.count(), 10);
+        QCOMPARE(Estimator::refits(Weeks(), weeks, changed), mondays(monday, 0, 9));
+    }
+
+    void nothingChanged() {
+        Weeks previous = fitted(monday, 10);
+        Weeks weeks;
+        QList<QDate> changed = read(previous, signatures(previous), weeks);
+        QVERIFY(changed.isEmpty());
+        QVERIFY(Estimator::refits(previous, weeks, changed).isEmpty());
+    }
+
+    // a ride changing changes its week's signature, that week is read
+    // again and it and the next five weeks are fitted again
+    void rideChanged_data() {
+        QTest::addColumn<int>("week");
+        QTest::addColumn<int>("last");
+
+        QTest::newRow("first") << 0 << 5;
+        QTest::newRow("middle") << 3 << 8;
+        QTest::newRow("near the end") << 7 << 9;
+        QTest::newRow("last") << 9 << 9;
+    }
+
+    void rideChanged() {
+        QFETCH(int, week);
+        QFETCH(int, last);
+
+        Weeks previous = fitted(monday, 10);
+        QMap<QDate, quint64> now = signatures(previous);
+        now[monday.addDays(7*week)] = 99;
+
+        Weeks weeks;
+        QList<QDate> changed = read(previous, now, weeks);
+        QCOMPARE(changed, QList<QDate>() << monday.addDays(7*week));
+        QCOMPARE(weeks[monday.addDays(7*week)].signature, quint64(99));
+        QCOMPARE(Estimator::refits(previous, weeks, changed), mondays(monday, week, last));
+    }
+
+    // a new ride in a week after the last one with power
+    void weekAdded() {
+        Weeks previous = fitted(monday, 10);
+        QMap<QDate, quint64> now = signatures(fitted(monday, 11));
+
+        Weeks weeks;
+        QList<QDate> changed = read(previous, now, weeks);
+        QCOMPARE(changed, QList<QDate>() << monday.addDays(70));
+        QCOMPARE(Estimator::refits(previous, weeks, changed), mondays(monday, 10, 10));
+    }
+
+    // the first ride with power was deleted, the weeks that had it
+    // in their six weeks are fitted again
+    void weekGone() {
+        Weeks previous = fitted(monday, 10);
+        QMap<QDate, quint64> now = signatures(previous);
+        now.remove(monday);
+
+        Weeks weeks;
+        QList<QDate> changed = read(previous, now, weeks);
+        QVERIFY(changed.isEmpty());
+        QCOMPARE(Estimator::refits(previous, weeks, changed), mondays(monday, 1, 5));
+    }
+
+    // bests that were missing rides are read again even when
+    // the rides are the same
+    void incompleteReadAgain() {
+        Weeks previous = fitted(monday, 10);
+        previous[monday.addDays(14)].complete = false;
+
+        Weeks weeks;
+        QList<QDate> changed = read(previous, signatures(previous), weeks);
+        QCOMPARE(changed, QList<QDate>() << monday.addDays(14));
+        QCOMPARE(Estimator::refits(previous, weeks, changed), mondays(monday, 2, 7));
+    }
+
+    // fitted with incomplete bests last time, fitted again on its own
+    void unfittedFitAgain() {
+        Weeks previous = fitted(monday, 10);
+        previous[monday.addDays(28)].fitted = false;
+
+        Weeks weeks;
+        QList<QDate> changed = read(previous, signatures(previous), weeks);
+        QVERIFY(changed.isEmpty());
+        QCOMPARE(Estimator::refits(previous, weeks, changed), mondays(monday, 4, 4));
+    }
+};
+
+
+QTEST_MAIN(TestEstimatorWeeks)
+#include "testEstimatorWeeks.moc"
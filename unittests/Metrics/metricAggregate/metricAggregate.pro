@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testMetricAggregate.cpp \
+          ../../../src/Metrics/MetricAggregate.cpp
+
+include(../../unittests.pri)
@@ -0,0 +1,279 @@
+#include "Metrics/MetricAggregate.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <limits>
+
+
+// as RideCache::getAggregate always did, ride by ride
+static double perRide(int type, const QVector<double> &values, const QVector<double> &counts, bool aggZero)
+{
+    double rvalue = 0;
+    double rcount = 0;
+
+    for (int i=0; i<values.count(); i++) {
+        double value = values[i];
+        double count = counts[i];
+
+        switch (type) {
+        case MetricAggregate::RunningTotal:
+        case MetricAggregate::Total:
+            rvalue += value;
+            break;
+        default:
+        case MetricAggregate::Average:
+            if (value || aggZero) {
+                rvalue += value*count;
+                rcount += count;
+            }
+            break;
+        case MetricAggregate::Low:
+            if (value < rvalue) rvalue = value;
+            break;
+        case MetricAggregate::Peak:
+            if (value > rvalue) rvalue = value;
+            break;
+        case MetricAggregate::MeanSquareRoot:
+            rvalue = sqrt((pow(rvalue, 2)*rcount + pow(value,2)*count)/(rcount + count));
+            rcount += count;
+            break;
+        }
+    }
+    if (type == MetricAggregate::Average && rcount) rvalue = rvalue / rcount;
+    return rvalue;
+}
+
+// a season of rides, some with zero values, a few rides each day
+static void season(int n, QVector<double> &values, QVector<double> &counts, QVector<double> &means, QVector<int> &groups)
+{
+    QRandomGenerator random(42);
+    values.resize(n);
+    counts.resize(n);
+    means.resize(n);
+    groups.resize(n);
+
+    int day = 1;
+    for (int i=0; i<n; i++) {
+        values[i] = random.bounded(5) ? random.bounded(400.0) - 50 : 0;
+        counts[i] = 1 + random.bounded(7200);
+        means[i] = random.bounded(300.0);
+        if (random.bounded(3) == 0) day += 1 + random.bounded(3);
+        groups[i] = day;
+    }
+}
+
+static bool same(double a, double b)
+{
+    return fabs(a - b) <= 1e-9 * qMax(1.0, fabs(b));
+}
+
+class TestMetricAggregate: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void aggregateMatchesPerRide_data() {
+        QTest::addColumn<int>("type");
+        QTest::addRow("total") << int(MetricAggregate::Total);
+        QTest::addRow("average") << int(MetricAggregate::Average);
+        QTest::addRow("peak") << int(MetricAggregate::Peak);
+        QTest::addRow("low") << int(MetricAggregate::Low);
+        QTest::addRow("runningtotal") << int(MetricAggregate::RunningTotal);
+        QTest::addRow("meansquareroot") << int(MetricAggregate::MeanSquareRoot);
+    }
+
+    void aggregateMatchesPerRide() {
+        QFETCH(int, type);
+
+        foreach (int n, QList<int>() << 0 << 1 << 2 << 3 << 5 << 1000) {
+            QVector<double> values, counts, means;
+            QVector<int> groups;
+            season(n, values, counts, means, groups);
+
+            foreach (bool aggZero, QList<bool>() << false << true) {
+                double expect = perRide(type, values, counts, aggZero);
+                double got = MetricAggregate::aggregate(type, values.constData(), counts.constData(), n, aggZero);
+                QVERIFY2(same(got, expect), qPrintable(QString("n=%1 %2 != %3").arg(n).arg(got).arg(expect)));
+            }
+        }
+    }
+
+    void zeroCountLeftOut() {
+        // average_temp gives missing temperatures no weight
+        QVector<double> values = QVector<double>() << 20 << 0 << 10;
+        QVector<double> counts = QVector<double>() << 1 << 0 << 1;
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Average, values.constData(), counts.constData(), 3, true), 15.0);
+    }
+
+    // nothing is 0 whatever the type, and there are no groups
+    void empty() {
+        foreach (int type, QList<int>() << MetricAggregate::Total << MetricAggregate::Average << MetricAggregate::Peak
+                                        << MetricAggregate::Low << MetricAggregate::RunningTotal << MetricAggregate::MeanSquareRoot) {
+            QCOMPARE(MetricAggregate::aggregate(type, NULL, NULL, 0, true), 0.0);
+
+            QVector<int> keys = QVector<int>() << 1;
+            QVector<double> results = QVector<double>() << 1;
+            MetricAggregate::grouped(type, NULL, NULL, NULL, NULL, 0, true, keys, results);
+            QVERIFY(keys.isEmpty());
+            QVERIFY(results.isEmpty());
+        }
+    }
+
+    // Peak and Low start from 0, so a single -5 peaks at 0
+    void oneValue() {
+        double value = -5, count = 10;
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Total, &value, &count, 1, false), -5.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Average, &value, &count, 1, false), -5.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Peak, &value, &count, 1, false), 0.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Low, &value, &count, 1, false), -5.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::MeanSquareRoot, &value, &count, 1, false), 5.0);
+
+        // a lone zero has no weight unless aggregating zeroes, either way it's 0
+        value = 0;
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Average, &value, &count, 1, false), 0.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Average, &value, &count, 1, true), 0.0);
+    }
+
+    // an hour at 100 and 20 minutes at 200 is (360000+240000)/4800
+    void averageIsWeighted() {
+        QVector<double> values = QVector<double>() << 100 << 200;
+        QVector<double> counts = QVector<double>() << 3600 << 1200;
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Average, values.constData(), counts.constData(), 2, false), 125.0);
+
+        QVector<int> groups = QVector<int>() << 7 << 7;
+        QVector<int> keys;
+        QVector<double> results;
+        MetricAggregate::grouped(MetricAggregate::Average, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), 2, false, keys, results);
+        QCOMPARE(results, QVector<double>() << 125);
+    }
+
+    // 3 and 4 for a second each is sqrt((9+16)/2), grouped or not
+    void meanSquareRoot() {
+        QVector<double> values = QVector<double>() << 3 << 4;
+        QVector<double> counts = QVector<double>() << 1 << 1;
+        QVector<int> groups = QVector<int>() << 1 << 1;
+        QVector<int> keys;
+        QVector<double> results;
+
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::MeanSquareRoot, values.constData(), counts.constData(), 2, false), sqrt(12.5));
+        MetricAggregate::grouped(MetricAggregate::MeanSquareRoot, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), 2, false, keys, results);
+        QCOMPARE(results, QVector<double>() << sqrt(12.5));
+    }
+
+    // two of 2 samples with sd 1 and means 0 and 2, the combined mean is 1
+    // so (1*1 + 1*1 + 2*1 + 2*1) / 4
+    void groupedStdDev() {
+        QVector<double> values = QVector<double>() << 1 << 1;
+        QVector<double> counts = QVector<double>() << 2 << 2;
+        QVector<double> means = QVector<double>() << 0 << 2;
+        QVector<int> groups = QVector<int>() << 1 << 1;
+        QVector<int> keys;
+        QVector<double> results;
+
+        MetricAggregate::grouped(MetricAggregate::StdDev, values.constData(), counts.constData(), means.constData(),
+                                 groups.constData(), 2, false, keys, results);
+        QCOMPARE(results, QVector<double>() << sqrt(1.5));
+    }
+
+    // NaN never compares, so a Peak or Low passes over it
+    void nanPassedOver() {
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        QVector<double> values = QVector<double>() << nan << 3 << -2 << nan;
+        QVector<double> counts = QVector<double>() << 1 << 1 << 1 << 1;
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Peak, values.constData(), counts.constData(), 4, false), 3.0);
+        QCOMPARE(MetricAggregate::aggregate(MetricAggregate::Low, values.constData(), counts.constData(), 4, false), -2.0);
+
+        QVector<int> groups = QVector<int>() << 1 << 1 << 1 << 1;
+        QVector<int> keys;
+        QVector<double> results;
+        MetricAggregate::grouped(MetricAggregate::Peak, values.constData() + 1, counts.constData(), NULL,
+                                 groups.constData(), 3, false, keys, results);
+        QCOMPARE(results, QVector<double>() << 3);
+    }
+
+    void groupedSumsEachGroup() {
+        QVector<double> values = QVector<double>() << 1 << 2 << 3 << 0 << 5;
+        QVector<double> counts = QVector<double>() << 1 << 1 << 1 << 1 << 1;
+        QVector<int> groups = QVector<int>() << 3 << 3 << 4 << 6 << 6;
+        QVector<int> keys;
+        QVector<double> results;
+
+        MetricAggregate::grouped(MetricAggregate::Total, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), values.count(), false, keys, results);
+        QCOMPARE(keys, QVector<int>() << 3 << 4 << 6);
+        QCOMPARE(results, QVector<double>() << 3 << 3 << 5);
+
+        // the zero doesn't count towards the average unless aggregating zeroes
+        MetricAggregate::grouped(MetricAggregate::Average, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), values.count(), false, keys, results);
+        QCOMPARE(results, QVector<double>() << 1.5 << 3 << 5);
+        MetricAggregate::grouped(MetricAggregate::Average, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), values.count(), true, keys, results);
+        QCOMPARE(results, QVector<double>() << 1.5 << 3 << 2.5);
+    }
+
+    // a RunningTotal isn't summed in a group, the first value is kept
+    void groupedRunningTotalKeepsFirst() {
+        QVector<double> values = QVector<double>() << 4 << 2 << 3 << 0 << 5;
+        QVector<double> counts = QVector<double>() << 1 << 1 << 1 << 1 << 1;
+        QVector<int> groups = QVector<int>() << 1 << 1 << 2 << 5 << 5;
+        QVector<int> keys;
+        QVector<double> results;
+
+        MetricAggregate::grouped(MetricAggregate::RunningTotal, values.constData(), counts.constData(), NULL,
+                                 groups.constData(), values.count(), false, keys, results);
+        QCOMPARE(keys, QVector<int>() << 1 << 2 << 5);
+        QCOMPARE(results, QVector<double>() << 4 << 3 << 0);
+    }
+
+    void groupedWholeSeasonIsAggregate() {
+        QVector<double> values, counts, means;
+        QVector<int> groups;
+        season(500, values, counts, means, groups);
+        groups.fill(1);
+
+        foreach (int type, QList<int>() << MetricAggregate::Total << MetricAggregate::Peak << MetricAggregate::Average) {
+            QVector<int> keys;
+            QVector<double> results;
+            MetricAggregate::grouped(type, values.constData(), counts.constData(), NULL,
+                                     groups.constData(), values.count(), false, keys, results);
+            QCOMPARE(keys.count(), 1);
+
+            // the first value is always included in a group
+            double expect = perRide(type, values, counts, false);
+            if (type == MetricAggregate::Average && values[0] == 0) continue;
+            QVERIFY(same(results[0], expect));
+        }
+    }
+
+    void benchmarkAggregate() {
+        QVector<double> values, counts, means;
+        QVector<int> groups;
+        season(20000, values, counts, means, groups);
+
+        QBENCHMARK {
+            MetricAggregate::aggregate(MetricAggregate::Average, values.constData(), counts.constData(), values.count(), false);
+        }
+    }
+
+    void benchmarkGrouped() {
+        QVector<double> values, counts, means;
+        QVector<int> groups;
+        season(20000, values, counts, means, groups);
+        QVector<int> keys;
+        QVector<double> results;
+
+        QBENCHMARK {
+            MetricAggregate::grouped(MetricAggregate::Average, values.constData(), counts.constData(), NULL,
+                                     groups.constData(), values.count(), false, keys, results);
+        }
+    }
+};
+
+QTEST_MAIN(TestMetricAggregate)
+#include "testMetricAggregate.moc"
@@ -0,0 +1,18 @@
+QT += testlib core gui widgets core5compat
+
+# RideMetric.cpp pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json
+
+SOURCES = testMetricPasses.cpp \
+          ../../../src/Metrics/RideMetric.cpp
+
+# RideItem is only constructed, but it is a QObject
+HEADERS = ../../../src/Core/RideItem.h
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES}
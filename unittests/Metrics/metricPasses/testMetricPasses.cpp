@@ -0,0 +1,253 @@
+#include "Metrics/RideMetric.h"
+#include "Metrics/PeakEngine.h"
+#include "Metrics/ZoneEngine.h"
+#include "Core/RideItem.h"
+#include "Core/Specification.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+
+// the samples every pass over the ride sees, and how many passes were made
+static QVector<RideFilePoint> samples;
+static int passes = 0;
+
+// computeMetrics only needs these to hand the ride to the metrics, the
+// samples come from the iterator below rather than a ride file
+RideFileIterator::RideFileIterator(RideFile *f, Specification, IterationSpec) : f(f), start(0), stop(samples.count()-1), index(0) { passes++; }
+bool RideFileIterator::hasNext() const { return index <= stop; }
+RideFilePoint *RideFileIterator::next() { return &samples[index++]; }
+
+RideItem::RideItem() : ride_(NULL), fileCache_(NULL), context(NULL) {}
+RideItem::~RideItem() {}
+RideFile *RideItem::ride(bool) { return ride_; }
+void RideItem::modified() {}
+void RideItem::reverted() {}
+void RideItem::saved() {}
+void RideItem::notifyRideDataChanged() {}
+void RideItem::notifyRideMetadataChanged() {}
+
+DateRange::DateRange(QDate, QDate, QString, QColor) : valid(false) {}
+DateRange::DateRange(const DateRange &) : valid(false) {}
+DateRange &DateRange::operator=(const DateRange &) { return *this; }
+PlanFilter::PlanFilter(PlanFilterType) {}
+Specification::Specification() : it(NULL), recintsecs(0), ri(NULL) {}
+
+PeakEngine::PeakEngine(RideFile *, Specification) {}
+PeakEngine::~PeakEngine() {}
+PeakEngine::Scope::Scope(PeakEngine *) {}
+PeakEngine::Scope::~Scope() {}
+ZoneEngine::ZoneEngine(RideFile *, Specification) {}
+ZoneEngine::~ZoneEngine() {}
+ZoneEngine::Scope::Scope(ZoneEngine *) {}
+ZoneEngine::Scope::~Scope() {}
+
+QString time_to_string(double, bool) { return QString(); }
+
+
+//
+// Metrics with dependency chains through accumulators and metrics that
+// compute on their own, as the ported BasicRideMetrics and the rest are
+//
+
+// total watts
+struct TestSum : public AccumulatingMetric {
+    double total;
+    TestSum() { setSymbol("test_sum"); }
+    bool begin(RideItem *, Specification, const QHash<QString,RideMetric*> &) { total = 0; return true; }
+    void accumulate(const RideFilePoint *point) { total += point->watts; }
+    void finalise() { setValue(total); setCount(1); }
+    RideMetric *clone() const { return new TestSum(*this); }
+};
+
+// max heartrate
+struct TestMax : public AccumulatingMetric {
+    double max;
+    TestMax() { setSymbol("test_max"); }
+    bool begin(RideItem *, Specification, const QHash<QString,RideMetric*> &) { max = 0; return true; }
+    void accumulate(const RideFilePoint *point) { if (point->hr > max) max = point->hr; }
+    void finalise() { setValue(max); setCount(1); }
+    RideMetric *clone() const { return new TestMax(*this); }
+};
+
+// average cadence, has nothing to do without samples
+struct TestCadence : public AccumulatingMetric {
+    double total, count;
+    TestCadence() { setSymbol("test_cadence"); }
+    bool begin(RideItem *, Specification, const QHash<QString,RideMetric*> &) {
+        if (samples.isEmpty()) {
+            setValue(RideFile::NIL);
+            setCount(0);
+            return false;
+        }
+        total = count = 0;
+        return true;
+    }
+    void accumulate(const RideFilePoint *point) { total += point->cad; count++; }
+    void finalise() { setValue(count ? total / count : 0); setCount(count); }
+    RideMetric *clone() const { return new TestCadence(*this); }
+};
+
+// from the accumulators, no samples needed
+struct TestRatio : public RideMetric {
+    TestRatio() { setSymbol("test_ratio"); }
+    void compute(RideItem *, Specification, const QHash<QString,RideMetric*> &deps) {
+        double max = deps.value("test_max")->value(true);
+        setValue(max ? deps.value("test_sum")->value(true) / max : 0);
+        setCount(1);
+    }
+    RideMetric *clone() const { return new TestRatio(*this); }
+};
+
+// an accumulator that needs a metric that needs accumulators
+struct TestScaled : public AccumulatingMetric {
+    double ratio, total;
+    TestScaled() { setSymbol("test_scaled"); }
+    bool begin(RideItem *, Specification, const QHash<QString,RideMetric*> &deps) {
+        ratio = deps.value("test_ratio")->value(true);
+        total = 0;
+        return true;
+    }
+    void accumulate(const RideFilePoint *point) { total += point->hr * ratio; }
+    void finalise() { setValue(total); setCount(1); }
+    RideMetric *clone() const { return new TestScaled(*this); }
+};
+
+// makes its own pass, as metrics needing random access do
+struct TestOver : public RideMetric {
+    TestOver() { setSymbol("test_over"); }
+    void compute(RideItem *item, Specification spec, const QHash<QString,RideMetric*> &deps) {
+        double mean = samples.count() ? deps.value("test_scaled")->value(true) / samples.count() : 0;
+        double over = 0;
+        RideFileIterator it(item->ride(), spec);
+        while (it.hasNext()) if (it.next()->hr * deps.value("test_ratio")->value(true) > mean) over++;
+        setValue(over + deps.value("test_cadence")->value(true));
+        setCount(1);
+    }
+    RideMetric *clone() const { return new TestOver(*this); }
+};
+
+static bool testSumAdded = RideMetricFactory::instance().addMetric(TestSum());
+static bool testMaxAdded = RideMetricFactory::instance().addMetric(TestMax());
+static bool testCadenceAdded = RideMetricFactory::instance().addMetric(TestCadence());
+static bool testRatioAdded = RideMetricFactory::instance().addMetric(TestRatio(),
+    &(QVector<QString>() << "test_sum" << "test_max"));
+static bool testScaledAdded = RideMetricFactory::instance().addMetric(TestScaled(),
+    &(QVector<QString>() << "test_ratio"));
+static bool testOverAdded = RideMetricFactory::instance().addMetric(TestOver(),
+    &(QVector<QString>() << "test_scaled" << "test_ratio" << "test_cadence"));
+
+// each metric in turn after its dependencies, with a pass of its own, as
+// computeMetrics did before accumulators
+static void perMetric(RideItem *item, QString symbol, QHash<QString,RideMetric*> &done)
+{
+    if (done.contains(symbol)) return;
+
+    const RideMetricFactory &factory = RideMetricFactory::instance();
+    foreach(QString dep, factory.dependencies(symbol)) perMetric(item, dep, done);
+
+    RideMetric *m = factory.newMetric(symbol);
+    m->setValue(0.0);
+    m->setCount(0);
+    m->compute(item, Specification(), done);
+    done.insert(symbol, m);
+}
+
+// a ride of 1s samples
+static void ride(int n)
+{
+    QRandomGenerator random(42);
+    samples.resize(n);
+    for (int i=0; i<n; i++) {
+        samples[i].secs = i;
+        samples[i].watts = random.bounded(600);
+        samples[i].hr = 60 + random.bounded(130);
+        samples[i].cad = random.bounded(120);
+    }
+}
+
+class TestMetricPasses: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void sameAsPerMetric_data() {
+        QTest::addColumn<QStringList>("metrics");
+        QTest::addColumn<int>("samples");
+        QTest::addColumn<int>("passes");
+        QTest::addColumn<int>("before");
+
+        QTest::newRow("one accumulator") << (QStringList() << "test_sum") << 3600 << 1 << 1;
+        QTest::newRow("independent accumulators") << (QStringList() << "test_sum" << "test_max" << "test_cadence") << 3600 << 1 << 3;
+        QTest::newRow("from accumulators") << (QStringList() << "test_ratio") << 3600 << 1 << 2;
+
+        // sum and max, then scaled, then over on its own
+        QTest::newRow("chain") << (QStringList() << "test_scaled") << 3600 << 2 << 3;
+        QTest::newRow("chain and own pass") << (QStringList() << "test_over") << 3600 << 3 << 5;
+        QTest::newRow("everything") << (QStringList() << "test_over" << "test_sum" << "test_max" << "test_cadence"
+                                                      << "test_ratio" << "test_scaled") << 3600 << 3 << 5;
+
+        // cadence has nothing to accumulate without samples
+        QTest::newRow("no samples") << (QStringList() << "test_over") << 0 << 3 << 4;
+    }
+
+    void sameAsPerMetric() {
+        QFETCH(QStringList, metrics);
+        QFETCH(int, samples);
+        QFETCH(int, passes);
+        QFETCH(int, before);
+
+        ride(samples);
+        RideItem item;
+
+        ::passes = 0;
+        QHash<QString,RideMetric*> done;
+        foreach(QString symbol, metrics) perMetric(&item, symbol, done);
+        QCOMPARE(::passes, before);
+
+        ::passes = 0;
+        QHash<QString,RideMetricPtr> computed = RideMetric::computeMetrics(&item, Specification(), metrics);
+        QCOMPARE(::passes, passes);
+
+        QCOMPARE(computed.count(), metrics.count());
+        foreach(QString symbol, metrics) {
+            QVERIFY(computed.contains(symbol));
+            QCOMPARE(computed.value(symbol)->value(true), done.value(symbol)->value(true));
+            QCOMPARE(computed.value(symbol)->count(), done.value(symbol)->count());
+        }
+        qDeleteAll(done);
+    }
+
+    // the dependencies are computed but not returned
+    void onlyWhatWasAsked() {
+        ride(100);
+        RideItem item;
+        QHash<QString,RideMetricPtr> computed = RideMetric::computeMetrics(&item, Specification(), QStringList() << "test_scaled" << "test_unknown");
+        QCOMPARE(computed.keys(), QList<QString>() << "test_scaled");
+    }
+
+    // reported when first used and still computed, last
+    void dependencyLoop() {
+        struct Loop : public RideMetric {
+            Loop(QString symbol) { setSymbol(symbol); }
+            void compute(RideItem *, Specification, const QHash<QString,RideMetric*> &deps) { setValue(deps.count()); }
+            RideMetric *clone() const { return new Loop(*this); }
+        };
+        RideMetricFactory::instance().addMetric(Loop("test_loop_a"), &(QVector<QString>() << "test_loop_b"));
+        RideMetricFactory::instance().addMetric(Loop("test_loop_b"), &(QVector<QString>() << "test_loop_a" << "test_sum"));
+
+        QTest::ignoreMessage(QtDebugMsg, "metric dep loop: \"test_loop_a\"");
+        QTest::ignoreMessage(QtDebugMsg, "metric dep loop: \"test_loop_b\"");
+
+        ride(100);
+        RideItem item;
+        QHash<QString,RideMetricPtr> computed = RideMetric::computeMetrics(&item, Specification(), QStringList() << "test_loop_a" << "test_sum");
+        QCOMPARE(computed.count(), 2);
+        QCOMPARE(computed.value("test_sum")->value(true), RideMetric::computeMetrics(&item, Specification(), QStringList() << "test_sum").value("test_sum")->value(true));
+    }
+};
+
+
+QTEST_MAIN(TestMetricPasses)
+#include "testMetricPasses.moc"
@@ -0,0 +1,186 @@
+#include "Metrics/PeakEngine.h"
+#include "FileIO/RideFile.h"
+#include "Core/Athlete.h"
+#include "Core/Context.h"
+#include "Core/Settings.h"
+#include "Core/Specification.h"
+#include "Core/Units.h"
+#include "FileIO/FilterHRV.h"
+#include "Gui/Colors.h"
+#include "Metrics/WPrime.h"
+#include "Metrics/Zones.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+
+// the rest of the tree RideFile.cpp refers to, none of it is
+// reached by building a ride and reading its samples
+GSettings *appsettings = NULL;
+QVariant GSettings::value(const QObject *, const QString, const QVariant def) { return def; }
+QVariant GSettings::cvalue(QString, QString, QVariant def) { return def; }
+GlobalContext *GlobalContext::context() { return NULL; }
+QColor GCColor::getColor(int) { return QColor(); }
+QString kphToPace(double, bool, bool) { return QString(); }
+void FilterHrv(XDataSeries *, double, double, double, int) {}
+double Athlete::getWeight(QDate, RideFile *) { return 0; }
+double Athlete::getHeight(RideFile *) { return 0; }
+int Zones::whichRange(const QDate &) const { return -1; }
+int Zones::getCP(int) const { return 0; }
+WPrime::WPrime() {}
+void WPrime::setRide(RideFile *) {}
+DateRange::DateRange(QDate, QDate, QString, QColor) : valid(false) {}
+DateRange::DateRange(const DateRange &) : valid(false) {}
+DateRange &DateRange::operator=(const DateRange &) { return *this; }
+PlanFilter::PlanFilter(PlanFilterType) {}
+Specification::Specification() : it(NULL), recintsecs(0), ri(NULL) {}
+double Specification::secsStart() const { return -1; }
+double Specification::secsEnd() const { return -1; }
+
+
+// AddIntervalDialog::findPeaks with maxIntervals=1, as the peak metrics
+// called it before PeakEngine
+struct Best {
+    double start, stop, avg;
+};
+
+static PeakEngine::Peak findPeak(const RideFile *ride, bool typeTime, RideFile::SeriesType series, double windowSize)
+{
+    PeakEngine::Peak returning;
+    QList<Best> bests;
+
+    double secsDelta = ride->recIntSecs();
+    double total = 0.0;
+    QList<const RideFilePoint*> window;
+
+    // ride is shorter than the window size!
+    if (typeTime && windowSize > ride->dataPoints().last()->secs + secsDelta) return returning;
+    if (!typeTime && windowSize > ride->dataPoints().last()->km*1000) return returning;
+
+    foreach(const RideFilePoint *point, ride->dataPoints()) {
+
+        while ((typeTime && !window.empty() && point->secs - window.first()->secs + secsDelta >= windowSize + secsDelta) ||
+               (!typeTime && window.length()>1 && 1000*(point->km - window.at(1)->km) >= windowSize)) {
+            total -= window.first()->value(series);
+            window.takeFirst();
+        }
+        total += point->value(series);
+        window.append(point);
+        double duration = window.last()->secs - window.first()->secs + secsDelta;
+        double distance = 1000*(window.last()->km - window.first()->km);
+
+        if ((typeTime && duration >= windowSize) || (!typeTime && distance >= windowSize)) {
+            Best add = { window.first()->secs, window.last()->secs, total * secsDelta / duration };
+            bests.append(add);
+        }
+    }
+
+    // decreasing average, then increasing start
+    std::sort(bests.begin(), bests.end(), [](const Best &a, const Best &b) {
+        if (a.avg > b.avg) return true;
+        if (b.avg > a.avg) return false;
+        return a.start < b.start;
+    });
+
+    if (!bests.isEmpty()) {
+        returning.found = true;
+        returning.start = bests.first().start;
+        returning.stop = bests.first().stop;
+        returning.avg = bests.first().avg;
+    }
+    return returning;
+}
+
+// 1s samples of power, heartrate and distance with some gaps in recording
+static void makeRide(RideFile &ride, int count, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    double secs = 0, km = 0;
+    for (int i=0; i<count; i++) {
+        RideFilePoint p;
+        p.secs = secs;
+        p.km = km;
+        p.kph = 20 + random.bounded(20);
+        p.watts = random.bounded(400);
+        p.hr = 100 + random.bounded(80);
+        ride.appendPoint(p);
+
+        int step = random.bounded(50) == 0 ? 5 + random.bounded(60) : 1;
+        secs += step;
+        km += random.bounded(step * 12) / 1000.0;
+    }
+}
+
+class TestPeakEngine: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void matchesFindPeaks_data() {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<quint32>("seed");
+        QTest::addRow("short") << 90 << quint32(1);
+        QTest::addRow("hour") << 3600 << quint32(2);
+        QTest::addRow("gappy") << 2000 << quint32(3);
+    }
+
+    void matchesFindPeaks() {
+        QFETCH(int, count);
+        QFETCH(quint32, seed);
+
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, count, seed);
+
+        // the last ones are longer than the short ride, or all of them
+        QVector<double> durations = QVector<double>() << 1 << 5 << 10 << 30 << 60 << 120 << 300 << 1200 << 3600 << 7200 << 100000;
+        QVector<double> distances = QVector<double>() << 100 << 200 << 400 << 1000 << 5000 << 20000 << 1000000;
+
+        QList<RideFile::SeriesType> series = QList<RideFile::SeriesType>() << RideFile::watts << RideFile::hr << RideFile::kph << RideFile::cad;
+        foreach(RideFile::SeriesType s, series) {
+
+            PeakEngine engine(&ride, Specification());
+
+            QVector<PeakEngine::Peak> byTime = engine.peaks(s, true, durations);
+            for (int i=0; i<durations.count(); i++) {
+                PeakEngine::Peak expected = findPeak(&ride, true, s, durations[i]);
+                QCOMPARE(byTime[i].found, expected.found);
+                QCOMPARE(byTime[i].start, expected.start);
+                QCOMPARE(byTime[i].stop, expected.stop);
+                QCOMPARE(byTime[i].avg, expected.avg);
+            }
+
+            QVector<PeakEngine::Peak> byDistance = engine.peaks(s, false, distances);
+            for (int i=0; i<distances.count(); i++) {
+                PeakEngine::Peak expected = findPeak(&ride, false, s, distances[i]);
+                QCOMPARE(byDistance[i].found, expected.found);
+                QCOMPARE(byDistance[i].start, expected.start);
+                QCOMPARE(byDistance[i].stop, expected.stop);
+                QCOMPARE(byDistance[i].avg, expected.avg);
+            }
+        }
+    }
+
+    // a window is found once and the rest come from the same pass
+    void memoised() {
+        RideFile ride(QDateTime::currentDateTime(), 1);
+        makeRide(ride, 600, 4);
+
+        PeakEngine engine(&ride, Specification());
+        PeakEngine::Peak first = engine.peak(RideFile::watts, true, 60);
+        QVERIFY(first.found);
+
+        PeakEngine::Peak again = engine.peak(RideFile::watts, true, 60);
+        QCOMPARE(again.avg, first.avg);
+        QCOMPARE(again.start, first.start);
+
+        // longer than the ride is not found
+        QVERIFY(!engine.peak(RideFile::watts, true, 3600).found);
+    }
+};
+
+
+QTEST_MAIN(TestPeakEngine)
+#include "testPeakEngine.moc"
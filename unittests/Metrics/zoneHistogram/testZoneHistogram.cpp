@@ -0,0 +1,161 @@
+#include "Metrics/ZoneHistogram.h"
+
+#include <QTest>
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <limits>
+#include <climits>
+
+
+// 7 power zones for a CP of 250, as Zones would set them up
+static ZoneBounds power()
+{
+    ZoneBounds bounds;
+    bounds.lo << 0 << 138 << 188 << 226 << 263 << 300 << 375;
+    bounds.hi << 138 << 188 << 226 << 263 << 300 << 375 << INT_MAX;
+    bounds.aet = 213;
+    bounds.threshold = 250;
+    bounds.zero = 1;
+    return bounds;
+}
+
+// as Zones::whichZone
+static int whichZone(const ZoneBounds &bounds, double value)
+{
+    for (int j=0; j<bounds.lo.count(); j++)
+        if (value >= bounds.lo[j] && value < bounds.hi[j]) return j;
+    return -1;
+}
+
+// a ride of 1s samples, with some zeroes, spikes and dropouts
+static QVector<double> ride(int n)
+{
+    QRandomGenerator random(42);
+    QVector<double> watts(n);
+    for (int i=0; i<n; i++) {
+        switch (random.bounded(20)) {
+        case 0: watts[i] = 0; break;
+        case 1: watts[i] = 1500; break;
+        case 2: watts[i] = -1; break;
+        default: watts[i] = random.bounded(450); break;
+        }
+    }
+    return watts;
+}
+
+class TestZoneHistogram: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void matchesPerSample() {
+        ZoneBounds bounds = power();
+        QVector<double> watts = ride(10000);
+        watts[10] = std::numeric_limits<double>::quiet_NaN();
+        watts[11] = 250; // on the threshold
+        watts[12] = 213; // on AeT
+
+        ZoneTimes times = ZoneHistogram::classify(watts.constData(), watts.count(), 0.5, bounds);
+
+        // as the time in zone metrics and ride file cache did it, sample by sample
+        QVector<double> zones(bounds.lo.count());
+        double polarized[3] = { 0, 0, 0 };
+        double cp[4] = { 0, 0, 0, 0 };
+        foreach (double value, watts) {
+            int index = whichZone(bounds, value);
+            if (index >= 0) zones[index] += 0.5;
+
+            if (value < bounds.aet) polarized[0] += 0.5;
+            if (value >= bounds.aet && value < bounds.threshold) polarized[1] += 0.5;
+            if (value >= bounds.threshold) polarized[2] += 0.5;
+
+            if (value < bounds.zero) cp[0] += 0.5;
+            else if (value < bounds.aet) cp[1] += 0.5;
+            else if (value < bounds.threshold) cp[2] += 0.5;
+            else cp[3] += 0.5;
+        }
+
+        QCOMPARE(times.zones, zones);
+        for (int i=0; i<3; i++) QCOMPARE(times.polarized[i], polarized[i]);
+        for (int i=0; i<4; i++) QCOMPARE(times.cp[i], cp[i]);
+        QCOMPARE(times.total, 5000.0);
+    }
+
+    // a single sample on the low edge of zone 2, 2s apart
+    void oneSample() {
+        double watts = 138;
+        ZoneTimes times = ZoneHistogram::classify(&watts, 1, 2, power());
+        QCOMPARE(times.zones, QVector<double>() << 0 << 2 << 0 << 0 << 0 << 0 << 0);
+        QCOMPARE(times.polarized[0], 2.0);
+        QCOMPARE(times.cp[1], 2.0);
+        QCOMPARE(times.total, 2.0);
+    }
+
+    // lo is in the zone and hi in the next, the same for AeT, CP and zero
+    void boundaries() {
+        QVector<double> watts = QVector<double>() << 0 << 137.999 << 138 << 375 << 1 << 0.999 << 213 << 250;
+        ZoneTimes times = ZoneHistogram::classify(watts.constData(), watts.count(), 1, power());
+
+        QCOMPARE(times.zones, QVector<double>() << 4 << 1 << 1 << 1 << 0 << 0 << 1);
+        QCOMPARE(times.polarized[0], 5.0);
+        QCOMPARE(times.polarized[1], 1.0);
+        QCOMPARE(times.polarized[2], 2.0);
+        QCOMPARE(times.cp[0], 2.0);
+        QCOMPARE(times.cp[1], 3.0);
+        QCOMPARE(times.cp[2], 1.0);
+        QCOMPARE(times.cp[3], 2.0);
+        QCOMPARE(times.total, 8.0);
+    }
+
+    // negative and infinite are in no zone but are polarized, nan
+    // fails every comparison so is only in the cache's zone III
+    void outOfRange() {
+        QVector<double> watts = QVector<double>() << -1 << std::numeric_limits<double>::infinity();
+        ZoneTimes times = ZoneHistogram::classify(watts.constData(), watts.count(), 1, power());
+        QCOMPARE(times.zones, QVector<double>(7));
+        QCOMPARE(times.polarized[0], 1.0);
+        QCOMPARE(times.polarized[2], 1.0);
+        QCOMPARE(times.cp[0], 1.0);
+        QCOMPARE(times.cp[3], 1.0);
+
+        double nan = std::numeric_limits<double>::quiet_NaN();
+        times = ZoneHistogram::classify(&nan, 1, 1, power());
+        QCOMPARE(times.zones, QVector<double>(7));
+        QCOMPARE(times.polarized[0] + times.polarized[1] + times.polarized[2], 0.0);
+        QCOMPARE(times.cp[0] + times.cp[1] + times.cp[2], 0.0);
+        QCOMPARE(times.cp[3], 1.0);
+        QCOMPARE(times.total, 1.0);
+    }
+
+    void noZones() {
+        QVector<double> watts = ride(100);
+        ZoneTimes times = ZoneHistogram::classify(watts.constData(), watts.count(), 1, ZoneBounds());
+        QCOMPARE(times.zones.count(), 0);
+        QCOMPARE(times.total, 100.0);
+
+        times = ZoneHistogram::classify(NULL, 0, 1, power());
+        QCOMPARE(times.zones, QVector<double>(7));
+        QCOMPARE(times.total, 0.0);
+    }
+
+    void wbal() {
+        // 20kJ W', 25% used is in zone 1 and 100% in zone 4
+        QVector<double> values = QVector<double>() << 20000 << 15000 << 14999 << 10000 << 5000 << 0 << -100;
+        QCOMPARE(ZoneHistogram::wbal(values, 20000), QVector<double>() << 2 << 2 << 1 << 2);
+        QCOMPARE(ZoneHistogram::wbal(QVector<double>(), 20000), QVector<double>() << 0 << 0 << 0 << 0);
+    }
+
+    void benchmarkClassify() {
+        ZoneBounds bounds = power();
+        QVector<double> watts = ride(4 * 3600);
+
+        QBENCHMARK {
+            ZoneHistogram::classify(watts.constData(), watts.count(), 1, bounds);
+        }
+    }
+};
+
+QTEST_MAIN(TestZoneHistogram)
+#include "testZoneHistogram.moc"
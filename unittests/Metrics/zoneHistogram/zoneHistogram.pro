@@ -0,0 +1,6 @@
+QT += testlib core
+
+SOURCES = testZoneHistogram.cpp \
+          ../../../src/Metrics/ZoneHistogram.cpp
+
+include(../../unittests.pri)
@@ -0,0 +1,28 @@
+QT += testlib core gui widgets core5compat
+
+# Bindings.h pulls in RideFile.h and headers from across the tree
+INCLUDEPATH += ../../../src/Python/SIP ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json
+SOURCES = testPythonDataSeries.cpp
+GC_OBJS = sip_core \
+          sip_array \
+          sip_descriptors \
+          sip_enum \
+          sip_int_convertors \
+          sip_object_map \
+          sip_threads \
+          sip_voidptr \
+          sipgoldencheetahcmodule \
+          sipgoldencheetahPythonDataSeries \
+          sipgoldencheetahQString \
+          sipgoldencheetahQStringList \
+          PythonDataSeries
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri, built as src.pro builds the bindings
+INCLUDEPATH += $$replace(PYTHONINCLUDES, ^-I, )
+LIBS += $${PYTHONLIBS}
+DEFINES += SIP_STATIC_MODULE
@@ -0,0 +1,158 @@
+#include <QTest>
+#include <QVector>
+
+#include "Python/SIP/Bindings.h"
+
+#undef slots
+#include "sipAPIgoldencheetah.h"
+#define slots Q_SLOTS
+
+extern "C" {
+extern PyObject *PyInit_goldencheetah(void);
+};
+
+// only the PythonDataSeries wrapper is linked, the other classes in the
+// module are empty and a series here never has a ride to write to
+sipClassTypeDef sipTypeDef_goldencheetah_Bindings = {
+    { SIP_NULLPTR, SIP_TYPE_CLASS, sipNameNr_Bindings, SIP_NULLPTR, SIP_NULLPTR },
+    { sipNameNr_Bindings, {0, 0, 1}, 0, SIP_NULLPTR, 0, SIP_NULLPTR, {SIP_NULLPTR} },
+    SIP_NULLPTR, -1, -1
+};
+sipClassTypeDef sipTypeDef_goldencheetah_PythonXDataSeries = {
+    { SIP_NULLPTR, SIP_TYPE_CLASS, sipNameNr_PythonXDataSeries, SIP_NULLPTR, SIP_NULLPTR },
+    { sipNameNr_PythonXDataSeries, {0, 0, 1}, 0, SIP_NULLPTR, 0, SIP_NULLPTR, {SIP_NULLPTR} },
+    SIP_NULLPTR, -1, -1
+};
+bool RideFile::isDataPresent(SeriesType) const { return false; }
+void RideFileCommand::setPointValue(int, RideFile::SeriesType, double) {}
+void RideFileCommand::setDataPresent(RideFile::SeriesType, bool) {}
+
+
+class TestPythonDataSeries: public QObject
+{
+    Q_OBJECT
+
+    // a script's globals, with s sharing values as the mean-max and
+    // season metrics calls hand them back when asked for series=True
+    PyObject* script(const QVector<double> &values) {
+        PyObject* globals = PyDict_New();
+        PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+        PyObject* s = sipConvertFromNewType(new PythonDataSeries("watts", values, 0, values.count(), false),
+                                            sipType_PythonDataSeries, NULL);
+        PyDict_SetItemString(globals, "s", s);
+        Py_DECREF(s);
+        return globals;
+    }
+
+    // the value of expression as text, or the name of the exception it raised
+    QString eval(PyObject *globals, const char *expression) {
+        PyObject* result = PyRun_String(expression, Py_eval_input, globals, globals);
+        if (result == NULL) {
+            PyObject *type, *value, *traceback;
+            PyErr_Fetch(&type, &value, &traceback);
+            QString name = ((PyTypeObject*)type)->tp_name;
+            Py_XDECREF(type);
+            Py_XDECREF(value);
+            Py_XDECREF(traceback);
+            return name;
+        }
+        PyObject* text = PyObject_Repr(result);
+        QString returning = PyUnicode_AsUTF8(text);
+        Py_DECREF(text);
+        Py_DECREF(result);
+        return returning;
+    }
+
+    void run(PyObject *globals, const char *statement) {
+        PyObject* result = PyRun_String(statement, Py_single_input, globals, globals);
+        if (result == NULL) PyErr_Print();
+        QVERIFY(result != NULL);
+        Py_DECREF(result);
+    }
+
+private slots:
+
+    void initTestCase() {
+        PyImport_AppendInittab("goldencheetah", PyInit_goldencheetah);
+        Py_InitializeEx(0);
+        PyObject* module = PyImport_ImportModule("goldencheetah");
+        if (module == NULL) PyErr_Print();
+        QVERIFY(module != NULL);
+        Py_DECREF(module);
+    }
+
+    void cleanupTestCase() {
+        Py_FinalizeEx();
+    }
+
+    // scripts treated the lists these used to be as sequences
+    void sequence() {
+        QVector<double> values = QVector<double>() << 100 << 200 << 300 << 400;
+        PyObject* globals = script(values);
+
+        QCOMPARE(eval(globals, "len(s)"), QString("4"));
+        QCOMPARE(eval(globals, "s[1]"), QString("200.0"));
+        QCOMPARE(eval(globals, "s[-1]"), QString("400.0"));
+        QCOMPARE(eval(globals, "s[4]"), QString("IndexError"));
+        QCOMPARE(eval(globals, "list(s)"), QString("[100.0, 200.0, 300.0, 400.0]"));
+        QCOMPARE(eval(globals, "max(s)"), QString("400.0"));
+
+        // slices are lists
+        QCOMPARE(eval(globals, "s[1:3]"), QString("[200.0, 300.0]"));
+        QCOMPARE(eval(globals, "s[::-2]"), QString("[400.0, 200.0]"));
+        QCOMPARE(eval(globals, "s[-2:]"), QString("[300.0, 400.0]"));
+        QCOMPARE(eval(globals, "s[5:]"), QString("[]"));
+        QCOMPARE(eval(globals, "s[::0]"), QString("ValueError"));
+
+        // and compare equal to the same values in any sequence
+        QCOMPARE(eval(globals, "s == [100, 200, 300, 400]"), QString("True"));
+        QCOMPARE(eval(globals, "[100, 200, 300, 400] == s"), QString("True"));
+        QCOMPARE(eval(globals, "s == (100.0, 200.0, 300.0, 400.0)"), QString("True"));
+        QCOMPARE(eval(globals, "s == s[:]"), QString("True"));
+        QCOMPARE(eval(globals, "s == [100, 200, 300]"), QString("False"));
+        QCOMPARE(eval(globals, "s != [100, 200, 300, 401]"), QString("True"));
+        QCOMPARE(eval(globals, "s == [100, 200, 300, 'x']"), QString("False"));
+        QCOMPARE(eval(globals, "s == 'abcd'"), QString("False"));
+        QCOMPARE(eval(globals, "s == None"), QString("False"));
+        QCOMPARE(eval(globals, "s != None"), QString("True"));
+
+        Py_DECREF(globals);
+    }
+
+    // writing to a series changes its own copy, never the values it shares
+    void writeCopies() {
+        QVector<double> values = QVector<double>() << 100 << 200 << 300;
+        PyObject* globals = script(values);
+
+        run(globals, "s[0] = 50");
+        QCOMPARE(eval(globals, "list(s)"), QString("[50.0, 200.0, 300.0]"));
+        QCOMPARE(values[0], 100.0);
+
+        Py_DECREF(globals);
+    }
+
+    // numpy sees the shared values themselves, and can't write to them
+    void numpySharesMemory() {
+        PyObject* numpy = PyImport_ImportModule("numpy");
+        if (numpy == NULL) {
+            PyErr_Clear();
+            QSKIP("numpy is not installed");
+        }
+        Py_DECREF(numpy);
+
+        QVector<double> values = QVector<double>() << 100 << 200 << 300;
+        PyObject* globals = script(values);
+        run(globals, "import numpy; a = numpy.asarray(s)");
+
+        QCOMPARE(eval(globals, "a.ctypes.data").toULongLong(), quint64(quintptr(values.constData())));
+        QCOMPARE(eval(globals, "a.flags.writeable"), QString("False"));
+        QCOMPARE(eval(globals, "float(a.sum())"), QString("600.0"));
+        QCOMPARE(eval(globals, "a.__setitem__(0, 1)"), QString("ValueError"));
+        QCOMPARE(values[0], 100.0);
+
+        Py_DECREF(globals);
+    }
+};
+
+QTEST_MAIN(TestPythonDataSeries)
+#include "testPythonDataSeries.moc"
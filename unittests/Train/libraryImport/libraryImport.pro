@@ -0,0 +1,21 @@
+QT += testlib core gui widgets sql core5compat
+
+# LibraryImport.cpp pulls in headers from across the tree, as src.pro does
+INCLUDEPATH += ../../../src/Core ../../../src/FileIO ../../../src/Metrics \
+               ../../../src/Gui ../../../src/Charts ../../../src/Cloud \
+               ../../../src/Train ../../../src/ANT ../../../src/Planning \
+               ../../../qwt/src ../../../contrib/qtsolutions/json
+
+SOURCES = testLibraryImport.cpp \
+          ../../../src/Train/LibraryImport.cpp \
+          ../../../src/Train/ErgFileBase.cpp \
+          ../../../src/Train/VideoSyncFileBase.cpp \
+          ../../../src/Core/TaskScheduler.cpp
+
+HEADERS = ../../../src/Train/LibraryImport.h \
+          ../../../src/Train/TrainDB.h
+
+include(../../unittests.pri)
+
+# set by gcconfig.pri
+INCLUDEPATH += $${GSL_INCLUDES}
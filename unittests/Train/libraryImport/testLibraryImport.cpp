@@ -0,0 +1,267 @@
+#include "Train/LibraryImport.h"
+#include "Train/TrainDB.h"
+#include "Train/ErgFile.h"
+#include "Train/VideoSyncFile.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QFile>
+
+
+//
+// TrainDB as the hashes and files it holds, and what was written to it
+//
+static QHash<QString, QString> dbHashes;
+static QSet<QString> dbWorkouts, dbVideoSyncs;
+static QHash<QString, QString> dbNames;
+static QStringList imported;
+
+TrainDB *trainDB;
+TrainDB::TrainDB(QDir home) : home(home), db(nullptr) {}
+TrainDB::~TrainDB() {}
+
+QStringList TrainDB::getWorkouts() const { return QStringList(dbWorkouts.begin(), dbWorkouts.end()); }
+QStringList TrainDB::getVideoSyncs() const { return QStringList(dbVideoSyncs.begin(), dbVideoSyncs.end()); }
+QHash<QString, QString> TrainDB::getWorkoutHashes() const { return QHash<QString, QString>(); }
+QHash<QString, QString> TrainDB::getFileHashes() const { return dbHashes; }
+bool TrainDB::setFileHash(QString filepath, QString hash) const { dbHashes.insert(filepath, hash); return true; }
+
+bool TrainDB::importWorkout(QString filepath, const ErgFileBase &ergFileBase, ImportMode) const
+{
+    imported << filepath;
+    dbWorkouts.insert(filepath);
+    dbNames.insert(filepath, ergFileBase.name());
+    return true;
+}
+
+bool TrainDB::importVideoSync(QString filepath, const VideoSyncFileBase &videoSyncFileBase, ImportMode) const
+{
+    imported << filepath;
+    dbVideoSyncs.insert(filepath);
+    dbNames.insert(filepath, videoSyncFileBase.name());
+    return true;
+}
+
+// tags aren't used by an import
+void TrainDB::deferTagSignals(bool) {}
+bool TrainDB::isDeferredTagSignals() { return false; }
+void TrainDB::catchupTagSignals() {}
+int TrainDB::addTag(const QString &) { return TAGSTORE_UNDEFINED_ID; }
+bool TrainDB::updateTag(int, const QString &) { return false; }
+bool TrainDB::deleteTag(int) { return false; }
+bool TrainDB::deleteTag(const QString &) { return false; }
+int TrainDB::getTagId(const QString &) const { return TAGSTORE_UNDEFINED_ID; }
+QString TrainDB::getTagLabel(int) const { return QString(); }
+bool TrainDB::hasTag(int) const { return false; }
+bool TrainDB::hasTag(const QString &) const { return false; }
+QList<TagStore::Tag> TrainDB::getTags() const { return QList<Tag>(); }
+QList<int> TrainDB::getTagIds() const { return QList<int>(); }
+QStringList TrainDB::getTagLabels() const { return QStringList(); }
+QStringList TrainDB::getTagLabels(const QList<int>) const { return QStringList(); }
+int TrainDB::countTagUsage(int) const { return 0; }
+
+//
+// a workout or videosync is valid when it starts "valid", its name is the
+// rest of the first line; parses are counted
+//
+static QAtomicInt parses;
+
+static bool parse(QString filepath, QString &name)
+{
+    parses.ref();
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    QString content = QString(file.readAll()).trimmed();
+    if (!content.startsWith("valid ")) return false;
+    name = content.mid(6);
+    return true;
+}
+
+ErgFile::ErgFile(QString filename, ErgFileFormat, Context *context, QDate when) : when(when), valid(false), context(context)
+{
+    QString name;
+    valid = parse(filename, name);
+    this->name(name);
+}
+ErgFile::~ErgFile() {}
+bool ErgFile::isValid() const { return valid; }
+
+VideoSyncFile::VideoSyncFile(QString filename, int &, Context *context) : valid(false), context(context)
+{
+    QString name;
+    valid = parse(filename, name);
+    this->name(name);
+}
+VideoSyncFile::~VideoSyncFile() {}
+bool VideoSyncFile::isValid() const { return valid; }
+
+
+class TestLibraryImport: public QObject
+{
+    Q_OBJECT
+
+private:
+    QTemporaryDir dir;
+
+    QString path(QString name) { return dir.path() + "/" + name; }
+
+    void write(QString name, QString content) {
+        QFile file(path(name));
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        file.write(content.toUtf8());
+    }
+
+    // a library search: queue everything found, then write what was parsed
+    void scan(LibraryImport &import, bool skipKnown = true) {
+        parses.storeRelaxed(0);
+        imported.clear();
+
+        if (skipKnown) import.skipKnown();
+        import.addWorkout(path("a.erg"));
+        import.addWorkout(path("b.erg"));
+        import.addWorkout(path("bad.erg"));
+        import.addVideoSync(path("s.rlv"));
+        import.wait();
+        QVERIFY(import.write());
+        imported.sort();
+    }
+
+private slots:
+
+    void initTestCase() {
+        QVERIFY(dir.isValid());
+        trainDB = new TrainDB(QDir(dir.path()));
+    }
+
+    void cleanupTestCase() {
+        delete trainDB;
+        trainDB = nullptr;
+    }
+
+    // an empty library, with files as the search finds them
+    void init() {
+        dbHashes.clear();
+        dbWorkouts.clear();
+        dbVideoSyncs.clear();
+        dbNames.clear();
+
+        write("a.erg", "valid A1");
+        write("b.erg", "valid B1");
+        write("bad.erg", "not a workout");
+        write("s.rlv", "valid S1");
+    }
+
+    void firstScan() {
+        LibraryImport import(nullptr);
+        scan(import);
+
+        QCOMPARE(import.count(LibraryImport::Queued), 4);
+        QCOMPARE(import.count(LibraryImport::Hashed), 4);
+        QCOMPARE(import.count(LibraryImport::Unchanged), 0);
+        QCOMPARE(import.count(LibraryImport::Parsed), 4);
+        QCOMPARE(import.count(LibraryImport::Written), 3);
+        QCOMPARE(parses.loadRelaxed(), 4);
+
+        QCOMPARE(imported, QStringList() << path("a.erg") << path("b.erg") << path("s.rlv"));
+        QCOMPARE(import.workouts(), QStringList() << path("a.erg") << path("b.erg"));
+        QCOMPARE(import.videoSyncs(), QStringList() << path("s.rlv"));
+        QCOMPARE(dbNames.value(path("b.erg")), QString("B1"));
+
+        // only what made it in has its hash remembered
+        QCOMPARE(dbHashes.count(), 3);
+        QCOMPARE(dbHashes.value(path("a.erg")), LibraryImport::contentHash(path("a.erg")));
+        QVERIFY(!dbHashes.contains(path("bad.erg")));
+    }
+
+    // nothing changed, only the file that didn't parse is read again
+    void unchangedSkipped() {
+        { LibraryImport first(nullptr); scan(first); }
+
+        LibraryImport import(nullptr);
+        scan(import);
+        QCOMPARE(import.count(LibraryImport::Hashed), 4);
+        QCOMPARE(import.count(LibraryImport::Unchanged), 3);
+        QCOMPARE(import.count(LibraryImport::Parsed), 1);
+        QCOMPARE(import.count(LibraryImport::Written), 0);
+        QCOMPARE(parses.loadRelaxed(), 1);
+        QVERIFY(imported.isEmpty());
+
+        // skipped files are still in the library
+        QCOMPARE(import.workouts(), QStringList() << path("a.erg") << path("b.erg"));
+        QCOMPARE(import.videoSyncs(), QStringList() << path("s.rlv"));
+        QVERIFY(import.workout(path("a.erg")) == nullptr);
+    }
+
+    // a file whose content changed is parsed and written again
+    void changedReimported() {
+        { LibraryImport first(nullptr); scan(first); }
+        write("b.erg", "valid B2");
+        write("s.rlv", "valid S2");
+
+        LibraryImport import(nullptr);
+        scan(import);
+        QCOMPARE(import.count(LibraryImport::Unchanged), 1);
+        QCOMPARE(import.count(LibraryImport::Parsed), 3);
+        QCOMPARE(imported, QStringList() << path("b.erg") << path("s.rlv"));
+        QCOMPARE(dbNames.value(path("b.erg")), QString("B2"));
+        QCOMPARE(dbNames.value(path("s.rlv")), QString("S2"));
+        QCOMPARE(import.workout(path("b.erg"))->name(), QString("B2"));
+        QCOMPARE(dbHashes.value(path("b.erg")), LibraryImport::contentHash(path("b.erg")));
+
+        // and then it is unchanged
+        LibraryImport again(nullptr);
+        scan(again);
+        QCOMPARE(again.count(LibraryImport::Unchanged), 3);
+        QVERIFY(imported.isEmpty());
+    }
+
+    // changed into something that doesn't parse, it's dropped
+    void changedInvalid() {
+        { LibraryImport first(nullptr); scan(first); }
+        write("b.erg", "not a workout any more");
+
+        LibraryImport import(nullptr);
+        scan(import);
+        QCOMPARE(import.count(LibraryImport::Parsed), 2);
+        QVERIFY(imported.isEmpty());
+        QCOMPARE(import.workouts(), QStringList() << path("a.erg"));
+    }
+
+    // the hash is known but the file has gone from TrainDB, e.g. deleted
+    // from the library, so it's imported again
+    void notInLibrary() {
+        { LibraryImport first(nullptr); scan(first); }
+        dbWorkouts.remove(path("a.erg"));
+
+        LibraryImport import(nullptr);
+        scan(import);
+        QCOMPARE(import.count(LibraryImport::Unchanged), 2);
+        QCOMPARE(imported, QStringList() << path("a.erg"));
+    }
+
+    // importing files rather than searching parses them all
+    void withoutSkip() {
+        { LibraryImport first(nullptr); scan(first); }
+
+        LibraryImport import(nullptr);
+        scan(import, false);
+        QCOMPARE(import.count(LibraryImport::Unchanged), 0);
+        QCOMPARE(import.count(LibraryImport::Parsed), 4);
+        QCOMPARE(imported, QStringList() << path("a.erg") << path("b.erg") << path("s.rlv"));
+    }
+
+    // found twice in a search, queued once
+    void queuedOnce() {
+        LibraryImport import(nullptr);
+        import.addWorkout(path("a.erg"));
+        import.addWorkout(path("a.erg"));
+        import.addVideoSync(path("a.erg"));
+        import.wait();
+        QCOMPARE(import.count(LibraryImport::Queued), 2);
+        QCOMPARE(import.workouts(), QStringList() << path("a.erg"));
+    }
+};
+
+
+QTEST_MAIN(TestLibraryImport)
+#include "testLibraryImport.moc"
@@ -0,0 +1,9 @@
+QT += testlib core
+
+INCLUDEPATH += ../../../src/FileIO
+
+SOURCES = testTelemetryRecorder.cpp \
+          ../../../src/Train/TelemetryRecorder.cpp \
+          ../../../src/FileIO/MeanMaxEngine.cpp
+
+include(../../unittests.pri)
@@ -0,0 +1,258 @@
+#include "Train/TelemetryRecorder.h"
+
+#include <QTest>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <cstring>
+#include <thread>
+
+
+// a sample holding channels, at session time msecs
+static TelemetrySample sample(qint64 msecs, quint32 channels, float watts, int interval=0)
+{
+    TelemetrySample s;
+    memset(&s, 0, sizeof(s));
+    s.msecs = msecs;
+    s.channels = channels;
+    s.watts = watts;
+    s.hr = watts / 2;
+    s.lat = 51.123456789012;
+    s.interval = interval;
+    return s;
+}
+
+// the values of each row of a CSV file, after the header
+static QList<QStringList> rows(QString csv)
+{
+    QList<QStringList> returning;
+    QFile file(csv);
+    if (!file.open(QFile::ReadOnly)) return returning;
+    QStringList lines = QTextStream(&file).readAll().split("\n", Qt::SkipEmptyParts);
+    for (int i=1; i<lines.count(); i++) returning << lines[i].split(",");
+    return returning;
+}
+
+
+class TestTelemetryRecorder: public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void ringIsFifo() {
+        TelemetryRing<int, 8> ring;
+        int x;
+
+        QVERIFY(!ring.pop(x));
+        for (int i=0; i<8; i++) QVERIFY(ring.push(i));
+        QVERIFY(!ring.push(8)); // full
+
+        for (int i=0; i<5; i++) {
+            QVERIFY(ring.pop(x));
+            QCOMPARE(x, i);
+        }
+
+        // wraps around
+        for (int i=8; i<13; i++) QVERIFY(ring.push(i));
+        for (int i=5; i<13; i++) {
+            QVERIFY(ring.pop(x));
+            QCOMPARE(x, i);
+        }
+        QVERIFY(!ring.pop(x));
+    }
+
+    void ringAcrossThreads() {
+        TelemetryRing<int, 64> ring;
+        const int count = 200000;
+
+        std::thread producer([&]() {
+            for (int i=0; i<count; ) {
+                if (ring.push(i)) i++;
+                else std::this_thread::yield();
+            }
+        });
+
+        int x, next = 0;
+        while (next < count) {
+            if (!ring.pop(x)) {
+                std::this_thread::yield();
+                continue;
+            }
+            QCOMPARE(x, next);
+            next++;
+        }
+        producer.join();
+    }
+
+    void recordAndConvert() {
+        QTemporaryDir dir;
+        QString binary = dir.path() + "/ride.tlm";
+        QString csv = dir.path() + "/ride.csv";
+
+        TelemetryRecorder recorder;
+        QVERIFY(recorder.open(binary));
+
+        // a power meter at 4 a second on source 1 and the train view with
+        // everything else on source 0, with nothing from 2.0s to 3.0s
+        const quint32 polled = TelemetrySample::All & ~TelemetrySample::Power;
+        QList<qint64> power = QList<qint64>() << 250 << 500 << 750 << 1000 << 1250 << 1500 << 1750 << 3250;
+        foreach(qint64 msecs, power) QVERIFY(recorder.push(1, sample(msecs, TelemetrySample::Power, msecs / 10.0)));
+        QList<qint64> view = QList<qint64>() << 200 << 1400 << 3200;
+        foreach(qint64 msecs, view) QVERIFY(recorder.push(0, sample(msecs, polled, 999, 2)));
+        recorder.close();
+        QCOMPARE(recorder.dropped(), 0);
+
+        QVERIFY(TelemetryRecorder::convert(binary, csv, 1000));
+
+        QFile file(csv);
+        QVERIFY(file.open(QFile::ReadOnly));
+        QVERIFY(QTextStream(&file).readLine().startsWith("secs, cad, hr, km, kph, nm, watts"));
+
+        // one row a second holding the latest of each channel, where
+        // the row for 1s includes the sample at exactly 1000ms
+        QList<QStringList> values = rows(csv);
+        QCOMPARE(values.count(), 3);
+        QStringList secs, watts, hr;
+        foreach(QStringList row, values) {
+            QCOMPARE(row.count(), 33);
+            secs << row[0];
+            watts << row[6];
+            hr << row[2];
+            QCOMPARE(row[9].toDouble(), 51.123456789012);
+            QCOMPARE(row[13], QString("2"));
+        }
+        QCOMPARE(secs, QStringList() << "1" << "2" << "4");
+        QCOMPARE(watts, QStringList() << "100" << "175" << "325");
+
+        // heart rate comes from the train view, not the power meter
+        QCOMPARE(hr, QStringList() << "499.5" << "499.5" << "499.5");
+    }
+
+    void convertEdges() {
+        QTemporaryDir dir;
+        QString binary = dir.path() + "/ride.tlm";
+        QString csv = dir.path() + "/ride.csv";
+
+        // nothing recorded, just the header
+        TelemetryRecorder recorder;
+        QVERIFY(recorder.open(binary));
+        recorder.close();
+        QVERIFY(TelemetryRecorder::convert(binary, csv, 1000));
+        QCOMPARE(rows(csv).count(), 0);
+
+        // one sample at the very start, the first row is for 0s
+        QVERIFY(recorder.open(binary));
+        QVERIFY(recorder.push(0, sample(0, TelemetrySample::All, 150)));
+        recorder.close();
+        QVERIFY(TelemetryRecorder::convert(binary, csv, 1000));
+        QList<QStringList> values = rows(csv);
+        QCOMPARE(values.count(), 1);
+        QCOMPARE(values[0][0], QString("0"));
+        QCOMPARE(values[0][6], QString("150"));
+
+        // sources drained out of order are put back in order
+        QVERIFY(recorder.open(binary));
+        QVERIFY(recorder.push(1, sample(900, TelemetrySample::Power, 300)));
+        QVERIFY(recorder.push(2, sample(600, TelemetrySample::Power, 200)));
+        recorder.close();
+        QVERIFY(TelemetryRecorder::convert(binary, csv, 1000));
+        values = rows(csv);
+        QCOMPARE(values.count(), 1);
+        QCOMPARE(values[0][6], QString("300"));
+    }
+
+    // the latest watts each second are searched as they are written
+    void sessionBests() {
+        QTemporaryDir dir;
+        TelemetryRecorder recorder;
+        QVERIFY(recorder.open(dir.path() + "/ride.tlm"));
+        int version = recorder.sessionBestsVersion();
+
+        // 100w with 300w for 4s and 5s, the latest sample in each second
+        // pushed first, nothing at all for 8s and 9s and the 12s sample
+        // completes 11s. The heart rate from the train view is ignored
+        QVector<double> secs, watts;
+        for (int i=1; i<=11; i++) {
+            if (i == 8 || i == 9) continue;
+            float w = (i == 4 || i == 5) ? 300 : 100;
+            QVERIFY(recorder.push(1, sample(i * 1000 - 100, TelemetrySample::Power, w)));
+            QVERIFY(recorder.push(1, sample(i * 1000 - 600, TelemetrySample::Power, 50)));
+            QVERIFY(recorder.push(0, sample(i * 1000 - 300, TelemetrySample::HeartRate, 500)));
+            secs << i;
+            watts << w;
+        }
+        QVERIFY(recorder.push(1, sample(11500, TelemetrySample::Power, 1000)));
+        recorder.close();
+
+        MeanMaxEngine expected;
+        QVERIFY(expected.update(secs.constData(), watts.constData(), 0, secs.count()));
+        QCOMPARE(recorder.sessionBests(), expected.bests());
+        QCOMPARE(recorder.sessionBests()[2], 300.0f);
+        QVERIFY(recorder.sessionBestsVersion() != version);
+
+        // and start again with the next session
+        QVERIFY(recorder.open(dir.path() + "/next.tlm"));
+        QVERIFY(recorder.sessionBests().isEmpty());
+        recorder.close();
+    }
+
+    void sessionTime() {
+        TelemetryRecorder recorder;
+        QVERIFY(!recorder.isRecording());
+
+        recorder.setSessionTime(5000, false);
+        QVERIFY(!recorder.isRecording());
+        QVERIFY(recorder.sessionTime() >= 5000);
+
+        recorder.setSessionTime(60000, true);
+        QVERIFY(recorder.isRecording());
+        QVERIFY(recorder.sessionTime() >= 60000 && recorder.sessionTime() < 70000);
+    }
+
+    void recoverAfterCrash() {
+        QTemporaryDir dir;
+        QString binary = dir.path() + "/2026_10_16_07_00_00_ride.tlm";
+
+        TelemetryRecorder recorder;
+        QVERIFY(recorder.open(binary));
+        QVERIFY(recorder.push(0, sample(1000, TelemetrySample::All, 200)));
+        QVERIFY(recorder.push(0, sample(2000, TelemetrySample::All, 210)));
+        recorder.close();
+
+        // as if we crashed part way through writing the next sample
+        QFile file(binary);
+        QVERIFY(file.open(QFile::Append));
+        TelemetrySample partial = sample(3000, TelemetrySample::All, 220);
+        file.write((const char*)&partial, sizeof(partial) / 2);
+        file.close();
+
+        QStringList recovered = TelemetryRecorder::recover(dir.path(), 1000);
+        QCOMPARE(recovered, QStringList() << dir.path() + "/2026_10_16_07_00_00_ride.csv");
+        QVERIFY(!QFile::exists(binary));
+
+        QList<QStringList> values = rows(recovered[0]);
+        QCOMPARE(values.count(), 2);
+        QCOMPARE(values[1][6], QString("210"));
+
+        // nothing left to do
+        QCOMPARE(TelemetryRecorder::recover(dir.path(), 1000), QStringList());
+    }
+
+    void convertRejectsOtherFiles() {
+        QTemporaryDir dir;
+        QFile file(dir.path() + "/ride.tlm");
+        QVERIFY(file.open(QFile::WriteOnly));
+        file.write("secs, cad, hr\n1,2,3\n");
+        file.close();
+
+        QVERIFY(!TelemetryRecorder::convert(file.fileName(), dir.path() + "/ride.csv", 1000));
+
+        // and isn't recovered
+        QCOMPARE(TelemetryRecorder::recover(dir.path(), 1000), QStringList());
+        QVERIFY(file.exists());
+    }
+};
+
+QTEST_MAIN(TestTelemetryRecorder)
+#include "testTelemetryRecorder.moc"
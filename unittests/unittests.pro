@@ -12,7 +12,32 @@ equals(GC_UNITTESTS, active) {
 			   Core/utils \
 			   Core/signalSafety \
 			   Core/splineCrash \
+			   Core/taskScheduler \
+			   Core/dataFilterProgram \
+			   Core/textIndex \
+			   Core/routeIndex \
+			   Core/rideDBStore \
+			   Core/settingsSnapshot \
+			   Core/apiRideList \
+			   ANT/antSerial \
+			   Charts/seriesPyramid \
+			   FileIO/meanMaxEngine \
+			   FileIO/rideFileRows \
+			   FileIO/rideFileColumns \
+			   FileIO/meanMaxIndex \
+			   FileIO/fitDecoder \
+			   Metrics/cpSolver \
+			   Metrics/estimatorWeeks \
+			   Metrics/metricAggregate \
+			   Metrics/metricPasses \
+			   Metrics/peakEngine \
+			   Metrics/zoneHistogram \
+			   Train/telemetryRecorder \
+			   Train/libraryImport \
 			   Gui/calendarData
+	contains(DEFINES, "GC_WANT_PYTHON") {
+		SUBDIRS += Python/pythonDataSeries
+	}
 	CONFIG += ordered
 } else {
 	message("Unittests are disabled; to enable copy unittests/unittests.pri.in to unittests/unittests.pri")